@@ -43,7 +43,7 @@ OPTION(BUILD_CLI "Build the `rpcli` command line program." ON)
 # ZLIB, libpng, XML, zstd
 # Internal versions are always used on Windows.
 OPTION(ENABLE_XML "Enable XML parsing for e.g. Windows manifests." ON)
-OPTION(ENABLE_ZSTD "Enable ZSTD decompression. (Required for some unit tests.)" ON)
+OPTION(ENABLE_ZSTD "Enable ZSTD decompression. (Required for some unit tests and KTX2 textures.)" ON)
 OPTION(ENABLE_LZ4 "Enable LZ4 decompression. (Required for some PSP disc formats.)" ON)
 OPTION(ENABLE_LZO "Enable LZO decompression. (Required for some PSP disc formats.)" ON)
 
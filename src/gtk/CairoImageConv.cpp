@@ -100,47 +100,30 @@ cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img
 				break;
 
 			// Premultiply the palette.
+			// NOTE: rp_image::expand_CI8() requires a 256-color palette,
+			// so smaller palettes are copied to pal_prex as well.
 			std::array<uint32_t, 256> pal_prex;
 			const uint32_t *pal_toUse;
 			if (premultiply) {
 				for (int i = 0; i < palette_len; i++) {
 					pal_prex[i] = rp_image::premultiply_pixel(palette[i]);
 				}
-				if (palette_len < (int)pal_prex.size()) {
-					// Clear the rest of the palette.
-					memset(&pal_prex[palette_len], 0, (pal_prex.size() - palette_len) * sizeof(uint32_t));
-				}
+				pal_toUse = pal_prex.data();
+			} else if (palette_len < (int)pal_prex.size()) {
+				memcpy(pal_prex.data(), palette, palette_len * sizeof(uint32_t));
 				pal_toUse = pal_prex.data();
 			} else {
 				pal_toUse = palette;
 			}
+			if (pal_toUse == pal_prex.data() && palette_len < (int)pal_prex.size()) {
+				// Clear the rest of the palette.
+				memset(&pal_prex[palette_len], 0, (pal_prex.size() - palette_len) * sizeof(uint32_t));
+			}
 
 			// Copy the image data.
-			const uint8_t *img_buf = static_cast<const uint8_t*>(img->bits());
-			const int dest_stride_adj = (cairo_image_surface_get_stride(surface) / sizeof(uint32_t)) - width;
-			const int src_stride_adj = img->stride() - width;
-
-			for (unsigned int y = (unsigned int)height; y > 0; y--) {
-				unsigned int x;
-				for (x = (unsigned int)width; x > 3; x -= 4) {
-					px_dest[0] = pal_toUse[img_buf[0]];
-					px_dest[1] = pal_toUse[img_buf[1]];
-					px_dest[2] = pal_toUse[img_buf[2]];
-					px_dest[3] = pal_toUse[img_buf[3]];
-					px_dest += 4;
-					img_buf += 4;
-				}
-				for (; x > 0; x--, px_dest++, img_buf++) {
-					// Last pixels.
-					*px_dest = pal_toUse[*img_buf];
-					px_dest++;
-					img_buf++;
-				}
-
-				// Next line.
-				img_buf += src_stride_adj;
-				px_dest += dest_stride_adj;
-			}
+			rp_image::expand_CI8(px_dest, cairo_image_surface_get_stride(surface),
+				static_cast<const uint8_t*>(img->bits()), img->stride(),
+				width, height, pal_toUse);
 
 			// Mark the surface as dirty.
 			cairo_surface_mark_dirty(surface);
@@ -11,6 +11,7 @@
 // librpbase, librptexture
 using namespace LibRpBase;
 using LibRpTexture::rp_image;
+#include "librptexture/img/rp_image_pool.hpp"
 
 // libromdata
 #include "libromdata/RomDataFactory.hpp"
@@ -308,6 +309,13 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 	g_type_init();
 #endif
 
+	// The D-Bus thumbnailer calls this function for every
+	// thumbnail request, so reuse image buffers between requests.
+	// NOTE: This only affects rp_image's default backend.
+	if (LibRpTexture::ImagePool::maxCachedBytes() == 0) {
+		LibRpTexture::ImagePool::setMaxCachedBytes(32*1024*1024);
+	}
+
 	// NOTE: TCreateThumbnail() has wrappers for opening the
 	// ROM file and getting RomData*, but we're doing it here
 	// in order to return better error codes.
@@ -332,7 +340,6 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 	}
 
 	// Create the thumbnail.
-	// TODO: If image is larger than maximum_size, resize down.
 	unique_ptr<CreateThumbnailPrivate> d(new CreateThumbnailPrivate());
 	CreateThumbnailPrivate::GetThumbnailOutParams_t outParams;
 	ret = d->getThumbnail(romData, maximum_size, &outParams);
@@ -370,6 +377,10 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 		goto cleanup;
 	}
 
+	// Thumbnails are cache files, so encoding speed
+	// is more important than file size.
+	pngWriter->setEncodeProfile(RpPngWriter::EncodeProfile::Fast);
+
 	/** tEXt chunks. **/
 	// NOTE: These are written before IHDR in order to put the
 	// tEXt chunks before the IDAT chunk.
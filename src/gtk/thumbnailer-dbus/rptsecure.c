@@ -38,7 +38,15 @@ int rpt_do_security_options(void)
 		// ensures it can only be used to create threads.
 		SCMP_SYS(clone),
 		// Other multi-threading syscalls
+		// [ImageDecoder: multithreaded decoding of large textures]
 		SCMP_SYS(set_robust_list),
+		SCMP_SYS(madvise),		// thread stack cleanup
+		SCMP_SYS(rt_sigprocmask),	// pthread_create()
+#if defined(__SNR_rseq)
+		SCMP_SYS(rseq),		// glibc-2.35
+#elif defined(__NR_rseq)
+		__NR_rseq,		// glibc-2.35
+#endif /* __SNR_rseq || __NR_rseq */
 
 		SCMP_SYS(access),	// LibUnixCommon::isWritableDirectory()
 		SCMP_SYS(close),
@@ -295,7 +295,6 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const ch
 	}
 
 	// Create the thumbnail.
-	// TODO: If image is larger than maximum_size, resize down.
 	RomThumbCreatorPrivate *const d = new RomThumbCreatorPrivate();
 	RomThumbCreatorPrivate::GetThumbnailOutParams_t outParams;
 	int ret = d->getThumbnail(romData, maximum_size, &outParams);
@@ -346,6 +345,10 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const ch
 		return RPCT_OUTPUT_FILE_FAILED;
 	}
 
+	// Thumbnails are cache files, so encoding speed
+	// is more important than file size.
+	pngWriter->setEncodeProfile(RpPngWriter::EncodeProfile::Fast);
+
 	// Software.
 	static const char sw[] = "ROM Properties Page shell extension (" RP_KDE_UPPER QT_MAJOR_STR ")";
 	kv.emplace_back("Software", sw);
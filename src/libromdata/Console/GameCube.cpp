@@ -761,39 +761,34 @@ GameCube::GameCube(IRpFile *file)
 				d->discReader = new WbfsReader(d->file);
 			} else*/ if ((d->discType & GameCubePrivate::DISC_FORMAT_MASK) == GameCubePrivate::DISC_FORMAT_WBFS) {
 				// First part of split WBFS.
-				// Check for a WBF1 file.
-				IRpFile *wbfs1 = FileSystem::openRelatedFile(file->filename().c_str(), nullptr, ".wbf1");
-				// COMMIT THIS FIRST BEFORE UNREF
-				if (unlikely(!wbfs1 || !wbfs1->isOpen())) {
-					// Unable to open the .wbf1 file.
-					// Assume it's a single .wbfs file.
-					UNREF_AND_NULL(wbfs1);
+				// Check for additional parts. (.wbf1, .wbf2, ...)
+				vector<IRpFile*> wbfsParts;
+				wbfsParts.push_back(d->file);
+				for (unsigned int i = 1; i <= 9; i++) {
+					char ext[8];
+					snprintf(ext, sizeof(ext), ".wbf%u", i);
+					IRpFile *const wbfsN = FileSystem::openRelatedFile(filename.c_str(), nullptr, ext);
+					if (!wbfsN || !wbfsN->isOpen()) {
+						// No more parts.
+						UNREF(wbfsN);
+						break;
+					}
+					wbfsParts.push_back(wbfsN);
 				}
 
-				if (likely(!wbfs1)) {
+				if (likely(wbfsParts.size() == 1)) {
 					// Single .wbfs file.
 					d->discReader = new WbfsReader(d->file);
 					break;
 				}
 
-				// Split .wbfs/.wbf1.
-				DualFile *const dualFile = new DualFile(d->file, wbfs1);
-				if (!dualFile->isOpen()) {
-					// Unable to open DualFile.
-					dualFile->unref();
-					d->discType = GameCubePrivate::DISC_UNKNOWN;
-					break;
+				// Split .wbfs/.wbf1/.wbf2...
+				// WbfsReader uses SplitFile and maintains its own references,
+				// so unreference the additional parts.
+				d->discReader = new WbfsReader(wbfsParts);
+				for (auto iter = wbfsParts.cbegin() + 1; iter != wbfsParts.cend(); ++iter) {
+					(*iter)->unref();
 				}
-
-				// DualFile maintains its own references, so unreference
-				// d->file and replace it with the DualFile.
-				IRpFile *const file_tmp = d->file;
-				d->file = dualFile;
-				file_tmp->unref();
-				wbfs1->unref();
-
-				// Open the WbfsReader.
-				d->discReader = new WbfsReader(d->file);
 			} else {
 				// Not supported.
 				d->discType = GameCubePrivate::DISC_UNKNOWN;
@@ -1570,6 +1565,19 @@ int GameCube::loadFieldData(void)
 		return static_cast<int>(d->fields->count());
 	}
 
+	// WBFS partitions can contain more than one disc.
+	// Only the first disc is shown, so indicate how many are present.
+	if ((d->discType & GameCubePrivate::DISC_FORMAT_MASK) == GameCubePrivate::DISC_FORMAT_WBFS) {
+		const WbfsReader *const wbfsReader = dynamic_cast<const WbfsReader*>(d->discReader);
+		const unsigned int discCount = (wbfsReader ? wbfsReader->discCount() : 0);
+		if (discCount > 1) {
+			d->fields->addField_string(C_("GameCube", "WBFS Disc"),
+				// tr: %1$u == disc number, %2$u == number of discs in the WBFS partition
+				rp_sprintf_p(C_("GameCube", "%1$u of %2$u"),
+					wbfsReader->discIndex() + 1, discCount));
+		}
+	}
+
 	// Region code.
 	// bi2.bin and/or RVL_RegionSetting is loaded in the constructor,
 	// and the region code is stored in d->gcnRegion.
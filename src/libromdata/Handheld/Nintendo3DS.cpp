@@ -73,6 +73,10 @@ Nintendo3DSPrivate::~Nintendo3DSPrivate()
 {
 	UNREF(mainContent);
 	UNREF(ncch_reader);
+
+	for (CIAReader *ciaReader : ciaReaders) {
+		UNREF(ciaReader);
+	}
 }
 
 /**
@@ -209,6 +213,78 @@ int Nintendo3DSPrivate::loadSMDH(void)
 	return 0;
 }
 
+/**
+ * Find a content in the content index. (CIA only)
+ * @param idx TMD content index.
+ * @return Content chunk record number, or -1 if not found.
+ */
+int Nintendo3DSPrivate::findContent(int idx) const
+{
+	if (idx < 0 || idx > 0xFFFF) {
+		// Invalid content index.
+		return -1;
+	}
+
+	// The content index usually matches the record number.
+	const unsigned int count = static_cast<unsigned int>(content_index.size());
+	if (static_cast<unsigned int>(idx) < count && content_index[idx].index == idx) {
+		return idx;
+	}
+
+	// Check all records.
+	for (unsigned int i = 0; i < count; i++) {
+		if (content_index[i].index == idx) {
+			return static_cast<int>(i);
+		}
+	}
+
+	// Not found.
+	return -1;
+}
+
+/**
+ * Get the CIAReader for an encrypted content. (CIA only)
+ * The CIAReader is created if it hasn't been created yet.
+ * If it can't be opened, the failure is cached.
+ * @param rec Content chunk record number.
+ * @return CIAReader, or nullptr if the content isn't encrypted or can't be decrypted.
+ */
+CIAReader *Nintendo3DSPrivate::getCIAReader(unsigned int rec)
+{
+	if (rec >= content_index.size() || !content_index[rec].encrypted) {
+		// Out of range, or not encrypted.
+		return nullptr;
+	}
+
+	content_index_t &content = content_index[rec];
+	if (content.ciaReaderFailed) {
+		// A previous attempt to open the CIAReader failed.
+		return nullptr;
+	}
+
+	if (ciaReaders.size() != content_index.size()) {
+		ciaReaders.resize(content_index.size());
+	}
+	CIAReader *ciaReader = ciaReaders[rec];
+	if (ciaReader) {
+		// CIAReader has already been created.
+		return ciaReader;
+	}
+
+	// Create a CIAReader.
+	ciaReader = new CIAReader(file, content.offset, content.length,
+		&mxh.ticket, content.index);
+	if (!ciaReader->isOpen()) {
+		// Unable to open the CIAReader.
+		// Don't try again for this content.
+		UNREF_AND_NULL_NOCHK(ciaReader);
+		content.ciaReaderFailed = true;
+	}
+
+	ciaReaders[rec] = ciaReader;
+	return ciaReader;
+}
+
 /**
  * Load the specified NCCH header.
  * @param pOutNcchReader	[out] Output variable for the NCCHReader.
@@ -223,6 +299,7 @@ int Nintendo3DSPrivate::loadNCCH(int idx, NCCHReader **pOutNcchReader)
 
 	off64_t offset = 0;
 	uint32_t length = 0;
+	int rec = -1;	// Content chunk record number. (CIA only)
 	switch (romType) {
 		case RomType::CIA: {
 			if (!(headers_loaded & HEADER_CIA)) {
@@ -236,34 +313,18 @@ int Nintendo3DSPrivate::loadNCCH(int idx, NCCHReader **pOutNcchReader)
 				return -EIO;
 			}
 
-			// Check if the content index is valid.
-			if (static_cast<unsigned int>(idx) >= content_chunks.size()) {
-				// Content index is out of range.
+			// Find the content in the content index.
+			rec = findContent(idx);
+			if (rec < 0) {
+				// Content chunk not found.
 				return -ENOENT;
 			}
-
-			// Determine the content start position.
-			// Need to add all content chunk sizes, algined to 64 bytes.
-			const auto content_chunks_cend = content_chunks.cend();
-			for (auto iter = content_chunks.cbegin();
-			     iter != content_chunks_cend; ++iter)
-			{
-				const uint32_t cur_size = static_cast<uint32_t>(be64_to_cpu(iter->size));
-				if (be16_to_cpu(iter->index) == idx) {
-					// Found the content chunk.
-					length = cur_size;
-					break;
-				}
-				// Next chunk.
-				offset += toNext64(cur_size);
-			}
+			offset = content_index[rec].offset;
+			length = content_index[rec].length;
 			if (length == 0) {
-				// Content chunk not found.
+				// Empty content.
 				return -ENOENT;
 			}
-
-			// Add the content start address.
-			offset += mxh.content_start_addr;
 			break;
 		}
 
@@ -310,51 +371,24 @@ int Nintendo3DSPrivate::loadNCCH(int idx, NCCHReader **pOutNcchReader)
 	}
 
 	// Is this encrypted using CIA title key encryption?
+	// If it is, use the shared CIAReader for this content.
 	CIAReader *ciaReader = nullptr;
-	if (romType == RomType::CIA && idx < (int)content_chunks.size()) {
-		// Check if this content is encrypted.
-		// If it is, we'll need to create a CIAReader.
-		N3DS_Ticket_t *ticket = nullptr;
-		const auto content_chunks_cend = content_chunks.cend();
-		for (auto iter = content_chunks.cbegin();
-		     iter != content_chunks_cend; ++iter)
-		{
-			const uint16_t content_index = be16_to_cpu(iter->index);
-			if (content_index == idx) {
-				// Found the content index.
-				if (iter->type & cpu_to_be16(N3DS_CONTENT_CHUNK_ENCRYPTED)) {
-					// Content is encrypted.
-					ticket = &mxh.ticket;
-				}
-				break;
-			}
-		}
-
-		if (ticket) {
-			// Create a CIAReader.
-			ciaReader = new CIAReader(file, offset, length, ticket, idx);
-			if (!ciaReader->isOpen()) {
-				// Unable to open the CIAReader.
-				UNREF_AND_NULL_NOCHK(ciaReader);
-			}
-		}
+	if (rec >= 0) {
+		ciaReader = getCIAReader(static_cast<unsigned int>(rec));
 	}
 
 	// Create the NCCHReader.
 	// NOTE: We're not checking isOpen() here.
 	// That should be checked by the caller.
-	if (ciaReader && ciaReader->isOpen()) {
+	if (ciaReader) {
 		// This is an encrypted CIA.
-		// NOTE 2: CIAReader handles the offset, so we need to
+		// NOTE: CIAReader handles the offset, so we need to
 		// tell NCCHReader that the offset is 0.
 		*pOutNcchReader = new NCCHReader(ciaReader, media_unit_shift, 0, length);
 	} else {
 		// Anything else is read directly.
 		*pOutNcchReader = new NCCHReader(file, media_unit_shift, offset, length);
 	}
-
-	// We don't need to keep a reference to the CIAReader.
-	UNREF(ciaReader);
 	return 0;
 }
 
@@ -533,6 +567,22 @@ int Nintendo3DSPrivate::loadTicketAndTMD(void)
 	// Store the content start address.
 	mxh.content_start_addr = tmd_start + toNext64(tmd_size);
 
+	// Build the content index.
+	// Each content starts at the next 64-byte boundary.
+	content_index.resize(content_count);
+	off64_t content_offset = mxh.content_start_addr;
+	for (unsigned int i = 0; i < content_count; i++) {
+		const N3DS_Content_Chunk_Record_t *const chunk = &content_chunks[i];
+		content_index_t *const content = &content_index[i];
+		const uint32_t cur_size = static_cast<uint32_t>(be64_to_cpu(chunk->size));
+		content->offset = content_offset;
+		content->length = cur_size;
+		content->index = be16_to_cpu(chunk->index);
+		content->encrypted = !!(chunk->type & cpu_to_be16(N3DS_CONTENT_CHUNK_ENCRYPTED));
+		content->ciaReaderFailed = false;
+		content_offset += toNext64(cur_size);
+	}
+
 	// Loaded the TMD header.
 	headers_loaded |= HEADER_TMD;
 
@@ -572,9 +622,8 @@ int Nintendo3DSPrivate::openSRL(void)
 		return -EIO;
 	}
 
-	const N3DS_Content_Chunk_Record_t *const chunk0 = &content_chunks[0];
-	const off64_t offset = mxh.content_start_addr;
-	const uint32_t length = static_cast<uint32_t>(be64_to_cpu(chunk0->size));
+	const content_index_t &content0 = content_index[0];
+	const uint32_t length = content0.length;
 	if (length < 0x8000) {
 		return -ENOENT;
 	}
@@ -584,16 +633,20 @@ int Nintendo3DSPrivate::openSRL(void)
 	// have to use both DiscReader and PartitionFile.
 
 	// Check if this content is encrypted.
-	// If it is, we'll need to create a CIAReader.
+	// If it is, use the shared CIAReader.
 	IDiscReader *srlReader = nullptr;
-	if (chunk0->type & cpu_to_be16(N3DS_CONTENT_CHUNK_ENCRYPTED)) {
+	if (content0.encrypted) {
 		// Content is encrypted.
-		srlReader = new CIAReader(this->file, offset, length,
-			&mxh.ticket, be16_to_cpu(chunk0->index));
+		srlReader = getCIAReader(0);
+		if (!srlReader) {
+			// Unable to open the CIAReader.
+			return -EIO;
+		}
+		srlReader->ref();
 	} else {
 		// Content is NOT encrypted.
 		// Use a plain old DiscReader.
-		srlReader = new DiscReader(this->file, offset, length);
+		srlReader = new DiscReader(this->file, content0.offset, length);
 	}
 	if (!srlReader->isOpen()) {
 		// Unable to open the SRL reader.
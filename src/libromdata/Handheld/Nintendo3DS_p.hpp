@@ -31,6 +31,7 @@ namespace LibRpFile {
 
 namespace LibRomData {
 
+class CIAReader;
 class NCCHReader;
 class Nintendo3DS_SMDH;
 class NintendoDS;
@@ -130,6 +131,27 @@ class Nintendo3DSPrivate final : public LibRpBase::RomDataPrivate
 		// Loaded by loadTicketAndTMD().
 		ao::uvector<N3DS_Content_Chunk_Record_t> content_chunks;
 
+		// Content index. (CIA only)
+		// Built from the content chunk records by loadTicketAndTMD(),
+		// so the records don't need to be rescanned for every content.
+		// Indexed by content chunk record number.
+		struct content_index_t {
+			off64_t offset;		// Absolute content offset
+			uint32_t length;	// Content length
+			uint16_t index;		// TMD content index (host-endian)
+			bool encrypted;		// True if encrypted using the title key
+			bool ciaReaderFailed;	// True if the CIAReader couldn't be opened
+		};
+		ao::uvector<content_index_t> content_index;
+
+		// CIAReaders for encrypted contents. (CIA only)
+		// Created on demand by getCIAReader() and shared
+		// by all NCCHReaders that use the same content.
+		// If a CIAReader couldn't be opened, the entry is nullptr
+		// and content_index[].ciaReaderFailed is set.
+		// Indexed by content chunk record number.
+		std::vector<CIAReader*> ciaReaders;
+
 		// TODO: Move the pointers to the union?
 		// That requires careful memory management...
 
@@ -162,6 +184,22 @@ class Nintendo3DSPrivate final : public LibRpBase::RomDataPrivate
 		 */
 		int loadSMDH(void);
 
+		/**
+		 * Find a content in the content index. (CIA only)
+		 * @param idx TMD content index.
+		 * @return Content chunk record number, or -1 if not found.
+		 */
+		int findContent(int idx) const;
+
+		/**
+		 * Get the CIAReader for an encrypted content. (CIA only)
+		 * The CIAReader is created if it hasn't been created yet.
+		 * If it can't be opened, the failure is cached.
+		 * @param rec Content chunk record number.
+		 * @return CIAReader, or nullptr if the content isn't encrypted or can't be decrypted.
+		 */
+		CIAReader *getCIAReader(unsigned int rec);
+
 		/**
 		 * Load the specified NCCH header.
 		 * @param idx			[in] Content/partition index.
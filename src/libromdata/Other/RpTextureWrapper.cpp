@@ -361,4 +361,85 @@ int RpTextureWrapper::loadInternalImage(ImageType imageType, const rp_image **pI
 		d->texture->image);	// func
 }
 
+/**
+ * Get an internal image from the ROM, using a smaller
+ * version of the image if one is available.
+ *
+ * For textures, this returns the smallest mipmap
+ * that is at least the requested size.
+ *
+ * @param imageType	[in] Image type to load.
+ * @param width		[in] Requested width.
+ * @param height	[in] Requested height.
+ * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
+ * @return Internal image, or nullptr if the ROM doesn't have one.
+ */
+const rp_image *RpTextureWrapper::imageForSize(ImageType imageType,
+	int width, int height, int pFullSize[2]) const
+{
+	RP_D(const RpTextureWrapper);
+	if (imageType != IMG_INT_IMAGE || !d->isValid || !d->texture) {
+		// Use the default implementation.
+		return super::imageForSize(imageType, width, height, pFullSize);
+	}
+
+	const rp_image *const img = d->texture->mipmapForSize(width, height);
+	if (img && pFullSize) {
+		// Get the full image size from the texture,
+		// since a smaller mipmap may have been returned.
+		pFullSize[0] = d->texture->width();
+		pFullSize[1] = d->texture->height();
+		if (pFullSize[1] <= 0) {
+			// 1D texture.
+			pFullSize[1] = 1;
+		}
+	}
+	return img;
+}
+
+/**
+ * Get the band height for imageBand().
+ * @param imageType	[in] Image type.
+ * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
+ * @return Band height, or 0 if banded decoding isn't supported.
+ */
+int RpTextureWrapper::imageBandHeight(ImageType imageType, int pFullSize[2]) const
+{
+	RP_D(const RpTextureWrapper);
+	if (imageType != IMG_INT_IMAGE || !d->isValid || !d->texture) {
+		// Use the default implementation.
+		return super::imageBandHeight(imageType, pFullSize);
+	}
+
+	const int band_height = d->texture->bandHeight();
+	if (band_height > 0 && pFullSize) {
+		pFullSize[0] = d->texture->width();
+		pFullSize[1] = d->texture->height();
+		if (pFullSize[1] <= 0) {
+			// 1D texture.
+			pFullSize[1] = 1;
+		}
+	}
+	return band_height;
+}
+
+/**
+ * Decode a horizontal band of an internal image.
+ * The band is *not* cached by this object.
+ * @param imageType	[in] Image type.
+ * @param y		[in] First row. (must be a multiple of imageBandHeight())
+ * @param height	[in] Number of rows.
+ * @return Band image (caller must unref()), or nullptr on error.
+ */
+rp_image *RpTextureWrapper::imageBand(ImageType imageType, int y, int height) const
+{
+	RP_D(const RpTextureWrapper);
+	if (imageType != IMG_INT_IMAGE || !d->isValid || !d->texture) {
+		// Use the default implementation.
+		return super::imageBand(imageType, y, height);
+	}
+
+	return d->texture->decodeBand(y, height);
+}
+
 }
@@ -19,6 +19,42 @@ ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
 ROMDATA_DECL_IMGINT()
+
+	public:
+		/**
+		 * Get an internal image from the ROM, using a smaller
+		 * version of the image if one is available.
+		 *
+		 * For textures, this returns the smallest mipmap
+		 * that is at least the requested size.
+		 *
+		 * @param imageType	[in] Image type to load.
+		 * @param width		[in] Requested width.
+		 * @param height	[in] Requested height.
+		 * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
+		 * @return Internal image, or nullptr if the ROM doesn't have one.
+		 */
+		const LibRpTexture::rp_image *imageForSize(ImageType imageType,
+			int width, int height, int pFullSize[2] = nullptr) const final;
+
+		/**
+		 * Get the band height for imageBand().
+		 * @param imageType	[in] Image type.
+		 * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
+		 * @return Band height, or 0 if banded decoding isn't supported.
+		 */
+		int imageBandHeight(ImageType imageType, int pFullSize[2] = nullptr) const final;
+
+		/**
+		 * Decode a horizontal band of an internal image.
+		 * The band is *not* cached by this object.
+		 * @param imageType	[in] Image type.
+		 * @param y		[in] First row. (must be a multiple of imageBandHeight())
+		 * @param height	[in] Number of rows.
+		 * @return Band image (caller must unref()), or nullptr on error.
+		 */
+		LibRpTexture::rp_image *imageBand(ImageType imageType, int y, int height) const final;
+
 ROMDATA_DECL_END()
 
 }
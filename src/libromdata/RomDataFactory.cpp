@@ -14,6 +14,7 @@
 
 // librpbase, librpfile
 #include "librpfile/RelatedFile.hpp"
+#include "librpfile/SplitFile.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
 
@@ -181,6 +182,14 @@ class RomDataFactoryPrivate
 		 */
 		static RomData *openDreamcastVMSandVMI(IRpFile *file);
 
+		/**
+		 * Attempt to open a split file set. (.part0, .iso.0, .000, etc.)
+		 * @param file First part of the split file set.
+		 * @param attrs RomDataAttr bitfield.
+		 * @return RomData subclass for the combined file, or nullptr if not a split file.
+		 */
+		static RomData *openSplitFile(IRpFile *file, unsigned int attrs);
+
 		// Vectors for file extensions and MIME types.
 		// We want to collect them once per session instead of
 		// repeatedly collecting them, since the caller might
@@ -434,6 +443,37 @@ RomData *RomDataFactoryPrivate::openDreamcastVMSandVMI(IRpFile *file)
 	return dcSave;
 }
 
+/**
+ * Attempt to open a split file set. (.part0, .iso.0, .000, etc.)
+ * @param file First part of the split file set.
+ * @param attrs RomDataAttr bitfield.
+ * @return RomData subclass for the combined file, or nullptr if not a split file.
+ */
+RomData *RomDataFactoryPrivate::openSplitFile(IRpFile *file, unsigned int attrs)
+{
+	// Check the filename first so the filesystem is only
+	// accessed if this might be part of a split file set.
+	if (!SplitFile::isSplitFilename(file->filename())) {
+		// Not a split file.
+		return nullptr;
+	}
+
+	// SplitFile locates the other parts.
+	// The other parts won't be opened until they're needed.
+	SplitFile *const splitFile = new SplitFile(file);
+	if (!splitFile->isOpen()) {
+		// Not the first part of a split file set.
+		splitFile->unref();
+		return nullptr;
+	}
+
+	// NOTE: SplitFile::filename() returns the combined filename,
+	// which doesn't have a part number, so this won't recurse.
+	RomData *const romData = RomDataFactory::create(splitFile, attrs);
+	splitFile->unref();	// RomData maintains its own reference.
+	return romData;
+}
+
 /**
  * Check an ISO-9660 disc image for a game-specific file system.
  *
@@ -553,6 +593,18 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 {
 	RomData::DetectInfo info;
 
+	// Special handling for split files.
+	if (!file->isDevice()) {
+		RomData *const romData = RomDataFactoryPrivate::openSplitFile(file, attrs);
+		if (romData) {
+			// Split file set opened.
+			return romData;
+		}
+
+		// Not a split file set, or the combined file
+		// isn't supported. Check the file by itself.
+	}
+
 	// Get the file size.
 	info.szFile = file->size();
 
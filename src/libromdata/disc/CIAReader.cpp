@@ -70,9 +70,8 @@ CIAReaderPrivate::CIAReaderPrivate(CIAReader *q,
 		return;
 	}
 
-	assert(ticket != nullptr);
 	if (!ticket) {
-		// No ticket. Assuming no encryption.
+		// No ticket. Assuming no encryption. (NoCrypto)
 		// Create a passthru CBCReader anyway.
 		cbcReader = new CBCReader(q->m_file, content_offset, content_length, nullptr, nullptr);
 		return;
@@ -41,9 +41,9 @@ class NCCHReader : public LibRpBase::IPartition
 		/**
 		 * Construct an NCCHReader with the specified CIAReader.
 		 *
-		 * NOTE: The NCCHReader *takes ownership* of the CIAReader.
-		 * This makes it easier to create a temporary CIAReader
-		 * without worrying about keeping track of it.
+		 * NOTE: The NCCHReader takes a reference to the CIAReader,
+		 * so the caller can unref() it afterwards. Multiple NCCHReaders
+		 * may share a single CIAReader.
 		 *
 		 * @param ciaReader		[in] CIAReader. (for CIAs only)
 		 * @param media_unit_shift	[in] Media unit shift.
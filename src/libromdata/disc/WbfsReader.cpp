@@ -12,8 +12,13 @@
 #include "libwbfs.h"
 
 // librpbase, librpfile
+#include "librpfile/SplitFile.hpp"
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
+using LibRpFile::SplitFile;
+
+// C++ STL classes.
+using std::vector;
 
 namespace LibRomData {
 
@@ -30,8 +35,18 @@ class WbfsReaderPrivate : public SparseDiscReaderPrivate {
 		// WBFS structs.
 		wbfs_t *m_wbfs;			// WBFS image.
 		wbfs_disc_t *m_wbfs_disc;	// Current disc.
+		unsigned int discIdx;		// Current disc index.
 
-		const be16_t *wlba_table;	// Pointer to m_wbfs_disc->disc->header->wlba_table.
+		// WBFS block table for the current disc.
+		// Converted from m_wbfs_disc->header->wlba_table
+		// to host-endian when the disc is opened.
+		ao::uvector<uint16_t> wlba_table;
+
+		/**
+		 * Initialize the WbfsReader.
+		 * Called by the constructors.
+		 */
+		void init(void);
 
 		/** WBFS functions. **/
 
@@ -72,6 +87,13 @@ class WbfsReaderPrivate : public SparseDiscReaderPrivate {
 		 * @return Non-sparse size, in bytes.
 		 */
 		off64_t getWbfsDiscSize(const wbfs_disc_t *disc) const;
+
+		/**
+		 * Count the number of discs in a WBFS image.
+		 * @param p wbfs_t struct.
+		 * @return Number of discs.
+		 */
+		static unsigned int countWbfsDiscs(const wbfs_t *p);
 };
 
 /** WbfsReaderPrivate **/
@@ -80,7 +102,7 @@ WbfsReaderPrivate::WbfsReaderPrivate(WbfsReader *q)
 	: super(q)
 	, m_wbfs(nullptr)
 	, m_wbfs_disc(nullptr)
-	, wlba_table(nullptr)
+	, discIdx(0)
 { }
 
 WbfsReaderPrivate::~WbfsReaderPrivate()
@@ -93,6 +115,46 @@ WbfsReaderPrivate::~WbfsReaderPrivate()
 	}
 }
 
+/**
+ * Initialize the WbfsReader.
+ * Called by the constructors.
+ */
+void WbfsReaderPrivate::init(void)
+{
+	RP_Q(WbfsReader);
+	if (!q->m_file) {
+		// File could not be ref()'d.
+		return;
+	}
+
+	// Read the WBFS header.
+	m_wbfs = readWbfsHeader();
+	if (!m_wbfs) {
+		// Error reading the WBFS header.
+		UNREF_AND_NULL_NOCHK(q->m_file);
+		q->m_lastError = EIO;
+		return;
+	}
+
+	// Open the specified disc.
+	m_wbfs_disc = openWbfsDisc(m_wbfs, discIdx);
+	if (!m_wbfs_disc) {
+		// Error opening the WBFS disc.
+		freeWbfsHeader(m_wbfs);
+		m_wbfs = nullptr;
+		UNREF_AND_NULL_NOCHK(q->m_file);
+		q->m_lastError = EIO;
+		return;
+	}
+
+	// Save important values for later.
+	block_size = m_wbfs->wbfs_sec_sz;
+	pos = 0;	// Reset the read position.
+
+	// Get the size of the WBFS disc.
+	disc_size = getWbfsDiscSize(m_wbfs_disc);
+}
+
 // from libwbfs.c
 // TODO: Optimize this?
 static inline uint8_t size_to_shift(uint32_t size)
@@ -274,10 +336,14 @@ wbfs_disc_t *WbfsReaderPrivate::openWbfsDisc(wbfs_t *p, uint32_t index)
 					return nullptr;
 				}
 
-				// TODO: Byteswap wlba_table[] here?
-				// Removes unnecessary byteswaps when reading,
-				// but may not be necessary if we're not reading
-				// the entire disc.
+				// Byteswap wlba_table[] to host-endian once here,
+				// since getPhysBlockAddr() is called for every block.
+				const unsigned int n_wlba = p->n_wbfs_sec_per_disc;
+				wlba_table.resize(n_wlba);
+				const be16_t *const src = disc->header->wlba_table;
+				for (unsigned int j = 0; j < n_wlba; j++) {
+					wlba_table[j] = be16_to_cpu(src[j]);
+				}
 
 				// Disc information read successfully.
 				p->n_disc_open++;
@@ -322,7 +388,7 @@ off64_t WbfsReaderPrivate::getWbfsDiscSize(const wbfs_disc_t *disc) const
 	const wbfs_t *const p = disc->p;
 	int lastBlock = p->n_wbfs_sec_per_disc - 1;
 	for (; lastBlock >= 0; lastBlock--) {
-		if (wlba_table[lastBlock] != cpu_to_be16(0))
+		if (wlba_table[lastBlock] != 0)
 			break;
 	}
 
@@ -330,44 +396,79 @@ off64_t WbfsReaderPrivate::getWbfsDiscSize(const wbfs_disc_t *disc) const
 	return (static_cast<off64_t>(lastBlock) + 1) * static_cast<off64_t>(p->wbfs_sec_sz);
 }
 
+/**
+ * Count the number of discs in a WBFS image.
+ * @param p wbfs_t struct.
+ * @return Number of discs.
+ */
+unsigned int WbfsReaderPrivate::countWbfsDiscs(const wbfs_t *p)
+{
+	const wbfs_head_t *const head = p->head;
+	unsigned int count = 0;
+	for (uint32_t i = 0; i < p->max_disc; i++) {
+		if (head->disc_table[i]) {
+			count++;
+		}
+	}
+	return count;
+}
+
 /** WbfsReader **/
 
-WbfsReader::WbfsReader(IRpFile *file)
+/**
+ * Construct a WbfsReader with the specified file.
+ * The file is ref()'d, so the original file can be
+ * unref()'d by the caller afterwards.
+ * @param file File to read from.
+ * @param discIdx Disc index within the WBFS partition.
+ */
+WbfsReader::WbfsReader(IRpFile *file, unsigned int discIdx)
 	: super(new WbfsReaderPrivate(this), file)
 {
-	if (!m_file) {
-		// File could not be ref()'d.
-		return;
-	}
+	RP_D(WbfsReader);
+	d->discIdx = discIdx;
+	d->init();
+}
 
-	// Read the WBFS header.
+/**
+ * Construct a WbfsReader with a split WBFS image.
+ * (.wbfs, .wbf1, .wbf2, ...)
+ * The files are ref()'d, so the original files can be
+ * unref()'d by the caller afterwards.
+ *
+ * The first file must contain the WBFS header.
+ * The remaining files are concatenated in order using SplitFile.
+ *
+ * @param files Files to read from, in order.
+ * @param discIdx Disc index within the WBFS partition.
+ */
+WbfsReader::WbfsReader(const vector<IRpFile*> &files, unsigned int discIdx)
+	: super(new WbfsReaderPrivate(this), nullptr)
+{
 	RP_D(WbfsReader);
-	d->m_wbfs = d->readWbfsHeader();
-	if (!d->m_wbfs) {
-		// Error reading the WBFS header.
-		UNREF_AND_NULL_NOCHK(m_file);
-		m_lastError = EIO;
+	d->discIdx = discIdx;
+	if (files.empty()) {
+		// No files...
+		m_lastError = EBADF;
 		return;
 	}
 
-	// Open the first disc.
-	d->m_wbfs_disc = d->openWbfsDisc(d->m_wbfs, 0);
-	if (!d->m_wbfs_disc) {
-		// Error opening the WBFS disc.
-		d->freeWbfsHeader(d->m_wbfs);
-		d->m_wbfs = nullptr;
-		UNREF_AND_NULL_NOCHK(m_file);
-		m_lastError = EIO;
-		return;
+	if (files.size() == 1) {
+		// Single-file WBFS image.
+		m_file = files[0]->ref();
+	} else {
+		// Split WBFS image.
+		SplitFile *const splitFile = new SplitFile(files);
+		if (!splitFile->isOpen()) {
+			// Unable to open the split file.
+			m_lastError = splitFile->lastError();
+			splitFile->unref();
+			return;
+		}
+		m_file = splitFile;
 	}
 
-	// Save important values for later.
-	d->wlba_table = d->m_wbfs_disc->header->wlba_table;
-	d->block_size = d->m_wbfs->wbfs_sec_sz;
-	d->pos = 0;	// Reset the read position.
-
-	// Get the size of the WBFS disc.
-	d->disc_size = d->getWbfsDiscSize(d->m_wbfs_disc);
+	d->init();
 }
 
 /**
@@ -410,6 +511,34 @@ int WbfsReader::isDiscSupported(const uint8_t *pHeader, size_t szHeader) const
 	return isDiscSupported_static(pHeader, szHeader);
 }
 
+/** WBFS partition functions. **/
+
+/**
+ * Get the number of discs in the WBFS partition.
+ * This can be used to enumerate all discs by creating
+ * a WbfsReader for each disc index.
+ * @return Number of discs, or 0 on error.
+ */
+unsigned int WbfsReader::discCount(void) const
+{
+	RP_D(const WbfsReader);
+	if (!d->m_wbfs) {
+		// WBFS header wasn't loaded.
+		return 0;
+	}
+	return d->countWbfsDiscs(d->m_wbfs);
+}
+
+/**
+ * Get the index of the currently-opened disc.
+ * @return Disc index.
+ */
+unsigned int WbfsReader::discIndex(void) const
+{
+	RP_D(const WbfsReader);
+	return d->discIdx;
+}
+
 /** SparseDiscReader functions. **/
 
 /**
@@ -429,7 +558,7 @@ off64_t WbfsReader::getPhysBlockAddr(uint32_t blockIdx) const
 	}
 
 	// Get the physical block index.
-	const unsigned int physBlockIdx = be16_to_cpu(d->wlba_table[blockIdx]);
+	const unsigned int physBlockIdx = d->wlba_table[blockIdx];
 	if (physBlockIdx == 0) {
 		// Empty block.
 		return 0;
@@ -11,6 +11,9 @@
 
 #include "librpbase/disc/SparseDiscReader.hpp"
 
+// C++ includes.
+#include <vector>
+
 namespace LibRomData {
 
 class WbfsReaderPrivate;
@@ -22,8 +25,23 @@ class WbfsReader : public LibRpBase::SparseDiscReader
 		 * The file is ref()'d, so the original file can be
 		 * unref()'d by the caller afterwards.
 		 * @param file File to read from.
+		 * @param discIdx Disc index within the WBFS partition.
+		 */
+		explicit WbfsReader(LibRpFile::IRpFile *file, unsigned int discIdx = 0);
+
+		/**
+		 * Construct a WbfsReader with a split WBFS image.
+		 * (.wbfs, .wbf1, .wbf2, ...)
+		 * The files are ref()'d, so the original files can be
+		 * unref()'d by the caller afterwards.
+		 *
+		 * The first file must contain the WBFS header.
+		 * The remaining files are concatenated in order using SplitFile.
+		 *
+		 * @param files Files to read from, in order.
+		 * @param discIdx Disc index within the WBFS partition.
 		 */
-		explicit WbfsReader(LibRpFile::IRpFile *file);
+		explicit WbfsReader(const std::vector<LibRpFile::IRpFile*> &files, unsigned int discIdx = 0);
 
 	private:
 		typedef SparseDiscReader super;
@@ -52,6 +70,23 @@ class WbfsReader : public LibRpBase::SparseDiscReader
 		ATTR_ACCESS_SIZE(read_only, 2, 3)
 		int isDiscSupported(const uint8_t *pHeader, size_t szHeader) const final;
 
+	public:
+		/** WBFS partition functions. **/
+
+		/**
+		 * Get the number of discs in the WBFS partition.
+		 * This can be used to enumerate all discs by creating
+		 * a WbfsReader for each disc index.
+		 * @return Number of discs, or 0 on error.
+		 */
+		unsigned int discCount(void) const;
+
+		/**
+		 * Get the index of the currently-opened disc.
+		 * @return Disc index.
+		 */
+		unsigned int discIndex(void) const;
+
 	protected:
 		/** SparseDiscReader functions. **/
 
@@ -42,6 +42,17 @@ class WuxReaderPrivate : public SparseDiscReaderPrivate {
 		// Data start position.
 		// Starts immediately after the index table.
 		off64_t dataOffset;
+
+		// Physical block cache.
+		// .wux deduplicates blocks, so many logical blocks may
+		// map to the same physical block. (e.g. zero-filled areas)
+		// This is a direct-mapped cache indexed by physical block index.
+		// If the block size is too large, the cache is disabled.
+		static const unsigned int BLOCK_CACHE_SIZE = 256*1024;
+		static const unsigned int BLOCK_CACHE_BLOCK_SIZE_MAX = 1024*1024;
+		static const unsigned int BLOCK_CACHE_SLOTS_MAX = 16;
+		ao::uvector<uint8_t> blockCache;
+		ao::uvector<uint32_t> blockCacheTags;	// Physical block index per slot.
 };
 
 /** WuxReaderPrivate **/
@@ -126,6 +137,19 @@ WuxReader::WuxReader(IRpFile *file)
 	d->dataOffset = sizeof(d->wuxHeader) + (idxTbl_count * sizeof(uint32_t));
 	d->dataOffset = ALIGN_BYTES(d->block_size, d->dataOffset);
 
+	// Initialize the physical block cache.
+	if (d->block_size <= WuxReaderPrivate::BLOCK_CACHE_BLOCK_SIZE_MAX) {
+		unsigned int slots = WuxReaderPrivate::BLOCK_CACHE_SIZE / d->block_size;
+		if (slots == 0) {
+			slots = 1;
+		} else if (slots > WuxReaderPrivate::BLOCK_CACHE_SLOTS_MAX) {
+			slots = WuxReaderPrivate::BLOCK_CACHE_SLOTS_MAX;
+		}
+		d->blockCache.resize(static_cast<size_t>(slots) * d->block_size);
+		d->blockCacheTags.resize(slots);
+		std::fill(d->blockCacheTags.begin(), d->blockCacheTags.end(), ~0U);
+	}
+
 	// Reset the disc position.
 	d->pos = 0;
 }
@@ -205,4 +229,78 @@ off64_t WuxReader::getPhysBlockAddr(uint32_t blockIdx) const
 	return d->dataOffset + (static_cast<off64_t>(physBlockIdx) * d->block_size);
 }
 
+/**
+ * Read the specified block.
+ *
+ * This can read either a full block or a partial block.
+ * For a full block, set pos = 0 and size = block_size.
+ *
+ * @param blockIdx	[in] Block index.
+ * @param pos		[in] Starting position. (Must be >= 0 and <= the block size!)
+ * @param ptr		[out] Output data buffer.
+ * @param size		[in] Amount of data to read, in bytes. (Must be <= the block size!)
+ * @return Number of bytes read, or -1 if the block index is invalid.
+ */
+int WuxReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
+{
+	// Read 'size' bytes of block 'blockIdx', starting at 'pos'.
+	// NOTE: This can only be called by SparseDiscReader,
+	// so the main assertions are already checked there.
+	RP_D(WuxReader);
+	if (d->blockCacheTags.empty()) {
+		// Physical block cache is disabled.
+		return super::readBlock(blockIdx, pos, ptr, size);
+	}
+
+	assert(pos >= 0 && pos < (int)d->block_size);
+	assert(size <= d->block_size);
+	// TODO: Make sure overflow doesn't occur.
+	assert(static_cast<off64_t>(pos + size) <= static_cast<off64_t>(d->block_size));
+	if (pos < 0 || static_cast<off64_t>(pos + size) > static_cast<off64_t>(d->block_size)) {
+		// pos+size is out of range.
+		return -1;
+	}
+
+	if (unlikely(size == 0)) {
+		// Nothing to read.
+		return 0;
+	}
+
+	// Make sure the block index is in range.
+	assert(blockIdx < d->idxTbl.size());
+	if (blockIdx >= d->idxTbl.size()) {
+		// Out of range.
+		return -1;
+	}
+
+	// Check the cache slot for this physical block.
+	const uint32_t physBlockIdx = le32_to_cpu(d->idxTbl[blockIdx]);
+	const unsigned int slot = physBlockIdx % static_cast<unsigned int>(d->blockCacheTags.size());
+	uint8_t *const pCache = &d->blockCache[static_cast<size_t>(slot) * d->block_size];
+	if (d->blockCacheTags[slot] == physBlockIdx) {
+		// Block is cached.
+		memcpy(ptr, &pCache[pos], size);
+		return static_cast<int>(size);
+	}
+
+	// Read the entire physical block into the cache.
+	const off64_t physBlockAddr = d->dataOffset + (static_cast<off64_t>(physBlockIdx) * d->block_size);
+	const size_t sz_read = m_file->seekAndRead(physBlockAddr, pCache, d->block_size);
+	m_lastError = m_file->lastError();
+	if (sz_read != d->block_size) {
+		// Short read. This might be the last block in the file.
+		// Don't cache it, but return the data if it's available.
+		d->blockCacheTags[slot] = ~0U;
+		if (sz_read < pos + size) {
+			// Requested data isn't available.
+			return -1;
+		}
+	} else {
+		d->blockCacheTags[slot] = physBlockIdx;
+	}
+
+	memcpy(ptr, &pCache[pos], size);
+	return static_cast<int>(size);
+}
+
 }
@@ -49,9 +49,16 @@ TCreateThumbnail<ImgClass>::~TCreateThumbnail()
 
 /**
  * Get an internal image.
+ *
+ * If the RomData object has a smaller version of the image
+ * that is at least req_size (e.g. a texture mipmap), that
+ * version will be returned instead of the full image.
+ *
  * @param romData	[in] RomData object.
  * @param imageType	[in] Image type.
+ * @param req_size	[in] Requested image size.
  * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size.
+ * @param pFullSize	[out,opt] Pointer to ImgSize to store the full image size if a smaller version was returned; otherwise, 0x0.
  * @param sBIT		[out,opt] sBIT metadata.
  * @return Internal image, or null ImgClass on error.
  */
@@ -59,7 +66,9 @@ template<typename ImgClass>
 ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 	const RomData *romData,
 	RomData::ImageType imageType,
+	int req_size,
 	ImgSize *pOutSize,
+	ImgSize *pFullSize,
 	rp_image::sBIT_t *sBIT)
 {
 	assert(imageType >= RomData::IMG_INT_MIN && imageType <= RomData::IMG_INT_MAX);
@@ -71,7 +80,8 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 		return getNullImgClass();
 	}
 
-	const rp_image *image = romData->image(imageType);
+	int fullSize[2] = {0, 0};
+	const rp_image *image = romData->imageForSize(imageType, req_size, req_size, fullSize);
 	if (!image) {
 		// No image.
 		if (sBIT) {
@@ -80,8 +90,22 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 		return getNullImgClass();
 	}
 
+	// If the image is larger than the requested size, scale it down.
+	rp_image *const scaled_img = scaleDownToReqSize(image, req_size, romData->imgpf(imageType));
+	if (scaled_img) {
+		if (fullSize[0] <= image->width() && fullSize[1] <= image->height()) {
+			// The original image is the full image.
+			fullSize[0] = image->width();
+			fullSize[1] = image->height();
+		}
+	}
+
 	// Convert the rp_image to ImgClass.
-	ImgClass ret_img = rpImageToImgClass(image);
+	const rp_image *const conv_img = (scaled_img ? scaled_img : image);
+	const int conv_width = conv_img->width();
+	const int conv_height = conv_img->height();
+	ImgClass ret_img = rpImageToImgClass(conv_img);
+	UNREF(scaled_img);
 	if (isImgClassValid(ret_img)) {
 		// Image converted successfully.
 		if (pOutSize) {
@@ -92,6 +116,16 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 			// TODO: Check for errors?
 			getImgClassSize(ret_img, pOutSize);
 		}
+		if (pFullSize) {
+			// Check if a smaller version of the image was returned.
+			if (fullSize[0] > conv_width || fullSize[1] > conv_height) {
+				pFullSize->width = fullSize[0];
+				pFullSize->height = fullSize[1];
+			} else {
+				pFullSize->width = 0;
+				pFullSize->height = 0;
+			}
+		}
 		if (sBIT) {
 			// Get the sBIT metadata.
 			if (image->get_sBIT(sBIT) != 0) {
@@ -110,6 +144,7 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
  * @param imageType	[in] Image type.
  * @param req_size	[in] Requested image size.
  * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size.
+ * @param pFullSize	[out,opt] Pointer to ImgSize to store the full image size if the image was scaled down; otherwise, 0x0.
  * @param sBIT		[out,opt] sBIT metadata.
  * @return External image, or null ImgClass on error.
  */
@@ -117,6 +152,7 @@ template<typename ImgClass>
 ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
 	const RomData *romData, RomData::ImageType imageType,
 	int req_size, ImgSize *pOutSize,
+	ImgSize *pFullSize,
 	rp_image::sBIT_t *sBIT)
 {
 	assert(imageType >= RomData::IMG_EXT_MIN && imageType <= RomData::IMG_EXT_MAX);
@@ -145,6 +181,13 @@ ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
 	const bool extImgDownloadEnabled = config->extImgDownloadEnabled();
 	const bool downloadHighResScans = config->downloadHighResScans();
 
+	// JPEG images can be decoded at a reduced size if they're
+	// larger than the requested size. This doesn't work with
+	// 8:7 aspect ratio correction, since getThumbnail() needs
+	// the original image width.
+	const uint32_t imgpf = romData->imgpf(imageType);
+	const int load_size = (imgpf & RomData::IMGPF_RESCALE_ASPECT_8to7) ? 0 : req_size;
+
 	CacheManager cache;
 	const auto extURLs_cend = extURLs.cend();
 	for (auto iter = extURLs.cbegin(); iter != extURLs_cend; ++iter) {
@@ -179,17 +222,31 @@ ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
 		// Attempt to load the image.
 		unique_RefBase<RpFile> file(new RpFile(cache_filename, RpFile::FM_OPEN_READ));
 		if (file->isOpen()) {
-			rp_image *const dl_img = RpImageLoader::load(file.get());
+			int dl_fullSize[2];
+			rp_image *const dl_img = RpImageLoader::load(file.get(), load_size, dl_fullSize);
 			if (dl_img && dl_img->isValid()) {
 				// Image loaded successfully.
 				file->close();
-				ImgClass ret_img = rpImageToImgClass(dl_img);
+
+				// If the image is larger than the requested size, scale it down.
+				rp_image *const scaled_img = scaleDownToReqSize(dl_img, req_size, imgpf);
+				const rp_image *const conv_img = (scaled_img ? scaled_img : dl_img);
+				ImgClass ret_img = rpImageToImgClass(conv_img);
 				if (isImgClassValid(ret_img)) {
 					// Image converted successfully.
 					if (pOutSize) {
 						// Get the image size.
-						pOutSize->width = dl_img->width();
-						pOutSize->height = dl_img->height();
+						pOutSize->width = conv_img->width();
+						pOutSize->height = conv_img->height();
+					}
+					if (pFullSize) {
+						// Report the original size if the image was scaled down,
+						// either by the image loader or by scaleDownToReqSize().
+						const bool is_scaled = (scaled_img ||
+							dl_fullSize[0] != dl_img->width() ||
+							dl_fullSize[1] != dl_img->height());
+						pFullSize->width = (is_scaled ? dl_fullSize[0] : 0);
+						pFullSize->height = (is_scaled ? dl_fullSize[1] : 0);
 					}
 					// Get the sBIT metadata.
 					if (sBIT) {
@@ -200,8 +257,11 @@ ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
 						}
 					}
 					// TODO: Transparency processing?
+					UNREF(scaled_img);
+					dl_img->unref();
 					return ret_img;
 				}
+				UNREF(scaled_img);
 			}
 			UNREF(dl_img);
 		}
@@ -242,6 +302,43 @@ inline void TCreateThumbnail<ImgClass>::rescale_aspect(ImgSize &rs_size, const I
 	}
 }
 
+/**
+ * Scale an rp_image down if it's larger than the requested size.
+ * The aspect ratio is maintained.
+ * @param img		[in] rp_image.
+ * @param req_size	[in] Requested image size.
+ * @param imgpf		[in] Image processing flags.
+ * @return Scaled rp_image, or nullptr if scaling isn't needed or failed.
+ */
+template<typename ImgClass>
+rp_image *TCreateThumbnail<ImgClass>::scaleDownToReqSize(const rp_image *img, int req_size, uint32_t imgpf)
+{
+	if (req_size <= 0 || (img->width() <= req_size && img->height() <= req_size)) {
+		// Image is already small enough.
+		return nullptr;
+	}
+	if (imgpf & RomData::IMGPF_RESCALE_ASPECT_8to7) {
+		// getThumbnail() checks the original width
+		// for 8:7 aspect ratio correction.
+		return nullptr;
+	}
+
+	ImgSize sz = {img->width(), img->height()};
+	const ImgSize tgt_size = {req_size, req_size};
+	rescale_aspect(sz, tgt_size);
+	if (sz.width <= 0 || sz.height <= 0) {
+		// Unable to rescale. (e.g. 1x4096 image)
+		return nullptr;
+	}
+
+	// Pixel art uses a box filter to keep edges sharp.
+	// Everything else uses Lanczos.
+	const rp_image::ScaleFilter filter = (imgpf & RomData::IMGPF_RESCALE_NEAREST)
+		? rp_image::ScaleFilter::Box
+		: rp_image::ScaleFilter::Lanczos;
+	return img->scaled(sz.width, sz.height, filter);
+}
+
 /**
  * Create a thumbnail for the specified ROM file.
  * @param romData	[in] RomData object.
@@ -271,6 +368,11 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomData *romData, int reqSize
 	uint32_t imgbf = romData->supportedImageTypes();
 	uint32_t imgpf = 0;
 
+	// Original image size, if a smaller version of
+	// an internal image (e.g. a mipmap) was used,
+	// or if the image was scaled down.
+	ImgSize origSize = {0, 0};
+
 	// Get the image priority.
 	const Config *const config = Config::instance();
 	Config::ImgTypePrio_t imgTypePrio;
@@ -296,7 +398,8 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomData *romData, int reqSize
 		// Check for an icon first.
 		// TODO: Define "small sizes" somewhere. (DPI independence?)
 		if (imgbf & RomData::IMGBF_INT_ICON) {
-			pOutParams->retImg = getInternalImage(romData, RomData::IMG_INT_ICON, &pOutParams->fullSize, &pOutParams->sBIT);
+			pOutParams->retImg = getInternalImage(romData, RomData::IMG_INT_ICON, reqSize,
+				&pOutParams->fullSize, &origSize, &pOutParams->sBIT);
 			imgpf = romData->imgpf(RomData::IMG_INT_ICON);
 			imgbf &= ~RomData::IMGBF_INT_ICON;
 
@@ -328,11 +431,13 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomData *romData, int reqSize
 		// This image may be present.
 		if (imgType <= RomData::IMG_INT_MAX) {
 			// Internal image.
-			pOutParams->retImg = getInternalImage(romData, imgType, &pOutParams->fullSize, &pOutParams->sBIT);
+			pOutParams->retImg = getInternalImage(romData, imgType, reqSize,
+				&pOutParams->fullSize, &origSize, &pOutParams->sBIT);
 			imgpf = romData->imgpf(imgType);
 		} else {
 			// External image.
-			pOutParams->retImg = getExternalImage(romData, imgType, reqSize, &pOutParams->fullSize, &pOutParams->sBIT);
+			pOutParams->retImg = getExternalImage(romData, imgType, reqSize,
+				&pOutParams->fullSize, &origSize, &pOutParams->sBIT);
 			imgpf = romData->imgpf(imgType);
 		}
 
@@ -381,7 +486,8 @@ skip_image_check:
 		}
 	}
 
-	// TODO: If image is larger than req_size, resize down.
+	// NOTE: Images larger than reqSize were already scaled
+	// down by getInternalImage() or getExternalImage().
 	if (imgpf & RomData::IMGPF_RESCALE_NEAREST) {
 		// TODO: User configuration.
 		ResizeNearestUpPolicy resize_up = RESIZE_UP_HALF;
@@ -443,6 +549,12 @@ skip_image_check:
 		pOutParams->thumbSize = pOutParams->fullSize;
 	}
 
+	if (origSize.width > 0 && origSize.height > 0) {
+		// A smaller version of the image was used.
+		// Report the original image size.
+		pOutParams->fullSize = origSize;
+	}
+
 	// Image retrieved successfully.
 	return RPCT_SUCCESS;
 }
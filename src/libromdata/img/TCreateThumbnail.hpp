@@ -104,15 +104,26 @@ class TCreateThumbnail
 
 		/**
 		 * Get an internal image.
+		 *
+		 * If the RomData object has a smaller version of the image
+		 * that is at least req_size (e.g. a texture mipmap), that
+		 * version will be returned instead of the full image.
+		 *
+		 * If the image is still larger than req_size, it will be
+		 * scaled down to fit within req_size.
+		 *
 		 * @param romData	[in] RomData object.
 		 * @param imageType	[in] Image type.
+		 * @param req_size	[in] Requested image size.
 		 * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size.
+		 * @param pFullSize	[out,opt] Pointer to ImgSize to store the full image size if a smaller version was returned; otherwise, 0x0.
 		 * @param sBIT		[out,opt] sBIT metadata.
 		 * @return Internal image, or null ImgClass on error.
 		 */
 		ImgClass getInternalImage(const LibRpBase::RomData *romData,
 			LibRpBase::RomData::ImageType imageType,
-			ImgSize *pOutSize = nullptr,
+			int req_size, ImgSize *pOutSize = nullptr,
+			ImgSize *pFullSize = nullptr,
 			LibRpTexture::rp_image::sBIT_t *sBIT = nullptr);
 
 		/**
@@ -121,12 +132,14 @@ class TCreateThumbnail
 		 * @param imageType	[in] Image type.
 		 * @param req_size	[in] Requested image size.
 		 * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size.
+		 * @param pFullSize	[out,opt] Pointer to ImgSize to store the full image size if the image was scaled down; otherwise, 0x0.
 		 * @param sBIT		[out,opt] sBIT metadata.
 		 * @return External image, or null ImgClass on error.
 		 */
 		ImgClass getExternalImage(
 			const LibRpBase::RomData *romData, LibRpBase::RomData::ImageType imageType,
 			int req_size, ImgSize *pOutSize = nullptr,
+			ImgSize *pFullSize = nullptr,
 			LibRpTexture::rp_image::sBIT_t *sBIT = nullptr);
 
 		/**
@@ -175,6 +188,16 @@ class TCreateThumbnail
 		 */
 		static inline void rescale_aspect(ImgSize &rs_size, const ImgSize &tgt_size);
 
+		/**
+		 * Scale an rp_image down if it's larger than the requested size.
+		 * The aspect ratio is maintained.
+		 * @param img		[in] rp_image.
+		 * @param req_size	[in] Requested image size.
+		 * @param imgpf		[in] Image processing flags.
+		 * @return Scaled rp_image, or nullptr if scaling isn't needed or failed.
+		 */
+		static LibRpTexture::rp_image *scaleDownToReqSize(const LibRpTexture::rp_image *img, int req_size, uint32_t imgpf);
+
 	protected:
 		/** Pure virtual functions. **/
 
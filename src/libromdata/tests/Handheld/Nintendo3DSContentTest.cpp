@@ -0,0 +1,236 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * Nintendo3DSContentTest.cpp: Nintendo 3DS CIA content lookup test.       *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase, librpfile
+#include "librpbase/config.librpbase.h"
+#include "librpbase/TextFuncs.hpp"
+#include "librpfile/RpMemFile.hpp"
+using LibRpFile::RpMemFile;
+
+// libromdata
+#include "Handheld/Nintendo3DS.hpp"
+#include "Handheld/Nintendo3DS_p.hpp"
+#include "disc/CIAReader.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+namespace LibRomData { namespace Tests {
+
+class Nintendo3DSContentTest : public ::testing::Test
+{
+	protected:
+		Nintendo3DSContentTest()
+			: d(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+		/**
+		 * Add a NoCrypto CIAReader to the CIAReader cache.
+		 * @param rec Content chunk record number.
+		 * @return CIAReader.
+		 */
+		CIAReader *addNoCryptoCIAReader(unsigned int rec);
+
+	public:
+		// Content data. This isn't actually decrypted.
+		uint8_t m_data[4096];
+
+		// Nintendo3DSPrivate is used directly so the
+		// content index can be set up without a full CIA.
+		Nintendo3DSPrivate *d;
+};
+
+void Nintendo3DSContentTest::SetUp(void)
+{
+	memset(m_data, 0x5A, sizeof(m_data));
+	RpMemFile *const memFile = new RpMemFile(m_data, sizeof(m_data));
+	d = new Nintendo3DSPrivate(nullptr, memFile);
+	memFile->unref();
+	d->romType = Nintendo3DSPrivate::RomType::CIA;
+
+	// Content chunk records.
+	// Records 2 and 3 have content indexes that
+	// don't match their record numbers.
+	static const struct {
+		uint16_t index;
+		bool encrypted;
+	} records[] = {
+		{0, true},
+		{1, false},
+		{5, true},
+		{2, true},
+	};
+
+	d->content_index.resize(ARRAY_SIZE(records));
+	for (unsigned int i = 0; i < ARRAY_SIZE(records); i++) {
+		Nintendo3DSPrivate::content_index_t &content = d->content_index[i];
+		content.offset = i * 1024;
+		content.length = 1024;
+		content.index = records[i].index;
+		content.encrypted = records[i].encrypted;
+		content.ciaReaderFailed = false;
+	}
+}
+
+void Nintendo3DSContentTest::TearDown(void)
+{
+	delete d;
+	d = nullptr;
+}
+
+/**
+ * Add a NoCrypto CIAReader to the CIAReader cache.
+ * @param rec Content chunk record number.
+ * @return CIAReader.
+ */
+CIAReader *Nintendo3DSContentTest::addNoCryptoCIAReader(unsigned int rec)
+{
+	const Nintendo3DSPrivate::content_index_t &content = d->content_index[rec];
+	d->ciaReaders.resize(d->content_index.size());
+	d->ciaReaders[rec] = new CIAReader(d->file,
+		content.offset, content.length, nullptr, content.index);
+	return d->ciaReaders[rec];
+}
+
+/**
+ * Look up contents by TMD content index.
+ */
+TEST_F(Nintendo3DSContentTest, findContent)
+{
+	EXPECT_EQ(0, d->findContent(0));
+	EXPECT_EQ(1, d->findContent(1));
+	EXPECT_EQ(2, d->findContent(5));
+	EXPECT_EQ(3, d->findContent(2));
+
+	// Content indexes that aren't present.
+	EXPECT_EQ(-1, d->findContent(3));
+	EXPECT_EQ(-1, d->findContent(4));
+	EXPECT_EQ(-1, d->findContent(-1));
+	EXPECT_EQ(-1, d->findContent(0x10000));
+}
+
+/**
+ * getCIAReader() doesn't create CIAReaders for
+ * unencrypted contents or invalid record numbers.
+ */
+TEST_F(Nintendo3DSContentTest, getCIAReader_noReader)
+{
+	EXPECT_EQ(nullptr, d->getCIAReader(1));
+	EXPECT_FALSE(d->content_index[1].ciaReaderFailed);
+	EXPECT_EQ(nullptr, d->getCIAReader(4));
+	EXPECT_EQ(nullptr, d->getCIAReader(~0U));
+}
+
+/**
+ * getCIAReader() returns the same shared CIAReader for each call.
+ *
+ * NOTE: Opening a CIAReader for an encrypted content loads keys.conf,
+ * which isn't permitted by the test sandbox, so NoCrypto CIAReaders
+ * are added to the cache directly.
+ */
+TEST_F(Nintendo3DSContentTest, getCIAReader_shared)
+{
+	CIAReader *const ciaReader = addNoCryptoCIAReader(0);
+	ASSERT_TRUE(ciaReader->isOpen());
+
+	for (unsigned int i = 0; i < 3; i++) {
+		EXPECT_EQ(ciaReader, d->getCIAReader(0));
+	}
+	EXPECT_FALSE(d->content_index[0].ciaReaderFailed);
+
+	// The shared CIAReader reads the content data.
+	uint8_t buf[16];
+	EXPECT_EQ(sizeof(buf), ciaReader->seekAndRead(0, buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, m_data, sizeof(buf)));
+}
+
+/**
+ * Look up a shared CIAReader by TMD content index.
+ */
+TEST_F(Nintendo3DSContentTest, getCIAReader_byContentIndex)
+{
+	CIAReader *const ciaReader0 = addNoCryptoCIAReader(0);
+	CIAReader *const ciaReader2 = addNoCryptoCIAReader(2);
+	CIAReader *const ciaReader3 = addNoCryptoCIAReader(3);
+
+	// Content index 5 is record 2.
+	int rec = d->findContent(5);
+	ASSERT_EQ(2, rec);
+	EXPECT_EQ(ciaReader2, d->getCIAReader(static_cast<unsigned int>(rec)));
+
+	// Content index 2 is record 3.
+	rec = d->findContent(2);
+	ASSERT_EQ(3, rec);
+	EXPECT_EQ(ciaReader3, d->getCIAReader(static_cast<unsigned int>(rec)));
+
+	// Content index 0 is record 0.
+	rec = d->findContent(0);
+	ASSERT_EQ(0, rec);
+	EXPECT_EQ(ciaReader0, d->getCIAReader(static_cast<unsigned int>(rec)));
+}
+
+/**
+ * getCIAReader() doesn't retry a CIAReader that couldn't be opened.
+ */
+TEST_F(Nintendo3DSContentTest, getCIAReader_cachedFailure)
+{
+	d->content_index[0].ciaReaderFailed = true;
+	for (unsigned int i = 0; i < 3; i++) {
+		EXPECT_EQ(nullptr, d->getCIAReader(0));
+	}
+
+	// A new CIAReader must not have been created.
+	if (!d->ciaReaders.empty()) {
+		EXPECT_EQ(nullptr, d->ciaReaders[0]);
+	}
+}
+
+#ifndef ENABLE_DECRYPTION
+/**
+ * Without decryption support, CIAReaders for encrypted
+ * contents can't be opened. The failure is cached.
+ */
+TEST_F(Nintendo3DSContentTest, getCIAReader_failedOpen)
+{
+	// Content index 5 is record 2.
+	const int rec = d->findContent(5);
+	ASSERT_EQ(2, rec);
+	EXPECT_EQ(nullptr, d->getCIAReader(static_cast<unsigned int>(rec)));
+	EXPECT_TRUE(d->content_index[2].ciaReaderFailed);
+	ASSERT_EQ(d->content_index.size(), d->ciaReaders.size());
+	EXPECT_EQ(nullptr, d->ciaReaders[2]);
+
+	// Other contents have not been opened yet.
+	EXPECT_FALSE(d->content_index[0].ciaReaderFailed);
+	EXPECT_FALSE(d->content_index[3].ciaReaderFailed);
+
+	// The cached failure is returned on subsequent calls.
+	EXPECT_EQ(nullptr, d->getCIAReader(2));
+	EXPECT_TRUE(d->content_index[2].ciaReaderFailed);
+}
+#endif /* !ENABLE_DECRYPTION */
+
+} }
+
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: Nintendo3DS content tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
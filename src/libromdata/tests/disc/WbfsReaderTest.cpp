@@ -0,0 +1,222 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * WbfsReaderTest.cpp: WbfsReader test.                                    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// libromdata
+#include "disc/WbfsReader.hpp"
+#include "disc/libwbfs.h"
+
+// librpcpu, librpfile
+#include "librpcpu/byteswap.h"
+#include "librpfile/RpMemFile.hpp"
+using LibRpFile::IRpFile;
+using LibRpFile::RpMemFile;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+// uvector
+#include "uvector.h"
+
+namespace LibRomData { namespace Tests {
+
+/**
+ * Test image layout:
+ * - 512-byte HDD sectors, 512 KB WBFS blocks.
+ * - Disc table: slot 0 is used, slot 1 is empty, slot 2 is used.
+ *   Hence, disc index 1 is stored in slot 2.
+ * - Disc 0: 1 block, physical block 1.
+ * - Disc 1: 2 blocks, physical blocks 2 and 3.
+ *
+ * For split images, the .wbf1 part starts in the middle of
+ * physical block 2, so disc 1's first block spans both parts.
+ */
+class WbfsReaderTest : public ::testing::Test
+{
+	protected:
+		WbfsReaderTest() { }
+
+	public:
+		static const unsigned int HD_SEC_SZ_S = 9;		// 512 bytes
+		static const unsigned int WBFS_SEC_SZ_S = 19;		// 512 KB
+		static const unsigned int WBFS_SEC_SZ = (1U << WBFS_SEC_SZ_S);
+		static const unsigned int N_PHYS_BLOCKS = 4;
+		static const unsigned int SPLIT_POS = (2 * WBFS_SEC_SZ) + (WBFS_SEC_SZ / 2);
+
+		// Size of a wbfs_disc_info_t for this image.
+		// (0x100 + n_wbfs_sec_per_disc*2, aligned to the HDD sector size)
+		static const unsigned int DISC_INFO_SZ = 36352;
+
+		void SetUp(void) final;
+
+		/**
+		 * Expected byte at the specified physical address.
+		 * @param addr Physical address.
+		 * @return Expected byte.
+		 */
+		static inline uint8_t physByte(unsigned int addr)
+		{
+			return static_cast<uint8_t>((addr * 0x9E3779B1U) >> 24);
+		}
+
+		/**
+		 * Check data read from a disc.
+		 * @param wlba	[in] Physical block table for the disc.
+		 * @param buf	[in] Data.
+		 * @param pos	[in] Logical offset within the disc.
+		 * @param size	[in] Size of buf.
+		 */
+		static void checkData(const vector<unsigned int> &wlba,
+			const uint8_t *buf, unsigned int pos, size_t size);
+
+	public:
+		ao::uvector<uint8_t> m_img;
+};
+
+void WbfsReaderTest::SetUp(void)
+{
+	m_img.resize(N_PHYS_BLOCKS * WBFS_SEC_SZ);
+	for (unsigned int i = 0; i < m_img.size(); i++) {
+		m_img[i] = physByte(i);
+	}
+
+	// Physical block 0 contains the WBFS header and the disc table.
+	memset(m_img.data(), 0, WBFS_SEC_SZ);
+	wbfs_head_t *const head = reinterpret_cast<wbfs_head_t*>(m_img.data());
+	head->magic = cpu_to_be32(WBFS_MAGIC);
+	head->n_hd_sec = cpu_to_be32(0x8000 * 8);
+	head->hd_sec_sz_s = HD_SEC_SZ_S;
+	head->wbfs_sec_sz_s = WBFS_SEC_SZ_S;
+	head->disc_table[0] = 1;
+	head->disc_table[1] = 0;
+	head->disc_table[2] = 1;
+
+	// Disc info for slot 0.
+	uint8_t *p = &m_img[(1U << HD_SEC_SZ_S) + (0 * DISC_INFO_SZ)];
+	wbfs_disc_info_t *discInfo = reinterpret_cast<wbfs_disc_info_t*>(p);
+	discInfo->wlba_table[0] = cpu_to_be16(1);
+
+	// Disc info for slot 2.
+	p = &m_img[(1U << HD_SEC_SZ_S) + (2 * DISC_INFO_SZ)];
+	discInfo = reinterpret_cast<wbfs_disc_info_t*>(p);
+	discInfo->wlba_table[0] = cpu_to_be16(2);
+	discInfo->wlba_table[1] = cpu_to_be16(3);
+}
+
+/**
+ * Check data read from a disc.
+ * @param wlba	[in] Physical block table for the disc.
+ * @param buf	[in] Data.
+ * @param pos	[in] Logical offset within the disc.
+ * @param size	[in] Size of buf.
+ */
+void WbfsReaderTest::checkData(const vector<unsigned int> &wlba,
+	const uint8_t *buf, unsigned int pos, size_t size)
+{
+	for (size_t i = 0; i < size; i++, pos++) {
+		const unsigned int physAddr = (wlba[pos >> WBFS_SEC_SZ_S] << WBFS_SEC_SZ_S) |
+			(pos & (WBFS_SEC_SZ - 1));
+		ASSERT_EQ(physByte(physAddr), buf[i]) << "at logical offset " << pos;
+	}
+}
+
+/**
+ * Open the first disc in a single-file WBFS image.
+ */
+TEST_F(WbfsReaderTest, singleFileDisc0)
+{
+	RpMemFile *const memFile = new RpMemFile(m_img.data(), m_img.size());
+	WbfsReader *const wbfs = new WbfsReader(memFile);
+	memFile->unref();
+	ASSERT_TRUE(wbfs->isOpen());
+
+	EXPECT_EQ(2U, wbfs->discCount());
+	EXPECT_EQ(0U, wbfs->discIndex());
+	EXPECT_EQ(static_cast<off64_t>(WBFS_SEC_SZ), wbfs->size());
+
+	const vector<unsigned int> wlba = {1};
+	uint8_t buf[256];
+	EXPECT_EQ(sizeof(buf), wbfs->seekAndRead(WBFS_SEC_SZ - 1000, buf, sizeof(buf)));
+	checkData(wlba, buf, WBFS_SEC_SZ - 1000, sizeof(buf));
+
+	wbfs->unref();
+}
+
+/**
+ * Open the second disc in a .wbfs/.wbf1 image.
+ * The second disc is stored in disc table slot 2,
+ * since slot 1 is empty.
+ */
+TEST_F(WbfsReaderTest, splitFileDisc1)
+{
+	vector<IRpFile*> files;
+	files.push_back(new RpMemFile(m_img.data(), SPLIT_POS));
+	files.push_back(new RpMemFile(&m_img[SPLIT_POS], m_img.size() - SPLIT_POS));
+	WbfsReader *const wbfs = new WbfsReader(files, 1);
+	for (IRpFile *file : files) {
+		file->unref();
+	}
+	ASSERT_TRUE(wbfs->isOpen());
+
+	EXPECT_EQ(2U, wbfs->discCount());
+	EXPECT_EQ(1U, wbfs->discIndex());
+	EXPECT_EQ(static_cast<off64_t>(WBFS_SEC_SZ * 2), wbfs->size());
+
+	const vector<unsigned int> wlba = {2, 3};
+	ao::uvector<uint8_t> buf(WBFS_SEC_SZ * 2);
+
+	// Read the entire disc.
+	EXPECT_EQ(buf.size(), wbfs->seekAndRead(0, buf.data(), buf.size()));
+	checkData(wlba, buf.data(), 0, buf.size());
+
+	// Read across the .wbfs/.wbf1 boundary.
+	const unsigned int splitLogical = SPLIT_POS - (2 * WBFS_SEC_SZ);
+	memset(buf.data(), 0, buf.size());
+	EXPECT_EQ(1024U, wbfs->seekAndRead(splitLogical - 512, buf.data(), 1024));
+	checkData(wlba, buf.data(), splitLogical - 512, 1024);
+
+	// Read across the WBFS block boundary.
+	memset(buf.data(), 0, buf.size());
+	EXPECT_EQ(1024U, wbfs->seekAndRead(WBFS_SEC_SZ - 512, buf.data(), 1024));
+	checkData(wlba, buf.data(), WBFS_SEC_SZ - 512, 1024);
+
+	wbfs->unref();
+}
+
+/**
+ * Attempt to open a disc index that isn't present.
+ */
+TEST_F(WbfsReaderTest, invalidDiscIndex)
+{
+	RpMemFile *const memFile = new RpMemFile(m_img.data(), m_img.size());
+	WbfsReader *const wbfs = new WbfsReader(memFile, 2);
+	memFile->unref();
+	EXPECT_FALSE(wbfs->isOpen());
+	EXPECT_EQ(0U, wbfs->discCount());
+	wbfs->unref();
+}
+
+} }
+
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: WbfsReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
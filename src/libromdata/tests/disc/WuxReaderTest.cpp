@@ -0,0 +1,333 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * WuxReaderTest.cpp: WuxReader physical block cache test.                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// libromdata
+#include "disc/WuxReader.hpp"
+#include "disc/wux_structs.h"
+
+// librpcpu, librpfile
+#include "librpcpu/byteswap.h"
+#include "librpfile/RpMemFile.hpp"
+using LibRpFile::IRpFile;
+using LibRpFile::RpMemFile;
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+using std::string;
+
+// uvector
+#include "uvector.h"
+
+namespace LibRomData { namespace Tests {
+
+/**
+ * IRpFile wrapper that counts read() calls.
+ * This is used to determine if the physical block cache was used.
+ */
+class CountingFile : public IRpFile
+{
+	public:
+		explicit CountingFile(IRpFile *file)
+			: m_file(file->ref())
+			, m_readCount(0)
+		{ }
+	protected:
+		virtual ~CountingFile()
+		{
+			UNREF(m_file);
+		}
+
+	private:
+		typedef IRpFile super;
+		RP_DISABLE_COPY(CountingFile)
+
+	public:
+		bool isOpen(void) const final
+		{
+			return (m_file && m_file->isOpen());
+		}
+
+		void close(void) final
+		{
+			UNREF_AND_NULL(m_file);
+		}
+
+		size_t read(void *ptr, size_t size) final
+		{
+			m_readCount++;
+			size_t ret = m_file->read(ptr, size);
+			m_lastError = m_file->lastError();
+			return ret;
+		}
+
+		size_t write(const void *ptr, size_t size) final
+		{
+			RP_UNUSED(ptr);
+			RP_UNUSED(size);
+			m_lastError = EBADF;
+			return 0;
+		}
+
+		int seek(off64_t pos) final
+		{
+			int ret = m_file->seek(pos);
+			m_lastError = m_file->lastError();
+			return ret;
+		}
+
+		off64_t tell(void) final
+		{
+			return m_file->tell();
+		}
+
+		int truncate(off64_t size) final
+		{
+			RP_UNUSED(size);
+			m_lastError = ENOTSUP;
+			return -1;
+		}
+
+		off64_t size(void) final
+		{
+			return m_file->size();
+		}
+
+		string filename(void) const final
+		{
+			return m_file->filename();
+		}
+
+	public:
+		/**
+		 * Get the number of read() calls.
+		 * @return Number of read() calls.
+		 */
+		unsigned int readCount(void) const
+		{
+			return m_readCount;
+		}
+
+	private:
+		IRpFile *m_file;
+		unsigned int m_readCount;
+};
+
+/**
+ * Test image layout:
+ * - 4 KB blocks. WuxReader uses 16 cache slots for this block size,
+ *   and the slot is the physical block index modulo 16.
+ * - Logical blocks 0-7 are deduplicated to physical block 0.
+ * - Logical blocks 8-31 map to physical blocks 1-24, so physical
+ *   blocks 1 and 17 use the same cache slot.
+ */
+class WuxReaderTest : public ::testing::Test
+{
+	protected:
+		WuxReaderTest()
+			: m_countingFile(nullptr)
+			, m_wux(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		static const unsigned int BLOCK_SIZE = 4096;
+		static const unsigned int LOGICAL_BLOCKS = 32;
+		static const unsigned int PHYS_BLOCKS = 25;
+		static const unsigned int CACHE_SLOTS = 16;
+
+		/**
+		 * Get the physical block index for a logical block.
+		 * @param blockIdx Logical block index.
+		 * @return Physical block index.
+		 */
+		static inline unsigned int physBlock(unsigned int blockIdx)
+		{
+			return (blockIdx < 8 ? 0 : blockIdx - 7);
+		}
+
+		/**
+		 * Expected byte at the specified position within a physical block.
+		 * @param physIdx Physical block index.
+		 * @param pos Position within the block.
+		 * @return Expected byte.
+		 */
+		static inline uint8_t physByte(unsigned int physIdx, unsigned int pos)
+		{
+			return static_cast<uint8_t>(((physIdx * BLOCK_SIZE + pos) * 0x9E3779B1U) >> 24);
+		}
+
+		/**
+		 * Read data from the WuxReader and check it.
+		 * @param pos Logical disc position.
+		 * @param size Size to read.
+		 */
+		void checkRead(unsigned int pos, size_t size);
+
+		/**
+		 * Get the number of read() calls on the underlying file
+		 * since the WuxReader was opened.
+		 * @return Number of read() calls.
+		 */
+		unsigned int fileReads(void) const
+		{
+			return m_countingFile->readCount() - m_readCountBase;
+		}
+
+	public:
+		ao::uvector<uint8_t> m_img;
+		CountingFile *m_countingFile;
+		unsigned int m_readCountBase;
+		WuxReader *m_wux;
+};
+
+void WuxReaderTest::SetUp(void)
+{
+	// Index table starts after the header.
+	// Data starts at the next block boundary.
+	static const unsigned int dataOffset = BLOCK_SIZE;
+	static_assert(sizeof(wuxHeader_t) + (LOGICAL_BLOCKS * sizeof(uint32_t)) <= dataOffset,
+		"Header and index table are too big.");
+
+	m_img.resize(dataOffset + (PHYS_BLOCKS * BLOCK_SIZE));
+	memset(m_img.data(), 0, dataOffset);
+
+	wuxHeader_t *const wuxHeader = reinterpret_cast<wuxHeader_t*>(m_img.data());
+	wuxHeader->magic[0] = cpu_to_le32(WUX_MAGIC_0);
+	wuxHeader->magic[1] = cpu_to_le32(WUX_MAGIC_1);
+	wuxHeader->sectorSize = cpu_to_le32(BLOCK_SIZE);
+	wuxHeader->uncompressedSize = cpu_to_le64(static_cast<uint64_t>(LOGICAL_BLOCKS) * BLOCK_SIZE);
+
+	uint32_t *const idxTbl = reinterpret_cast<uint32_t*>(&m_img[sizeof(wuxHeader_t)]);
+	for (unsigned int i = 0; i < LOGICAL_BLOCKS; i++) {
+		idxTbl[i] = cpu_to_le32(physBlock(i));
+	}
+
+	uint8_t *p = &m_img[dataOffset];
+	for (unsigned int phys = 0; phys < PHYS_BLOCKS; phys++) {
+		for (unsigned int i = 0; i < BLOCK_SIZE; i++, p++) {
+			*p = physByte(phys, i);
+		}
+	}
+
+	RpMemFile *const memFile = new RpMemFile(m_img.data(), m_img.size());
+	m_countingFile = new CountingFile(memFile);
+	memFile->unref();
+	m_wux = new WuxReader(m_countingFile);
+	ASSERT_TRUE(m_wux->isOpen());
+	m_readCountBase = m_countingFile->readCount();
+}
+
+void WuxReaderTest::TearDown(void)
+{
+	UNREF_AND_NULL(m_wux);
+	UNREF_AND_NULL(m_countingFile);
+}
+
+/**
+ * Read data from the WuxReader and check it.
+ * @param pos Logical disc position.
+ * @param size Size to read.
+ */
+void WuxReaderTest::checkRead(unsigned int pos, size_t size)
+{
+	ao::uvector<uint8_t> buf(size);
+	ASSERT_EQ(size, m_wux->seekAndRead(pos, buf.data(), size));
+	for (size_t i = 0; i < size; i++, pos++) {
+		const uint8_t expected = physByte(physBlock(pos / BLOCK_SIZE), pos % BLOCK_SIZE);
+		ASSERT_EQ(expected, buf[i]) << "at logical offset " << pos;
+	}
+}
+
+/**
+ * Deduplicated blocks are only read from the file once.
+ */
+TEST_F(WuxReaderTest, cacheHits)
+{
+	// Logical blocks 0-7 all map to physical block 0.
+	checkRead(0, BLOCK_SIZE);
+	EXPECT_EQ(1U, fileReads());
+	for (unsigned int i = 1; i < 8; i++) {
+		checkRead(i * BLOCK_SIZE, BLOCK_SIZE);
+	}
+	EXPECT_EQ(1U, fileReads());
+
+	// Partial block reads also use the cache.
+	checkRead((3 * BLOCK_SIZE) + 100, 200);
+	EXPECT_EQ(1U, fileReads());
+}
+
+/**
+ * Blocks that share a cache slot evict each other.
+ */
+TEST_F(WuxReaderTest, cacheEvictions)
+{
+	// Physical blocks 1 and 17 share a cache slot.
+	static const unsigned int blockA = 8;	// physical block 1
+	static const unsigned int blockB = 24;	// physical block 17
+	ASSERT_EQ(physBlock(blockA) % CACHE_SLOTS, physBlock(blockB) % CACHE_SLOTS);
+
+	checkRead(blockA * BLOCK_SIZE, 16);
+	EXPECT_EQ(1U, fileReads());
+	checkRead(blockB * BLOCK_SIZE, 16);
+	EXPECT_EQ(2U, fileReads());
+
+	// Block A was evicted.
+	checkRead(blockA * BLOCK_SIZE, 16);
+	EXPECT_EQ(3U, fileReads());
+	// Block A is cached again.
+	checkRead((blockA * BLOCK_SIZE) + 16, 16);
+	EXPECT_EQ(3U, fileReads());
+
+	// A block in a different slot doesn't evict block A.
+	checkRead((blockA + 1) * BLOCK_SIZE, 16);
+	EXPECT_EQ(4U, fileReads());
+	checkRead((blockA * BLOCK_SIZE) + 32, 16);
+	EXPECT_EQ(4U, fileReads());
+}
+
+/**
+ * Reads that span multiple blocks.
+ */
+TEST_F(WuxReaderTest, spanningReads)
+{
+	// Unaligned start and end, spanning the deduplicated
+	// blocks and the first non-deduplicated blocks.
+	checkRead((6 * BLOCK_SIZE) + 123, (4 * BLOCK_SIZE) + 456);
+	// Physical blocks 0, 1, 2, 3
+	EXPECT_EQ(4U, fileReads());
+
+	// Same range again: all blocks are cached.
+	checkRead((6 * BLOCK_SIZE) + 123, (4 * BLOCK_SIZE) + 456);
+	EXPECT_EQ(4U, fileReads());
+
+	// Entire disc.
+	checkRead(0, LOGICAL_BLOCKS * BLOCK_SIZE);
+}
+
+} }
+
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: WuxReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,765 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * ImageDecoderBenchmark.cpp: ImageDecoder benchmark.                      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "config.librptexture.h"
+
+// zlib
+#include <zlib.h>
+
+// gzclose_r() and gzclose_w() were introduced in zlib-1.2.4.
+#if (ZLIB_VER_MAJOR > 1) || \
+    (ZLIB_VER_MAJOR == 1 && ZLIB_VER_MINOR > 2) || \
+    (ZLIB_VER_MAJOR == 1 && ZLIB_VER_MINOR == 2 && ZLIB_VER_REVISION >= 4)
+// zlib-1.2.4 or later
+#else
+#define gzclose_r(file) gzclose(file)
+#define gzclose_w(file) gzclose(file)
+#endif
+
+// librpfile
+#include "common.h"
+#include "librpfile/RpMemFile.hpp"
+using LibRpFile::RpMemFile;
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/decoder/ImageDecoder.hpp"
+#include "librptexture/fileformat/FileFormat.hpp"
+#include "librptexture/FileFormatFactory.hpp"
+using namespace LibRpTexture;
+
+// librpsecure
+#include "librpsecure/os-secure.h"
+
+// Pseudo-random test data. (shared with ImageDecoderTest)
+#include "librpbase/tests/PseudoRandom.hpp"
+using LibRpBase::Tests::fillPseudoRandom;
+using LibRpBase::Tests::fixBC7Modes;
+
+// C includes.
+#include <stdint.h>
+#include <stdlib.h>
+#ifndef _WIN32
+# include <dirent.h>
+#endif /* !_WIN32 */
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+#ifdef _WIN32
+# include "libwin32common/RpWin32_sdk.h"
+#endif /* _WIN32 */
+
+/**
+ * Output format.
+ */
+enum class OutputFormat {
+	JSON,
+	CSV,
+};
+
+/**
+ * Benchmark options.
+ */
+struct BenchmarkOptions {
+	OutputFormat format;	// Output format
+	string data_dir;	// ImageDecoder_data directory
+	string filter;		// Only run benchmarks whose name contains this string
+	unsigned int min_time_ms;	// Minimum time per benchmark, in milliseconds
+	int size;		// Width and height of synthetic images
+	bool fileformat;	// Run the FileFormat benchmarks
+	bool decoder;		// Run the ImageDecoder function benchmarks
+};
+
+/**
+ * Benchmark result.
+ */
+struct BenchmarkResult {
+	const char *section;	// "fileformat" or "decoder"
+	string name;		// Corpus filename or ImageDecoder function name
+	string format;		// Texture format and/or pixel format
+	const char *isa;	// ISA variant ("dispatch" for FileFormat benchmarks)
+	int width;
+	int height;
+	unsigned int iterations;
+	double ns_per_pixel;	// Nanoseconds per decoded pixel
+	double mib_per_s;	// Decoded output (4 bytes per pixel), in MiB/s
+};
+
+/**
+ * Run a decode function repeatedly until the minimum time has elapsed.
+ * One untimed iteration is run first to warm up caches and lookup tables.
+ * @param fn		[in] Decode function. Returns an rp_image, or nullptr on error.
+ * @param min_time_ms	[in] Minimum time, in milliseconds.
+ * @param result	[out] Benchmark result. (width, height, iterations, timings)
+ * @return True on success; false if the decode function failed.
+ */
+static bool runBenchmark(const std::function<const rp_image*(void)> &fn,
+	unsigned int min_time_ms, BenchmarkResult &result)
+{
+	typedef std::chrono::steady_clock clock;
+
+	// Warm-up iteration.
+	const rp_image *img = fn();
+	if (!img) {
+		return false;
+	}
+	result.width = img->width();
+	result.height = img->height();
+	img->unref();
+
+	const clock::duration min_time = std::chrono::milliseconds(min_time_ms);
+	const clock::time_point start = clock::now();
+	clock::duration elapsed;
+	unsigned int iterations = 0;
+	do {
+		img = fn();
+		if (!img) {
+			return false;
+		}
+		img->unref();
+		iterations++;
+		elapsed = clock::now() - start;
+	} while (elapsed < min_time);
+
+	const double ns = static_cast<double>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+	const double pixels = static_cast<double>(result.width) * result.height * iterations;
+	result.iterations = iterations;
+	result.ns_per_pixel = ns / pixels;
+	result.mib_per_s = (pixels * 4.0 / (1024.0 * 1024.0)) / (ns / 1e9);
+	return true;
+}
+
+/** FileFormat benchmarks **/
+
+/**
+ * Recursively list all files in a directory.
+ * @param dir		[in] Directory.
+ * @param prefix	[in] Prefix for returned filenames. (relative to the top-level directory)
+ * @param files		[out] Filenames, relative to the top-level directory.
+ */
+static void listFiles(const string &dir, const string &prefix, vector<string> &files)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA ffd;
+	HANDLE hFind = FindFirstFileA((dir + "\\*").c_str(), &ffd);
+	if (hFind == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	do {
+		const char *const name = ffd.cFileName;
+		if (name[0] == '.') {
+			continue;
+		}
+		if (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			listFiles(dir + '\\' + name, prefix + name + '/', files);
+		} else {
+			files.push_back(prefix + name);
+		}
+	} while (FindNextFileA(hFind, &ffd));
+	FindClose(hFind);
+#else /* !_WIN32 */
+	DIR *const pdir = opendir(dir.c_str());
+	if (!pdir) {
+		return;
+	}
+	const struct dirent *d;
+	while ((d = readdir(pdir)) != nullptr) {
+		const char *const name = d->d_name;
+		if (name[0] == '.') {
+			continue;
+		}
+		const string path = dir + '/' + name;
+		DIR *const psubdir = opendir(path.c_str());
+		if (psubdir) {
+			closedir(psubdir);
+			listFiles(path, prefix + name + '/', files);
+		} else {
+			files.push_back(prefix + name);
+		}
+	}
+	closedir(pdir);
+#endif /* _WIN32 */
+}
+
+/**
+ * Load a file into memory, decompressing it if it's gzipped.
+ * @param filename	[in] Filename.
+ * @param buf		[out] File data.
+ * @return True on success; false on error.
+ */
+static bool loadFile(const string &filename, vector<uint8_t> &buf)
+{
+	// NOTE: gzread() reads uncompressed files as-is.
+	gzFile gz = gzopen(filename.c_str(), "rb");
+	if (!gz) {
+		return false;
+	}
+
+	buf.clear();
+	uint8_t tmp[32768];
+	int sz_read;
+	while ((sz_read = gzread(gz, tmp, sizeof(tmp))) > 0) {
+		buf.insert(buf.end(), tmp, tmp + sz_read);
+	}
+	gzclose_r(gz);
+	return (sz_read == 0 && !buf.empty());
+}
+
+/**
+ * Run FileFormat benchmarks over the ImageDecoder_data corpus.
+ * Files that aren't handled by FileFormatFactory (e.g. reference
+ * PNGs and RomData-only formats) are skipped.
+ * @param opts		[in] Options.
+ * @param results	[out] Results.
+ * @return 0 on success; non-zero if the corpus could not be read.
+ */
+static int benchmarkFileFormats(const BenchmarkOptions &opts, vector<BenchmarkResult> &results)
+{
+	vector<string> files;
+	listFiles(opts.data_dir, string(), files);
+	if (files.empty()) {
+		fprintf(stderr, "*** ERROR: No files found in '%s'.\n", opts.data_dir.c_str());
+		return 1;
+	}
+	std::sort(files.begin(), files.end());
+
+	vector<uint8_t> buf;
+	for (const string &file : files) {
+		if (file.size() >= 4 && !file.compare(file.size()-4, 4, ".png")) {
+			// Reference image.
+			continue;
+		}
+		if (!opts.filter.empty() && file.find(opts.filter) == string::npos) {
+			continue;
+		}
+		if (!loadFile(opts.data_dir + '/' + file, buf)) {
+			fprintf(stderr, "*** WARNING: Unable to read '%s'.\n", file.c_str());
+			continue;
+		}
+
+		// Check if FileFormatFactory can handle this file.
+		RpMemFile *const memFile = new RpMemFile(buf.data(), buf.size());
+		FileFormat *fileFormat = FileFormatFactory::create(memFile);
+		if (!fileFormat) {
+			memFile->unref();
+			continue;
+		}
+
+		BenchmarkResult result;
+		result.section = "fileformat";
+		result.name = file;
+		result.format = fileFormat->textureFormatName();
+		const char *const pxf = fileFormat->pixelFormat();
+		if (pxf) {
+			result.format += ' ';
+			result.format += pxf;
+		}
+		result.isa = "dispatch";
+		fileFormat->unref();
+
+		// NOTE: FileFormat caches the decoded image, so we
+		// have to recreate the FileFormat every time.
+		bool ok = runBenchmark([memFile]() -> const rp_image* {
+			FileFormat *const fileFormat = FileFormatFactory::create(memFile);
+			if (!fileFormat) {
+				return nullptr;
+			}
+			const rp_image *const img = fileFormat->image();
+			const rp_image *const ret = (img ? img->ref() : nullptr);
+			fileFormat->unref();
+			return ret;
+		}, opts.min_time_ms, result);
+		memFile->unref();
+
+		if (!ok) {
+			fprintf(stderr, "*** WARNING: Unable to decode '%s'.\n", file.c_str());
+			continue;
+		}
+		results.push_back(std::move(result));
+	}
+
+	return 0;
+}
+
+/** ImageDecoder function benchmarks **/
+
+/**
+ * ImageDecoder function benchmark.
+ */
+struct DecoderBenchmark {
+	const char *name;	// Function name, without the ISA suffix
+	const char *format;	// Pixel format, if applicable
+	const char *isa;	// ISA variant
+	std::function<const rp_image*(void)> fn;
+};
+
+/**
+ * Is the specified ISA variant supported by the host CPU?
+ * @param isa ISA variant.
+ * @return True if supported; false if not.
+ */
+static bool isIsaSupported(const char *isa)
+{
+	if (!strcmp(isa, "cpp")) {
+		return true;
+	}
+#if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
+	if (!strcmp(isa, "sse2")) {
+		return !!RP_CPU_HasSSE2();
+	} else if (!strcmp(isa, "ssse3")) {
+		return !!RP_CPU_HasSSSE3();
+	} else if (!strcmp(isa, "sse41")) {
+		return !!RP_CPU_HasSSE41();
+	} else if (!strcmp(isa, "avx2")) {
+		return !!RP_CPU_HasAVX2();
+	} else if (!strcmp(isa, "bmi2")) {
+		return !!RP_CPU_HasBMI2();
+	}
+#endif /* RP_CPU_I386 || RP_CPU_AMD64 */
+	return false;
+}
+
+/**
+ * Synthetic image data for the ImageDecoder function benchmarks.
+ * Filled with deterministic pseudo-random data so every
+ * ISA variant decodes exactly the same input.
+ */
+struct SyntheticData {
+	int w, h;
+	vector<uint8_t> img;	// w*h*4 bytes; large enough for any format
+	vector<uint8_t> alpha;	// w*h/2 bytes (4-bit alpha)
+	vector<uint8_t> bc7;	// w*h bytes; BC7 blocks with valid modes
+	uint32_t pal[1024];	// Palette (also used as 16-bit)
+
+	explicit SyntheticData(int size)
+		: w(size), h(size)
+		, img(static_cast<size_t>(size) * size * 4)
+		, alpha(static_cast<size_t>(size) * size / 2)
+		, bc7(static_cast<size_t>(size) * size)
+	{
+		fillPseudoRandom(img.data(), img.size(), 0x12345678);
+		fillPseudoRandom(alpha.data(), alpha.size(), 0x12345679);
+		fillPseudoRandom(pal, sizeof(pal), 0x1234567A);
+
+		memcpy(bc7.data(), img.data(), bc7.size());
+		fixBC7Modes(bc7.data(), bc7.size());
+	}
+
+	inline int img_siz(void) const { return static_cast<int>(img.size()); }
+	inline const uint16_t *img16(void) const { return reinterpret_cast<const uint16_t*>(img.data()); }
+	inline const uint32_t *img32(void) const { return reinterpret_cast<const uint32_t*>(img.data()); }
+	inline const uint16_t *pal16(void) const { return reinterpret_cast<const uint16_t*>(pal); }
+};
+
+/**
+ * Get the list of ImageDecoder function benchmarks.
+ * Every ISA variant that was compiled in is listed;
+ * variants the host CPU doesn't support are filtered later.
+ * @param d Synthetic image data.
+ * @return ImageDecoder function benchmarks.
+ */
+static vector<DecoderBenchmark> getDecoderBenchmarks(const SyntheticData &d)
+{
+	vector<DecoderBenchmark> v;
+
+	// Functions with no ISA variants.
+#define GENERIC(fn, pxf, ...) \
+	v.push_back({#fn, pxf, "cpp", [&d]() { return ImageDecoder::fn(__VA_ARGS__); }})
+	// Block-compressed formats: (width, height, img_buf, img_siz)
+#define BLOCK(fn, isa) \
+	v.push_back({#fn, "", #isa, [&d]() { \
+		return ImageDecoder::fn##_##isa(d.w, d.h, d.img.data(), d.img_siz()); }})
+	// Linear formats: (px_format, width, height, img_buf, img_siz)
+#define LINEAR(fn, isa, pxf, buf) \
+	v.push_back({#fn, #pxf, #isa, [&d]() { \
+		return ImageDecoder::fn##_##isa(ImageDecoder::PXF_##pxf, d.w, d.h, buf, d.img_siz()); }})
+
+	/** Linear **/
+	GENERIC(fromLinearCI4, "RGB565", ImageDecoder::PXF_RGB565, true,
+		d.w, d.h, d.img.data(), d.img_siz(), d.pal, sizeof(d.pal));
+	GENERIC(fromLinearCI8, "RGB565", ImageDecoder::PXF_RGB565,
+		d.w, d.h, d.img.data(), d.img_siz(), d.pal, sizeof(d.pal));
+	GENERIC(fromLinearMono, "", d.w, d.h, d.img.data(), d.img_siz());
+	GENERIC(fromLinear8, "L8", ImageDecoder::PXF_L8, d.w, d.h, d.img.data(), d.img_siz());
+
+#define LINEAR16(isa) \
+	LINEAR(fromLinear16, isa, RGB565, d.img16()); \
+	LINEAR(fromLinear16, isa, ARGB1555, d.img16()); \
+	LINEAR(fromLinear16, isa, ARGB4444, d.img16())
+#define LINEAR24(isa) \
+	LINEAR(fromLinear24, isa, RGB888, d.img.data())
+#define LINEAR32(isa) \
+	LINEAR(fromLinear32, isa, ABGR8888, d.img32()); \
+	LINEAR(fromLinear32, isa, xRGB8888, d.img32())
+
+	LINEAR16(cpp);
+	LINEAR24(cpp);
+	LINEAR32(cpp);
+#ifdef IMAGEDECODER_HAS_SSE2
+	LINEAR16(sse2);
+#endif /* IMAGEDECODER_HAS_SSE2 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+	LINEAR24(ssse3);
+	LINEAR32(ssse3);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+#ifdef IMAGEDECODER_HAS_AVX2
+	LINEAR16(avx2);
+	LINEAR24(avx2);
+	LINEAR32(avx2);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+	/** GameCube **/
+#define GCN16(isa) \
+	LINEAR(fromGcn16, isa, RGB5A3, d.img16()); \
+	LINEAR(fromGcn16, isa, RGB565, d.img16()); \
+	LINEAR(fromGcn16, isa, IA8, d.img16())
+#define GCN8(isa) \
+	v.push_back({"fromGcnCI8", "RGB5A3", #isa, [&d]() { \
+		return ImageDecoder::fromGcnCI8_##isa(d.w, d.h, d.img.data(), d.img_siz(), \
+			d.pal16(), 256*2); }}); \
+	BLOCK(fromGcnI8, isa)
+
+	GCN16(cpp);
+	GCN8(cpp);
+#ifdef IMAGEDECODER_HAS_SSSE3
+	GCN16(ssse3);
+	GCN8(ssse3);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+#ifdef IMAGEDECODER_HAS_AVX2
+	GCN16(avx2);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+	/** Nintendo DS / 3DS **/
+	GENERIC(fromNDS_CI4, "BGR555", d.w, d.h, d.img.data(), d.img_siz(), d.pal16(), 16*2);
+	GENERIC(fromN3DSTiledRGB565, "RGB565", d.w, d.h, d.img16(), d.img_siz());
+	GENERIC(fromN3DSTiledRGB565_A4, "RGB565_A4", d.w, d.h, d.img16(), d.img_siz(),
+		d.alpha.data(), static_cast<int>(d.alpha.size()));
+
+	/** S3TC / BC4 / BC5 **/
+#define S3TC(isa) \
+	BLOCK(fromDXT1_GCN, isa); \
+	BLOCK(fromDXT1, isa); \
+	BLOCK(fromDXT1_A1, isa); \
+	BLOCK(fromDXT3, isa); \
+	BLOCK(fromDXT5, isa); \
+	BLOCK(fromBC4, isa); \
+	BLOCK(fromBC5, isa)
+
+	S3TC(cpp);
+#ifdef IMAGEDECODER_HAS_SSSE3
+	S3TC(ssse3);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+#ifdef IMAGEDECODER_HAS_AVX2
+	S3TC(avx2);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+	GENERIC(fromDXT2, "", d.w, d.h, d.img.data(), d.img_siz());
+	GENERIC(fromDXT4, "", d.w, d.h, d.img.data(), d.img_siz());
+
+	/** Dreamcast **/
+#define DREAMCAST_VQ(isa) \
+	v.push_back({"fromDreamcastVQ16", "ARGB1555", #isa, [&d]() { \
+		return ImageDecoder::fromDreamcastVQ16_##isa(ImageDecoder::PXF_ARGB1555, false, false, \
+			d.w, d.h, d.img.data(), d.img_siz(), d.pal16(), 1024*2); }})
+#define DREAMCAST(isa) \
+	LINEAR(fromDreamcastSquareTwiddled16, isa, ARGB1555, d.img16()); \
+	DREAMCAST_VQ(isa)
+
+	DREAMCAST(cpp);
+#ifdef IMAGEDECODER_HAS_SSE2
+	DREAMCAST(sse2);
+#endif /* IMAGEDECODER_HAS_SSE2 */
+#ifdef IMAGEDECODER_HAS_BMI2
+	// NOTE: VQ doesn't have a BMI2 version.
+	LINEAR(fromDreamcastSquareTwiddled16, bmi2, ARGB1555, d.img16());
+#endif /* IMAGEDECODER_HAS_BMI2 */
+
+	/** ETC1 / ETC2 **/
+#define ETC(isa) \
+	BLOCK(fromETC1, isa); \
+	BLOCK(fromETC2_RGB, isa); \
+	BLOCK(fromETC2_RGBA, isa); \
+	BLOCK(fromETC2_RGB_A1, isa)
+
+	ETC(cpp);
+#ifdef IMAGEDECODER_HAS_SSE41
+	ETC(sse41);
+#endif /* IMAGEDECODER_HAS_SSE41 */
+
+	/** PVRTC **/
+#ifdef ENABLE_PVRTC
+	GENERIC(fromPVRTC, "4bpp", d.w, d.h, d.img.data(), d.img_siz(),
+		ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES);
+	GENERIC(fromPVRTC, "2bpp", d.w, d.h, d.img.data(), d.img_siz(),
+		ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES);
+	GENERIC(fromPVRTCII, "4bpp", d.w, d.h, d.img.data(), d.img_siz(),
+		ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES);
+	GENERIC(fromPVRTCII, "2bpp", d.w, d.h, d.img.data(), d.img_siz(),
+		ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES);
+#endif /* ENABLE_PVRTC */
+
+	/** BC7 **/
+#define BC7(isa) \
+	v.push_back({"fromBC7", "", #isa, [&d]() { \
+		return ImageDecoder::fromBC7_##isa(d.w, d.h, d.bc7.data(), static_cast<int>(d.bc7.size())); }})
+
+	BC7(cpp);
+#ifdef IMAGEDECODER_HAS_SSSE3
+	BC7(ssse3);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+	return v;
+}
+
+/**
+ * Run ImageDecoder function benchmarks on synthetic image data.
+ * @param opts		[in] Options.
+ * @param results	[out] Results.
+ */
+static void benchmarkDecoders(const BenchmarkOptions &opts, vector<BenchmarkResult> &results)
+{
+	const SyntheticData d(opts.size);
+	for (const DecoderBenchmark &bench : getDecoderBenchmarks(d)) {
+		if (!opts.filter.empty() && !strstr(bench.name, opts.filter.c_str())) {
+			continue;
+		}
+		if (!isIsaSupported(bench.isa)) {
+			continue;
+		}
+
+		BenchmarkResult result;
+		result.section = "decoder";
+		result.name = bench.name;
+		result.format = bench.format;
+		result.isa = bench.isa;
+		if (!runBenchmark(bench.fn, opts.min_time_ms, result)) {
+			fprintf(stderr, "*** WARNING: %s_%s(%s) failed.\n", bench.name, bench.isa, bench.format);
+			continue;
+		}
+		results.push_back(std::move(result));
+	}
+}
+
+/** Output **/
+
+/**
+ * Get the host CPU's supported ISA variants.
+ * @return ISA variants.
+ */
+static vector<const char*> getCpuIsas(void)
+{
+	vector<const char*> v;
+	static const char *const isas[] = {"sse2", "ssse3", "sse41", "avx2", "bmi2"};
+	for (const char *isa : isas) {
+		if (isIsaSupported(isa)) {
+			v.push_back(isa);
+		}
+	}
+	return v;
+}
+
+/**
+ * Print a JSON string, with escaping.
+ * @param str String.
+ */
+static void printJsonString(const string &str)
+{
+	putchar('"');
+	for (const char chr : str) {
+		if (chr == '"' || chr == '\\') {
+			putchar('\\');
+			putchar(chr);
+		} else if (static_cast<unsigned char>(chr) < 0x20) {
+			printf("\\u%04X", static_cast<unsigned int>(chr));
+		} else {
+			putchar(chr);
+		}
+	}
+	putchar('"');
+}
+
+/**
+ * Print the results as JSON.
+ * @param opts		[in] Options.
+ * @param results	[in] Results.
+ */
+static void printJson(const BenchmarkOptions &opts, const vector<BenchmarkResult> &results)
+{
+	printf("{\n\t\"cpu_isas\": [");
+	const vector<const char*> isas = getCpuIsas();
+	for (size_t i = 0; i < isas.size(); i++) {
+		printf("%s\"%s\"", (i > 0 ? ", " : ""), isas[i]);
+	}
+	printf("],\n\t\"min_time_ms\": %u,\n\t\"results\": [", opts.min_time_ms);
+
+	bool first = true;
+	for (const BenchmarkResult &r : results) {
+		printf("%s\n\t\t{\"section\": \"%s\", \"name\": ", (first ? "" : ","), r.section);
+		printJsonString(r.name);
+		printf(", \"format\": ");
+		printJsonString(r.format);
+		printf(", \"isa\": \"%s\", \"width\": %d, \"height\": %d, \"iterations\": %u, "
+			"\"ns_per_pixel\": %.4f, \"mib_per_s\": %.2f}",
+			r.isa, r.width, r.height, r.iterations, r.ns_per_pixel, r.mib_per_s);
+		first = false;
+	}
+	printf("\n\t]\n}\n");
+}
+
+/**
+ * Print a CSV field, quoting it if necessary.
+ * @param str String.
+ */
+static void printCsvString(const string &str)
+{
+	if (str.find_first_of(",\"\n") == string::npos) {
+		fputs(str.c_str(), stdout);
+		return;
+	}
+	putchar('"');
+	for (const char chr : str) {
+		if (chr == '"') {
+			putchar('"');
+		}
+		putchar(chr);
+	}
+	putchar('"');
+}
+
+/**
+ * Print the results as CSV.
+ * @param results	[in] Results.
+ */
+static void printCsv(const vector<BenchmarkResult> &results)
+{
+	puts("section,name,format,isa,width,height,iterations,ns_per_pixel,mib_per_s");
+	for (const BenchmarkResult &r : results) {
+		printf("%s,", r.section);
+		printCsvString(r.name);
+		putchar(',');
+		printCsvString(r.format);
+		printf(",%s,%d,%d,%u,%.4f,%.2f\n",
+			r.isa, r.width, r.height, r.iterations, r.ns_per_pixel, r.mib_per_s);
+	}
+}
+
+/**
+ * Print the program syntax.
+ * @param argv0 Program name.
+ */
+static void printSyntax(const char *argv0)
+{
+	fprintf(stderr,
+		"Syntax: %s [options]\n"
+		"\n"
+		"Options:\n"
+		"  --format=json|csv    Output format. (default is json)\n"
+		"  --data-dir=DIR       ImageDecoder_data directory. (default is ImageDecoder_data)\n"
+		"  --filter=STRING      Only run benchmarks whose name contains STRING.\n"
+		"  --min-time=MS        Minimum time per benchmark, in milliseconds. (default is 250)\n"
+		"  --size=N             Synthetic image size for ImageDecoder functions. (default is 512)\n"
+		"  --fileformat-only    Only run the FileFormat benchmarks.\n"
+		"  --decoder-only       Only run the ImageDecoder function benchmarks.\n"
+		"\n"
+		"FileFormat benchmarks decode every texture in the ImageDecoder_data corpus\n"
+		"using the ISA variants selected by the CPU dispatcher. ImageDecoder function\n"
+		"benchmarks decode synthetic images using every ISA variant supported by the CPU.\n"
+		"Throughput is measured as decoded ARGB32 output. (4 bytes per pixel)\n",
+		argv0);
+}
+
+int RP_C_API main(int argc, char *argv[])
+{
+	// Set OS-specific security options.
+	// TODO: Non-Windows syscall stuff.
+#ifdef _WIN32
+	rp_secure_param_t param;
+	param.bHighSec = FALSE;
+	rp_secure_enable(param);
+#endif /* _WIN32 */
+
+	BenchmarkOptions opts;
+	opts.format = OutputFormat::JSON;
+	opts.data_dir = "ImageDecoder_data";
+	opts.min_time_ms = 250;
+	opts.size = 512;
+	opts.fileformat = true;
+	opts.decoder = true;
+
+	for (int i = 1; i < argc; i++) {
+		const char *const arg = argv[i];
+		if (!strcmp(arg, "--format=json")) {
+			opts.format = OutputFormat::JSON;
+		} else if (!strcmp(arg, "--format=csv")) {
+			opts.format = OutputFormat::CSV;
+		} else if (!strncmp(arg, "--data-dir=", 11)) {
+			opts.data_dir = &arg[11];
+		} else if (!strncmp(arg, "--filter=", 9)) {
+			opts.filter = &arg[9];
+		} else if (!strncmp(arg, "--min-time=", 11)) {
+			char *endptr = nullptr;
+			const long ltmp = strtol(&arg[11], &endptr, 10);
+			if (*endptr != '\0' || ltmp <= 0 || ltmp > 60000) {
+				fprintf(stderr, "*** ERROR: Invalid minimum time '%s'.\n", &arg[11]);
+				return EXIT_FAILURE;
+			}
+			opts.min_time_ms = static_cast<unsigned int>(ltmp);
+		} else if (!strncmp(arg, "--size=", 7)) {
+			// NOTE: Dreamcast twiddled images must be square and
+			// a power of two; tiled formats need multiples of 8.
+			char *endptr = nullptr;
+			const long ltmp = strtol(&arg[7], &endptr, 10);
+			if (*endptr != '\0' || ltmp < 8 || ltmp > 4096 || (ltmp & (ltmp - 1)) != 0) {
+				fprintf(stderr, "*** ERROR: Size must be a power of two from 8 to 4096.\n");
+				return EXIT_FAILURE;
+			}
+			opts.size = static_cast<int>(ltmp);
+		} else if (!strcmp(arg, "--fileformat-only")) {
+			opts.fileformat = true;
+			opts.decoder = false;
+		} else if (!strcmp(arg, "--decoder-only")) {
+			opts.fileformat = false;
+			opts.decoder = true;
+		} else {
+			printSyntax(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	vector<BenchmarkResult> results;
+	if (opts.fileformat) {
+		if (benchmarkFileFormats(opts, results) != 0) {
+			return EXIT_FAILURE;
+		}
+	}
+	if (opts.decoder) {
+		benchmarkDecoders(opts, results);
+	}
+
+	switch (opts.format) {
+		default:
+		case OutputFormat::JSON:
+			printJson(opts, results);
+			break;
+		case OutputFormat::CSV:
+			printCsv(results);
+			break;
+	}
+	return EXIT_SUCCESS;
+}
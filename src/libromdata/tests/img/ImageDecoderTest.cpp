@@ -42,6 +42,10 @@ using namespace LibRpFile;
 // librptexture
 #include "librptexture/img/rp_image.hpp"
 #include "librptexture/decoder/ImageDecoder.hpp"
+#include "librptexture/fileformat/dds_structs.h"
+#include "librptexture/fileformat/ktx_structs.h"
+#include "librptexture/fileformat/gl_defs.h"
+#include "librpcpu/byteswap.h"
 using namespace LibRpTexture;
 
 // TODO: Separate out the actual DDS texture loader
@@ -68,13 +72,20 @@ using namespace LibRpTexture;
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 using std::string;
 using std::unique_ptr;
+using std::vector;
 
 // Uninitialized vector class.
 // Reference: http://andreoffringa.org/?q=uvector
 #include "uvector.h"
 
+// Pseudo-random test data.
+#include "librpbase/tests/PseudoRandom.hpp"
+using LibRpBase::Tests::fillPseudoRandom;
+using LibRpBase::Tests::fixBC7Modes;
+
 namespace LibRomData { namespace Tests {
 
 struct ImageDecoderTest_mode
@@ -119,7 +130,6 @@ class ImageDecoderTest : public ::testing::TestWithParam<ImageDecoderTest_mode>
 	protected:
 		ImageDecoderTest()
 			: ::testing::TestWithParam<ImageDecoderTest_mode>()
-			, m_gzDds(nullptr)
 			, m_f_dds(nullptr)
 			, m_romData(nullptr)
 		{ }
@@ -148,10 +158,6 @@ class ImageDecoderTest : public ::testing::TestWithParam<ImageDecoderTest_mode>
 		ao::uvector<uint8_t> m_dds_buf;
 		ao::uvector<uint8_t> m_png_buf;
 
-		// gzip file handle for .dds.gz.
-		// Placed here so it can be freed by TearDown() if necessary.
-		gzFile m_gzDds;
-
 		// RomData class pointer for .dds.gz.
 		// Placed here so it can be freed by TearDown() if necessary.
 		// The underlying RpMemFile is here as well, since we can't
@@ -175,6 +181,15 @@ class ImageDecoderTest : public ::testing::TestWithParam<ImageDecoderTest_mode>
 		 */
 		static inline void replace_slashes(string &path);
 
+		/**
+		 * Load a test file from ImageDecoder_data/.
+		 * gzipped files are decompressed automatically.
+		 * @param filename	[in] Filename, relative to ImageDecoder_data/.
+		 * @param maxSize	[in] Maximum file size.
+		 * @param buf		[out] File data.
+		 */
+		static void loadTestFile(const string &filename, size_t maxSize, ao::uvector<uint8_t> &buf);
+
 		/**
 		 * Internal test function.
 		 */
@@ -212,6 +227,39 @@ inline void ImageDecoderTest::replace_slashes(string &path)
 #endif /* _WIN32 */
 }
 
+/**
+ * Load a test file from ImageDecoder_data/.
+ * gzipped files are decompressed automatically.
+ * @param filename	[in] Filename, relative to ImageDecoder_data/.
+ * @param maxSize	[in] Maximum file size.
+ * @param buf		[out] File data.
+ */
+void ImageDecoderTest::loadTestFile(const string &filename, size_t maxSize, ao::uvector<uint8_t> &buf)
+{
+	string path = "ImageDecoder_data";
+	path += DIR_SEP_CHR;
+	path += filename;
+	replace_slashes(path);
+	gzFile gzf = gzopen(path.c_str(), "rb");
+	ASSERT_TRUE(gzf != nullptr) << "gzopen() failed to open the test file: " << filename;
+
+	// gzseek() does not support SEEK_END, so the decompressed
+	// file size isn't known. Read the file in chunks.
+	static const size_t CHUNK_SIZE = 64*1024;
+	int sz_read;
+	buf.clear();
+	do {
+		const size_t pos = buf.size();
+		buf.resize(pos + CHUNK_SIZE);
+		sz_read = gzread(gzf, &buf[pos], static_cast<unsigned int>(CHUNK_SIZE));
+		buf.resize(pos + (sz_read > 0 ? sz_read : 0));
+	} while (sz_read > 0 && buf.size() <= maxSize);
+	gzclose_r(gzf);
+
+	ASSERT_NE(-1, sz_read) << "gzread() failed: " << filename;
+	ASSERT_LE(buf.size(), maxSize) << "Test file is too big: " << filename;
+}
+
 /**
  * SetUp() function.
  * Run before each test.
@@ -226,66 +274,15 @@ void ImageDecoderTest::SetUp(void)
 	// Parameterized test.
 	const ImageDecoderTest_mode &mode = GetParam();
 
-	// Open the gzipped DDS texture file being tested.
-	string path = "ImageDecoder_data";
-	path += DIR_SEP_CHR;
-	path += mode.dds_gz_filename;
-	replace_slashes(path);
-	m_gzDds = gzopen(path.c_str(), "rb");
-	ASSERT_TRUE(m_gzDds != nullptr) << "gzopen() failed to open the DDS file: "
-		<< mode.dds_gz_filename;
-
-	// Get the decompressed file size.
-	// gzseek() does not support SEEK_END.
-	// Read through the file until we hit an EOF.
-	// NOTE: We could optimize this by reading the uncompressed
-	// file size if gzdirect() == 1, but this is a test case,
-	// so it doesn't really matter.
-	uint8_t buf[4096];
-	uint32_t ddsSize = 0;
-	while (!gzeof(m_gzDds)) {
-		int sz_read = gzread(m_gzDds, buf, sizeof(buf));
-		ASSERT_NE(sz_read, -1) << "gzread() failed.";
-		ddsSize += sz_read;
-	}
-	gzrewind(m_gzDds);
+	// Load the texture file and the reference PNG image.
+	ASSERT_NO_FATAL_FAILURE(loadTestFile(mode.dds_gz_filename, MAX_DDS_IMAGE_FILESIZE, m_dds_buf));
+	ASSERT_NO_FATAL_FAILURE(loadTestFile(mode.png_filename, MAX_PNG_IMAGE_FILESIZE, m_png_buf));
 
 	/* FIXME: Per-type minimum sizes.
 	 * This fails on some very small SVR files.
-	ASSERT_GT(ddsSize, 4+sizeof(DDS_HEADER))
+	ASSERT_GT(m_dds_buf.size(), 4+sizeof(DDS_HEADER))
 		<< "DDS test image is too small.";
 	*/
-	ASSERT_LE(ddsSize, MAX_DDS_IMAGE_FILESIZE)
-		<< "DDS test image is too big.";
-
-	// Read the DDS image into memory.
-	m_dds_buf.resize(ddsSize);
-	ASSERT_EQ((size_t)ddsSize, m_dds_buf.size());
-	int sz = gzread(m_gzDds, m_dds_buf.data(), ddsSize);
-	gzclose_r(m_gzDds);
-	m_gzDds = nullptr;
-
-	ASSERT_EQ(ddsSize, (uint32_t)sz) << "Error loading DDS image file: " <<
-		mode.dds_gz_filename << " - short read";
-
-	// Open the PNG image file being tested.
-	path.resize(18);	// Back to "ImageDecoder_data/".
-	path += mode.png_filename;
-	replace_slashes(path);
-	unique_RefBase<RpFile> file(new RpFile(path, RpFile::FM_OPEN_READ));
-	ASSERT_TRUE(file->isOpen()) << "Error loading PNG image file: " <<
-		mode.png_filename << " - " << strerror(file->lastError());
-
-	// Maximum image size.
-	ASSERT_LE(file->size(), MAX_PNG_IMAGE_FILESIZE) << "PNG test image is too big.";
-
-	// Read the PNG image into memory.
-	const size_t pngSize = static_cast<size_t>(file->size());
-	m_png_buf.resize(pngSize);
-	ASSERT_EQ(pngSize, m_png_buf.size());
-	size_t readSize = file->read(m_png_buf.data(), pngSize);
-	ASSERT_EQ(pngSize, readSize) << "Error loading PNG image file: " <<
-		mode.png_filename << " - short read";
 }
 
 /**
@@ -296,11 +293,6 @@ void ImageDecoderTest::TearDown(void)
 {
 	UNREF_AND_NULL(m_romData);
 	UNREF_AND_NULL(m_f_dds);
-
-	if (m_gzDds) {
-		gzclose_r(m_gzDds);
-		m_gzDds = nullptr;
-	}
 }
 
 struct RpImageUnrefDeleter {
@@ -495,6 +487,34 @@ void ImageDecoderTest::decodeTest_internal(void)
 
 	// Compare the image data.
 	ASSERT_NO_FATAL_FAILURE(Compare_RpImage(img_png.get(), img_dds));
+
+	// If the image can be decoded in bands, each band
+	// must match the corresponding rows of the full image.
+	int fullSize[2];
+	const int bandHeight = m_romData->imageBandHeight(mode.imgType, fullSize);
+	if (bandHeight > 0) {
+		ASSERT_EQ(img_dds->width(), fullSize[0]);
+		ASSERT_EQ(img_dds->height(), fullSize[1]);
+		ASSERT_EQ(rp_image::Format::ARGB32, img_dds->format());
+
+		// NOTE: Using an odd number of band rows to test
+		// a partial band at the bottom of the image.
+		const int rows = bandHeight * 3;
+		const int row_bytes = img_dds->row_bytes();
+		for (int y = 0; y < fullSize[1]; y += rows) {
+			const int h = (fullSize[1] - y < rows ? fullSize[1] - y : rows);
+			unique_ptr<rp_image, RpImageUnrefDeleter> band(
+				m_romData->imageBand(mode.imgType, y, h), RpImageUnrefDeleter());
+			ASSERT_TRUE(band != nullptr) << "Could not decode the band at row " << y << '.';
+			ASSERT_EQ(rp_image::Format::ARGB32, band->format());
+			ASSERT_EQ(fullSize[0], band->width());
+			ASSERT_EQ(h, band->height());
+			for (int i = 0; i < h; i++) {
+				ASSERT_EQ(0, memcmp(img_dds->scanLine(y + i), band->scanLine(i), row_bytes))
+					<< "Band row " << (y + i) << " does not match the full image.";
+			}
+		}
+	}
 }
 
 /**
@@ -932,6 +952,15 @@ INSTANTIATE_TEST_SUITE_P(KTX2, ImageDecoderTest,
 		KTX2_IMAGE_TEST("texturearray_etc2_unorm"))
 	, ImageDecoderTest::test_case_suffix_generator);
 
+#ifdef HAVE_ZSTD
+// KTX2 tests. (Zstandard supercompression)
+INSTANTIATE_TEST_SUITE_P(KTX2_zstd, ImageDecoderTest,
+	::testing::Values(
+		KTX2_IMAGE_TEST("rgb-mipmap-reference-u-zstd"),
+		KTX2_IMAGE_TEST("texturearray_etc2_unorm-zstd"))
+	, ImageDecoderTest::test_case_suffix_generator);
+#endif /* HAVE_ZSTD */
+
 // Valve VTF tests. (all formats)
 INSTANTIATE_TEST_SUITE_P(VTF, ImageDecoderTest,
 	::testing::Values(
@@ -1081,33 +1110,1156 @@ INSTANTIATE_TEST_SUITE_P(TCtest_PVRTC, ImageDecoderTest,
 #endif /* ENABLE_PVRTC */
 
 // BC7 tests.
+static const ImageDecoderTest_mode bc7_modes[] = {
+	ImageDecoderTest_mode(
+		"BC7/w5_grass200_abd_a.dds.gz",
+		"BC7/w5_grass200_abd_a.png"),
+	ImageDecoderTest_mode(
+		"BC7/w5_grass201_abd.dds.gz",
+		"BC7/w5_grass201_abd.png"),
+	ImageDecoderTest_mode(
+		"BC7/w5_grass206_abd.dds.gz",
+		"BC7/w5_grass206_abd.png"),
+	ImageDecoderTest_mode(
+		"BC7/w5_rock805_abd.dds.gz",
+		"BC7/w5_rock805_abd.png"),
+	ImageDecoderTest_mode(
+		"BC7/w5_rock805_nrm.dds.gz",
+		"BC7/w5_rock805_nrm.png"),
+	ImageDecoderTest_mode(
+		"BC7/w5_rope801_prm.dds",
+		"BC7/w5_rope801_prm.png"),
+	ImageDecoderTest_mode(
+		"BC7/w5_sand504_abd_a.dds.gz",
+		"BC7/w5_sand504_abd_a.png"),
+	ImageDecoderTest_mode(
+		"BC7/w5_wood503_prm.dds.gz",
+		"BC7/w5_wood503_prm.png"),
+};
+
 INSTANTIATE_TEST_SUITE_P(BC7, ImageDecoderTest,
+	::testing::ValuesIn(bc7_modes)
+	, ImageDecoderTest::test_case_suffix_generator);
+
+/**
+ * CPU-specific ImageDecoder implementations.
+ */
+enum class DecoderImpl {
+	CPP,
+	SSE2,
+	SSSE3,
+	SSE41,
+	AVX2,
+	BMI2,
+
+	Max
+};
+
+// Decoder table entries for implementations that weren't compiled in.
+#ifdef IMAGEDECODER_HAS_SSE2
+# define ISA_SSE2(fn) fn
+#else /* !IMAGEDECODER_HAS_SSE2 */
+# define ISA_SSE2(fn) nullptr
+#endif /* IMAGEDECODER_HAS_SSE2 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+# define ISA_SSSE3(fn) fn
+#else /* !IMAGEDECODER_HAS_SSSE3 */
+# define ISA_SSSE3(fn) nullptr
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+#ifdef IMAGEDECODER_HAS_SSE41
+# define ISA_SSE41(fn) fn
+#else /* !IMAGEDECODER_HAS_SSE41 */
+# define ISA_SSE41(fn) nullptr
+#endif /* IMAGEDECODER_HAS_SSE41 */
+#ifdef IMAGEDECODER_HAS_AVX2
+# define ISA_AVX2(fn) fn
+#else /* !IMAGEDECODER_HAS_AVX2 */
+# define ISA_AVX2(fn) nullptr
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_BMI2
+# define ISA_BMI2(fn) fn
+#else /* !IMAGEDECODER_HAS_BMI2 */
+# define ISA_BMI2(fn) nullptr
+#endif /* IMAGEDECODER_HAS_BMI2 */
+
+/**
+ * Input data for ImageDecoderISATest.
+ */
+struct ImageDecoderISATest_input
+{
+	int width;
+	int height;
+	ao::uvector<uint8_t> img_buf;
+	ao::uvector<uint16_t> pal_buf;
+
+	// Reference image. (file-based tests only)
+	unique_ptr<rp_image, RpImageUnrefDeleter> img_ref;
+	bool flipV;	// Flip the decoded image vertically before comparing.
+
+	inline int img_siz(void) const { return static_cast<int>(img_buf.size()); }
+	inline int pal_siz(void) const { return static_cast<int>(pal_buf.size() * sizeof(uint16_t)); }
+};
+
+/**
+ * ImageDecoderISATest test case.
+ * The input data is either loaded from a texture file, in which case
+ * the standard version must match the reference PNG image, or it's
+ * pseudo-random data. The optimized versions must match the standard
+ * version exactly.
+ */
+struct ImageDecoderISATest_mode
+{
+	typedef void (*pfnPrepare_t)(const ImageDecoderISATest_mode &mode, ImageDecoderISATest_input &in);
+	typedef rp_image *(*pfnDecode_t)(const ImageDecoderISATest_mode &mode, const ImageDecoderISATest_input &in);
+
+	const char *name;		// Test name, or texture filename.
+	const char *png_filename;	// Reference PNG image. (file-based tests only)
+	pfnPrepare_t prepare;		// Load or generate the input data.
+	pfnDecode_t decode[static_cast<int>(DecoderImpl::Max)];	// Decoding functions. (nullptr if not available)
+	unsigned int benchmark_iterations;
+
+	// Parameters for synthetic tests.
+	int type;			// Format-specific type.
+	ImageDecoder::PixelFormat px_format;	// Pixel format.
+	int width;			// Image width.
+	int height;			// Image height.
+};
+
+/**
+ * ImageDecoderISATest parameter: test case and implementation.
+ */
+struct ImageDecoderISATest_param
+{
+	const ImageDecoderISATest_mode *mode;
+	DecoderImpl impl;
+};
+
+/**
+ * Get the test parameters for all available implementations of each test case.
+ * @param modes Test cases.
+ * @return Test parameters.
+ */
+template<size_t N>
+static vector<ImageDecoderISATest_param> isa_params(const ImageDecoderISATest_mode (&modes)[N])
+{
+	vector<ImageDecoderISATest_param> params;
+	for (const ImageDecoderISATest_mode &mode : modes) {
+		for (int i = 0; i < static_cast<int>(DecoderImpl::Max); i++) {
+			if (mode.decode[i]) {
+				params.push_back({&mode, static_cast<DecoderImpl>(i)});
+			}
+		}
+	}
+	return params;
+}
+
+/**
+ * Decoder tests for the individual CPU-specific implementations.
+ * Texture headers are parsed directly so ImageDecoder can be called
+ * without going through the RomData dispatch function.
+ */
+class ImageDecoderISATest : public ::testing::TestWithParam<ImageDecoderISATest_param>
+{
+	protected:
+		ImageDecoderISATest()
+			: ::testing::TestWithParam<ImageDecoderISATest_param>()
+			, m_supported(false)
+		{ }
+
+		void SetUp(void) final;
+
+	public:
+		/**
+		 * Decode the test image.
+		 * @param impl Implementation to use.
+		 * @return rp_image, or nullptr on error.
+		 */
+		inline rp_image *decode(DecoderImpl impl) const
+		{
+			const ImageDecoderISATest_mode &mode = *GetParam().mode;
+			return mode.decode[static_cast<int>(impl)](mode, m_input);
+		}
+
+		/**
+		 * Compare two rp_image objects for bit-exactness.
+		 * The format, palette, and sBIT must match, too.
+		 * @param pImgExpected	[in] Expected image data.
+		 * @param pImgActual	[in] Actual image data.
+		 */
+		static void Compare_RpImage_Exact(
+			const rp_image *pImgExpected,
+			const rp_image *pImgActual);
+
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<ImageDecoderISATest_param> &info);
+
+	public:
+		/** Input data preparation functions. **/
+
+		/**
+		 * Load a DDS texture and its reference PNG image.
+		 * The DX10 header is skipped if present.
+		 */
+		static void prepareDDS(const ImageDecoderISATest_mode &mode, ImageDecoderISATest_input &in);
+
+		/**
+		 * Load a KTX texture and its reference PNG image.
+		 * Only the first mipmap level is used, and the texture
+		 * must not have any KTX key/value data.
+		 */
+		static void prepareKTX(const ImageDecoderISATest_mode &mode, ImageDecoderISATest_input &in);
+
+		/**
+		 * Generate pseudo-random BC7 blocks.
+		 * mode.type is the block mode to use. (-1 for all modes)
+		 */
+		static void prepareBC7Mode(const ImageDecoderISATest_mode &mode, ImageDecoderISATest_input &in);
+
+	protected:
+		/**
+		 * Load the reference PNG image.
+		 * @param mode	[in] Test case.
+		 * @param in	[out] Input data.
+		 */
+		static void loadReferenceImage(const ImageDecoderISATest_mode &mode, ImageDecoderISATest_input &in);
+
+		ImageDecoderISATest_input m_input;
+		bool m_supported;	// True if this CPU supports the implementation.
+};
+
+/**
+ * Formatting function for ImageDecoderISATest.
+ */
+inline ::std::ostream& operator<<(::std::ostream& os, const ImageDecoderISATest_param& param)
+{
+	return os << param.mode->name;
+};
+
+/**
+ * Decode a block-compressed image.
+ * @tparam fn Decoding function.
+ */
+template<rp_image *(*fn)(int width, int height, const uint8_t *img_buf, int img_siz)>
+static rp_image *decodeBlocks(const ImageDecoderISATest_mode &mode, const ImageDecoderISATest_input &in)
+{
+	RP_UNUSED(mode);
+	return fn(in.width, in.height, in.img_buf.data(), in.img_siz());
+}
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void ImageDecoderISATest::SetUp(void)
+{
+	static const struct {
+		const char *name;
+		bool (*pfnHasISA)(void);
+	} isa_tbl[] = {
+		{"C++", nullptr},
+#ifdef IMAGEDECODER_HAS_SSE2
+		{"SSE2", [](void) -> bool { return RP_CPU_HasSSE2(); }},
+#else /* !IMAGEDECODER_HAS_SSE2 */
+		{"SSE2", [](void) -> bool { return false; }},
+#endif /* IMAGEDECODER_HAS_SSE2 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+		{"SSSE3", [](void) -> bool { return RP_CPU_HasSSSE3(); }},
+#else /* !IMAGEDECODER_HAS_SSSE3 */
+		{"SSSE3", [](void) -> bool { return false; }},
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+#ifdef IMAGEDECODER_HAS_SSE41
+		{"SSE4.1", [](void) -> bool { return RP_CPU_HasSSE41(); }},
+#else /* !IMAGEDECODER_HAS_SSE41 */
+		{"SSE4.1", [](void) -> bool { return false; }},
+#endif /* IMAGEDECODER_HAS_SSE41 */
+#ifdef IMAGEDECODER_HAS_AVX2
+		{"AVX2", [](void) -> bool { return RP_CPU_HasAVX2(); }},
+#else /* !IMAGEDECODER_HAS_AVX2 */
+		{"AVX2", [](void) -> bool { return false; }},
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_BMI2
+		{"BMI2", [](void) -> bool { return RP_CPU_HasSSE2() && RP_CPU_HasBMI2(); }},
+#else /* !IMAGEDECODER_HAS_BMI2 */
+		{"BMI2", [](void) -> bool { return false; }},
+#endif /* IMAGEDECODER_HAS_BMI2 */
+	};
+	static_assert(ARRAY_SIZE(isa_tbl) == static_cast<size_t>(DecoderImpl::Max),
+		"isa_tbl[] needs to be updated.");
+
+	const ImageDecoderISATest_param &param = GetParam();
+	const auto &isa = isa_tbl[static_cast<int>(param.impl)];
+	if (isa.pfnHasISA && !isa.pfnHasISA()) {
+		fprintf(stderr, "*** %s is not supported on this CPU. Skipping test.\n", isa.name);
+		return;
+	}
+
+	m_supported = true;
+	m_input.width = param.mode->width;
+	m_input.height = param.mode->height;
+	m_input.flipV = false;
+	ASSERT_NO_FATAL_FAILURE(param.mode->prepare(*param.mode, m_input));
+}
+
+/**
+ * Compare two rp_image objects for bit-exactness.
+ * The format, palette, and sBIT must match, too.
+ * @param pImgExpected	[in] Expected image data.
+ * @param pImgActual	[in] Actual image data.
+ */
+void ImageDecoderISATest::Compare_RpImage_Exact(
+	const rp_image *pImgExpected,
+	const rp_image *pImgActual)
+{
+	ASSERT_EQ(pImgExpected->format(), pImgActual->format());
+	ASSERT_EQ(pImgExpected->width(), pImgActual->width());
+	ASSERT_EQ(pImgExpected->height(), pImgActual->height());
+	const size_t row_bytes = pImgExpected->row_bytes();
+	for (int y = 0; y < pImgExpected->height(); y++) {
+		ASSERT_EQ(0, memcmp(pImgExpected->scanLine(y), pImgActual->scanLine(y), row_bytes)) <<
+			"Image differs on row " << y;
+	}
+
+	if (pImgExpected->format() == rp_image::Format::CI8) {
+		ASSERT_EQ(pImgExpected->palette_len(), pImgActual->palette_len());
+		ASSERT_EQ(0, memcmp(pImgExpected->palette(), pImgActual->palette(),
+			pImgExpected->palette_len() * sizeof(uint32_t))) << "Palettes differ.";
+		EXPECT_EQ(pImgExpected->tr_idx(), pImgActual->tr_idx());
+	}
+
+	rp_image::sBIT_t sBIT_expected, sBIT_actual;
+	const int ret = pImgExpected->get_sBIT(&sBIT_expected);
+	ASSERT_EQ(ret, pImgActual->get_sBIT(&sBIT_actual));
+	if (ret == 0) {
+		EXPECT_EQ(0, memcmp(&sBIT_expected, &sBIT_actual, sizeof(sBIT_expected)));
+	}
+}
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string ImageDecoderISATest::test_case_suffix_generator(const ::testing::TestParamInfo<ImageDecoderISATest_param> &info)
+{
+	static const char s_impl[][8] = {
+		"_cpp", "_sse2", "_ssse3", "_sse41", "_avx2", "_bmi2"
+	};
+	static_assert(ARRAY_SIZE(s_impl) == static_cast<size_t>(DecoderImpl::Max),
+		"s_impl[] needs to be updated.");
+
+	string suffix = info.param.mode->name;
+
+	// Replace all non-alphanumeric characters with '_'.
+	// See gtest-param-util.h::IsValidParamName().
+	std::for_each(suffix.begin(), suffix.end(),
+		[](char &c) {
+			if (!ISALNUM(c)) {
+				c = '_';
+			}
+		}
+	);
+
+	suffix += s_impl[static_cast<int>(info.param.impl)];
+	return suffix;
+}
+
+/**
+ * Load the reference PNG image.
+ * @param mode	[in] Test case.
+ * @param in	[out] Input data.
+ */
+void ImageDecoderISATest::loadReferenceImage(const ImageDecoderISATest_mode &mode, ImageDecoderISATest_input &in)
+{
+	ao::uvector<uint8_t> png_buf;
+	ASSERT_NO_FATAL_FAILURE(ImageDecoderTest::loadTestFile(mode.png_filename, MAX_PNG_IMAGE_FILESIZE, png_buf));
+
+	unique_RefBase<RpMemFile> f_png(new RpMemFile(png_buf.data(), png_buf.size()));
+	ASSERT_TRUE(f_png->isOpen()) << "Could not create RpMemFile for the PNG image.";
+	in.img_ref.reset(RpImageLoader::load(f_png.get()));
+	ASSERT_TRUE(in.img_ref != nullptr) << "Could not load the PNG image as rp_image.";
+	ASSERT_TRUE(in.img_ref->isValid()) << "Could not load the PNG image as rp_image.";
+}
+
+/**
+ * Load a DDS texture and its reference PNG image.
+ * The DX10 header is skipped if present.
+ */
+void ImageDecoderISATest::prepareDDS(const ImageDecoderISATest_mode &mode, ImageDecoderISATest_input &in)
+{
+	ao::uvector<uint8_t> dds_buf;
+	ASSERT_NO_FATAL_FAILURE(ImageDecoderTest::loadTestFile(mode.name, MAX_DDS_IMAGE_FILESIZE, dds_buf));
+
+	size_t hdrSize = sizeof(uint32_t) + sizeof(DDS_HEADER);
+	ASSERT_GT(dds_buf.size(), hdrSize) << "DDS test image is too small.";
+
+	const uint32_t *const pMagic = reinterpret_cast<const uint32_t*>(dds_buf.data());
+	ASSERT_EQ(cpu_to_be32(DDS_MAGIC), *pMagic) << "DDS magic number is incorrect.";
+	const DDS_HEADER *const pDdsHeader = reinterpret_cast<const DDS_HEADER*>(&dds_buf[4]);
+	if (pDdsHeader->ddspf.dwFourCC == cpu_to_be32(DDPF_FOURCC_DX10)) {
+		hdrSize += sizeof(DDS_HEADER_DXT10);
+		ASSERT_GT(dds_buf.size(), hdrSize) << "DDS test image is too small.";
+	}
+
+	// NOTE: The decoders only need img_siz to be large enough
+	// for the first mipmap level, so the rest of the file is used.
+	in.width = static_cast<int>(le32_to_cpu(pDdsHeader->dwWidth));
+	in.height = static_cast<int>(le32_to_cpu(pDdsHeader->dwHeight));
+	in.img_buf.assign(dds_buf.begin() + hdrSize, dds_buf.end());
+
+	ASSERT_NO_FATAL_FAILURE(loadReferenceImage(mode, in));
+}
+
+/**
+ * Load a KTX texture and its reference PNG image.
+ * Only the first mipmap level is used, and the texture
+ * must not have any KTX key/value data.
+ */
+void ImageDecoderISATest::prepareKTX(const ImageDecoderISATest_mode &mode, ImageDecoderISATest_input &in)
+{
+	ao::uvector<uint8_t> ktx_buf;
+	ASSERT_NO_FATAL_FAILURE(ImageDecoderTest::loadTestFile(mode.name, MAX_DDS_IMAGE_FILESIZE, ktx_buf));
+
+	// Image data starts after the imageSize field.
+	static const size_t hdrSize = sizeof(KTX_Header) + sizeof(uint32_t);
+	ASSERT_GT(ktx_buf.size(), hdrSize) << "KTX test image is too small.";
+
+	const KTX_Header *const pKtxHeader = reinterpret_cast<const KTX_Header*>(ktx_buf.data());
+	ASSERT_EQ(0, memcmp(pKtxHeader->identifier, KTX_IDENTIFIER, sizeof(pKtxHeader->identifier)))
+		<< "KTX identifier is incorrect.";
+	ASSERT_EQ(static_cast<uint32_t>(KTX_ENDIAN_MAGIC), le32_to_cpu(pKtxHeader->endianness))
+		<< "KTX test image is not little-endian.";
+
+	// NOTE: Key/value data may contain KTXorientation, which isn't handled here.
+	ASSERT_EQ(0U, le32_to_cpu(pKtxHeader->bytesOfKeyValueData)) << "KTX test image has key/value data.";
+
+	uint32_t imageSize;
+	memcpy(&imageSize, &ktx_buf[sizeof(KTX_Header)], sizeof(imageSize));
+	imageSize = le32_to_cpu(imageSize);
+	ASSERT_GE(ktx_buf.size() - hdrSize, imageSize) << "KTX image data is truncated.";
+
+	in.width = static_cast<int>(le32_to_cpu(pKtxHeader->pixelWidth));
+	in.height = static_cast<int>(le32_to_cpu(pKtxHeader->pixelHeight));
+	in.img_buf.assign(ktx_buf.begin() + hdrSize, ktx_buf.begin() + hdrSize + imageSize);
+
+	// The test images don't have KTXorientation, so they're
+	// stored bottom-up. (KhronosKTX flips these by default.)
+	in.flipV = true;
+
+	ASSERT_NO_FATAL_FAILURE(loadReferenceImage(mode, in));
+}
+
+/**
+ * Generate pseudo-random BC7 blocks.
+ * mode.type is the block mode to use. (-1 for all modes)
+ */
+void ImageDecoderISATest::prepareBC7Mode(const ImageDecoderISATest_mode &mode, ImageDecoderISATest_input &in)
+{
+	const size_t siz = static_cast<size_t>((mode.width + 3) / 4) * ((mode.height + 3) / 4) * 16;
+	in.img_buf.resize(siz);
+	fillPseudoRandom(in.img_buf.data(), siz);
+
+	// Set the mode bits.
+	for (size_t i = 0; i < siz; i += 16) {
+		const unsigned int blkMode = (mode.type >= 0)
+			? static_cast<unsigned int>(mode.type)
+			: static_cast<unsigned int>((i / 16) % 8);
+		const uint8_t modeMask = (2U << blkMode) - 1;
+		in.img_buf[i] = (in.img_buf[i] & ~modeMask) | (1U << blkMode);
+	}
+}
+
+/**
+ * Test an ImageDecoder implementation.
+ * The standard version is compared to the reference image, if any;
+ * optimized versions are compared to the standard version.
+ */
+TEST_P(ImageDecoderISATest, decodeTest)
+{
+	if (!m_supported) {
+		return;
+	}
+
+	unique_ptr<rp_image, RpImageUnrefDeleter> img_cpp(decode(DecoderImpl::CPP), RpImageUnrefDeleter());
+	ASSERT_TRUE(img_cpp != nullptr) << "Could not decode the image. (standard version)";
+
+	if (m_input.img_ref) {
+		const rp_image *pImgCmp = img_cpp.get();
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_flip(nullptr, RpImageUnrefDeleter());
+		if (m_input.flipV) {
+			img_flip.reset(img_cpp->flip(rp_image::FLIP_V));
+			ASSERT_TRUE(img_flip != nullptr) << "Could not flip the image.";
+			pImgCmp = img_flip.get();
+		}
+		ASSERT_NO_FATAL_FAILURE(ImageDecoderTest::Compare_RpImage(m_input.img_ref.get(), pImgCmp));
+	}
+
+	const DecoderImpl impl = GetParam().impl;
+	if (impl == DecoderImpl::CPP) {
+		// Nothing else to compare.
+		return;
+	}
+
+	unique_ptr<rp_image, RpImageUnrefDeleter> img_opt(decode(impl), RpImageUnrefDeleter());
+	ASSERT_TRUE(img_opt != nullptr) << "Could not decode the image. (optimized version)";
+	ASSERT_NO_FATAL_FAILURE(Compare_RpImage_Exact(img_cpp.get(), img_opt.get()));
+}
+
+/**
+ * Benchmark an ImageDecoder implementation.
+ */
+TEST_P(ImageDecoderISATest, decodeBenchmark)
+{
+	if (!m_supported) {
+		return;
+	}
+
+	const ImageDecoderISATest_param &param = GetParam();
+	for (unsigned int i = param.mode->benchmark_iterations; i > 0; i--) {
+		rp_image *const img = decode(param.impl);
+		ASSERT_TRUE(img != nullptr) << "Could not decode the image.";
+		img->unref();
+	}
+}
+
+/** BC7 **/
+
+#define BC7_DECODERS { \
+	decodeBlocks<ImageDecoder::fromBC7_cpp>, \
+	nullptr, \
+	ISA_SSSE3(decodeBlocks<ImageDecoder::fromBC7_ssse3>), \
+	ISA_SSE41(decodeBlocks<ImageDecoder::fromBC7_sse41>), \
+	ISA_AVX2(decodeBlocks<ImageDecoder::fromBC7_avx2>), \
+	nullptr}
+#define BC7_ISA_TEST(dds, png) \
+	{dds, png, ImageDecoderISATest::prepareDDS, BC7_DECODERS, \
+		ImageDecoderTest::BENCHMARK_ITERATIONS_BC7, 0, ImageDecoder::PXF_UNKNOWN, 0, 0}
+static const ImageDecoderISATest_mode bc7_isa_modes[] = {
+	BC7_ISA_TEST("BC7/w5_grass200_abd_a.dds.gz", "BC7/w5_grass200_abd_a.png"),
+	BC7_ISA_TEST("BC7/w5_grass201_abd.dds.gz", "BC7/w5_grass201_abd.png"),
+	BC7_ISA_TEST("BC7/w5_grass206_abd.dds.gz", "BC7/w5_grass206_abd.png"),
+	BC7_ISA_TEST("BC7/w5_rock805_abd.dds.gz", "BC7/w5_rock805_abd.png"),
+	BC7_ISA_TEST("BC7/w5_rock805_nrm.dds.gz", "BC7/w5_rock805_nrm.png"),
+	BC7_ISA_TEST("BC7/w5_rope801_prm.dds", "BC7/w5_rope801_prm.png"),
+	BC7_ISA_TEST("BC7/w5_sand504_abd_a.dds.gz", "BC7/w5_sand504_abd_a.png"),
+	BC7_ISA_TEST("BC7/w5_wood503_prm.dds.gz", "BC7/w5_wood503_prm.png"),
+};
+INSTANTIATE_TEST_SUITE_P(BC7, ImageDecoderISATest,
+	::testing::ValuesIn(isa_params(bc7_isa_modes))
+	, ImageDecoderISATest::test_case_suffix_generator);
+
+// BC7 bit-exactness tests.
+// Blocks are pseudo-random, with the mode bits forced so every
+// mode, partition, rotation, and index selection is covered.
+// NOTE: Odd tile counts are included to test the
+// single-block code path in the AVX2 version.
+#define BC7_MODE_TEST(name, blkMode, width, height) \
+	{name, nullptr, ImageDecoderISATest::prepareBC7Mode, BC7_DECODERS, \
+		ImageDecoderTest::BENCHMARK_ITERATIONS_BC7, blkMode, ImageDecoder::PXF_UNKNOWN, width, height}
+static const ImageDecoderISATest_mode bc7_mode_isa_modes[] = {
+	BC7_MODE_TEST("mode0", 0, 256, 64),
+	BC7_MODE_TEST("mode1", 1, 256, 64),
+	BC7_MODE_TEST("mode2", 2, 256, 64),
+	BC7_MODE_TEST("mode3", 3, 256, 64),
+	BC7_MODE_TEST("mode4", 4, 256, 64),
+	BC7_MODE_TEST("mode5", 5, 256, 64),
+	BC7_MODE_TEST("mode6", 6, 256, 64),
+	BC7_MODE_TEST("mode7", 7, 256, 64),
+	BC7_MODE_TEST("mixed_256x256", -1, 256, 256),
+	BC7_MODE_TEST("mixed_20x12", -1, 20, 12),
+	BC7_MODE_TEST("mixed_37x9", -1, 37, 9),
+};
+INSTANTIATE_TEST_SUITE_P(BC7Mode, ImageDecoderISATest,
+	::testing::ValuesIn(isa_params(bc7_mode_isa_modes))
+	, ImageDecoderISATest::test_case_suffix_generator);
+
+/** S3TC **/
+
+// DXT2 and DXT4 aren't tested here, since they're handled by
+// fromDXT3() and fromDXT5().
+#define S3TC_ISA_TEST(file, fn) \
+	{"S3TC/" file ".dds.gz", "S3TC/" file ".s3tc.png", ImageDecoderISATest::prepareDDS, { \
+		decodeBlocks<ImageDecoder::fn##_cpp>, \
+		nullptr, \
+		ISA_SSSE3(decodeBlocks<ImageDecoder::fn##_ssse3>), \
+		nullptr, \
+		ISA_AVX2(decodeBlocks<ImageDecoder::fn##_avx2>), \
+		nullptr}, \
+		ImageDecoderTest::BENCHMARK_ITERATIONS, 0, ImageDecoder::PXF_UNKNOWN, 0, 0}
+static const ImageDecoderISATest_mode s3tc_isa_modes[] = {
+	S3TC_ISA_TEST("dxt1-rgb", fromDXT1_A1),
+	S3TC_ISA_TEST("dxt3-rgb", fromDXT3),
+	S3TC_ISA_TEST("dxt3-argb", fromDXT3),
+	S3TC_ISA_TEST("dxt5-rgb", fromDXT5),
+	S3TC_ISA_TEST("dxt5-argb", fromDXT5),
+	S3TC_ISA_TEST("bc4", fromBC4),
+	S3TC_ISA_TEST("bc5", fromBC5),
+};
+INSTANTIATE_TEST_SUITE_P(S3TC, ImageDecoderISATest,
+	::testing::ValuesIn(isa_params(s3tc_isa_modes))
+	, ImageDecoderISATest::test_case_suffix_generator);
+
+/** ETC **/
+
+#define ETC_ISA_TEST(file, fn) \
+	{"KTX/" file ".ktx.gz", "KTX/" file ".png", ImageDecoderISATest::prepareKTX, { \
+		decodeBlocks<ImageDecoder::fn##_cpp>, \
+		nullptr, \
+		nullptr, \
+		ISA_SSE41(decodeBlocks<ImageDecoder::fn##_sse41>), \
+		nullptr, \
+		nullptr}, \
+		ImageDecoderTest::BENCHMARK_ITERATIONS, 0, ImageDecoder::PXF_UNKNOWN, 0, 0}
+static const ImageDecoderISATest_mode etc_isa_modes[] = {
+	ETC_ISA_TEST("etc1", fromETC1),
+	ETC_ISA_TEST("etc2-rgb", fromETC2_RGB),
+	ETC_ISA_TEST("etc2-rgba1", fromETC2_RGB_A1),
+	ETC_ISA_TEST("etc2-rgba8", fromETC2_RGBA),
+};
+INSTANTIATE_TEST_SUITE_P(ETC, ImageDecoderISATest,
+	::testing::ValuesIn(isa_params(etc_isa_modes))
+	, ImageDecoderISATest::test_case_suffix_generator);
+
+/**
+ * Multithreaded block decoding tests.
+ * Images with pseudo-random block data are decoded on one thread,
+ * then with the specified number of threads. Results must match.
+ */
+struct ImageDecoderMTTest_mode
+{
+	typedef rp_image *(*pfnDecodeBlocks_t)(int width, int height,
+		const uint8_t *img_buf, int img_siz);
+
+	const char *name;		// Format name.
+	pfnDecodeBlocks_t pfn;		// Decoding function.
+	unsigned int blockSize;		// Block size, in bytes.
+	unsigned int threads;		// Number of threads. (0 == number of logical CPUs)
+};
+
+class ImageDecoderMTTest : public ::testing::TestWithParam<ImageDecoderMTTest_mode>
+{
+	protected:
+		void TearDown(void) final
+		{
+			// Restore the default thread count.
+			ImageDecoder::setMaxThreads(0);
+		}
+
+	public:
+		/**
+		 * Generate pseudo-random block data.
+		 * @param buf	[out] Block data.
+		 * @param width	[in] Image width.
+		 * @param height [in] Image height.
+		 */
+		void makeBlockData(ao::uvector<uint8_t> &buf, int width, int height);
+
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<ImageDecoderMTTest_mode> &info);
+
+		// Number of iterations for benchmarks.
+		// 4096x4096 images are used, so fewer iterations are needed.
+		static const unsigned int BENCHMARK_ITERATIONS = 10;
+};
+
+/**
+ * Generate pseudo-random block data.
+ * @param buf	[out] Block data.
+ * @param width	[in] Image width.
+ * @param height [in] Image height.
+ */
+void ImageDecoderMTTest::makeBlockData(ao::uvector<uint8_t> &buf, int width, int height)
+{
+	const ImageDecoderMTTest_mode &mode = GetParam();
+	const size_t siz = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * mode.blockSize;
+	buf.resize(siz);
+	fillPseudoRandom(buf.data(), siz);
+	if (!strcmp(mode.name, "BC7")) {
+		fixBC7Modes(buf.data(), siz);
+	}
+}
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string ImageDecoderMTTest::test_case_suffix_generator(const ::testing::TestParamInfo<ImageDecoderMTTest_mode> &info)
+{
+	char buf[64];
+	if (info.param.threads == 0) {
+		snprintf(buf, sizeof(buf), "%s_auto", info.param.name);
+	} else {
+		snprintf(buf, sizeof(buf), "%s_%uthreads", info.param.name, info.param.threads);
+	}
+	return buf;
+}
+
+/**
+ * Compare multithreaded decoding to single-threaded decoding.
+ * The image height isn't a multiple of the band height,
+ * so the last band is shorter than the rest.
+ * NOTE: ETC requires the image size to be a multiple of 4.
+ */
+TEST_P(ImageDecoderMTTest, decodeBlocks_mt_test)
+{
+	const ImageDecoderMTTest_mode &mode = GetParam();
+	static const int width = 1028, height = 1028;
+	ao::uvector<uint8_t> buf;
+	makeBlockData(buf, width, height);
+
+	ImageDecoder::setMaxThreads(1);
+	unique_ptr<rp_image, RpImageUnrefDeleter> img_st(
+		mode.pfn(width, height, buf.data(), static_cast<int>(buf.size())), RpImageUnrefDeleter());
+	ASSERT_TRUE(img_st != nullptr) << "Could not decode the image using one thread.";
+
+	ImageDecoder::setMaxThreads(mode.threads);
+	unique_ptr<rp_image, RpImageUnrefDeleter> img_mt(
+		mode.pfn(width, height, buf.data(), static_cast<int>(buf.size())), RpImageUnrefDeleter());
+	ASSERT_TRUE(img_mt != nullptr) << "Could not decode the image using multiple threads.";
+
+	ASSERT_NO_FATAL_FAILURE(ImageDecoderTest::Compare_RpImage(img_st.get(), img_mt.get()));
+
+	// sBIT must be set on the multithreaded image, too.
+	rp_image::sBIT_t sBIT_st, sBIT_mt;
+	ASSERT_EQ(0, img_st->get_sBIT(&sBIT_st));
+	ASSERT_EQ(0, img_mt->get_sBIT(&sBIT_mt));
+	EXPECT_EQ(0, memcmp(&sBIT_st, &sBIT_mt, sizeof(sBIT_st)));
+}
+
+/**
+ * Benchmark multithreaded decoding.
+ * Compare the reported times for each thread count.
+ */
+TEST_P(ImageDecoderMTTest, decodeBlocks_mt_Benchmark)
+{
+	const ImageDecoderMTTest_mode &mode = GetParam();
+	static const int width = 4096, height = 4096;
+	ao::uvector<uint8_t> buf;
+	makeBlockData(buf, width, height);
+
+	ImageDecoder::setMaxThreads(mode.threads);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = mode.pfn(width, height, buf.data(), static_cast<int>(buf.size()));
+		ASSERT_TRUE(img != nullptr) << "Could not decode the image.";
+		img->unref();
+	}
+}
+
+#define MT_TEST(name, pfn, blockSize) \
+	ImageDecoderMTTest_mode{name, pfn, blockSize, 1}, \
+	ImageDecoderMTTest_mode{name, pfn, blockSize, 2}, \
+	ImageDecoderMTTest_mode{name, pfn, blockSize, 4}, \
+	ImageDecoderMTTest_mode{name, pfn, blockSize, 8}, \
+	ImageDecoderMTTest_mode{name, pfn, blockSize, 0}
+INSTANTIATE_TEST_SUITE_P(MT, ImageDecoderMTTest,
+	::testing::Values(
+		MT_TEST("DXT1", ImageDecoder::fromDXT1, 8),
+		MT_TEST("DXT3", ImageDecoder::fromDXT3, 16),
+		MT_TEST("DXT5", ImageDecoder::fromDXT5, 16),
+		MT_TEST("BC4", ImageDecoder::fromBC4, 8),
+		MT_TEST("BC5", ImageDecoder::fromBC5, 16),
+		MT_TEST("BC7", ImageDecoder::fromBC7, 16),
+		MT_TEST("ETC1", ImageDecoder::fromETC1, 8),
+		MT_TEST("ETC2_RGB", ImageDecoder::fromETC2_RGB, 8),
+		MT_TEST("ETC2_RGBA", ImageDecoder::fromETC2_RGBA, 16),
+		MT_TEST("ETC2_RGB_A1", ImageDecoder::fromETC2_RGB_A1, 8))
+	, ImageDecoderMTTest::test_case_suffix_generator);
+
+/**
+ * Region-of-interest decoding tests.
+ * Regions decoded with fromBlocks_ROI() must match the
+ * same region of the fully-decoded image.
+ */
+struct ImageDecoderROITest_mode
+{
+	const char *name;			// Format name.
+	ImageDecoder::BlockFormat blkfmt;	// Block format.
+	ImageDecoderMTTest_mode::pfnDecodeBlocks_t pfn;	// Full image decoding function.
+	unsigned int blockSize;			// Block size, in bytes.
+};
+
+class ImageDecoderROITest : public ::testing::TestWithParam<ImageDecoderROITest_mode>
+{
+	public:
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<ImageDecoderROITest_mode> &info)
+		{
+			return info.param.name;
+		}
+};
+
+/**
+ * Compare regions of interest to the fully-decoded image.
+ * NOTE: ETC requires the image size to be a multiple of 4.
+ */
+TEST_P(ImageDecoderROITest, fromBlocks_ROI_test)
+{
+	const ImageDecoderROITest_mode &mode = GetParam();
+	static const int width = 256, height = 128;
+	const size_t siz = static_cast<size_t>(width / 4) * (height / 4) * mode.blockSize;
+	ao::uvector<uint8_t> buf(siz);
+	fillPseudoRandom(buf.data(), siz, 0xC0FFEE11);
+	if (mode.blkfmt == ImageDecoder::BLKF_BC7) {
+		fixBC7Modes(buf.data(), siz);
+	}
+
+	unique_ptr<rp_image, RpImageUnrefDeleter> img_full(
+		mode.pfn(width, height, buf.data(), static_cast<int>(siz)), RpImageUnrefDeleter());
+	ASSERT_TRUE(img_full != nullptr) << "Could not decode the full image.";
+	rp_image::sBIT_t sBIT_full;
+	ASSERT_EQ(0, img_full->get_sBIT(&sBIT_full));
+
+	// Regions: x, y, width, height
+	static const int regions[][4] = {
+		{0, 0, width, height},		// Full image
+		{0, 0, 64, 32},			// Tile-aligned
+		{0, 40, width, 16},		// Full tile rows
+		{5, 7, 33, 17},			// Unaligned
+		{width-3, height-1, 3, 1},	// Bottom-right corner
+		{1, 2, 1, 1},			// Single pixel
+		{2, 0, width-4, height},	// Full height, partial tiles
+	};
+
+	for (const auto &r : regions) {
+		const int rx = r[0], ry = r[1], rw = r[2], rh = r[3];
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_roi(
+			ImageDecoder::fromBlocks_ROI(mode.blkfmt, width, height,
+				buf.data(), static_cast<int>(siz), rx, ry, rw, rh),
+			RpImageUnrefDeleter());
+		ASSERT_TRUE(img_roi != nullptr) << "Could not decode region (" <<
+			rx << "," << ry << ") " << rw << "x" << rh;
+		ASSERT_EQ(rp_image::Format::ARGB32, img_roi->format());
+		ASSERT_EQ(rw, img_roi->width());
+		ASSERT_EQ(rh, img_roi->height());
+
+		for (int y = 0; y < rh; y++) {
+			const uint32_t *const pFull = static_cast<const uint32_t*>(img_full->scanLine(ry + y));
+			ASSERT_EQ(0, memcmp(img_roi->scanLine(y), &pFull[rx], rw * sizeof(uint32_t))) <<
+				"Region (" << rx << "," << ry << ") " << rw << "x" << rh << " differs on row " << y;
+		}
+
+		rp_image::sBIT_t sBIT_roi;
+		ASSERT_EQ(0, img_roi->get_sBIT(&sBIT_roi));
+		EXPECT_EQ(0, memcmp(&sBIT_full, &sBIT_roi, sizeof(sBIT_full)));
+	}
+}
+
+#define ROI_TEST(name, blockSize) \
+	ImageDecoderROITest_mode{#name, ImageDecoder::BLKF_##name, ImageDecoder::from##name, blockSize}
+INSTANTIATE_TEST_SUITE_P(ROI, ImageDecoderROITest,
+	::testing::Values(
+		ROI_TEST(DXT1, 8),
+		ROI_TEST(DXT1_A1, 8),
+		ROI_TEST(DXT2, 16),
+		ROI_TEST(DXT3, 16),
+		ROI_TEST(DXT4, 16),
+		ROI_TEST(DXT5, 16),
+		ROI_TEST(BC4, 8),
+		ROI_TEST(BC5, 16),
+		ROI_TEST(BC7, 16),
+		ROI_TEST(ETC1, 8),
+		ROI_TEST(ETC2_RGB, 8),
+		ROI_TEST(ETC2_RGB_A1, 8),
+		ROI_TEST(ETC2_RGBA, 16))
+	, ImageDecoderROITest::test_case_suffix_generator);
+
+/** Dreamcast **/
+
+// Dreamcast texture types. (ImageDecoderISATest_mode::type)
+enum DC_Type {
+	DC_SqTwiddled,
+	DC_VQ,
+	DC_SmallVQ,
+};
+
+/**
+ * Generate a pseudo-random Dreamcast texture.
+ */
+static void prepareDC(const ImageDecoderISATest_mode &mode, ImageDecoderISATest_input &in)
+{
+	const int size = mode.width;
+	switch (mode.type) {
+		case DC_SqTwiddled:
+			in.img_buf.resize(size * size * 2);
+			fillPseudoRandom(in.img_buf.data(), in.img_buf.size(), 0xDC0DEDC0);
+			break;
+
+		case DC_VQ:
+		case DC_SmallVQ: {
+			const int pal_entry_count = (mode.type == DC_SmallVQ
+				? ImageDecoder::calcDreamcastSmallVQPaletteEntries_NoMipmaps(size)
+				: 1024);
+			in.pal_buf.resize(pal_entry_count);
+			fillPseudoRandom(in.pal_buf.data(), in.pal_siz(), 0xDC0DEDC0);
+
+			// Palette indexes must be in range for SmallVQ.
+			const unsigned int idx_count = pal_entry_count / 4;
+			in.img_buf.resize(size * size / 4);
+			fillPseudoRandom(in.img_buf.data(), in.img_buf.size(), 0xDC0DEDC1);
+			for (uint8_t &idx : in.img_buf) {
+				idx %= idx_count;
+			}
+			break;
+		}
+
+		default:
+			ASSERT_TRUE(!"Invalid texture type.");
+			break;
+	}
+}
+
+/**
+ * Decode a Dreamcast square twiddled texture.
+ * @tparam fn Decoding function.
+ */
+template<rp_image *(*fn)(ImageDecoder::PixelFormat px_format,
+	int width, int height,
+	const uint16_t *img_buf, int img_siz)>
+static rp_image *decodeDCSqTwiddled(const ImageDecoderISATest_mode &mode, const ImageDecoderISATest_input &in)
+{
+	return fn(mode.px_format, in.width, in.height,
+		reinterpret_cast<const uint16_t*>(in.img_buf.data()), in.img_siz());
+}
+
+/**
+ * Decode a Dreamcast VQ texture.
+ * @tparam fn Decoding function.
+ */
+template<rp_image *(*fn)(ImageDecoder::PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *img_buf, int img_siz,
+	const uint16_t *pal_buf, int pal_siz)>
+static rp_image *decodeDCVQ(const ImageDecoderISATest_mode &mode, const ImageDecoderISATest_input &in)
+{
+	return fn(mode.px_format, (mode.type == DC_SmallVQ), false,
+		in.width, in.height,
+		in.img_buf.data(), in.img_siz(),
+		in.pal_buf.data(), in.pal_siz());
+}
+
+// The Morton-order versions must match the table-based version.
+// VQ doesn't have a BMI2 version, since it isn't faster than SSE2.
+#define DC_DECODERS(adapter, fn, bmi2) { \
+	adapter<ImageDecoder::fn##_cpp>, \
+	ISA_SSE2(adapter<ImageDecoder::fn##_sse2>), \
+	nullptr, \
+	nullptr, \
+	nullptr, \
+	bmi2}
+#define DC_SQTWIDDLED_TEST(name, pxf, size) \
+	{name, nullptr, prepareDC, DC_DECODERS(decodeDCSqTwiddled, fromDreamcastSquareTwiddled16, \
+		ISA_BMI2(decodeDCSqTwiddled<ImageDecoder::fromDreamcastSquareTwiddled16_bmi2>)), \
+		ImageDecoderTest::BENCHMARK_ITERATIONS, DC_SqTwiddled, ImageDecoder::PXF_##pxf, size, size}
+#define DC_VQ_TEST(name, type, pxf, size) \
+	{name, nullptr, prepareDC, DC_DECODERS(decodeDCVQ, fromDreamcastVQ16, nullptr), \
+		ImageDecoderTest::BENCHMARK_ITERATIONS, DC_##type, ImageDecoder::PXF_##pxf, size, size}
+static const ImageDecoderISATest_mode dc_isa_modes[] = {
+	DC_SQTWIDDLED_TEST("SqTwiddled_ARGB1555_8", ARGB1555, 8),
+	DC_SQTWIDDLED_TEST("SqTwiddled_RGB565_64", RGB565, 64),
+	DC_SQTWIDDLED_TEST("SqTwiddled_ARGB4444_1024", ARGB4444, 1024),
+	DC_SQTWIDDLED_TEST("SqTwiddled_RGB565_2", RGB565, 2),
+	DC_SQTWIDDLED_TEST("SqTwiddled_ARGB1555_24", ARGB1555, 24),
+	DC_VQ_TEST("VQ_RGB565_256", VQ, RGB565, 256),
+	DC_VQ_TEST("VQ_ARGB1555_1024", VQ, ARGB1555, 1024),
+	DC_VQ_TEST("SmallVQ_ARGB4444_16", SmallVQ, ARGB4444, 16),
+	DC_VQ_TEST("SmallVQ_RGB565_64", SmallVQ, RGB565, 64),
+};
+INSTANTIATE_TEST_SUITE_P(DC, ImageDecoderISATest,
+	::testing::ValuesIn(isa_params(dc_isa_modes))
+	, ImageDecoderISATest::test_case_suffix_generator);
+
+/** GameCube **/
+
+// GameCube texture types. (ImageDecoderISATest_mode::type)
+enum GCN_Type {
+	GCN_Gcn16,	// 16-bit (4x4 tiles)
+	GCN_CI8,	// CI8 (8x4 tiles)
+	GCN_I8,		// I8 (8x4 tiles)
+};
+
+/**
+ * Generate a pseudo-random GameCube texture.
+ */
+static void prepareGCN(const ImageDecoderISATest_mode &mode, ImageDecoderISATest_input &in)
+{
+	const bool is8bit = (mode.type != GCN_Gcn16);
+	in.img_buf.resize(mode.width * mode.height * (is8bit ? 1 : 2));
+	fillPseudoRandom(in.img_buf.data(), in.img_buf.size(), 0x6C0DE6C0);
+	if (mode.type == GCN_CI8) {
+		in.pal_buf.resize(256);
+		fillPseudoRandom(in.pal_buf.data(), in.pal_siz(), 0x6C0DE6C1);
+	}
+}
+
+/**
+ * Decode a GameCube 16-bit texture.
+ * @tparam fn Decoding function.
+ */
+template<rp_image *(*fn)(ImageDecoder::PixelFormat px_format,
+	int width, int height,
+	const uint16_t *img_buf, int img_siz)>
+static rp_image *decodeGcn16(const ImageDecoderISATest_mode &mode, const ImageDecoderISATest_input &in)
+{
+	return fn(mode.px_format, in.width, in.height,
+		reinterpret_cast<const uint16_t*>(in.img_buf.data()), in.img_siz());
+}
+
+/**
+ * Decode a GameCube CI8 texture.
+ * @tparam fn Decoding function.
+ */
+template<rp_image *(*fn)(int width, int height,
+	const uint8_t *img_buf, int img_siz,
+	const uint16_t *pal_buf, int pal_siz)>
+static rp_image *decodeGcnCI8(const ImageDecoderISATest_mode &mode, const ImageDecoderISATest_input &in)
+{
+	RP_UNUSED(mode);
+	return fn(in.width, in.height,
+		in.img_buf.data(), in.img_siz(),
+		in.pal_buf.data(), in.pal_siz());
+}
+
+// The SIMD versions must match the standard version.
+// NOTE: CI8 and I8 don't have AVX2 versions.
+// NOTE: Odd tile counts are included to test the
+// single-tile code paths in the SIMD versions.
+#define GCN16_TEST(name, pxf, width, height) \
+	{name, nullptr, prepareGCN, { \
+		decodeGcn16<ImageDecoder::fromGcn16_cpp>, \
+		nullptr, \
+		ISA_SSSE3(decodeGcn16<ImageDecoder::fromGcn16_ssse3>), \
+		nullptr, \
+		ISA_AVX2(decodeGcn16<ImageDecoder::fromGcn16_avx2>), \
+		nullptr}, \
+		ImageDecoderTest::BENCHMARK_ITERATIONS, GCN_Gcn16, ImageDecoder::PXF_##pxf, width, height}
+#define GCN_CI8_TEST(name, width, height) \
+	{name, nullptr, prepareGCN, { \
+		decodeGcnCI8<ImageDecoder::fromGcnCI8_cpp>, \
+		nullptr, \
+		ISA_SSSE3(decodeGcnCI8<ImageDecoder::fromGcnCI8_ssse3>), \
+		nullptr, \
+		nullptr, \
+		nullptr}, \
+		ImageDecoderTest::BENCHMARK_ITERATIONS, GCN_CI8, ImageDecoder::PXF_UNKNOWN, width, height}
+#define GCN_I8_TEST(name, width, height) \
+	{name, nullptr, prepareGCN, { \
+		decodeBlocks<ImageDecoder::fromGcnI8_cpp>, \
+		nullptr, \
+		ISA_SSSE3(decodeBlocks<ImageDecoder::fromGcnI8_ssse3>), \
+		nullptr, \
+		nullptr, \
+		nullptr}, \
+		ImageDecoderTest::BENCHMARK_ITERATIONS, GCN_I8, ImageDecoder::PXF_UNKNOWN, width, height}
+static const ImageDecoderISATest_mode gcn_isa_modes[] = {
+	GCN16_TEST("RGB5A3_32x32", RGB5A3, 32, 32),
+	GCN16_TEST("RGB5A3_12x8", RGB5A3, 12, 8),
+	GCN16_TEST("RGB5A3_512x512", RGB5A3, 512, 512),
+	GCN16_TEST("RGB565_4x4", RGB565, 4, 4),
+	GCN16_TEST("RGB565_512x512", RGB565, 512, 512),
+	GCN16_TEST("IA8_20x12", IA8, 20, 12),
+	GCN16_TEST("IA8_512x512", IA8, 512, 512),
+	GCN_CI8_TEST("CI8_8x4", 8, 4),
+	GCN_CI8_TEST("CI8_40x16", 40, 16),
+	GCN_CI8_TEST("CI8_512x512", 512, 512),
+	GCN_I8_TEST("I8_24x8", 24, 8),
+	GCN_I8_TEST("I8_512x512", 512, 512),
+};
+INSTANTIATE_TEST_SUITE_P(GCN, ImageDecoderISATest,
+	::testing::ValuesIn(isa_params(gcn_isa_modes))
+	, ImageDecoderISATest::test_case_suffix_generator);
+
+/**
+ * Mipmap tests.
+ * The rgb-mipmap-reference images have a solid color for each
+ * mipmap level. Verify that the correct mipmap is decoded, and
+ * that RomData::imageForSize() selects the correct mipmap.
+ */
+class ImageDecoderMipmapTest : public ImageDecoderTest
+{ };
+
+TEST_P(ImageDecoderMipmapTest, mipmapForSize_test)
+{
+	// Mipmap level colors. (64x64 through 1x1)
+	// NOTE: The KTX2 version uses a different orange for mipmap 1.
+	const ImageDecoderTest_mode &mode = GetParam();
+	const bool isKTX2 = (mode.dds_gz_filename.find(".ktx2") != string::npos);
+	const uint32_t mip_colors[] = {
+		0xFFFF0000, (isKTX2 ? 0xFFFF7400 : 0xFFFF6600), 0xFFFFFF00, 0xFF00FF00,
+		0xFF0000FF, 0xFF00FFFF, 0xFFFF00FF,
+	};
+
+	// Open the image as an IRpFile.
+	m_f_dds = new RpMemFile(m_dds_buf.data(), m_dds_buf.size());
+	ASSERT_TRUE(m_f_dds->isOpen()) << "Could not create RpMemFile for the texture.";
+
+	// NOTE: Using RpTextureWrapper.
+	m_romData = new RpTextureWrapper(m_f_dds);
+	ASSERT_TRUE(m_romData->isValid()) << "Could not load the texture.";
+
+	// Request sizes and the expected mipmap sizes.
+	static const struct {
+		int req_size;
+		int mip_size;
+	} size_tbl[] = {
+		{  1,  1}, {  2,  2}, {  3,  4}, {  5,  8},
+		{ 16, 16}, { 17, 32}, { 48, 64}, { 64, 64},
+		{256, 64},
+	};
+
+	for (const auto &p : size_tbl) {
+		int fullSize[2] = {0, 0};
+		const rp_image *const img = m_romData->imageForSize(
+			RomData::IMG_INT_IMAGE, p.req_size, p.req_size, fullSize);
+		ASSERT_TRUE(img != nullptr) << "imageForSize(" << p.req_size << ") failed.";
+		EXPECT_EQ(p.mip_size, img->width()) << "Incorrect mipmap width for size " << p.req_size;
+		EXPECT_EQ(p.mip_size, img->height()) << "Incorrect mipmap height for size " << p.req_size;
+		EXPECT_EQ(64, fullSize[0]);
+		EXPECT_EQ(64, fullSize[1]);
+
+		// Check the mipmap color.
+		int mip = 0;
+		for (int sz = 64; sz > p.mip_size; sz >>= 1) {
+			mip++;
+		}
+		ASSERT_LT(mip, (int)ARRAY_SIZE(mip_colors));
+		ASSERT_EQ(rp_image::Format::ARGB32, img->format());
+		for (int y = 0; y < img->height(); y++) {
+			const uint32_t *px = static_cast<const uint32_t*>(img->scanLine(y));
+			for (int x = 0; x < img->width(); x++, px++) {
+				ASSERT_EQ(mip_colors[mip], *px) << "Incorrect pixel color in mipmap " << mip <<
+					" at (" << x << "," << y << ")";
+			}
+		}
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(Mipmap, ImageDecoderMipmapTest,
 	::testing::Values(
 		ImageDecoderTest_mode(
-			"BC7/w5_grass200_abd_a.dds.gz",
-			"BC7/w5_grass200_abd_a.png"),
-		ImageDecoderTest_mode(
-			"BC7/w5_grass201_abd.dds.gz",
-			"BC7/w5_grass201_abd.png"),
-		ImageDecoderTest_mode(
-			"BC7/w5_grass206_abd.dds.gz",
-			"BC7/w5_grass206_abd.png"),
-		ImageDecoderTest_mode(
-			"BC7/w5_rock805_abd.dds.gz",
-			"BC7/w5_rock805_abd.png"),
-		ImageDecoderTest_mode(
-			"BC7/w5_rock805_nrm.dds.gz",
-			"BC7/w5_rock805_nrm.png"),
-		ImageDecoderTest_mode(
-			"BC7/w5_rope801_prm.dds",
-			"BC7/w5_rope801_prm.png"),
-		ImageDecoderTest_mode(
-			"BC7/w5_sand504_abd_a.dds.gz",
-			"BC7/w5_sand504_abd_a.png"),
-		ImageDecoderTest_mode(
-			"BC7/w5_wood503_prm.dds.gz",
-			"BC7/w5_wood503_prm.png"))
+			"KTX/rgb-mipmap-reference.ktx.gz",
+			"KTX2/rgb-mipmap-reference-u.png"),
+		KTX2_IMAGE_TEST("rgb-mipmap-reference-u"))
+	, ImageDecoderTest::test_case_suffix_generator);
+
+#ifdef HAVE_ZSTD
+INSTANTIATE_TEST_SUITE_P(Mipmap_zstd, ImageDecoderMipmapTest,
+	::testing::Values(
+		KTX2_IMAGE_TEST("rgb-mipmap-reference-u-zstd"))
 	, ImageDecoderTest::test_case_suffix_generator);
+#endif /* HAVE_ZSTD */
 
 // SMDH tests.
 // From *New* Nintendo 3DS 9.2.0-20J.
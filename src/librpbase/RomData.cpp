@@ -808,6 +808,82 @@ const rp_image *RomData::image(ImageType imageType) const
 	return (ret == 0 ? img : nullptr);
 }
 
+/**
+ * Get an internal image from the ROM, using a smaller
+ * version of the image if one is available.
+ *
+ * This is intended for thumbnailing. For example, texture
+ * files may have mipmaps, and decoding a smaller mipmap is
+ * much faster than decoding and downscaling the full image.
+ * The returned image will have at least one dimension that
+ * is at least the requested size, unless the full image
+ * is smaller than the requested size.
+ *
+ * The default implementation returns image(imageType).
+ *
+ * The retrieved image must be ref()'d by the caller if the
+ * caller stores it instead of using it immediately.
+ *
+ * @param imageType	[in] Image type to load.
+ * @param width		[in] Requested width.
+ * @param height	[in] Requested height.
+ * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
+ * @return Internal image, or nullptr if the ROM doesn't have one.
+ */
+const rp_image *RomData::imageForSize(ImageType imageType, int width, int height, int pFullSize[2]) const
+{
+	// No reduced-size images by default.
+	RP_UNUSED(width);
+	RP_UNUSED(height);
+	const rp_image *const img = this->image(imageType);
+	if (img && pFullSize) {
+		pFullSize[0] = img->width();
+		pFullSize[1] = img->height();
+	}
+	return img;
+}
+
+/**
+ * Get the band height for imageBand().
+ *
+ * If non-zero, the internal image can be decoded in
+ * horizontal bands using imageBand(), e.g. to write it
+ * to a file without keeping the full image in memory.
+ *
+ * The default implementation returns 0.
+ *
+ * @param imageType	[in] Image type.
+ * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
+ * @return Band height, or 0 if banded decoding isn't supported.
+ */
+int RomData::imageBandHeight(ImageType imageType, int pFullSize[2]) const
+{
+	// No banded decoding by default.
+	RP_UNUSED(imageType);
+	RP_UNUSED(pFullSize);
+	return 0;
+}
+
+/**
+ * Decode a horizontal band of an internal image.
+ * The band is *not* cached by this object.
+ *
+ * The default implementation returns nullptr.
+ *
+ * @param imageType	[in] Image type.
+ * @param y		[in] First row. (must be a multiple of imageBandHeight())
+ * @param height	[in] Number of rows.
+ * @return Band image (caller must unref()), or nullptr on error.
+ */
+rp_image *RomData::imageBand(ImageType imageType, int y, int height) const
+{
+	// No banded decoding by default.
+	RP_UNUSED(imageType);
+	RP_UNUSED(y);
+	RP_UNUSED(height);
+	return nullptr;
+}
+
 /**
  * Get a list of URLs for an external image type.
  *
@@ -466,6 +466,59 @@ class RomData : public RefBase
 		 */
 		const LibRpTexture::rp_image *image(ImageType imageType) const;
 
+		/**
+		 * Get an internal image from the ROM, using a smaller
+		 * version of the image if one is available.
+		 *
+		 * This is intended for thumbnailing. For example, texture
+		 * files may have mipmaps, and decoding a smaller mipmap is
+		 * much faster than decoding and downscaling the full image.
+		 * The returned image will have at least one dimension that
+		 * is at least the requested size, unless the full image
+		 * is smaller than the requested size.
+		 *
+		 * The default implementation returns image(imageType).
+		 *
+		 * The retrieved image must be ref()'d by the caller if the
+		 * caller stores it instead of using it immediately.
+		 *
+		 * @param imageType	[in] Image type to load.
+		 * @param width		[in] Requested width.
+		 * @param height	[in] Requested height.
+		 * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
+		 * @return Internal image, or nullptr if the ROM doesn't have one.
+		 */
+		virtual const LibRpTexture::rp_image *imageForSize(ImageType imageType,
+			int width, int height, int pFullSize[2] = nullptr) const;
+
+		/**
+		 * Get the band height for imageBand().
+		 *
+		 * If non-zero, the internal image can be decoded in
+		 * horizontal bands using imageBand(), e.g. to write it
+		 * to a file without keeping the full image in memory.
+		 *
+		 * The default implementation returns 0.
+		 *
+		 * @param imageType	[in] Image type.
+		 * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
+		 * @return Band height, or 0 if banded decoding isn't supported.
+		 */
+		virtual int imageBandHeight(ImageType imageType, int pFullSize[2] = nullptr) const;
+
+		/**
+		 * Decode a horizontal band of an internal image.
+		 * The band is *not* cached by this object.
+		 *
+		 * The default implementation returns nullptr.
+		 *
+		 * @param imageType	[in] Image type.
+		 * @param y		[in] First row. (must be a multiple of imageBandHeight())
+		 * @param height	[in] Number of rows.
+		 * @return Band image (caller must unref()), or nullptr on error.
+		 */
+		virtual LibRpTexture::rp_image *imageBand(ImageType imageType, int y, int height) const;
+
 		/**
 		 * External URLs for a media type.
 		 * Includes URL and "cache key" for local caching,
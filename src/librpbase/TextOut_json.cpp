@@ -376,17 +376,36 @@ std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
 			if (!(imgbf & (1U << i)))
 				continue;
 
-			auto image = romdata->image((RomData::ImageType)i);
-			if (!image || !image->isValid())
+			// If the image can be decoded in bands, only decode
+			// the first band to get the format.
+			int size[2] = {0, 0};
+			rp_image *band = nullptr;
+			const int bandHeight = romdata->imageBandHeight((RomData::ImageType)i, size);
+			if (bandHeight > 0) {
+				band = romdata->imageBand((RomData::ImageType)i, 0, bandHeight);
+			}
+
+			const rp_image *image = band;
+			if (!image) {
+				image = romdata->image((RomData::ImageType)i);
+				if (image) {
+					size[0] = image->width();
+					size[1] = image->height();
+				}
+			}
+			if (!image || !image->isValid()) {
+				UNREF(band);
 				continue;
+			}
 
 			Value imgint_obj(kObjectType);
 			imgint_obj.AddMember("type", StringRef(RomData::getImageTypeName((RomData::ImageType)i)), allocator);
 			imgint_obj.AddMember("format", StringRef(rp_image::getFormatName(image->format())), allocator);
+			UNREF(band);
 
 			Value size_array(kArrayType);	// size
-			size_array.PushBack(image->width(), allocator);
-			size_array.PushBack(image->height(), allocator);
+			size_array.PushBack(size[0], allocator);
+			size_array.PushBack(size[1], allocator);
 			imgint_obj.AddMember("size", size_array, allocator);
 
 			const uint32_t ppf = romdata->imgpf((RomData::ImageType)i);
@@ -762,15 +762,33 @@ std::ostream& operator<<(std::ostream& os, const ROMOutput& fo) {
 		if (!(supported & (1U << i)))
 			continue;
 
-		auto image = romdata->image((RomData::ImageType)i);
+		// If the image can be decoded in bands, only decode
+		// the first band. Otherwise, large textures would be
+		// fully decoded just to print the format and size.
+		int size[2] = {0, 0};
+		rp_image *band = nullptr;
+		const int bandHeight = romdata->imageBandHeight((RomData::ImageType)i, size);
+		if (bandHeight > 0) {
+			band = romdata->imageBand((RomData::ImageType)i, 0, bandHeight);
+		}
+
+		const rp_image *image = band;
+		if (!image) {
+			image = romdata->image((RomData::ImageType)i);
+			if (image) {
+				size[0] = image->width();
+				size[1] = image->height();
+			}
+		}
 		if (image && image->isValid()) {
 			os << "-- " << RomData::getImageTypeName((RomData::ImageType)i) << " is present (use -x" << i << " to extract)" << '\n';
 			os << "   Format : " << rp_image::getFormatName(image->format()) << '\n';
-			os << "   Size   : " << image->width() << " x " << image->height() << '\n';
+			os << "   Size   : " << size[0] << " x " << size[1] << '\n';
 			if (romdata->imgpf((RomData::ImageType) i)  & RomData::IMGPF_ICON_ANIMATED) {
 				os << "   Animated icon present (use -a to extract)" << '\n';
 			}
 		}
+		UNREF(band);
 	}
 
 	std::vector<RomData::ExtURL> extURLs;
@@ -47,6 +47,21 @@ class CBCReaderPrivate
 		uint8_t key[16];
 		uint8_t iv[16];
 		LibRpBase::IAesCipher *cipher;
+		bool isCBC;	// True for CBC; false for ECB.
+
+		// Bounce buffer for reads that aren't block-aligned,
+		// or that need the preceding block as the IV.
+		// Allocated on demand; up to BOUNCE_BUF_SIZE+16 bytes.
+		enum { BOUNCE_BUF_SIZE = 64*1024 };
+		ao::uvector<uint8_t> bounceBuf;
+
+		// Cached IV for sequential reads.
+		// This is the ciphertext of the block immediately
+		// preceding iv_cache_pos, which is the IV needed to
+		// decrypt the block at iv_cache_pos.
+		// If iv_cache_pos is -1, the cache is invalid.
+		uint8_t iv_cache[16];
+		off64_t iv_cache_pos;
 #endif /* ENABLE_DECRYPTION */
 };
 
@@ -61,6 +76,8 @@ CBCReaderPrivate::CBCReaderPrivate(CBCReader *q,
 	, pos(0)
 #ifdef ENABLE_DECRYPTION
 	, cipher(nullptr)
+	, isCBC(false)
+	, iv_cache_pos(-1)
 #endif
 {
 	assert(q->m_file != nullptr);
@@ -97,7 +114,8 @@ CBCReaderPrivate::CBCReaderPrivate(CBCReader *q,
 	}
 
 	// Initialize parameters for CBC decryption.
-	cipher->setChainingMode(iv != nullptr ? IAesCipher::ChainingMode::CBC : IAesCipher::ChainingMode::ECB);
+	isCBC = (iv != nullptr);
+	cipher->setChainingMode(isCBC ? IAesCipher::ChainingMode::CBC : IAesCipher::ChainingMode::ECB);
 	cipher->setKey(this->key, sizeof(this->key));
 	if (iv) {
 		cipher->setIV(this->iv, sizeof(this->iv));
@@ -207,131 +225,138 @@ size_t CBCReader::read(void *ptr, size_t size)
 		size = d->length - d->pos;
 	}
 
-	uint8_t iv[16];
-
-	// Read the first block.
 	// NOTE: If we're in the middle of a block, round it down.
 	const off64_t pos_block = d->pos & ~15LL;
 
 	// Total number of bytes read.
 	size_t total_sz_read = 0;
 
+	// CBC chain:
+	// - iv: IV for the next block to be decrypted.
+	// - iv_prev: IV for the last block that was decrypted.
+	uint8_t iv[16], iv_prev[16];
+
 	// Get the IV.
-	if (pos_block == 0) {
-		// Start of data.
+	// If it isn't available, it will be read along with the
+	// first chunk of data, since it's the preceding block.
+	bool have_iv = true;
+	if (!d->isCBC || pos_block == 0) {
+		// ECB, or start of data.
 		// Use the specified IV.
 		memcpy(iv, d->iv, sizeof(iv));
-		m_file->seek(d->offset);
+	} else if (pos_block == d->iv_cache_pos) {
+		// Sequential read.
+		// Use the IV cached from the previous read.
+		memcpy(iv, d->iv_cache, sizeof(iv));
 	} else {
 		// Not start of data.
-		// Read the IV from the previous 16 bytes.
-		// TODO: Cache it!
-		m_file->seek(d->offset + pos_block - 16);
-		size_t sz_read = m_file->read(iv, sizeof(iv));
-		if (sz_read != sizeof(iv)) {
-			// Read error.
-			m_lastError = m_file->lastError();
-			if (m_lastError == 0) {
-				m_lastError = EIO;
-			}
-			return 0;
-		}
+		// The IV is the previous 16 bytes.
+		have_iv = false;
 	}
+	memcpy(iv_prev, iv, sizeof(iv_prev));
 
-	// Set the IV.
-	int ret = d->cipher->setIV(iv, sizeof(iv));
+	int ret = m_file->seek(d->offset + pos_block - (have_iv ? 0 : 16));
 	if (ret != 0) {
-		// setIV() failed.
-		m_lastError = EIO;
+		// Seek error.
+		m_lastError = m_file->lastError();
+		if (m_lastError == 0) {
+			m_lastError = EIO;
+		}
 		return 0;
 	}
 
-	uint8_t block_tmp[16];
-	if (d->pos != pos_block) {
-		// We're in the middle of a block.
-		// Read and decrypt the full block, and copy out
-		// the necessary bytes.
-		const size_t sz = std::min(16U - (static_cast<size_t>(d->pos) & 15U), size);
-		size_t sz_read = m_file->read(block_tmp, sizeof(block_tmp));
-		if (sz_read != sizeof(block_tmp)) {
-			// Read error.
-			m_lastError = m_file->lastError();
-			if (m_lastError == 0) {
-				m_lastError = EIO;
+	while (size > 0) {
+		const unsigned int head = static_cast<unsigned int>(d->pos & 15);
+		uint8_t *pCt;		// Ciphertext to decrypt in place.
+		size_t ct_sz;		// Size of the ciphertext, in bytes.
+		size_t out_sz;		// Number of bytes to return.
+
+		if (have_iv && head == 0 && size >= 16) {
+			// Block-aligned, and the IV is known.
+			// Read the full blocks directly into the output buffer.
+			ct_sz = size & ~static_cast<size_t>(15);
+			size_t sz_read = m_file->read(ptr8, ct_sz);
+			if (sz_read != ct_sz) {
+				// Short read.
+				// Cannot decrypt with a short read.
+				m_lastError = m_file->lastError();
+				if (m_lastError == 0) {
+					m_lastError = EIO;
+				}
+				return 0;
 			}
-			return 0;
-		}
-
-		// Decrypt the data.
-		size_t sz_dec = d->cipher->decrypt(block_tmp, sizeof(block_tmp));
-		if (sz_dec != sizeof(block_tmp)) {
-			// decrypt() failed.
-			m_lastError = EIO;
-			return 0;
+			pCt = ptr8;
+			out_sz = ct_sz;
+		} else {
+			// Read into the bounce buffer.
+			// If the IV isn't known, the preceding block
+			// is read into the same buffer.
+			const size_t iv_sz = (have_iv ? 0 : 16);
+			ct_sz = std::min<size_t>((head + size + 15) & ~static_cast<size_t>(15),
+				CBCReaderPrivate::BOUNCE_BUF_SIZE);
+			if (d->bounceBuf.size() < iv_sz + ct_sz) {
+				d->bounceBuf.resize(CBCReaderPrivate::BOUNCE_BUF_SIZE + 16);
+			}
+			size_t sz_read = m_file->read(d->bounceBuf.data(), iv_sz + ct_sz);
+			if (sz_read != iv_sz + ct_sz) {
+				// Short read.
+				// Cannot decrypt with a short read.
+				m_lastError = m_file->lastError();
+				if (m_lastError == 0) {
+					m_lastError = EIO;
+				}
+				return 0;
+			}
+			if (!have_iv) {
+				memcpy(iv, d->bounceBuf.data(), sizeof(iv));
+				have_iv = true;
+			}
+			pCt = d->bounceBuf.data() + iv_sz;
+			out_sz = std::min(ct_sz - head, size);
 		}
 
-		memcpy(ptr8, &block_tmp[d->pos & 15], sz);
-		ptr8 += sz;
-		size -= sz;
-		total_sz_read += sz;
-		d->pos += sz;
-	}
-
-	// Read full blocks.
-	size_t full_block_sz = size & ~15LL;
-	if (full_block_sz > 0) {
-		size_t sz_read = m_file->read(ptr8, full_block_sz);
-		if (sz_read != full_block_sz) {
-			// Short read.
-			// Cannot decrypt with a short read.
-			m_lastError = m_file->lastError();
-			if (m_lastError == 0) {
+		// Update the CBC chain.
+		// NOTE: This must be done before decrypting in place.
+		if (d->isCBC) {
+			ret = d->cipher->setIV(iv, sizeof(iv));
+			if (ret != 0) {
+				// setIV() failed.
 				m_lastError = EIO;
+				return 0;
 			}
-			return 0;
+			memcpy(iv_prev, (ct_sz >= 32 ? &pCt[ct_sz - 32] : iv), sizeof(iv_prev));
+			memcpy(iv, &pCt[ct_sz - 16], sizeof(iv));
 		}
 
 		// Decrypt the data.
-		size_t sz_dec = d->cipher->decrypt(ptr8, full_block_sz);
-		if (sz_dec != full_block_sz) {
+		size_t sz_dec = d->cipher->decrypt(pCt, ct_sz);
+		if (sz_dec != ct_sz) {
 			// decrypt() failed.
 			m_lastError = EIO;
 			return 0;
 		}
 
-		ptr8 += sz_read;
-		size -= sz_read;
-		total_sz_read += sz_read;
-		d->pos += sz_read;
-	}
-
-	if (size > 0) {
-		// We need to decrypt a partial block at the end.
-		// Read and decrypt the full block, and copy out
-		// the necessary bytes.
-		size_t sz_read = m_file->read(block_tmp, sizeof(block_tmp));
-		if (sz_read != sizeof(block_tmp)) {
-			// Read error.
-			m_lastError = m_file->lastError();
-			if (m_lastError == 0) {
-				m_lastError = EIO;
-			}
-			return 0;
-		}
-
-		// Decrypt the data.
-		size_t sz_dec = d->cipher->decrypt(block_tmp, sizeof(block_tmp));
-		if (sz_dec != sizeof(block_tmp)) {
-			// decrypt() failed.
-			m_lastError = EIO;
-			return 0;
+		if (pCt != ptr8) {
+			// Copy the data out of the bounce buffer.
+			memcpy(ptr8, &pCt[head], out_sz);
 		}
+		ptr8 += out_sz;
+		size -= out_sz;
+		total_sz_read += out_sz;
+		d->pos += out_sz;
+	}
 
-		memcpy(ptr8, block_tmp, size);
-		ptr8 += size;
-		total_sz_read += size;
-		d->pos += size;
-		size = 0;
+	// Cache the IV for the next sequential read.
+	if ((d->pos & 15) == 0) {
+		// Block-aligned. The next block's IV is
+		// the last ciphertext block.
+		memcpy(d->iv_cache, iv, sizeof(d->iv_cache));
+		d->iv_cache_pos = d->pos;
+	} else {
+		// In the middle of a block. The next read will
+		// start with the last block that was decrypted.
+		memcpy(d->iv_cache, iv_prev, sizeof(d->iv_cache));
+		d->iv_cache_pos = d->pos & ~15LL;
 	}
 
 	// Data read and decrypted successfully.
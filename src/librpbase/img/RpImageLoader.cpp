@@ -62,11 +62,27 @@ const uint8_t RpImageLoaderPrivate::jpeg_magic_2[4] =
  * This image is NOT checked for issues; do not use
  * with untrusted images!
  *
- * @param file IRpFile to load from.
+ * If req_size is specified, JPEG images may be decoded
+ * at a reduced size. The longest side of the returned
+ * image will be at least req_size pixels, unless the
+ * original image is smaller. Other formats are always
+ * loaded at full size.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param req_size	[in,opt] Requested image size. (single dimension; 0 for full size)
+ * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpImageLoader::loadUnchecked(IRpFile *file)
+rp_image *RpImageLoader::loadUnchecked(IRpFile *file, int req_size, int pFullSize[2])
 {
+	if (pFullSize) {
+		pFullSize[0] = 0;
+		pFullSize[1] = 0;
+	}
+#ifndef HAVE_JPEG
+	// Only JPEG images can be decoded at a reduced size.
+	RP_UNUSED(req_size);
+#endif /* !HAVE_JPEG */
 	file->rewind();
 
 	// Check the file header to see what kind of image this is.
@@ -78,7 +94,12 @@ rp_image *RpImageLoader::loadUnchecked(IRpFile *file)
 		     sizeof(RpImageLoaderPrivate::png_magic)))
 		{
 			// Found a PNG image.
-			return RpPng::loadUnchecked(file);
+			rp_image *const img = RpPng::loadUnchecked(file);
+			if (img && pFullSize) {
+				pFullSize[0] = img->width();
+				pFullSize[1] = img->height();
+			}
+			return img;
 		}
 #ifdef HAVE_JPEG
 		else if (!memcmp(buf, RpImageLoaderPrivate::jpeg_magic_1,
@@ -87,7 +108,7 @@ rp_image *RpImageLoader::loadUnchecked(IRpFile *file)
 			  sizeof(RpImageLoaderPrivate::jpeg_magic_2)))
 		{
 			// Found a JPEG image.
-			return RpJpeg::loadUnchecked(file);
+			return RpJpeg::loadUnchecked(file, req_size, pFullSize);
 		}
 #endif /* HAVE_JPEG */
 	}
@@ -102,11 +123,27 @@ rp_image *RpImageLoader::loadUnchecked(IRpFile *file)
  * This image is verified with various tools to ensure
  * it doesn't have any errors.
  *
- * @param file IRpFile to load from.
+ * If req_size is specified, JPEG images may be decoded
+ * at a reduced size. The longest side of the returned
+ * image will be at least req_size pixels, unless the
+ * original image is smaller. Other formats are always
+ * loaded at full size.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param req_size	[in,opt] Requested image size. (single dimension; 0 for full size)
+ * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpImageLoader::load(IRpFile *file)
+rp_image *RpImageLoader::load(IRpFile *file, int req_size, int pFullSize[2])
 {
+	if (pFullSize) {
+		pFullSize[0] = 0;
+		pFullSize[1] = 0;
+	}
+#ifndef HAVE_JPEG
+	// Only JPEG images can be decoded at a reduced size.
+	RP_UNUSED(req_size);
+#endif /* !HAVE_JPEG */
 	file->rewind();
 
 	// Check the file header to see what kind of image this is.
@@ -118,7 +155,12 @@ rp_image *RpImageLoader::load(IRpFile *file)
 		     sizeof(RpImageLoaderPrivate::png_magic)))
 		{
 			// Found a PNG image.
-			return RpPng::load(file);
+			rp_image *const img = RpPng::load(file);
+			if (img && pFullSize) {
+				pFullSize[0] = img->width();
+				pFullSize[1] = img->height();
+			}
+			return img;
 		}
 #ifdef HAVE_JPEG
 		else if (!memcmp(buf, RpImageLoaderPrivate::jpeg_magic_1,
@@ -127,7 +169,7 @@ rp_image *RpImageLoader::load(IRpFile *file)
 			  sizeof(RpImageLoaderPrivate::jpeg_magic_2)))
 		{
 			// Found a JPEG image.
-			return RpJpeg::load(file);
+			return RpJpeg::load(file, req_size, pFullSize);
 		}
 #endif /* HAVE_JPEG */
 	}
@@ -211,10 +211,17 @@ void RpJpegPrivate::jpeg_IRpFile_src(j_decompress_ptr cinfo, IRpFile *infile)
  * This image is NOT checked for issues; do not use
  * with untrusted images!
  *
- * @param file IRpFile to load from.
+ * If req_size is specified, the image may be decoded at a
+ * reduced size using libjpeg's IDCT scaling (1/2, 1/4, or 1/8).
+ * The longest side of the returned image will be at least
+ * req_size pixels, unless the original image is smaller.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param req_size	[in,opt] Requested image size. (single dimension; 0 for full size)
+ * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpJpeg::loadUnchecked(IRpFile *file)
+rp_image *RpJpeg::loadUnchecked(IRpFile *file, int req_size, int pFullSize[2])
 {
 	if (!file)
 		return nullptr;
@@ -291,6 +298,26 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
 		return nullptr;
 	}
 
+	if (pFullSize) {
+		pFullSize[0] = static_cast<int>(cinfo.image_width);
+		pFullSize[1] = static_cast<int>(cinfo.image_height);
+	}
+
+	// If a smaller image was requested, use libjpeg's IDCT scaling
+	// to decode the image at 1/2, 1/4, or 1/8 size. This is much
+	// faster than decoding the full image and scaling it down.
+	// NOTE: Standard libjpeg only supports 1/N scaling, so we won't
+	// use libjpeg-turbo's M/8 scaling factors.
+	if (req_size > 0) {
+		const unsigned int longest = std::max(cinfo.image_width, cinfo.image_height);
+		unsigned int denom = 8;
+		while (denom > 1 && ((longest + denom - 1) / denom) < static_cast<unsigned int>(req_size)) {
+			denom /= 2;
+		}
+		cinfo.scale_num = 1;
+		cinfo.scale_denom = denom;
+	}
+
 	/** Step 4: Set parameters for decompression. **/
 	// Make sure we use libjpeg's built-in colorspace conversion
 	// where possible.
@@ -391,7 +418,7 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
 				return nullptr;
 			}
 
-			img = new rp_image(cinfo.image_width, cinfo.image_height, rp_image::Format::ARGB32);
+			img = new rp_image(cinfo.output_width, cinfo.output_height, rp_image::Format::ARGB32);
 			if (!img->isValid()) {
 				// Could not allocate the image.
 				jpeg_destroy_decompress(&cinfo);
@@ -412,7 +439,7 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
 				return nullptr;
 			}
 
-			img = new rp_image(cinfo.image_width, cinfo.image_height, rp_image::Format::ARGB32);
+			img = new rp_image(cinfo.output_width, cinfo.output_height, rp_image::Format::ARGB32);
 			if (!img->isValid()) {
 				// Could not allocate the image.
 				jpeg_destroy_decompress(&cinfo);
@@ -431,7 +458,7 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
 				return nullptr;
 			}
 
-			img = new rp_image(cinfo.image_width, cinfo.image_height, rp_image::Format::ARGB32);
+			img = new rp_image(cinfo.output_width, cinfo.output_height, rp_image::Format::ARGB32);
 			if (!img->isValid()) {
 				// Could not allocate the image.
 				jpeg_destroy_decompress(&cinfo);
@@ -595,16 +622,23 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
  * This image is verified with various tools to ensure
  * it doesn't have any errors.
  *
- * @param file IRpFile to load from.
+ * If req_size is specified, the image may be decoded at a
+ * reduced size using libjpeg's IDCT scaling (1/2, 1/4, or 1/8).
+ * The longest side of the returned image will be at least
+ * req_size pixels, unless the original image is smaller.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param req_size	[in,opt] Requested image size. (single dimension; 0 for full size)
+ * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpJpeg::load(IRpFile *file)
+rp_image *RpJpeg::load(IRpFile *file, int req_size, int pFullSize[2])
 {
 	if (!file)
 		return nullptr;
 
 	// FIXME: Add a JPEG equivalent of pngcheck().
-	return loadUnchecked(file);
+	return loadUnchecked(file, req_size, pFullSize);
 }
 
 }
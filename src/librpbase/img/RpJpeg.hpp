@@ -35,10 +35,18 @@ class RpJpeg
 		 * This image is NOT checked for issues; do not use
 		 * with untrusted images!
 		 *
-		 * @param file IRpFile to load from.
+		 * If req_size is specified, the image may be decoded at a
+		 * reduced size using libjpeg's IDCT scaling (1/2, 1/4, or 1/8).
+		 * The longest side of the returned image will be at least
+		 * req_size pixels, unless the original image is smaller.
+		 *
+		 * @param file		[in] IRpFile to load from.
+		 * @param req_size	[in,opt] Requested image size. (single dimension; 0 for full size)
+		 * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
 		 * @return rp_image*, or nullptr on error.
 		 */
-		static LibRpTexture::rp_image *loadUnchecked(LibRpFile::IRpFile *file);
+		static LibRpTexture::rp_image *loadUnchecked(LibRpFile::IRpFile *file,
+			int req_size = 0, int pFullSize[2] = nullptr);
 
 		/**
 		 * Load a JPEG image from an IRpFile.
@@ -46,10 +54,18 @@ class RpJpeg
 		 * This image is verified with various tools to ensure
 		 * it doesn't have any errors.
 		 *
-		 * @param file IRpFile to load from.
+		 * If req_size is specified, the image may be decoded at a
+		 * reduced size using libjpeg's IDCT scaling (1/2, 1/4, or 1/8).
+		 * The longest side of the returned image will be at least
+		 * req_size pixels, unless the original image is smaller.
+		 *
+		 * @param file		[in] IRpFile to load from.
+		 * @param req_size	[in,opt] Requested image size. (single dimension; 0 for full size)
+		 * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
 		 * @return rp_image*, or nullptr on error.
 		 */
-		static LibRpTexture::rp_image *load(LibRpFile::IRpFile *file);
+		static LibRpTexture::rp_image *load(LibRpFile::IRpFile *file,
+			int req_size = 0, int pFullSize[2] = nullptr);
 };
 
 }
@@ -41,11 +41,17 @@ namespace LibRpBase {
  * This image is NOT checked for issues; do not use
  * with untrusted images!
  *
- * @param file IRpFile to load from.
+ * NOTE: GDI+ doesn't support decoding at a reduced size,
+ * so req_size is ignored and the full image is returned.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param req_size	[in,opt] Requested image size. (ignored)
+ * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpJpeg::loadUnchecked(IRpFile *file)
+rp_image *RpJpeg::loadUnchecked(IRpFile *file, int req_size, int pFullSize[2])
 {
+	RP_UNUSED(req_size);
 	if (!file)
 		return nullptr;
 
@@ -71,7 +77,12 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
 
 	// Create an rp_image using the GDI+ bitmap.
 	RpGdiplusBackend *const backend = new RpGdiplusBackend(pGdipBmp);
-	return new rp_image(backend);
+	rp_image *const img = new rp_image(backend);
+	if (pFullSize) {
+		pFullSize[0] = img->width();
+		pFullSize[1] = img->height();
+	}
+	return img;
 }
 
 /**
@@ -80,16 +91,21 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
  * This image is verified with various tools to ensure
  * it doesn't have any errors.
  *
- * @param file IRpFile to load from.
+ * NOTE: GDI+ doesn't support decoding at a reduced size,
+ * so req_size is ignored and the full image is returned.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param req_size	[in,opt] Requested image size. (ignored)
+ * @param pFullSize	[out,opt] Two-element array for the full image size. [w, h]
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpJpeg::load(IRpFile *file)
+rp_image *RpJpeg::load(IRpFile *file, int req_size, int pFullSize[2])
 {
 	if (!file)
 		return nullptr;
 
 	// FIXME: Add a JPEG equivalent of pngcheck().
-	return loadUnchecked(file);
+	return loadUnchecked(file, req_size, pFullSize);
 }
 
 }
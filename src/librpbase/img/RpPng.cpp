@@ -10,6 +10,7 @@
 #include "config.librpbase.h"
 
 #include "RpPng.hpp"
+#include "RpPng_p.hpp"
 
 // librpfile
 #include "librpfile/RpFile.hpp"
@@ -23,12 +24,13 @@ using LibRpTexture::argb32_t;
 // PNG writer.
 #include "RpPngWriter.hpp"
 
+#ifdef RPPNG_HAS_SSSE3
+# include "librpcpu/cpuflags_x86.h"
+#endif /* RPPNG_HAS_SSSE3 */
+
 // C++ STL classes.
 using std::unique_ptr;
 
-// Image format libraries.
-#include <png.h>
-
 #if PNG_LIBPNG_VER < 10209 || \
     (PNG_LIBPNG_VER == 10209 && \
         (PNG_LIBPNG_VER_BUILD >= 1 && PNG_LIBPNG_VER_BUILD < 8))
@@ -43,16 +45,6 @@ using std::unique_ptr;
 	png_set_gray_1_2_4_to_8(png_ptr)
 #endif
 
-// PNGCAPI was added in libpng-1.5.0beta14.
-// Older versions will need this.
-#ifndef PNGCAPI
-# ifdef _MSC_VER
-#  define PNGCAPI __cdecl
-# else
-#  define PNGCAPI
-# endif
-#endif /* !PNGCAPI */
-
 // pngcheck()
 #include "pngcheck/pngcheck.hpp"
 
@@ -84,76 +76,6 @@ static int DelayLoad_test_zlib_and_png(void)
 }
 #endif /* defined(_MSC_VER) && (defined(ZLIB_IS_DLL) || defined(PNG_IS_DLL)) */
 
-class RpPngPrivate
-{
-	private:
-		// RpPngPrivate is a static class.
-		RpPngPrivate();
-		~RpPngPrivate();
-		RP_DISABLE_COPY(RpPngPrivate)
-
-	public:
-		/** I/O functions. **/
-
-		/**
-		 * libpng I/O read handler for IRpFile.
-		 * @param png_ptr	[in]  PNG pointer.
-		 * @param data		[out] Buffer for the data to read.
-		 * @param length	[in]  Size of data.
-		 */
-		static void PNGCAPI png_io_IRpFile_read(png_structp png_ptr, png_bytep data, png_size_t length);
-
-		/**
-		 * libpng I/O write handler for IRpFile.
-		 * @param png_ptr	[in] PNG pointer.
-		 * @param data		[in] Data to write.
-		 * @param length	[in] Size of data.
-		 */
-		static void PNGCAPI png_io_IRpFile_write(png_structp png_ptr, png_bytep data, png_size_t length);
-
-		/**
-		 * libpng I/O flush handler for IRpFile.
-		 * @param png_ptr	[in] PNG pointer.
-		 */
-		static void PNGCAPI png_io_IRpFile_flush(png_structp png_ptr);
-
-		/** Error handler functions. **/
-
-#ifdef PNG_WARNINGS_SUPPORTED
-		/**
-		 * libpng warning handler function that simply ignores warnings.
-		 *
-		 * Certain PNG images have "known incorrect" sRGB profiles,
-		 * and we don't want libpng to spam stderr with warnings
-		 * about them.
-		 *
-		 * @param png_ptr	[in] PNG pointer.
-		 * @param msg		[in] Warning message.
-		 */
-		static void PNGCAPI png_warning_fn(png_structp png_ptr, png_const_charp msg);
-#endif /* PNG_WARNINGS_SUPPORTED */
-
-		/** Read functions. **/
-
-		/**
-		 * Read the palette for a CI8 image.
-		 * @param png_ptr png_structp
-		 * @param info_ptr png_infop
-		 * @param color_type PNG color type.
-		 * @param img rp_image to store the palette in.
-		 */
-		static void Read_CI8_Palette(png_structp png_ptr, png_infop info_ptr,
-					     int color_type, rp_image *img);
-
-		/**
-		 * Load a PNG image from an opened PNG handle.
-		 * @param png_ptr png_structp
-		 * @param info_ptr png_infop
-		 * @return rp_image*, or nullptr on error.
-		 */
-		static rp_image *loadPng(png_structp png_ptr, png_infop info_ptr);
-};
-
 /** RpPngPrivate **/
 
 /** I/O functions. **/
@@ -326,6 +248,83 @@ void RpPngPrivate::Read_CI8_Palette(png_structp png_ptr, png_infop info_ptr,
 	}
 }
 
+/**
+ * Get a row conversion function for a PNG image.
+ *
+ * This is only supported for non-interlaced 8-bit RGB (without tRNS),
+ * RGBA, and gray+alpha images, and only if the CPU supports SSSE3
+ * or AVX2. Otherwise, libpng's transformations must be used.
+ *
+ * @param png_ptr png_structp
+ * @param info_ptr png_infop
+ * @return Row conversion function, or nullptr if not supported.
+ */
+RpPngPrivate::convert_row_fn RpPngPrivate::getRowConverter(png_structp png_ptr, png_infop info_ptr)
+{
+#if defined(RPPNG_HAS_SSSE3) || defined(RPPNG_HAS_AVX2)
+	if (png_get_bit_depth(png_ptr, info_ptr) != 8 ||
+	    png_get_interlace_type(png_ptr, info_ptr) != PNG_INTERLACE_NONE)
+	{
+		// Only 8-bit non-interlaced images are supported.
+		return nullptr;
+	}
+
+	switch (png_get_color_type(png_ptr, info_ptr)) {
+		case PNG_COLOR_TYPE_RGB:
+			if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS) == PNG_INFO_tRNS) {
+				// tRNS is handled by libpng.
+				break;
+			}
+#ifdef RPPNG_HAS_AVX2
+			if (RP_CPU_HasAVX2()) {
+				return convertRGBtoARGB_avx2;
+			}
+#endif /* RPPNG_HAS_AVX2 */
+#ifdef RPPNG_HAS_SSSE3
+			if (RP_CPU_HasSSSE3()) {
+				return convertRGBtoARGB_ssse3;
+			}
+#endif /* RPPNG_HAS_SSSE3 */
+			break;
+
+		case PNG_COLOR_TYPE_RGB_ALPHA:
+#ifdef RPPNG_HAS_AVX2
+			if (RP_CPU_HasAVX2()) {
+				return convertRGBAtoARGB_avx2;
+			}
+#endif /* RPPNG_HAS_AVX2 */
+#ifdef RPPNG_HAS_SSSE3
+			if (RP_CPU_HasSSSE3()) {
+				return convertRGBAtoARGB_ssse3;
+			}
+#endif /* RPPNG_HAS_SSSE3 */
+			break;
+
+		case PNG_COLOR_TYPE_GRAY_ALPHA:
+#ifdef RPPNG_HAS_AVX2
+			if (RP_CPU_HasAVX2()) {
+				return convertGAtoARGB_avx2;
+			}
+#endif /* RPPNG_HAS_AVX2 */
+#ifdef RPPNG_HAS_SSSE3
+			if (RP_CPU_HasSSSE3()) {
+				return convertGAtoARGB_ssse3;
+			}
+#endif /* RPPNG_HAS_SSSE3 */
+			break;
+
+		default:
+			break;
+	}
+#else /* !(RPPNG_HAS_SSSE3 || RPPNG_HAS_AVX2) */
+	RP_UNUSED(png_ptr);
+	RP_UNUSED(info_ptr);
+#endif /* RPPNG_HAS_SSSE3 || RPPNG_HAS_AVX2 */
+
+	// No row conversion function.
+	return nullptr;
+}
+
 /**
  * Load a PNG image from an opened PNG handle.
  * @param png_ptr png_structp
@@ -334,9 +333,13 @@ void RpPngPrivate::Read_CI8_Palette(png_structp png_ptr, png_infop info_ptr,
  */
 rp_image *RpPngPrivate::loadPng(png_structp png_ptr, png_infop info_ptr)
 {
+	// NOTE: These are assigned after setjmp(), so they must be
+	// volatile in order to be valid in the error handler.
 	// Row pointers. (NOTE: Allocated after IHDR is read.)
-	const png_byte **row_pointers = nullptr;
-	rp_image *img = nullptr;
+	const png_byte **volatile row_pointers = nullptr;
+	// Row buffer for the row conversion function.
+	png_byte *volatile row_buf = nullptr;
+	rp_image *volatile img = nullptr;
 
 	bool has_sBIT = false;
 	png_color_8p png_sBIT = nullptr;
@@ -347,7 +350,8 @@ rp_image *RpPngPrivate::loadPng(png_structp png_ptr, png_infop info_ptr)
 	if (setjmp(png_jmpbuf(png_ptr))) {
 		// PNG read failed.
 		png_free(png_ptr, row_pointers);
-		img->unref();
+		png_free(png_ptr, row_buf);
+		UNREF(img);
 		return nullptr;
 	}
 #endif
@@ -387,6 +391,10 @@ rp_image *RpPngPrivate::loadPng(png_structp png_ptr, png_infop info_ptr)
 	}
 #endif /* PNG_sBIT_SUPPORTED */
 
+	// Check if the rows can be converted using SIMD instead of
+	// using libpng's transformations.
+	const convert_row_fn convert_row = getRowConverter(png_ptr, info_ptr);
+
 	// Check the color type.
 	bool is24bit = false;
 	rp_image::Format fmt;
@@ -416,7 +424,9 @@ rp_image *RpPngPrivate::loadPng(png_structp png_ptr, png_infop info_ptr)
 			// QImage, gdk-pixbuf, cairo, and GDI+ don't support IA8.
 			// TODO: Does this work with 1, 2, and 4-bit grayscale?
 			fmt = rp_image::Format::ARGB32;
-			png_set_gray_to_rgb(png_ptr);
+			if (!convert_row) {
+				png_set_gray_to_rgb(png_ptr);
+			}
 			if (!has_sBIT) {
 				const uint8_t bits = static_cast<uint8_t>(bit_depth > 8 ? 8 : bit_depth);
 				png_sBIT_fake.red = 0;
@@ -493,15 +503,17 @@ rp_image *RpPngPrivate::loadPng(png_structp png_ptr, png_infop info_ptr)
 	png_get_IHDR(png_ptr, info_ptr, &width, &height,
 		&bit_depth, &color_type, nullptr, nullptr, nullptr);
 
-	if (is24bit) {
-		// rp_image doesn't support 24-bit color.
-		// Expand it by having libpng fill the alpha channel
-		// with 0xFF (opaque).
-		png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
-	}
+	if (!convert_row) {
+		if (is24bit) {
+			// rp_image doesn't support 24-bit color.
+			// Expand it by having libpng fill the alpha channel
+			// with 0xFF (opaque).
+			png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
+		}
 
-	// We're using "BGR" color.
-	png_set_bgr(png_ptr);
+		// We're using "BGR" color.
+		png_set_bgr(png_ptr);
+	}
 
 	// Update the PNG info.
 	png_read_update_info(png_ptr, info_ptr);
@@ -516,24 +528,47 @@ rp_image *RpPngPrivate::loadPng(png_structp png_ptr, png_infop info_ptr)
 		return nullptr;
 	}
 
-	// Allocate the row pointers.
-	row_pointers = static_cast<const png_byte**>(
-		png_malloc(png_ptr, sizeof(const png_byte*) * height));
-	if (!row_pointers) {
-		img->unref();
-		return nullptr;
-	}
+	if (convert_row) {
+		// Read the image one row at a time and convert it
+		// using the row conversion function.
+		// NOTE: The row conversion functions require 32 bytes
+		// of padding past the end of the row.
+		row_buf = static_cast<png_byte*>(
+			png_malloc(png_ptr, png_get_rowbytes(png_ptr, info_ptr) + 32));
+		if (!row_buf) {
+			img->unref();
+			return nullptr;
+		}
 
-	// Initialize the row pointers array.
-	const png_byte *pb = static_cast<const png_byte*>(img->bits());
-	const int stride = img->stride();
-	for (png_uint_32 y = 0; y < height; y++, pb += stride) {
-		row_pointers[y] = pb;
-	}
+		uint32_t *dest = static_cast<uint32_t*>(img->bits());
+		const int dest_stride = img->stride() / sizeof(uint32_t);
+		for (png_uint_32 y = 0; y < height; y++, dest += dest_stride) {
+			png_read_row(png_ptr, row_buf, nullptr);
+			convert_row(dest, row_buf, width);
+		}
+		png_free(png_ptr, row_buf);
+		row_buf = nullptr;
+	} else {
+		// Allocate the row pointers.
+		row_pointers = static_cast<const png_byte**>(
+			png_malloc(png_ptr, sizeof(const png_byte*) * height));
+		if (!row_pointers) {
+			img->unref();
+			return nullptr;
+		}
+
+		// Initialize the row pointers array.
+		const png_byte *pb = static_cast<const png_byte*>(img->bits());
+		const int stride = img->stride();
+		for (png_uint_32 y = 0; y < height; y++, pb += stride) {
+			row_pointers[y] = pb;
+		}
 
-	// Read the image.
-	png_read_image(png_ptr, const_cast<png_byte**>(row_pointers));
-	png_free(png_ptr, row_pointers);
+		// Read the image.
+		png_read_image(png_ptr, const_cast<png_byte**>(row_pointers));
+		png_free(png_ptr, row_pointers);
+		row_pointers = nullptr;
+	}
 
 	// If CI8, read the palette.
 	if (fmt == rp_image::Format::CI8) {
@@ -651,9 +686,11 @@ rp_image *RpPng::load(IRpFile *file)
  *
  * @param file IRpFile to write to.
  * @param img rp_image to save.
+ * @param profile Encoding profile.
  * @return 0 on success; negative POSIX error code on error.
  */
-int RpPng::save(IRpFile *file, const rp_image *img)
+int RpPng::save(IRpFile *file, const rp_image *img,
+	RpPngWriter::EncodeProfile profile)
 {
 	assert(file != nullptr);
 	assert(img != nullptr);
@@ -665,8 +702,13 @@ int RpPng::save(IRpFile *file, const rp_image *img)
 	if (!pngWriter->isOpen())
 		return -pngWriter->lastError();
 
+	// Set the encoding profile.
+	int ret = pngWriter->setEncodeProfile(profile);
+	if (ret != 0)
+		return ret;
+
 	// Write the PNG IHDR.
-	int ret = pngWriter->write_IHDR();
+	ret = pngWriter->write_IHDR();
 	if (ret != 0)
 		return ret;
 
@@ -679,9 +721,11 @@ int RpPng::save(IRpFile *file, const rp_image *img)
  *
  * @param filename Destination filename.
  * @param img rp_image to save.
+ * @param profile Encoding profile.
  * @return 0 on success; negative POSIX error code on error.
  */
-int RpPng::save(const char *filename, const rp_image *img)
+int RpPng::save(const char *filename, const rp_image *img,
+	RpPngWriter::EncodeProfile profile)
 {
 	assert(filename != nullptr);
 	assert(filename[0] != 0);
@@ -694,8 +738,13 @@ int RpPng::save(const char *filename, const rp_image *img)
 	if (!pngWriter->isOpen())
 		return -pngWriter->lastError();
 
+	// Set the encoding profile.
+	int ret = pngWriter->setEncodeProfile(profile);
+	if (ret != 0)
+		return ret;
+
 	// Write the PNG IHDR.
-	int ret = pngWriter->write_IHDR();
+	ret = pngWriter->write_IHDR();
 	if (ret != 0)
 		return ret;
 
@@ -720,9 +769,11 @@ int RpPng::save(const char *filename, const rp_image *img)
  *
  * @param file IRpFile to write to.
  * @param iconAnimData Animated image data to save.
+ * @param profile Encoding profile.
  * @return 0 on success; negative POSIX error code on error.
  */
-int RpPng::save(IRpFile *file, const IconAnimData *iconAnimData)
+int RpPng::save(IRpFile *file, const IconAnimData *iconAnimData,
+	RpPngWriter::EncodeProfile profile)
 {
 	assert(file != nullptr);
 	assert(iconAnimData != nullptr);
@@ -734,8 +785,13 @@ int RpPng::save(IRpFile *file, const IconAnimData *iconAnimData)
 	if (!pngWriter->isOpen())
 		return -pngWriter->lastError();
 
+	// Set the encoding profile.
+	int ret = pngWriter->setEncodeProfile(profile);
+	if (ret != 0)
+		return ret;
+
 	// Write the PNG IHDR.
-	int ret = pngWriter->write_IHDR();
+	ret = pngWriter->write_IHDR();
 	if (ret != 0)
 		return ret;
 
@@ -757,9 +813,11 @@ int RpPng::save(IRpFile *file, const IconAnimData *iconAnimData)
  *
  * @param filename Destination filename.
  * @param iconAnimData Animated image data to save.
+ * @param profile Encoding profile.
  * @return 0 on success; negative POSIX error code on error.
  */
-int RpPng::save(const char *filename, const IconAnimData *iconAnimData)
+int RpPng::save(const char *filename, const IconAnimData *iconAnimData,
+	RpPngWriter::EncodeProfile profile)
 {
 	assert(filename != nullptr);
 	assert(filename[0] != 0);
@@ -772,8 +830,13 @@ int RpPng::save(const char *filename, const IconAnimData *iconAnimData)
 	if (!pngWriter->isOpen())
 		return -pngWriter->lastError();
 
+	// Set the encoding profile.
+	int ret = pngWriter->setEncodeProfile(profile);
+	if (ret != 0)
+		return ret;
+
 	// Write the PNG IHDR.
-	int ret = pngWriter->write_IHDR();
+	ret = pngWriter->write_IHDR();
 	if (ret != 0)
 		return ret;
 
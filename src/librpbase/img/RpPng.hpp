@@ -10,6 +10,7 @@
 #define __ROMPROPERTIES_LIBRPBASE_IMG_RPPNG_HPP__
 
 #include "common.h"
+#include "RpPngWriter.hpp"
 
 namespace LibRpFile {
 	class IRpFile;
@@ -62,18 +63,22 @@ class RpPng
 		 *
 		 * @param file IRpFile to write to.
 		 * @param img rp_image to save.
+		 * @param profile Encoding profile.
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		static int save(LibRpFile::IRpFile *file, const LibRpTexture::rp_image *img);
+		static int save(LibRpFile::IRpFile *file, const LibRpTexture::rp_image *img,
+			RpPngWriter::EncodeProfile profile = RpPngWriter::EncodeProfile::Balanced);
 
 		/**
 		 * Save an image in PNG format to a file.
 		 *
 		 * @param filename Destination filename.
 		 * @param img rp_image to save.
+		 * @param profile Encoding profile.
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		static int save(const char *filename, const LibRpTexture::rp_image *img);
+		static int save(const char *filename, const LibRpTexture::rp_image *img,
+			RpPngWriter::EncodeProfile profile = RpPngWriter::EncodeProfile::Balanced);
 
 		/**
 		 * Save an animated image in APNG format to an IRpFile.
@@ -92,9 +97,11 @@ class RpPng
 		 *
 		 * @param file IRpFile to write to.
 		 * @param iconAnimData Animated image data to save.
+		 * @param profile Encoding profile.
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		static int save(LibRpFile::IRpFile *file, const IconAnimData *iconAnimData);
+		static int save(LibRpFile::IRpFile *file, const IconAnimData *iconAnimData,
+			RpPngWriter::EncodeProfile profile = RpPngWriter::EncodeProfile::Balanced);
 
 		/**
 		 * Save an animated image in APNG format to a file.
@@ -109,9 +116,11 @@ class RpPng
 		 *
 		 * @param filename Destination filename.
 		 * @param iconAnimData Animated image data to save.
+		 * @param profile Encoding profile.
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		static int save(const char *filename, const IconAnimData *iconAnimData);
+		static int save(const char *filename, const IconAnimData *iconAnimData,
+			RpPngWriter::EncodeProfile profile = RpPngWriter::EncodeProfile::Balanced);
 };
 
 }
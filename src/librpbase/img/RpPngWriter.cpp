@@ -29,6 +29,8 @@ using LibRpTexture::argb32_t;
 
 // libpng
 #include <png.h>
+// zlib: Needed for Z_RLE.
+#include <zlib.h>
 
 #if PNG_LIBPNG_VER < 10209 || \
     (PNG_LIBPNG_VER == 10209 && \
@@ -83,8 +85,6 @@ using std::unique_ptr;
 using std::vector;
 
 #if defined(_MSC_VER) && (defined(ZLIB_IS_DLL) || defined(PNG_IS_DLL))
-// Need zlib for delay-load checks.
-#include <zlib.h>
 // MSVC: Exception handling for /DELAYLOAD.
 #include "libwin32common/DelayLoadHelper.h"
 #endif /* defined(_MSC_VER) && (defined(ZLIB_IS_DLL) || defined(PNG_IS_DLL)) */
@@ -117,26 +117,34 @@ class RpPngWriterPrivate
 		// ref() is done here if needed.
 		RpPngWriterPrivate(IRpFile *file, int width, int height, rp_image::Format format)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
-			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, png_ptr(nullptr), info_ptr(nullptr)
+			, encodeProfile(RpPngWriter::EncodeProfile::Balanced)
+			, IHDR_written(false), rows_written(0)
 		{
 			init(file, width, height, format);
 		}
 		RpPngWriterPrivate(IRpFile *file, const rp_image *img)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
-			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, png_ptr(nullptr), info_ptr(nullptr)
+			, encodeProfile(RpPngWriter::EncodeProfile::Balanced)
+			, IHDR_written(false), rows_written(0)
 		{
 			init(file, img);
 		}
 		RpPngWriterPrivate(IRpFile *file, const IconAnimData *iconAnimData)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
-			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, png_ptr(nullptr), info_ptr(nullptr)
+			, encodeProfile(RpPngWriter::EncodeProfile::Balanced)
+			, IHDR_written(false), rows_written(0)
 		{
 			init(file, iconAnimData);
 		}
 
 		RpPngWriterPrivate(const char *filename, int width, int height, rp_image::Format format)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
-			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, png_ptr(nullptr), info_ptr(nullptr)
+			, encodeProfile(RpPngWriter::EncodeProfile::Balanced)
+			, IHDR_written(false), rows_written(0)
 		{
 			RpFile *const file = (filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(file, width, height, format);
@@ -144,7 +152,9 @@ class RpPngWriterPrivate
 		}
 		RpPngWriterPrivate(const char *filename, const rp_image *img)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
-			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, png_ptr(nullptr), info_ptr(nullptr)
+			, encodeProfile(RpPngWriter::EncodeProfile::Balanced)
+			, IHDR_written(false), rows_written(0)
 		{
 			RpFile *const file = (filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(file, img);
@@ -152,7 +162,9 @@ class RpPngWriterPrivate
 		}
 		RpPngWriterPrivate(const char *filename, const IconAnimData *iconAnimData)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
-			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, png_ptr(nullptr), info_ptr(nullptr)
+			, encodeProfile(RpPngWriter::EncodeProfile::Balanced)
+			, IHDR_written(false), rows_written(0)
 		{
 			RpFile *const file = (filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(file, iconAnimData);
@@ -273,8 +285,27 @@ class RpPngWriterPrivate
 		png_structp png_ptr;
 		png_infop info_ptr;
 
+		// Encoding profile.
+		RpPngWriter::EncodeProfile encodeProfile;
+
 		// Current state.
 		bool IHDR_written;
+		int rows_written;	// Rows written using write_IDAT_rows().
+
+		// APNG frame to write.
+		// Duplicate frames are merged, and subsequent frames
+		// only contain the region that changed since the
+		// previous frame.
+		struct apng_frame_t {
+			const rp_image *img;	// Source image.
+			const rp_image *prev;	// Previous image. (for PNG_BLEND_OP_OVER)
+			int x, y, w, h;		// Region to write.
+			uint16_t delay_numer;	// Delay numerator.
+			uint16_t delay_denom;	// Delay denominator.
+			uint8_t blend_op;	// PNG_BLEND_OP_*
+		};
+		vector<apng_frame_t> apng_frames;
+		vector<uint32_t> apng_blend_buf;	// Buffer for PNG_BLEND_OP_OVER frames.
 
 	public:
 		/**
@@ -313,6 +344,12 @@ class RpPngWriterPrivate
 		 */
 		int write_CI8_palette(void);
 
+		/**
+		 * Set the libpng transformations for writing image rows.
+		 * @param is_abgr If true, image data is ABGR instead of ARGB.
+		 */
+		void set_IDAT_transforms(bool is_abgr);
+
 		/**
 		 * Write raw image data to the PNG image.
 		 *
@@ -339,6 +376,35 @@ class RpPngWriterPrivate
 		 */
 		int write_IDAT(void);
 
+		/**
+		 * Find the region that differs between two images.
+		 * @param pixel Pixel type. (uint32_t for ARGB32; uint8_t for CI8)
+		 * @param prev	[in] Previous image.
+		 * @param img	[in] Current image.
+		 * @param frame	[out] APNG frame. (x, y, w, h, and blend_op are set)
+		 * @return True if the images differ; false if they're identical.
+		 */
+		template<typename pixel>
+		bool find_dirty_rect(const rp_image *prev, const rp_image *img, apng_frame_t &frame) const;
+
+		/**
+		 * Add a sequence delay to a previously-planned APNG frame.
+		 * This is used when a frame is identical to the previous frame.
+		 * @param frame	[in,out] APNG frame.
+		 * @param delay	[in] Delay to add.
+		 * @return True on success; false if the delays can't be represented as a single fraction.
+		 */
+		static bool add_APNG_delay(apng_frame_t &frame, const IconAnimData::delay_t &delay);
+
+		/**
+		 * Determine which APNG frames to write.
+		 * This must be called before writing acTL.
+		 *
+		 * Frames that are identical to the previous frame are merged,
+		 * and other frames are reduced to the region that changed.
+		 */
+		void calc_APNG_frames(void);
+
 		/**
 		 * Write the animated image data to the PNG image.
 		 *
@@ -710,6 +776,32 @@ int RpPngWriterPrivate::write_CI8_palette(void)
 	return 0;
 }
 
+/**
+ * Set the libpng transformations for writing image rows.
+ * @param is_abgr If true, image data is ABGR instead of ARGB.
+ */
+void RpPngWriterPrivate::set_IDAT_transforms(bool is_abgr)
+{
+	// TODO: Byteswap image data on big-endian systems?
+	//png_set_swap(png_ptr);
+
+	// TODO: What format on big-endian?
+	if (!is_abgr) {
+		png_set_bgr(png_ptr);
+	}
+
+	if (cache.skip_alpha && cache.format == rp_image::Format::ARGB32) {
+		// Need to skip the alpha bytes.
+		// Assuming 'after' on LE, 'before' on BE.
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
+		static const int flags = PNG_FILLER_AFTER;
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+		static const int flags = PNG_FILLER_BEFORE;
+#endif
+		png_set_filler(png_ptr, 0xFF, flags);
+	}
+}
+
 /**
  * Write raw image data to the PNG image.
  *
@@ -747,26 +839,8 @@ int RpPngWriterPrivate::write_IDAT(const png_byte *const *row_pointers, bool is_
 	}
 #endif /* PNG_SETJMP_SUPPORTED */
 
-	// TODO: Byteswap image data on big-endian systems?
-	//png_set_swap(png_ptr);
-
-	// TODO: What format on big-endian?
-	if (!is_abgr) {
-		png_set_bgr(png_ptr);
-	}
-
-	if (cache.skip_alpha && cache.format == rp_image::Format::ARGB32) {
-		// Need to skip the alpha bytes.
-		// Assuming 'after' on LE, 'before' on BE.
-#if SYS_BYTEORDER == SYS_LIL_ENDIAN
-		static const int flags = PNG_FILLER_AFTER;
-#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
-		static const int flags = PNG_FILLER_BEFORE;
-#endif
-		png_set_filler(png_ptr, 0xFF, flags);
-	}
-
 	// Write the image data.
+	set_IDAT_transforms(is_abgr);
 	png_write_image(png_ptr, const_cast<png_bytepp>(row_pointers));
 	return 0;
 }
@@ -819,6 +893,198 @@ int RpPngWriterPrivate::write_IDAT(void)
 	return ret;
 }
 
+/**
+ * Find the region that differs between two images.
+ * @param pixel Pixel type. (uint32_t for ARGB32; uint8_t for CI8)
+ * @param prev	[in] Previous image.
+ * @param img	[in] Current image.
+ * @param frame	[out] APNG frame. (x, y, w, h, and blend_op are set)
+ * @return True if the images differ; false if they're identical.
+ */
+template<typename pixel>
+bool RpPngWriterPrivate::find_dirty_rect(const rp_image *prev, const rp_image *img, apng_frame_t &frame) const
+{
+	const int width = cache.width;
+	const int height = cache.height;
+	const size_t row_bytes = width * sizeof(pixel);
+
+	// Find the first and last rows that differ.
+	int top = 0;
+	for (; top < height; top++) {
+		if (memcmp(prev->scanLine(top), img->scanLine(top), row_bytes) != 0)
+			break;
+	}
+	if (top == height) {
+		// Images are identical.
+		return false;
+	}
+	int bottom = height - 1;
+	for (; bottom > top; bottom--) {
+		if (memcmp(prev->scanLine(bottom), img->scanLine(bottom), row_bytes) != 0)
+			break;
+	}
+
+	// Find the first and last columns that differ.
+	int left = width, right = -1;
+	for (int y = top; y <= bottom; y++) {
+		const pixel *const p = static_cast<const pixel*>(prev->scanLine(y));
+		const pixel *const q = static_cast<const pixel*>(img->scanLine(y));
+		for (int x = 0; x < left; x++) {
+			if (p[x] != q[x]) {
+				left = x;
+				break;
+			}
+		}
+		for (int x = width - 1; x > right; x--) {
+			if (p[x] != q[x]) {
+				right = x;
+				break;
+			}
+		}
+	}
+	assert(left <= right);
+
+	frame.x = left;
+	frame.y = top;
+	frame.w = right - left + 1;
+	frame.h = bottom - top + 1;
+	frame.blend_op = PNG_BLEND_OP_SOURCE;
+
+	// If all of the changed pixels are opaque, unchanged pixels can be
+	// written as transparent and blended over the previous frame.
+	// This usually compresses better than the original pixels.
+	// NOTE: Only possible if the alpha channel is being written.
+#ifdef PNG_sBIT_SUPPORTED
+	if (sizeof(pixel) != sizeof(uint32_t) || cache.skip_alpha)
+		return true;
+#else /* !PNG_sBIT_SUPPORTED */
+	if (sizeof(pixel) != sizeof(uint32_t))
+		return true;
+#endif /* PNG_sBIT_SUPPORTED */
+
+	bool has_unchanged = false;
+	for (int y = top; y <= bottom; y++) {
+		const uint32_t *const p = static_cast<const uint32_t*>(prev->scanLine(y));
+		const uint32_t *const q = static_cast<const uint32_t*>(img->scanLine(y));
+		for (int x = left; x <= right; x++) {
+			if (p[x] == q[x]) {
+				has_unchanged = true;
+			} else if ((q[x] >> 24) != 0xFF) {
+				// Changed pixel isn't opaque.
+				return true;
+			}
+		}
+	}
+	if (has_unchanged) {
+		frame.blend_op = PNG_BLEND_OP_OVER;
+	}
+	return true;
+}
+
+/**
+ * Add a sequence delay to a previously-planned APNG frame.
+ * This is used when a frame is identical to the previous frame.
+ * @param frame	[in,out] APNG frame.
+ * @param delay	[in] Delay to add.
+ * @return True on success; false if the delays can't be represented as a single fraction.
+ */
+bool RpPngWriterPrivate::add_APNG_delay(apng_frame_t &frame, const IconAnimData::delay_t &delay)
+{
+	// NOTE: APNG treats a denominator of 0 as 100.
+	const unsigned int d1 = (frame.delay_denom != 0 ? frame.delay_denom : 100);
+	const unsigned int d2 = (delay.denom != 0 ? delay.denom : 100);
+
+	// Use the least common multiple of the denominators.
+	unsigned int a = d1, b = d2;
+	while (b != 0) {
+		const unsigned int t = a % b;
+		a = b;
+		b = t;
+	}
+	const unsigned int denom = d1 / a * d2;
+	if (denom > 0xFFFF)
+		return false;
+	const unsigned int numer = (frame.delay_numer * (denom / d1)) + (delay.numer * (denom / d2));
+	if (numer > 0xFFFF)
+		return false;
+
+	frame.delay_numer = static_cast<uint16_t>(numer);
+	frame.delay_denom = static_cast<uint16_t>(denom);
+	return true;
+}
+
+/**
+ * Determine which APNG frames to write.
+ * This must be called before writing acTL.
+ *
+ * Frames that are identical to the previous frame are merged,
+ * and other frames are reduced to the region that changed.
+ */
+void RpPngWriterPrivate::calc_APNG_frames(void)
+{
+	assert(imageTag == ImageTag::IconAnimData);
+	apng_frames.clear();
+	apng_frames.reserve(iconAnimData->seq_count);
+
+	const rp_image *prev = nullptr;
+	for (int i = 0; i < iconAnimData->seq_count; i++) {
+		const IconAnimData::delay_t &delay = iconAnimData->delays[i];
+		const rp_image *img = iconAnimData->frames[iconAnimData->seq_index[i]];
+		if (!img) {
+			// nullptr means "use the previous frame".
+			img = prev;
+		}
+
+		apng_frame_t frame;
+		frame.img = img;
+		frame.prev = prev;
+		frame.x = 0;
+		frame.y = 0;
+		// NOTE: Frames must fit within the first frame's dimensions.
+		frame.w = std::min(img->width(), cache.width);
+		frame.h = std::min(img->height(), cache.height);
+		frame.delay_numer = delay.numer;
+		frame.delay_denom = delay.denom;
+		frame.blend_op = PNG_BLEND_OP_SOURCE;
+
+		// Only compare frames that match the first frame's
+		// dimensions and format. Other frames are written
+		// in full.
+		if (prev && prev->format() == cache.format &&
+		    img->format() == cache.format &&
+		    prev->width() == cache.width && prev->height() == cache.height &&
+		    img->width() == cache.width && img->height() == cache.height)
+		{
+			bool differs;
+			if (img == prev) {
+				differs = false;
+			} else if (cache.format == rp_image::Format::CI8) {
+				differs = find_dirty_rect<uint8_t>(prev, img, frame);
+			} else {
+				differs = find_dirty_rect<uint32_t>(prev, img, frame);
+			}
+
+			if (!differs) {
+				// Identical to the previous frame.
+				// Extend the previous frame's delay.
+				if (add_APNG_delay(apng_frames.back(), delay))
+					continue;
+
+				// Delays can't be merged. Write a single pixel
+				// from the unchanged image to keep the timing.
+				frame.w = 1;
+				frame.h = 1;
+			}
+		}
+
+		if (frame.blend_op == PNG_BLEND_OP_OVER && apng_blend_buf.empty()) {
+			apng_blend_buf.resize(cache.width * cache.height);
+		}
+		apng_frames.push_back(frame);
+		prev = img;
+	}
+}
+
 /**
  * Write the animated image data to the PNG image.
  *
@@ -851,8 +1117,9 @@ int RpPngWriterPrivate::write_IDAT_APNG(void)
 	const png_byte **row_pointers = nullptr;
 
 	// Using the cached width/height from the first image.
-	// TODO: Handle animated images where the different frames
-	// have different widths, heights, and/or formats.
+	// Frames were planned by calc_APNG_frames() in write_IHDR().
+	const int bytespp = (cache.format == rp_image::Format::CI8 ? 1 : 4);
+	const size_t frame_count = apng_frames.size();
 
 #ifdef PNG_SETJMP_SUPPORTED
 	// WARNING: Do NOT initialize any C++ objects past this point!
@@ -863,10 +1130,8 @@ int RpPngWriterPrivate::write_IDAT_APNG(void)
 	}
 #endif /* PNG_SETJMP_SUPPORTED */
 
-	// TODO: Byteswap image data on big-endian systems?
-	//ppng_set_swap(png_ptr);
-	// TODO: What format on big-endian?
-	png_set_bgr(png_ptr);
+	// Set the libpng transformations.
+	set_IDAT_transforms(false);
 
 	// Allocate the row pointers.
 	row_pointers = static_cast<const png_byte**>(
@@ -877,23 +1142,38 @@ int RpPngWriterPrivate::write_IDAT_APNG(void)
 	}
 
 	// Write the images.
-	for (int i = 0; i < iconAnimData->seq_count; i++) {
-		const rp_image *const img = iconAnimData->frames[iconAnimData->seq_index[i]];
-		if (!img)
-			break;
+	for (size_t i = 0; i < frame_count; i++) {
+		const apng_frame_t *const frame = &apng_frames[i];
 
 		// Initialize the row pointers array.
-		for (int y = cache.height-1; y >= 0; y--) {
-			row_pointers[y] = static_cast<const png_byte*>(img->scanLine(y));
+		if (frame->blend_op == PNG_BLEND_OP_OVER) {
+			// Unchanged pixels are transparent so the
+			// previous frame will show through.
+			uint32_t *dest = apng_blend_buf.data();
+			for (int y = 0; y < frame->h; y++, dest += frame->w) {
+				const uint32_t *const src = static_cast<const uint32_t*>(
+					frame->img->scanLine(frame->y + y)) + frame->x;
+				const uint32_t *const src_prev = static_cast<const uint32_t*>(
+					frame->prev->scanLine(frame->y + y)) + frame->x;
+				for (int x = 0; x < frame->w; x++) {
+					dest[x] = (src[x] != src_prev[x] ? src[x] : 0);
+				}
+				row_pointers[y] = reinterpret_cast<const png_byte*>(dest);
+			}
+		} else {
+			for (int y = frame->h-1; y >= 0; y--) {
+				row_pointers[y] = static_cast<const png_byte*>(
+					frame->img->scanLine(frame->y + y)) + (frame->x * bytespp);
+			}
 		}
 
 		// Frame header.
 		png_write_frame_head(png_ptr, info_ptr, (png_bytepp)row_pointers,
-				cache.width, cache.height, 0, 0,	// width, height, x offset, y offset
-				iconAnimData->delays[i].numer,
-				iconAnimData->delays[i].denom,
+				frame->w, frame->h, frame->x, frame->y,
+				frame->delay_numer,
+				frame->delay_denom,
 				PNG_DISPOSE_OP_NONE,
-				PNG_BLEND_OP_SOURCE);
+				frame->blend_op);
 
 		// Write the image data.
 		// TODO: Individual palette for CI8?
@@ -1082,6 +1362,41 @@ void RpPngWriter::close(void)
 	d->close();
 }
 
+/**
+ * Set the PNG encoding profile.
+ * This must be called before write_IHDR().
+ * @param profile Encoding profile.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpPngWriter::setEncodeProfile(EncodeProfile profile)
+{
+	RP_D(RpPngWriter);
+	assert(profile >= EncodeProfile::Fast && profile < EncodeProfile::Max);
+	if (profile < EncodeProfile::Fast || profile >= EncodeProfile::Max) {
+		// Invalid profile.
+		return -EINVAL;
+	}
+	if (unlikely(d->IHDR_written)) {
+		// IHDR has already been written.
+		// Compression parameters can't be changed.
+		d->lastError = EEXIST;
+		return -d->lastError;
+	}
+
+	d->encodeProfile = profile;
+	return 0;
+}
+
+/**
+ * Get the PNG encoding profile.
+ * @return Encoding profile.
+ */
+RpPngWriter::EncodeProfile RpPngWriter::encodeProfile(void) const
+{
+	RP_D(const RpPngWriter);
+	return d->encodeProfile;
+}
+
 /**
  * Write the PNG IHDR.
  * This must be called before writing any other image data.
@@ -1117,9 +1432,27 @@ int RpPngWriter::write_IHDR(void)
 #endif /* PNG_SETJMP_SUPPORTED */
 
 	// Initialize compression parameters.
-	// TODO: Customizable?
-	png_set_filter(d->png_ptr, 0, PNG_FILTER_NONE);
-	png_set_compression_level(d->png_ptr, PNG_Z_DEFAULT_COMPRESSION);
+	switch (d->encodeProfile) {
+		case EncodeProfile::Fast:
+			// Sub is the cheapest filter that still helps with
+			// gradients, and Z_RLE skips the hash chain search.
+			png_set_filter(d->png_ptr, 0, PNG_FILTER_SUB);
+			png_set_compression_level(d->png_ptr, 1);
+			png_set_compression_strategy(d->png_ptr, Z_RLE);
+			break;
+
+		case EncodeProfile::Balanced:
+		default:
+			png_set_filter(d->png_ptr, 0, PNG_FILTER_NONE);
+			png_set_compression_level(d->png_ptr, PNG_Z_DEFAULT_COMPRESSION);
+			break;
+
+		case EncodeProfile::Small:
+			// libpng selects the filter for each row.
+			png_set_filter(d->png_ptr, 0, PNG_ALL_FILTERS);
+			png_set_compression_level(d->png_ptr, 9);
+			break;
+	}
 
 	// Write the PNG header.
 	switch (d->cache.format) {
@@ -1169,8 +1502,12 @@ int RpPngWriter::write_IHDR(void)
 	}
 
 	if (d->imageTag == RpPngWriterPrivate::ImageTag::IconAnimData) {
+		// Determine which frames need to be written.
+		d->calc_APNG_frames();
+
 		// Write an acTL chunk to indicate that this is an APNG image.
-		png_set_acTL(d->png_ptr, d->info_ptr, d->iconAnimData->seq_count, 0);
+		png_set_acTL(d->png_ptr, d->info_ptr,
+			static_cast<png_uint_32>(d->apng_frames.size()), 0);
 	}
 
 #ifdef PNG_sBIT_SUPPORTED
@@ -1414,10 +1751,80 @@ int RpPngWriter::write_IDAT(const uint8_t *const *row_pointers, bool is_abgr)
 		// Can't be used for this type.
 		return -EINVAL;
 	}
+	assert(d->rows_written == 0);
+	if (unlikely(d->rows_written != 0)) {
+		// Rows were already written using write_IDAT_rows().
+		d->lastError = EEXIST;
+		return -d->lastError;
+	}
 
 	return d->write_IDAT(row_pointers, is_abgr);
 }
 
+/**
+ * Write some rows of raw image data to the PNG image.
+ *
+ * This allows an image to be written incrementally, e.g. as
+ * it's being decoded, so the full image doesn't need to be
+ * kept in memory. Call this function repeatedly until all
+ * rows have been written. Rows are written from top to bottom.
+ *
+ * Once all rows have been written, close() will finish
+ * writing the PNG file.
+ *
+ * NOTE: This version is *only* for raw images!
+ *
+ * @param row_pointers PNG row pointers. Array must have `count` elements.
+ * @param count Number of rows to write.
+ * @param is_abgr If true, image data is ABGR instead of ARGB. (Must be the same for all calls.)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpPngWriter::write_IDAT_rows(const uint8_t *const *row_pointers, int count, bool is_abgr)
+{
+	assert(row_pointers != nullptr);
+	assert(count > 0);
+	if (unlikely(!row_pointers || count <= 0)) {
+		return -EINVAL;
+	}
+
+	RP_D(RpPngWriter);
+	assert(d->imageTag == RpPngWriterPrivate::ImageTag::Raw);
+	if (unlikely(d->imageTag != RpPngWriterPrivate::ImageTag::Raw)) {
+		// Can't be used for this type.
+		return -EINVAL;
+	}
+	assert(d->file != nullptr);
+	assert(d->IHDR_written);
+	if (unlikely(!d->file || !d->IHDR_written)) {
+		// Invalid state.
+		d->lastError = EIO;
+		return -d->lastError;
+	}
+	if (unlikely(count > d->cache.height - d->rows_written)) {
+		// Too many rows.
+		return -EINVAL;
+	}
+
+#ifdef PNG_SETJMP_SUPPORTED
+	// WARNING: Do NOT initialize any C++ objects past this point!
+	if (setjmp(png_jmpbuf(d->png_ptr))) {
+		// PNG write failed.
+		d->lastError = EIO;
+		return -d->lastError;
+	}
+#endif /* PNG_SETJMP_SUPPORTED */
+
+	if (d->rows_written == 0) {
+		// First set of rows.
+		d->set_IDAT_transforms(is_abgr);
+	}
+
+	// Write the image data.
+	png_write_rows(d->png_ptr, const_cast<png_bytepp>(row_pointers), count);
+	d->rows_written += count;
+	return 0;
+}
+
 /**
  * Write the rp_image data to the PNG image.
  *
@@ -172,6 +172,42 @@ class RpPngWriter
 		 */
 		void close(void);
 
+	public:
+		/**
+		 * PNG encoding profile.
+		 * Selects the row filters and zlib parameters.
+		 */
+		enum class EncodeProfile : uint8_t {
+			// Fastest encoding: zlib level 1, Z_RLE strategy,
+			// and the Sub filter. Recommended for thumbnail
+			// caches, where encoding time matters more than size.
+			Fast,
+
+			// Balanced: default zlib level, no filtering.
+			Balanced,
+
+			// Smallest output: zlib level 9 with adaptive filtering.
+			// Significantly slower than the other profiles.
+			Small,
+
+			Max
+		};
+
+		/**
+		 * Set the PNG encoding profile.
+		 * This must be called before write_IHDR().
+		 * @param profile Encoding profile.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int setEncodeProfile(EncodeProfile profile);
+
+		/**
+		 * Get the PNG encoding profile.
+		 * @return Encoding profile.
+		 */
+		EncodeProfile encodeProfile(void) const;
+
+	public:
 		/**
 		 * Write the PNG IHDR.
 		 * This must be called before writing any other image data.
@@ -236,6 +272,26 @@ class RpPngWriter
 		 */
 		int write_IDAT(const uint8_t *const *row_pointers, bool is_abgr = false);
 
+		/**
+		 * Write some rows of raw image data to the PNG image.
+		 *
+		 * This allows an image to be written incrementally, e.g. as
+		 * it's being decoded, so the full image doesn't need to be
+		 * kept in memory. Call this function repeatedly until all
+		 * rows have been written. Rows are written from top to bottom.
+		 *
+		 * Once all rows have been written, close() will finish
+		 * writing the PNG file.
+		 *
+		 * NOTE: This version is *only* for raw images!
+		 *
+		 * @param row_pointers PNG row pointers. Array must have `count` elements.
+		 * @param count Number of rows to write.
+		 * @param is_abgr If true, image data is ABGR instead of ARGB. (Must be the same for all calls.)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int write_IDAT_rows(const uint8_t *const *row_pointers, int count, bool is_abgr = false);
+
 		/**
 		 * Write the rp_image data to the PNG image.
 		 *
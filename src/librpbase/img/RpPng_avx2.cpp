@@ -0,0 +1,140 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * RpPng_avx2.cpp: PNG image handler.                                      *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RpPng_p.hpp"
+
+// librptexture
+using LibRpTexture::argb32_t;
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+namespace LibRpBase {
+
+/**
+ * Convert a row of 24-bit RGB pixels to 32-bit ARGB.
+ * AVX2-optimized version.
+ * @param dest	[out] Destination row. (ARGB32)
+ * @param src	[in] Source row. (RGB)
+ * @param width	[in] Width, in pixels.
+ */
+void RpPngPrivate::convertRGBtoARGB_avx2(uint32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width)
+{
+	// Each 32-byte load contains 8 pixels (24 bytes) plus 8 unused bytes.
+	// vpermd moves pixels 0-3 to the low lane and 4-7 to the high lane,
+	// and then vpshufb converts them to ARGB32 within each lane.
+	// NOTE: The last load reads 8 bytes past the 16th pixel, so the
+	// source buffer must be padded.
+	const __m256i perm_mask = _mm256_setr_epi32(0,1,2,0, 3,4,5,0);
+	const __m256i shuf_mask = _mm256_setr_epi8(
+		2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1,
+		2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1);
+	const __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+
+	// Process 16 pixels per iteration using AVX2.
+	unsigned int x = width;
+	for (; x > 15; x -= 16, dest += 16, src += 16*3) {
+		__m256i *ymm_dest = reinterpret_cast<__m256i*>(dest);
+
+		__m256i sa = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+		__m256i sb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 8*3));
+		sa = _mm256_permutevar8x32_epi32(sa, perm_mask);
+		sb = _mm256_permutevar8x32_epi32(sb, perm_mask);
+		sa = _mm256_or_si256(_mm256_shuffle_epi8(sa, shuf_mask), alpha_mask);
+		sb = _mm256_or_si256(_mm256_shuffle_epi8(sb, shuf_mask), alpha_mask);
+		_mm256_storeu_si256(&ymm_dest[0], sa);
+		_mm256_storeu_si256(&ymm_dest[1], sb);
+	}
+
+	// Remaining pixels.
+	argb32_t *px_dest = reinterpret_cast<argb32_t*>(dest);
+	for (; x > 0; x--, px_dest++, src += 3) {
+		px_dest->b = src[2];
+		px_dest->g = src[1];
+		px_dest->r = src[0];
+		px_dest->a = 0xFF;
+	}
+}
+
+/**
+ * Convert a row of 32-bit RGBA pixels to 32-bit ARGB.
+ * AVX2-optimized version.
+ * @param dest	[out] Destination row. (ARGB32)
+ * @param src	[in] Source row. (RGBA)
+ * @param width	[in] Width, in pixels.
+ */
+void RpPngPrivate::convertRGBAtoARGB_avx2(uint32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width)
+{
+	// Swap the R and B channels.
+	const __m256i shuf_mask = _mm256_setr_epi8(
+		2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15,
+		2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15);
+
+	// Process 16 pixels per iteration using AVX2.
+	unsigned int x = width;
+	for (; x > 15; x -= 16, dest += 16, src += 16*4) {
+		const __m256i *ymm_src = reinterpret_cast<const __m256i*>(src);
+		__m256i *ymm_dest = reinterpret_cast<__m256i*>(dest);
+
+		const __m256i sa = _mm256_loadu_si256(&ymm_src[0]);
+		const __m256i sb = _mm256_loadu_si256(&ymm_src[1]);
+		_mm256_storeu_si256(&ymm_dest[0], _mm256_shuffle_epi8(sa, shuf_mask));
+		_mm256_storeu_si256(&ymm_dest[1], _mm256_shuffle_epi8(sb, shuf_mask));
+	}
+
+	// Remaining pixels.
+	argb32_t *px_dest = reinterpret_cast<argb32_t*>(dest);
+	for (; x > 0; x--, px_dest++, src += 4) {
+		px_dest->b = src[2];
+		px_dest->g = src[1];
+		px_dest->r = src[0];
+		px_dest->a = src[3];
+	}
+}
+
+/**
+ * Convert a row of 16-bit gray+alpha pixels to 32-bit ARGB.
+ * AVX2-optimized version.
+ * @param dest	[out] Destination row. (ARGB32)
+ * @param src	[in] Source row. (GA)
+ * @param width	[in] Width, in pixels.
+ */
+void RpPngPrivate::convertGAtoARGB_avx2(uint32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width)
+{
+	// Each 16-byte load contains 8 pixels. It's broadcast to both
+	// lanes, and then vpshufb expands pixels 0-3 in the low lane
+	// and pixels 4-7 in the high lane.
+	const __m256i shuf_mask = _mm256_setr_epi8(
+		0,0,0,1, 2,2,2,3, 4,4,4,5, 6,6,6,7,
+		8,8,8,9, 10,10,10,11, 12,12,12,13, 14,14,14,15);
+
+	// Process 16 pixels per iteration using AVX2.
+	unsigned int x = width;
+	for (; x > 15; x -= 16, dest += 16, src += 16*2) {
+		const __m128i *xmm_src = reinterpret_cast<const __m128i*>(src);
+		__m256i *ymm_dest = reinterpret_cast<__m256i*>(dest);
+
+		const __m256i sa = _mm256_broadcastsi128_si256(_mm_loadu_si128(&xmm_src[0]));
+		const __m256i sb = _mm256_broadcastsi128_si256(_mm_loadu_si128(&xmm_src[1]));
+		_mm256_storeu_si256(&ymm_dest[0], _mm256_shuffle_epi8(sa, shuf_mask));
+		_mm256_storeu_si256(&ymm_dest[1], _mm256_shuffle_epi8(sb, shuf_mask));
+	}
+
+	// Remaining pixels.
+	argb32_t *px_dest = reinterpret_cast<argb32_t*>(dest);
+	for (; x > 0; x--, px_dest++, src += 2) {
+		px_dest->b = src[0];
+		px_dest->g = src[0];
+		px_dest->r = src[0];
+		px_dest->a = src[1];
+	}
+}
+
+}
@@ -0,0 +1,194 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * RpPng_p.hpp: PNG image handler. (Private class)                         *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_IMG_RPPNG_P_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_IMG_RPPNG_P_HPP__
+
+#include "common.h"
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+
+// PNG header.
+#include <png.h>
+
+// PNGCAPI was added in libpng-1.5.0beta14.
+// Older versions will need this.
+#ifndef PNGCAPI
+# ifdef _MSC_VER
+#  define PNGCAPI __cdecl
+# else
+#  define PNGCAPI
+# endif
+#endif /* !PNGCAPI */
+
+#if defined(__i386__) || defined(__x86_64__) || \
+    defined(_M_IX86) || defined(_M_X64)
+# define RPPNG_HAS_SSSE3 1
+// TODO: Check 2012; assuming 2013+ for now.
+# if !defined(_MSC_VER) || _MSC_VER >= 1800
+#  define RPPNG_HAS_AVX2 1
+# endif
+#endif
+
+namespace LibRpBase {
+
+class RpPngPrivate
+{
+	private:
+		// RpPngPrivate is a static class.
+		RpPngPrivate();
+		~RpPngPrivate();
+		RP_DISABLE_COPY(RpPngPrivate)
+
+	public:
+		/** I/O functions. **/
+
+		/**
+		 * libpng I/O read handler for IRpFile.
+		 * @param png_ptr	[in]  PNG pointer.
+		 * @param data		[out] Buffer for the data to read.
+		 * @param length	[in]  Size of data.
+		 */
+		static void PNGCAPI png_io_IRpFile_read(png_structp png_ptr, png_bytep data, png_size_t length);
+
+		/**
+		 * libpng I/O write handler for IRpFile.
+		 * @param png_ptr	[in] PNG pointer.
+		 * @param data		[in] Data to write.
+		 * @param length	[in] Size of data.
+		 */
+		static void PNGCAPI png_io_IRpFile_write(png_structp png_ptr, png_bytep data, png_size_t length);
+
+		/**
+		 * libpng I/O flush handler for IRpFile.
+		 * @param png_ptr	[in] PNG pointer.
+		 */
+		static void PNGCAPI png_io_IRpFile_flush(png_structp png_ptr);
+
+		/** Error handler functions. **/
+
+#ifdef PNG_WARNINGS_SUPPORTED
+		/**
+		 * libpng warning handler function that simply ignores warnings.
+		 *
+		 * Certain PNG images have "known incorrect" sRGB profiles,
+		 * and we don't want libpng to spam stderr with warnings
+		 * about them.
+		 *
+		 * @param png_ptr	[in] PNG pointer.
+		 * @param msg		[in] Warning message.
+		 */
+		static void PNGCAPI png_warning_fn(png_structp png_ptr, png_const_charp msg);
+#endif /* PNG_WARNINGS_SUPPORTED */
+
+		/** Read functions. **/
+
+		/**
+		 * Read the palette for a CI8 image.
+		 * @param png_ptr png_structp
+		 * @param info_ptr png_infop
+		 * @param color_type PNG color type.
+		 * @param img rp_image to store the palette in.
+		 */
+		static void Read_CI8_Palette(png_structp png_ptr, png_infop info_ptr,
+					     int color_type, LibRpTexture::rp_image *img);
+
+		/**
+		 * Load a PNG image from an opened PNG handle.
+		 * @param png_ptr png_structp
+		 * @param info_ptr png_infop
+		 * @return rp_image*, or nullptr on error.
+		 */
+		static LibRpTexture::rp_image *loadPng(png_structp png_ptr, png_infop info_ptr);
+
+	public:
+		/** Row conversion functions. **/
+
+		// These functions convert a row of 8-bit PNG pixels to ARGB32
+		// without using libpng's transformations.
+		// NOTE: These functions should ONLY be called from loadPng().
+		// NOTE 2: The source buffer must have at least 32 bytes of
+		// padding past the end of the row.
+		typedef void (*convert_row_fn)(uint32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width);
+
+		/**
+		 * Get a row conversion function for a PNG image.
+		 *
+		 * This is only supported for non-interlaced 8-bit RGB (without tRNS),
+		 * RGBA, and gray+alpha images, and only if the CPU supports SSSE3
+		 * or AVX2. Otherwise, libpng's transformations must be used.
+		 *
+		 * @param png_ptr png_structp
+		 * @param info_ptr png_infop
+		 * @return Row conversion function, or nullptr if not supported.
+		 */
+		static convert_row_fn getRowConverter(png_structp png_ptr, png_infop info_ptr);
+
+#ifdef RPPNG_HAS_SSSE3
+		/**
+		 * Convert a row of 24-bit RGB pixels to 32-bit ARGB.
+		 * SSSE3-optimized version.
+		 * @param dest	[out] Destination row. (ARGB32)
+		 * @param src	[in] Source row. (RGB)
+		 * @param width	[in] Width, in pixels.
+		 */
+		static void convertRGBtoARGB_ssse3(uint32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width);
+
+		/**
+		 * Convert a row of 32-bit RGBA pixels to 32-bit ARGB.
+		 * SSSE3-optimized version.
+		 * @param dest	[out] Destination row. (ARGB32)
+		 * @param src	[in] Source row. (RGBA)
+		 * @param width	[in] Width, in pixels.
+		 */
+		static void convertRGBAtoARGB_ssse3(uint32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width);
+
+		/**
+		 * Convert a row of 16-bit gray+alpha pixels to 32-bit ARGB.
+		 * SSSE3-optimized version.
+		 * @param dest	[out] Destination row. (ARGB32)
+		 * @param src	[in] Source row. (GA)
+		 * @param width	[in] Width, in pixels.
+		 */
+		static void convertGAtoARGB_ssse3(uint32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width);
+#endif /* RPPNG_HAS_SSSE3 */
+
+#ifdef RPPNG_HAS_AVX2
+		/**
+		 * Convert a row of 24-bit RGB pixels to 32-bit ARGB.
+		 * AVX2-optimized version.
+		 * @param dest	[out] Destination row. (ARGB32)
+		 * @param src	[in] Source row. (RGB)
+		 * @param width	[in] Width, in pixels.
+		 */
+		static void convertRGBtoARGB_avx2(uint32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width);
+
+		/**
+		 * Convert a row of 32-bit RGBA pixels to 32-bit ARGB.
+		 * AVX2-optimized version.
+		 * @param dest	[out] Destination row. (ARGB32)
+		 * @param src	[in] Source row. (RGBA)
+		 * @param width	[in] Width, in pixels.
+		 */
+		static void convertRGBAtoARGB_avx2(uint32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width);
+
+		/**
+		 * Convert a row of 16-bit gray+alpha pixels to 32-bit ARGB.
+		 * AVX2-optimized version.
+		 * @param dest	[out] Destination row. (ARGB32)
+		 * @param src	[in] Source row. (GA)
+		 * @param width	[in] Width, in pixels.
+		 */
+		static void convertGAtoARGB_avx2(uint32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width);
+#endif /* RPPNG_HAS_AVX2 */
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_IMG_RPPNG_P_HPP__ */
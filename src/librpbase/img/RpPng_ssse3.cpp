@@ -0,0 +1,136 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * RpPng_ssse3.cpp: PNG image handler.                                     *
+ * SSSE3-optimized version.                                                *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RpPng_p.hpp"
+
+// librptexture
+using LibRpTexture::argb32_t;
+
+// SSSE3 intrinsics.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+namespace LibRpBase {
+
+/**
+ * Convert a row of 24-bit RGB pixels to 32-bit ARGB.
+ * SSSE3-optimized version.
+ * @param dest	[out] Destination row. (ARGB32)
+ * @param src	[in] Source row. (RGB)
+ * @param width	[in] Width, in pixels.
+ */
+void RpPngPrivate::convertRGBtoARGB_ssse3(uint32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width)
+{
+	// Same algorithm as RpJpegPrivate::decodeBGRtoARGB().
+	const __m128i shuf_mask = _mm_setr_epi8(2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1);
+	const __m128i alpha_mask = _mm_setr_epi8(0,0,0,-1, 0,0,0,-1, 0,0,0,-1, 0,0,0,-1);
+
+	// Process 16 pixels per iteration using SSSE3.
+	unsigned int x = width;
+	for (; x > 15; x -= 16, dest += 16, src += 16*3) {
+		const __m128i *xmm_src = reinterpret_cast<const __m128i*>(src);
+		__m128i *xmm_dest = reinterpret_cast<__m128i*>(dest);
+
+		const __m128i sa = _mm_loadu_si128(&xmm_src[0]);
+		const __m128i sb = _mm_loadu_si128(&xmm_src[1]);
+		const __m128i sc = _mm_loadu_si128(&xmm_src[2]);
+
+		__m128i val = _mm_shuffle_epi8(sa, shuf_mask);
+		val = _mm_or_si128(val, alpha_mask);
+		_mm_storeu_si128(&xmm_dest[0], val);
+		val = _mm_shuffle_epi8(_mm_alignr_epi8(sb, sa, 12), shuf_mask);
+		val = _mm_or_si128(val, alpha_mask);
+		_mm_storeu_si128(&xmm_dest[1], val);
+		val = _mm_shuffle_epi8(_mm_alignr_epi8(sc, sb, 8), shuf_mask);
+		val = _mm_or_si128(val, alpha_mask);
+		_mm_storeu_si128(&xmm_dest[2], val);
+		val = _mm_shuffle_epi8(_mm_alignr_epi8(sc, sc, 4), shuf_mask);
+		val = _mm_or_si128(val, alpha_mask);
+		_mm_storeu_si128(&xmm_dest[3], val);
+	}
+
+	// Remaining pixels.
+	argb32_t *px_dest = reinterpret_cast<argb32_t*>(dest);
+	for (; x > 0; x--, px_dest++, src += 3) {
+		px_dest->b = src[2];
+		px_dest->g = src[1];
+		px_dest->r = src[0];
+		px_dest->a = 0xFF;
+	}
+}
+
+/**
+ * Convert a row of 32-bit RGBA pixels to 32-bit ARGB.
+ * SSSE3-optimized version.
+ * @param dest	[out] Destination row. (ARGB32)
+ * @param src	[in] Source row. (RGBA)
+ * @param width	[in] Width, in pixels.
+ */
+void RpPngPrivate::convertRGBAtoARGB_ssse3(uint32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width)
+{
+	// Swap the R and B channels.
+	const __m128i shuf_mask = _mm_setr_epi8(2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15);
+
+	// Process 8 pixels per iteration using SSSE3.
+	unsigned int x = width;
+	for (; x > 7; x -= 8, dest += 8, src += 8*4) {
+		const __m128i *xmm_src = reinterpret_cast<const __m128i*>(src);
+		__m128i *xmm_dest = reinterpret_cast<__m128i*>(dest);
+
+		const __m128i sa = _mm_loadu_si128(&xmm_src[0]);
+		const __m128i sb = _mm_loadu_si128(&xmm_src[1]);
+		_mm_storeu_si128(&xmm_dest[0], _mm_shuffle_epi8(sa, shuf_mask));
+		_mm_storeu_si128(&xmm_dest[1], _mm_shuffle_epi8(sb, shuf_mask));
+	}
+
+	// Remaining pixels.
+	argb32_t *px_dest = reinterpret_cast<argb32_t*>(dest);
+	for (; x > 0; x--, px_dest++, src += 4) {
+		px_dest->b = src[2];
+		px_dest->g = src[1];
+		px_dest->r = src[0];
+		px_dest->a = src[3];
+	}
+}
+
+/**
+ * Convert a row of 16-bit gray+alpha pixels to 32-bit ARGB.
+ * SSSE3-optimized version.
+ * @param dest	[out] Destination row. (ARGB32)
+ * @param src	[in] Source row. (GA)
+ * @param width	[in] Width, in pixels.
+ */
+void RpPngPrivate::convertGAtoARGB_ssse3(uint32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width)
+{
+	// Copy the gray channel to B, G, and R.
+	const __m128i shuf_lo = _mm_setr_epi8(0,0,0,1, 2,2,2,3, 4,4,4,5, 6,6,6,7);
+	const __m128i shuf_hi = _mm_setr_epi8(8,8,8,9, 10,10,10,11, 12,12,12,13, 14,14,14,15);
+
+	// Process 8 pixels per iteration using SSSE3.
+	unsigned int x = width;
+	for (; x > 7; x -= 8, dest += 8, src += 8*2) {
+		__m128i *xmm_dest = reinterpret_cast<__m128i*>(dest);
+
+		const __m128i sa = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		_mm_storeu_si128(&xmm_dest[0], _mm_shuffle_epi8(sa, shuf_lo));
+		_mm_storeu_si128(&xmm_dest[1], _mm_shuffle_epi8(sa, shuf_hi));
+	}
+
+	// Remaining pixels.
+	argb32_t *px_dest = reinterpret_cast<argb32_t*>(dest);
+	for (; x > 0; x--, px_dest++, src += 2) {
+		px_dest->b = src[0];
+		px_dest->g = src[0];
+		px_dest->r = src[0];
+		px_dest->a = src[1];
+	}
+}
+
+}
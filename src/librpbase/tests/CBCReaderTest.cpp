@@ -0,0 +1,236 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * CBCReaderTest.cpp: CBCReader class test.                                *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// CBCReader
+#include "../disc/CBCReader.hpp"
+#include "../crypto/AesCipherFactory.hpp"
+#include "../crypto/IAesCipher.hpp"
+
+// librpfile
+#include "librpfile/RpMemFile.hpp"
+using LibRpFile::RpMemFile;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <random>
+using std::unique_ptr;
+
+// uvector
+#include "uvector.h"
+
+namespace LibRpBase { namespace Tests {
+
+class CBCReaderTest : public ::testing::TestWithParam<bool>
+{
+	protected:
+		CBCReaderTest()
+			: m_reader(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// CBCReader's bounce buffer size.
+		static const size_t BOUNCE_BUF_SIZE = 64*1024;
+
+		// Encrypted data offset within the file.
+		// The data before and after the encrypted data
+		// must not be read by CBCReader.
+		static const unsigned int DATA_OFFSET = 32;
+		// Encrypted data length.
+		static const unsigned int DATA_LENGTH = (2 * BOUNCE_BUF_SIZE) + 4096 + 48;
+
+		static const uint8_t key[16];
+		static const uint8_t iv[16];
+
+		/**
+		 * Read data from the CBCReader and compare it to the reference plaintext.
+		 * @param pos Starting position.
+		 * @param size Size to read.
+		 */
+		void checkRead(unsigned int pos, size_t size);
+
+		/**
+		 * Read data sequentially from the CBCReader's current position
+		 * and compare it to the reference plaintext.
+		 * @param size Size to read.
+		 */
+		void checkSeqRead(size_t size);
+
+	public:
+		ao::uvector<uint8_t> m_file_data;	// Ciphertext, with padding before and after.
+		ao::uvector<uint8_t> m_plaintext;	// Reference plaintext. (single decrypt)
+		CBCReader *m_reader;
+};
+
+const uint8_t CBCReaderTest::key[16] = {
+	0x00,0x11,0x22,0x33,0x44,0x55,0x66,0x77,
+	0x88,0x99,0xAA,0xBB,0xCC,0xDD,0xEE,0xFF
+};
+
+const uint8_t CBCReaderTest::iv[16] = {
+	0x0F,0x1E,0x2D,0x3C,0x4B,0x5A,0x69,0x78,
+	0x87,0x96,0xA5,0xB4,0xC3,0xD2,0xE1,0xF0
+};
+
+void CBCReaderTest::SetUp(void)
+{
+	const bool isCBC = GetParam();
+
+	// Random "ciphertext".
+	std::mt19937 gen(0x43424352);	// 'CBCR'
+	m_file_data.resize(DATA_OFFSET + DATA_LENGTH + DATA_OFFSET);
+	for (uint8_t &b : m_file_data) {
+		b = static_cast<uint8_t>(gen() >> 24);
+	}
+
+	// Decrypt the entire buffer at once to get the reference plaintext.
+	unique_ptr<IAesCipher> cipher(AesCipherFactory::create());
+	ASSERT_TRUE(cipher && cipher->isInit());
+	ASSERT_EQ(0, cipher->setChainingMode(isCBC
+		? IAesCipher::ChainingMode::CBC
+		: IAesCipher::ChainingMode::ECB));
+	ASSERT_EQ(0, cipher->setKey(key, sizeof(key)));
+	if (isCBC) {
+		ASSERT_EQ(0, cipher->setIV(iv, sizeof(iv)));
+	}
+	m_plaintext.resize(DATA_LENGTH);
+	memcpy(m_plaintext.data(), &m_file_data[DATA_OFFSET], DATA_LENGTH);
+	ASSERT_EQ(static_cast<size_t>(DATA_LENGTH), cipher->decrypt(m_plaintext.data(), DATA_LENGTH));
+
+	RpMemFile *const memFile = new RpMemFile(m_file_data.data(), m_file_data.size());
+	m_reader = new CBCReader(memFile, DATA_OFFSET, DATA_LENGTH, key, (isCBC ? iv : nullptr));
+	memFile->unref();
+	ASSERT_TRUE(m_reader->isOpen());
+}
+
+void CBCReaderTest::TearDown(void)
+{
+	UNREF_AND_NULL(m_reader);
+}
+
+/**
+ * Read data from the CBCReader and compare it to the reference plaintext.
+ * @param pos Starting position.
+ * @param size Size to read.
+ */
+void CBCReaderTest::checkRead(unsigned int pos, size_t size)
+{
+	ASSERT_EQ(0, m_reader->seek(pos));
+	checkSeqRead(size);
+}
+
+/**
+ * Read data sequentially from the CBCReader's current position
+ * and compare it to the reference plaintext.
+ * @param size Size to read.
+ */
+void CBCReaderTest::checkSeqRead(size_t size)
+{
+	const off64_t pos = m_reader->tell();
+	ASSERT_GE(pos, 0);
+	ASSERT_LE(pos + static_cast<off64_t>(size), static_cast<off64_t>(DATA_LENGTH));
+
+	ao::uvector<uint8_t> buf(size);
+	ASSERT_EQ(size, m_reader->read(buf.data(), size));
+	ASSERT_EQ(pos + static_cast<off64_t>(size), m_reader->tell());
+	EXPECT_EQ(0, memcmp(&m_plaintext[static_cast<size_t>(pos)], buf.data(), size))
+		<< "Data mismatch at position " << pos << ", size " << size;
+}
+
+/**
+ * Read the entire buffer at once.
+ */
+TEST_P(CBCReaderTest, readAll)
+{
+	checkRead(0, DATA_LENGTH);
+}
+
+/**
+ * Read with an unaligned start and end.
+ */
+TEST_P(CBCReaderTest, unalignedStartAndEnd)
+{
+	checkRead(5, 7);	// within one block
+	checkRead(13, 6);	// across one block boundary
+	checkRead(37, 1000);
+	checkRead(DATA_LENGTH - 17, 17);
+	checkRead(DATA_LENGTH - 1, 1);
+}
+
+/**
+ * Reads that are larger than the bounce buffer.
+ */
+TEST_P(CBCReaderTest, largeReads)
+{
+	// Block-aligned start, unaligned end.
+	checkRead(16, BOUNCE_BUF_SIZE + 100);
+	// Unaligned start and end. This goes through the bounce buffer.
+	checkRead(3, (BOUNCE_BUF_SIZE * 2) + 29);
+	// Unaligned start, block-aligned end.
+	checkRead(4099, DATA_LENGTH - 4099);
+}
+
+/**
+ * Sequential reads of varying sizes.
+ * These use the cached IV from the previous read.
+ */
+TEST_P(CBCReaderTest, sequentialReads)
+{
+	static const size_t sizes[] = {
+		1, 15, 16, 17, 31, 32, 33, 100, 4096, 4099,
+		BOUNCE_BUF_SIZE - 1, BOUNCE_BUF_SIZE + 17,
+	};
+
+	ASSERT_EQ(0, m_reader->seek(0));
+	size_t remaining = DATA_LENGTH;
+	for (unsigned int i = 0; remaining > 0; i++) {
+		const size_t size = std::min(sizes[i % ARRAY_SIZE(sizes)], remaining);
+		checkSeqRead(size);
+		if (HasFatalFailure())
+			return;
+		remaining -= size;
+	}
+}
+
+/**
+ * Random seeks that need the preceding ciphertext block as the IV.
+ */
+TEST_P(CBCReaderTest, randomSeeks)
+{
+	// Read from the middle first so the cached IV doesn't apply.
+	checkRead(8192, 16);
+	// Block-aligned, not at the start of the data.
+	checkRead(4096, 16);
+	checkRead(48, 64);
+	// Unaligned, not at the start of the data.
+	checkRead(12345, 678);
+	// Backwards to the start of the data.
+	checkRead(0, 16);
+	// Forwards past the cached IV position.
+	checkRead(BOUNCE_BUF_SIZE + 32, 48);
+	// Adjacent to the previous read, but one block later.
+	checkRead(BOUNCE_BUF_SIZE + 96, 16);
+}
+
+INSTANTIATE_TEST_SUITE_P(CBCReaderTest, CBCReaderTest,
+	::testing::Values(true, false),
+	[](const ::testing::TestParamInfo<bool> &info) {
+		return (info.param ? "CBC" : "ECB");
+	});
+
+} }
@@ -0,0 +1,62 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * PseudoRandom.hpp: Deterministic pseudo-random test data.                *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_TESTS_PSEUDORANDOM_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_TESTS_PSEUDORANDOM_HPP__
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+namespace LibRpBase { namespace Tests {
+
+/**
+ * Advance a deterministic pseudo-random sequence.
+ * A simple LCG is used, since the data only needs to be
+ * identical for every implementation that's being compared.
+ * @param seed	[in,out] Current state.
+ * @return New state.
+ */
+static inline uint32_t nextPseudoRandom(uint32_t &seed)
+{
+	seed = (seed * 1103515245U) + 12345U;
+	return seed;
+}
+
+/**
+ * Fill a buffer with deterministic pseudo-random data.
+ * @param buf	[out] Buffer.
+ * @param siz	[in] Size of buf, in bytes.
+ * @param seed	[in] Initial seed.
+ */
+static inline void fillPseudoRandom(void *buf, size_t siz, uint32_t seed = 0x1BADB002)
+{
+	uint8_t *p = static_cast<uint8_t*>(buf);
+	for (; siz > 0; siz--, p++) {
+		*p = static_cast<uint8_t>(nextPseudoRandom(seed) >> 16);
+	}
+}
+
+/**
+ * Make sure each BC7 block in a pseudo-random buffer has a mode.
+ * BC7 blocks with no mode bit set are invalid.
+ * @param buf	[in,out] BC7 blocks.
+ * @param siz	[in] Size of buf, in bytes.
+ */
+static inline void fixBC7Modes(uint8_t *buf, size_t siz)
+{
+	for (; siz >= 16; siz -= 16, buf += 16) {
+		if (*buf == 0) {
+			*buf = 0x80;
+		}
+	}
+}
+
+} }
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_TESTS_PSEUDORANDOM_HPP__ */
@@ -43,6 +43,22 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		// TODO: Add more syscalls.
 		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
 		// defined in earlier versions, including Ubuntu 14.04.
+
+		// NOTE: Special case for clone(). If it's the first syscall
+		// in the list, it has a parameter restriction added that
+		// ensures it can only be used to create threads.
+		SCMP_SYS(clone),
+		// Other multi-threading syscalls
+		// [ImageDecoder: multithreaded decoding of large textures]
+		SCMP_SYS(set_robust_list),
+		SCMP_SYS(madvise),		// thread stack cleanup
+		SCMP_SYS(rt_sigprocmask),	// pthread_create()
+#if defined(__SNR_rseq)
+		SCMP_SYS(rseq),		// glibc-2.35
+#elif defined(__NR_rseq)
+		__NR_rseq,		// glibc-2.35
+#endif /* __SNR_rseq || __NR_rseq */
+
 		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
 		SCMP_SYS(fstat),     SCMP_SYS(fstat64),		// __GI___fxstat() [printf()]
 		SCMP_SYS(fstatat64), SCMP_SYS(newfstatat),	// Ubuntu 19.10 (32-bit)
@@ -0,0 +1,341 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RpJpegFormatTest.cpp: RpImageLoader JPEG format test.                   *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "librpbase/config.librpbase.h"
+
+// Google Test
+#include "gtest/gtest.h"
+
+// librpbase
+#include "common.h"
+#include "uvector.h"
+#include "img/RpImageLoader.hpp"
+
+// librpfile
+#include "librpfile/RpFile.hpp"
+#include "librpfile/RpMemFile.hpp"
+#include "librpfile/FileSystem.hpp"
+using namespace LibRpFile;
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+using LibRpTexture::rp_image;
+
+// C includes.
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes. (C++ namespace)
+#include "ctypex.h"
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <ostream>
+#include <string>
+using std::string;
+
+namespace LibRpBase { namespace Tests {
+
+struct RpJpegFormatTest_mode
+{
+	string jpeg_filename;	// JPEG image to test.
+	int full_width;		// Full image width.
+	int full_height;	// Full image height.
+	int req_size;		// Requested image size. (0 for full size)
+	int scale_denom;	// Expected scaling denominator. (1/N)
+
+	RpJpegFormatTest_mode(
+		const char *jpeg_filename,
+		int full_width, int full_height,
+		int req_size, int scale_denom)
+		: jpeg_filename(jpeg_filename)
+		, full_width(full_width)
+		, full_height(full_height)
+		, req_size(req_size)
+		, scale_denom(scale_denom)
+	{ }
+};
+
+// Maximum file size for images.
+static const off64_t MAX_JPEG_IMAGE_FILESIZE = 512*1024;
+
+class RpJpegFormatTest : public ::testing::TestWithParam<RpJpegFormatTest_mode>
+{
+	protected:
+		RpJpegFormatTest()
+			: ::testing::TestWithParam<RpJpegFormatTest_mode>()
+			, m_img(nullptr)
+			, m_img_full(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		/**
+		 * Compare a reduced-size ARGB32 image to a full-size ARGB32 image.
+		 * Each pixel in the reduced-size image is compared to the average
+		 * of the corresponding NxN block in the full-size image.
+		 *
+		 * libjpeg's IDCT scaling isn't identical to a box filter,
+		 * so a small per-channel difference is allowed.
+		 *
+		 * @param img Reduced-size image.
+		 * @param img_full Full-size image.
+		 * @param denom Scaling denominator. (1/N)
+		 */
+		static void Compare_ARGB32_Downscaled(
+			const rp_image *img,
+			const rp_image *img_full,
+			int denom);
+
+	public:
+		// JPEG image buffer.
+		ao::uvector<uint8_t> m_jpeg_buf;
+
+		// Loaded images.
+		rp_image *m_img;
+		rp_image *m_img_full;
+
+	public:
+		/** Test case parameters. **/
+
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<RpJpegFormatTest_mode> &info);
+};
+
+/**
+ * Formatting function for RpJpegFormatTest.
+ */
+inline ::std::ostream& operator<<(::std::ostream& os, const RpJpegFormatTest_mode& mode)
+{
+	return os << mode.jpeg_filename << " (req_size=" << mode.req_size << ')';
+};
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void RpJpegFormatTest::SetUp(void)
+{
+	if (::testing::UnitTest::GetInstance()->current_test_info()->value_param() == nullptr) {
+		// Not a parameterized test.
+		return;
+	}
+
+	// Parameterized test.
+	const RpJpegFormatTest_mode &mode = GetParam();
+
+	// Open the JPEG image file being tested.
+	string path = "png_data";
+	path += DIR_SEP_CHR;
+	path += mode.jpeg_filename;
+	unique_RefBase<RpFile> file(new RpFile(path, RpFile::FM_OPEN_READ));
+	ASSERT_TRUE(file->isOpen());
+
+	// Maximum image size.
+	ASSERT_LE(file->size(), MAX_JPEG_IMAGE_FILESIZE) << "JPEG test image is too big.";
+
+	// Read the JPEG image into memory.
+	const size_t jpegSize = static_cast<size_t>(file->size());
+	m_jpeg_buf.resize(jpegSize);
+	ASSERT_EQ(jpegSize, m_jpeg_buf.size());
+	size_t readSize = file->read(m_jpeg_buf.data(), jpegSize);
+	ASSERT_EQ(jpegSize, readSize) << "Error loading JPEG image file: "
+		<< mode.jpeg_filename;
+}
+
+/**
+ * TearDown() function.
+ * Run after each test.
+ */
+void RpJpegFormatTest::TearDown(void)
+{
+	UNREF_AND_NULL(m_img);
+	UNREF_AND_NULL(m_img_full);
+}
+
+/**
+ * Compare a reduced-size ARGB32 image to a full-size ARGB32 image.
+ * Each pixel in the reduced-size image is compared to the average
+ * of the corresponding NxN block in the full-size image.
+ *
+ * libjpeg's IDCT scaling isn't identical to a box filter,
+ * so a small per-channel difference is allowed.
+ *
+ * @param img Reduced-size image.
+ * @param img_full Full-size image.
+ * @param denom Scaling denominator. (1/N)
+ */
+void RpJpegFormatTest::Compare_ARGB32_Downscaled(
+	const rp_image *img,
+	const rp_image *img_full,
+	int denom)
+{
+	// Maximum difference for a single channel.
+	// Edges can differ quite a bit due to IDCT ringing.
+	static const unsigned int MAX_CHANNEL_DIFF = 64;
+	// Maximum average difference for the entire image.
+	static const unsigned int MAX_AVG_DIFF = 2;
+
+	ASSERT_EQ(rp_image::Format::ARGB32, img->format());
+	ASSERT_EQ(rp_image::Format::ARGB32, img_full->format());
+	ASSERT_EQ(img_full->width() / denom, img->width());
+	ASSERT_EQ(img_full->height() / denom, img->height());
+
+	const unsigned int block_px = static_cast<unsigned int>(denom * denom);
+	uint64_t total_diff = 0;
+	unsigned int max_diff = 0;
+	for (int y = 0; y < img->height(); y++) {
+		const uint32_t *px = static_cast<const uint32_t*>(img->scanLine(y));
+		for (int x = 0; x < img->width(); x++, px++) {
+			// Average the corresponding NxN block.
+			unsigned int sum[4] = {0, 0, 0, 0};
+			for (int by = 0; by < denom; by++) {
+				const uint32_t *px_full = static_cast<const uint32_t*>(
+					img_full->scanLine((y * denom) + by)) + (x * denom);
+				for (int bx = 0; bx < denom; bx++, px_full++) {
+					for (unsigned int c = 0; c < 4; c++) {
+						sum[c] += (*px_full >> (c * 8)) & 0xFF;
+					}
+				}
+			}
+
+			for (unsigned int c = 0; c < 4; c++) {
+				const unsigned int expected = (sum[c] + (block_px / 2)) / block_px;
+				const unsigned int actual = (*px >> (c * 8)) & 0xFF;
+				const unsigned int diff = (actual > expected
+					? actual - expected
+					: expected - actual);
+				total_diff += diff;
+				max_diff = std::max(max_diff, diff);
+			}
+		}
+	}
+
+	EXPECT_LE(max_diff, MAX_CHANNEL_DIFF) << "Maximum channel difference is too large.";
+	const uint64_t channels = static_cast<uint64_t>(img->width()) * img->height() * 4;
+	EXPECT_LE(total_diff / channels, MAX_AVG_DIFF) << "Average channel difference is too large.";
+}
+
+/**
+ * Run an RpImageLoader test.
+ */
+TEST_P(RpJpegFormatTest, loadTest)
+{
+	const RpJpegFormatTest_mode &mode = GetParam();
+
+	// Create an RpMemFile.
+	unique_RefBase<RpMemFile> jpeg_mem_file(new RpMemFile(m_jpeg_buf.data(), m_jpeg_buf.size()));
+	ASSERT_TRUE(jpeg_mem_file->isOpen());
+
+	// Load the full-size image using the default parameters.
+	m_img_full = RpImageLoader::load(jpeg_mem_file.get());
+	ASSERT_NE(nullptr, m_img_full) << "RpImageLoader failed to load the image.";
+	EXPECT_EQ(mode.full_width, m_img_full->width()) << "rp_image width is incorrect.";
+	EXPECT_EQ(mode.full_height, m_img_full->height()) << "rp_image height is incorrect.";
+	ASSERT_EQ(rp_image::Format::ARGB32, m_img_full->format()) << "rp_image format is incorrect.";
+
+#ifdef _WIN32
+	// GDI+ always loads the image at full size.
+	const int denom = 1;
+#else /* !_WIN32 */
+	const int denom = mode.scale_denom;
+#endif /* _WIN32 */
+
+	// Load the image using the requested size.
+	int full_size[2] = {-1, -1};
+	m_img = RpImageLoader::load(jpeg_mem_file.get(), mode.req_size, full_size);
+	ASSERT_NE(nullptr, m_img) << "RpImageLoader failed to load the image.";
+
+	// The full image size should always be the original size.
+	EXPECT_EQ(mode.full_width, full_size[0]) << "Full image width is incorrect.";
+	EXPECT_EQ(mode.full_height, full_size[1]) << "Full image height is incorrect.";
+
+	// Check the rp_image parameters.
+	EXPECT_EQ(mode.full_width / denom, m_img->width()) << "rp_image width is incorrect.";
+	EXPECT_EQ(mode.full_height / denom, m_img->height()) << "rp_image height is incorrect.";
+	ASSERT_EQ(rp_image::Format::ARGB32, m_img->format()) << "rp_image format is incorrect.";
+	if (mode.req_size > 0) {
+		// The longest side must be at least req_size,
+		// unless the original image is smaller.
+		const int longest = std::max(m_img->width(), m_img->height());
+		EXPECT_GE(longest, std::min(mode.req_size, std::max(mode.full_width, mode.full_height)));
+	}
+
+	if (denom == 1) {
+		// Full-size image. This must be identical to
+		// the image loaded with the default parameters.
+		const size_t row_bytes = m_img->row_bytes();
+		for (int y = 0; y < m_img->height(); y++) {
+			ASSERT_EQ(0, memcmp(m_img_full->scanLine(y), m_img->scanLine(y), row_bytes))
+				<< "Full-size images differ on row " << y << '.';
+		}
+	} else {
+		// Reduced-size image. Compare it to the full-size image.
+		ASSERT_NO_FATAL_FAILURE(Compare_ARGB32_Downscaled(m_img, m_img_full, denom));
+	}
+}
+
+/**
+ * Get the test case suffix from the test case parameters.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string RpJpegFormatTest::test_case_suffix_generator(const ::testing::TestParamInfo<RpJpegFormatTest_mode> &info)
+{
+	string suffix = info.param.jpeg_filename;
+	suffix += "_req";
+	suffix += std::to_string(info.param.req_size);
+
+	// Replace all non-alphanumeric characters with '_'.
+	// See gtest-param-util.h::IsValidParamName().
+	std::for_each(suffix.begin(), suffix.end(),
+		[](char &c) {
+			// NOTE: Not checking for '_' because that
+			// wastes a branch.
+			if (!ISALNUM(c)) {
+				c = '_';
+			}
+		}
+	);
+
+	return suffix;
+}
+
+// Test cases.
+
+#ifdef HAVE_JPEG
+// gl_triangle JPEG image tests. (400x352)
+INSTANTIATE_TEST_SUITE_P(gl_triangle_jpeg, RpJpegFormatTest,
+	::testing::Values(
+		// Full size.
+		RpJpegFormatTest_mode("gl_triangle.RGB24.jpg", 400, 352,   0, 1),
+		RpJpegFormatTest_mode("gl_triangle.RGB24.jpg", 400, 352, 400, 1),
+		RpJpegFormatTest_mode("gl_triangle.RGB24.jpg", 400, 352, 512, 1),
+		// 1/2 would be 200x176, which is too small.
+		RpJpegFormatTest_mode("gl_triangle.RGB24.jpg", 400, 352, 201, 1),
+
+		// Reduced sizes.
+		// The longest side must be at least req_size.
+		RpJpegFormatTest_mode("gl_triangle.RGB24.jpg", 400, 352, 200, 2),
+		RpJpegFormatTest_mode("gl_triangle.RGB24.jpg", 400, 352, 128, 2),
+		RpJpegFormatTest_mode("gl_triangle.RGB24.jpg", 400, 352, 101, 2),
+		RpJpegFormatTest_mode("gl_triangle.RGB24.jpg", 400, 352, 100, 4),
+		RpJpegFormatTest_mode("gl_triangle.RGB24.jpg", 400, 352,  51, 4),
+		RpJpegFormatTest_mode("gl_triangle.RGB24.jpg", 400, 352,  50, 8),
+		RpJpegFormatTest_mode("gl_triangle.RGB24.jpg", 400, 352,  32, 8))
+	, RpJpegFormatTest::test_case_suffix_generator);
+#endif /* HAVE_JPEG */
+
+} }
@@ -0,0 +1,302 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RpPngRowConvTest.cpp: RpPng row conversion function test.               *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// librpbase
+#include "common.h"
+#include "img/RpPng_p.hpp"
+#ifdef RPPNG_HAS_SSSE3
+# include "librpcpu/cpuflags_x86.h"
+#endif /* RPPNG_HAS_SSSE3 */
+
+// librptexture
+using LibRpTexture::argb32_t;
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+struct RpPngRowConvTest_mode
+{
+	const char *name;		// Source format name.
+	unsigned int src_bytespp;	// Source bytes per pixel. (2 == GA, 3 == RGB, 4 == RGBA)
+
+	RpPngRowConvTest_mode(const char *name, unsigned int src_bytespp)
+		: name(name)
+		, src_bytespp(src_bytespp)
+	{ }
+};
+
+/**
+ * Formatting function for RpPngRowConvTest.
+ */
+inline ::std::ostream& operator<<(::std::ostream& os, const RpPngRowConvTest_mode& mode) {
+	return os << mode.name;
+};
+
+class RpPngRowConvTest : public ::testing::TestWithParam<RpPngRowConvTest_mode>
+{
+	protected:
+		// Maximum width to test.
+		static const unsigned int MAX_WIDTH = 1024;
+
+		// Number of rows to convert for benchmarks.
+		static const unsigned int BENCHMARK_ROWS = 100000;
+
+		void SetUp(void) final;
+
+		/**
+		 * Convert a row using a reference implementation.
+		 * @param dest		[out] Destination row. (ARGB32)
+		 * @param src		[in] Source row.
+		 * @param width		[in] Width, in pixels.
+		 * @param src_bytespp	[in] Source bytes per pixel.
+		 */
+		static void convertRow_ref(uint32_t *dest, const uint8_t *src, unsigned int width, unsigned int src_bytespp);
+
+		/**
+		 * Test a row conversion function for every width up to 67 pixels,
+		 * plus the maximum width.
+		 * @param fn Row conversion function.
+		 */
+		void testConvertRow(RpPngPrivate::convert_row_fn fn);
+
+		/**
+		 * Benchmark a row conversion function.
+		 * @param fn Row conversion function.
+		 */
+		void benchmarkConvertRow(RpPngPrivate::convert_row_fn fn);
+
+	public:
+		// Source row, with 32 bytes of padding.
+		vector<uint8_t> m_src;
+		// Destination rows.
+		vector<uint32_t> m_dest;
+		vector<uint32_t> m_dest_ref;
+
+	public:
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<RpPngRowConvTest_mode> &info);
+};
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void RpPngRowConvTest::SetUp(void)
+{
+	const RpPngRowConvTest_mode &mode = GetParam();
+
+	// Fill the source row with pseudo-random data.
+	m_src.resize(MAX_WIDTH * mode.src_bytespp + 32);
+	srand(0x12345678);
+	for (auto iter = m_src.begin(); iter != m_src.end(); ++iter) {
+		*iter = static_cast<uint8_t>(rand() & 0xFF);
+	}
+
+	// Destination rows have one extra pixel to check for overruns.
+	m_dest.resize(MAX_WIDTH + 1);
+	m_dest_ref.resize(MAX_WIDTH + 1);
+}
+
+/**
+ * Convert a row using a reference implementation.
+ * @param dest		[out] Destination row. (ARGB32)
+ * @param src		[in] Source row.
+ * @param width		[in] Width, in pixels.
+ * @param src_bytespp	[in] Source bytes per pixel.
+ */
+void RpPngRowConvTest::convertRow_ref(uint32_t *dest, const uint8_t *src, unsigned int width, unsigned int src_bytespp)
+{
+	for (unsigned int x = 0; x < width; x++, src += src_bytespp) {
+		argb32_t px;
+		switch (src_bytespp) {
+			case 2:
+				px.b = src[0];
+				px.g = src[0];
+				px.r = src[0];
+				px.a = src[1];
+				break;
+			case 3:
+				px.b = src[2];
+				px.g = src[1];
+				px.r = src[0];
+				px.a = 0xFF;
+				break;
+			case 4:
+				px.b = src[2];
+				px.g = src[1];
+				px.r = src[0];
+				px.a = src[3];
+				break;
+			default:
+				assert(!"Invalid source bytes per pixel.");
+				px.u32 = 0;
+				break;
+		}
+		dest[x] = px.u32;
+	}
+}
+
+/**
+ * Test a row conversion function for every width up to 67 pixels,
+ * plus the maximum width.
+ * @param fn Row conversion function.
+ */
+void RpPngRowConvTest::testConvertRow(RpPngPrivate::convert_row_fn fn)
+{
+	const RpPngRowConvTest_mode &mode = GetParam();
+	static const uint32_t canary = 0xDEADBEEF;
+
+	// Test every width up to 67 pixels to cover all of the
+	// "remaining pixels" cases, then test the maximum width.
+	for (unsigned int width = 1; width <= MAX_WIDTH; width = (width < 67 ? width + 1 : MAX_WIDTH)) {
+		m_dest[width] = canary;
+		fn(m_dest.data(), m_src.data(), width);
+		convertRow_ref(m_dest_ref.data(), m_src.data(), width, mode.src_bytespp);
+
+		for (unsigned int x = 0; x < width; x++) {
+			ASSERT_EQ(m_dest_ref[x], m_dest[x]) << "Pixel " << x << " does not match. (width == " << width << ')';
+		}
+		ASSERT_EQ(canary, m_dest[width]) << "Row overrun. (width == " << width << ')';
+
+		if (width == MAX_WIDTH)
+			break;
+	}
+}
+
+/**
+ * Benchmark a row conversion function.
+ * @param fn Row conversion function.
+ */
+void RpPngRowConvTest::benchmarkConvertRow(RpPngPrivate::convert_row_fn fn)
+{
+	// NOTE: Using a volatile function pointer to prevent the
+	// compiler from optimizing out the repeated conversions.
+	RpPngPrivate::convert_row_fn volatile v_fn = fn;
+	for (unsigned int i = BENCHMARK_ROWS; i > 0; i--) {
+		v_fn(m_dest.data(), m_src.data(), MAX_WIDTH);
+	}
+}
+
+#ifdef RPPNG_HAS_SSSE3
+/**
+ * Get the SSSE3 row conversion function for the specified mode.
+ * @param mode Test mode.
+ * @return Row conversion function.
+ */
+static RpPngPrivate::convert_row_fn getFn_ssse3(const RpPngRowConvTest_mode &mode)
+{
+	switch (mode.src_bytespp) {
+		case 2:		return RpPngPrivate::convertGAtoARGB_ssse3;
+		case 3:		return RpPngPrivate::convertRGBtoARGB_ssse3;
+		case 4:		return RpPngPrivate::convertRGBAtoARGB_ssse3;
+		default:	return nullptr;
+	}
+}
+
+/**
+ * Test the row conversion functions. (SSSE3-optimized version)
+ */
+TEST_P(RpPngRowConvTest, ssse3_test)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+	ASSERT_NO_FATAL_FAILURE(testConvertRow(getFn_ssse3(GetParam())));
+}
+
+/**
+ * Benchmark the row conversion functions. (SSSE3-optimized version)
+ */
+TEST_P(RpPngRowConvTest, ssse3_benchmark)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+	benchmarkConvertRow(getFn_ssse3(GetParam()));
+}
+#endif /* RPPNG_HAS_SSSE3 */
+
+#ifdef RPPNG_HAS_AVX2
+/**
+ * Get the AVX2 row conversion function for the specified mode.
+ * @param mode Test mode.
+ * @return Row conversion function.
+ */
+static RpPngPrivate::convert_row_fn getFn_avx2(const RpPngRowConvTest_mode &mode)
+{
+	switch (mode.src_bytespp) {
+		case 2:		return RpPngPrivate::convertGAtoARGB_avx2;
+		case 3:		return RpPngPrivate::convertRGBtoARGB_avx2;
+		case 4:		return RpPngPrivate::convertRGBAtoARGB_avx2;
+		default:	return nullptr;
+	}
+}
+
+/**
+ * Test the row conversion functions. (AVX2-optimized version)
+ */
+TEST_P(RpPngRowConvTest, avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+	ASSERT_NO_FATAL_FAILURE(testConvertRow(getFn_avx2(GetParam())));
+}
+
+/**
+ * Benchmark the row conversion functions. (AVX2-optimized version)
+ */
+TEST_P(RpPngRowConvTest, avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+	benchmarkConvertRow(getFn_avx2(GetParam()));
+}
+#endif /* RPPNG_HAS_AVX2 */
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string RpPngRowConvTest::test_case_suffix_generator(const ::testing::TestParamInfo<RpPngRowConvTest_mode> &info)
+{
+	return info.param.name;
+}
+
+INSTANTIATE_TEST_SUITE_P(RowConv, RpPngRowConvTest,
+	::testing::Values(
+		RpPngRowConvTest_mode("GA", 2),
+		RpPngRowConvTest_mode("RGB", 3),
+		RpPngRowConvTest_mode("RGBA", 4))
+	, RpPngRowConvTest::test_case_suffix_generator);
+
+} }
@@ -0,0 +1,484 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RpPngWriterTest.cpp: RpPngWriter encoding profile test.                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// librpbase
+#include "common.h"
+#include "img/RpPng.hpp"
+#include "img/RpPngWriter.hpp"
+#include "img/IconAnimData.hpp"
+
+// librpcpu
+#include "librpcpu/byteswap.h"
+
+// librpfile
+#include "librpfile/RpFile.hpp"
+#include "librpfile/RpVectorFile.hpp"
+#include "librpfile/FileSystem.hpp"
+using namespace LibRpFile;
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+using LibRpTexture::rp_image;
+
+// C includes. (C++ namespace)
+#include "ctypex.h"
+#include <cstring>
+
+// C++ includes.
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+using std::cout;
+using std::endl;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+struct RpPngWriterTest_mode
+{
+	string png_filename;			// PNG image to test.
+	RpPngWriter::EncodeProfile profile;	// Encoding profile.
+
+	RpPngWriterTest_mode(
+		const char *png_filename,
+		RpPngWriter::EncodeProfile profile)
+		: png_filename(png_filename)
+		, profile(profile)
+	{ }
+
+	// May be required for MSVC 2010?
+	RpPngWriterTest_mode(const RpPngWriterTest_mode &other)
+		: png_filename(other.png_filename)
+		, profile(other.profile)
+	{ }
+
+	// Required for MSVC 2010.
+	RpPngWriterTest_mode &operator=(const RpPngWriterTest_mode &other)
+	{
+		png_filename = other.png_filename;
+		profile = other.profile;
+		return *this;
+	}
+};
+
+/**
+ * Get the name of an encoding profile.
+ * @param profile Encoding profile.
+ * @return Name.
+ */
+static const char *profileName(RpPngWriter::EncodeProfile profile)
+{
+	switch (profile) {
+		case RpPngWriter::EncodeProfile::Fast:		return "Fast";
+		case RpPngWriter::EncodeProfile::Balanced:	return "Balanced";
+		case RpPngWriter::EncodeProfile::Small:		return "Small";
+		default:					return "Unknown";
+	}
+}
+
+/**
+ * Formatting function for RpPngWriterTest.
+ */
+inline ::std::ostream& operator<<(::std::ostream& os, const RpPngWriterTest_mode& mode) {
+	return os << mode.png_filename << '_' << profileName(mode.profile);
+};
+
+class RpPngWriterTest : public ::testing::TestWithParam<RpPngWriterTest_mode>
+{
+	protected:
+		RpPngWriterTest()
+			: m_img(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+		/**
+		 * Load a PNG image from the png_data directory.
+		 * @param filename Filename.
+		 * @return rp_image*, or nullptr on error.
+		 */
+		static rp_image *loadTestImage(const string &filename);
+
+		/**
+		 * Compare two ARGB32 images.
+		 * @param expected	[in] Expected image.
+		 * @param actual	[in] Actual image.
+		 */
+		static void compareImages(const rp_image *expected, const rp_image *actual);
+
+	public:
+		/** Test case parameters. **/
+
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<RpPngWriterTest_mode> &info);
+
+	public:
+		rp_image *m_img;
+};
+
+/**
+ * Load a PNG image from the png_data directory.
+ * @param filename Filename.
+ * @return rp_image*, or nullptr on error.
+ */
+rp_image *RpPngWriterTest::loadTestImage(const string &filename)
+{
+	string path = "png_data";
+	path += DIR_SEP_CHR;
+	path += filename;
+	RpFile *const file = new RpFile(path, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		file->unref();
+		return nullptr;
+	}
+	rp_image *const img = RpPng::load(file);
+	file->unref();
+	return img;
+}
+
+/**
+ * Compare two ARGB32 images.
+ * @param expected	[in] Expected image.
+ * @param actual	[in] Actual image.
+ */
+void RpPngWriterTest::compareImages(const rp_image *expected, const rp_image *actual)
+{
+	ASSERT_TRUE(actual != nullptr);
+	ASSERT_TRUE(actual->isValid());
+	ASSERT_EQ(expected->width(), actual->width());
+	ASSERT_EQ(expected->height(), actual->height());
+	ASSERT_EQ(expected->format(), actual->format());
+
+	const int row_bytes = expected->row_bytes();
+	for (int y = 0; y < expected->height(); y++) {
+		ASSERT_EQ(0, memcmp(expected->scanLine(y), actual->scanLine(y), row_bytes))
+			<< "Row " << y << " does not match.";
+	}
+}
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void RpPngWriterTest::SetUp(void)
+{
+	const RpPngWriterTest_mode &mode = GetParam();
+	m_img = loadTestImage(mode.png_filename);
+	ASSERT_TRUE(m_img != nullptr) << "Error loading PNG image file: "
+		<< mode.png_filename;
+	ASSERT_EQ(rp_image::Format::ARGB32, m_img->format());
+}
+
+/**
+ * TearDown() function.
+ * Run after each test.
+ */
+void RpPngWriterTest::TearDown(void)
+{
+	UNREF_AND_NULL(m_img);
+}
+
+/**
+ * Save an image using the specified profile,
+ * then reload it and compare the pixels.
+ */
+TEST_P(RpPngWriterTest, roundTrip)
+{
+	const RpPngWriterTest_mode &mode = GetParam();
+
+	RpVectorFile *const vecFile = new RpVectorFile();
+	ASSERT_EQ(0, RpPng::save(vecFile, m_img, mode.profile));
+	ASSERT_GT(vecFile->size(), 0);
+
+	vecFile->rewind();
+	rp_image *const img = RpPng::load(vecFile);
+	vecFile->unref();
+	compareImages(m_img, img);
+	UNREF(img);
+}
+
+/**
+ * Write an image in bands using write_IDAT_rows(),
+ * then reload it and compare the pixels.
+ */
+TEST_P(RpPngWriterTest, writeRows)
+{
+	const RpPngWriterTest_mode &mode = GetParam();
+	const int width = m_img->width();
+	const int height = m_img->height();
+
+	RpVectorFile *const vecFile = new RpVectorFile();
+	unique_ptr<RpPngWriter> pngWriter(new RpPngWriter(vecFile, width, height, rp_image::Format::ARGB32));
+	ASSERT_TRUE(pngWriter->isOpen());
+	ASSERT_EQ(0, pngWriter->setEncodeProfile(mode.profile));
+	rp_image::sBIT_t sBIT;
+	ASSERT_EQ(0, pngWriter->write_IHDR(m_img->get_sBIT(&sBIT) == 0 ? &sBIT : nullptr));
+
+	// NOTE: Using an odd band height so the last band is partial.
+	static const int BAND_HEIGHT = 17;
+	const uint8_t *row_pointers[BAND_HEIGHT];
+	for (int y = 0; y < height; y += BAND_HEIGHT) {
+		const int h = (height - y < BAND_HEIGHT ? height - y : BAND_HEIGHT);
+		for (int i = 0; i < h; i++) {
+			row_pointers[i] = static_cast<const uint8_t*>(m_img->scanLine(y + i));
+		}
+		ASSERT_EQ(0, pngWriter->write_IDAT_rows(row_pointers, h));
+	}
+
+	// Writing more rows than the image height must fail.
+	EXPECT_EQ(-EINVAL, pngWriter->write_IDAT_rows(row_pointers, 1));
+	pngWriter->close();
+
+	vecFile->rewind();
+	rp_image *const img = RpPng::load(vecFile);
+	vecFile->unref();
+	compareImages(m_img, img);
+	UNREF(img);
+}
+
+/**
+ * The encoding profile can't be changed after IHDR is written.
+ */
+TEST_P(RpPngWriterTest, setProfileAfterIHDR)
+{
+	const RpPngWriterTest_mode &mode = GetParam();
+
+	RpVectorFile *const vecFile = new RpVectorFile();
+	unique_ptr<RpPngWriter> pngWriter(new RpPngWriter(vecFile, m_img));
+	vecFile->unref();
+	ASSERT_TRUE(pngWriter->isOpen());
+
+	EXPECT_EQ(0, pngWriter->setEncodeProfile(mode.profile));
+	EXPECT_EQ(mode.profile, pngWriter->encodeProfile());
+	ASSERT_EQ(0, pngWriter->write_IHDR());
+	EXPECT_EQ(-EEXIST, pngWriter->setEncodeProfile(RpPngWriter::EncodeProfile::Balanced));
+	EXPECT_EQ(mode.profile, pngWriter->encodeProfile());
+	EXPECT_EQ(0, pngWriter->write_IDAT());
+}
+
+/**
+ * Benchmark encoding time and file size for the specified profile.
+ */
+TEST_P(RpPngWriterTest, encode_benchmark)
+{
+	const RpPngWriterTest_mode &mode = GetParam();
+	static const unsigned int BENCHMARK_ITERATIONS = 100;
+
+	off64_t size = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		RpVectorFile *const vecFile = new RpVectorFile();
+		ASSERT_EQ(0, RpPng::save(vecFile, m_img, mode.profile));
+		size = vecFile->size();
+		vecFile->unref();
+	}
+	const auto end = std::chrono::steady_clock::now();
+	const double us = std::chrono::duration<double, std::micro>(end - start).count() / BENCHMARK_ITERATIONS;
+
+	cout << mode.png_filename << ": " << profileName(mode.profile)
+	     << ": " << us << " us/image, " << size << " bytes" << endl;
+}
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string RpPngWriterTest::test_case_suffix_generator(const ::testing::TestParamInfo<RpPngWriterTest_mode> &info)
+{
+	string suffix = info.param.png_filename;
+	suffix += '_';
+	suffix += profileName(info.param.profile);
+
+	// Replace all non-alphanumeric characters with '_'.
+	// See gtest-param-util.h::IsValidParamName().
+	for (auto iter = suffix.begin(); iter != suffix.end(); ++iter) {
+		if (!isalnum(*iter)) {
+			*iter = '_';
+		}
+	}
+
+	return suffix;
+}
+
+INSTANTIATE_TEST_SUITE_P(gl_triangle_png, RpPngWriterTest,
+	::testing::Values(
+		RpPngWriterTest_mode("gl_triangle.ARGB32.png", RpPngWriter::EncodeProfile::Fast),
+		RpPngWriterTest_mode("gl_triangle.ARGB32.png", RpPngWriter::EncodeProfile::Balanced),
+		RpPngWriterTest_mode("gl_triangle.ARGB32.png", RpPngWriter::EncodeProfile::Small))
+	, RpPngWriterTest::test_case_suffix_generator);
+
+INSTANTIATE_TEST_SUITE_P(gl_quad_png, RpPngWriterTest,
+	::testing::Values(
+		RpPngWriterTest_mode("gl_quad.ARGB32.png", RpPngWriter::EncodeProfile::Fast),
+		RpPngWriterTest_mode("gl_quad.ARGB32.png", RpPngWriter::EncodeProfile::Balanced),
+		RpPngWriterTest_mode("gl_quad.ARGB32.png", RpPngWriter::EncodeProfile::Small))
+	, RpPngWriterTest::test_case_suffix_generator);
+
+/**
+ * APNG frame control chunk. (fcTL)
+ * Only the fields checked by the test are included.
+ */
+struct apng_fcTL_t {
+	uint32_t width;
+	uint32_t height;
+	uint32_t x_offset;
+	uint32_t y_offset;
+	uint16_t delay_num;
+	uint16_t delay_den;
+	uint8_t blend_op;
+};
+
+/**
+ * Get the fcTL chunks from an APNG image.
+ * @param data	[in] PNG data.
+ * @param size	[in] Size of data.
+ * @param num_frames	[out] Number of frames from the acTL chunk.
+ * @return fcTL chunks.
+ */
+static vector<apng_fcTL_t> get_fcTL_chunks(const uint8_t *data, size_t size, uint32_t &num_frames)
+{
+	vector<apng_fcTL_t> fcTLs;
+	num_frames = 0;
+
+	// Skip the PNG signature.
+	for (size_t pos = 8; pos + 12 <= size; ) {
+		uint32_t len;
+		memcpy(&len, &data[pos], sizeof(len));
+		len = be32_to_cpu(len);
+		const uint8_t *const chunk = &data[pos + 8];
+
+		if (!memcmp(&data[pos + 4], "acTL", 4) && len == 8) {
+			memcpy(&num_frames, &chunk[0], sizeof(num_frames));
+			num_frames = be32_to_cpu(num_frames);
+		} else if (!memcmp(&data[pos + 4], "fcTL", 4) && len == 26) {
+			apng_fcTL_t fcTL;
+			uint32_t u32[4];
+			uint16_t u16[2];
+			memcpy(u32, &chunk[4], sizeof(u32));
+			memcpy(u16, &chunk[20], sizeof(u16));
+			fcTL.width = be32_to_cpu(u32[0]);
+			fcTL.height = be32_to_cpu(u32[1]);
+			fcTL.x_offset = be32_to_cpu(u32[2]);
+			fcTL.y_offset = be32_to_cpu(u32[3]);
+			fcTL.delay_num = be16_to_cpu(u16[0]);
+			fcTL.delay_den = be16_to_cpu(u16[1]);
+			fcTL.blend_op = chunk[25];
+			fcTLs.push_back(fcTL);
+		}
+		pos += 12 + len;
+	}
+
+	return fcTLs;
+}
+
+/**
+ * Save an animated icon with repeated frames.
+ * Duplicate frames should be merged, and changed frames
+ * should only contain the region that changed.
+ */
+TEST(RpPngWriterAPNGTest, deltaFrames)
+{
+	static const int ICON_W = 32, ICON_H = 32;
+
+	// Two frames: The second frame has opaque pixels in a
+	// checkerboard pattern within a 4x3 rectangle at (5,7)
+	// that differ from the first frame.
+	IconAnimData *const iconAnimData = new IconAnimData();
+	iconAnimData->count = 2;
+	for (int i = 0; i < 2; i++) {
+		rp_image *const img = new rp_image(ICON_W, ICON_H, rp_image::Format::ARGB32);
+		for (int y = 0; y < ICON_H; y++) {
+			uint32_t *const px = static_cast<uint32_t*>(img->scanLine(y));
+			for (int x = 0; x < ICON_W; x++) {
+				px[x] = 0xFF000000 | (x << 19) | (y << 11) | 0x40;
+				if (i == 1 && x >= 5 && x < 9 && y >= 7 && y < 10 && !((x ^ y) & 1)) {
+					px[x] = 0xFFFFFF00;
+				}
+			}
+		}
+		iconAnimData->frames[i] = img;
+	}
+
+	// Sequence: 0, 1, 1, 0
+	static const uint8_t seq_index[] = {0, 1, 1, 0};
+	iconAnimData->seq_count = static_cast<int>(ARRAY_SIZE(seq_index));
+	for (int i = 0; i < iconAnimData->seq_count; i++) {
+		iconAnimData->seq_index[i] = seq_index[i];
+		iconAnimData->delays[i].numer = 1;
+		iconAnimData->delays[i].denom = 8;
+		iconAnimData->delays[i].ms = 125;
+	}
+
+	RpVectorFile *const vecFile = new RpVectorFile();
+	const int ret = RpPng::save(vecFile, iconAnimData);
+	if (ret == -ENOTSUP) {
+		fprintf(stderr, "*** APNG is not supported by libpng. Skipping test.\n");
+		vecFile->unref();
+		iconAnimData->unref();
+		return;
+	}
+	ASSERT_EQ(0, ret);
+
+	uint32_t num_frames = 0;
+	const vector<uint8_t> &data = vecFile->vector();
+	const vector<apng_fcTL_t> fcTLs = get_fcTL_chunks(data.data(), data.size(), num_frames);
+
+	// The duplicate frame should be merged into the previous frame.
+	EXPECT_EQ(3U, num_frames);
+	ASSERT_EQ(3U, fcTLs.size());
+
+	// First frame: Full image.
+	EXPECT_EQ(static_cast<uint32_t>(ICON_W), fcTLs[0].width);
+	EXPECT_EQ(static_cast<uint32_t>(ICON_H), fcTLs[0].height);
+	EXPECT_EQ(0U, fcTLs[0].x_offset);
+	EXPECT_EQ(0U, fcTLs[0].y_offset);
+	EXPECT_EQ(0, fcTLs[0].blend_op);	// PNG_BLEND_OP_SOURCE
+
+	// Second and third frames: Changed region only.
+	// All changed pixels are opaque, so they can be blended.
+	for (int i = 1; i < 3; i++) {
+		EXPECT_EQ(4U, fcTLs[i].width);
+		EXPECT_EQ(3U, fcTLs[i].height);
+		EXPECT_EQ(5U, fcTLs[i].x_offset);
+		EXPECT_EQ(7U, fcTLs[i].y_offset);
+		EXPECT_EQ(1, fcTLs[i].blend_op);	// PNG_BLEND_OP_OVER
+	}
+
+	// The second frame's delay should include the duplicate frame.
+	EXPECT_EQ(2U * fcTLs[1].delay_den, 8U * fcTLs[1].delay_num);
+	EXPECT_EQ(1U * fcTLs[2].delay_den, 8U * fcTLs[2].delay_num);
+
+	// The default image should be the first frame.
+	vecFile->rewind();
+	rp_image *const img = RpPng::load(vecFile);
+	vecFile->unref();
+	ASSERT_TRUE(img != nullptr);
+	ASSERT_EQ(ICON_W, img->width());
+	ASSERT_EQ(ICON_H, img->height());
+	for (int y = 0; y < ICON_H; y++) {
+		EXPECT_EQ(0, memcmp(iconAnimData->frames[0]->scanLine(y), img->scanLine(y), ICON_W * sizeof(uint32_t)))
+			<< "Row " << y << " does not match.";
+	}
+	UNREF(img);
+	iconAnimData->unref();
+}
+
+} }
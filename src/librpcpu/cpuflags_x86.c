@@ -55,6 +55,7 @@
 
 // Flags stored in the %ebx register.
 #define CPUFLAG_IA32_FN7_EBX_AVX2	((uint32_t)(1U << 5))
+#define CPUFLAG_IA32_FN7_EBX_BMI2	((uint32_t)(1U << 8))
 
 // CPUID function 0x80000001: Extended Processor Info and Feature Bits
 
@@ -138,6 +139,7 @@ static FORCEINLINE int is_cpuid_supported(void)
 
 /**
  * Run the `cpuid` instruction.
+ * The subleaf (%ecx) is always set to 0.
  * @param level
  * @param regs Registers. (%eax, %ebx, %ecx, %edx)
  */
@@ -152,19 +154,25 @@ static FORCEINLINE void cpuid(unsigned int level, unsigned int regs[4])
 		"cpuid\n"
 		"xchgl	%%ebx, %1\n"
 		: "=a" (regs[0]), "=r" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
-		: "0" (level)
+		: "0" (level), "2" (0)
 		);
 # else /* !ASM_RESERVE_EBX */
 	__asm__ (
 		"cpuid\n"
 		: "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
-		: "0" (level)
+		: "0" (level), "2" (0)
 		);
 # endif
 #elif defined(_MSC_VER)
-# if _MSC_VER >= 1400
-	// CPUID for MSVC 2005+
+# if _MSC_VER >= 1500
+	// CPUID for MSVC 2008+
+	// Uses the __cpuidex() intrinsic.
+	__cpuidex((int*)regs, level, 0);
+# elif _MSC_VER >= 1400
+	// CPUID for MSVC 2005
 	// Uses the __cpuid() intrinsic.
+	// NOTE: Subleaf is not cleared, so extended features
+	// (function 7) might not be reported correctly.
 	__cpuid((int*)regs, level);
 # else /* _MSC_VER < 1400 */
 	// CPUID for old MSVC that doesn't support intrinsics.
@@ -173,6 +181,8 @@ static FORCEINLINE void cpuid(unsigned int level, unsigned int regs[4])
 #   error Cannot use inline assembly on 64-bit MSVC.
 #  endif
 	__asm {
+		mov	eax, level
+		xor	ecx, ecx
 		cpuid
 		mov	regs[0 * TYPE int], eax
 		mov	regs[1 * TYPE int], ebx
@@ -185,6 +195,36 @@ static FORCEINLINE void cpuid(unsigned int level, unsigned int regs[4])
 #endif
 }
 
+// XCR0: XSAVE-enabled state components.
+#define XCR0_SSE_STATE		(1U << 1)
+#define XCR0_AVX_STATE		(1U << 2)
+
+/**
+ * Get the low 32 bits of XCR0.
+ * Only call this if CPUID reports OSXSAVE.
+ * @return Low 32 bits of XCR0, or 0 if `xgetbv` can't be used.
+ */
+static FORCEINLINE uint32_t xgetbv0(void)
+{
+#if defined(__GNUC__)
+	// NOTE: Using the raw opcode for compatibility
+	// with older assemblers.
+	uint32_t __eax, __edx;
+	__asm__ (
+		".byte 0x0F, 0x01, 0xD0\n"	// xgetbv
+		: "=a" (__eax), "=d" (__edx)
+		: "c" (0)
+		);
+	return __eax;
+#elif defined(_MSC_VER) && (_MSC_FULL_VER >= 160040219)
+	// MSVC 2010 SP1+
+	return (uint32_t)_xgetbv(0);
+#else
+	// Not supported.
+	return 0;
+#endif
+}
+
 // Register indexes.
 #define REG_EAX 0
 #define REG_EBX 1
@@ -308,6 +348,35 @@ static void RP_CPU_InitCPUFlags_int(void)
 		if (regs[REG_ECX] & CPUFLAG_IA32_ECX_SSE42)
 			RP_CPU_Flags |= RP_CPUFLAG_X86_SSE42;
 #endif /* defined(__i386__) || defined(_M_IX86) */
+
+		// Check for AVX.
+		// The OS must save the upper halves of the YMM registers
+		// on context switches, which is indicated by XCR0.
+		if ((RP_CPU_Flags & RP_CPUFLAG_X86_SSE2) &&
+		    (regs[REG_ECX] & (CPUFLAG_IA32_ECX_OSXSAVE | CPUFLAG_IA32_ECX_AVX)) ==
+		     (CPUFLAG_IA32_ECX_OSXSAVE | CPUFLAG_IA32_ECX_AVX))
+		{
+			const uint32_t xcr0 = xgetbv0();
+			if ((xcr0 & (XCR0_SSE_STATE | XCR0_AVX_STATE)) ==
+			     (XCR0_SSE_STATE | XCR0_AVX_STATE))
+			{
+				RP_CPU_Flags |= RP_CPUFLAG_X86_AVX;
+			}
+		}
+	}
+
+	if (maxFunc >= CPUID_EXT_FEATURES) {
+		// Get the extended features.
+		cpuid(CPUID_EXT_FEATURES, regs);
+		// BMI2 uses general-purpose registers, so it
+		// doesn't depend on OS support for AVX.
+		if (regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_BMI2)
+			RP_CPU_Flags |= RP_CPUFLAG_X86_BMI2;
+		if ((RP_CPU_Flags & RP_CPUFLAG_X86_AVX) &&
+		    (regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_AVX2))
+		{
+			RP_CPU_Flags |= RP_CPUFLAG_X86_AVX2;
+		}
 	}
 
 	// CPU flags initialized.
@@ -0,0 +1,578 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * SplitFile.cpp: Special wrapper for handling an N-part split file as one.*
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "SplitFile.hpp"
+#include "FileSystem.hpp"
+#include "RpFile.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+// C++ STL classes.
+using std::string;
+using std::vector;
+
+namespace LibRpFile {
+
+// Maximum number of parts to look for.
+static const unsigned int SPLITFILE_MAX_PARTS = 1000;
+
+/**
+ * Split filename information.
+ * Part filenames are: prefix + number + suffix
+ */
+struct SplitFilenameInfo {
+	string prefix;		// Filename up to the part number.
+	string suffix;		// Filename after the part number. (may be empty)
+	string joined;		// Filename of the combined file.
+	unsigned int first;	// First part number. (0 or 1)
+	unsigned int width;	// Minimum number of digits. (zero-padded)
+};
+
+/**
+ * Check if a string only contains digits.
+ * @param s String.
+ * @param len Length.
+ * @return True if the string only contains digits.
+ */
+static bool is_all_digits(const char *s, size_t len)
+{
+	if (len == 0)
+		return false;
+	for (; len > 0; s++, len--) {
+		if (!ISDIGIT(*s))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Parse a filename for split file naming schemes.
+ * @param filename	[in] Filename.
+ * @param info		[out] Split filename information.
+ * @return True if the filename looks like the first part of a split file; false if not.
+ */
+static bool parseSplitFilename(const string &filename, SplitFilenameInfo &info)
+{
+	const size_t slashpos = filename.find_last_of(DIR_SEP_CHR);
+	const size_t name_start = (slashpos != string::npos ? slashpos + 1 : 0);
+	const size_t dotpos = filename.find_last_of('.');
+	if (dotpos == string::npos || dotpos < name_start || dotpos >= filename.size()-1) {
+		// No file extension.
+		return false;
+	}
+
+	const char *const ext = &filename[dotpos+1];
+	const size_t ext_len = filename.size() - dotpos - 1;
+
+	// Part number location within the filename.
+	size_t num_pos, num_len;
+	if (ext_len <= 3 && is_all_digits(ext, ext_len)) {
+		// name.ext.0, name.ext.000
+		num_pos = dotpos + 1;
+		num_len = ext_len;
+		info.suffix.clear();
+		info.joined.assign(filename, 0, dotpos);
+	} else if (ext_len > 4 && !strncasecmp(ext, "part", 4) && is_all_digits(ext+4, ext_len-4)) {
+		// name.part0
+		num_pos = dotpos + 5;
+		num_len = ext_len - 4;
+		info.suffix.clear();
+		info.joined.assign(filename, 0, dotpos);
+	} else {
+		// Check for name.part0.ext.
+		const size_t dotpos2 = (dotpos > 0 ? filename.find_last_of('.', dotpos-1) : string::npos);
+		if (dotpos2 == string::npos || dotpos2 < name_start) {
+			// Not a split file.
+			return false;
+		}
+		const char *const ext2 = &filename[dotpos2+1];
+		const size_t ext2_len = dotpos - dotpos2 - 1;
+		if (ext2_len <= 4 || strncasecmp(ext2, "part", 4) != 0 || !is_all_digits(ext2+4, ext2_len-4)) {
+			// Not a split file.
+			return false;
+		}
+		num_pos = dotpos2 + 5;
+		num_len = ext2_len - 4;
+		info.suffix.assign(filename, dotpos, string::npos);
+		info.joined.assign(filename, 0, dotpos2);
+		info.joined += info.suffix;
+	}
+
+	if (num_len > 4) {
+		// Part number is too long.
+		return false;
+	}
+
+	// The first part must be either 0 or 1.
+	const unsigned int num = static_cast<unsigned int>(strtoul(&filename[num_pos], nullptr, 10));
+	if (num > 1) {
+		// Not the first part.
+		return false;
+	}
+
+	info.prefix.assign(filename, 0, num_pos);
+	info.first = num;
+	info.width = static_cast<unsigned int>(num_len);
+	return true;
+}
+
+/**
+ * Get the filename of a part.
+ * @param info Split filename information.
+ * @param num Part number.
+ * @return Filename.
+ */
+static string partFilename(const SplitFilenameInfo &info, unsigned int num)
+{
+	char buf[16];
+	snprintf(buf, sizeof(buf), "%0*u", static_cast<int>(info.width), num);
+	string s = info.prefix;
+	s += buf;
+	s += info.suffix;
+	return s;
+}
+
+/**
+ * Open a split file set, starting with the first part.
+ * The resulting IRpFile is read-only.
+ *
+ * Supported naming schemes:
+ * - name.ext.0, name.ext.1, ... (also .000/.001 and .001/.002)
+ * - name.part0, name.part1, ... (also starting at .part1)
+ * - name.part0.ext, name.part1.ext, ...
+ *
+ * The remaining parts are located using the first part's
+ * filename, and are only opened when they're read from.
+ *
+ * If file0 is not the first part of a split file set
+ * with at least two parts, isOpen() will return false.
+ *
+ * @param file0 First part.
+ */
+SplitFile::SplitFile(IRpFile *file0)
+	: super()
+	, m_fullSize(0)
+	, m_pos(0)
+	, m_lastPart(0)
+{
+	assert(file0 != nullptr);
+	if (!file0) {
+		// File is missing.
+		m_lastError = EBADF;
+		return;
+	}
+
+	const string filename0 = file0->filename();
+	SplitFilenameInfo info;
+	if (filename0.empty() || !parseSplitFilename(filename0, info)) {
+		// Not a split file.
+		m_lastError = ENOENT;
+		return;
+	}
+
+	if (info.first == 1) {
+		// If a part 0 exists, this isn't the first part.
+		// NOTE: Checking the file size like the other parts,
+		// since empty parts are ignored.
+		if (FileSystem::filesize(partFilename(info, 0)) > 0) {
+			// Not the first part.
+			m_lastError = ENOENT;
+			return;
+		}
+	}
+
+	// First part.
+	const off64_t size0 = file0->size();
+	if (size0 <= 0) {
+		// First part is empty.
+		m_lastError = EIO;
+		return;
+	}
+
+	// Find the remaining parts.
+	// Only the file sizes are needed for now.
+	vector<Part> parts;
+	parts.push_back(Part());
+	parts[0].file = nullptr;
+	parts[0].openError = 0;
+	parts[0].filename = filename0;
+	parts[0].start = 0;
+	parts[0].size = size0;
+
+	off64_t start = size0;
+	for (unsigned int num = info.first + 1; num < SPLITFILE_MAX_PARTS; num++) {
+		string filenameN = partFilename(info, num);
+		const off64_t sizeN = FileSystem::filesize(filenameN);
+		if (sizeN <= 0) {
+			// No more parts.
+			break;
+		}
+
+		Part part;
+		part.file = nullptr;
+		part.openError = 0;
+		part.filename = std::move(filenameN);
+		part.start = start;
+		part.size = sizeN;
+		parts.push_back(std::move(part));
+		start += sizeN;
+	}
+
+	if (parts.size() < 2) {
+		// Not a split file.
+		m_lastError = ENOENT;
+		return;
+	}
+
+	// Split file set found.
+	parts[0].file = file0->ref();
+	m_parts = std::move(parts);
+	m_filename = std::move(info.joined);
+	m_fullSize = start;
+}
+
+/**
+ * Open already-opened files and handle them as if they're a single file.
+ * The resulting IRpFile is read-only.
+ *
+ * @param files Parts, in order.
+ */
+SplitFile::SplitFile(const vector<IRpFile*> &files)
+	: super()
+	, m_fullSize(0)
+	, m_pos(0)
+	, m_lastPart(0)
+{
+	assert(!files.empty());
+	if (files.empty()) {
+		// No files...
+		m_lastError = EBADF;
+		return;
+	}
+
+	m_parts.reserve(files.size());
+	for (IRpFile *file : files) {
+		assert(file != nullptr);
+		if (!file) {
+			// File is missing.
+			close();
+			m_lastError = EBADF;
+			return;
+		}
+
+		Part part;
+		part.file = file->ref();
+		part.openError = 0;
+		part.start = m_fullSize;
+		part.size = file->size();
+		m_parts.push_back(std::move(part));
+		if (m_parts.back().size <= 0) {
+			// Part is empty.
+			close();
+			m_lastError = EIO;
+			return;
+		}
+		m_fullSize += m_parts.back().size;
+	}
+
+	m_filename = files[0]->filename();
+}
+
+SplitFile::~SplitFile()
+{
+	for (Part &part : m_parts) {
+		UNREF(part.file);
+	}
+}
+
+/**
+ * Is the file open?
+ * This usually only returns false if an error occurred.
+ * @return True if the file is open; false if it isn't.
+ */
+bool SplitFile::isOpen(void) const
+{
+	return (!m_parts.empty() && m_parts[0].file != nullptr);
+}
+
+/**
+ * Close the file.
+ */
+void SplitFile::close(void)
+{
+	for (Part &part : m_parts) {
+		UNREF(part.file);
+	}
+	m_parts.clear();
+
+	m_fullSize = 0;
+	m_pos = 0;
+	m_lastPart = 0;
+}
+
+/**
+ * Find the part that contains the specified position.
+ * @param pos Position. (must be < m_fullSize)
+ * @return Part index.
+ */
+unsigned int SplitFile::findPart(off64_t pos)
+{
+	assert(pos >= 0 && pos < m_fullSize);
+
+	// Sequential reads usually stay in the same part.
+	const Part &last = m_parts[m_lastPart];
+	if (pos >= last.start && pos < last.start + last.size) {
+		return m_lastPart;
+	}
+
+	// Binary search for the last part that starts at or before pos.
+	auto iter = std::upper_bound(m_parts.cbegin(), m_parts.cend(), pos,
+		[](off64_t pos, const Part &part) {
+			return (pos < part.start);
+		});
+	assert(iter != m_parts.cbegin());
+	m_lastPart = static_cast<unsigned int>(std::distance(m_parts.cbegin(), iter) - 1);
+	return m_lastPart;
+}
+
+/**
+ * Get the IRpFile for the specified part, opening it if necessary.
+ * @param idx Part index.
+ * @return IRpFile, or nullptr on error.
+ */
+IRpFile *SplitFile::getPartFile(unsigned int idx)
+{
+	assert(idx < m_parts.size());
+	Part &part = m_parts[idx];
+	if (part.file) {
+		// Part is already open.
+		return part.file;
+	} else if (part.openError != 0) {
+		// A previous attempt to open the part failed.
+		m_lastError = part.openError;
+		return nullptr;
+	}
+
+	// Open the part.
+	RpFile *const file = new RpFile(part.filename, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		// Unable to open the part.
+		part.openError = file->lastError();
+		if (part.openError == 0) {
+			part.openError = EIO;
+		}
+		m_lastError = part.openError;
+		file->unref();
+		return nullptr;
+	}
+
+	// Make sure the part size hasn't changed.
+	if (file->size() != part.size) {
+		part.openError = EIO;
+		m_lastError = EIO;
+		file->unref();
+		return nullptr;
+	}
+
+	part.file = file;
+	return file;
+}
+
+/**
+ * Read data from the file.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t SplitFile::read(void *ptr, size_t size)
+{
+	const size_t sz_read = readAt(m_pos, ptr, size);
+	m_pos += sz_read;
+	return sz_read;
+}
+
+/**
+ * Read data from the specified position.
+ * The file position is not changed.
+ * Reads may cross part boundaries.
+ * @param pos	[in] Starting position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t SplitFile::readAt(off64_t pos, void *ptr, size_t size)
+{
+	if (!isOpen()) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	if (unlikely(size == 0) || pos < 0 || pos >= m_fullSize) {
+		// Not reading anything...
+		return 0;
+	}
+
+	// Make sure pos + size <= m_fullSize.
+	// If it isn't, we'll do a short read.
+	if (pos + static_cast<off64_t>(size) > m_fullSize) {
+		size = static_cast<size_t>(m_fullSize - pos);
+	}
+
+	// uint8_t pointer access.
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+
+	for (unsigned int idx = findPart(pos); size > 0 && idx < m_parts.size(); idx++) {
+		IRpFile *const file = getPartFile(idx);
+		if (!file) {
+			// Unable to open the part.
+			break;
+		}
+
+		const Part &part = m_parts[idx];
+		const off64_t partPos = pos - part.start;
+		size_t sz_part = size;
+		if (partPos + static_cast<off64_t>(sz_part) > part.size) {
+			sz_part = static_cast<size_t>(part.size - partPos);
+		}
+
+		const size_t sz_read = file->seekAndRead(partPos, ptr8, sz_part);
+		m_lastPart = idx;
+		ret += sz_read;
+		if (sz_read != sz_part) {
+			// Short read.
+			m_lastError = file->lastError();
+			if (m_lastError == 0) {
+				m_lastError = EIO;
+			}
+			break;
+		}
+
+		pos += sz_read;
+		ptr8 += sz_read;
+		size -= sz_read;
+	}
+
+	return ret;
+}
+
+/**
+ * Write data to the file.
+ * (NOTE: Not valid for SplitFile; this will always return 0.)
+ * @param ptr Input data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes written.
+ */
+size_t SplitFile::write(const void *ptr, size_t size)
+{
+	// Not a valid operation for SplitFile.
+	RP_UNUSED(ptr);
+	RP_UNUSED(size);
+	m_lastError = EBADF;
+	return 0;
+}
+
+/**
+ * Set the file position.
+ * @param pos File position.
+ * @return 0 on success; -1 on error.
+ */
+int SplitFile::seek(off64_t pos)
+{
+	if (!isOpen()) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	if (pos <= 0) {
+		m_pos = 0;
+	} else if (pos >= m_fullSize) {
+		m_pos = m_fullSize;
+	} else {
+		m_pos = pos;
+	}
+
+	return 0;
+}
+
+/**
+ * Get the file position.
+ * @return File position, or -1 on error.
+ */
+off64_t SplitFile::tell(void)
+{
+	if (!isOpen()) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	return m_pos;
+}
+
+/**
+ * Truncate the file.
+ * (NOTE: Not valid for SplitFile; this will always return -1.)
+ * @param size New size. (default is 0)
+ * @return 0 on success; -1 on error.
+ */
+int SplitFile::truncate(off64_t size)
+{
+	// Not supported.
+	RP_UNUSED(size);
+	m_lastError = ENOTSUP;
+	return -1;
+}
+
+/** File properties **/
+
+/**
+ * Get the file size.
+ * @return File size, or negative on error.
+ */
+off64_t SplitFile::size(void)
+{
+	if (!isOpen()) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	return m_fullSize;
+}
+
+/**
+ * Get the filename.
+ * This is the filename of the combined file,
+ * without the part number.
+ * @return Filename. (May be empty if the filename is not available.)
+ */
+string SplitFile::filename(void) const
+{
+	return m_filename;
+}
+
+/** SplitFile functions **/
+
+/**
+ * Check if a filename matches a split file naming scheme
+ * for the first part of a split file set.
+ *
+ * Only the filename is checked. The filesystem isn't
+ * accessed, so the other parts might not exist.
+ *
+ * @param filename Filename.
+ * @return True if the filename matches; false if not.
+ */
+bool SplitFile::isSplitFilename(const string &filename)
+{
+	SplitFilenameInfo info;
+	return parseSplitFilename(filename, info);
+}
+
+}
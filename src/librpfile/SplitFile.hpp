@@ -0,0 +1,197 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * SplitFile.hpp: Special wrapper for handling an N-part split file as one.*
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPFILE_SPLITFILE_HPP__
+#define __ROMPROPERTIES_LIBRPFILE_SPLITFILE_HPP__
+
+#include "IRpFile.hpp"
+
+// C++ includes.
+#include <string>
+#include <vector>
+
+namespace LibRpFile {
+
+class SplitFile final : public IRpFile
+{
+	public:
+		/**
+		 * Open a split file set, starting with the first part.
+		 * The resulting IRpFile is read-only.
+		 *
+		 * Supported naming schemes:
+		 * - name.ext.0, name.ext.1, ... (also .000/.001 and .001/.002)
+		 * - name.part0, name.part1, ... (also starting at .part1)
+		 * - name.part0.ext, name.part1.ext, ...
+		 *
+		 * The remaining parts are located using the first part's
+		 * filename, and are only opened when they're read from.
+		 *
+		 * If file0 is not the first part of a split file set
+		 * with at least two parts, isOpen() will return false.
+		 *
+		 * @param file0 First part.
+		 */
+		explicit SplitFile(IRpFile *file0);
+
+		/**
+		 * Open already-opened files and handle them as if they're a single file.
+		 * The resulting IRpFile is read-only.
+		 *
+		 * @param files Parts, in order.
+		 */
+		explicit SplitFile(const std::vector<IRpFile*> &files);
+	protected:
+		virtual ~SplitFile();	// call unref() instead
+
+	private:
+		typedef IRpFile super;
+		RP_DISABLE_COPY(SplitFile)
+
+	public:
+		/**
+		 * Is the file open?
+		 * This usually only returns false if an error occurred.
+		 * @return True if the file is open; false if it isn't.
+		 */
+		bool isOpen(void) const final;
+
+		/**
+		 * Close the file.
+		 */
+		void close(void) final;
+
+		/**
+		 * Read data from the file.
+		 * @param ptr Output data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 2, 3)
+		size_t read(void *ptr, size_t size) final;
+
+		/**
+		 * Write data to the file.
+		 * (NOTE: Not valid for SplitFile; this will always return 0.)
+		 * @param ptr Input data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes written.
+		 */
+		ATTR_ACCESS_SIZE(read_only, 2, 3)
+		size_t write(const void *ptr, size_t size) final;
+
+		/**
+		 * Set the file position.
+		 * @param pos File position.
+		 * @return 0 on success; -1 on error.
+		 */
+		int seek(off64_t pos) final;
+
+		/**
+		 * Get the file position.
+		 * @return File position, or -1 on error.
+		 */
+		off64_t tell(void) final;
+
+		/**
+		 * Truncate the file.
+		 * (NOTE: Not valid for SplitFile; this will always return -1.)
+		 * @param size New size. (default is 0)
+		 * @return 0 on success; -1 on error.
+		 */
+		int truncate(off64_t size = 0) final;
+
+	public:
+		/** File properties **/
+
+		/**
+		 * Get the file size.
+		 * @return File size, or negative on error.
+		 */
+		off64_t size(void) final;
+
+		/**
+		 * Get the filename.
+		 * This is the filename of the combined file,
+		 * without the part number.
+		 * @return Filename. (May be empty if the filename is not available.)
+		 */
+		std::string filename(void) const final;
+
+	public:
+		/** SplitFile functions **/
+
+		/**
+		 * Check if a filename matches a split file naming scheme
+		 * for the first part of a split file set.
+		 *
+		 * Only the filename is checked. The filesystem isn't
+		 * accessed, so the other parts might not exist.
+		 *
+		 * @param filename Filename.
+		 * @return True if the filename matches; false if not.
+		 */
+		static bool isSplitFilename(const std::string &filename);
+
+		/**
+		 * Read data from the specified position.
+		 * The file position is not changed.
+		 * Reads may cross part boundaries.
+		 * @param pos	[in] Starting position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size);
+
+		/**
+		 * Get the number of parts.
+		 * @return Number of parts.
+		 */
+		inline unsigned int partCount(void) const
+		{
+			return static_cast<unsigned int>(m_parts.size());
+		}
+
+	private:
+		/**
+		 * Find the part that contains the specified position.
+		 * @param pos Position. (must be < m_fullSize)
+		 * @return Part index.
+		 */
+		unsigned int findPart(off64_t pos);
+
+		/**
+		 * Get the IRpFile for the specified part, opening it if necessary.
+		 * If the part can't be opened, the error is saved, and the
+		 * part won't be opened again.
+		 * @param idx Part index.
+		 * @return IRpFile, or nullptr on error.
+		 */
+		IRpFile *getPartFile(unsigned int idx);
+
+	private:
+		struct Part {
+			IRpFile *file;		// nullptr if not opened yet
+			int openError;		// errno if opening the part failed
+			std::string filename;	// for opening on demand
+			off64_t start;		// starting offset in the combined file
+			off64_t size;		// size of this part
+		};
+		std::vector<Part> m_parts;
+
+		std::string m_filename;	// Combined filename.
+		off64_t m_fullSize;	// Combined sizes.
+		off64_t m_pos;		// Current position.
+		unsigned int m_lastPart;	// Last part accessed.
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPFILE_SPLITFILE_HPP__ */
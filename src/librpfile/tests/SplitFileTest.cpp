@@ -0,0 +1,325 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile/tests)                  *
+ * SplitFileTest.cpp: SplitFile detection test.                            *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpfile
+#include "librpfile/RpFile.hpp"
+#include "librpfile/SplitFile.hpp"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+
+// C++ includes.
+#include <string>
+using std::string;
+
+// Directory separator for test filenames.
+#ifdef _WIN32
+# define DIR_SEP_STR_A "\\"
+#else /* !_WIN32 */
+# define DIR_SEP_STR_A "/"
+#endif /* _WIN32 */
+
+namespace LibRpFile { namespace Tests {
+
+class SplitFileTest : public ::testing::Test
+{
+	protected:
+		SplitFileTest() { }
+
+	public:
+		/**
+		 * Get the path of a test file in split_data/.
+		 * @param filename Filename.
+		 * @return Path.
+		 */
+		static string testPath(const char *filename);
+
+		/**
+		 * Open a test file and create a SplitFile from it.
+		 * @param filename Filename of the part in split_data/.
+		 * @return SplitFile, or nullptr if the part couldn't be opened. (Caller must unref() it.)
+		 */
+		static SplitFile *openSplitFile(const char *filename);
+
+		/**
+		 * Verify data read from the test files.
+		 * Each byte in the test files is the low 8 bits of
+		 * its offset within the combined file.
+		 * @param buf	[in] Data.
+		 * @param pos	[in] Starting offset in the combined file.
+		 * @param size	[in] Size of buf.
+		 */
+		static void checkData(const uint8_t *buf, unsigned int pos, size_t size);
+};
+
+/**
+ * Get the path of a test file in split_data/.
+ * @param filename Filename.
+ * @return Path.
+ */
+string SplitFileTest::testPath(const char *filename)
+{
+	string path = "split_data" DIR_SEP_STR_A;
+	path += filename;
+	return path;
+}
+
+/**
+ * Open a test file and create a SplitFile from it.
+ * @param filename Filename of the part in split_data/.
+ * @return SplitFile, or nullptr if the part couldn't be opened. (Caller must unref() it.)
+ */
+SplitFile *SplitFileTest::openSplitFile(const char *filename)
+{
+	RpFile *const file = new RpFile(testPath(filename), RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		file->unref();
+		return nullptr;
+	}
+
+	SplitFile *const splitFile = new SplitFile(file);
+	file->unref();
+	return splitFile;
+}
+
+/**
+ * Verify data read from the test files.
+ * Each byte in the test files is the low 8 bits of
+ * its offset within the combined file.
+ * @param buf	[in] Data.
+ * @param pos	[in] Starting offset in the combined file.
+ * @param size	[in] Size of buf.
+ */
+void SplitFileTest::checkData(const uint8_t *buf, unsigned int pos, size_t size)
+{
+	for (size_t i = 0; i < size; i++) {
+		EXPECT_EQ(static_cast<uint8_t>(pos + i), buf[i]) << "offset " << (pos + i);
+	}
+}
+
+/**
+ * Test first-part filename patterns.
+ */
+TEST_F(SplitFileTest, firstPartFilenames)
+{
+	static const char *const filenames[] = {
+		"game.iso.0",
+		"game.iso.000",
+		"game.iso.1",
+		"game.iso.001",
+		"game.000",
+		"game.001",
+		"game.part0",
+		"game.part1",
+		"game.PART0",
+		"game.part00",
+		"game.part0.iso",
+		"game.part1.iso",
+		"game.Part0.wbfs",
+		"dir" DIR_SEP_STR_A "game.part0.iso",
+		"dir.iso" DIR_SEP_STR_A "game.iso.0",
+	};
+
+	for (const char *filename : filenames) {
+		EXPECT_TRUE(SplitFile::isSplitFilename(filename)) << filename;
+	}
+}
+
+/**
+ * Test filenames that aren't the first part of a split file.
+ */
+TEST_F(SplitFileTest, notFirstPartFilenames)
+{
+	static const char *const filenames[] = {
+		// Not split files.
+		"",
+		"game",
+		"game.",
+		"game.iso",
+		"game.iso.x",
+		"game.iso.0a",
+		"game.part",
+		"game.partX",
+		"game.part0a",
+		"game.part.iso",
+		"game.iso.0001",	// Too many digits for a numeric extension.
+		"game.part00000",	// Too many digits for a part number.
+		"dir.part0" DIR_SEP_STR_A "game.iso",
+		"dir.iso.0" DIR_SEP_STR_A "game",
+
+		// Not the first part.
+		"game.iso.2",
+		"game.002",
+		"game.part2",
+		"game.part2.iso",
+		"game.part10.iso",
+	};
+
+	for (const char *filename : filenames) {
+		EXPECT_FALSE(SplitFile::isSplitFilename(filename)) << filename;
+	}
+}
+
+/**
+ * Test a split file set with all parts present.
+ */
+TEST_F(SplitFileTest, allParts)
+{
+	SplitFile *const splitFile = openSplitFile("all.iso.0");
+	ASSERT_NE(nullptr, splitFile);
+	ASSERT_TRUE(splitFile->isOpen());
+	EXPECT_EQ(3U, splitFile->partCount());
+	EXPECT_EQ(250, splitFile->size());
+	EXPECT_EQ(testPath("all.iso"), splitFile->filename());
+
+	// Read across both part boundaries.
+	uint8_t buf[150];
+	ASSERT_EQ(sizeof(buf), splitFile->readAt(75, buf, sizeof(buf)));
+	ASSERT_NO_FATAL_FAILURE(checkData(buf, 75, sizeof(buf)));
+
+	// Sequential reads.
+	ASSERT_EQ(0, splitFile->seek(90));
+	ASSERT_EQ(20U, splitFile->read(buf, 20));
+	ASSERT_NO_FATAL_FAILURE(checkData(buf, 90, 20));
+	EXPECT_EQ(110, splitFile->tell());
+
+	splitFile->unref();
+}
+
+/**
+ * Successful reads must not clear the last error.
+ */
+TEST_F(SplitFileTest, readKeepsLastError)
+{
+	SplitFile *const splitFile = openSplitFile("all.iso.0");
+	ASSERT_NE(nullptr, splitFile);
+	ASSERT_TRUE(splitFile->isOpen());
+	EXPECT_EQ(0, splitFile->lastError());
+
+	// SplitFile is read-only, so write() fails with EBADF.
+	uint8_t buf[150];
+	EXPECT_EQ(0U, splitFile->write(buf, sizeof(buf)));
+	EXPECT_EQ(EBADF, splitFile->lastError());
+
+	// Read across both part boundaries.
+	ASSERT_EQ(sizeof(buf), splitFile->readAt(75, buf, sizeof(buf)));
+	ASSERT_NO_FATAL_FAILURE(checkData(buf, 75, sizeof(buf)));
+	EXPECT_EQ(EBADF, splitFile->lastError());
+
+	splitFile->unref();
+}
+
+/**
+ * Test a split file set starting at 1, with the part number before the extension.
+ */
+TEST_F(SplitFileTest, partNumberBeforeExtension)
+{
+	SplitFile *const splitFile = openSplitFile("ext.part1.iso");
+	ASSERT_NE(nullptr, splitFile);
+	ASSERT_TRUE(splitFile->isOpen());
+	EXPECT_EQ(2U, splitFile->partCount());
+	EXPECT_EQ(200, splitFile->size());
+	EXPECT_EQ(testPath("ext.iso"), splitFile->filename());
+	splitFile->unref();
+}
+
+/**
+ * Test a first part that doesn't have any other parts.
+ */
+TEST_F(SplitFileTest, missingSecondPart)
+{
+	SplitFile *const splitFile = openSplitFile("single.iso.0");
+	ASSERT_NE(nullptr, splitFile);
+	EXPECT_FALSE(splitFile->isOpen());
+	splitFile->unref();
+}
+
+/**
+ * Test a split file set with a missing part in the middle.
+ * Only the parts before the missing part are used.
+ */
+TEST_F(SplitFileTest, missingMiddlePart)
+{
+	SplitFile *const splitFile = openSplitFile("gap.part0");
+	ASSERT_NE(nullptr, splitFile);
+	ASSERT_TRUE(splitFile->isOpen());
+	EXPECT_EQ(2U, splitFile->partCount());
+	EXPECT_EQ(200, splitFile->size());
+	splitFile->unref();
+}
+
+/**
+ * Test a split file set where the second part is empty.
+ */
+TEST_F(SplitFileTest, emptySecondPart)
+{
+	SplitFile *const splitFile = openSplitFile("empty.000");
+	ASSERT_NE(nullptr, splitFile);
+	EXPECT_FALSE(splitFile->isOpen());
+	splitFile->unref();
+}
+
+/**
+ * Test a split file set where the last part is shorter than the others.
+ * Reads past the end of the last part must be truncated.
+ */
+TEST_F(SplitFileTest, shortLastPart)
+{
+	SplitFile *const splitFile = openSplitFile("short.iso.0");
+	ASSERT_NE(nullptr, splitFile);
+	ASSERT_TRUE(splitFile->isOpen());
+	EXPECT_EQ(2U, splitFile->partCount());
+	EXPECT_EQ(137, splitFile->size());
+
+	uint8_t buf[64];
+	ASSERT_EQ(47U, splitFile->readAt(90, buf, sizeof(buf)));
+	ASSERT_NO_FATAL_FAILURE(checkData(buf, 90, 47));
+	EXPECT_EQ(0U, splitFile->readAt(137, buf, sizeof(buf)));
+
+	splitFile->unref();
+}
+
+/**
+ * Test opening a .001 file when a .000 file is present.
+ * The .001 file isn't the first part in this case.
+ */
+TEST_F(SplitFileTest, notFirstPart)
+{
+	SplitFile *splitFile = openSplitFile("first.001");
+	ASSERT_NE(nullptr, splitFile);
+	EXPECT_FALSE(splitFile->isOpen());
+	splitFile->unref();
+
+	splitFile = openSplitFile("first.000");
+	ASSERT_NE(nullptr, splitFile);
+	ASSERT_TRUE(splitFile->isOpen());
+	EXPECT_EQ(3U, splitFile->partCount());
+	EXPECT_EQ(300, splitFile->size());
+	EXPECT_EQ(testPath("first"), splitFile->filename());
+	splitFile->unref();
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpFile test suite: SplitFile tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
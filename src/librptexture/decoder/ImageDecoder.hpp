@@ -24,6 +24,11 @@
 # include "librpcpu/cpuflags_x86.h"
 # define IMAGEDECODER_HAS_SSE2 1
 # define IMAGEDECODER_HAS_SSSE3 1
+# define IMAGEDECODER_HAS_SSE41 1
+# if !defined(_MSC_VER) || _MSC_VER >= 1800
+#  define IMAGEDECODER_HAS_AVX2 1
+#  define IMAGEDECODER_HAS_BMI2 1
+# endif
 #endif
 #ifdef RP_CPU_AMD64
 # define IMAGEDECODER_ALWAYS_HAS_SSE2 1
@@ -31,6 +36,7 @@
 
 namespace LibRpTexture {
 	class rp_image;
+	class rp_image_buffer;
 }
 
 namespace LibRpTexture { namespace ImageDecoder {
@@ -137,6 +143,23 @@ enum PixelFormat {
 #endif
 };
 
+/** Multithreading **/
+
+/**
+ * Set the maximum number of threads used to decode
+ * large block-compressed images. (S3TC, BC7, ETC1/ETC2)
+ * Small images are always decoded on the calling thread.
+ * @param maxThreads Maximum number of threads. (0 == number of logical CPUs; 1 == single-threaded)
+ */
+void setMaxThreads(unsigned int maxThreads);
+
+/**
+ * Get the maximum number of threads used to decode
+ * large block-compressed images.
+ * @return Maximum number of threads. (0 == number of logical CPUs)
+ */
+unsigned int maxThreads(void);
+
 /**
  * Convert a linear CI4 image to rp_image with a little-endian 16-bit palette.
  * @param px_format Palette pixel format.
@@ -236,10 +259,28 @@ rp_image *fromLinear16_sse2(PixelFormat px_format,
 	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0);
 #endif /* IMAGEDECODER_HAS_SSE2 */
 
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a linear 16-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 16-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear16_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
 #if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 
-#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
-// System does support IFUNC, but it's always guaranteed to have SSE2.
+#  if defined(IMAGEDECODER_ALWAYS_HAS_SSE2) && !defined(IMAGEDECODER_HAS_AVX2)
+// System does support IFUNC, but it's always guaranteed to have SSE2,
+// and there aren't any other optimized versions.
 // Eliminate the IFUNC dispatch on this system.
 
 /**
@@ -259,8 +300,9 @@ static inline rp_image *fromLinear16(PixelFormat px_format,
 	// amd64 always has SSE2.
 	return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
 }
-#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
-// System supports IFUNC and is not guaranteed to always have SSE2.
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 || IMAGEDECODER_HAS_AVX2 */
+// System supports IFUNC and is either not guaranteed to always
+// have SSE2, or it might have AVX2.
 
 /**
  * Convert a linear 16-bit RGB image to rp_image.
@@ -272,10 +314,10 @@ static inline rp_image *fromLinear16(PixelFormat px_format,
  * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
  * @return rp_image, or nullptr on error.
  */
-IFUNC_SSE2_STATIC_INLINE rp_image *fromLinear16(PixelFormat px_format,
+IFUNC_STATIC_INLINE rp_image *fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0);
-#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 && !IMAGEDECODER_HAS_AVX2 */
 
 #else /* !RP_HAS_IFUNC or not i386/amd64 */
 // System does not support IFUNC, or we aren't guaranteed to have
@@ -295,6 +337,11 @@ static inline rp_image *fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0)
 {
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromLinear16_avx2(px_format, width, height, img_buf, img_siz, stride);
+	}
+#  endif /* IMAGEDECODER_HAS_AVX2 */
 #  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
 	// amd64 always has SSE2.
 	return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
@@ -348,6 +395,24 @@ rp_image *fromLinear24_ssse3(PixelFormat px_format,
 	const uint8_t *RESTRICT img_buf, int img_siz, int stride = 0);
 #endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a linear 24-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 24-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] Image buffer. (must be byte-addressable)
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*3]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 4, 5)
+rp_image *fromLinear24_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
 #if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a linear 24-bit RGB image to rp_image.
@@ -382,6 +447,11 @@ static inline rp_image *fromLinear24(PixelFormat px_format,
 	int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz, int stride = 0)
 {
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromLinear24_avx2(px_format, width, height, img_buf, img_siz, stride);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
 #  ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return fromLinear24_ssse3(px_format, width, height, img_buf, img_siz, stride);
@@ -427,6 +497,23 @@ rp_image *fromLinear32_ssse3(PixelFormat px_format,
 	const uint32_t *RESTRICT img_buf, int img_siz, int stride = 0);
 #endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a linear 32-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 32-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 32-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*4]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear32_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint32_t *RESTRICT img_buf, int img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
 #if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a linear 32-bit RGB image to rp_image.
@@ -459,6 +546,11 @@ static inline rp_image *fromLinear32(PixelFormat px_format,
 	int width, int height,
 	const uint32_t *RESTRICT img_buf, int img_siz, int stride = 0)
 {
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromLinear32_avx2(px_format, width, height, img_buf, img_siz, stride);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
 #  ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return fromLinear32_ssse3(px_format, width, height, img_buf, img_siz, stride);
@@ -470,8 +562,133 @@ static inline rp_image *fromLinear32(PixelFormat px_format,
 }
 #endif /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
 
+/**
+ * Convert a linear 32-bit RGB image to rp_image.
+ *
+ * If the pixel format is PXF_HOST_ARGB32 and the default rp_image
+ * backend is in use, the rp_image will reference the image buffer
+ * directly instead of copying it. Otherwise, this is the same as
+ * the fromLinear32() function that takes a raw image buffer.
+ *
+ * @param px_format	[in] 32-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param buffer	[in] Reference-counted 32-bit image buffer.
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear32(PixelFormat px_format,
+	int width, int height,
+	rp_image_buffer *buffer, int stride = 0);
+
 /** GameCube **/
 
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * Standard version using regular C++ code.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_cpp(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a GameCube CI8 image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf CI8 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 256*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcnCI8_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz);
+
+/**
+ * Convert a GameCube I8 image to rp_image.
+ * NOTE: Uses a grayscale palette.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf I8 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromGcnI8_cpp(int width, int height,
+	const uint8_t *img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * SSSE3-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_ssse3(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a GameCube CI8 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf CI8 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 256*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcnCI8_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz);
+
+/**
+ * Convert a GameCube I8 image to rp_image.
+ * NOTE: Uses a grayscale palette.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf I8 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromGcnI8_ssse3(int width, int height,
+	const uint8_t *img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+
 /**
  * Convert a GameCube 16-bit image to rp_image.
  * @param px_format 16-bit pixel format.
@@ -481,7 +698,7 @@ static inline rp_image *fromLinear32(PixelFormat px_format,
  * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromGcn16(PixelFormat px_format,
+IFUNC_STATIC_INLINE rp_image *fromGcn16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz);
 
@@ -495,7 +712,7 @@ rp_image *fromGcn16(PixelFormat px_format,
  * @param pal_siz Size of palette data. [must be >= 256*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromGcnCI8(int width, int height,
+IFUNC_STATIC_INLINE rp_image *fromGcnCI8(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz,
 	const uint16_t *RESTRICT pal_buf, int pal_siz);
 
@@ -509,9 +726,90 @@ rp_image *fromGcnCI8(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromGcnI8(int width, int height,
+IFUNC_STATIC_INLINE rp_image *fromGcnI8(int width, int height,
 	const uint8_t *img_buf, int img_siz);
 
+#else /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+static inline rp_image *fromGcn16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromGcn16_avx2(px_format, width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromGcn16_ssse3(px_format, width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromGcn16_cpp(px_format, width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert a GameCube CI8 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf CI8 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 256*2]
+ * @return rp_image, or nullptr on error.
+ */
+static inline rp_image *fromGcnCI8(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromGcnCI8_ssse3(width, height, img_buf, img_siz, pal_buf, pal_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromGcnCI8_cpp(width, height, img_buf, img_siz, pal_buf, pal_siz);
+	}
+}
+
+/**
+ * Convert a GameCube I8 image to rp_image.
+ * NOTE: Uses a grayscale palette.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf I8 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromGcnI8(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromGcnI8_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromGcnI8_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+#endif /* RP_HAS_IFUNC && (RP_CPU_I386 || RP_CPU_AMD64) */
+
 /** Nintendo DS **/
 
 /**
@@ -563,6 +861,7 @@ rp_image *fromN3DSTiledRGB565_A4(int width, int height,
  * Convert a GameCube DXT1 image to rp_image.
  * The GameCube variant has 2x2 block tiling in addition to 4x4 pixel tiling.
  * S3TC palette index 3 will be interpreted as fully transparent.
+ * Standard version using regular C++ code.
  *
  * @param width Image width.
  * @param height Image height.
@@ -571,12 +870,13 @@ rp_image *fromN3DSTiledRGB565_A4(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT1_GCN(int width, int height,
+rp_image *fromDXT1_GCN_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
  * Convert a DXT1 image to rp_image.
  * S3TC palette index 3 will be interpreted as black.
+ * Standard version using regular C++ code.
  *
  * @param width Image width.
  * @param height Image height.
@@ -585,12 +885,13 @@ rp_image *fromDXT1_GCN(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT1(int width, int height,
+rp_image *fromDXT1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
  * Convert a DXT1 image to rp_image.
  * S3TC palette index 3 will be interpreted as fully transparent.
+ * Standard version using regular C++ code.
  *
  * @param width Image width.
  * @param height Image height.
@@ -599,23 +900,12 @@ rp_image *fromDXT1(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT1_A1(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
-
-/**
- * Convert a DXT2 image to rp_image.
- * @param width Image width.
- * @param height Image height.
- * @param img_buf DXT2 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)]
- * @return rp_image, or nullptr on error.
- */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT2(int width, int height,
+rp_image *fromDXT1_A1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
  * Convert a DXT3 image to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf DXT3 image buffer.
@@ -623,23 +913,12 @@ rp_image *fromDXT2(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT3(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
-
-/**
- * Convert a DXT4 image to rp_image.
- * @param width Image width.
- * @param height Image height.
- * @param img_buf DXT4 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)]
- * @return rp_image, or nullptr on error.
- */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT4(int width, int height,
+rp_image *fromDXT3_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
  * Convert a DXT5 image to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf DXT5 image buffer.
@@ -647,35 +926,571 @@ rp_image *fromDXT4(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT5(int width, int height,
+rp_image *fromDXT5_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
  * Convert a BC4 (ATI1) image to rp_image.
  * Color component is Red.
+ * Standard version using regular C++ code.
  *
  * @param width Image width.
  * @param height Image height.
  * @param img_buf BC4 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromBC4(int width, int height,
+rp_image *fromBC4_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
  * Convert a BC5 (ATI2) image to rp_image.
  * Color components are Red and Green.
+ * Standard version using regular C++ code.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC5_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a GameCube DXT1 image to rp_image.
+ * The GameCube variant has 2x2 block tiling in addition to 4x4 pixel tiling.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT1_GCN_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT1_A1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT3 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT3_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT5 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC4_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a GameCube DXT1 image to rp_image.
+ * The GameCube variant has 2x2 block tiling in addition to 4x4 pixel tiling.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT1_GCN_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT1_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT1_A1_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT3 image to rp_image.
+ * AVX2-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT3_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT5 image to rp_image.
+ * AVX2-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT5_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC4_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC5_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+/**
+ * Convert a GameCube DXT1 image to rp_image.
+ * The GameCube variant has 2x2 block tiling in addition to 4x4 pixel tiling.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromDXT1_GCN(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromDXT1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromDXT1_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT3 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromDXT3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT5 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromDXT5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromBC4(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromBC5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a GameCube DXT1 image to rp_image.
+ * The GameCube variant has 2x2 block tiling in addition to 4x4 pixel tiling.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromDXT1_GCN(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromDXT1_GCN_avx2(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromDXT1_GCN_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromDXT1_GCN_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromDXT1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromDXT1_avx2(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromDXT1_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromDXT1_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromDXT1_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromDXT1_A1_avx2(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromDXT1_A1_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromDXT1_A1_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert a DXT3 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromDXT3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromDXT3_avx2(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromDXT3_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromDXT3_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert a DXT5 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromDXT5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromDXT5_avx2(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromDXT5_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromDXT5_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
  *
  * @param width Image width.
  * @param height Image height.
  * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromBC4(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromBC4_avx2(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromBC4_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromBC4_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromBC5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromBC5_avx2(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromBC5_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromBC5_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+#endif /* RP_HAS_IFUNC && (RP_CPU_I386 || RP_CPU_AMD64) */
+
+/**
+ * Convert a DXT2 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT2 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT2(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT4 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT4 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromBC5(int width, int height,
+rp_image *fromDXT4(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
@@ -696,6 +1511,96 @@ int fromRed8ToL8(rp_image *img);
 
 /* Dreamcast */
 
+/**
+ * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * Standard version using a twiddle map lookup table.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf 16-bit image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDreamcastSquareTwiddled16_cpp(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a Dreamcast vector-quantized image to rp_image.
+ * Standard version using a twiddle map lookup table.
+ * @param px_format Palette pixel format.
+ * @param smallVQ If true, handle this image as SmallVQ.
+ * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf VQ image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 1024*2; for SmallVQ, 64*2, 256*2, or 512*2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 6, 7)
+rp_image *fromDreamcastVQ16_cpp(PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz);
+
+#ifdef IMAGEDECODER_HAS_SSE2
+/**
+ * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * SSE2-optimized version. (Morton order)
+ * @param px_format 16-bit pixel format.
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf 16-bit image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDreamcastSquareTwiddled16_sse2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a Dreamcast vector-quantized image to rp_image.
+ * SSE2-optimized version. (Morton order)
+ * @param px_format Palette pixel format.
+ * @param smallVQ If true, handle this image as SmallVQ.
+ * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf VQ image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 1024*2; for SmallVQ, 64*2, 256*2, or 512*2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 6, 7)
+rp_image *fromDreamcastVQ16_sse2(PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz);
+#endif /* IMAGEDECODER_HAS_SSE2 */
+
+#ifdef IMAGEDECODER_HAS_BMI2
+/**
+ * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * SSE2+BMI2-optimized version. (Morton order, using PDEP)
+ * @param px_format 16-bit pixel format.
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf 16-bit image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDreamcastSquareTwiddled16_bmi2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_BMI2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+
 /**
  * Convert a Dreamcast square twiddled 16-bit image to rp_image.
  * @param px_format 16-bit pixel format.
@@ -705,7 +1610,7 @@ int fromRed8ToL8(rp_image *img);
  * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
+IFUNC_STATIC_INLINE rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz);
 
@@ -723,11 +1628,77 @@ rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 6, 7)
-rp_image *fromDreamcastVQ16(PixelFormat px_format,
+IFUNC_STATIC_INLINE rp_image *fromDreamcastVQ16(PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz);
+
+#else /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf 16-bit image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+static inline rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_BMI2
+	if (RP_CPU_HasSSE2() && RP_CPU_HasBMI2()) {
+		return fromDreamcastSquareTwiddled16_bmi2(px_format, width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_BMI2 */
+#  ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return fromDreamcastSquareTwiddled16_sse2(px_format, width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return fromDreamcastSquareTwiddled16_cpp(px_format, width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert a Dreamcast vector-quantized image to rp_image.
+ * @param px_format Palette pixel format.
+ * @param smallVQ If true, handle this image as SmallVQ.
+ * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf VQ image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 1024*2; for SmallVQ, 64*2, 256*2, or 512*2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 6, 7)
+static inline rp_image *fromDreamcastVQ16(PixelFormat px_format,
 	bool smallVQ, bool hasMipmaps,
 	int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz,
-	const uint16_t *RESTRICT pal_buf, int pal_siz);
+	const uint16_t *RESTRICT pal_buf, int pal_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return fromDreamcastVQ16_sse2(px_format, smallVQ, hasMipmaps,
+			width, height, img_buf, img_siz, pal_buf, pal_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return fromDreamcastVQ16_cpp(px_format, smallVQ, hasMipmaps,
+			width, height, img_buf, img_siz, pal_buf, pal_siz);
+	}
+}
+
+#endif /* RP_HAS_IFUNC && (RP_CPU_I386 || RP_CPU_AMD64) */
 
 /**
  * Get the number of palette entries for Dreamcast SmallVQ textures.
@@ -771,6 +1742,113 @@ static inline int calcDreamcastSmallVQPaletteEntries_WithMipmaps(int width)
 
 /* ETC1 */
 
+/**
+ * Convert an ETC1 image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC1_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGB image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC2_RGB_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGBA image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGBA image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC2_RGBA_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB+A1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC2_RGB_A1_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSE41
+/**
+ * Convert an ETC1 image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC1_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGB image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC2_RGB_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGBA image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGBA image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC2_RGBA_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB+A1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC2_RGB_A1_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSE41 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert an ETC1 image to rp_image.
  * @param width Image width.
@@ -780,7 +1858,7 @@ static inline int calcDreamcastSmallVQPaletteEntries_WithMipmaps(int width)
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromETC1(int width, int height,
+IFUNC_STATIC_INLINE rp_image *fromETC1(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
@@ -792,7 +1870,7 @@ rp_image *fromETC1(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromETC2_RGB(int width, int height,
+IFUNC_STATIC_INLINE rp_image *fromETC2_RGB(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
@@ -804,7 +1882,7 @@ rp_image *fromETC2_RGB(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromETC2_RGBA(int width, int height,
+IFUNC_STATIC_INLINE rp_image *fromETC2_RGBA(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
@@ -816,9 +1894,103 @@ rp_image *fromETC2_RGBA(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromETC2_RGB_A1(int width, int height,
+IFUNC_STATIC_INLINE rp_image *fromETC2_RGB_A1(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert an ETC1 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromETC1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return fromETC1_sse41(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return fromETC1_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert an ETC2 RGB image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromETC2_RGB(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return fromETC2_RGB_sse41(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return fromETC2_RGB_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert an ETC2 RGBA image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGBA image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromETC2_RGBA(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return fromETC2_RGBA_sse41(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return fromETC2_RGBA_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB+A1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromETC2_RGB_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return fromETC2_RGB_A1_sse41(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return fromETC2_RGB_A1_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+#endif /* RP_HAS_IFUNC && (RP_CPU_I386 || RP_CPU_AMD64) */
+
 #ifdef ENABLE_PVRTC
 /* PVRTC */
 
@@ -865,6 +2037,65 @@ rp_image *fromPVRTCII(int width, int height,
 
 /* BC7 */
 
+/**
+ * Convert a BC7 image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC7_cpp(int width, int height,
+	const uint8_t *img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a BC7 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC7_ssse3(int width, int height,
+	const uint8_t *img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_SSE41
+/**
+ * Convert a BC7 image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC7_sse41(int width, int height,
+	const uint8_t *img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSE41 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a BC7 image to rp_image.
+ * AVX2-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC7_avx2(int width, int height,
+	const uint8_t *img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a BC7 image to rp_image.
  * @param width Image width.
@@ -874,8 +2105,94 @@ rp_image *fromPVRTCII(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromBC7(int width, int height,
+IFUNC_STATIC_INLINE rp_image *fromBC7(int width, int height,
 	const uint8_t *img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a BC7 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromBC7(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromBC7_avx2(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return fromBC7_sse41(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSE41 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromBC7_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromBC7_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* RP_HAS_IFUNC && (RP_CPU_I386 || RP_CPU_AMD64) */
+
+/** Region of interest **/
+
+/**
+ * 4x4 block-compressed formats supported by fromBlocks_ROI().
+ * NOTE: PVRTC isn't supported, since each PVRTC block
+ * depends on its neighboring blocks.
+ */
+enum BlockFormat {
+	BLKF_DXT1,		// fromDXT1()
+	BLKF_DXT1_A1,		// fromDXT1_A1()
+	BLKF_DXT2,		// fromDXT2()
+	BLKF_DXT3,		// fromDXT3()
+	BLKF_DXT4,		// fromDXT4()
+	BLKF_DXT5,		// fromDXT5()
+	BLKF_BC4,		// fromBC4()
+	BLKF_BC5,		// fromBC5()
+	BLKF_BC7,		// fromBC7()
+	BLKF_ETC1,		// fromETC1()
+	BLKF_ETC2_RGB,		// fromETC2_RGB()
+	BLKF_ETC2_RGB_A1,	// fromETC2_RGB_A1()
+	BLKF_ETC2_RGBA,		// fromETC2_RGBA()
+
+	BLKF_MAX
+};
+
+/**
+ * Decode a region of a 4x4 block-compressed image.
+ * Only the tiles that cover the region are decoded, so this
+ * is much faster than decoding the full image and cropping it.
+ *
+ * The region must be entirely within the image.
+ * If the region covers the full image, this is the same as
+ * calling the format's regular decoding function.
+ *
+ * @param blkfmt Block format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf Image buffer.
+ * @param img_siz Size of image data.
+ * @param x Region X position.
+ * @param y Region Y position.
+ * @param roi_width Region width.
+ * @param roi_height Region height.
+ * @return rp_image containing only the region, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 4, 5)
+rp_image *fromBlocks_ROI(BlockFormat blkfmt, int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	int x, int y, int roi_width, int roi_height);
 
 } }
 
@@ -11,17 +11,23 @@
 #include "ImageDecoder.hpp"
 #include "ImageDecoder_p.hpp"
 
+// One-time initialization.
+#include "librpthreads/pthread_once.h"
+
 // References:
 // - https://msdn.microsoft.com/en-us/library/windows/desktop/hh308953(v=vs.85).aspx
 // - https://msdn.microsoft.com/en-us/library/windows/desktop/hh308954(v=vs.85).aspx
 
-namespace LibRpTexture { namespace ImageDecoder {
+namespace LibRpTexture {
 
 // Interpolation values.
 static const uint8_t aWeight2[] = {0, 21, 43, 64};
 static const uint8_t aWeight3[] = {0, 9, 18, 27, 37, 46, 55, 64};
 static const uint8_t aWeight4[] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
 
+// Interpolation values, indexed by index precision.
+static const uint8_t *const aWeights[5] = {nullptr, nullptr, aWeight2, aWeight3, aWeight4};
+
 /** Partition definitions. **/
 
 // Each 32-bit value defines a partition with 2 or 3 subsets.
@@ -74,47 +80,6 @@ static const uint32_t bc7_3sub[64] = {
 	0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254
 };
 
-/**
- * Interpolate a color component.
- * @tparam bits Index precision, in number of bits.
- * @param index Color/alpha index.
- * @param e0 Endpoint 0 component.
- * @param e1 Endpoint 1 component.
- * @return Interpolated color component.
- */
-static uint8_t interpolate_component(unsigned int bits, unsigned int index, uint8_t e0, uint8_t e1)
-{
-	assert(bits >= 2 && bits <= 4);
-	assert(index < (1U << bits));
-
-	// Shortcut for no-interpolation cases.
-	// TODO: Does this actually improve performance?
-	if (index == 0) {
-		return e0;
-	} else if (index == (1U<<bits)-1) {
-		return e1;
-	}
-
-	uint8_t weight;
-	switch (bits) {
-		case 2:
-			weight = aWeight2[index];
-			break;
-		case 3:
-			weight = aWeight3[index];
-			break;
-		case 4:
-			weight = aWeight4[index];
-			break;
-		default:
-			// Should not happen...
-			return 0;
-	}
-
-	return (uint8_t)((((64 - weight) * (unsigned int)e0) +
-			       ((weight  * (unsigned int)e1) + 32)) >> 6);
-}
-
 /**
  * Get the mode number.
  * @param dword0 LSB DWORD.
@@ -237,15 +202,526 @@ static FORCEINLINE void rshift128(uint64_t &msb, uint64_t &lsb, unsigned int sha
 	msb >>= shamt;
 }
 
+/**
+ * Decode the parameters of a BC7 block.
+ * @param blk		[out] Decoded block parameters.
+ * @param bc7_src	[in] BC7 block. (128-bit little-endian)
+ * @return 0 on success; non-zero if the block mode is invalid.
+ */
+int ImageDecoderPrivate::BC7_decodeBlock(bc7_block_t *RESTRICT blk, const uint64_t *RESTRICT bc7_src)
+{
+	// Endpoints.
+	// - [8]: Individual endpoints.
+	// - [4]: RGBx components. (idx3 is unused)
+	// NOTE: Endpoints 6 and 7 are never used.
+	// They're kept here because the subset index is 2-bit.
+	union {
+		uint8_t   u8[8][4];
+		uint32_t u32[8];
+	} endpoints;
+
+	// Alpha components.
+	// If no alpha is present, this will be 255.
+	// For modes with alpha components, there is always
+	// one alpha channel per endpoint.
+	uint8_t alpha[6];
+
+	// TODO: Make sure this is correct on big-endian.
+	uint64_t lsb = le64_to_cpu(bc7_src[0]);
+	uint64_t msb = le64_to_cpu(bc7_src[1]);
+
+	// Check the block mode.
+	const int mode = get_mode(static_cast<uint32_t>(lsb));
+	if (mode < 0) {
+		// Invalid mode.
+		return -1;
+	}
+	rshift128(msb, lsb, mode+1);
+
+	// Rotation mode.
+	// Only present in modes 4 and 5.
+	// For all other modes, this is assumed to be 00.
+	// - 00: ARGB - no swapping
+	// - 01: RAGB - swap A and R
+	// - 10: GRAB - swap A and G
+	// - 11: BRGA - swap A and B
+	if (mode == 4 || mode == 5) {
+		blk->rotation_mode = lsb & 3;
+		rshift128(msb, lsb, 2);
+	} else {
+		// No rotation.
+		blk->rotation_mode = 0;
+	}
+
+	// Index mode selector. (Mode 4 only)
+	uint8_t idxMode_m4 = 0;
+	if (mode == 4) {
+		// Mode 4 has both 2-bit and 3-bit selectors.
+		// The index selection bit determines which is used for
+		// color data and which is used for alpha data:
+		// - idxMode_m4 == 0: Color == 2-bit, Alpha == 3-bit
+		// - idxMode_m4 == 1: Color == 3-bit, Alpha == 2-bit
+		idxMode_m4 = lsb & 1;
+		rshift128(msb, lsb, 1);
+	}
+
+	// Subset/partition.
+	static const uint8_t SubsetCount[8] = {3, 2, 3, 2, 1, 1, 1, 2};
+	static const uint8_t PartitionBits[8] = {4, 6, 6, 6, 0, 0, 0, 6};
+	uint32_t subset = 0;
+	uint8_t partition = 0;
+	if (PartitionBits[mode] != 0) {
+		partition = lsb & ((1U << PartitionBits[mode]) - 1);
+		rshift128(msb, lsb, PartitionBits[mode]);
+
+		// Determine the subset to use.
+		switch (SubsetCount[mode]) {
+			default:
+			case 1:
+				// One subset.
+				subset = 0;
+				break;
+			case 2:
+				// Two subsets.
+				subset = bc7_2sub[partition];
+				break;
+			case 3:
+				// Three subsets.
+				subset = bc7_3sub[partition];
+				break;
+		}
+	} else {
+		// No subsets/partitions.
+		subset = 0;
+	}
+
+	// Number of endpoints.
+	static const uint8_t EndpointCount[8] = {6, 4, 6, 4, 2, 2, 2, 4};
+	// Bits per endpoint component.
+	static const uint8_t EndpointBits[8] = {4, 6, 5, 7, 5, 7, 7, 5};
+
+	// Extract and extend the components.
+	// NOTE: Components are stored in RRRR/GGGG/BBBB/AAAA order.
+	// Needs to be shuffled for RGBA.
+	uint8_t endpoint_bits = EndpointBits[mode];
+	const uint8_t endpoint_count = EndpointCount[mode];
+	const uint8_t endpoint_mask = (1U << endpoint_bits) - 1;
+	const uint8_t endpoint_shamt = 8U - endpoint_bits;
+	const unsigned int component_count = endpoint_count * 3;
+	uint8_t ep_idx = 0, comp_idx = 0;
+	for (unsigned int i = 0; i < component_count; i++) {
+		endpoints.u8[ep_idx][comp_idx] = (lsb & endpoint_mask) << endpoint_shamt;
+		ep_idx++;
+		if (ep_idx == endpoint_count) {
+			// Next component.
+			comp_idx++;
+			ep_idx = 0;
+		}
+
+		// Shift the data over.
+		rshift128(msb, lsb, endpoint_bits);
+	}
+
+	// Do we have alpha components?
+	static const uint8_t AlphaBits[8] = {0, 0, 0, 0, 6, 8, 7, 5};
+	uint8_t alpha_bits = AlphaBits[mode];
+	if (alpha_bits != 0) {
+		// We have alpha components.
+		// TODO: Might not actually be alpha if rotation is enabled...
+		// TODO: Or, rotation might enable alpha...
+		const uint8_t alpha_mask = (1U << alpha_bits) - 1;
+		const uint8_t alpha_shamt = 8U - alpha_bits;
+		for (unsigned int i = 0; i < endpoint_count; i++) {
+			alpha[i] = (lsb & alpha_mask) << alpha_shamt;
+			rshift128(msb, lsb, alpha_bits);
+		}
+	} else {
+		// No alpha. Use 255.
+		memset(alpha, 255, sizeof(alpha));
+	}
+
+	// P-bits.
+	// NOTE: These are applied per subset.
+	// The P-bit count is needed here in order to determine the
+	// shift amount for the endpoints and alpha values.
+	static const uint8_t PBitCount[8] = {1, 1, 0, 1, 0, 0, 1, 1};
+	if (PBitCount[mode] != 0) {
+		// Optimization to avoid having to shift the
+		// whole 64-bit and/or 128-bit value multiple times.
+		unsigned int lsb8 = (lsb & 0xFF);
+		if (mode == 1) {
+			// Mode 1: Two P-bits for four endpoints.
+
+			// Subset 0
+			if (lsb & 1) {
+				endpoints.u32[0] |= 0x02020202;
+				endpoints.u32[1] |= 0x02020202;
+			}
+
+			// Subset 1
+			if (lsb & 2) {
+				endpoints.u32[2] |= 0x02020202;
+				endpoints.u32[3] |= 0x02020202;
+			}
+
+			rshift128(msb, lsb, 2);
+		} else {
+			// Other modes: Unique P-bit for each endpoint.
+			const uint8_t p_ep_shamt = 7 - endpoint_bits;
+			for (unsigned int i = 0; i < endpoint_count; i++, lsb8 >>= 1) {
+				if (lsb8 & 1) {
+					endpoints.u32[i] |= (0x01010101 << p_ep_shamt);
+				}
+			}
+
+			if (alpha_bits > 0) {
+				// Apply P-bits to the alpha components.
+				assert(endpoint_count <= ARRAY_SIZE(alpha));
+				const uint8_t p_a_shamt = 7 - alpha_bits;
+				lsb8 = (lsb & 0xFF);
+				for (unsigned int i = 0; i < endpoint_count; i++, lsb8 >>= 1) {
+					alpha[i] |= (lsb8 & 1) << p_a_shamt;
+				}
+
+				// Increment the alpha bits to indicate how many bits
+				// need to be copied when expanding the color value.
+				alpha_bits++;
+			}
+
+			rshift128(msb, lsb, endpoint_count);
+		}
+
+		// Increment the endpoint bits to indicate how many bits
+		// need to be copied when expanding the color value.
+		endpoint_bits++;
+	}
+
+	// Expand the endpoints and alpha components.
+	if (endpoint_bits < 8) {
+		for (unsigned int i = 0; i < endpoint_count; i++) {
+			endpoints.u8[i][0] = endpoints.u8[i][0] | (endpoints.u8[i][0] >> endpoint_bits);
+			endpoints.u8[i][1] = endpoints.u8[i][1] | (endpoints.u8[i][1] >> endpoint_bits);
+			endpoints.u8[i][2] = endpoints.u8[i][2] | (endpoints.u8[i][2] >> endpoint_bits);
+		}
+	}
+	if (alpha_bits != 0 && alpha_bits < 8) {
+		for (unsigned int i = 0; i < endpoint_count; i++) {
+			alpha[i] = alpha[i] | (alpha[i] >> alpha_bits);
+		}
+	}
+
+	// Save the endpoints in argb32_t order.
+	for (unsigned int i = 0; i < endpoint_count; i++) {
+		argb32_t &ep = blk->endpoints[i & 1][i >> 1];
+		ep.r = endpoints.u8[i][0];
+		ep.g = endpoints.u8[i][1];
+		ep.b = endpoints.u8[i][2];
+		ep.a = alpha[i];
+	}
+	for (unsigned int i = endpoint_count; i < 8; i++) {
+		blk->endpoints[i & 1][i >> 1].u32 = 0;
+	}
+
+	// Bits per index. (either 2 or 3)
+	// NOTE: Most modes don't have the full 32-bit or 48-bit
+	// index table. Missing bits are assumed to be 0.
+	static const uint8_t IndexBits[8] = {3, 3, 2, 2, 0, 2, 4, 2};
+	unsigned int index_bits = IndexBits[mode];
+
+	// At this point, the only remaining data is indexes,
+	// which fits entirely into LSB. Hence, we can stop
+	// using rshift128().
+
+	// EXCEPTION: Mode 4 has both 2-bit *and* 3-bit indexes.
+	// Depending on idxMode_m4, we have to use one or the other.
+	uint64_t idxData;
+	uint8_t index_mask;
+	if (mode == 4) {
+		// Load the color indexes.
+		if (idxMode_m4) {
+			// idxMode is set: Color data uses the 3-bit indexes.
+			// NOTE: We've already shifted by 50 bits by now, so the
+			// MSB contains the high 14 bits of the index data, and
+			// the LSB contains the low 33 bits of the index data.
+			idxData = (msb << 33) | (lsb >> 31);
+			index_bits = 3;
+			index_mask = (1U << 3) - 1;
+		} else {
+			// idxMode is not set: Color data uses the 2-bit indexes.
+			idxData = lsb & ((1U << 31) - 1);
+			index_bits = 2;
+			index_mask = (1U << 2) - 1;
+		}
+	} else {
+		// Use the LSB indexes as-is.
+		idxData = lsb;
+		index_mask = (1U << index_bits) - 1;
+	}
+
+	// Get the anchor indexes.
+	// Subset 0 is always anchored at 0.
+	// Other subsets depend on subset count and partition number.
+	// NOTE: Index 3 is invalid. It's present here for alignment
+	// and because the subset index is 2-bit.
+	uint8_t anchor_index[4] = {0, 0, 0, 0};
+	const uint8_t subset_count = SubsetCount[mode];
+	for (unsigned int i = 1; i < subset_count; i++) {
+		anchor_index[i] = getAnchorIndex(partition, i, subset_count);
+	}
+
+	// Process the index data for the color components.
+	const uint8_t *pWeight = aWeights[index_bits];
+	uint32_t subsetData = subset;
+	for (unsigned int i = 0; i < 16; i++, subsetData >>= 2) {
+		const uint8_t subset_idx = subsetData & 3;
+		assert(subset_idx != 3);
+		uint8_t data_idx;
+		if (i == anchor_index[subset_idx]) {
+			// This is an anchor index.
+			// Highest bit is 0.
+			data_idx = idxData & (index_mask >> 1);
+			idxData >>= (index_bits - 1);
+		} else {
+			// Regular index.
+			data_idx = idxData & index_mask;
+			idxData >>= index_bits;
+		}
+
+		blk->subset[i] = subset_idx;
+		blk->colorWeight[i] = pWeight[data_idx];
+	}
+
+	// Alpha handling.
+	if (mode == 4) {
+		// Mode 4: Alpha indexes are present.
+		// Load the appropriate indexes based on idxMode.
+		uint8_t index_bits, index_mask;
+		if (idxMode_m4) {
+			// idxMode is set: Alpha data uses the 2-bit indexes.
+			idxData = lsb & ((1U << 31) - 1);
+			index_bits = 2;
+			index_mask = (1U << 2) - 1;
+		} else {
+			// idxMode is not set: Alpha data uses the 3-bit indexes.
+			// NOTE: We've already shifted by 50 bits by now, so the
+			// MSB contains the high 14 bits of the index data, and
+			// the LSB contains the low 33 bits of the index data.
+			idxData = (msb << 33) | (lsb >> 31);
+			index_bits = 3;
+			index_mask = (1U << 3) - 1;
+		}
+
+		// NOTE: Mode 4 only has one subset.
+		pWeight = aWeights[index_bits];
+		for (unsigned int i = 0; i < 16; i++) {
+			uint8_t data_idx;
+			if (i == 0) {
+				// This is an anchor index.
+				// Highest bit is 0.
+				data_idx = idxData & (index_mask >> 1);
+				idxData >>= (index_bits - 1);
+			} else {
+				// Regular index.
+				data_idx = idxData & index_mask;
+				idxData >>= index_bits;
+			}
+
+			blk->alphaWeight[i] = pWeight[data_idx];
+		}
+	} else if (mode == 5) {
+		// Mode 5: Separate alpha indexes, stored after the color indexes.
+		// NOTE: Mode 5 only has one subset.
+		idxData = lsb >> 31;
+		for (unsigned int i = 0; i < 16; i++) {
+			uint8_t data_idx;
+			if (i == 0) {
+				// This is an anchor index.
+				// Highest bit is 0.
+				data_idx = idxData & (index_mask >> 1);
+				idxData >>= (index_bits - 1);
+			} else {
+				// Regular index.
+				data_idx = idxData & index_mask;
+				idxData >>= index_bits;
+			}
+
+			blk->alphaWeight[i] = pWeight[data_idx];
+		}
+	} else {
+		// Other modes: Same indexes as color data.
+		// If there's no alpha, the alpha endpoints are both 255,
+		// so the weights don't matter.
+		memcpy(blk->alphaWeight, blk->colorWeight, sizeof(blk->alphaWeight));
+	}
+
+	return 0;
+}
+
+/** SIMD decoder parameters **/
+
+// Partition parameters.
+// - [0]: Single-subset modes. (only partition 0 is used)
+// - [1]: 2-subset modes.
+// - [2]: 3-subset modes.
+static ImageDecoderPrivate::bc7_partition_t bc7_partitions[3][64];
+
+// Per-mode parameters.
+static ImageDecoderPrivate::bc7_mode_params_t bc7_mode_params[8];
+
+// pthread_once() control variable.
+static pthread_once_t bc7_once_control = PTHREAD_ONCE_INIT;
+
+/**
+ * Initialize the BC7 SIMD decoder parameters.
+ * This initializes bc7_partitions[] and bc7_mode_params[].
+ *
+ * This function MUST be called using pthread_once().
+ */
+static void initBC7ModeParams(void)
+{
+	// Mode layout.
+	// NOTE: Shared P-bits (mode 1) apply to both endpoints in a subset.
+	static const struct {
+		uint8_t subsets;	// Number of subsets.
+		uint8_t partBits;	// Partition number bits.
+		uint8_t extraBits;	// Rotation and index selection bits.
+		uint8_t colorBits;	// Bits per color component.
+		uint8_t alphaBits;	// Bits per alpha component.
+		uint8_t pbits;		// 0 == none; 1 == per endpoint; 2 == shared
+		uint8_t idxBits;	// Index 1 bits.
+		uint8_t idx2Bits;	// Index 2 bits.
+	} modeInfo[8] = {
+		{3, 4, 0, 4, 0, 1, 3, 0},
+		{2, 6, 0, 6, 0, 2, 3, 0},
+		{3, 6, 0, 5, 0, 0, 2, 0},
+		{2, 6, 0, 7, 0, 1, 2, 0},
+		{1, 0, 3, 5, 6, 0, 2, 3},
+		{1, 0, 2, 7, 8, 0, 2, 2},
+		{1, 0, 0, 7, 7, 1, 4, 0},
+		{2, 6, 0, 5, 5, 1, 2, 0},
+	};
+
+	// Partition parameters.
+	for (unsigned int sc = 1; sc <= 3; sc++) {
+		for (unsigned int p = 0; p < 64; p++) {
+			ImageDecoderPrivate::bc7_partition_t &part = bc7_partitions[sc - 1][p];
+			uint8_t anchor_index[4] = {0, 0, 0, 0};
+			for (unsigned int s = 1; s < sc; s++) {
+				anchor_index[s] = getAnchorIndex(p, s, sc);
+			}
+
+			uint32_t subsetData = (sc == 1 ? 0 : (sc == 2 ? bc7_2sub[p] : bc7_3sub[p]));
+			uint8_t anchors = 0;
+			for (unsigned int i = 0; i < 16; i++, subsetData >>= 2) {
+				const uint8_t subset_idx = subsetData & 3;
+				part.subset[i] = subset_idx;
+				part.anchorsBefore[i] = static_cast<uint8_t>(-anchors);
+				if (i == anchor_index[subset_idx]) {
+					part.anchor[i] = 0xFF;
+					anchors++;
+				} else {
+					part.anchor[i] = 0;
+				}
+			}
+		}
+	}
+
+	for (unsigned int mode = 0; mode < 8; mode++) {
+		const auto &mi = modeInfo[mode];
+		ImageDecoderPrivate::bc7_mode_params_t &mp = bc7_mode_params[mode];
+		memset(&mp, 0, sizeof(mp));
+		memset(mp.compShuf, 0x80, sizeof(mp.compShuf));
+		memset(mp.pbitShuf, 0x80, sizeof(mp.pbitShuf));
+		memset(mp.epShuf, 0x80, sizeof(mp.epShuf));
+
+		unsigned int bit = mode + 1 + mi.extraBits;
+		mp.partitionShift = bit;
+		mp.partitionMask = (1U << mi.partBits) - 1;
+		mp.partitions = bc7_partitions[mi.subsets - 1];
+		bit += mi.partBits;
+
+		// Endpoint components.
+		const unsigned int epCount = mi.subsets * 2;
+		const unsigned int compCount = epCount * (mi.alphaBits != 0 ? 4 : 3);
+		const unsigned int pbitStart = bit + (epCount * 3 * mi.colorBits) + (epCount * mi.alphaBits);
+		for (unsigned int lane = 0; lane < compCount; lane++) {
+			const unsigned int c = lane / epCount;	// 0 == R, 1 == G, 2 == B, 3 == A
+			const unsigned int ep = lane % epCount;
+			const unsigned int bits = (c < 3 ? mi.colorBits : mi.alphaBits);
+			const unsigned int v = lane / 8, l = lane % 8;
+
+			mp.compShuf[v][l*2] = bit >> 3;
+			mp.compShuf[v][l*2+1] = (bit >> 3) + 1;
+			mp.compMul[v][l] = 1U << (8 - (bit & 7));
+			mp.compMask[v][l] = (1U << bits) - 1;
+			mp.compScale[v][l] = 1U << (8 - bits);
+			bit += bits;
+
+			unsigned int expBits = bits;
+			if (mi.pbits != 0) {
+				const unsigned int pbit = pbitStart + (mi.pbits == 2 ? (ep >> 1) : ep);
+				mp.pbitShuf[v][l*2] = pbit >> 3;
+				mp.pbitShuf[v][l*2+1] = (pbit >> 3) + 1;
+				mp.pbitMul[v][l] = 1U << (8 - (pbit & 7));
+				mp.pbitMask[v][l] = 1;
+				mp.pbitScale[v][l] = 1U << (7 - bits);
+				expBits++;
+			}
+			mp.expandMul[v][l] = (expBits < 8 ? (1U << (16 - expBits)) : 0);
+
+			// Destination byte in bc7_block_t::endpoints[ep & 1][ep >> 1].
+			static const uint8_t compByte[4] = {2, 1, 0, 3};
+			mp.epShuf[ep & 1][lane / 16][((ep >> 1) * 4) + compByte[c]] = lane % 16;
+		}
+		if (mi.alphaBits == 0) {
+			// No alpha components. Use 255.
+			for (unsigned int ep = 0; ep < epCount; ep++) {
+				mp.epConst[ep & 1][((ep >> 1) * 4) + 3] = 0xFF;
+			}
+		}
+
+		// Indexes.
+		bit = pbitStart + (mi.pbits == 2 ? mi.subsets : (mi.pbits * epCount));
+		const uint8_t idxBits[2] = {mi.idxBits, mi.idx2Bits};
+		for (unsigned int n = 0; n < 2 && idxBits[n] != 0; n++) {
+			const unsigned int b = idxBits[n];
+			for (unsigned int i = 0; i < 16; i++) {
+				mp.idxBase[n][i] = bit + (i * b);
+			}
+			memcpy(mp.idxWeights[n], aWeights[b], 1U << b);
+			mp.idxMask[n] = (1U << b) - 1;
+			mp.idxAnchorBit[n] = 1U << (b - 1);
+			// Each subset's anchor index drops its MSB.
+			// (Only single-subset modes have a second index set.)
+			bit += (16 * b) - mi.subsets;
+		}
+		assert(bit == 128);
+	}
+}
+
+/**
+ * Get the BC7 per-mode parameters for the SIMD decoders.
+ * @return Mode parameters, indexed by mode number.
+ */
+const ImageDecoderPrivate::bc7_mode_params_t *ImageDecoderPrivate::BC7_getModeParams(void)
+{
+	pthread_once(&bc7_once_control, initBC7ModeParams);
+	return bc7_mode_params;
+}
+
+namespace ImageDecoder {
+
 /**
  * Convert a BC7 image to rp_image.
+ * Standard version using regular C++ code.
+ * Single-threaded version. (See decodeBlocks_mt().)
  * @param width Image width.
  * @param height Image height.
  * @param img_buf BC7 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromBC7(int width, int height,
+static rp_image *fromBC7_st(int width, int height,
 	const uint8_t *img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -271,7 +747,7 @@ rp_image *fromBC7(int width, int height,
 	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
 
 	// Create an rp_image.
-	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
 	if (!img->isValid()) {
 		// Could not allocate the image.
 		img->unref();
@@ -288,370 +764,34 @@ rp_image *fromBC7(int width, int height,
 	// block format we have is 128-bit little-endian, which will be
 	// represented as two uint64_t values, which will be shifted
 	// as each component is processed.
-	// TODO: Optimize by using fewer shifts?
 	const uint64_t *bc7_src = reinterpret_cast<const uint64_t*>(img_buf);
 
 	// Temporary tile buffer.
 	ALIGNED_VAR(16, argb32_t tileBuf[4*4]);
 
-	// Anchor indexes.
-	// Subset 0 is always anchored at 0.
-	// Other subsets depend on subset count and partition number.
-	// NOTE: Index 3 is invalid. It's present here for alignment
-	// and because the subset index is 2-bit.
-	uint8_t anchor_index[4];
-	anchor_index[0] = 0;
-
 	for (unsigned int y = 0; y < tilesY; y++) {
 	for (unsigned int x = 0; x < tilesX; x++, bc7_src += 2) {
-		/** BEGIN: Temporary values. **/
-
-		// Endpoints.
-		// - [8]: Individual endpoints.
-		// - [4]: RGBx components. (idx3 is unused)
-		// NOTE: Endpoints 6 and 7 are never used.
-		// They're kept here because the subset index is 2-bit.
-		union {
-			uint8_t   u8[8][4];
-			uint32_t u32[8];
-		} endpoints;
-
-		// Alpha components.
-		// If no alpha is present, this will be 255.
-		// For modes with alpha components, there is always
-		// one alpha channel per endpoint.
-		uint8_t alpha[4];
-
-		/** END: Temporary values. **/
-
-		// TODO: Make sure this is correct on big-endian.
-		uint64_t lsb = le64_to_cpu(bc7_src[0]);
-		uint64_t msb = le64_to_cpu(bc7_src[1]);
-
-		// Check the block mode.
-		const int mode = get_mode(static_cast<uint32_t>(lsb));
-		if (mode < 0) {
+		ImageDecoderPrivate::bc7_block_t blk;
+		if (ImageDecoderPrivate::BC7_decodeBlock(&blk, bc7_src) != 0) {
 			// Invalid mode.
 			img->unref();
 			return nullptr;
 		}
-		rshift128(msb, lsb, mode+1);
-
-		// Rotation mode.
-		// Only present in modes 4 and 5.
-		// For all other modes, this is assumed to be 00.
-		// - 00: ARGB - no swapping
-		// - 01: RAGB - swap A and R
-		// - 10: GRAB - swap A and G
-		// - 11: BRGA - swap A and B
-		uint8_t rotation_mode;
-		if (mode == 4 || mode == 5) {
-			rotation_mode = lsb & 3;
-			rshift128(msb, lsb, 2);
-		} else {
-			// No rotation.
-			rotation_mode = 0;
-		}
-
-		// Index mode selector. (Mode 4 only)
-		uint8_t idxMode_m4 = 0;
-		if (mode == 4) {
-			// Mode 4 has both 2-bit and 3-bit selectors.
-			// The index selection bit determines which is used for
-			// color data and which is used for alpha data:
-			// - idxMode_m4 == 0: Color == 2-bit, Alpha == 3-bit
-			// - idxMode_m4 == 1: Color == 3-bit, Alpha == 2-bit
-			idxMode_m4 = lsb & 1;
-			rshift128(msb, lsb, 1);
-		}
-
-		// Subset/partition.
-		static const uint8_t SubsetCount[8] = {3, 2, 3, 2, 1, 1, 1, 2};
-		static const uint8_t PartitionBits[8] = {4, 6, 6, 6, 0, 0, 0, 6};
-		uint32_t subset = 0;
-		uint8_t partition = 0;
-		if (PartitionBits[mode] != 0) {
-			partition = lsb & ((1U << PartitionBits[mode]) - 1);
-			rshift128(msb, lsb, PartitionBits[mode]);
-
-			// Determine the subset to use.
-			switch (SubsetCount[mode]) {
-				default:
-				case 1:
-					// One subset.
-					subset = 0;
-					break;
-				case 2:
-					// Two subsets.
-					subset = bc7_2sub[partition];
-					break;
-				case 3:
-					// Three subsets.
-					subset = bc7_3sub[partition];
-					break;
-			}
-		} else {
-			// No subsets/partitions.
-			subset = 0;
-		}
-
-		// Number of endpoints.
-		static const uint8_t EndpointCount[8] = {6, 4, 6, 4, 2, 2, 2, 4};
-		// Bits per endpoint component.
-		static const uint8_t EndpointBits[8] = {4, 6, 5, 7, 5, 7, 7, 5};
-
-		// Extract and extend the components.
-		// NOTE: Components are stored in RRRR/GGGG/BBBB/AAAA order.
-		// Needs to be shuffled for RGBA.
-		uint8_t endpoint_bits = EndpointBits[mode];
-		const uint8_t endpoint_count = EndpointCount[mode];
-		const uint8_t endpoint_mask = (1U << endpoint_bits) - 1;
-		const uint8_t endpoint_shamt = 8U - endpoint_bits;
-		const unsigned int component_count = endpoint_count * 3;
-		uint8_t ep_idx = 0, comp_idx = 0;
-		for (unsigned int i = 0; i < component_count; i++) {
-			endpoints.u8[ep_idx][comp_idx] = (lsb & endpoint_mask) << endpoint_shamt;
-			ep_idx++;
-			if (ep_idx == endpoint_count) {
-				// Next component.
-				comp_idx++;
-				ep_idx = 0;
-			}
-
-			// Shift the data over.
-			rshift128(msb, lsb, endpoint_bits);
-		}
-
-		// Do we have alpha components?
-		static const uint8_t AlphaBits[8] = {0, 0, 0, 0, 6, 8, 7, 5};
-		uint8_t alpha_bits = AlphaBits[mode];
-		if (alpha_bits != 0) {
-			// We have alpha components.
-			// TODO: Might not actually be alpha if rotation is enabled...
-			// TODO: Or, rotation might enable alpha...
-			const uint8_t alpha_mask = (1U << alpha_bits) - 1;
-			const uint8_t alpha_shamt = 8U - alpha_bits;
-			for (unsigned int i = 0; i < endpoint_count; i++) {
-				alpha[i] = (lsb & alpha_mask) << alpha_shamt;
-				rshift128(msb, lsb, alpha_bits);
-			}
-		} else {
-			// No alpha. Use 255.
-			alpha[0] = 255;
-			alpha[1] = 255;
-			alpha[2] = 255;
-			alpha[3] = 255;
-		}
-
-		// P-bits.
-		// NOTE: These are applied per subset.
-		// The P-bit count is needed here in order to determine the
-		// shift amount for the endpoints and alpha values.
-		static const uint8_t PBitCount[8] = {1, 1, 0, 1, 0, 0, 1, 1};
-		if (PBitCount[mode] != 0) {
-			// Optimization to avoid having to shift the
-			// whole 64-bit and/or 128-bit value multiple times.
-			unsigned int lsb8 = (lsb & 0xFF);
-			if (mode == 1) {
-				// Mode 1: Two P-bits for four endpoints.
-
-				// Subset 0
-				if (lsb & 1) {
-					endpoints.u32[0] |= 0x02020202;
-					endpoints.u32[1] |= 0x02020202;
-				}
-
-				// Subset 1
-				if (lsb & 2) {
-					endpoints.u32[2] |= 0x02020202;
-					endpoints.u32[3] |= 0x02020202;
-				}
-
-				rshift128(msb, lsb, 2);
-			} else {
-				// Other modes: Unique P-bit for each endpoint.
-				const uint8_t p_ep_shamt = 7 - endpoint_bits;
-				for (unsigned int i = 0; i < endpoint_count; i++, lsb8 >>= 1) {
-					if (lsb8 & 1) {
-						endpoints.u32[i] |= (0x01010101 << p_ep_shamt);
-					}
-				}
-
-				if (alpha_bits > 0) {
-					// Apply P-bits to the alpha components.
-					assert(endpoint_count <= ARRAY_SIZE(alpha));
-					const uint8_t p_a_shamt = 7 - alpha_bits;
-					lsb8 = (lsb & 0xFF);
-					for (unsigned int i = 0; i < endpoint_count; i++, lsb8 >>= 1) {
-						alpha[i] |= (lsb8 & 1) << p_a_shamt;
-					}
-
-					// Increment the alpha bits to indicate how many bits
-					// need to be copied when expanding the color value.
-					alpha_bits++;
-				}
-
-				rshift128(msb, lsb, endpoint_count);
-			}
-
-			// Increment the endpoint bits to indicate how many bits
-			// need to be copied when expanding the color value.
-			endpoint_bits++;
-		}
-
-		// Expand the endpoints and alpha components.
-		if (endpoint_bits < 8) {
-			for (unsigned int i = 0; i < endpoint_count; i++) {
-				endpoints.u8[i][0] = endpoints.u8[i][0] | (endpoints.u8[i][0] >> endpoint_bits);
-				endpoints.u8[i][1] = endpoints.u8[i][1] | (endpoints.u8[i][1] >> endpoint_bits);
-				endpoints.u8[i][2] = endpoints.u8[i][2] | (endpoints.u8[i][2] >> endpoint_bits);
-			}
-		}
-		if (alpha_bits != 0 && alpha_bits < 8) {
-			for (unsigned int i = 0; i < endpoint_count; i++) {
-				alpha[i] = alpha[i] | (alpha[i] >> alpha_bits);
-			}
-		}
-
-		// Bits per index. (either 2 or 3)
-		// NOTE: Most modes don't have the full 32-bit or 48-bit
-		// index table. Missing bits are assumed to be 0.
-		static const uint8_t IndexBits[8] = {3, 3, 2, 2, 0, 2, 4, 2};
-		unsigned int index_bits = IndexBits[mode];
-
-		// At this point, the only remaining data is indexes,
-		// which fits entirely into LSB. Hence, we can stop
-		// using rshift128().
-
-		// EXCEPTION: Mode 4 has both 2-bit *and* 3-bit indexes.
-		// Depending on idxMode_m4, we have to use one or the other.
-		uint64_t idxData;
-		uint8_t index_mask;
-		if (mode == 4) {
-			// Load the color indexes.
-			if (idxMode_m4) {
-				// idxMode is set: Color data uses the 3-bit indexes.
-				// NOTE: We've already shifted by 50 bits by now, so the
-				// MSB contains the high 14 bits of the index data, and
-				// the LSB contains the low 33 bits of the index data.
-				idxData = (msb << 33) | (lsb >> 31);
-				index_bits = 3;
-				index_mask = (1U << 3) - 1;
-			} else {
-				// idxMode is not set: Color data uses the 2-bit indexes.
-				idxData = lsb & ((1U << 31) - 1);
-				index_bits = 2;
-				index_mask = (1U << 2) - 1;
-			}
-		} else {
-			// Use the LSB indexes as-is.
-			idxData = lsb;
-			index_mask = (1U << index_bits) - 1;
-		}
 
-		// Get the anchor indexes.
-		const uint8_t subset_count = SubsetCount[mode];
-		for (unsigned int i = 1; i < subset_count; i++) {
-			anchor_index[i] = getAnchorIndex(partition, i, subset_count);
-		}
-
-		// Process the index data for the color components.
-		uint32_t subsetData = subset;
-		for (unsigned int i = 0; i < 16; i++, subsetData >>= 2) {
-			const uint8_t subset_idx = subsetData & 3;
-			assert(subset_idx != 3);
-			uint8_t data_idx;
-			if (i == anchor_index[subset_idx]) {
-				// This is an anchor index.
-				// Highest bit is 0.
-				data_idx = idxData & (index_mask >> 1);
-				idxData >>= (index_bits - 1);
-			} else {
-				// Regular index.
-				data_idx = idxData & index_mask;
-				idxData >>= index_bits;
-			}
-
-			const uint8_t ep_idx = subset_idx * 2;
-			tileBuf[i].r = interpolate_component(index_bits, data_idx, endpoints.u8[ep_idx][0], endpoints.u8[ep_idx+1][0]);
-			tileBuf[i].g = interpolate_component(index_bits, data_idx, endpoints.u8[ep_idx][1], endpoints.u8[ep_idx+1][1]);
-			tileBuf[i].b = interpolate_component(index_bits, data_idx, endpoints.u8[ep_idx][2], endpoints.u8[ep_idx+1][2]);
-		}
-
-		// Alpha handling.
-		if (mode == 4) {
-			// Mode 4: Alpha indexes are present.
-			// Load the appropriate indexes based on idxMode.
-			uint8_t index_bits, index_mask;
-			if (idxMode_m4) {
-				// idxMode is set: Alpha data uses the 2-bit indexes.
-				idxData = lsb & ((1U << 31) - 1);
-				index_bits = 2;
-				index_mask = (1U << 2) - 1;
-			} else {
-				// idxMode is not set: Alpha data uses the 3-bit indexes.
-				// NOTE: We've already shifted by 50 bits by now, so the
-				// MSB contains the high 14 bits of the index data, and
-				// the LSB contains the low 33 bits of the index data.
-				idxData = (msb << 33) | (lsb >> 31);
-				index_bits = 3;
-				index_mask = (1U << 3) - 1;
-			}
-
-			subsetData = subset;
-			for (unsigned int i = 0; i < 16; i++, subsetData >>= 2) {
-				const uint8_t subset_idx = subsetData & 3;
-				uint8_t data_idx;
-				if (i == anchor_index[subset_idx]) {
-					// This is an anchor index.
-					// Highest bit is 0.
-					data_idx = idxData & (index_mask >> 1);
-					idxData >>= (index_bits - 1);
-				}
-				else {
-					// Regular index.
-					data_idx = idxData & index_mask;
-					idxData >>= index_bits;
-				}
-
-				tileBuf[i].a = interpolate_component(index_bits, data_idx, alpha[0], alpha[1]);
-			}
-		} else if (alpha_bits == 0) {
-			// No alpha. Assume 255.
-			for (unsigned int i = 0; i < 16; i++) {
-				tileBuf[i].a = 255;
-			}
-		} else {
-			// Process alpha using the index data.
-			if (mode == 5) {
-				// Mode 5: Separate alpha indexes, stored after the color indexes.
-				idxData = lsb >> 31;
-			} else {
-				// Other modes: Same indexes as color data.
-				idxData = lsb;
-			}
-			subsetData = subset;
-			for (unsigned int i = 0; i < 16; i++, subsetData >>= 2) {
-				const uint8_t subset_idx = subsetData & 3;
-				uint8_t data_idx;
-				if (i == anchor_index[subset_idx]) {
-					// This is an anchor index.
-					// Highest bit is 0.
-					data_idx = idxData & (index_mask >> 1);
-					idxData >>= (index_bits - 1);
-				} else {
-					// Regular index.
-					data_idx = idxData & index_mask;
-					idxData >>= index_bits;
-				}
-
-				const uint8_t ep_idx = subset_idx * 2;
-				tileBuf[i].a = interpolate_component(index_bits, data_idx, alpha[ep_idx], alpha[ep_idx+1]);
-			}
+		// Interpolate the pixels.
+		for (unsigned int i = 0; i < 16; i++) {
+			const argb32_t e0 = blk.endpoints[0][blk.subset[i]];
+			const argb32_t e1 = blk.endpoints[1][blk.subset[i]];
+			const unsigned int cw = blk.colorWeight[i];
+			const unsigned int aw = blk.alphaWeight[i];
+			tileBuf[i].r = (uint8_t)((((64 - cw) * e0.r) + (cw * e1.r) + 32) >> 6);
+			tileBuf[i].g = (uint8_t)((((64 - cw) * e0.g) + (cw * e1.g) + 32) >> 6);
+			tileBuf[i].b = (uint8_t)((((64 - cw) * e0.b) + (cw * e1.b) + 32) >> 6);
+			tileBuf[i].a = (uint8_t)((((64 - aw) * e0.a) + (aw * e1.a) + 32) >> 6);
 		}
 
 		// Component rotation.
-		switch (rotation_mode & 3) {
+		switch (blk.rotation_mode & 3) {
 			case 0:
 				// ARGB: No rotation.
 				break;
@@ -692,4 +832,20 @@ rp_image *fromBC7(int width, int height,
 	return img;
 }
 
+/**
+ * Convert a BC7 image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC7_cpp(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromBC7_st, 16,
+		width, height, img_buf, img_siz);
+}
+
 } }
@@ -0,0 +1,435 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_BC7.cpp: Image decoding functions. (BC7)                   *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// librpcpu
+#include "librpcpu/bitstuff.h"
+
+// AVX2 headers.
+#include <immintrin.h>
+
+// C++ STL classes.
+using std::vector;
+
+// NOTE: The output of these functions must be identical to
+// the standard version in ImageDecoder_BC7.cpp.
+// See ImageDecoder_BC7_sse41.cpp for details on the algorithm.
+// The AVX2 version decodes two blocks of the same mode per
+// register, since VPSHUFB works on each 128-bit lane separately.
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+typedef ImageDecoderPrivate::bc7_mode_params_t bc7_mode_params_t;
+typedef ImageDecoderPrivate::bc7_partition_t bc7_partition_t;
+
+/**
+ * Load a 16-byte constant into both 128-bit lanes.
+ * @param p Constant.
+ * @return 256-bit vector.
+ */
+static FORCEINLINE __m256i load_const(const void *p)
+{
+	return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+/**
+ * Load two 16-byte values into separate 128-bit lanes.
+ * @param pA Value for the low lane.
+ * @param pB Value for the high lane.
+ * @return 256-bit vector.
+ */
+static FORCEINLINE __m256i load_pair(const void *pA, const void *pB)
+{
+	return _mm256_inserti128_si256(
+		_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pA))),
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(pB)), 1);
+}
+
+/**
+ * Extract 16 BC7 indexes per block and look up their interpolation weights.
+ * @param blk BC7 blocks.
+ * @param offs Bit offset of each index.
+ * @param mask Mask for each index.
+ * @param weights Interpolation weights.
+ * @return Interpolation weight for each pixel.
+ */
+static FORCEINLINE __m256i extractWeights(__m256i blk, __m256i offs, __m256i mask, __m256i weights)
+{
+	// Multipliers to shift a 16-bit window right by 0-7 bits,
+	// leaving the result in the high byte: 2^(8 - shamt)
+	const __m256i shMulLo = _mm256_broadcastsi128_si256(
+		_mm_setr_epi8(0, -128, 64, 32, 16, 8, 4, 2, 0,0,0,0,0,0,0,0));
+	const __m256i shMulHi = _mm256_broadcastsi128_si256(
+		_mm_setr_epi8(1, 0, 0, 0, 0, 0, 0, 0, 0,0,0,0,0,0,0,0));
+
+	const __m256i byteIdx = _mm256_and_si256(_mm256_srli_epi16(offs, 3), _mm256_set1_epi8(0x1F));
+	const __m256i byteIdx1 = _mm256_add_epi8(byteIdx, _mm256_set1_epi8(1));
+	const __m256i shamt = _mm256_and_si256(offs, _mm256_set1_epi8(7));
+	const __m256i mulL = _mm256_shuffle_epi8(shMulLo, shamt);
+	const __m256i mulH = _mm256_shuffle_epi8(shMulHi, shamt);
+
+	// NOTE: If the last index ends at bit 127, byteIdx1 is 16,
+	// which VPSHUFB wraps around to 0. The index fits entirely
+	// within the first byte in that case, so the extra bits
+	// are masked out.
+	__m256i lo = _mm256_shuffle_epi8(blk, _mm256_unpacklo_epi8(byteIdx, byteIdx1));
+	__m256i hi = _mm256_shuffle_epi8(blk, _mm256_unpackhi_epi8(byteIdx, byteIdx1));
+	lo = _mm256_srli_epi16(_mm256_mullo_epi16(lo, _mm256_unpacklo_epi8(mulL, mulH)), 8);
+	hi = _mm256_srli_epi16(_mm256_mullo_epi16(hi, _mm256_unpackhi_epi8(mulL, mulH)), 8);
+
+	const __m256i idx = _mm256_and_si256(_mm256_packus_epi16(lo, hi), mask);
+	return _mm256_shuffle_epi8(weights, idx);
+}
+
+/**
+ * Decode two BC7 blocks that use the same mode.
+ * @tparam MODE Block mode.
+ * @param pSrcA First BC7 block.
+ * @param pSrcB Second BC7 block.
+ * @param mp Mode parameters.
+ * @param pDestA Destination tile for the first block.
+ * @param pDestB Destination tile for the second block.
+ * @param stride Destination stride, in bytes.
+ */
+template<unsigned int MODE>
+static FORCEINLINE void decodeBlockPair(const uint8_t *pSrcA, const uint8_t *pSrcB,
+	const bc7_mode_params_t *RESTRICT mp, uint8_t *pDestA, uint8_t *pDestB, int stride)
+{
+	typedef ImageDecoderPrivate::bc7_mode_traits_t<MODE> traits;
+
+	const __m256i blk = load_pair(pSrcA, pSrcB);
+	// NOTE: The mode, rotation, index selection, and partition
+	// bits are all within the first 14 bits.
+	const uint32_t hdrA = le32_to_cpu(*reinterpret_cast<const uint32_t*>(pSrcA));
+	const uint32_t hdrB = le32_to_cpu(*reinterpret_cast<const uint32_t*>(pSrcB));
+
+	// Extract the endpoint components.
+	__m256i comp[3];
+	for (unsigned int v = 0; v < traits::compVecs; v++) {
+		const __m256i win = _mm256_shuffle_epi8(blk, load_const(mp->compShuf[v]));
+		const __m256i c = _mm256_and_si256(
+			_mm256_srli_epi16(_mm256_mullo_epi16(win, load_const(mp->compMul[v])), 8),
+			load_const(mp->compMask[v]));
+		__m256i x = _mm256_mullo_epi16(c, load_const(mp->compScale[v]));
+		if (traits::hasPBits) {
+			const __m256i pwin = _mm256_shuffle_epi8(blk, load_const(mp->pbitShuf[v]));
+			const __m256i p = _mm256_and_si256(
+				_mm256_srli_epi16(_mm256_mullo_epi16(pwin, load_const(mp->pbitMul[v])), 8),
+				load_const(mp->pbitMask[v]));
+			x = _mm256_or_si256(x, _mm256_mullo_epi16(p, load_const(mp->pbitScale[v])));
+		}
+		// Copy the MSBs into the LSBs.
+		comp[v] = _mm256_or_si256(x, _mm256_mulhi_epu16(x, load_const(mp->expandMul[v])));
+	}
+
+	// Assemble the endpoint tables. (E0 and E1 for subsets 0-2)
+	const __m256i compA = _mm256_packus_epi16(comp[0], (traits::compVecs > 1 ? comp[1] : _mm256_setzero_si256()));
+	__m256i ep0 = _mm256_or_si256(_mm256_shuffle_epi8(compA, load_const(mp->epShuf[0][0])), load_const(mp->epConst[0]));
+	__m256i ep1 = _mm256_or_si256(_mm256_shuffle_epi8(compA, load_const(mp->epShuf[1][0])), load_const(mp->epConst[1]));
+	if (traits::compVecs > 2) {
+		const __m256i compB = _mm256_packus_epi16(comp[2], comp[2]);
+		ep0 = _mm256_or_si256(ep0, _mm256_shuffle_epi8(compB, load_const(mp->epShuf[0][1])));
+		ep1 = _mm256_or_si256(ep1, _mm256_shuffle_epi8(compB, load_const(mp->epShuf[1][1])));
+	}
+
+	// Extract the indexes.
+	__m256i anchor, anchorsBefore, subset4;
+	if (traits::subsets > 1) {
+		const bc7_partition_t *const partA = &mp->partitions[(hdrA >> mp->partitionShift) & mp->partitionMask];
+		const bc7_partition_t *const partB = &mp->partitions[(hdrB >> mp->partitionShift) & mp->partitionMask];
+		anchor = load_pair(partA->anchor, partB->anchor);
+		anchorsBefore = load_pair(partA->anchorsBefore, partB->anchorsBefore);
+		// Subset indexes, pre-multiplied by 4 for the endpoint table lookup.
+		// NOTE: Subset indexes are at most 2, so 16-bit shifts
+		// won't carry into adjacent bytes.
+		subset4 = _mm256_slli_epi16(load_pair(partA->subset, partB->subset), 2);
+	} else {
+		anchor = load_const(mp->partitions[0].anchor);
+		anchorsBefore = load_const(mp->partitions[0].anchorsBefore);
+		subset4 = _mm256_setzero_si256();
+	}
+
+	const __m256i w1 = extractWeights(blk,
+		_mm256_add_epi8(load_const(mp->idxBase[0]), anchorsBefore),
+		_mm256_andnot_si256(_mm256_and_si256(anchor, _mm256_set1_epi8(mp->idxAnchorBit[0])), _mm256_set1_epi8(mp->idxMask[0])),
+		load_const(mp->idxWeights[0]));
+	__m256i cw, aw;
+	if (traits::hasAlphaIdx) {
+		const __m256i w2 = extractWeights(blk,
+			_mm256_add_epi8(load_const(mp->idxBase[1]), anchorsBefore),
+			_mm256_andnot_si256(_mm256_and_si256(anchor, _mm256_set1_epi8(mp->idxAnchorBit[1])), _mm256_set1_epi8(mp->idxMask[1])),
+			load_const(mp->idxWeights[1]));
+		if (MODE == 4) {
+			// Index selection bit: If set, color uses the 3-bit indexes.
+			const __m256i sel = _mm256_inserti128_si256(
+				_mm256_castsi128_si256(_mm_set1_epi8(-static_cast<int8_t>((hdrA >> 7) & 1))),
+				_mm_set1_epi8(-static_cast<int8_t>((hdrB >> 7) & 1)), 1);
+			cw = _mm256_blendv_epi8(w1, w2, sel);
+			aw = _mm256_blendv_epi8(w2, w1, sel);
+		} else {
+			cw = w1;
+			aw = w2;
+		}
+	} else {
+		cw = w1;
+		aw = w1;
+	}
+
+	// Shuffle masks to expand one tile row's pixel values
+	// to four bytes per pixel.
+	static const uint8_t pxsel[4][16] = {
+		{ 0, 0, 0, 0,  1, 1, 1, 1,  2, 2, 2, 2,  3, 3, 3, 3},
+		{ 4, 4, 4, 4,  5, 5, 5, 5,  6, 6, 6, 6,  7, 7, 7, 7},
+		{ 8, 8, 8, 8,  9, 9, 9, 9, 10,10,10,10, 11,11,11,11},
+		{12,12,12,12, 13,13,13,13, 14,14,14,14, 15,15,15,15},
+	};
+	// Component offsets within each endpoint.
+	const __m256i chanOff = _mm256_broadcastsi128_si256(
+		_mm_setr_epi8(0,1,2,3, 0,1,2,3, 0,1,2,3, 0,1,2,3));
+	// Alpha component mask.
+	const __m256i alphaMask = _mm256_set1_epi32(0xFF000000);
+	const __m256i w64 = _mm256_set1_epi8(64);
+	const __m256i round = _mm256_set1_epi16(32);
+
+	// Component rotation shuffle masks.
+	// - 00: ARGB - no swapping
+	// - 01: RAGB - swap A and R
+	// - 10: GRAB - swap A and G
+	// - 11: BRGA - swap A and B
+	static const uint8_t rotMask[4][16] = {
+		{0,1,2,3, 4,5,6,7, 8,9,10,11, 12,13,14,15},
+		{0,1,3,2, 4,5,7,6, 8,9,11,10, 12,13,15,14},
+		{0,3,2,1, 4,7,6,5, 8,11,10,9, 12,15,14,13},
+		{3,1,2,0, 7,5,6,4, 11,9,10,8, 15,13,14,12},
+	};
+	const __m256i rot = (traits::hasAlphaIdx)
+		? load_pair(rotMask[(hdrA >> (MODE + 1)) & 3], rotMask[(hdrB >> (MODE + 1)) & 3])
+		: _mm256_setzero_si256();
+
+	if (traits::subsets == 1) {
+		// Only one subset, so every pixel uses the same endpoints.
+		ep0 = _mm256_shuffle_epi32(ep0, 0);
+		ep1 = _mm256_shuffle_epi32(ep1, 0);
+	}
+
+	// If the blocks are adjacent, each row can be written
+	// using a single 32-byte store.
+	const bool adjacent = (pDestB == pDestA + 16);
+
+	for (unsigned int row = 0; row < 4; row++, pDestA += stride, pDestB += stride) {
+		const __m256i sel = load_const(pxsel[row]);
+
+		// Look up the endpoints for each pixel.
+		__m256i e0, e1;
+		if (traits::subsets > 1) {
+			const __m256i epIdx = _mm256_add_epi8(_mm256_shuffle_epi8(subset4, sel), chanOff);
+			e0 = _mm256_shuffle_epi8(ep0, epIdx);
+			e1 = _mm256_shuffle_epi8(ep1, epIdx);
+		} else {
+			e0 = ep0;
+			e1 = ep1;
+		}
+
+		// Weights: color weight for RGB; alpha weight for A.
+		const __m256i w = (traits::hasAlphaIdx)
+			? _mm256_blendv_epi8(_mm256_shuffle_epi8(cw, sel), _mm256_shuffle_epi8(aw, sel), alphaMask)
+			: _mm256_shuffle_epi8(cw, sel);
+		const __m256i wInv = _mm256_sub_epi8(w64, w);
+
+		// Interpolate: ((64 - w) * e0 + w * e1 + 32) >> 6
+		__m256i lo = _mm256_maddubs_epi16(_mm256_unpacklo_epi8(e0, e1), _mm256_unpacklo_epi8(wInv, w));
+		__m256i hi = _mm256_maddubs_epi16(_mm256_unpackhi_epi8(e0, e1), _mm256_unpackhi_epi8(wInv, w));
+		lo = _mm256_srli_epi16(_mm256_add_epi16(lo, round), 6);
+		hi = _mm256_srli_epi16(_mm256_add_epi16(hi, round), 6);
+
+		// Pack the pixels and apply component rotation.
+		__m256i px = _mm256_packus_epi16(lo, hi);
+		if (traits::hasAlphaIdx) {
+			px = _mm256_shuffle_epi8(px, rot);
+		}
+		if (adjacent) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestA), px);
+		} else {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDestA), _mm256_castsi256_si128(px));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDestB), _mm256_extracti128_si256(px, 1));
+		}
+	}
+}
+
+/**
+ * Decode a group of BC7 blocks that use the same mode.
+ * @tparam MODE Block mode.
+ * @param pSrcRow First BC7 block in the tile row.
+ * @param blkIdx Block indexes within the tile row.
+ * @param count Number of blocks.
+ * @param mp Mode parameters.
+ * @param pDestRow First tile in the destination row.
+ * @param stride Destination stride, in bytes.
+ */
+template<unsigned int MODE>
+static void decodeGroup(const uint8_t *RESTRICT pSrcRow, const unsigned int *RESTRICT blkIdx,
+	unsigned int count, const bc7_mode_params_t *RESTRICT mp, uint8_t *RESTRICT pDestRow, int stride)
+{
+	for (; count > 1; count -= 2, blkIdx += 2) {
+		const unsigned int xA = blkIdx[0];
+		const unsigned int xB = blkIdx[1];
+		decodeBlockPair<MODE>(pSrcRow + (xA * 16), pSrcRow + (xB * 16), mp,
+			pDestRow + (xA * 16), pDestRow + (xB * 16), stride);
+	}
+
+	if (count == 1) {
+		// Last block. Decode it in both lanes.
+		const unsigned int x = blkIdx[0];
+		decodeBlockPair<MODE>(pSrcRow + (x * 16), pSrcRow + (x * 16), mp,
+			pDestRow + (x * 16), pDestRow + (x * 16), stride);
+	}
+}
+
+/**
+ * Convert a BC7 image to rp_image.
+ * AVX2-optimized version.
+ *
+ * Each tile row's blocks are grouped by mode, and each group
+ * is decoded two blocks at a time using code specialized for
+ * that mode.
+ *
+ * Single-threaded version. (See decodeBlocks_mt().)
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+static rp_image *fromBC7_st(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// BC7 uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	assert(img_siz >= (width * height));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < (physWidth * physHeight))
+	{
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+	uint8_t *const bits = static_cast<uint8_t*>(img->bits());
+	const int stride = img->stride();
+
+	// sBIT metadata.
+	// TODO: Dynamically determine if we have alpha?
+	// Rotation bits makes this difficult...
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+
+	// Per-mode decoding functions.
+	typedef void (*pfnDecodeGroup_t)(const uint8_t *RESTRICT pSrcRow, const unsigned int *RESTRICT blkIdx,
+		unsigned int count, const bc7_mode_params_t *RESTRICT mp, uint8_t *RESTRICT pDestRow, int stride);
+	static const pfnDecodeGroup_t pfnDecodeGroup[8] = {
+		decodeGroup<0>, decodeGroup<1>, decodeGroup<2>, decodeGroup<3>,
+		decodeGroup<4>, decodeGroup<5>, decodeGroup<6>, decodeGroup<7>,
+	};
+	const bc7_mode_params_t *const mp = ImageDecoderPrivate::BC7_getModeParams();
+
+	// Block indexes for the current tile row, grouped by mode.
+	vector<unsigned int> blkIdx(tilesX);
+	// Mode of each block in the current tile row.
+	vector<uint8_t> blkMode(tilesX);
+
+	const uint8_t *pSrcRow = img_buf;
+	for (unsigned int y = 0; y < tilesY; y++, pSrcRow += (tilesX * 16)) {
+		// Determine the mode of each block.
+		// The mode is the lowest set bit in the first byte.
+		unsigned int count[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+		for (unsigned int x = 0; x < tilesX; x++) {
+			const unsigned int lsb8 = pSrcRow[x * 16];
+			if (lsb8 == 0) {
+				// Invalid mode.
+				img->unref();
+				return nullptr;
+			}
+			const uint8_t mode = static_cast<uint8_t>(uilog2(lsb8 & (~lsb8 + 1)));
+			blkMode[x] = mode;
+			count[mode]++;
+		}
+
+		// Group the blocks by mode.
+		unsigned int start[8];
+		unsigned int pos = 0;
+		for (unsigned int mode = 0; mode < 8; mode++) {
+			start[mode] = pos;
+			pos += count[mode];
+		}
+		unsigned int next[8];
+		memcpy(next, start, sizeof(next));
+		for (unsigned int x = 0; x < tilesX; x++) {
+			blkIdx[next[blkMode[x]]++] = x;
+		}
+
+		// Decode each group.
+		uint8_t *const pDestRow = bits + (y * 4 * stride);
+		for (unsigned int mode = 0; mode < 8; mode++) {
+			if (count[mode] == 0)
+				continue;
+			pfnDecodeGroup[mode](pSrcRow, &blkIdx[start[mode]], count[mode],
+				&mp[mode], pDestRow, stride);
+		}
+	}
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a BC7 image to rp_image.
+ * AVX2-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC7_avx2(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromBC7_st, 16,
+		width, height, img_buf, img_siz);
+}
+
+} }
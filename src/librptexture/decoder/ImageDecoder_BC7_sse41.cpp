@@ -0,0 +1,379 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_BC7.cpp: Image decoding functions. (BC7)                   *
+ * SSE4.1-optimized version.                                               *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// librpcpu
+#include "librpcpu/bitstuff.h"
+
+// SSE4.1 headers.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <smmintrin.h>
+
+// C++ STL classes.
+using std::vector;
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+typedef ImageDecoderPrivate::bc7_mode_params_t bc7_mode_params_t;
+typedef ImageDecoderPrivate::bc7_partition_t bc7_partition_t;
+
+/**
+ * Extract 16 BC7 indexes and look up their interpolation weights.
+ * @param blk BC7 block.
+ * @param offs Bit offset of each index.
+ * @param mask Mask for each index.
+ * @param weights Interpolation weights.
+ * @return Interpolation weight for each pixel.
+ */
+static FORCEINLINE __m128i extractWeights(__m128i blk, __m128i offs, __m128i mask, __m128i weights)
+{
+	// Multipliers to shift a 16-bit window right by 0-7 bits,
+	// leaving the result in the high byte: 2^(8 - shamt)
+	const __m128i shMulLo = _mm_setr_epi8(0, -128, 64, 32, 16, 8, 4, 2, 0,0,0,0,0,0,0,0);
+	const __m128i shMulHi = _mm_setr_epi8(1, 0, 0, 0, 0, 0, 0, 0, 0,0,0,0,0,0,0,0);
+
+	const __m128i byteIdx = _mm_and_si128(_mm_srli_epi16(offs, 3), _mm_set1_epi8(0x1F));
+	const __m128i byteIdx1 = _mm_add_epi8(byteIdx, _mm_set1_epi8(1));
+	const __m128i shamt = _mm_and_si128(offs, _mm_set1_epi8(7));
+	const __m128i mulL = _mm_shuffle_epi8(shMulLo, shamt);
+	const __m128i mulH = _mm_shuffle_epi8(shMulHi, shamt);
+
+	// NOTE: If the last index ends at bit 127, byteIdx1 is 16,
+	// which PSHUFB wraps around to 0. The index fits entirely
+	// within the first byte in that case, so the extra bits
+	// are masked out.
+	__m128i lo = _mm_shuffle_epi8(blk, _mm_unpacklo_epi8(byteIdx, byteIdx1));
+	__m128i hi = _mm_shuffle_epi8(blk, _mm_unpackhi_epi8(byteIdx, byteIdx1));
+	lo = _mm_srli_epi16(_mm_mullo_epi16(lo, _mm_unpacklo_epi8(mulL, mulH)), 8);
+	hi = _mm_srli_epi16(_mm_mullo_epi16(hi, _mm_unpackhi_epi8(mulL, mulH)), 8);
+
+	const __m128i idx = _mm_and_si128(_mm_packus_epi16(lo, hi), mask);
+	return _mm_shuffle_epi8(weights, idx);
+}
+
+/**
+ * Decode a BC7 block.
+ * @tparam MODE Block mode.
+ * @param pSrc BC7 block.
+ * @param mp Mode parameters.
+ * @param pDest Destination tile.
+ * @param stride Destination stride, in bytes.
+ */
+template<unsigned int MODE>
+static FORCEINLINE void decodeBlock(const uint8_t *RESTRICT pSrc, const bc7_mode_params_t *RESTRICT mp,
+	uint8_t *RESTRICT pDest, int stride)
+{
+	typedef ImageDecoderPrivate::bc7_mode_traits_t<MODE> traits;
+
+	const __m128i blk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc));
+	// NOTE: The mode, rotation, index selection, and partition
+	// bits are all within the first 14 bits.
+	const uint32_t hdr = le32_to_cpu(*reinterpret_cast<const uint32_t*>(pSrc));
+
+	// Extract the endpoint components.
+	__m128i comp[3];
+	for (unsigned int v = 0; v < traits::compVecs; v++) {
+		const __m128i win = _mm_shuffle_epi8(blk, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->compShuf[v])));
+		const __m128i c = _mm_and_si128(
+			_mm_srli_epi16(_mm_mullo_epi16(win, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->compMul[v]))), 8),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->compMask[v])));
+		__m128i x = _mm_mullo_epi16(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->compScale[v])));
+		if (traits::hasPBits) {
+			const __m128i pwin = _mm_shuffle_epi8(blk, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->pbitShuf[v])));
+			const __m128i p = _mm_and_si128(
+				_mm_srli_epi16(_mm_mullo_epi16(pwin, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->pbitMul[v]))), 8),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->pbitMask[v])));
+			x = _mm_or_si128(x, _mm_mullo_epi16(p, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->pbitScale[v]))));
+		}
+		// Copy the MSBs into the LSBs.
+		comp[v] = _mm_or_si128(x, _mm_mulhi_epu16(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->expandMul[v]))));
+	}
+
+	// Assemble the endpoint tables. (E0 and E1 for subsets 0-2)
+	const __m128i compA = _mm_packus_epi16(comp[0], (traits::compVecs > 1 ? comp[1] : _mm_setzero_si128()));
+	__m128i ep0 = _mm_or_si128(_mm_shuffle_epi8(compA, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->epShuf[0][0]))),
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->epConst[0])));
+	__m128i ep1 = _mm_or_si128(_mm_shuffle_epi8(compA, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->epShuf[1][0]))),
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->epConst[1])));
+	if (traits::compVecs > 2) {
+		const __m128i compB = _mm_packus_epi16(comp[2], comp[2]);
+		ep0 = _mm_or_si128(ep0, _mm_shuffle_epi8(compB, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->epShuf[0][1]))));
+		ep1 = _mm_or_si128(ep1, _mm_shuffle_epi8(compB, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->epShuf[1][1]))));
+	}
+
+	// Extract the indexes.
+	const bc7_partition_t *const part = (traits::subsets > 1)
+		? &mp->partitions[(hdr >> mp->partitionShift) & mp->partitionMask]
+		: &mp->partitions[0];
+	const __m128i anchor = _mm_loadu_si128(reinterpret_cast<const __m128i*>(part->anchor));
+	const __m128i anchorsBefore = _mm_loadu_si128(reinterpret_cast<const __m128i*>(part->anchorsBefore));
+
+	const __m128i w1 = extractWeights(blk,
+		_mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->idxBase[0])), anchorsBefore),
+		_mm_andnot_si128(_mm_and_si128(anchor, _mm_set1_epi8(mp->idxAnchorBit[0])), _mm_set1_epi8(mp->idxMask[0])),
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->idxWeights[0])));
+	__m128i cw, aw;
+	if (traits::hasAlphaIdx) {
+		const __m128i w2 = extractWeights(blk,
+			_mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->idxBase[1])), anchorsBefore),
+			_mm_andnot_si128(_mm_and_si128(anchor, _mm_set1_epi8(mp->idxAnchorBit[1])), _mm_set1_epi8(mp->idxMask[1])),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(mp->idxWeights[1])));
+		if (MODE == 4) {
+			// Index selection bit: If set, color uses the 3-bit indexes.
+			const __m128i sel = _mm_set1_epi8(-static_cast<int8_t>((hdr >> 7) & 1));
+			cw = _mm_blendv_epi8(w1, w2, sel);
+			aw = _mm_blendv_epi8(w2, w1, sel);
+		} else {
+			cw = w1;
+			aw = w2;
+		}
+	} else {
+		cw = w1;
+		aw = w1;
+	}
+
+	// Shuffle masks to expand one tile row's pixel values
+	// to four bytes per pixel.
+	const __m128i pxsel[4] = {
+		_mm_setr_epi8( 0, 0, 0, 0,  1, 1, 1, 1,  2, 2, 2, 2,  3, 3, 3, 3),
+		_mm_setr_epi8( 4, 4, 4, 4,  5, 5, 5, 5,  6, 6, 6, 6,  7, 7, 7, 7),
+		_mm_setr_epi8( 8, 8, 8, 8,  9, 9, 9, 9, 10,10,10,10, 11,11,11,11),
+		_mm_setr_epi8(12,12,12,12, 13,13,13,13, 14,14,14,14, 15,15,15,15),
+	};
+	// Component offsets within each endpoint.
+	const __m128i chanOff = _mm_setr_epi8(0,1,2,3, 0,1,2,3, 0,1,2,3, 0,1,2,3);
+	// Alpha component mask.
+	const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+	const __m128i w64 = _mm_set1_epi8(64);
+	const __m128i round = _mm_set1_epi16(32);
+
+	// Component rotation shuffle masks.
+	// - 00: ARGB - no swapping
+	// - 01: RAGB - swap A and R
+	// - 10: GRAB - swap A and G
+	// - 11: BRGA - swap A and B
+	static const uint8_t rotMask[4][16] = {
+		{0,1,2,3, 4,5,6,7, 8,9,10,11, 12,13,14,15},
+		{0,1,3,2, 4,5,7,6, 8,9,11,10, 12,13,15,14},
+		{0,3,2,1, 4,7,6,5, 8,11,10,9, 12,15,14,13},
+		{3,1,2,0, 7,5,6,4, 11,9,10,8, 15,13,14,12},
+	};
+	const __m128i rot = (traits::hasAlphaIdx)
+		? _mm_loadu_si128(reinterpret_cast<const __m128i*>(rotMask[(hdr >> (MODE + 1)) & 3]))
+		: _mm_setzero_si128();
+
+	// Subset indexes, pre-multiplied by 4 for the endpoint table lookup.
+	// NOTE: Subset indexes are at most 2, so 16-bit shifts
+	// won't carry into adjacent bytes.
+	const __m128i subset4 = (traits::subsets > 1)
+		? _mm_slli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(part->subset)), 2)
+		: _mm_setzero_si128();
+	if (traits::subsets == 1) {
+		// Only one subset, so every pixel uses the same endpoints.
+		ep0 = _mm_shuffle_epi32(ep0, 0);
+		ep1 = _mm_shuffle_epi32(ep1, 0);
+	}
+
+	for (unsigned int row = 0; row < 4; row++, pDest += stride) {
+		// Look up the endpoints for each pixel.
+		__m128i e0, e1;
+		if (traits::subsets > 1) {
+			const __m128i epIdx = _mm_add_epi8(_mm_shuffle_epi8(subset4, pxsel[row]), chanOff);
+			e0 = _mm_shuffle_epi8(ep0, epIdx);
+			e1 = _mm_shuffle_epi8(ep1, epIdx);
+		} else {
+			e0 = ep0;
+			e1 = ep1;
+		}
+
+		// Weights: color weight for RGB; alpha weight for A.
+		const __m128i w = (traits::hasAlphaIdx)
+			? _mm_blendv_epi8(_mm_shuffle_epi8(cw, pxsel[row]), _mm_shuffle_epi8(aw, pxsel[row]), alphaMask)
+			: _mm_shuffle_epi8(cw, pxsel[row]);
+		const __m128i wInv = _mm_sub_epi8(w64, w);
+
+		// Interpolate: ((64 - w) * e0 + w * e1 + 32) >> 6
+		__m128i lo = _mm_maddubs_epi16(_mm_unpacklo_epi8(e0, e1), _mm_unpacklo_epi8(wInv, w));
+		__m128i hi = _mm_maddubs_epi16(_mm_unpackhi_epi8(e0, e1), _mm_unpackhi_epi8(wInv, w));
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 6);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 6);
+
+		// Pack the pixels and apply component rotation.
+		__m128i px = _mm_packus_epi16(lo, hi);
+		if (traits::hasAlphaIdx) {
+			px = _mm_shuffle_epi8(px, rot);
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), px);
+	}
+}
+
+/**
+ * Decode a group of BC7 blocks that use the same mode.
+ * @tparam MODE Block mode.
+ * @param pSrcRow First BC7 block in the tile row.
+ * @param blkIdx Block indexes within the tile row.
+ * @param count Number of blocks.
+ * @param mp Mode parameters.
+ * @param pDestRow First tile in the destination row.
+ * @param stride Destination stride, in bytes.
+ */
+template<unsigned int MODE>
+static void decodeGroup(const uint8_t *RESTRICT pSrcRow, const unsigned int *RESTRICT blkIdx,
+	unsigned int count, const bc7_mode_params_t *RESTRICT mp, uint8_t *RESTRICT pDestRow, int stride)
+{
+	for (; count > 0; count--, blkIdx++) {
+		const unsigned int x = *blkIdx;
+		decodeBlock<MODE>(pSrcRow + (x * 16), mp, pDestRow + (x * 16), stride);
+	}
+}
+
+/**
+ * Convert a BC7 image to rp_image.
+ * SSE4.1-optimized version.
+ *
+ * Each tile row's blocks are grouped by mode, and each group
+ * is decoded using code specialized for that mode. Endpoint
+ * extraction, index extraction, and interpolation are all
+ * done using SIMD.
+ *
+ * Single-threaded version. (See decodeBlocks_mt().)
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+static rp_image *fromBC7_st(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// BC7 uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	assert(img_siz >= (width * height));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < (physWidth * physHeight))
+	{
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+	uint8_t *const bits = static_cast<uint8_t*>(img->bits());
+	const int stride = img->stride();
+
+	// sBIT metadata.
+	// TODO: Dynamically determine if we have alpha?
+	// Rotation bits makes this difficult...
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+
+	// Per-mode decoding functions.
+	typedef void (*pfnDecodeGroup_t)(const uint8_t *RESTRICT pSrcRow, const unsigned int *RESTRICT blkIdx,
+		unsigned int count, const bc7_mode_params_t *RESTRICT mp, uint8_t *RESTRICT pDestRow, int stride);
+	static const pfnDecodeGroup_t pfnDecodeGroup[8] = {
+		decodeGroup<0>, decodeGroup<1>, decodeGroup<2>, decodeGroup<3>,
+		decodeGroup<4>, decodeGroup<5>, decodeGroup<6>, decodeGroup<7>,
+	};
+	const bc7_mode_params_t *const mp = ImageDecoderPrivate::BC7_getModeParams();
+
+	// Block indexes for the current tile row, grouped by mode.
+	vector<unsigned int> blkIdx(tilesX);
+	// Mode of each block in the current tile row.
+	vector<uint8_t> blkMode(tilesX);
+
+	const uint8_t *pSrcRow = img_buf;
+	for (unsigned int y = 0; y < tilesY; y++, pSrcRow += (tilesX * 16)) {
+		// Determine the mode of each block.
+		// The mode is the lowest set bit in the first byte.
+		unsigned int count[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+		for (unsigned int x = 0; x < tilesX; x++) {
+			const unsigned int lsb8 = pSrcRow[x * 16];
+			if (lsb8 == 0) {
+				// Invalid mode.
+				img->unref();
+				return nullptr;
+			}
+			const uint8_t mode = static_cast<uint8_t>(uilog2(lsb8 & (~lsb8 + 1)));
+			blkMode[x] = mode;
+			count[mode]++;
+		}
+
+		// Group the blocks by mode.
+		unsigned int start[8];
+		unsigned int pos = 0;
+		for (unsigned int mode = 0; mode < 8; mode++) {
+			start[mode] = pos;
+			pos += count[mode];
+		}
+		unsigned int next[8];
+		memcpy(next, start, sizeof(next));
+		for (unsigned int x = 0; x < tilesX; x++) {
+			blkIdx[next[blkMode[x]]++] = x;
+		}
+
+		// Decode each group.
+		uint8_t *const pDestRow = bits + (y * 4 * stride);
+		for (unsigned int mode = 0; mode < 8; mode++) {
+			if (count[mode] == 0)
+				continue;
+			pfnDecodeGroup[mode](pSrcRow, &blkIdx[start[mode]], count[mode],
+				&mp[mode], pDestRow, stride);
+		}
+	}
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a BC7 image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC7_sse41(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromBC7_st, 16,
+		width, height, img_buf, img_siz);
+}
+
+} }
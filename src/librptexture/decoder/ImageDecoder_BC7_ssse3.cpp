@@ -0,0 +1,182 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_BC7.cpp: Image decoding functions. (BC7)                   *
+ * SSSE3-optimized version.                                                *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// SSSE3 headers.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Convert a BC7 image to rp_image.
+ * SSSE3-optimized version.
+ *
+ * Block parameters are decoded using the same code as the
+ * standard version. Endpoint lookup and interpolation are
+ * done four pixels (one tile row) at a time using PSHUFB
+ * and PMADDUBSW.
+ *
+ * Single-threaded version. (See decodeBlocks_mt().)
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+static rp_image *fromBC7_st(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// BC7 uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	assert(img_siz >= (width * height));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < (physWidth * physHeight))
+	{
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+	uint8_t *const bits = static_cast<uint8_t*>(img->bits());
+	const int stride = img->stride();
+
+	// sBIT metadata.
+	// TODO: Dynamically determine if we have alpha?
+	// Rotation bits makes this difficult...
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+
+	// Shuffle masks to expand one tile row's pixel values
+	// to four bytes per pixel.
+	const __m128i pxsel[4] = {
+		_mm_setr_epi8( 0, 0, 0, 0,  1, 1, 1, 1,  2, 2, 2, 2,  3, 3, 3, 3),
+		_mm_setr_epi8( 4, 4, 4, 4,  5, 5, 5, 5,  6, 6, 6, 6,  7, 7, 7, 7),
+		_mm_setr_epi8( 8, 8, 8, 8,  9, 9, 9, 9, 10,10,10,10, 11,11,11,11),
+		_mm_setr_epi8(12,12,12,12, 13,13,13,13, 14,14,14,14, 15,15,15,15),
+	};
+	// Component offsets within each endpoint.
+	const __m128i chanOff = _mm_setr_epi8(0,1,2,3, 0,1,2,3, 0,1,2,3, 0,1,2,3);
+	// Alpha component mask.
+	const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+	const __m128i w64 = _mm_set1_epi8(64);
+	const __m128i round = _mm_set1_epi16(32);
+
+	// Component rotation shuffle masks.
+	// - 00: ARGB - no swapping
+	// - 01: RAGB - swap A and R
+	// - 10: GRAB - swap A and G
+	// - 11: BRGA - swap A and B
+	const __m128i rotMask[4] = {
+		_mm_setr_epi8(0,1,2,3, 4,5,6,7, 8,9,10,11, 12,13,14,15),
+		_mm_setr_epi8(0,1,3,2, 4,5,7,6, 8,9,11,10, 12,13,15,14),
+		_mm_setr_epi8(0,3,2,1, 4,7,6,5, 8,11,10,9, 12,15,14,13),
+		_mm_setr_epi8(3,1,2,0, 7,5,6,4, 11,9,10,8, 15,13,14,12),
+	};
+
+	// BC7 blocks are 128-bit little-endian.
+	const uint64_t *bc7_src = reinterpret_cast<const uint64_t*>(img_buf);
+
+	for (unsigned int y = 0; y < tilesY; y++) {
+		uint8_t *pDestRow = bits + (y * 4 * stride);
+	for (unsigned int x = 0; x < tilesX; x++, bc7_src += 2) {
+		ImageDecoderPrivate::bc7_block_t blk;
+		if (ImageDecoderPrivate::BC7_decodeBlock(&blk, bc7_src) != 0) {
+			// Invalid mode.
+			img->unref();
+			return nullptr;
+		}
+
+		// Endpoint tables. (E0 and E1 for subsets 0-2)
+		const __m128i ep0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk.endpoints[0][0]));
+		const __m128i ep1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk.endpoints[1][0]));
+		// Subset indexes, pre-multiplied by 4 for the endpoint table lookup.
+		// NOTE: Subset indexes are at most 2, so 16-bit shifts
+		// won't carry into adjacent bytes.
+		const __m128i subset4 = _mm_slli_epi16(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(blk.subset)), 2);
+		const __m128i cw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blk.colorWeight));
+		const __m128i aw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blk.alphaWeight));
+		const __m128i rot = rotMask[blk.rotation_mode & 3];
+
+		uint8_t *pDest = pDestRow + (x * 16);
+		for (unsigned int row = 0; row < 4; row++, pDest += stride) {
+			// Look up the endpoints for each pixel.
+			const __m128i epIdx = _mm_add_epi8(_mm_shuffle_epi8(subset4, pxsel[row]), chanOff);
+			const __m128i e0 = _mm_shuffle_epi8(ep0, epIdx);
+			const __m128i e1 = _mm_shuffle_epi8(ep1, epIdx);
+
+			// Weights: color weight for RGB; alpha weight for A.
+			const __m128i w = _mm_or_si128(
+				_mm_andnot_si128(alphaMask, _mm_shuffle_epi8(cw, pxsel[row])),
+				_mm_and_si128(alphaMask, _mm_shuffle_epi8(aw, pxsel[row])));
+			const __m128i wInv = _mm_sub_epi8(w64, w);
+
+			// Interpolate: ((64 - w) * e0 + w * e1 + 32) >> 6
+			__m128i lo = _mm_maddubs_epi16(_mm_unpacklo_epi8(e0, e1), _mm_unpacklo_epi8(wInv, w));
+			__m128i hi = _mm_maddubs_epi16(_mm_unpackhi_epi8(e0, e1), _mm_unpackhi_epi8(wInv, w));
+			lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 6);
+			hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 6);
+
+			// Pack the pixels and apply component rotation.
+			const __m128i px = _mm_shuffle_epi8(_mm_packus_epi16(lo, hi), rot);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), px);
+		}
+	} }
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a BC7 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC7_ssse3(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromBC7_st, 16,
+		width, height, img_buf, img_siz);
+}
+
+} }
@@ -0,0 +1,37 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_DC_bmi2.cpp: Image decoding functions. (Dreamcast)         *
+ * BMI2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+
+// Use PDEP for Morton index calculation.
+#define DC_MORTON_USE_BMI2 1
+#include "ImageDecoder_DC_morton.hpp"
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * BMI2-optimized version using Morton-order block decoding.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf 16-bit image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDreamcastSquareTwiddled16_bmi2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	return fromDreamcastSquareTwiddled16_morton(px_format,
+		width, height, img_buf, img_siz);
+}
+
+} }
@@ -0,0 +1,461 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_DC_morton.hpp: Image decoding functions. (Dreamcast)       *
+ * Morton-order SSE2 kernels. (shared by the SSE2 and BMI2 versions)       *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+/**
+ * Dreamcast twiddled textures are stored in Morton order, with the
+ * Y coordinate in the even bits and the X coordinate in the odd bits.
+ * Every aligned run of 16 source pixels is a 4x4 tile, so the image
+ * is decoded one 4x4 tile at a time: the tile's Morton index is
+ * computed from its tile coordinates, and its 16 pixels are loaded
+ * and converted together. Tiles are written one 4-line strip at a
+ * time so the destination image is written mostly sequentially.
+ *
+ * Define DC_MORTON_USE_BMI2 before including this file to use PDEP
+ * for Morton index calculation. The including file must be compiled
+ * with BMI2 enabled in that case.
+ */
+
+#ifndef __ROMPROPERTIES_LIBRPTEXTURE_DECODER_IMAGEDECODER_DC_MORTON_HPP__
+#define __ROMPROPERTIES_LIBRPTEXTURE_DECODER_IMAGEDECODER_DC_MORTON_HPP__
+
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+#include "PixelConversion.hpp"
+#include "librpcpu/bitstuff.h"
+
+// SSE2 intrinsics.
+#include <emmintrin.h>
+#ifdef DC_MORTON_USE_BMI2
+// BMI2 intrinsics.
+#  include <immintrin.h>
+#endif /* DC_MORTON_USE_BMI2 */
+
+// MSVC complains when the high bit is set in hex values
+// when setting SSE2 registers.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4309)
+#endif
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Spread the bits of a coordinate into the odd bits of a Morton index.
+ * The even bits are the same coordinate shifted right by one bit.
+ * @param x X coordinate. (maximum is 16 bits)
+ * @return Morton index with the X coordinate in the odd bits.
+ */
+static FORCEINLINE unsigned int dc_morton_spread_x(unsigned int x)
+{
+#ifdef DC_MORTON_USE_BMI2
+	return _pdep_u32(x, 0xAAAAAAAAU);
+#else /* !DC_MORTON_USE_BMI2 */
+	x = (x | (x << 8)) & 0x00FF00FFU;
+	x = (x | (x << 4)) & 0x0F0F0F0FU;
+	x = (x | (x << 2)) & 0x33333333U;
+	x = (x | (x << 1)) & 0x55555555U;
+	return x << 1;
+#endif /* DC_MORTON_USE_BMI2 */
+}
+
+/**
+ * Spread the bits of a coordinate into the even bits of a Morton index.
+ * @param y Y coordinate. (maximum is 16 bits)
+ * @return Morton index with the Y coordinate in the even bits.
+ */
+static FORCEINLINE unsigned int dc_morton_spread_y(unsigned int y)
+{
+#ifdef DC_MORTON_USE_BMI2
+	return _pdep_u32(y, 0x55555555U);
+#else /* !DC_MORTON_USE_BMI2 */
+	return dc_morton_spread_x(y) >> 1;
+#endif /* DC_MORTON_USE_BMI2 */
+}
+
+/**
+ * Templated function for Dreamcast 16-bit to ARGB32 conversion using SSE2.
+ * Converts 8 pixels.
+ * @tparam px_format Pixel format. (ARGB1555, RGB565, or ARGB4444)
+ * @param px16	[in] 16-bit pixels.
+ * @param px0	[out] First four ARGB32 pixels.
+ * @param px1	[out] Last four ARGB32 pixels.
+ */
+template<PixelFormat px_format>
+static FORCEINLINE void T_dc16_to_ARGB32_sse2(__m128i px16, __m128i &px0, __m128i &px1)
+{
+	const __m128i MaskHi8 = _mm_set1_epi16(0xFF00);
+	__m128i sAR, sGB;
+
+	switch (px_format) {
+		default:
+			assert(!"Unsupported pixel format.");
+			// fall-through
+		case PXF_RGB565: {
+			// RGB565: RRRRRGGG GGGBBBBB
+			__m128i sR = _mm_srli_epi16(_mm_and_si128(px16, _mm_set1_epi16(0xF800)), 8);
+			__m128i sG = _mm_slli_epi16(_mm_and_si128(px16, _mm_set1_epi16(0x07E0)), 5);
+			__m128i sB = _mm_slli_epi16(_mm_and_si128(px16, _mm_set1_epi16(0x001F)), 3);
+			sR = _mm_or_si128(sR, _mm_srli_epi16(sR, 5));
+			sG = _mm_or_si128(sG, _mm_srli_epi16(sG, 6));
+			sB = _mm_or_si128(sB, _mm_srli_epi16(sB, 5));
+			sAR = _mm_or_si128(sR, MaskHi8);
+			sGB = _mm_or_si128(sB, _mm_and_si128(sG, MaskHi8));
+			break;
+		}
+
+		case PXF_ARGB1555: {
+			// ARGB1555: ARRRRRGG GGGBBBBB
+			__m128i sR = _mm_srli_epi16(_mm_and_si128(px16, _mm_set1_epi16(0x7C00)), 7);
+			__m128i sG = _mm_slli_epi16(_mm_and_si128(px16, _mm_set1_epi16(0x03E0)), 6);
+			__m128i sB = _mm_slli_epi16(_mm_and_si128(px16, _mm_set1_epi16(0x001F)), 3);
+			sR = _mm_or_si128(sR, _mm_srli_epi16(sR, 5));
+			sG = _mm_or_si128(sG, _mm_srli_epi16(sG, 5));
+			sB = _mm_or_si128(sB, _mm_srli_epi16(sB, 5));
+			// Alpha: Arithmetic shift copies bit 15 to all bits.
+			const __m128i sA = _mm_and_si128(_mm_srai_epi16(px16, 15), MaskHi8);
+			sAR = _mm_or_si128(sR, sA);
+			sGB = _mm_or_si128(sB, _mm_and_si128(sG, MaskHi8));
+			break;
+		}
+
+		case PXF_ARGB4444: {
+			// ARGB4444: AAAARRRR GGGGBBBB
+			const __m128i MaskNyb = _mm_set1_epi16(0x0F0F);
+			// High nybbles: A and G
+			__m128i sHi = _mm_and_si128(px16, _mm_set1_epi16(0xF0F0));
+			// Low nybbles: R and B
+			__m128i sLo = _mm_and_si128(px16, MaskNyb);
+			sHi = _mm_or_si128(sHi, _mm_and_si128(_mm_srli_epi16(sHi, 4), MaskNyb));
+			sLo = _mm_or_si128(sLo, _mm_slli_epi16(sLo, 4));
+			// sHi: AAAAAAAA GGGGGGGG
+			// sLo: RRRRRRRR BBBBBBBB
+			sAR = _mm_or_si128(_mm_and_si128(sHi, MaskHi8), _mm_srli_epi16(sLo, 8));
+			sGB = _mm_or_si128(_mm_slli_epi16(sHi, 8), _mm_and_si128(sLo, _mm_set1_epi16(0x00FF)));
+			break;
+		}
+	}
+
+	// Unpack AR and GB into DWORDs.
+	px0 = _mm_unpacklo_epi16(sGB, sAR);
+	px1 = _mm_unpackhi_epi16(sGB, sAR);
+}
+
+/**
+ * Templated function for Dreamcast twiddled 16-bit decoding using SSE2.
+ * Each iteration converts one 4x4 block, which is stored as
+ * 16 consecutive pixels in the source buffer.
+ * Blocks are written one 4-line strip at a time.
+ * @tparam px_format Pixel format. (ARGB1555, RGB565, or ARGB4444)
+ * @param img		[in,out] Destination image.
+ * @param img_buf	[in] 16-bit image buffer.
+ */
+template<PixelFormat px_format>
+static inline void T_fromDreamcastSquareTwiddled16_morton(rp_image *RESTRICT img,
+	const uint16_t *RESTRICT img_buf)
+{
+	uint32_t *const bits = static_cast<uint32_t*>(img->bits());
+	const int dest_stride = img->stride() / sizeof(uint32_t);
+	const unsigned int blocksPerRow = static_cast<unsigned int>(img->width()) / 4;
+
+	for (unsigned int by = 0; by < blocksPerRow; by++) {
+	const unsigned int ym = dc_morton_spread_y(by);
+	for (unsigned int bx = 0; bx < blocksPerRow; bx++) {
+		const uint16_t *const src = &img_buf[(dc_morton_spread_x(bx) | ym) * 16];
+
+		// Source pixel order within a 4x4 block:
+		// - v0: (0,0) (0,1) (1,0) (1,1)
+		// - v1: (0,2) (0,3) (1,2) (1,3)
+		// - v2: (2,0) (2,1) (3,0) (3,1)
+		// - v3: (2,2) (2,3) (3,2) (3,3)
+		__m128i v0, v1, v2, v3;
+		T_dc16_to_ARGB32_sse2<px_format>(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[0])), v0, v1);
+		T_dc16_to_ARGB32_sse2<px_format>(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[8])), v2, v3);
+
+		// Even elements are even rows; odd elements are odd rows.
+		const __m128 f0 = _mm_castsi128_ps(v0);
+		const __m128 f1 = _mm_castsi128_ps(v1);
+		const __m128 f2 = _mm_castsi128_ps(v2);
+		const __m128 f3 = _mm_castsi128_ps(v3);
+		uint32_t *const px_dest = &bits[(by * 4 * dest_stride) + (bx * 4)];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*0]),
+			_mm_castps_si128(_mm_shuffle_ps(f0, f2, _MM_SHUFFLE(2,0,2,0))));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*1]),
+			_mm_castps_si128(_mm_shuffle_ps(f0, f2, _MM_SHUFFLE(3,1,3,1))));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*2]),
+			_mm_castps_si128(_mm_shuffle_ps(f1, f3, _MM_SHUFFLE(2,0,2,0))));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*3]),
+			_mm_castps_si128(_mm_shuffle_ps(f1, f3, _MM_SHUFFLE(3,1,3,1))));
+	} }
+}
+
+/**
+ * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * Morton-order version. Falls back to the table-based version
+ * if the image size isn't a power of two, or is smaller than 4x4.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf 16-bit image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+static inline rp_image *fromDreamcastSquareTwiddled16_morton(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(width == height);
+	assert(width <= 4096);
+	assert(img_siz >= ((width * height) * 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    width != height || width > 4096 ||
+	    img_siz < ((width * height) * 2))
+	{
+		return nullptr;
+	}
+
+	if (width < 4 || !isPow2(static_cast<unsigned int>(width))) {
+		// Not a power of two, or smaller than one 4x4 block.
+		return fromDreamcastSquareTwiddled16_cpp(px_format, width, height, img_buf, img_siz);
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	switch (px_format) {
+		case PXF_ARGB1555: {
+			T_fromDreamcastSquareTwiddled16_morton<PXF_ARGB1555>(img, img_buf);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,5,5,0,1};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_RGB565: {
+			T_fromDreamcastSquareTwiddled16_morton<PXF_RGB565>(img, img_buf);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,6,5,0,0};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_ARGB4444: {
+			T_fromDreamcastSquareTwiddled16_morton<PXF_ARGB4444>(img, img_buf);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {4,4,4,0,4};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		default:
+			assert(!"Invalid pixel format for this function.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a Dreamcast vector-quantized image to rp_image.
+ * Morton-order version. Falls back to the table-based version
+ * if the image size isn't a power of two, or is smaller than 4x4.
+ * @param px_format Palette pixel format.
+ * @param smallVQ If true, handle this image as SmallVQ.
+ * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf VQ image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 1024*2; for SmallVQ, 64*2, 256*2, or 512*2]
+ * @return rp_image, or nullptr on error.
+ */
+static inline rp_image *fromDreamcastVQ16_morton(PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz)
+{
+	using namespace LibRpTexture::PixelConversion;
+
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(pal_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(width == height);
+	assert(width <= 4096);
+	assert(img_siz > 0);
+	assert(pal_siz > 0);
+	if (!img_buf || !pal_buf || width <= 0 || height <= 0 ||
+	    width != height || width > 4096 ||
+	    img_siz == 0 || pal_siz == 0)
+	{
+		return nullptr;
+	}
+
+	if (width < 4 || !isPow2(static_cast<unsigned int>(width)) ||
+	    img_siz < (width * height) / 4)
+	{
+		// Not a power of two, smaller than one 4x4 block,
+		// or the image data is too small. The table-based
+		// version handles these cases.
+		return fromDreamcastVQ16_cpp(px_format, smallVQ, hasMipmaps,
+			width, height, img_buf, img_siz, pal_buf, pal_siz);
+	}
+
+	// Determine the number of palette entries.
+	int pal_entry_count;
+	if (smallVQ) {
+		pal_entry_count = (hasMipmaps
+			? calcDreamcastSmallVQPaletteEntries_WithMipmaps(width)
+			: calcDreamcastSmallVQPaletteEntries_NoMipmaps(width));
+	} else {
+		pal_entry_count = 1024;
+	}
+
+	assert(pal_entry_count % 2 == 0);
+	assert(pal_entry_count * 2 >= pal_siz);
+	if ((pal_entry_count % 2 != 0) ||
+	    (pal_entry_count * 2 < pal_siz))
+	{
+		// Palette isn't large enough,
+		// or palette isn't an even multiple.
+		return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Convert the palette.
+	// Each 2x2 palette block is stored in column order:
+	// (0,0), (0,1), (1,0), (1,1). It's rearranged into row
+	// order here so each row of a block is a single 64-bit store.
+	auto palette_buf = aligned_uptr<uint32_t>(16, pal_entry_count);
+	uint32_t *const palette = palette_buf.get();
+	switch (px_format) {
+		case PXF_ARGB1555: {
+			for (unsigned int i = 0; i < static_cast<unsigned int>(pal_entry_count); i += 4) {
+				palette[i+0] = ARGB1555_to_ARGB32(pal_buf[i+0]);
+				palette[i+1] = ARGB1555_to_ARGB32(pal_buf[i+2]);
+				palette[i+2] = ARGB1555_to_ARGB32(pal_buf[i+1]);
+				palette[i+3] = ARGB1555_to_ARGB32(pal_buf[i+3]);
+			}
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,5,5,0,1};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_RGB565: {
+			for (unsigned int i = 0; i < static_cast<unsigned int>(pal_entry_count); i += 4) {
+				palette[i+0] = RGB565_to_ARGB32(pal_buf[i+0]);
+				palette[i+1] = RGB565_to_ARGB32(pal_buf[i+2]);
+				palette[i+2] = RGB565_to_ARGB32(pal_buf[i+1]);
+				palette[i+3] = RGB565_to_ARGB32(pal_buf[i+3]);
+			}
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,6,5,0,0};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_ARGB4444: {
+			for (unsigned int i = 0; i < static_cast<unsigned int>(pal_entry_count); i += 4) {
+				palette[i+0] = ARGB4444_to_ARGB32(pal_buf[i+0]);
+				palette[i+1] = ARGB4444_to_ARGB32(pal_buf[i+2]);
+				palette[i+2] = ARGB4444_to_ARGB32(pal_buf[i+1]);
+				palette[i+3] = ARGB4444_to_ARGB32(pal_buf[i+3]);
+			}
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {4,4,4,0,4};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		default:
+			assert(!"Invalid pixel format for this function.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Each VQ index is a 2x2 block of pixels, so four consecutive
+	// indexes are a 4x4 block of pixels. Index order within the
+	// 4x4 block: (0,0), (0,2), (2,0), (2,2)
+	uint32_t *const bits = static_cast<uint32_t*>(img->bits());
+	const int dest_stride = img->stride() / sizeof(uint32_t);
+	const unsigned int blocksPerRow = static_cast<unsigned int>(width) / 4;
+	for (unsigned int by = 0; by < blocksPerRow; by++) {
+	const unsigned int ym = dc_morton_spread_y(by);
+	for (unsigned int bx = 0; bx < blocksPerRow; bx++) {
+		const uint8_t *const src = &img_buf[(dc_morton_spread_x(bx) | ym) * 4];
+		uint32_t *const px_dest = &bits[(by * 4 * dest_stride) + (bx * 4)];
+
+		// Palette indexes.
+		// Each block of 2x2 pixels uses a 4-element block of
+		// the palette, so the palette index needs to be
+		// multiplied by 4.
+		const unsigned int palIdx[4] = {
+			src[0] * 4U, src[1] * 4U, src[2] * 4U, src[3] * 4U
+		};
+		if (smallVQ) {
+			if (palIdx[0] >= static_cast<unsigned int>(pal_entry_count) ||
+			    palIdx[1] >= static_cast<unsigned int>(pal_entry_count) ||
+			    palIdx[2] >= static_cast<unsigned int>(pal_entry_count) ||
+			    palIdx[3] >= static_cast<unsigned int>(pal_entry_count))
+			{
+				// Palette index is out of bounds.
+				// NOTE: This can only happen with SmallVQ,
+				// since VQ always has 1024 palette entries.
+				assert(!"Palette index is out of bounds.");
+				img->unref();
+				return nullptr;
+			}
+		}
+
+		// Index 0 and 2 are the top two 2x2 blocks;
+		// index 1 and 3 are the bottom two 2x2 blocks.
+		const __m128i p0 = _mm_load_si128(reinterpret_cast<const __m128i*>(&palette[palIdx[0]]));
+		const __m128i p1 = _mm_load_si128(reinterpret_cast<const __m128i*>(&palette[palIdx[1]]));
+		const __m128i p2 = _mm_load_si128(reinterpret_cast<const __m128i*>(&palette[palIdx[2]]));
+		const __m128i p3 = _mm_load_si128(reinterpret_cast<const __m128i*>(&palette[palIdx[3]]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*0]), _mm_unpacklo_epi64(p0, p2));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*1]), _mm_unpackhi_epi64(p0, p2));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*2]), _mm_unpacklo_epi64(p1, p3));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*3]), _mm_unpackhi_epi64(p1, p3));
+	} }
+
+	// Image has been converted.
+	return img;
+}
+
+} }
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#endif /* __ROMPROPERTIES_LIBRPTEXTURE_DECODER_IMAGEDECODER_DC_MORTON_HPP__ */
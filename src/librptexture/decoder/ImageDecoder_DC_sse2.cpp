@@ -0,0 +1,59 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_DC_sse2.cpp: Image decoding functions. (Dreamcast)         *
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+
+#include "ImageDecoder_DC_morton.hpp"
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * SSE2-optimized version using Morton-order block decoding.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf 16-bit image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDreamcastSquareTwiddled16_sse2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	return fromDreamcastSquareTwiddled16_morton(px_format,
+		width, height, img_buf, img_siz);
+}
+
+/**
+ * Convert a Dreamcast vector-quantized image to rp_image.
+ * SSE2-optimized version using Morton-order block decoding.
+ * @param px_format Palette pixel format.
+ * @param smallVQ If true, handle this image as SmallVQ.
+ * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf VQ image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 1024*2; for SmallVQ, 64*2, 256*2, or 512*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDreamcastVQ16_sse2(PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz)
+{
+	return fromDreamcastVQ16_morton(px_format, smallVQ, hasMipmaps,
+		width, height, img_buf, img_siz, pal_buf, pal_siz);
+}
+
+} }
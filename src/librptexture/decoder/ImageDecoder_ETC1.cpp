@@ -15,7 +15,7 @@
 // - https://www.khronos.org/registry/DataFormat/specs/1.1/dataformat.1.1.html#ETC1
 // - https://www.khronos.org/registry/DataFormat/specs/1.1/dataformat.1.1.html#ETC2
 
-namespace LibRpTexture { namespace ImageDecoder {
+namespace LibRpTexture {
 
 // ETC1 block format.
 // NOTE: Layout maps to on-disk format, which is big-endian.
@@ -300,28 +300,17 @@ static inline uint32_t clamp_ColorRGB(const ColorRGB &color)
 	return xrgb32 | 0xFF000000;
 }
 
-// ETC decoding mode.
-enum ETC_Decoding_Mode {
-	// Bit 0: ETC1 vs. ETC2
-	ETC_DM_ETC1	= (0U << 0),	// ETC1
-	ETC_DM_ETC2	= (1U << 0),	// ETC2
-	ETC_DM_MASK12	= (1U << 0),
-
-	// Bit 1: ETC2 punchthrough alpha
-	ETC2_DM_A1	= (1U << 1),
-};
-
 /**
- * Decode an ETC1/ETC2 RGB block.
- * @param mode          [in] Mode flags.
- * @param tileBuf	[out] Destination tile buffer.
- * @param src		[in] Source RGB block.
+ * Decode the parameters of an ETC1/ETC2 RGB block.
+ * @param blk		[out] Decoded block parameters.
+ * @param etc1_src	[in] ETC1/ETC2 RGB block. (8 bytes)
+ * @param mode		[in] Mode flags. (See ETC_Decoding_Mode)
  */
-template</* ETC_Decoding_Mode */ unsigned int mode>
-static void decodeBlock_ETC_RGB(uint32_t tileBuf[4*4], const etc1_block *etc1_src)
+void ImageDecoderPrivate::ETC_decodeBlock(etc_rgb_block_t *RESTRICT blk, const uint8_t *RESTRICT etc1_src_u8, unsigned int mode)
 {
 	// Prevent invalid combinations from being used.
-	static_assert(mode != (ETC_DM_ETC1 | ETC2_DM_A1), "Cannot use ETC1 with punchthrough alpha.");
+	assert(mode != (ETC_DM_ETC1 | ETC2_DM_A1));
+	const etc1_block *const etc1_src = reinterpret_cast<const etc1_block*>(etc1_src_u8);
 
 	// Base colors.
 	// For ETC1 mode, these are used as base colors for the two subblocks.
@@ -332,7 +321,7 @@ static void decodeBlock_ETC_RGB(uint32_t tileBuf[4*4], const etc1_block *etc1_sr
 	// 'T', 'H' modes: Paint colors are used instead of base colors.
 	// Intensity modifications are not supported, so we'll store the
 	// final xRGB32 values instead of ColorRGB.
-	uint32_t paint_color[4];
+	uint32_t *const paint_color = blk->paint_color;
 
 	// ETC2 block mode.
 	etc2_block_mode block_mode = etc2_block_mode::Unknown;
@@ -482,6 +471,63 @@ static void decodeBlock_ETC_RGB(uint32_t tileBuf[4*4], const etc1_block *etc1_sr
 		}
 	}
 
+	// Save the block parameters.
+	unsigned int colorCount;
+	switch (block_mode) {
+		default:
+			assert(!"Invalid ETC2 block mode.");
+			// fall-through
+		case etc2_block_mode::ETC1:
+			blk->mode = etc_rgb_block_t::Mode::ETC1;
+			colorCount = 2;
+			break;
+		case etc2_block_mode::TH:
+			blk->mode = etc_rgb_block_t::Mode::TH;
+			colorCount = 0;
+			break;
+		case etc2_block_mode::Planar:
+			blk->mode = etc_rgb_block_t::Mode::Planar;
+			colorCount = 3;
+			break;
+	}
+	for (unsigned int i = 0; i < colorCount; i++) {
+		blk->base_color[i][0] = static_cast<int16_t>(base_color[i].B);
+		blk->base_color[i][1] = static_cast<int16_t>(base_color[i].G);
+		blk->base_color[i][2] = static_cast<int16_t>(base_color[i].R);
+		blk->base_color[i][3] = 255;
+	}
+
+	// control, bit 0: flip
+	blk->flip = etc1_src->control & 0x01;
+	blk->tbl_idx[0] =  etc1_src->control >> 5;
+	blk->tbl_idx[1] = (etc1_src->control >> 2) & 0x07;
+
+	// control, bit 1: opaque bit (ETC2 punchthrough alpha)
+	blk->punchthrough = (mode & ETC2_DM_A1) && !(etc1_src->control & 0x02);
+
+	blk->px_msb = be16_to_cpu(etc1_src->msb);
+	blk->px_lsb = be16_to_cpu(etc1_src->lsb);
+}
+
+namespace ImageDecoder {
+
+/**
+ * Decode an ETC1/ETC2 RGB block.
+ * @param mode          [in] Mode flags.
+ * @param tileBuf	[out] Destination tile buffer.
+ * @param src		[in] Source RGB block.
+ */
+template</* ETC_Decoding_Mode */ unsigned int mode>
+static void decodeBlock_ETC_RGB(uint32_t tileBuf[4*4], const etc1_block *etc1_src)
+{
+	// Prevent invalid combinations from being used.
+	static_assert(mode != (ImageDecoderPrivate::ETC_DM_ETC1 | ImageDecoderPrivate::ETC2_DM_A1),
+		"Cannot use ETC1 with punchthrough alpha.");
+
+	// Decode the block parameters.
+	ImageDecoderPrivate::etc_rgb_block_t blk;
+	ImageDecoderPrivate::ETC_decodeBlock(&blk, reinterpret_cast<const uint8_t*>(etc1_src), mode);
+
 	// Tile arrangement:
 	// flip == 0        flip == 1
 	// a e | i m        a e   i m
@@ -492,37 +538,31 @@ static void decodeBlock_ETC_RGB(uint32_t tileBuf[4*4], const etc1_block *etc1_sr
 
 	// Process the 16 pixel indexes.
 	// TODO: Use SSE2 for saturated arithmetic?
-	uint16_t px_msb = be16_to_cpu(etc1_src->msb);
-	uint16_t px_lsb = be16_to_cpu(etc1_src->lsb);
-	switch (block_mode) {
-		default:
-			// TODO: Return an error code?
-			assert(!"Invalid ETC2 block mode.");
-			memset(tileBuf, 0, 4*4*sizeof(uint32_t));
-			break;
-
-		case etc2_block_mode::ETC1: {
+	uint16_t px_msb = blk.px_msb;
+	uint16_t px_lsb = blk.px_lsb;
+	switch (blk.mode) {
+		case ImageDecoderPrivate::etc_rgb_block_t::Mode::ETC1: {
 			// ETC1 block mode.
 
 			// Intensities for the table codewords.
 			const int16_t *tbl[2];
-			if ((mode & ETC2_DM_A1) && !(etc1_src->control & 0x02)) {
+			if (blk.punchthrough) {
 				// ETC2, punchthrough alpha: Opaque bit is unset.
-				tbl[0] = etc2_intensity_a1[ etc1_src->control >> 5];
-				tbl[1] = etc2_intensity_a1[(etc1_src->control >> 2) & 0x07];
+				tbl[0] = etc2_intensity_a1[blk.tbl_idx[0]];
+				tbl[1] = etc2_intensity_a1[blk.tbl_idx[1]];
 			} else {
 				// All other versions.
-				tbl[0] = etc1_intensity[ etc1_src->control >> 5];
-				tbl[1] = etc1_intensity[(etc1_src->control >> 2) & 0x07];
+				tbl[0] = etc1_intensity[blk.tbl_idx[0]];
+				tbl[1] = etc1_intensity[blk.tbl_idx[1]];
 			}
 
 			// control, bit 0: flip
-			uint16_t subblock = etc1_subblock_mapping[etc1_src->control & 0x01];
+			uint16_t subblock = etc1_subblock_mapping[blk.flip];
 			for (unsigned int i = 0; i < 16; i++, px_msb >>= 1, px_lsb >>= 1, subblock >>= 1) {
 				uint32_t *const p = &tileBuf[etc1_mapping[i]];
 				const unsigned int px_idx = ((px_msb & 1) << 1) | (px_lsb & 1);
 
-				if ((mode & ETC2_DM_A1) && !(etc1_src->control & 0x02)) {
+				if ((mode & ImageDecoderPrivate::ETC2_DM_A1) && blk.punchthrough) {
 					// ETC2 punchthrough alpha: opaque bit is 0.
 					if (px_idx == 2) {
 						// Pixel is completely transparent.
@@ -534,10 +574,10 @@ static void decodeBlock_ETC_RGB(uint32_t tileBuf[4*4], const etc1_block *etc1_sr
 				// Select the table codeword based on the current subblock.
 				const uint8_t cur_sub = subblock & 1;
 				const int adj = tbl[cur_sub][px_idx];
-				ColorRGB color = base_color[cur_sub];
-				color.R += adj;
-				color.G += adj;
-				color.B += adj;
+				ColorRGB color;
+				color.R = blk.base_color[cur_sub][2] + adj;
+				color.G = blk.base_color[cur_sub][1] + adj;
+				color.B = blk.base_color[cur_sub][0] + adj;
 
 				// Clamp the color components and save it to the tile buffer.
 				*p = clamp_ColorRGB(color);
@@ -545,13 +585,13 @@ static void decodeBlock_ETC_RGB(uint32_t tileBuf[4*4], const etc1_block *etc1_sr
 			break;
 		}
 
-		case etc2_block_mode::TH: {
+		case ImageDecoderPrivate::etc_rgb_block_t::Mode::TH: {
 			// ETC2 'T' or 'H' mode.
 			for (unsigned int i = 0; i < 16; i++, px_msb >>= 1, px_lsb >>= 1) {
 				uint32_t *const p = &tileBuf[etc1_mapping[i]];
 				const unsigned int px_idx = ((px_msb & 1) << 1) | (px_lsb & 1);
 
-				if ((mode & ETC2_DM_A1) && !(etc1_src->control & 0x02)) {
+				if ((mode & ImageDecoderPrivate::ETC2_DM_A1) && blk.punchthrough) {
 					// ETC2 punchthrough alpha: opaque bit is 0.
 					if (px_idx == 2) {
 						// Pixel is completely transparent.
@@ -561,12 +601,12 @@ static void decodeBlock_ETC_RGB(uint32_t tileBuf[4*4], const etc1_block *etc1_sr
 				}
 
 				// Pixel index indicates the paint color to use.
-				*p = paint_color[px_idx];
+				*p = blk.paint_color[px_idx];
 			}
 			break;
 		}
 
-		case etc2_block_mode::Planar: {
+		case ImageDecoderPrivate::etc_rgb_block_t::Mode::Planar: {
 			// ETC2 'Planar' mode.
 			// Each pixel is interpolated using the three RGB676 colors.
 			for (unsigned int i = 0; i < 16; i++) {
@@ -578,15 +618,15 @@ static void decodeBlock_ETC_RGB(uint32_t tileBuf[4*4], const etc1_block *etc1_sr
 				// Color order: 0, 1, 2 => 'O', 'H', 'V'
 				// TODO: SIMD optimization?
 				ColorRGB tmp;
-				tmp.R = ((pX * (base_color[1].R - base_color[0].R)) +
-					 (pY * (base_color[2].R - base_color[0].R)) +
-					  (4 *  base_color[0].R) + 2) >> 2;
-				tmp.G = ((pX * (base_color[1].G - base_color[0].G)) +
-					 (pY * (base_color[2].G - base_color[0].G)) +
-					  (4 *  base_color[0].G) + 2) >> 2;
-				tmp.B = ((pX * (base_color[1].B - base_color[0].B)) +
-					 (pY * (base_color[2].B - base_color[0].B)) +
-					  (4 *  base_color[0].B) + 2) >> 2;
+				tmp.R = ((pX * (blk.base_color[1][2] - blk.base_color[0][2])) +
+					 (pY * (blk.base_color[2][2] - blk.base_color[0][2])) +
+					  (4 *  blk.base_color[0][2]) + 2) >> 2;
+				tmp.G = ((pX * (blk.base_color[1][1] - blk.base_color[0][1])) +
+					 (pY * (blk.base_color[2][1] - blk.base_color[0][1])) +
+					  (4 *  blk.base_color[0][1]) + 2) >> 2;
+				tmp.B = ((pX * (blk.base_color[1][0] - blk.base_color[0][0])) +
+					 (pY * (blk.base_color[2][0] - blk.base_color[0][0])) +
+					  (4 *  blk.base_color[0][0]) + 2) >> 2;
 
 				// Clamp the color components and save it to the tile buffer.
 				tileBuf[etc1_mapping[i]] = clamp_ColorRGB(tmp);
@@ -598,13 +638,14 @@ static void decodeBlock_ETC_RGB(uint32_t tileBuf[4*4], const etc1_block *etc1_sr
 
 /**
  * Convert an ETC1 image to rp_image.
+ * Single-threaded version. (See decodeBlocks_mt().)
  * @param width Image width.
  * @param height Image height.
  * @param img_buf ETC1 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromETC1(int width, int height,
+static rp_image *fromETC1_st(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -644,7 +685,7 @@ rp_image *fromETC1(int width, int height,
 	for (unsigned int y = 0; y < tilesY; y++) {
 	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
 		// Decode the ETC1 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC1>(tileBuf, etc1_src);
+		decodeBlock_ETC_RGB<ImageDecoderPrivate::ETC_DM_ETC1>(tileBuf, etc1_src);
 
 		// Blit the tile to the main image buffer.
 		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
@@ -658,15 +699,31 @@ rp_image *fromETC1(int width, int height,
 	return img;
 }
 
+/**
+ * Convert an ETC1 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromETC1_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromETC1_st, 8,
+		width, height, img_buf, img_siz);
+}
+
 /**
  * Convert an ETC2 RGB image to rp_image.
+ * Single-threaded version. (See decodeBlocks_mt().)
  * @param width Image width.
  * @param height Image height.
  * @param img_buf ETC2 RGB image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromETC2_RGB(int width, int height,
+static rp_image *fromETC2_RGB_st(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -706,7 +763,7 @@ rp_image *fromETC2_RGB(int width, int height,
 	for (unsigned int y = 0; y < tilesY; y++) {
 	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
 		// Decode the ETC2 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC2>(tileBuf, etc1_src);
+		decodeBlock_ETC_RGB<ImageDecoderPrivate::ETC_DM_ETC2>(tileBuf, etc1_src);
 
 		// Blit the tile to the main image buffer.
 		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
@@ -720,6 +777,21 @@ rp_image *fromETC2_RGB(int width, int height,
 	return img;
 }
 
+/**
+ * Convert an ETC2 RGB image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromETC2_RGB_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromETC2_RGB_st, 8,
+		width, height, img_buf, img_siz);
+}
+
 /**
  * Decode an ETC2 alpha block.
  * @param tileBuf	[out] Destination tile buffer.
@@ -762,13 +834,14 @@ static void decodeBlock_ETC2_alpha(uint32_t tileBuf[4*4], const etc2_alpha *alph
 
 /**
  * Convert an ETC2 RGBA image to rp_image.
+ * Single-threaded version. (See decodeBlocks_mt().)
  * @param width Image width.
  * @param height Image height.
  * @param img_buf ETC2 RGBA image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromETC2_RGBA(int width, int height,
+static rp_image *fromETC2_RGBA_st(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -808,7 +881,7 @@ rp_image *fromETC2_RGBA(int width, int height,
 	for (unsigned int y = 0; y < tilesY; y++) {
 	for (unsigned int x = 0; x < tilesX; x++, etc2_src++) {
 		// Decode the ETC2 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC2>(tileBuf, &etc2_src->etc1);
+		decodeBlock_ETC_RGB<ImageDecoderPrivate::ETC_DM_ETC2>(tileBuf, &etc2_src->etc1);
 
 		// Decode the ETC2 alpha block.
 		// TODO: Don't fill in the alpha channel in decodeBlock_ETC2_RGB()?
@@ -826,15 +899,31 @@ rp_image *fromETC2_RGBA(int width, int height,
 	return img;
 }
 
+/**
+ * Convert an ETC2 RGBA image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGBA image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromETC2_RGBA_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromETC2_RGBA_st, 16,
+		width, height, img_buf, img_siz);
+}
+
 /**
  * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * Single-threaded version. (See decodeBlocks_mt().)
  * @param width Image width.
  * @param height Image height.
  * @param img_buf ETC2 RGB+A1 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromETC2_RGB_A1(int width, int height,
+static rp_image *fromETC2_RGB_A1_st(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -874,7 +963,7 @@ rp_image *fromETC2_RGB_A1(int width, int height,
 	for (unsigned int y = 0; y < tilesY; y++) {
 	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
 		// Decode the ETC2 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC2 | ETC2_DM_A1>(tileBuf, etc1_src);
+		decodeBlock_ETC_RGB<ImageDecoderPrivate::ETC_DM_ETC2 | ImageDecoderPrivate::ETC2_DM_A1>(tileBuf, etc1_src);
 
 		// Blit the tile to the main image buffer.
 		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
@@ -888,4 +977,19 @@ rp_image *fromETC2_RGB_A1(int width, int height,
 	return img;
 }
 
+/**
+ * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB+A1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromETC2_RGB_A1_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromETC2_RGB_A1_st, 8,
+		width, height, img_buf, img_siz);
+}
+
 } }
@@ -0,0 +1,510 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_ETC1.cpp: Image decoding functions. (ETC1)                 *
+ * SSE4.1-optimized version.                                               *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// SSE4.1 headers.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <smmintrin.h>
+
+// MSVC complains when the high bit is set in hex values
+// when setting SSE2 registers.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4309)
+#endif
+
+// NOTE: The output of these functions must be identical to
+// the standard versions in ImageDecoder_ETC1.cpp.
+//
+// Block parameters are decoded using ImageDecoderPrivate::ETC_decodeBlock(),
+// which is shared with the standard version. Palettes are built using
+// saturated 16-bit arithmetic (PACKUSWB clamps to [0,255], same as
+// clamp_ColorRGB()), and pixels are looked up one tile row at a time
+// using PSHUFB. Output is written directly to the image in row-major
+// order, so no intermediate tile buffer is needed.
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Intensity modifier sets, expanded for 16-bit SIMD lanes.
+ * Each table has four B,G,R,A entries. Alpha is never modified.
+ * Values are the same as etc1_intensity[] in ImageDecoder_ETC1.cpp.
+ */
+#define ETC1_INTENSITY_V(a, b) { \
+	 (a), (a), (a), 0,   (b),  (b),  (b), 0, \
+	-(a),-(a),-(a), 0,  -(b), -(b), -(b), 0 }
+static const int16_t etc1_intensity_v[8][16] = {
+	ETC1_INTENSITY_V( 2,   8),
+	ETC1_INTENSITY_V( 5,  17),
+	ETC1_INTENSITY_V( 9,  29),
+	ETC1_INTENSITY_V(13,  42),
+	ETC1_INTENSITY_V(18,  60),
+	ETC1_INTENSITY_V(24,  80),
+	ETC1_INTENSITY_V(33, 106),
+	ETC1_INTENSITY_V(47, 183),
+};
+
+/**
+ * Intensity modifier sets, expanded for 16-bit SIMD lanes.
+ * (ETC2 with punchthrough alpha if opaque == 0)
+ * Values are the same as etc2_intensity_a1[] in ImageDecoder_ETC1.cpp.
+ */
+static const int16_t etc2_intensity_a1_v[8][16] = {
+	ETC1_INTENSITY_V(0,   8),
+	ETC1_INTENSITY_V(0,  17),
+	ETC1_INTENSITY_V(0,  29),
+	ETC1_INTENSITY_V(0,  42),
+	ETC1_INTENSITY_V(0,  60),
+	ETC1_INTENSITY_V(0,  80),
+	ETC1_INTENSITY_V(0, 106),
+	ETC1_INTENSITY_V(0, 183),
+};
+
+// ETC2 alpha modifiers table.
+// Values are the same as etc2_alpha_tbl[] in ImageDecoder_ETC1.cpp.
+static const int8_t etc2_alpha_tbl[16][8] = {
+	{-3, -6,  -9, -15, 2, 5, 8, 14},
+	{-3, -7, -10, -13, 2, 6, 9, 12},
+	{-2, -5,  -8, -13, 1, 4, 7, 12},
+	{-2, -4,  -6, -13, 1, 3, 5, 12},
+	{-3, -6,  -8, -12, 2, 5, 7, 11},
+	{-3, -7,  -9, -11, 2, 6, 8, 10},
+	{-4, -7,  -8, -11, 3, 6, 7, 10},
+	{-3, -5,  -8, -11, 2, 4, 7, 10},
+	{-2, -6,  -8, -10, 1, 5, 7,  9},
+	{-2, -5,  -8, -10, 1, 4, 7,  9},
+	{-2, -4,  -8, -10, 1, 3, 7,  9},
+	{-2, -5,  -7, -10, 1, 4, 6,  9},
+	{-3, -4,  -7, -10, 2, 3, 6,  9},
+	{-1, -2,  -3, -10, 0, 1, 2,  9},
+	{-4, -6,  -8,  -9, 3, 5, 7,  8},
+	{-3, -5,  -7,  -9, 2, 4, 6,  8},
+};
+
+// Selects the bytes for each pixel in a tile row.
+static const uint8_t pxsel_row[4][16] = {
+	{ 0, 0, 0, 0,  1, 1, 1, 1,  2, 2, 2, 2,  3, 3, 3, 3},
+	{ 4, 4, 4, 4,  5, 5, 5, 5,  6, 6, 6, 6,  7, 7, 7, 7},
+	{ 8, 8, 8, 8,  9, 9, 9, 9, 10,10,10,10, 11,11,11,11},
+	{12,12,12,12, 13,13,13,13, 14,14,14,14, 15,15,15,15},
+};
+
+// Selects one byte per pixel into the alpha channel.
+static const uint8_t alpha_sel[4][16] = {
+	{0x80,0x80,0x80, 0, 0x80,0x80,0x80, 1, 0x80,0x80,0x80, 2, 0x80,0x80,0x80, 3},
+	{0x80,0x80,0x80, 4, 0x80,0x80,0x80, 5, 0x80,0x80,0x80, 6, 0x80,0x80,0x80, 7},
+	{0x80,0x80,0x80, 8, 0x80,0x80,0x80, 9, 0x80,0x80,0x80,10, 0x80,0x80,0x80,11},
+	{0x80,0x80,0x80,12, 0x80,0x80,0x80,13, 0x80,0x80,0x80,14, 0x80,0x80,0x80,15},
+};
+
+// ETC1 arranges pixels by column, then by row.
+// This table maps it back to linear.
+static const uint8_t etc1_mapping[16] = {
+	0, 4,  8, 12,
+	1, 5,  9, 13,
+	2, 6, 10, 14,
+	3, 7, 11, 15,
+};
+
+/**
+ * Load a constant 16-byte vector.
+ * @param p Pointer to the constant.
+ * @return Vector.
+ */
+static FORCEINLINE __m128i load_const(const void *p)
+{
+	return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+/**
+ * Expand the 2-bit pixel indexes of an ETC1/ETC2 RGB block.
+ * @param etc1_blk	[in] ETC1/ETC2 RGB block in the low 8 bytes.
+ * @return Palette byte offsets (index * 4) for each pixel, in row-major order.
+ */
+static FORCEINLINE __m128i ETC_indexes(__m128i etc1_blk)
+{
+	// Pixel index bits are stored in ETC1 order (columns, then rows)
+	// as two big-endian 16-bit values: MSBs in bytes 4-5; LSBs in bytes 6-7.
+	// For row-major pixel (x,y), the ETC1 bit number is (x*4)+y.
+	// Bits 0-7 are in the second byte; bits 8-15 are in the first byte.
+	const __m128i msb_sel = _mm_setr_epi8(5,5,4,4, 5,5,4,4, 5,5,4,4, 5,5,4,4);
+	const __m128i lsb_sel = _mm_setr_epi8(7,7,6,6, 7,7,6,6, 7,7,6,6, 7,7,6,6);
+	const __m128i bitmask = _mm_setr_epi8(
+		0x01,0x10,0x01,0x10, 0x02,0x20,0x02,0x20,
+		0x04,0x40,0x04,0x40, 0x08,0x80,0x08,0x80);
+
+	const __m128i msb = _mm_cmpeq_epi8(_mm_and_si128(_mm_shuffle_epi8(etc1_blk, msb_sel), bitmask), bitmask);
+	const __m128i lsb = _mm_cmpeq_epi8(_mm_and_si128(_mm_shuffle_epi8(etc1_blk, lsb_sel), bitmask), bitmask);
+	return _mm_or_si128(_mm_and_si128(msb, _mm_set1_epi8(8)), _mm_and_si128(lsb, _mm_set1_epi8(4)));
+}
+
+/**
+ * Build an ETC1-mode subblock palette.
+ * @param base_color	[in] Base color. (B,G,R,A; 16-bit)
+ * @param tbl		[in] Intensity modifier table. (16-bit)
+ * @return Palette. (four ARGB32 entries)
+ */
+static FORCEINLINE __m128i ETC1_palette(const int16_t base_color[4], const int16_t tbl[16])
+{
+	__m128i base = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(base_color));
+	base = _mm_unpacklo_epi64(base, base);
+	const __m128i lo = _mm_add_epi16(base, load_const(&tbl[0]));
+	const __m128i hi = _mm_add_epi16(base, load_const(&tbl[8]));
+	// PACKUSWB clamps each component to [0,255].
+	return _mm_packus_epi16(lo, hi);
+}
+
+/**
+ * Decode an ETC1/ETC2 RGB block.
+ * @tparam mode		[in] Mode flags. (See ETC_Decoding_Mode)
+ * @param rows		[out] Tile rows. (four ARGB32 pixels each)
+ * @param etc1_src	[in] Source RGB block. (8 bytes)
+ */
+template</* ETC_Decoding_Mode */ unsigned int mode>
+static FORCEINLINE void T_decodeBlock_ETC_RGB(__m128i rows[4], const uint8_t *RESTRICT etc1_src)
+{
+	// Prevent invalid combinations from being used.
+	static_assert(mode != (ImageDecoderPrivate::ETC_DM_ETC1 | ImageDecoderPrivate::ETC2_DM_A1),
+		"Cannot use ETC1 with punchthrough alpha.");
+
+	// Decode the block parameters.
+	ImageDecoderPrivate::etc_rgb_block_t blk;
+	ImageDecoderPrivate::ETC_decodeBlock(&blk, etc1_src, mode);
+
+	if (blk.mode == ImageDecoderPrivate::etc_rgb_block_t::Mode::Planar) {
+		// ETC2 'Planar' mode.
+		// Each pixel is interpolated using the three RGB676 colors:
+		// c = ((x * (H - O)) + (y * (V - O)) + (4 * O) + 2) >> 2
+		// Alpha is 255 in all three colors, so it's always 255 here.
+		const __m128i O = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(blk.base_color[0]));
+		const __m128i H = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(blk.base_color[1]));
+		const __m128i V = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(blk.base_color[2]));
+		__m128i dH = _mm_sub_epi16(H, O);
+		__m128i dV = _mm_sub_epi16(V, O);
+		dV = _mm_unpacklo_epi64(dV, dV);
+		// Pixels 0 and 1 start with 0*dH and 1*dH; pixels 2 and 3 add 2*dH.
+		const __m128i dH01 = _mm_slli_si128(dH, 8);
+		dH = _mm_unpacklo_epi64(dH, dH);
+		const __m128i dH2 = _mm_add_epi16(dH, dH);
+
+		__m128i rowBase = _mm_add_epi16(_mm_slli_epi16(O, 2), _mm_set1_epi16(2));
+		rowBase = _mm_add_epi16(_mm_unpacklo_epi64(rowBase, rowBase), dH01);
+		for (unsigned int y = 0; y < 4; y++, rowBase = _mm_add_epi16(rowBase, dV)) {
+			const __m128i px01 = _mm_srai_epi16(rowBase, 2);
+			const __m128i px23 = _mm_srai_epi16(_mm_add_epi16(rowBase, dH2), 2);
+			rows[y] = _mm_packus_epi16(px01, px23);
+		}
+		return;
+	}
+
+	// ETC1 and 'T'/'H' modes use palette lookups.
+	__m128i pal0, pal1;
+	if (blk.mode == ImageDecoderPrivate::etc_rgb_block_t::Mode::ETC1) {
+		const int16_t (*const tbl)[16] = (blk.punchthrough ? etc2_intensity_a1_v : etc1_intensity_v);
+		pal0 = ETC1_palette(blk.base_color[0], tbl[blk.tbl_idx[0]]);
+		pal1 = ETC1_palette(blk.base_color[1], tbl[blk.tbl_idx[1]]);
+	} else /*if (blk.mode == ImageDecoderPrivate::etc_rgb_block_t::Mode::TH)*/ {
+		pal0 = load_const(blk.paint_color);
+		pal1 = pal0;
+	}
+
+	if ((mode & ImageDecoderPrivate::ETC2_DM_A1) && blk.punchthrough) {
+		// ETC2 punchthrough alpha: opaque bit is 0.
+		// Pixel index 2 is completely transparent.
+		const __m128i mask = _mm_setr_epi32(-1, -1, 0, -1);
+		pal0 = _mm_and_si128(pal0, mask);
+		pal1 = _mm_and_si128(pal1, mask);
+	}
+
+	// Tile arrangement:
+	// flip == 0        flip == 1
+	// a e | i m        a e   i m
+	// b f | j n        b f   j n
+	//     |            ---------
+	// c g | k o        c g   k o
+	// d h | l p        d h   l p
+	const __m128i idx4 = ETC_indexes(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(etc1_src)));
+	const __m128i chanOff = _mm_setr_epi8(0,1,2,3, 0,1,2,3, 0,1,2,3, 0,1,2,3);
+	const __m128i sub_flip0 = _mm_setr_epi32(0, 0, -1, -1);
+	for (unsigned int y = 0; y < 4; y++) {
+		const __m128i sel = _mm_add_epi8(_mm_shuffle_epi8(idx4, load_const(pxsel_row[y])), chanOff);
+		const __m128i px0 = _mm_shuffle_epi8(pal0, sel);
+		const __m128i px1 = _mm_shuffle_epi8(pal1, sel);
+		const __m128i sub = (blk.flip
+			? (y >= 2 ? _mm_set1_epi32(-1) : _mm_setzero_si128())
+			: sub_flip0);
+		rows[y] = _mm_blendv_epi8(px0, px1, sub);
+	}
+}
+
+/**
+ * Decode an ETC2 alpha block.
+ * @param alpha_src	[in] Source alpha block. (8 bytes)
+ * @return Alpha values, one byte per pixel, in row-major order.
+ */
+static FORCEINLINE __m128i decodeBlock_ETC2_alpha(const uint8_t *RESTRICT alpha_src)
+{
+	// Get the base codeword and multiplier.
+	// NOTE: mult == 0 is not allowed to be used by the encoder,
+	// but the specification requires decoders to handle it.
+	const uint8_t base = alpha_src[0];
+	const uint8_t mult = (alpha_src[1] >> 4);
+
+	// Build the 8-entry alpha palette.
+	// PACKUSWB clamps the values to [0,255].
+	const __m128i tbl = _mm_cvtepi8_epi16(_mm_loadl_epi64(
+		reinterpret_cast<const __m128i*>(etc2_alpha_tbl[alpha_src[1] & 0x0F])));
+	__m128i pal = _mm_add_epi16(_mm_mullo_epi16(tbl, _mm_set1_epi16(mult)), _mm_set1_epi16(base));
+	pal = _mm_packus_epi16(pal, pal);
+
+	// Extract the 3-bit codes.
+	// Codes are stored as a 48-bit big-endian value in bytes 2-7,
+	// with the first pixel in the most significant bits.
+	// Each 16-bit lane gets the two bytes containing the code,
+	// which is then shifted into place using multiplication.
+	const __m128i blk = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(alpha_src));
+	const __m128i shift = _mm_setr_epi16(8, 64, 512, 16, 128, 1024, 32, 256);
+	__m128i lo = _mm_shuffle_epi8(blk, _mm_setr_epi8(3,2, 3,2, 3,2, 4,3, 4,3, 4,3, 5,4, 5,4));
+	__m128i hi = _mm_shuffle_epi8(blk, _mm_setr_epi8(6,5, 6,5, 6,5, 7,6, 7,6, 7,6, -1,7, -1,7));
+	const __m128i mask3 = _mm_set1_epi16(7);
+	lo = _mm_and_si128(_mm_mulhi_epu16(lo, shift), mask3);
+	hi = _mm_and_si128(_mm_mulhi_epu16(hi, shift), mask3);
+	__m128i codes = _mm_packus_epi16(lo, hi);
+
+	// Convert from ETC1 order to row-major order.
+	codes = _mm_shuffle_epi8(codes, load_const(etc1_mapping));
+	return _mm_shuffle_epi8(pal, codes);
+}
+
+/**
+ * Convert an ETC1/ETC2 image to rp_image.
+ * @tparam mode		[in] Mode flags. (See ETC_Decoding_Mode)
+ * @tparam hasAlpha	[in] If true, each block has an ETC2 alpha block. (RGBA)
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC1/ETC2 image buffer.
+ * @param img_siz Size of image data. [RGB: must be >= (w*h)/2; RGBA: must be >= (w*h)]
+ * @param sBIT sBIT metadata.
+ * @return rp_image, or nullptr on error.
+ */
+template</* ETC_Decoding_Mode */ unsigned int mode, bool hasAlpha>
+static rp_image *T_fromETC_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const rp_image::sBIT_t *sBIT)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	const int minSize = (hasAlpha ? (width * height) : ((width * height) / 2));
+	assert(img_siz >= minSize);
+	if (!img_buf || width <= 0 || height <= 0 || img_siz < minSize) {
+		return nullptr;
+	}
+
+	// ETC1/ETC2 uses 4x4 tiles.
+	assert(width % 4 == 0);
+	assert(height % 4 == 0);
+	if (width % 4 != 0 || height % 4 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+	uint8_t *const bits = static_cast<uint8_t*>(img->bits());
+	const int stride = img->stride();
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
+
+	// RGBA blocks have the alpha block first.
+	static const unsigned int blockSize = (hasAlpha ? 16 : 8);
+	const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+
+	const uint8_t *src = img_buf;
+	for (unsigned int y = 0; y < tilesY; y++) {
+		uint8_t *pDestTile = bits + (y * 4 * stride);
+	for (unsigned int x = 0; x < tilesX; x++, src += blockSize, pDestTile += 16) {
+		// Decode the ETC1/ETC2 RGB block.
+		__m128i rows[4];
+		T_decodeBlock_ETC_RGB<mode>(rows, (hasAlpha ? src + 8 : src));
+
+		if (hasAlpha) {
+			// Decode the ETC2 alpha block.
+			const __m128i alpha = decodeBlock_ETC2_alpha(src);
+			for (unsigned int row = 0; row < 4; row++) {
+				rows[row] = _mm_or_si128(_mm_and_si128(rows[row], rgbMask),
+					_mm_shuffle_epi8(alpha, load_const(alpha_sel[row])));
+			}
+		}
+
+		// Write the tile rows to the image.
+		uint8_t *pDest = pDestTile;
+		for (unsigned int row = 0; row < 4; row++, pDest += stride) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), rows[row]);
+		}
+	} }
+
+	// Set the sBIT metadata.
+	img->set_sBIT(sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert an ETC1 image to rp_image.
+ * SSE4.1-optimized version.
+ * Single-threaded version. (See decodeBlocks_mt().)
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+static rp_image *fromETC1_st(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,0};
+	return T_fromETC_sse41<ImageDecoderPrivate::ETC_DM_ETC1, false>(
+		width, height, img_buf, img_siz, &sBIT);
+}
+
+/**
+ * Convert an ETC1 image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromETC1_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromETC1_st, 8,
+		width, height, img_buf, img_siz);
+}
+
+/**
+ * Convert an ETC2 RGB image to rp_image.
+ * SSE4.1-optimized version.
+ * Single-threaded version. (See decodeBlocks_mt().)
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+static rp_image *fromETC2_RGB_st(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,0};
+	return T_fromETC_sse41<ImageDecoderPrivate::ETC_DM_ETC2, false>(
+		width, height, img_buf, img_siz, &sBIT);
+}
+
+/**
+ * Convert an ETC2 RGB image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromETC2_RGB_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromETC2_RGB_st, 8,
+		width, height, img_buf, img_siz);
+}
+
+/**
+ * Convert an ETC2 RGBA image to rp_image.
+ * SSE4.1-optimized version.
+ * Single-threaded version. (See decodeBlocks_mt().)
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGBA image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+static rp_image *fromETC2_RGBA_st(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+	return T_fromETC_sse41<ImageDecoderPrivate::ETC_DM_ETC2, true>(
+		width, height, img_buf, img_siz, &sBIT);
+}
+
+/**
+ * Convert an ETC2 RGBA image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGBA image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromETC2_RGBA_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromETC2_RGBA_st, 16,
+		width, height, img_buf, img_siz);
+}
+
+/**
+ * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * SSE4.1-optimized version.
+ * Single-threaded version. (See decodeBlocks_mt().)
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB+A1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+static rp_image *fromETC2_RGB_A1_st(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
+	return T_fromETC_sse41<ImageDecoderPrivate::ETC_DM_ETC2 | ImageDecoderPrivate::ETC2_DM_A1, false>(
+		width, height, img_buf, img_siz, &sBIT);
+}
+
+/**
+ * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB+A1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromETC2_RGB_A1_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromETC2_RGB_A1_st, 8,
+		width, height, img_buf, img_siz);
+}
+
+} }
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
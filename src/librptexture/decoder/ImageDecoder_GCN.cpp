@@ -17,6 +17,7 @@ namespace LibRpTexture { namespace ImageDecoder {
 
 /**
  * Convert a GameCube 16-bit image to rp_image.
+ * Standard version using regular C++ code.
  * @param px_format 16-bit pixel format.
  * @param width Image width.
  * @param height Image height.
@@ -24,7 +25,7 @@ namespace LibRpTexture { namespace ImageDecoder {
  * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromGcn16(PixelFormat px_format,
+rp_image *fromGcn16_cpp(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz)
 {
@@ -138,6 +139,7 @@ rp_image *fromGcn16(PixelFormat px_format,
 
 /**
  * Convert a GameCube CI8 image to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf CI8 image buffer.
@@ -146,7 +148,7 @@ rp_image *fromGcn16(PixelFormat px_format,
  * @param pal_siz Size of palette data. [must be >= 256*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromGcnCI8(int width, int height,
+rp_image *fromGcnCI8_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz,
 	const uint16_t *RESTRICT pal_buf, int pal_siz)
 {
@@ -231,6 +233,7 @@ rp_image *fromGcnCI8(int width, int height,
 
 /**
  * Convert a GameCube I8 image to rp_image.
+ * Standard version using regular C++ code.
  * NOTE: Uses a grayscale palette.
  * FIXME: Needs verification.
  * @param width Image width.
@@ -239,7 +242,7 @@ rp_image *fromGcnCI8(int width, int height,
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromGcnI8(int width, int height,
+rp_image *fromGcnI8_cpp(int width, int height,
 	const uint8_t *img_buf, int img_siz)
 {
 	// Verify parameters.
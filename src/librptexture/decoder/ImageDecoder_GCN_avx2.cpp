@@ -0,0 +1,258 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_GCN_avx2.cpp: Image decoding functions. (GameCube)         *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+// MSVC complains when the high bit is set in hex values
+// when setting SSE2 registers.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4309)
+#endif
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Templated function for GameCube 16-bit to ARGB32 conversion using AVX2.
+ * Converts one 4x4 tile. (16 big-endian pixels)
+ * @tparam px_format Pixel format. (RGB5A3, RGB565, or IA8)
+ * @param px16	[in] 16-bit pixels. (big-endian)
+ * @param px02	[out] Rows 0 and 2. (low and high lanes)
+ * @param px13	[out] Rows 1 and 3. (low and high lanes)
+ */
+template<PixelFormat px_format>
+static FORCEINLINE void T_gcn16_to_ARGB32_avx2(__m256i px16, __m256i &px02, __m256i &px13)
+{
+	if (px_format == PXF_IA8) {
+		// IA8: IIIIIIII AAAAAAAA (big-endian, so I is the first byte)
+		// The output pixel is {I, I, I, A} in memory order,
+		// so it can be built directly from the source bytes.
+		const __m256i shuf_lo = _mm256_setr_epi8(
+			0,0,0,1, 2,2,2,3, 4,4,4,5, 6,6,6,7,
+			0,0,0,1, 2,2,2,3, 4,4,4,5, 6,6,6,7);
+		const __m256i shuf_hi = _mm256_setr_epi8(
+			8,8,8,9, 10,10,10,11, 12,12,12,13, 14,14,14,15,
+			8,8,8,9, 10,10,10,11, 12,12,12,13, 14,14,14,15);
+		px02 = _mm256_shuffle_epi8(px16, shuf_lo);
+		px13 = _mm256_shuffle_epi8(px16, shuf_hi);
+		return;
+	}
+
+	// Byteswap the pixels.
+	const __m256i shuf_bswap = _mm256_setr_epi8(
+		1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14,
+		1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14);
+	px16 = _mm256_shuffle_epi8(px16, shuf_bswap);
+
+	const __m256i Mask5 = _mm256_set1_epi16(0x00F8);
+	__m256i sAR, sGB;
+
+	switch (px_format) {
+		default:
+			assert(!"Unsupported pixel format.");
+			// fall-through
+		case PXF_RGB565: {
+			// RGB565: RRRRRGGG GGGBBBBB
+			__m256i sR = _mm256_and_si256(_mm256_srli_epi16(px16, 8), Mask5);
+			__m256i sG = _mm256_and_si256(_mm256_srli_epi16(px16, 3), _mm256_set1_epi16(0x00FC));
+			__m256i sB = _mm256_and_si256(_mm256_slli_epi16(px16, 3), Mask5);
+			sR = _mm256_or_si256(sR, _mm256_srli_epi16(sR, 5));
+			sG = _mm256_or_si256(sG, _mm256_srli_epi16(sG, 6));
+			sB = _mm256_or_si256(sB, _mm256_srli_epi16(sB, 5));
+			sAR = _mm256_or_si256(sR, _mm256_set1_epi16(0xFF00));
+			sGB = _mm256_or_si256(sB, _mm256_slli_epi16(sG, 8));
+			break;
+		}
+
+		case PXF_RGB5A3: {
+			// RGB5A3: 1RRRRRGG GGGBBBBB (opaque)
+			//         0AAARRRR GGGGBBBB (translucent)
+			// Convert both formats, then select based on bit 15.
+			const __m256i opaque = _mm256_srai_epi16(px16, 15);
+
+			// RGB555
+			__m256i sR5 = _mm256_and_si256(_mm256_srli_epi16(px16, 7), Mask5);
+			__m256i sG5 = _mm256_and_si256(_mm256_srli_epi16(px16, 2), Mask5);
+			__m256i sB5 = _mm256_and_si256(_mm256_slli_epi16(px16, 3), Mask5);
+			sR5 = _mm256_or_si256(sR5, _mm256_srli_epi16(sR5, 5));
+			sG5 = _mm256_or_si256(sG5, _mm256_srli_epi16(sG5, 5));
+			sB5 = _mm256_or_si256(sB5, _mm256_srli_epi16(sB5, 5));
+
+			// RGB4A3
+			const __m256i Mask4 = _mm256_set1_epi16(0x000F);
+			__m256i sR4 = _mm256_and_si256(_mm256_srli_epi16(px16, 8), Mask4);
+			__m256i sG4 = _mm256_and_si256(_mm256_srli_epi16(px16, 4), Mask4);
+			__m256i sB4 = _mm256_and_si256(px16, Mask4);
+			sR4 = _mm256_or_si256(sR4, _mm256_slli_epi16(sR4, 4));
+			sG4 = _mm256_or_si256(sG4, _mm256_slli_epi16(sG4, 4));
+			sB4 = _mm256_or_si256(sB4, _mm256_slli_epi16(sB4, 4));
+			// A3 is expanded to 8-bit by bit replication: AAAAAAAA = aaa aaa aa
+			__m256i sA3 = _mm256_and_si256(_mm256_srli_epi16(px16, 12), _mm256_set1_epi16(0x0007));
+			sA3 = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(sA3, 5), _mm256_slli_epi16(sA3, 2)),
+				_mm256_srli_epi16(sA3, 1));
+
+			const __m256i sR = _mm256_blendv_epi8(sR4, sR5, opaque);
+			const __m256i sG = _mm256_blendv_epi8(sG4, sG5, opaque);
+			const __m256i sB = _mm256_blendv_epi8(sB4, sB5, opaque);
+			// Opaque pixels have all bits set in `opaque`, so alpha is 0xFF.
+			sAR = _mm256_or_si256(_mm256_slli_epi16(_mm256_or_si256(opaque, sA3), 8), sR);
+			sGB = _mm256_or_si256(_mm256_slli_epi16(sG, 8), sB);
+			break;
+		}
+	}
+
+	// Unpack AR and GB into DWORDs.
+	// NOTE: AVX2 unpack works within each 128-bit lane.
+	px02 = _mm256_unpacklo_epi16(sGB, sAR);
+	px13 = _mm256_unpackhi_epi16(sGB, sAR);
+}
+
+/**
+ * Templated function for GameCube 16-bit image decoding using AVX2.
+ * Two 4x4 tiles are converted per iteration, so each
+ * destination row is written with a single 32-byte store.
+ * @tparam px_format Pixel format. (RGB5A3, RGB565, or IA8)
+ * @param img		[in,out] Destination image.
+ * @param img_buf	[in] 16-bit image buffer.
+ */
+template<PixelFormat px_format>
+static inline void T_fromGcn16_avx2(rp_image *RESTRICT img, const uint16_t *RESTRICT img_buf)
+{
+	const unsigned int tilesX = static_cast<unsigned int>(img->width() / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(img->height() / 4);
+	const int dest_stride = img->stride() / sizeof(uint32_t);
+	uint32_t *px_dest_row = static_cast<uint32_t*>(img->bits());
+
+	for (unsigned int y = 0; y < tilesY; y++, px_dest_row += (dest_stride * 4)) {
+		uint32_t *px_dest = px_dest_row;
+		unsigned int x = tilesX;
+		for (; x > 1; x -= 2, px_dest += 8, img_buf += (4*4)*2) {
+			__m256i a02, a13, b02, b13;
+			T_gcn16_to_ARGB32_avx2<px_format>(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&img_buf[ 0])), a02, a13);
+			T_gcn16_to_ARGB32_avx2<px_format>(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&img_buf[16])), b02, b13);
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&px_dest[dest_stride*0]),
+				_mm256_permute2x128_si256(a02, b02, 0x20));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&px_dest[dest_stride*1]),
+				_mm256_permute2x128_si256(a13, b13, 0x20));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&px_dest[dest_stride*2]),
+				_mm256_permute2x128_si256(a02, b02, 0x31));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&px_dest[dest_stride*3]),
+				_mm256_permute2x128_si256(a13, b13, 0x31));
+		}
+
+		if (x == 1) {
+			// One tile left.
+			__m256i a02, a13;
+			T_gcn16_to_ARGB32_avx2<px_format>(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&img_buf[0])), a02, a13);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*0]),
+				_mm256_castsi256_si128(a02));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*1]),
+				_mm256_castsi256_si128(a13));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*2]),
+				_mm256_extracti128_si256(a02, 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*3]),
+				_mm256_extracti128_si256(a13, 1));
+			img_buf += (4*4);
+		}
+	}
+}
+
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * 2))
+	{
+		return nullptr;
+	}
+
+	// GameCube RGB5A3 uses 4x4 tiles.
+	assert(width % 4 == 0);
+	assert(height % 4 == 0);
+	if (width % 4 != 0 || height % 4 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	switch (px_format) {
+		case PXF_RGB5A3: {
+			T_fromGcn16_avx2<PXF_RGB5A3>(img, img_buf);
+			// Set the sBIT metadata.
+			// NOTE: Pixels may be RGB555 or ARGB4444.
+			// We'll use 555 for RGB, and 4 for alpha.
+			// TODO: Set alpha to 0 if no translucent pixels were found.
+			static const rp_image::sBIT_t sBIT = {5,5,5,0,4};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_RGB565: {
+			T_fromGcn16_avx2<PXF_RGB565>(img, img_buf);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,6,5,0,0};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_IA8: {
+			T_fromGcn16_avx2<PXF_IA8>(img, img_buf);
+			// Set the sBIT metadata.
+			// NOTE: Setting the grayscale value, though we're
+			// not saving grayscale PNGs at the moment.
+			static const rp_image::sBIT_t sBIT = {8,8,8,8,8};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		default:
+			assert(!"Invalid pixel format for this function.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+} }
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
@@ -0,0 +1,427 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_GCN_ssse3.cpp: Image decoding functions. (GameCube)        *
+ * SSSE3-optimized version.                                                *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// SSSE3 intrinsics.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+// MSVC complains when the high bit is set in hex values
+// when setting SSE2 registers.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4309)
+#endif
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Templated function for GameCube 16-bit to ARGB32 conversion using SSSE3.
+ * Converts 8 big-endian pixels, i.e. two rows of a 4x4 tile.
+ * @tparam px_format Pixel format. (RGB5A3, RGB565, or IA8)
+ * @param px16	[in] 16-bit pixels. (big-endian)
+ * @param px0	[out] First four ARGB32 pixels.
+ * @param px1	[out] Last four ARGB32 pixels.
+ */
+template<PixelFormat px_format>
+static FORCEINLINE void T_gcn16_to_ARGB32_ssse3(__m128i px16, __m128i &px0, __m128i &px1)
+{
+	if (px_format == PXF_IA8) {
+		// IA8: IIIIIIII AAAAAAAA (big-endian, so I is the first byte)
+		// The output pixel is {I, I, I, A} in memory order,
+		// so it can be built directly from the source bytes.
+		const __m128i shuf_lo = _mm_setr_epi8(0,0,0,1, 2,2,2,3, 4,4,4,5, 6,6,6,7);
+		const __m128i shuf_hi = _mm_setr_epi8(8,8,8,9, 10,10,10,11, 12,12,12,13, 14,14,14,15);
+		px0 = _mm_shuffle_epi8(px16, shuf_lo);
+		px1 = _mm_shuffle_epi8(px16, shuf_hi);
+		return;
+	}
+
+	// Byteswap the pixels.
+	const __m128i shuf_bswap = _mm_setr_epi8(1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14);
+	px16 = _mm_shuffle_epi8(px16, shuf_bswap);
+
+	const __m128i Mask5 = _mm_set1_epi16(0x00F8);
+	__m128i sAR, sGB;
+
+	switch (px_format) {
+		default:
+			assert(!"Unsupported pixel format.");
+			// fall-through
+		case PXF_RGB565: {
+			// RGB565: RRRRRGGG GGGBBBBB
+			__m128i sR = _mm_and_si128(_mm_srli_epi16(px16, 8), Mask5);
+			__m128i sG = _mm_and_si128(_mm_srli_epi16(px16, 3), _mm_set1_epi16(0x00FC));
+			__m128i sB = _mm_and_si128(_mm_slli_epi16(px16, 3), Mask5);
+			sR = _mm_or_si128(sR, _mm_srli_epi16(sR, 5));
+			sG = _mm_or_si128(sG, _mm_srli_epi16(sG, 6));
+			sB = _mm_or_si128(sB, _mm_srli_epi16(sB, 5));
+			sAR = _mm_or_si128(sR, _mm_set1_epi16(0xFF00));
+			sGB = _mm_or_si128(sB, _mm_slli_epi16(sG, 8));
+			break;
+		}
+
+		case PXF_RGB5A3: {
+			// RGB5A3: 1RRRRRGG GGGBBBBB (opaque)
+			//         0AAARRRR GGGGBBBB (translucent)
+			// Convert both formats, then select based on bit 15.
+			const __m128i opaque = _mm_srai_epi16(px16, 15);
+
+			// RGB555
+			__m128i sR5 = _mm_and_si128(_mm_srli_epi16(px16, 7), Mask5);
+			__m128i sG5 = _mm_and_si128(_mm_srli_epi16(px16, 2), Mask5);
+			__m128i sB5 = _mm_and_si128(_mm_slli_epi16(px16, 3), Mask5);
+			sR5 = _mm_or_si128(sR5, _mm_srli_epi16(sR5, 5));
+			sG5 = _mm_or_si128(sG5, _mm_srli_epi16(sG5, 5));
+			sB5 = _mm_or_si128(sB5, _mm_srli_epi16(sB5, 5));
+
+			// RGB4A3
+			const __m128i Mask4 = _mm_set1_epi16(0x000F);
+			__m128i sR4 = _mm_and_si128(_mm_srli_epi16(px16, 8), Mask4);
+			__m128i sG4 = _mm_and_si128(_mm_srli_epi16(px16, 4), Mask4);
+			__m128i sB4 = _mm_and_si128(px16, Mask4);
+			sR4 = _mm_or_si128(sR4, _mm_slli_epi16(sR4, 4));
+			sG4 = _mm_or_si128(sG4, _mm_slli_epi16(sG4, 4));
+			sB4 = _mm_or_si128(sB4, _mm_slli_epi16(sB4, 4));
+			// A3 is expanded to 8-bit by bit replication: AAAAAAAA = aaa aaa aa
+			__m128i sA3 = _mm_and_si128(_mm_srli_epi16(px16, 12), _mm_set1_epi16(0x0007));
+			sA3 = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(sA3, 5), _mm_slli_epi16(sA3, 2)),
+				_mm_srli_epi16(sA3, 1));
+
+			const __m128i sR = _mm_or_si128(_mm_and_si128(opaque, sR5), _mm_andnot_si128(opaque, sR4));
+			const __m128i sG = _mm_or_si128(_mm_and_si128(opaque, sG5), _mm_andnot_si128(opaque, sG4));
+			const __m128i sB = _mm_or_si128(_mm_and_si128(opaque, sB5), _mm_andnot_si128(opaque, sB4));
+			// Opaque pixels have all bits set in `opaque`, so alpha is 0xFF.
+			sAR = _mm_or_si128(_mm_slli_epi16(_mm_or_si128(opaque, sA3), 8), sR);
+			sGB = _mm_or_si128(_mm_slli_epi16(sG, 8), sB);
+			break;
+		}
+	}
+
+	// Unpack AR and GB into DWORDs.
+	px0 = _mm_unpacklo_epi16(sGB, sAR);
+	px1 = _mm_unpackhi_epi16(sGB, sAR);
+}
+
+/**
+ * Templated function for GameCube 16-bit image decoding using SSSE3.
+ * Each 4x4 tile is converted and stored one row at a time.
+ * @tparam px_format Pixel format. (RGB5A3, RGB565, or IA8)
+ * @param img		[in,out] Destination image.
+ * @param img_buf	[in] 16-bit image buffer.
+ */
+template<PixelFormat px_format>
+static inline void T_fromGcn16_ssse3(rp_image *RESTRICT img, const uint16_t *RESTRICT img_buf)
+{
+	const unsigned int tilesX = static_cast<unsigned int>(img->width() / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(img->height() / 4);
+	const int dest_stride = img->stride() / sizeof(uint32_t);
+	uint32_t *px_dest_row = static_cast<uint32_t*>(img->bits());
+
+	for (unsigned int y = 0; y < tilesY; y++, px_dest_row += (dest_stride * 4)) {
+		uint32_t *px_dest = px_dest_row;
+		for (unsigned int x = 0; x < tilesX; x++, px_dest += 4, img_buf += 4*4) {
+			__m128i row0, row1, row2, row3;
+			T_gcn16_to_ARGB32_ssse3<px_format>(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[0])), row0, row1);
+			T_gcn16_to_ARGB32_ssse3<px_format>(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[8])), row2, row3);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*0]), row0);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*1]), row1);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*2]), row2);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*3]), row3);
+		}
+	}
+}
+
+/**
+ * Untile a GameCube 8-bit image with 8x4 tiles using SSE2.
+ * Two tiles are processed per iteration so each
+ * destination row is written with a single 16-byte store.
+ * @param img		[in,out] Destination image. (CI8)
+ * @param img_buf	[in] 8-bit image buffer.
+ */
+static inline void untileGcn8x4_sse2(rp_image *RESTRICT img, const uint8_t *RESTRICT img_buf)
+{
+	const unsigned int tilesX = static_cast<unsigned int>(img->width() / 8);
+	const unsigned int tilesY = static_cast<unsigned int>(img->height() / 4);
+	const int dest_stride = img->stride();
+	uint8_t *px_dest_row = static_cast<uint8_t*>(img->bits());
+
+	for (unsigned int y = 0; y < tilesY; y++, px_dest_row += (dest_stride * 4)) {
+		uint8_t *px_dest = px_dest_row;
+		unsigned int x = tilesX;
+		for (; x > 1; x -= 2, px_dest += 16, img_buf += (8*4)*2) {
+			// Each 16-byte load contains two rows of one tile.
+			const __m128i a01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[ 0]));
+			const __m128i a23 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[16]));
+			const __m128i b01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[32]));
+			const __m128i b23 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[48]));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*0]), _mm_unpacklo_epi64(a01, b01));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*1]), _mm_unpackhi_epi64(a01, b01));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*2]), _mm_unpacklo_epi64(a23, b23));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&px_dest[dest_stride*3]), _mm_unpackhi_epi64(a23, b23));
+		}
+
+		if (x == 1) {
+			// One tile left.
+			const __m128i a01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[ 0]));
+			const __m128i a23 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[16]));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(&px_dest[dest_stride*0]), a01);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(&px_dest[dest_stride*1]), _mm_srli_si128(a01, 8));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(&px_dest[dest_stride*2]), a23);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(&px_dest[dest_stride*3]), _mm_srli_si128(a23, 8));
+			img_buf += (8*4);
+		}
+	}
+}
+
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * SSSE3-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_ssse3(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * 2))
+	{
+		return nullptr;
+	}
+
+	// GameCube RGB5A3 uses 4x4 tiles.
+	assert(width % 4 == 0);
+	assert(height % 4 == 0);
+	if (width % 4 != 0 || height % 4 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	switch (px_format) {
+		case PXF_RGB5A3: {
+			T_fromGcn16_ssse3<PXF_RGB5A3>(img, img_buf);
+			// Set the sBIT metadata.
+			// NOTE: Pixels may be RGB555 or ARGB4444.
+			// We'll use 555 for RGB, and 4 for alpha.
+			// TODO: Set alpha to 0 if no translucent pixels were found.
+			static const rp_image::sBIT_t sBIT = {5,5,5,0,4};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_RGB565: {
+			T_fromGcn16_ssse3<PXF_RGB565>(img, img_buf);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,6,5,0,0};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_IA8: {
+			T_fromGcn16_ssse3<PXF_IA8>(img, img_buf);
+			// Set the sBIT metadata.
+			// NOTE: Setting the grayscale value, though we're
+			// not saving grayscale PNGs at the moment.
+			static const rp_image::sBIT_t sBIT = {8,8,8,8,8};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		default:
+			assert(!"Invalid pixel format for this function.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a GameCube CI8 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf CI8 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 256*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcnCI8_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(pal_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= (width * height));
+	assert(pal_siz >= 256*2);
+	if (!img_buf || !pal_buf || width <= 0 || height <= 0 ||
+	    img_siz < (width * height) || pal_siz < 256*2)
+	{
+		return nullptr;
+	}
+
+	// GameCube CI8 uses 8x4 tiles.
+	assert(width % 8 == 0);
+	assert(height % 4 == 0);
+	if (width % 8 != 0 || height % 4 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::CI8);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Convert the palette.
+	uint32_t *const palette = img->palette();
+	assert(img->palette_len() >= 256);
+	if (img->palette_len() < 256) {
+		// Not enough colors...
+		img->unref();
+		return nullptr;
+	}
+
+	// GCN color format is RGB5A3.
+	for (unsigned int i = 0; i < 256; i += 8) {
+		__m128i px0, px1;
+		T_gcn16_to_ARGB32_ssse3<PXF_RGB5A3>(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(&pal_buf[i])), px0, px1);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&palette[i+0]), px0);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&palette[i+4]), px1);
+	}
+
+	int tr_idx = -1;
+	for (unsigned int i = 0; i < 256; i++) {
+		if ((palette[i] >> 24) == 0) {
+			// Found the transparent color.
+			tr_idx = static_cast<int>(i);
+			break;
+		}
+	}
+	img->set_tr_idx(tr_idx);
+
+	// Untile the image.
+	untileGcn8x4_sse2(img, img_buf);
+
+	// Set the sBIT metadata.
+	// NOTE: Pixels may be RGB555 or ARGB4444.
+	// We'll use 555 for RGB, and 4 for alpha.
+	// TODO: Set alpha to 0 if no translucent pixels were found.
+	static const rp_image::sBIT_t sBIT = {5,5,5,0,4};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a GameCube I8 image to rp_image.
+ * SSSE3-optimized version.
+ * NOTE: Uses a grayscale palette.
+ * FIXME: Needs verification.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf I8 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcnI8_ssse3(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= (width * height));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < (width * height))
+	{
+		return nullptr;
+	}
+
+	// GameCube I8 uses 8x4 tiles.
+	// FIXME: Verify!
+	assert(width % 8 == 0);
+	assert(height % 4 == 0);
+	if (width % 8 != 0 || height % 4 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::CI8);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Initialize a grayscale palette.
+	uint32_t *const palette = img->palette();
+	assert(img->palette_len() >= 256);
+	if (img->palette_len() < 256) {
+		// Not enough colors...
+		img->unref();
+		return nullptr;
+	}
+
+	__m128i gray = _mm_setr_epi32(0xFF000000, 0xFF010101, 0xFF020202, 0xFF030303);
+	const __m128i gray_inc = _mm_set1_epi32(0x00040404);
+	for (unsigned int i = 0; i < 256; i += 4) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&palette[i]), gray);
+		gray = _mm_add_epi32(gray, gray_inc);
+	}
+	// No transparency here.
+	img->set_tr_idx(-1);
+
+	// Untile the image.
+	untileGcn8x4_sse2(img, img_buf);
+
+	// Set the sBIT metadata.
+	// TODO: Use grayscale instead of RGB.
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,0};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+} }
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
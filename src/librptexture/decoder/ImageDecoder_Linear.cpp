@@ -14,6 +14,8 @@
 #include "PixelConversion.hpp"
 using namespace LibRpTexture::PixelConversion;
 
+#include "../img/rp_image_backend_view.hpp"
+
 namespace LibRpTexture { namespace ImageDecoder {
 
 /**
@@ -1203,4 +1205,65 @@ rp_image *fromLinear32_cpp(PixelFormat px_format,
 	return img;
 }
 
+/**
+ * Convert a linear 32-bit RGB image to rp_image.
+ *
+ * If the pixel format is PXF_HOST_ARGB32 and the default rp_image
+ * backend is in use, the rp_image will reference the image buffer
+ * directly instead of copying it. Otherwise, this is the same as
+ * the fromLinear32() function that takes a raw image buffer.
+ *
+ * @param px_format	[in] 32-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param buffer	[in] Reference-counted 32-bit image buffer.
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear32(PixelFormat px_format,
+	int width, int height,
+	rp_image_buffer *buffer, int stride)
+{
+	static const int bytespp = 4;
+
+	// Verify parameters.
+	assert(buffer != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(buffer->size() >= static_cast<size_t>((width * height) * bytespp));
+	if (!buffer || width <= 0 || height <= 0 ||
+	    buffer->size() < static_cast<size_t>((width * height) * bytespp))
+	{
+		return nullptr;
+	}
+
+	if (stride == 0) {
+		// Calculate the stride based on image width.
+		stride = width * bytespp;
+	}
+
+	// NOTE: Other rp_image backends (e.g. QImage and GDI+)
+	// need the image data in their own buffers.
+	if (px_format == PXF_HOST_ARGB32 &&
+	    rp_image::backendCreatorFn() == nullptr &&
+	    rp_image_backend_view::canView(buffer, buffer->data(), width, height, stride))
+	{
+		// Image data is already in rp_image's ARGB32 format.
+		rp_image *const img = new rp_image(
+			new rp_image_backend_view(buffer, buffer->data(), width, height, stride));
+		if (img->isValid()) {
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT_A32 = {8,8,8,0,8};
+			img->set_sBIT(&sBIT_A32);
+			return img;
+		}
+		img->unref();
+	}
+
+	// Convert the image data.
+	return fromLinear32(px_format, width, height,
+		static_cast<const uint32_t*>(buffer->data()),
+		static_cast<int>(buffer->size()), stride);
+}
+
 } }
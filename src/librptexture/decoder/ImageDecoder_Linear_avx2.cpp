@@ -0,0 +1,842 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_Linear.cpp: Image decoding functions. (Linear)             *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+#include "PixelConversion.hpp"
+using namespace LibRpTexture::PixelConversion;
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Templated function for 15/16-bit RGB conversion using AVX2. (no alpha channel)
+ * Processes 16 pixels per iteration.
+ * Use this in the inner loop of the main code.
+ *
+ * @tparam Rshift_W	[in] Red shift amount in the high word.
+ * @tparam Gshift_W	[in] Green shift amount in the low word.
+ * @tparam Bshift_W	[in] Blue shift amount in the low word.
+ * @tparam Rbits	[in] Red bit count.
+ * @tparam Gbits	[in] Green bit count.
+ * @tparam Bbits	[in] Blue bit count.
+ * @tparam isBGR	[in] If true, this is BGR instead of RGB.
+ * @param Rmask		[in] AVX2 mask for the Red channel.
+ * @param Gmask		[in] AVX2 mask for the Green channel.
+ * @param Bmask		[in] AVX2 mask for the Blue channel.
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param px_dest	[out] Destination image buffer.
+ */
+template<uint8_t Rshift_W, uint8_t Gshift_W, uint8_t Bshift_W,
+	uint8_t Rbits, uint8_t Gbits, uint8_t Bbits, bool isBGR>
+static inline void T_RGB16_avx2(
+	const __m256i &Rmask, const __m256i &Gmask, const __m256i &Bmask,
+	const uint16_t *RESTRICT img_buf, uint32_t *RESTRICT px_dest)
+{
+	// Alpha mask.
+	const __m256i Mask32_A  = _mm256_set1_epi32(0xFF000000);
+	// Mask for the high byte for Green.
+	const __m256i MaskG_Hi8 = _mm256_set1_epi16(static_cast<int16_t>(0xFF00));
+
+	// Unpacking works within 128-bit lanes, so swap the middle
+	// two qwords. Unpacking will then result in pixels 0-7 in
+	// the low register and 8-15 in the high register.
+	const __m256i src = _mm256_permute4x64_epi64(
+		_mm256_loadu_si256(reinterpret_cast<const __m256i*>(img_buf)), 0xD8);
+	__m256i *ymm_dest = reinterpret_cast<__m256i*>(px_dest);
+
+	// Mask the G and B components and shift them into place.
+	__m256i sG = _mm256_slli_epi16(_mm256_and_si256(Gmask, src), Gshift_W);
+	__m256i sB;
+	if (isBGR) {
+		sB = _mm256_srli_epi16(_mm256_and_si256(Bmask, src), Bshift_W);
+	} else {
+		sB = _mm256_slli_epi16(_mm256_and_si256(Bmask, src), Bshift_W);
+	}
+	sG = _mm256_or_si256(sG, _mm256_srli_epi16(sG, Gbits));
+	sB = _mm256_or_si256(sB, _mm256_srli_epi16(sB, Bbits));
+	// Combine G and B.
+	if (Gbits > 4) {
+		// NOTE: G low byte has to be masked due to the shift.
+		sB = _mm256_or_si256(sB, _mm256_and_si256(sG, MaskG_Hi8));
+	} else {
+		// Not enough Gbits to need masking.
+		sB = _mm256_or_si256(sB, sG);
+	}
+
+	// Mask the R component and shift it into place.
+	__m256i sR;
+	if (isBGR) {
+		sR = _mm256_slli_epi16(_mm256_and_si256(Rmask, src), Rshift_W);
+	} else {
+		sR = _mm256_srli_epi16(_mm256_and_si256(Rmask, src), Rshift_W);
+	}
+	sR = _mm256_or_si256(sR, _mm256_srli_epi16(sR, Rbits));
+
+	// Unpack R and GB into DWORDs.
+	__m256i px0 = _mm256_or_si256(_mm256_unpacklo_epi16(sB, sR), Mask32_A);
+	__m256i px1 = _mm256_or_si256(_mm256_unpackhi_epi16(sB, sR), Mask32_A);
+
+	_mm256_storeu_si256(&ymm_dest[0], px0);
+	_mm256_storeu_si256(&ymm_dest[1], px1);
+}
+
+/**
+ * Templated function for 15/16-bit RGB conversion using AVX2. (with alpha channel)
+ * Processes 16 pixels per iteration.
+ * Use this in the inner loop of the main code.
+ *
+ * @tparam Ashift_W	[in] Alpha shift amount in the high word. (16 for 1555 alpha handling; 17 for 5551 alpha handling)
+ * @tparam Rshift_W	[in] Red shift amount in the high word.
+ * @tparam Gshift_W	[in] Green shift amount in the low word.
+ * @tparam Bshift_W	[in] Blue shift amount in the low word.
+ * @tparam Abits	[in] Alpha bit count.
+ * @tparam Rbits	[in] Red bit count.
+ * @tparam Gbits	[in] Green bit count.
+ * @tparam Bbits	[in] Blue bit count.
+ * @tparam isBGR	[in] If true, this is BGR instead of RGB.
+ * @param Amask		[in] AVX2 mask for the Alpha channel.
+ * @param Rmask		[in] AVX2 mask for the Red channel.
+ * @param Gmask		[in] AVX2 mask for the Green channel.
+ * @param Bmask		[in] AVX2 mask for the Blue channel.
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param px_dest	[out] Destination image buffer.
+ */
+template<uint8_t Ashift_W, uint8_t Rshift_W, uint8_t Gshift_W, uint8_t Bshift_W,
+	uint8_t Abits, uint8_t Rbits, uint8_t Gbits, uint8_t Bbits, bool isBGR>
+static inline void T_ARGB16_avx2(
+	const __m256i &Amask, const __m256i &Rmask, const __m256i &Gmask, const __m256i &Bmask,
+	const uint16_t *RESTRICT img_buf, uint32_t *RESTRICT px_dest)
+{
+	static_assert(Ashift_W <= 17, "Ashift_W is invalid.");
+	static_assert(Rshift_W < 16, "Rshift_W is invalid.");
+	static_assert(Gshift_W < 16, "Gshift_W is invalid.");
+	static_assert(Bshift_W < 16, "Bshift_W is invalid.");
+	static_assert(Abits < 16, "Abits is invalid.");
+	static_assert(Rbits < 16, "Rbits is invalid.");
+	static_assert(Gbits < 16, "Gbits is invalid.");
+	static_assert(Bbits < 16, "Bbits is invalid.");
+	static_assert(Abits + Rbits + Gbits + Bbits <= 16, "Total number of bits is invalid.");
+
+	// Mask for the high byte for Green and Alpha.
+	const __m256i MaskAG_Hi8 = _mm256_set1_epi16(static_cast<int16_t>(0xFF00));
+
+	// Swap the middle two qwords. (See T_RGB16_avx2().)
+	const __m256i src = _mm256_permute4x64_epi64(
+		_mm256_loadu_si256(reinterpret_cast<const __m256i*>(img_buf)), 0xD8);
+	__m256i *ymm_dest = reinterpret_cast<__m256i*>(px_dest);
+
+	// Mask the G and B components and shift them into place.
+	__m256i sG = _mm256_slli_epi16(_mm256_and_si256(Gmask, src), Gshift_W);
+	__m256i sB;
+	if (isBGR) {
+		sB = _mm256_srli_epi16(_mm256_and_si256(Bmask, src), Bshift_W);
+	} else {
+		sB = _mm256_slli_epi16(_mm256_and_si256(Bmask, src), Bshift_W);
+	}
+	sG = _mm256_or_si256(sG, _mm256_srli_epi16(sG, Gbits));
+	sB = _mm256_or_si256(sB, _mm256_srli_epi16(sB, Bbits));
+	// Combine G and B.
+	if (Gbits > 4) {
+		// NOTE: G low byte has to be masked due to the shift.
+		sB = _mm256_or_si256(sB, _mm256_and_si256(sG, MaskAG_Hi8));
+	} else {
+		// Not enough Gbits to need masking.
+		sB = _mm256_or_si256(sB, sG);
+	}
+
+	// Mask the R component and shift it into place.
+	__m256i sR;
+	if (isBGR) {
+		sR = _mm256_slli_epi16(_mm256_and_si256(Rmask, src), Rshift_W);
+	} else {
+		sR = _mm256_srli_epi16(_mm256_and_si256(Rmask, src), Rshift_W);
+	}
+	sR = _mm256_or_si256(sR, _mm256_srli_epi16(sR, Rbits));
+	// Mask the A components, shift it into place, and combine with R.
+	__m256i sA;
+	if (Ashift_W == 16) {
+		// 1555 alpha handling.
+		// Signed bytewise comparison; Amask must be 0x0080.
+		// (See T_ARGB16_sse2() for details.)
+		sA = _mm256_cmpgt_epi8(Amask, src);
+		// Combine A and R.
+		sR = _mm256_or_si256(sR, sA);
+	} else if (Ashift_W == 17) {
+		// 5551 alpha handling.
+		// Amask has only bit 0 set for each byte.
+		// Any words that have bit 0 set will be set to 0x00FF,
+		// which can then be shifted into place.
+		sA = _mm256_slli_epi16(_mm256_cmpeq_epi8(_mm256_and_si256(src, Amask), Amask), 8);
+		// Combine A and R.
+		sR = _mm256_or_si256(sR, sA);
+	} else {
+		// Standard alpha handling.
+		sA = _mm256_slli_epi16(_mm256_and_si256(Amask, src), Ashift_W);
+		sA = _mm256_or_si256(sA, _mm256_srli_epi16(sA, Abits));
+		// Combine A and R.
+		if (Abits > 4) {
+			// NOTE: A low byte has to be masked due to the shift.
+			sR = _mm256_or_si256(sR, _mm256_and_si256(sA, MaskAG_Hi8));
+		} else {
+			// Not enough Abits to need masking.
+			sR = _mm256_or_si256(sR, sA);
+		}
+	}
+
+	// Unpack AR and GB into DWORDs.
+	__m256i px0 = _mm256_unpacklo_epi16(sB, sR);
+	__m256i px1 = _mm256_unpackhi_epi16(sB, sR);
+
+	_mm256_storeu_si256(&ymm_dest[0], px0);
+	_mm256_storeu_si256(&ymm_dest[1], px1);
+}
+
+/**
+ * Convert a linear 16-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 16-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear16_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz, int stride)
+{
+	static const int bytespp = 2;
+
+	// FIXME: Add support for these formats.
+	// For now, redirect back to the C++ version.
+	switch (px_format) {
+		case PXF_ARGB8332:
+		case PXF_RGB5A3:
+		case PXF_IA8:
+		case PXF_BGR555_PS1:
+		case PXF_BGR5A3:
+		case PXF_L16:
+		case PXF_A8L8:
+		case PXF_L8A8:
+			return fromLinear16_cpp(px_format, width, height, img_buf, img_siz, stride);
+
+		default:
+			break;
+	}
+
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * bytespp));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * bytespp))
+	{
+		return nullptr;
+	}
+
+	// Stride adjustment.
+	// NOTE: Unaligned loads are used, so the stride
+	// doesn't need to be a multiple of 16 bytes.
+	int src_stride_adj = 0;
+	assert(stride >= 0);
+	if (stride > 0) {
+		// Set src_stride_adj to the number of pixels we need to
+		// add to the end of each line to get to the next row.
+		assert(stride % bytespp == 0);
+		assert(stride >= (width * bytespp));
+		if (unlikely(stride % bytespp != 0 || stride < (width * bytespp))) {
+			// Invalid stride.
+			return nullptr;
+		}
+		src_stride_adj = (stride / bytespp) - width;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	const int dest_stride_adj = (img->stride() / sizeof(uint32_t)) - img->width();
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+
+	// AND masks for 565 channels.
+	const __m256i Mask565_Hi5  = _mm256_set1_epi16(static_cast<int16_t>(0xF800));
+	const __m256i Mask565_Mid6 = _mm256_set1_epi16(0x07E0);
+	const __m256i Mask565_Lo5  = _mm256_set1_epi16(0x001F);
+
+	// AND masks for 555 channels.
+	const __m256i Mask555_Hi5  = _mm256_set1_epi16(0x7C00);
+	const __m256i Mask555_Mid5 = _mm256_set1_epi16(0x03E0);
+	const __m256i Mask555_Lo5  = _mm256_set1_epi16(0x001F);
+
+	// AND masks for 4444 channels.
+	const __m256i Mask4444_Nyb3 = _mm256_set1_epi16(static_cast<int16_t>(0xF000));
+	const __m256i Mask4444_Nyb2 = _mm256_set1_epi16(0x0F00);
+	const __m256i Mask4444_Nyb1 = _mm256_set1_epi16(0x00F0);
+	const __m256i Mask4444_Nyb0 = _mm256_set1_epi16(0x000F);
+
+	// AND masks for 1555 channels.
+	const __m256i Cmp1555_A     = _mm256_set1_epi16(0x0080);
+	const __m256i Mask1555_Hi5  = _mm256_set1_epi16(0x7C00);
+	const __m256i Mask1555_Mid5 = _mm256_set1_epi16(0x03E0);
+	const __m256i Mask1555_Lo5  = _mm256_set1_epi16(0x001F);
+
+	// AND masks for 5551 channels.
+	const __m256i Cmp5551_A     = _mm256_set1_epi16(0x0101);
+	const __m256i Mask5551_Hi5  = _mm256_set1_epi16(static_cast<int16_t>(0xF800));
+	const __m256i Mask5551_Mid5 = _mm256_set1_epi16(0x07C0);
+	const __m256i Mask5551_Lo5  = _mm256_set1_epi16(0x003E);
+
+	// Alpha mask.
+	const __m256i Mask32_A  = _mm256_set1_epi32(0xFF000000);
+
+	// GR88 mask.
+	const __m256i MaskGR88  = _mm256_set1_epi32(0x00FFFF00);
+
+	// sBIT metadata.
+	static const rp_image::sBIT_t sBIT_RGB565   = {5,6,5,0,0};
+	static const rp_image::sBIT_t sBIT_ARGB1555 = {5,5,5,0,1};
+	static const rp_image::sBIT_t sBIT_xRGB4444 = {4,4,4,0,0};
+	static const rp_image::sBIT_t sBIT_ARGB4444 = {4,4,4,0,4};
+	static const rp_image::sBIT_t sBIT_RGB555   = {5,5,5,0,0};
+	static const rp_image::sBIT_t sBIT_RG88     = {8,8,1,0,0};
+
+	// Macro for 16-bit formats with no alpha channel.
+#define fromLinear16_convert(fmt, sBIT, Rshift_W, Gshift_W, Bshift_W, Rbits, Gbits, Bbits, isBGR, Rmask, Gmask, Bmask) \
+		case PXF_##fmt: { \
+			for (unsigned int y = (unsigned int)height; y > 0; y--) { \
+				/* Process 16 pixels per iteration using AVX2. */ \
+				unsigned int x = (unsigned int)width; \
+				for (; x > 15; x -= 16, px_dest += 16, img_buf += 16) { \
+					T_RGB16_avx2<Rshift_W, Gshift_W, Bshift_W, Rbits, Gbits, Bbits, isBGR>( \
+						Rmask, Gmask, Bmask, img_buf, px_dest); \
+				} \
+				\
+				/* Remaining pixels. */ \
+				for (; x > 0; x--) { \
+					*px_dest = fmt##_to_ARGB32(*img_buf); \
+					img_buf++; \
+					px_dest++; \
+				} \
+				\
+				/* Next line. */ \
+				img_buf += src_stride_adj; \
+				px_dest += dest_stride_adj; \
+			} \
+			/* Set the sBIT metadata. */ \
+			img->set_sBIT(&sBIT); \
+		} break
+
+	// Macro for 16-bit formats with an alpha channel.
+#define fromLinear16A_convert(fmt, sBIT, Ashift_W, Rshift_W, Gshift_W, Bshift_W, Abits, Rbits, Gbits, Bbits, isBGR, Amask, Rmask, Gmask, Bmask) \
+		case PXF_##fmt: { \
+			for (unsigned int y = (unsigned int)height; y > 0; y--) { \
+				/* Process 16 pixels per iteration using AVX2. */ \
+				unsigned int x = (unsigned int)width; \
+				for (; x > 15; x -= 16, px_dest += 16, img_buf += 16) { \
+					T_ARGB16_avx2<Ashift_W, Rshift_W, Gshift_W, Bshift_W, Abits, Rbits, Gbits, Bbits, isBGR>( \
+						Amask, Rmask, Gmask, Bmask, img_buf, px_dest); \
+				} \
+				\
+				/* Remaining pixels. */ \
+				for (; x > 0; x--) { \
+					*px_dest = fmt##_to_ARGB32(*img_buf); \
+					img_buf++; \
+					px_dest++; \
+				} \
+				\
+				/* Next line. */ \
+				img_buf += src_stride_adj; \
+				px_dest += dest_stride_adj; \
+			} \
+			/* Set the sBIT metadata. */ \
+			img->set_sBIT(&sBIT); \
+		} break
+
+	switch (px_format) {
+		/** RGB565 **/
+		fromLinear16_convert(RGB565, sBIT_RGB565, 8, 5, 3, 5, 6, 5, false, Mask565_Hi5, Mask565_Mid6, Mask565_Lo5);
+		fromLinear16_convert(BGR565, sBIT_RGB565, 3, 5, 8, 5, 6, 5, true,  Mask565_Lo5, Mask565_Mid6, Mask565_Hi5);
+
+		/** ARGB1555 **/
+		fromLinear16A_convert(ARGB1555, sBIT_ARGB1555, 16, 7, 6, 3, 1, 5, 5, 5, false, Cmp1555_A, Mask1555_Hi5, Mask1555_Mid5, Mask1555_Lo5);
+		fromLinear16A_convert(ABGR1555, sBIT_ARGB1555, 16, 3, 6, 7, 1, 5, 5, 5, true,  Cmp1555_A, Mask1555_Lo5, Mask1555_Mid5, Mask1555_Hi5);
+		fromLinear16A_convert(RGBA5551, sBIT_ARGB1555, 17, 8, 5, 2, 1, 5, 5, 5, false, Cmp5551_A, Mask5551_Hi5, Mask5551_Mid5, Mask5551_Lo5);
+		fromLinear16A_convert(BGRA5551, sBIT_ARGB1555, 17, 2, 5, 8, 1, 5, 5, 5, true,  Cmp5551_A, Mask5551_Lo5, Mask5551_Mid5, Mask5551_Hi5);
+
+		/** ARGB4444 **/
+		fromLinear16A_convert(ARGB4444, sBIT_ARGB4444,  0, 4, 8, 4, 4, 4, 4, 4, false, Mask4444_Nyb3, Mask4444_Nyb2, Mask4444_Nyb1, Mask4444_Nyb0);
+		fromLinear16A_convert(ABGR4444, sBIT_ARGB4444,  0, 4, 8, 4, 4, 4, 4, 4, true,  Mask4444_Nyb3, Mask4444_Nyb0, Mask4444_Nyb1, Mask4444_Nyb2);
+		fromLinear16A_convert(RGBA4444, sBIT_ARGB4444, 12, 8, 4, 0, 4, 4, 4, 4, false, Mask4444_Nyb0, Mask4444_Nyb3, Mask4444_Nyb2, Mask4444_Nyb1);
+		fromLinear16A_convert(BGRA4444, sBIT_ARGB4444, 12, 0, 4, 8, 4, 4, 4, 4, true,  Mask4444_Nyb0, Mask4444_Nyb1, Mask4444_Nyb2, Mask4444_Nyb3);
+
+		/** xRGB4444 **/
+		fromLinear16_convert(xRGB4444, sBIT_xRGB4444, 4, 8, 4, 4, 4, 4, false, Mask4444_Nyb2, Mask4444_Nyb1, Mask4444_Nyb0);
+		fromLinear16_convert(xBGR4444, sBIT_xRGB4444, 4, 8, 4, 4, 4, 4, true,  Mask4444_Nyb0, Mask4444_Nyb1, Mask4444_Nyb2);
+		fromLinear16_convert(RGBx4444, sBIT_xRGB4444, 8, 4, 0, 4, 4, 4, false, Mask4444_Nyb3, Mask4444_Nyb2, Mask4444_Nyb1);
+		fromLinear16_convert(BGRx4444, sBIT_xRGB4444, 0, 4, 8, 4, 4, 4, true,  Mask4444_Nyb1, Mask4444_Nyb2, Mask4444_Nyb3);
+
+		/** RGB555 **/
+		fromLinear16_convert(RGB555, sBIT_RGB555, 7, 6, 3, 5, 5, 5, false, Mask555_Hi5, Mask555_Mid5, Mask555_Lo5);
+		fromLinear16_convert(BGR555, sBIT_RGB555, 3, 6, 7, 5, 5, 5, true,  Mask555_Lo5, Mask555_Mid5, Mask555_Hi5);
+
+		/** RG88 **/
+		case PXF_RG88: {
+			// Components are already 8-bit, so we need to
+			// expand them to DWORD and add the alpha channel.
+			const __m256i reg_zero = _mm256_setzero_si256();
+			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+				// Process 16 pixels per iteration using AVX2.
+				unsigned int x = static_cast<unsigned int>(width);
+				for (; x > 15; x -= 16, px_dest += 16, img_buf += 16) {
+					const __m256i src = _mm256_permute4x64_epi64(
+						_mm256_loadu_si256(reinterpret_cast<const __m256i*>(img_buf)), 0xD8);
+					__m256i *ymm_dest = reinterpret_cast<__m256i*>(px_dest);
+
+					// Registers now contain: [00 00 RR GG]
+					__m256i px0 = _mm256_unpacklo_epi16(src, reg_zero);
+					__m256i px1 = _mm256_unpackhi_epi16(src, reg_zero);
+
+					// Shift to [00 RR GG 00] and apply the alpha channel.
+					px0 = _mm256_or_si256(_mm256_slli_epi32(px0, 8), Mask32_A);
+					px1 = _mm256_or_si256(_mm256_slli_epi32(px1, 8), Mask32_A);
+
+					// Write the pixels to the destination image buffer.
+					_mm256_storeu_si256(&ymm_dest[0], px0);
+					_mm256_storeu_si256(&ymm_dest[1], px1);
+				}
+
+				// Remaining pixels.
+				for (; x > 0; x--) {
+					*px_dest = RG88_to_ARGB32(*img_buf);
+					img_buf++;
+					px_dest++;
+				}
+
+				// Next line.
+				img_buf += src_stride_adj;
+				px_dest += dest_stride_adj;
+			}
+
+			// Set the sBIT metadata.
+			img->set_sBIT(&sBIT_RG88);
+			break;
+		}
+
+		/** GR88 **/
+		case PXF_GR88: {
+			// Components are already 8-bit, so we need to
+			// expand them to DWORD and add the alpha channel.
+			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+				// Process 16 pixels per iteration using AVX2.
+				unsigned int x = static_cast<unsigned int>(width);
+				for (; x > 15; x -= 16, px_dest += 16, img_buf += 16) {
+					const __m256i src = _mm256_permute4x64_epi64(
+						_mm256_loadu_si256(reinterpret_cast<const __m256i*>(img_buf)), 0xD8);
+					__m256i *ymm_dest = reinterpret_cast<__m256i*>(px_dest);
+
+					// Registers now contain: [GG RR GG RR]
+					__m256i px0 = _mm256_unpacklo_epi16(src, src);
+					__m256i px1 = _mm256_unpackhi_epi16(src, src);
+
+					// Mask off the low and high bytes and apply the alpha channel.
+					// Registers now contain: [FF RR GG 00]
+					px0 = _mm256_or_si256(_mm256_and_si256(px0, MaskGR88), Mask32_A);
+					px1 = _mm256_or_si256(_mm256_and_si256(px1, MaskGR88), Mask32_A);
+
+					// Write the pixels to the destination image buffer.
+					_mm256_storeu_si256(&ymm_dest[0], px0);
+					_mm256_storeu_si256(&ymm_dest[1], px1);
+				}
+
+				// Remaining pixels.
+				for (; x > 0; x--) {
+					*px_dest = GR88_to_ARGB32(*img_buf);
+					img_buf++;
+					px_dest++;
+				}
+
+				// Next line.
+				img_buf += src_stride_adj;
+				px_dest += dest_stride_adj;
+			}
+
+			// Set the sBIT metadata.
+			img->set_sBIT(&sBIT_RG88);
+			break;
+		}
+
+		default:
+			assert(!"Pixel format not supported.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a linear 24-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 24-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] Image buffer. (must be byte-addressable)
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*3]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear24_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz, int stride)
+{
+	static const int bytespp = 3;
+
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * bytespp));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * bytespp))
+	{
+		return nullptr;
+	}
+
+	// Stride adjustment.
+	// NOTE: Unaligned loads are used, so the stride
+	// doesn't need to be a multiple of 16 bytes.
+	int src_stride_adj = 0;
+	assert(stride >= 0);
+	if (stride > 0) {
+		// Set src_stride_adj to the number of bytes we need to
+		// add to the end of each line to get to the next row.
+		if (unlikely(stride < (width * bytespp))) {
+			// Invalid stride.
+			return nullptr;
+		}
+		// NOTE: Byte addressing, so keep it in units of bytespp.
+		src_stride_adj = stride - (width * bytespp);
+	}
+
+	// Determine the byte shuffle masks.
+	// Each 128-bit lane is loaded separately, so the same
+	// 12-byte source pattern is used for each lane, except
+	// for the last lane, which is loaded 4 bytes early in
+	// order to avoid reading past the end of the row.
+	__m256i shuf_mask_lo, shuf_mask_hi;
+	switch (px_format) {
+		case PXF_RGB888:
+			shuf_mask_lo = _mm256_setr_epi8(
+				0,1,2,-1, 3,4,5,-1, 6,7,8,-1, 9,10,11,-1,
+				0,1,2,-1, 3,4,5,-1, 6,7,8,-1, 9,10,11,-1);
+			shuf_mask_hi = _mm256_setr_epi8(
+				0,1,2,-1, 3,4,5,-1, 6,7,8,-1, 9,10,11,-1,
+				4,5,6,-1, 7,8,9,-1, 10,11,12,-1, 13,14,15,-1);
+			break;
+		case PXF_BGR888:
+			shuf_mask_lo = _mm256_setr_epi8(
+				2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1,
+				2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1);
+			shuf_mask_hi = _mm256_setr_epi8(
+				2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1,
+				6,5,4,-1, 9,8,7,-1, 12,11,10,-1, 15,14,13,-1);
+			break;
+		default:
+			assert(!"Unsupported 24-bit pixel format.");
+			return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+	const int dest_stride_adj = (img->stride() / sizeof(argb32_t)) - img->width();
+	argb32_t *px_dest = static_cast<argb32_t*>(img->bits());
+
+	// 24-bit RGB images don't have an alpha channel.
+	const __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+
+	for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+		// Process 16 pixels per iteration using AVX2.
+		unsigned int x = static_cast<unsigned int>(width);
+		for (; x > 15; x -= 16, px_dest += 16, img_buf += 16*3) {
+			__m256i *ymm_dest = reinterpret_cast<__m256i*>(px_dest);
+
+			// Load 4 pixels into each 128-bit lane.
+			__m256i sa = _mm256_inserti128_si256(_mm256_castsi128_si256(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[0]))),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[12])), 1);
+			__m256i sb = _mm256_inserti128_si256(_mm256_castsi128_si256(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[24]))),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[32])), 1);
+
+			__m256i val = _mm256_shuffle_epi8(sa, shuf_mask_lo);
+			val = _mm256_or_si256(val, alpha_mask);
+			_mm256_storeu_si256(&ymm_dest[0], val);
+			val = _mm256_shuffle_epi8(sb, shuf_mask_hi);
+			val = _mm256_or_si256(val, alpha_mask);
+			_mm256_storeu_si256(&ymm_dest[1], val);
+		}
+
+		// Remaining pixels.
+		if (x > 0) {
+		switch (px_format) {
+			case PXF_RGB888:
+				for (; x > 0; x--, px_dest++, img_buf += 3) {
+					px_dest->b = img_buf[0];
+					px_dest->g = img_buf[1];
+					px_dest->r = img_buf[2];
+					px_dest->a = 0xFF;
+				}
+				break;
+
+			case PXF_BGR888:
+				for (; x > 0; x--, px_dest++, img_buf += 3) {
+					px_dest->b = img_buf[2];
+					px_dest->g = img_buf[1];
+					px_dest->r = img_buf[0];
+					px_dest->a = 0xFF;
+				}
+				break;
+
+			default:
+				assert(!"Unsupported 24-bit pixel format.");
+				img->unref();
+				return nullptr;
+		} }
+
+		// Next line.
+		img_buf += src_stride_adj;
+		px_dest += dest_stride_adj;
+	}
+
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,0};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a linear 32-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 32-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 32-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*4]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear32_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint32_t *RESTRICT img_buf, int img_siz, int stride)
+{
+	static const int bytespp = 4;
+
+	// FIXME: Add support for these formats.
+	// For now, redirect back to the C++ version.
+	switch (px_format) {
+		case PXF_A2R10G10B10:
+		case PXF_A2B10G10R10:
+		case PXF_RGB9_E5:
+		case PXF_BGR888_ABGR7888:
+			return fromLinear32_cpp(px_format, width, height, img_buf, img_siz, stride);
+
+		default:
+			break;
+	}
+
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * bytespp));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * bytespp))
+	{
+		return nullptr;
+	}
+
+	// Stride adjustment.
+	// NOTE: Unaligned loads are used, so the stride
+	// doesn't need to be a multiple of 16 bytes.
+	int src_stride_adj = 0;
+	assert(stride >= 0);
+	if (stride > 0) {
+		// Set src_stride_adj to the number of pixels we need to
+		// add to the end of each line to get to the next row.
+		assert(stride % bytespp == 0);
+		assert(stride >= (width * bytespp));
+		if (unlikely(stride % bytespp != 0 || stride < (width * bytespp))) {
+			// Invalid stride.
+			return nullptr;
+		}
+		src_stride_adj = (stride / bytespp) - width;
+	} else {
+		stride = width * bytespp;
+	}
+
+	// Determine the byte shuffle mask.
+	// NOTE: The same mask is used for both 128-bit lanes.
+	__m128i shuf_mask;
+	bool has_alpha;
+	switch (px_format) {
+		case PXF_HOST_ARGB32:
+			// No shuffling is needed. (handled below)
+			shuf_mask = _mm_setzero_si128();
+			has_alpha = true;
+			break;
+
+		case PXF_HOST_xRGB32:
+			shuf_mask = _mm_setr_epi8(0,1,2,3, 4,5,6,7, 8,9,10,11, 12,13,14,15);
+			has_alpha = false;
+			break;
+
+		case PXF_HOST_RGBA32:
+		case PXF_HOST_RGBx32:
+			shuf_mask = _mm_setr_epi8(1,2,3,0, 5,6,7,4, 9,10,11,8, 13,14,15,12);
+			has_alpha = (px_format == PXF_HOST_RGBA32);
+			break;
+
+		case PXF_SWAP_ARGB32:
+		case PXF_SWAP_xRGB32:
+			shuf_mask = _mm_setr_epi8(3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12);
+			has_alpha = (px_format == PXF_SWAP_ARGB32);
+			break;
+
+		case PXF_SWAP_RGBA32:
+		case PXF_SWAP_RGBx32:
+			shuf_mask = _mm_setr_epi8(2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15);
+			has_alpha = (px_format == PXF_SWAP_RGBA32);
+			break;
+
+		case PXF_G16R16:
+			// NOTE: Truncates to G8R8.
+			shuf_mask = _mm_setr_epi8(-1,3,1,-1, -1,7,5,-1, -1,11,9,-1, -1,15,13,-1);
+			has_alpha = false;
+			break;
+
+		case PXF_RABG8888:
+			shuf_mask = _mm_setr_epi8(1,0,3,2, 5,4,7,6, 9,8,11,10, 13,12,15,14);
+			has_alpha = true;
+			break;
+
+		default:
+			assert(!"Unsupported 32-bit pixel format.");
+			return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	if (px_format == PXF_HOST_ARGB32) {
+		// Host-endian ARGB32.
+		// We can directly copy the image data without conversions.
+		if (stride == img->stride()) {
+			// Stride is identical. Copy the whole image all at once.
+			memcpy(img->bits(), img_buf, stride * height);
+		} else {
+			// Stride is not identical. Copy each scanline.
+			const int dest_stride = img->stride() / sizeof(uint32_t);
+			uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+			const unsigned int copy_len = static_cast<unsigned int>(width * bytespp);
+			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+				memcpy(px_dest, img_buf, copy_len);
+				img_buf += (stride / bytespp);
+				px_dest += dest_stride;
+			}
+		}
+		// Set the sBIT metadata.
+		static const rp_image::sBIT_t sBIT_A32 = {8,8,8,0,8};
+		img->set_sBIT(&sBIT_A32);
+		return img;
+	}
+
+	const int dest_stride_adj = (img->stride() / sizeof(uint32_t)) - img->width();
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+
+	// If the image doesn't have an alpha channel,
+	// the alpha channel is set to 0xFF.
+	const __m256i ymm_shuf_mask = _mm256_broadcastsi128_si256(shuf_mask);
+	const __m256i ymm_alpha_mask = (has_alpha
+		? _mm256_setzero_si256()
+		: _mm256_set1_epi32(0xFF000000));
+	const __m128i xmm_alpha_mask = _mm256_castsi256_si128(ymm_alpha_mask);
+
+	for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+		// Process 16 pixels per iteration using AVX2.
+		unsigned int x = static_cast<unsigned int>(width);
+		for (; x > 15; x -= 16, px_dest += 16, img_buf += 16) {
+			const __m256i *ymm_src = reinterpret_cast<const __m256i*>(img_buf);
+			__m256i *ymm_dest = reinterpret_cast<__m256i*>(px_dest);
+
+			__m256i sa = _mm256_loadu_si256(&ymm_src[0]);
+			__m256i sb = _mm256_loadu_si256(&ymm_src[1]);
+
+			sa = _mm256_or_si256(_mm256_shuffle_epi8(sa, ymm_shuf_mask), ymm_alpha_mask);
+			sb = _mm256_or_si256(_mm256_shuffle_epi8(sb, ymm_shuf_mask), ymm_alpha_mask);
+
+			_mm256_storeu_si256(&ymm_dest[0], sa);
+			_mm256_storeu_si256(&ymm_dest[1], sb);
+		}
+
+		// Remaining pixels.
+		// The first 4 bytes of the shuffle mask only reference
+		// the first pixel, so the same mask works for a single pixel.
+		for (; x > 0; x--, px_dest++, img_buf++) {
+			const __m128i px = _mm_shuffle_epi8(
+				_mm_cvtsi32_si128(static_cast<int>(*img_buf)), shuf_mask);
+			*px_dest = static_cast<uint32_t>(_mm_cvtsi128_si32(
+				_mm_or_si128(px, xmm_alpha_mask)));
+		}
+
+		// Next line.
+		img_buf += src_stride_adj;
+		px_dest += dest_stride_adj;
+	}
+
+	// Set the sBIT metadata.
+	if (has_alpha) {
+		static const rp_image::sBIT_t sBIT_A32 = {8,8,8,0,8};
+		img->set_sBIT(&sBIT_A32);
+	} else if (unlikely(px_format == PXF_G16R16)) {
+		static const rp_image::sBIT_t sBIT_G16R16 = {8,8,1,0,0};
+		img->set_sBIT(&sBIT_G16R16);
+	} else {
+		static const rp_image::sBIT_t sBIT_x32 = {8,8,8,0,0};
+		img->set_sBIT(&sBIT_x32);
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+} }
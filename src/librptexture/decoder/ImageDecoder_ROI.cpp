@@ -0,0 +1,176 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_ROI.cpp: Image decoding functions. (Region of interest)    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// Uninitialized vector class.
+// Reference: http://andreoffringa.org/?q=uvector
+// FIXME: Move out of librpbase?
+#include "librpbase/uvector.h"
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Decoding function and block size for each BlockFormat.
+ */
+struct BlockFormatInfo {
+	ImageDecoderPrivate::pfnDecodeBlocks_t pfn;
+	unsigned int blockSize;		// Block size, in bytes.
+};
+
+/**
+ * Decode a region of a 4x4 block-compressed image.
+ * Only the tiles that cover the region are decoded, so this
+ * is much faster than decoding the full image and cropping it.
+ *
+ * The region must be entirely within the image.
+ * If the region covers the full image, this is the same as
+ * calling the format's regular decoding function.
+ *
+ * @param blkfmt Block format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf Image buffer.
+ * @param img_siz Size of image data.
+ * @param x Region X position.
+ * @param y Region Y position.
+ * @param roi_width Region width.
+ * @param roi_height Region height.
+ * @return rp_image containing only the region, or nullptr on error.
+ */
+rp_image *fromBlocks_ROI(BlockFormat blkfmt, int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	int x, int y, int roi_width, int roi_height)
+{
+	// NOTE: The function pointers have to be initialized here
+	// instead of in a static table, since the decoding functions
+	// might be resolved using IFUNC.
+	BlockFormatInfo info;
+	switch (blkfmt) {
+		case BLKF_DXT1:		info.pfn = fromDXT1;		info.blockSize = 8;	break;
+		case BLKF_DXT1_A1:	info.pfn = fromDXT1_A1;		info.blockSize = 8;	break;
+		case BLKF_DXT2:		info.pfn = fromDXT2;		info.blockSize = 16;	break;
+		case BLKF_DXT3:		info.pfn = fromDXT3;		info.blockSize = 16;	break;
+		case BLKF_DXT4:		info.pfn = fromDXT4;		info.blockSize = 16;	break;
+		case BLKF_DXT5:		info.pfn = fromDXT5;		info.blockSize = 16;	break;
+		case BLKF_BC4:		info.pfn = fromBC4;		info.blockSize = 8;	break;
+		case BLKF_BC5:		info.pfn = fromBC5;		info.blockSize = 16;	break;
+		case BLKF_BC7:		info.pfn = fromBC7;		info.blockSize = 16;	break;
+		case BLKF_ETC1:		info.pfn = fromETC1;		info.blockSize = 8;	break;
+		case BLKF_ETC2_RGB:	info.pfn = fromETC2_RGB;	info.blockSize = 8;	break;
+		case BLKF_ETC2_RGB_A1:	info.pfn = fromETC2_RGB_A1;	info.blockSize = 8;	break;
+		case BLKF_ETC2_RGBA:	info.pfn = fromETC2_RGBA;	info.blockSize = 16;	break;
+		default:
+			assert(!"Unsupported block format.");
+			return nullptr;
+	}
+
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	if (!img_buf || width <= 0 || height <= 0)
+		return nullptr;
+
+	// The region must be entirely within the image.
+	assert(x >= 0 && y >= 0);
+	assert(roi_width > 0 && roi_height > 0);
+	assert(x + roi_width <= width);
+	assert(y + roi_height <= height);
+	if (x < 0 || y < 0 || roi_width <= 0 || roi_height <= 0 ||
+	    roi_width > width - x || roi_height > height - y)
+	{
+		return nullptr;
+	}
+
+	const unsigned int tilesX = static_cast<unsigned int>(ALIGN_BYTES(4, width) / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(ALIGN_BYTES(4, height) / 4);
+	assert(img_siz >= 0);
+	assert(static_cast<size_t>(img_siz) >= static_cast<size_t>(tilesX) * tilesY * info.blockSize);
+	if (img_siz < 0 ||
+	    static_cast<size_t>(img_siz) < static_cast<size_t>(tilesX) * tilesY * info.blockSize)
+	{
+		return nullptr;
+	}
+
+	if (x == 0 && y == 0 && roi_width == width && roi_height == height) {
+		// The region covers the full image.
+		return info.pfn(width, height, img_buf, img_siz);
+	}
+
+	// Tiles that cover the region.
+	const unsigned int tx0 = static_cast<unsigned int>(x) / 4;
+	const unsigned int ty0 = static_cast<unsigned int>(y) / 4;
+	const unsigned int tx1 = static_cast<unsigned int>(x + roi_width + 3) / 4;
+	const unsigned int ty1 = static_cast<unsigned int>(y + roi_height + 3) / 4;
+	const unsigned int roiTilesX = tx1 - tx0;
+	const unsigned int roiTilesY = ty1 - ty0;
+
+	const uint8_t *tile_buf;
+	ao::uvector<uint8_t> roi_buf;
+	const size_t src_stride = static_cast<size_t>(tilesX) * info.blockSize;
+	const size_t roi_stride = static_cast<size_t>(roiTilesX) * info.blockSize;
+	if (roiTilesX == tilesX) {
+		// Full tile rows. The blocks are already contiguous.
+		tile_buf = &img_buf[ty0 * src_stride];
+	} else {
+		// Gather the covering blocks from each tile row.
+		roi_buf.resize(roi_stride * roiTilesY);
+		const uint8_t *src = &img_buf[(ty0 * src_stride) + (tx0 * info.blockSize)];
+		uint8_t *dest = roi_buf.data();
+		for (unsigned int ty = roiTilesY; ty > 0; ty--) {
+			memcpy(dest, src, roi_stride);
+			src += src_stride;
+			dest += roi_stride;
+		}
+		tile_buf = roi_buf.data();
+	}
+
+	// Decode the covering tiles.
+	// NOTE: The tile area is always a multiple of 4 pixels,
+	// which is required by the ETC decoders.
+	const int tileW = static_cast<int>(roiTilesX * 4);
+	const int tileH = static_cast<int>(roiTilesY * 4);
+	rp_image *const tileImg = info.pfn(tileW, tileH,
+		tile_buf, static_cast<int>(roi_stride * roiTilesY));
+	if (!tileImg)
+		return nullptr;
+	assert(tileImg->format() == rp_image::Format::ARGB32);
+
+	const int ox = x - static_cast<int>(tx0 * 4);
+	const int oy = y - static_cast<int>(ty0 * 4);
+	if (ox == 0 && oy == 0 && roi_width == tileW && roi_height == tileH) {
+		// The region is aligned to the tile grid.
+		return tileImg;
+	}
+
+	// Crop the region out of the decoded tiles.
+	rp_image *const img = new rp_image(roi_width, roi_height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		tileImg->unref();
+		return nullptr;
+	}
+	const size_t row_bytes = static_cast<size_t>(roi_width) * sizeof(uint32_t);
+	for (int row = 0; row < roi_height; row++) {
+		const uint32_t *const src = static_cast<const uint32_t*>(tileImg->scanLine(oy + row));
+		memcpy(img->scanLine(row), &src[ox], row_bytes);
+	}
+
+	// Copy sBIT from the decoded tiles.
+	rp_image::sBIT_t sBIT;
+	if (tileImg->get_sBIT(&sBIT) == 0) {
+		img->set_sBIT(&sBIT);
+	}
+	tileImg->unref();
+	return img;
+}
+
+} }
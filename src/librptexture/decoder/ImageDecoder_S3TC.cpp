@@ -191,7 +191,7 @@ static inline uint8_t decode_DXT5_alpha_S3TC(unsigned int a3, const uint8_t *RES
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDXT1_GCN(int width, int height,
+rp_image *fromDXT1_GCN_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -353,10 +353,11 @@ static rp_image *T_fromDXT1(int width, int height,
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDXT1(int width, int height,
+rp_image *fromDXT1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
-	return T_fromDXT1<0>(width, height, img_buf, img_siz);
+	return ImageDecoderPrivate::decodeBlocks_mt(T_fromDXT1<0>, 8,
+		width, height, img_buf, img_siz);
 }
 
 /**
@@ -369,10 +370,11 @@ rp_image *fromDXT1(int width, int height,
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDXT1_A1(int width, int height,
+rp_image *fromDXT1_A1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
-	return T_fromDXT1<DXTn_PALETTE_COLOR3_ALPHA>(width, height, img_buf, img_siz);
+	return ImageDecoderPrivate::decodeBlocks_mt(T_fromDXT1<DXTn_PALETTE_COLOR3_ALPHA>, 8,
+		width, height, img_buf, img_siz);
 }
 
 /**
@@ -406,13 +408,14 @@ rp_image *fromDXT2(int width, int height,
 
 /**
  * Convert a DXT3 image to rp_image.
+ * Single-threaded version. (See decodeBlocks_mt().)
  * @param width Image width.
  * @param height Image height.
  * @param img_buf DXT3 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDXT3(int width, int height,
+static rp_image *fromDXT3_st(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -492,6 +495,21 @@ rp_image *fromDXT3(int width, int height,
 	return img;
 }
 
+/**
+ * Convert a DXT3 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT3_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromDXT3_st, 16,
+		width, height, img_buf, img_siz);
+}
+
 /**
  * Convert a DXT4 image to rp_image.
  * @param width Image width.
@@ -523,13 +541,14 @@ rp_image *fromDXT4(int width, int height,
 
 /**
  * Convert a DXT5 image to rp_image.
+ * Single-threaded version. (See decodeBlocks_mt().)
  * @param width Image width.
  * @param height Image height.
  * @param img_buf DXT5 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDXT5(int width, int height,
+static rp_image *fromDXT5_st(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -608,15 +627,31 @@ rp_image *fromDXT5(int width, int height,
 	return img;
 }
 
+/**
+ * Convert a DXT5 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT5_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromDXT5_st, 16,
+		width, height, img_buf, img_siz);
+}
+
 /**
  * Convert a BC4 (ATI1) image to rp_image.
+ * Single-threaded version. (See decodeBlocks_mt().)
  * @param width Image width.
  * @param height Image height.
  * @param img_buf BC4 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromBC4(int width, int height,
+static rp_image *fromBC4_st(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -696,15 +731,31 @@ rp_image *fromBC4(int width, int height,
 	return img;
 }
 
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC4_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromBC4_st, 8,
+		width, height, img_buf, img_siz);
+}
+
 /**
  * Convert a BC5 (ATI2) image to rp_image.
+ * Single-threaded version. (See decodeBlocks_mt().)
  * @param width Image width.
  * @param height Image height.
  * @param img_buf BC5 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromBC5(int width, int height,
+static rp_image *fromBC5_st(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -742,8 +793,8 @@ rp_image *fromBC5(int width, int height,
 	const bc5_block *bc5_src = reinterpret_cast<const bc5_block*>(img_buf);
 
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
 
 	// Temporary tile buffer.
 	uint32_t tileBuf[4*4];
@@ -786,6 +837,21 @@ rp_image *fromBC5(int width, int height,
 	return img;
 }
 
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC5_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(fromBC5_st, 16,
+		width, height, img_buf, img_siz);
+}
+
 /**
  * Convert a Red image to Luminance.
  * Use with fromBC4() to decode an LATC1 texture.
@@ -0,0 +1,748 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_S3TC.cpp: Image decoding functions. (S3TC)                 *
+ * SSSE3-optimized version.                                                *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// SSSE3 headers.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+// MSVC complains when the high bit is set in hex values
+// when setting SSE2 registers.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4309)
+#endif
+
+// NOTE: The output of these functions must be identical to
+// the standard versions in ImageDecoder_S3TC.cpp.
+// - Palette colors are interpolated using 16-bit lanes.
+//   Division by 3, 5, and 7 is done using PMULHUW with
+//   reciprocals that are exact for all possible inputs.
+// - Palette lookups are done using PSHUFB.
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+// Selects the bytes for each pixel in a tile row.
+static const uint8_t pxsel_row[4][16] = {
+	{ 0, 0, 0, 0,  1, 1, 1, 1,  2, 2, 2, 2,  3, 3, 3, 3},
+	{ 4, 4, 4, 4,  5, 5, 5, 5,  6, 6, 6, 6,  7, 7, 7, 7},
+	{ 8, 8, 8, 8,  9, 9, 9, 9, 10,10,10,10, 11,11,11,11},
+	{12,12,12,12, 13,13,13,13, 14,14,14,14, 15,15,15,15},
+};
+
+// Selects one byte per pixel into a specific ARGB32 component.
+// Index 0 is Blue; 3 is Alpha.
+#define COMPONENT_SEL_ROW(c, row) \
+	{ (c)==0?(4*(row)+0):0x80, (c)==1?(4*(row)+0):0x80, (c)==2?(4*(row)+0):0x80, (c)==3?(4*(row)+0):0x80, \
+	  (c)==0?(4*(row)+1):0x80, (c)==1?(4*(row)+1):0x80, (c)==2?(4*(row)+1):0x80, (c)==3?(4*(row)+1):0x80, \
+	  (c)==0?(4*(row)+2):0x80, (c)==1?(4*(row)+2):0x80, (c)==2?(4*(row)+2):0x80, (c)==3?(4*(row)+2):0x80, \
+	  (c)==0?(4*(row)+3):0x80, (c)==1?(4*(row)+3):0x80, (c)==2?(4*(row)+3):0x80, (c)==3?(4*(row)+3):0x80 }
+#define COMPONENT_SEL(c) { \
+	COMPONENT_SEL_ROW(c, 0), COMPONENT_SEL_ROW(c, 1), \
+	COMPONENT_SEL_ROW(c, 2), COMPONENT_SEL_ROW(c, 3) }
+static const uint8_t green_sel[4][16] = COMPONENT_SEL(1);
+static const uint8_t red_sel[4][16]   = COMPONENT_SEL(2);
+static const uint8_t alpha_sel[4][16] = COMPONENT_SEL(3);
+
+/**
+ * Load a constant 16-byte vector.
+ * @param p Pointer to the constant.
+ * @return Vector.
+ */
+static FORCEINLINE __m128i load_const(const uint8_t *p)
+{
+	return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+/**
+ * Swap adjacent 16-bit lanes.
+ * @param x Vector.
+ * @return Vector with lanes (0,1), (2,3), etc. swapped.
+ */
+static FORCEINLINE __m128i swap16(__m128i x)
+{
+	x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2,3,0,1));
+	return _mm_shufflehi_epi16(x, _MM_SHUFFLE(2,3,0,1));
+}
+
+/**
+ * Interpolate the third and fourth colors of a DXT1 palette for one component.
+ * @param x	[in] 16-bit lanes: c0, c1, c0, c1, ...
+ * @param mode4	[in] All ones for blocks that use 4-color mode.
+ * @return 16-bit lanes: c2, c3, c2, c3, ...
+ */
+static FORCEINLINE __m128i interpolate_DXT1(__m128i x, __m128i mode4)
+{
+	const __m128i sw = swap16(x);
+	// 4-color mode: c2 = (2*c0 + c1) / 3; c3 = (2*c1 + c0) / 3
+	const __m128i i3 = _mm_mulhi_epu16(_mm_add_epi16(_mm_add_epi16(x, x), sw), _mm_set1_epi16(21846));
+	// 3-color mode: c2 = (c0 + c1) / 2; c3 = black
+	const __m128i i2 = _mm_and_si128(_mm_srli_epi16(_mm_add_epi16(x, sw), 1), _mm_set1_epi32(0x0000FFFF));
+	return _mm_or_si128(_mm_and_si128(mode4, i3), _mm_andnot_si128(mode4, i2));
+}
+
+/**
+ * Decode the color palettes for four DXT1 blocks.
+ * @tparam isBigEndian	If true, colors are big-endian. (GameCube)
+ * @tparam color3Alpha	If true, color 3 is transparent in 3-color mode.
+ * @param pal		[out] Four palettes, each with four ARGB32 colors.
+ * @param colors	[in] color0 and color1 for each block. (32-bit lanes)
+ */
+template<bool isBigEndian, bool color3Alpha>
+static FORCEINLINE void T_DXT1_palette_x4(__m128i pal[4], __m128i colors)
+{
+	if (isBigEndian) {
+		colors = _mm_or_si128(_mm_slli_epi16(colors, 8), _mm_srli_epi16(colors, 8));
+	}
+
+	// Expand RGB565 to 8 bits per component.
+	__m128i r = _mm_srli_epi16(colors, 11);
+	__m128i g = _mm_and_si128(_mm_srli_epi16(colors, 5), _mm_set1_epi16(0x3F));
+	__m128i b = _mm_and_si128(colors, _mm_set1_epi16(0x1F));
+	r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+	g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+	b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+
+	// 4-color mode is used if color0 > color1. (unsigned)
+	// The result for color0 is copied to the color1 lane.
+	const __m128i sign = _mm_set1_epi16(0x8000);
+	__m128i mode4 = _mm_cmpgt_epi16(_mm_xor_si128(colors, sign), _mm_xor_si128(swap16(colors), sign));
+	mode4 = _mm_shufflelo_epi16(mode4, _MM_SHUFFLE(2,2,0,0));
+	mode4 = _mm_shufflehi_epi16(mode4, _MM_SHUFFLE(2,2,0,0));
+
+	// Interpolate colors 2 and 3.
+	const __m128i r23 = interpolate_DXT1(r, mode4);
+	const __m128i g23 = interpolate_DXT1(g, mode4);
+	const __m128i b23 = interpolate_DXT1(b, mode4);
+	__m128i a23;
+	if (color3Alpha) {
+		// Color 3 is transparent in 3-color mode.
+		a23 = _mm_and_si128(_mm_or_si128(mode4, _mm_set1_epi32(0x0000FFFF)), _mm_set1_epi16(0xFF));
+	} else {
+		a23 = _mm_set1_epi16(0xFF);
+	}
+
+	// Combine the components into ARGB32.
+	const __m128i bg01 = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+	const __m128i ra01 = _mm_or_si128(r, _mm_set1_epi16(0xFF00));
+	const __m128i bg23 = _mm_or_si128(b23, _mm_slli_epi16(g23, 8));
+	const __m128i ra23 = _mm_or_si128(r23, _mm_slli_epi16(a23, 8));
+
+	// Colors 0 and 1 for blocks 0+1 and blocks 2+3.
+	const __m128i c01_b01 = _mm_unpacklo_epi16(bg01, ra01);
+	const __m128i c01_b23 = _mm_unpackhi_epi16(bg01, ra01);
+	// Colors 2 and 3 for blocks 0+1 and blocks 2+3.
+	const __m128i c23_b01 = _mm_unpacklo_epi16(bg23, ra23);
+	const __m128i c23_b23 = _mm_unpackhi_epi16(bg23, ra23);
+
+	pal[0] = _mm_unpacklo_epi64(c01_b01, c23_b01);
+	pal[1] = _mm_unpackhi_epi64(c01_b01, c23_b01);
+	pal[2] = _mm_unpacklo_epi64(c01_b23, c23_b23);
+	pal[3] = _mm_unpackhi_epi64(c01_b23, c23_b23);
+}
+
+/**
+ * Expand the 2-bit color indexes for one DXT1 block.
+ * @tparam isBigEndian	If true, indexes are big-endian. (GameCube)
+ * @param indexes	[in] Color indexes for up to four blocks. (32-bit lanes)
+ * @param bytesel	[in] Selects the four index bytes for this block.
+ * @return Palette byte offsets (index * 4) for each pixel, one byte per pixel.
+ */
+template<bool isBigEndian>
+static FORCEINLINE __m128i T_DXT1_indexes(__m128i indexes, __m128i bytesel)
+{
+	// Each index byte has four pixels.
+	// Little-endian: First pixel is in the low bits.
+	// Big-endian: First pixel is in the high bits.
+	const __m128i bit0 = (isBigEndian
+		? _mm_setr_epi8(64,16,4,1, 64,16,4,1, 64,16,4,1, 64,16,4,1)
+		: _mm_setr_epi8(1,4,16,64, 1,4,16,64, 1,4,16,64, 1,4,16,64));
+	const __m128i bit1 = _mm_add_epi8(bit0, bit0);
+
+	const __m128i x = _mm_shuffle_epi8(indexes, bytesel);
+	const __m128i lo = _mm_cmpeq_epi8(_mm_and_si128(x, bit0), bit0);
+	const __m128i hi = _mm_cmpeq_epi8(_mm_and_si128(x, bit1), bit1);
+	return _mm_or_si128(_mm_and_si128(lo, _mm_set1_epi8(4)), _mm_and_si128(hi, _mm_set1_epi8(8)));
+}
+
+/**
+ * Get the PSHUFB selector for one tile row of ARGB32 palette lookups.
+ * @param idx4	[in] Palette byte offsets from T_DXT1_indexes().
+ * @param row	[in] Tile row.
+ * @return PSHUFB selector.
+ */
+static FORCEINLINE __m128i palette_row_sel(__m128i idx4, unsigned int row)
+{
+	const __m128i chanOff = _mm_setr_epi8(0,1,2,3, 0,1,2,3, 0,1,2,3, 0,1,2,3);
+	return _mm_add_epi8(_mm_shuffle_epi8(idx4, load_const(pxsel_row[row])), chanOff);
+}
+
+/**
+ * Decode DXT5-style interpolated values for one block.
+ * Used for DXT5 alpha and for BC4/BC5 color components.
+ * @param blk	[in] Block in the low 8 bytes. (two values; 48-bit codes)
+ * @return Decoded values, one byte per pixel.
+ */
+static FORCEINLINE __m128i decode_DXT5_alpha(__m128i blk)
+{
+	// Build the 8-entry palette using 16-bit lanes.
+	const __m128i a0 = _mm_shuffle_epi8(blk, _mm_setr_epi8(0,-1, 0,-1, 0,-1, 0,-1, 0,-1, 0,-1, 0,-1, 0,-1));
+	const __m128i a1 = _mm_shuffle_epi8(blk, _mm_setr_epi8(1,-1, 1,-1, 1,-1, 1,-1, 1,-1, 1,-1, 1,-1, 1,-1));
+	const __m128i mode7 = _mm_cmpgt_epi16(a0, a1);
+
+	// a0 > a1: 6 interpolated values, divided by 7.
+	// a0 <= a1: 4 interpolated values, divided by 5, then 0 and 255.
+	const __m128i w0 = _mm_or_si128(
+		_mm_and_si128(mode7, _mm_setr_epi16(7,0,6,5,4,3,2,1)),
+		_mm_andnot_si128(mode7, _mm_setr_epi16(5,0,4,3,2,1,0,0)));
+	const __m128i w1 = _mm_or_si128(
+		_mm_and_si128(mode7, _mm_setr_epi16(0,7,1,2,3,4,5,6)),
+		_mm_andnot_si128(mode7, _mm_setr_epi16(0,5,1,2,3,4,0,0)));
+	const __m128i div = _mm_or_si128(
+		_mm_and_si128(mode7, _mm_set1_epi16(9363)),		// 65536/7, rounded up
+		_mm_andnot_si128(mode7, _mm_set1_epi16(13108)));	// 65536/5, rounded up
+	__m128i pal = _mm_add_epi16(_mm_mullo_epi16(a0, w0), _mm_mullo_epi16(a1, w1));
+	pal = _mm_mulhi_epu16(pal, div);
+	pal = _mm_or_si128(pal, _mm_andnot_si128(mode7, _mm_setr_epi16(0,0,0,0,0,0,0,255)));
+	pal = _mm_packus_epi16(pal, pal);
+
+	// Extract the 3-bit codes.
+	// Each 16-bit lane gets the two bytes containing the code,
+	// which is then shifted into the high byte using multiplication.
+	const __m128i shift = _mm_setr_epi16(256,32,4,128,16,2,64,8);
+	__m128i lo = _mm_shuffle_epi8(blk, _mm_setr_epi8(2,3, 2,3, 2,3, 3,4, 3,4, 3,4, 4,5, 4,5));
+	__m128i hi = _mm_shuffle_epi8(blk, _mm_setr_epi8(5,6, 5,6, 5,6, 6,7, 6,7, 6,7, 7,-1, 7,-1));
+	lo = _mm_srli_epi16(_mm_mullo_epi16(lo, shift), 8);
+	hi = _mm_srli_epi16(_mm_mullo_epi16(hi, shift), 8);
+	const __m128i codes = _mm_and_si128(_mm_packus_epi16(lo, hi), _mm_set1_epi8(7));
+
+	return _mm_shuffle_epi8(pal, codes);
+}
+
+/**
+ * Decode DXT3 alpha values for one block.
+ * @param blk	[in] Block in the low 8 bytes. (4-bit alpha)
+ * @return Alpha values, one byte per pixel.
+ */
+static FORCEINLINE __m128i decode_DXT3_alpha(__m128i blk)
+{
+	const __m128i mask4 = _mm_set1_epi8(0x0F);
+	const __m128i lo = _mm_and_si128(blk, mask4);
+	const __m128i hi = _mm_and_si128(_mm_srli_epi16(blk, 4), mask4);
+	const __m128i a4 = _mm_unpacklo_epi8(lo, hi);
+	// NOTE: The nibbles are < 16, so the 16-bit shift doesn't
+	// carry into the adjacent byte.
+	return _mm_or_si128(a4, _mm_slli_epi16(a4, 4));
+}
+
+/**
+ * Get the number of DXT1 blocks to decode in this iteration.
+ * If fewer than four blocks are left, they're copied to a zero-padded buffer.
+ * @param src		[in] Source blocks.
+ * @param remain	[in] Number of blocks remaining in this row.
+ * @param blockSize	[in] Block size, in bytes.
+ * @param tmp		[out] Temporary buffer. (must be 4*blockSize bytes)
+ * @param pSrc		[out] Source pointer to use for this iteration.
+ * @return Number of valid blocks. (1-4)
+ */
+static FORCEINLINE unsigned int get_blocks_x4(const uint8_t *src, unsigned int remain,
+	unsigned int blockSize, uint8_t *tmp, const uint8_t **pSrc)
+{
+	if (remain >= 4) {
+		*pSrc = src;
+		return 4;
+	}
+	memset(tmp, 0, 4 * blockSize);
+	memcpy(tmp, src, remain * blockSize);
+	*pSrc = tmp;
+	return remain;
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * @tparam color3Alpha If true, color 3 is transparent in 3-color mode.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+template<bool color3Alpha>
+static rp_image *T_fromDXT1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// DXT1 uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	assert(img_siz >= ((width * height) / 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((physWidth * physHeight) / 2))
+	{
+		return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+	uint8_t *const bits = static_cast<uint8_t*>(img->bits());
+	const int stride = img->stride();
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	const uint8_t *src = img_buf;
+	uint8_t tmp[4*8];
+	for (unsigned int y = 0; y < tilesY; y++) {
+		uint8_t *const pDestRow = bits + (y * 4 * stride);
+	for (unsigned int x = 0; x < tilesX; x += 4) {
+		// Decode four blocks at a time.
+		const uint8_t *pSrc;
+		const unsigned int count = get_blocks_x4(src, tilesX - x, 8, tmp, &pSrc);
+		src += count * 8;
+
+		// Separate the colors and indexes.
+		const __m128i *const xmm_src = reinterpret_cast<const __m128i*>(pSrc);
+		const __m128i b01 = _mm_shuffle_epi32(_mm_loadu_si128(&xmm_src[0]), _MM_SHUFFLE(3,1,2,0));
+		const __m128i b23 = _mm_shuffle_epi32(_mm_loadu_si128(&xmm_src[1]), _MM_SHUFFLE(3,1,2,0));
+		const __m128i colors = _mm_unpacklo_epi64(b01, b23);
+		const __m128i indexes = _mm_unpackhi_epi64(b01, b23);
+
+		__m128i pal[4];
+		T_DXT1_palette_x4<false, color3Alpha>(pal, colors);
+
+		uint8_t *pDestTile = pDestRow + (x * 16);
+		for (unsigned int i = 0; i < count; i++, pDestTile += 16) {
+			const __m128i idx4 = T_DXT1_indexes<false>(indexes, _mm_add_epi8(
+				load_const(pxsel_row[0]), _mm_set1_epi8(static_cast<char>(i * 4))));
+			uint8_t *pDest = pDestTile;
+			for (unsigned int row = 0; row < 4; row++, pDest += stride) {
+				const __m128i px = _mm_shuffle_epi8(pal[i], palette_row_sel(idx4, row));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), px);
+			}
+		}
+	} }
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a GameCube DXT1 image to rp_image.
+ * The GameCube variant has 2x2 block tiling in addition to 4x4 pixel tiling.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT1_GCN_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) / 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) / 2))
+	{
+		return nullptr;
+	}
+
+	// GameCube DXT1 uses 2x2 blocks of 4x4 tiles.
+	assert(width % 8 == 0);
+	assert(height % 8 == 0);
+	if (width % 8 != 0 || height % 8 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+	uint8_t *const bits = static_cast<uint8_t*>(img->bits());
+	const int stride = img->stride();
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
+
+	// Tiles are arranged in 2x2 blocks.
+	// Each 2x2 block is decoded in a single iteration.
+	const __m128i *xmm_src = reinterpret_cast<const __m128i*>(img_buf);
+	for (unsigned int y = 0; y < tilesY; y += 2) {
+	for (unsigned int x = 0; x < tilesX; x += 2, xmm_src += 2) {
+		// Separate the colors and indexes.
+		const __m128i b01 = _mm_shuffle_epi32(_mm_loadu_si128(&xmm_src[0]), _MM_SHUFFLE(3,1,2,0));
+		const __m128i b23 = _mm_shuffle_epi32(_mm_loadu_si128(&xmm_src[1]), _MM_SHUFFLE(3,1,2,0));
+		const __m128i colors = _mm_unpacklo_epi64(b01, b23);
+		const __m128i indexes = _mm_unpackhi_epi64(b01, b23);
+
+		// TODO: Color 3 may be either black or transparent.
+		// Figure out if there's a way to specify that in GVR.
+		// Assuming transparent for now, since most GVR DXT1
+		// textures use transparency.
+		__m128i pal[4];
+		T_DXT1_palette_x4<true, true>(pal, colors);
+
+		for (unsigned int i = 0; i < 4; i++) {
+			const __m128i idx4 = T_DXT1_indexes<true>(indexes, _mm_add_epi8(
+				load_const(pxsel_row[0]), _mm_set1_epi8(static_cast<char>(i * 4))));
+			uint8_t *pDest = bits + ((y + (i >> 1)) * 4 * stride) + ((x + (i & 1)) * 16);
+			for (unsigned int row = 0; row < 4; row++, pDest += stride) {
+				const __m128i px = _mm_shuffle_epi8(pal[i], palette_row_sel(idx4, row));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), px);
+			}
+		}
+	} }
+
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(T_fromDXT1_ssse3<false>, 8,
+		width, height, img_buf, img_siz);
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT1_A1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(T_fromDXT1_ssse3<true>, 8,
+		width, height, img_buf, img_siz);
+}
+
+/**
+ * Convert a DXT3 or DXT5 image to rp_image.
+ * @tparam isDXT5 If true, this is DXT5; otherwise, DXT3.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT3/DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+template<bool isDXT5>
+static rp_image *T_fromDXT3_DXT5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// DXT3/DXT5 uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	assert(img_siz >= (physWidth * physHeight));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < (physWidth * physHeight))
+	{
+		return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+	uint8_t *const bits = static_cast<uint8_t*>(img->bits());
+	const int stride = img->stride();
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	// Alpha is replaced by the separate alpha block.
+	const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+
+	// Block format: 8 bytes of alpha, then a DXT1-style color block.
+	const uint8_t *src = img_buf;
+	uint8_t tmp[4*16];
+	for (unsigned int y = 0; y < tilesY; y++) {
+		uint8_t *const pDestRow = bits + (y * 4 * stride);
+	for (unsigned int x = 0; x < tilesX; x += 4) {
+		// Decode four blocks at a time.
+		const uint8_t *pSrc;
+		const unsigned int count = get_blocks_x4(src, tilesX - x, 16, tmp, &pSrc);
+		src += count * 16;
+
+		// Separate the colors and indexes.
+		const __m128i *const xmm_src = reinterpret_cast<const __m128i*>(pSrc);
+		__m128i blk[4];
+		blk[0] = _mm_loadu_si128(&xmm_src[0]);
+		blk[1] = _mm_loadu_si128(&xmm_src[1]);
+		blk[2] = _mm_loadu_si128(&xmm_src[2]);
+		blk[3] = _mm_loadu_si128(&xmm_src[3]);
+		const __m128i t01 = _mm_unpackhi_epi32(blk[0], blk[1]);
+		const __m128i t23 = _mm_unpackhi_epi32(blk[2], blk[3]);
+		const __m128i colors = _mm_unpacklo_epi64(t01, t23);
+		const __m128i indexes = _mm_unpackhi_epi64(t01, t23);
+
+		// FIXME: DXT3 with DXTn_PALETTE_COLOR0_LE_COLOR1 seems to result
+		// in garbage pixels, so both DXT3 and DXT5 use the DXT1 palette.
+		// (See the standard version.)
+		__m128i pal[4];
+		T_DXT1_palette_x4<false, false>(pal, colors);
+
+		uint8_t *pDestTile = pDestRow + (x * 16);
+		for (unsigned int i = 0; i < count; i++, pDestTile += 16) {
+			const __m128i idx4 = T_DXT1_indexes<false>(indexes, _mm_add_epi8(
+				load_const(pxsel_row[0]), _mm_set1_epi8(static_cast<char>(i * 4))));
+			const __m128i alpha = (isDXT5
+				? decode_DXT5_alpha(blk[i])
+				: decode_DXT3_alpha(blk[i]));
+			const __m128i rgb = _mm_and_si128(pal[i], rgbMask);
+
+			uint8_t *pDest = pDestTile;
+			for (unsigned int row = 0; row < 4; row++, pDest += stride) {
+				const __m128i px = _mm_or_si128(
+					_mm_shuffle_epi8(rgb, palette_row_sel(idx4, row)),
+					_mm_shuffle_epi8(alpha, load_const(alpha_sel[row])));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), px);
+			}
+		}
+	} }
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT_DXT3 = {8,8,8,0,4};
+	static const rp_image::sBIT_t sBIT_DXT5 = {8,8,8,0,8};
+	img->set_sBIT(isDXT5 ? &sBIT_DXT5 : &sBIT_DXT3);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a DXT3 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT3_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(T_fromDXT3_DXT5_ssse3<false>, 16,
+		width, height, img_buf, img_siz);
+}
+
+/**
+ * Convert a DXT5 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(T_fromDXT3_DXT5_ssse3<true>, 16,
+		width, height, img_buf, img_siz);
+}
+
+/**
+ * Convert a BC4 or BC5 image to rp_image.
+ * @tparam isBC5 If true, this is BC5; otherwise, BC4.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4/BC5 image buffer.
+ * @param img_siz Size of image data. [BC4: must be >= (w*h)/2; BC5: must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+template<bool isBC5>
+static rp_image *T_fromBC4_BC5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// BC4/BC5 uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	// BC4 blocks are 8 bytes; BC5 blocks are 16 bytes.
+	static const unsigned int blockSize = (isBC5 ? 16 : 8);
+	const int minSize = (isBC5 ? (physWidth * physHeight) : ((physWidth * physHeight) / 2));
+	assert(img_siz >= (isBC5 ? (width * height) : ((width * height) / 2)));
+	if (!img_buf || width <= 0 || height <= 0 || img_siz < minSize) {
+		return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+	uint8_t *const bits = static_cast<uint8_t*>(img->bits());
+	const int stride = img->stride();
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	// Opaque black.
+	const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+
+	const uint8_t *src = img_buf;
+	for (unsigned int y = 0; y < tilesY; y++) {
+		uint8_t *pDestTile = bits + (y * 4 * stride);
+	for (unsigned int x = 0; x < tilesX; x++, src += blockSize, pDestTile += 16) {
+		// BC4/BC5 colors are determined using DXT5-style alpha interpolation.
+		// NOTE: Using red instead of grayscale for BC4.
+		__m128i red, green;
+		if (isBC5) {
+			const __m128i blk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+			red = decode_DXT5_alpha(blk);
+			green = decode_DXT5_alpha(_mm_srli_si128(blk, 8));
+		} else {
+			red = decode_DXT5_alpha(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)));
+			green = _mm_setzero_si128();
+		}
+
+		uint8_t *pDest = pDestTile;
+		for (unsigned int row = 0; row < 4; row++, pDest += stride) {
+			__m128i px = _mm_or_si128(alphaMask, _mm_shuffle_epi8(red, load_const(red_sel[row])));
+			if (isBC5) {
+				px = _mm_or_si128(px, _mm_shuffle_epi8(green, load_const(green_sel[row])));
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), px);
+		}
+	} }
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	// NOTE: We have to set '1' for the empty channels,
+	// since libpng complains if it's set to '0'.
+	static const rp_image::sBIT_t sBIT_BC4 = {8,1,1,0,0};
+	static const rp_image::sBIT_t sBIT_BC5 = {8,8,1,0,0};
+	img->set_sBIT(isBC5 ? &sBIT_BC5 : &sBIT_BC4);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC4_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(T_fromBC4_BC5_ssse3<false>, 8,
+		width, height, img_buf, img_siz);
+}
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return ImageDecoderPrivate::decodeBlocks_mt(T_fromBC4_BC5_ssse3<true>, 16,
+		width, height, img_buf, img_siz);
+}
+
+} }
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
@@ -17,13 +17,18 @@ using namespace LibRpTexture;
 // IFUNC attribute doesn't support C++ name mangling.
 extern "C" {
 
-#ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
+#if !defined(IMAGEDECODER_ALWAYS_HAS_SSE2) || defined(IMAGEDECODER_HAS_AVX2)
 /**
  * IFUNC resolver function for fromLinear16().
  * @return Function pointer.
  */
 static __typeof__(&ImageDecoder::fromLinear16_cpp) fromLinear16_resolve(void)
 {
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromLinear16_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
 #ifdef IMAGEDECODER_HAS_SSE2
 	if (RP_CPU_HasSSE2()) {
 		return &ImageDecoder::fromLinear16_sse2;
@@ -33,7 +38,7 @@ static __typeof__(&ImageDecoder::fromLinear16_cpp) fromLinear16_resolve(void)
 		return &ImageDecoder::fromLinear16_cpp;
 	}
 }
-#endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#endif /* !IMAGEDECODER_ALWAYS_HAS_SSE2 || IMAGEDECODER_HAS_AVX2 */
 
 /**
  * IFUNC resolver function for fromLinear24().
@@ -41,6 +46,11 @@ static __typeof__(&ImageDecoder::fromLinear16_cpp) fromLinear16_resolve(void)
  */
 static __typeof__(&ImageDecoder::fromLinear24_cpp) fromLinear24_resolve(void)
 {
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromLinear24_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
 #ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return &ImageDecoder::fromLinear24_ssse3;
@@ -57,6 +67,11 @@ static __typeof__(&ImageDecoder::fromLinear24_cpp) fromLinear24_resolve(void)
  */
 static __typeof__(&ImageDecoder::fromLinear32_cpp) fromLinear32_resolve(void)
 {
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromLinear32_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
 #ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return &ImageDecoder::fromLinear32_ssse3;
@@ -67,14 +82,341 @@ static __typeof__(&ImageDecoder::fromLinear32_cpp) fromLinear32_resolve(void)
 	}
 }
 
+/**
+ * IFUNC resolver function for fromBC7().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromBC7_cpp) fromBC7_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromBC7_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return &ImageDecoder::fromBC7_sse41;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE41 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromBC7_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromBC7_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDXT1_GCN().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDXT1_GCN_cpp) fromDXT1_GCN_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromDXT1_GCN_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromDXT1_GCN_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromDXT1_GCN_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDXT1().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDXT1_cpp) fromDXT1_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromDXT1_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromDXT1_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromDXT1_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDXT1_A1().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDXT1_A1_cpp) fromDXT1_A1_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromDXT1_A1_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromDXT1_A1_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromDXT1_A1_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDXT3().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDXT3_cpp) fromDXT3_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromDXT3_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromDXT3_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromDXT3_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDXT5().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDXT5_cpp) fromDXT5_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromDXT5_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromDXT5_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromDXT5_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromBC4().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromBC4_cpp) fromBC4_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromBC4_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromBC4_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromBC4_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromBC5().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromBC5_cpp) fromBC5_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromBC5_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromBC5_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromBC5_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromETC1().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromETC1_cpp) fromETC1_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return &ImageDecoder::fromETC1_sse41;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return &ImageDecoder::fromETC1_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromETC2_RGB().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromETC2_RGB_cpp) fromETC2_RGB_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return &ImageDecoder::fromETC2_RGB_sse41;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return &ImageDecoder::fromETC2_RGB_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromETC2_RGBA().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromETC2_RGBA_cpp) fromETC2_RGBA_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return &ImageDecoder::fromETC2_RGBA_sse41;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return &ImageDecoder::fromETC2_RGBA_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromETC2_RGB_A1().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromETC2_RGB_A1_cpp) fromETC2_RGB_A1_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return &ImageDecoder::fromETC2_RGB_A1_sse41;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return &ImageDecoder::fromETC2_RGB_A1_cpp;
+	}
 }
 
-#ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
+/**
+ * IFUNC resolver function for fromDreamcastSquareTwiddled16().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDreamcastSquareTwiddled16_cpp) fromDreamcastSquareTwiddled16_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_BMI2
+	if (RP_CPU_HasSSE2() && RP_CPU_HasBMI2()) {
+		return &ImageDecoder::fromDreamcastSquareTwiddled16_bmi2;
+	} else
+#endif /* IMAGEDECODER_HAS_BMI2 */
+#ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return &ImageDecoder::fromDreamcastSquareTwiddled16_sse2;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return &ImageDecoder::fromDreamcastSquareTwiddled16_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDreamcastVQ16().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDreamcastVQ16_cpp) fromDreamcastVQ16_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return &ImageDecoder::fromDreamcastVQ16_sse2;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return &ImageDecoder::fromDreamcastVQ16_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromGcn16().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromGcn16_cpp) fromGcn16_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromGcn16_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromGcn16_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromGcn16_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromGcnCI8().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromGcnCI8_cpp) fromGcnCI8_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromGcnCI8_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromGcnCI8_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromGcnI8().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromGcnI8_cpp) fromGcnI8_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromGcnI8_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromGcnI8_cpp;
+	}
+}
+
+}
+
+#if !defined(IMAGEDECODER_ALWAYS_HAS_SSE2) || defined(IMAGEDECODER_HAS_AVX2)
 rp_image *ImageDecoder::fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *img_buf, int img_siz, int stride)
 	IFUNC_ATTR(fromLinear16_resolve);
-#endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#endif /* !IMAGEDECODER_ALWAYS_HAS_SSE2 || IMAGEDECODER_HAS_AVX2 */
 
 rp_image *ImageDecoder::fromLinear24(PixelFormat px_format,
 	int width, int height,
@@ -86,4 +428,78 @@ rp_image *ImageDecoder::fromLinear32(PixelFormat px_format,
 	const uint32_t *img_buf, int img_siz, int stride)
 	IFUNC_ATTR(fromLinear32_resolve);
 
+rp_image *ImageDecoder::fromBC7(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromBC7_resolve);
+
+rp_image *ImageDecoder::fromDXT1_GCN(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromDXT1_GCN_resolve);
+
+rp_image *ImageDecoder::fromDXT1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromDXT1_resolve);
+
+rp_image *ImageDecoder::fromDXT1_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromDXT1_A1_resolve);
+
+rp_image *ImageDecoder::fromDXT3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromDXT3_resolve);
+
+rp_image *ImageDecoder::fromDXT5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromDXT5_resolve);
+
+rp_image *ImageDecoder::fromBC4(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromBC4_resolve);
+
+rp_image *ImageDecoder::fromBC5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromBC5_resolve);
+
+rp_image *ImageDecoder::fromETC1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromETC1_resolve);
+
+rp_image *ImageDecoder::fromETC2_RGB(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromETC2_RGB_resolve);
+
+rp_image *ImageDecoder::fromETC2_RGBA(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromETC2_RGBA_resolve);
+
+rp_image *ImageDecoder::fromETC2_RGB_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromETC2_RGB_A1_resolve);
+
+rp_image *ImageDecoder::fromDreamcastSquareTwiddled16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromDreamcastSquareTwiddled16_resolve);
+
+rp_image *ImageDecoder::fromDreamcastVQ16(PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz)
+	IFUNC_ATTR(fromDreamcastVQ16_resolve);
+
+rp_image *ImageDecoder::fromGcn16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromGcn16_resolve);
+
+rp_image *ImageDecoder::fromGcnCI8(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz)
+	IFUNC_ATTR(fromGcnCI8_resolve);
+
+rp_image *ImageDecoder::fromGcnI8(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromGcnI8_resolve);
+
 #endif /* RP_HAS_IFUNC */
@@ -0,0 +1,216 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_mt.cpp: Image decoding functions. (Multithreading)         *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// librpthreads
+#include "librpthreads/Atomics.h"
+#include "librpthreads/Thread.hpp"
+using LibRpThreads::Thread;
+
+// C++ STL classes.
+#include <atomic>
+using std::vector;
+
+namespace LibRpTexture {
+
+// Maximum number of threads. (0 == number of logical CPUs)
+// NOTE: This may be set while other threads are decoding images.
+static std::atomic<unsigned int> mt_maxThreads(0);
+
+// Images smaller than this many pixels are always
+// decoded on the calling thread.
+static const int64_t MT_MIN_PIXELS = 512*512;
+
+// Number of tile rows per band.
+// Each band is decoded into a temporary image, so this
+// also limits the amount of extra memory used per thread.
+static const unsigned int MT_BAND_TILE_ROWS = 16;
+
+/**
+ * Shared state for multithreaded block decoding.
+ */
+struct DecodeBlocksState {
+	ImageDecoderPrivate::pfnDecodeBlocks_t pfn;
+	const uint8_t *img_buf;
+	int img_siz;
+	int width;
+	int height;
+	unsigned int bandCount;
+	unsigned int bytesPerBand;
+
+	rp_image *img;		// Destination image.
+	volatile int nextBand;	// Next band to decode. (atomic)
+	volatile int error;	// Non-zero if any band failed. (atomic)
+};
+
+/**
+ * Decoding thread function.
+ * Bands are claimed in order until all bands have been decoded,
+ * so threads that get cheaper bands will decode more of them.
+ * @param param DecodeBlocksState.
+ */
+static void decodeBlocks_thread(void *param)
+{
+	DecodeBlocksState *const st = static_cast<DecodeBlocksState*>(param);
+	const int bandHeight = static_cast<int>(MT_BAND_TILE_ROWS * 4);
+	const size_t row_bytes = static_cast<size_t>(st->width) * sizeof(uint32_t);
+
+	while (!st->error) {
+		const unsigned int band = static_cast<unsigned int>(ATOMIC_INC_FETCH(&st->nextBand) - 1);
+		if (band >= st->bandCount)
+			break;
+
+		// The last band may be shorter than the rest.
+		const int y0 = static_cast<int>(band) * bandHeight;
+		const int h = std::min(bandHeight, st->height - y0);
+		const size_t offset = static_cast<size_t>(band) * st->bytesPerBand;
+
+		rp_image *const bandImg = st->pfn(st->width, h,
+			st->img_buf + offset, st->img_siz - static_cast<int>(offset));
+		if (!bandImg) {
+			ATOMIC_OR_FETCH(&st->error, 1);
+			break;
+		}
+		assert(bandImg->format() == rp_image::Format::ARGB32);
+		assert(bandImg->width() == st->width);
+		assert(bandImg->height() == h);
+
+		// Copy the band into the destination image.
+		for (int y = 0; y < h; y++) {
+			memcpy(st->img->scanLine(y0 + y), bandImg->scanLine(y), row_bytes);
+		}
+
+		if (band == 0) {
+			// sBIT is the same for all bands.
+			rp_image::sBIT_t sBIT;
+			if (bandImg->get_sBIT(&sBIT) == 0) {
+				st->img->set_sBIT(&sBIT);
+			}
+		}
+		bandImg->unref();
+	}
+}
+
+/**
+ * Decode a 4x4 block-compressed image, using multiple threads
+ * if the image is large enough.
+ *
+ * The tile grid is split into bands of tile rows, which are
+ * decoded by pfn() and copied into the destination image.
+ * Small images are decoded by pfn() on the calling thread.
+ *
+ * @param pfn		[in] Single-threaded decoding function. (must return ARGB32)
+ * @param blockSize	[in] Block size, in bytes.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] Image buffer.
+ * @param img_siz	[in] Size of image data.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *ImageDecoderPrivate::decodeBlocks_mt(pfnDecodeBlocks_t pfn, unsigned int blockSize,
+	int width, int height, const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	assert(pfn != nullptr);
+	assert(blockSize != 0);
+
+	unsigned int threadCount = 1;
+	if (img_buf && width > 0 && height > 0 &&
+	    static_cast<int64_t>(width) * static_cast<int64_t>(height) >= MT_MIN_PIXELS)
+	{
+		const unsigned int nThreads = mt_maxThreads.load(std::memory_order_relaxed);
+		threadCount = (nThreads != 0 ? nThreads : Thread::numberOfCPUs());
+	}
+	const unsigned int tilesX = static_cast<unsigned int>(ALIGN_BYTES(4, width) / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(ALIGN_BYTES(4, height) / 4);
+	const unsigned int bandCount = (tilesY + MT_BAND_TILE_ROWS - 1) / MT_BAND_TILE_ROWS;
+	if (threadCount > bandCount) {
+		threadCount = bandCount;
+	}
+	if (threadCount <= 1 ||
+	    static_cast<size_t>(img_siz) < static_cast<size_t>(tilesX) * tilesY * blockSize)
+	{
+		// Single-threaded decoding.
+		// NOTE: If the image data is too small, pfn() will reject it.
+		return pfn(width, height, img_buf, img_siz);
+	}
+
+	// Create the destination image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	DecodeBlocksState st;
+	st.pfn = pfn;
+	st.img_buf = img_buf;
+	st.img_siz = img_siz;
+	st.width = width;
+	st.height = height;
+	st.bandCount = bandCount;
+	st.bytesPerBand = tilesX * MT_BAND_TILE_ROWS * blockSize;
+	st.img = img;
+	st.nextBand = 0;
+	st.error = 0;
+
+	// Start the worker threads.
+	// The calling thread also decodes bands.
+	vector<Thread*> threads;
+	threads.reserve(threadCount - 1);
+	for (unsigned int i = 1; i < threadCount; i++) {
+		Thread *const thr = new Thread(decodeBlocks_thread, &st);
+		if (!thr->isValid()) {
+			// Could not start the thread.
+			// The remaining bands will be handled by the other threads.
+			delete thr;
+			break;
+		}
+		threads.push_back(thr);
+	}
+	decodeBlocks_thread(&st);
+
+	// Wait for the worker threads to finish.
+	for (auto iter = threads.begin(); iter != threads.end(); ++iter) {
+		delete *iter;
+	}
+
+	if (st.error) {
+		// A band failed to decode.
+		img->unref();
+		return nullptr;
+	}
+	return img;
+}
+
+namespace ImageDecoder {
+
+/**
+ * Set the maximum number of threads used to decode
+ * large block-compressed images.
+ * @param maxThreads Maximum number of threads. (0 == number of logical CPUs; 1 == single-threaded)
+ */
+void setMaxThreads(unsigned int maxThreads)
+{
+	mt_maxThreads.store(maxThreads, std::memory_order_relaxed);
+}
+
+/**
+ * Get the maximum number of threads used to decode
+ * large block-compressed images.
+ * @return Maximum number of threads. (0 == number of logical CPUs)
+ */
+unsigned int maxThreads(void)
+{
+	return mt_maxThreads.load(std::memory_order_relaxed);
+}
+
+} }
@@ -59,6 +59,196 @@ class ImageDecoderPrivate
 		static inline void BlitTile_CI4_LeftLSN(
 			rp_image *RESTRICT img, const uint8_t *RESTRICT tileBuf,
 			unsigned int tileX, unsigned int tileY);
+
+	public:
+		/** Multithreading **/
+
+		/**
+		 * Block decoding function.
+		 * Same signature as the 4x4 block decoding functions in ImageDecoder.
+		 */
+		typedef rp_image *(*pfnDecodeBlocks_t)(int width, int height,
+			const uint8_t *img_buf, int img_siz);
+
+		/**
+		 * Decode a 4x4 block-compressed image, using multiple threads
+		 * if the image is large enough.
+		 *
+		 * The tile grid is split into bands of tile rows, which are
+		 * decoded by pfn() and copied into the destination image.
+		 * Small images are decoded by pfn() on the calling thread.
+		 *
+		 * @param pfn		[in] Single-threaded decoding function. (must return ARGB32)
+		 * @param blockSize	[in] Block size, in bytes.
+		 * @param width		[in] Image width.
+		 * @param height	[in] Image height.
+		 * @param img_buf	[in] Image buffer.
+		 * @param img_siz	[in] Size of image data.
+		 * @return rp_image, or nullptr on error.
+		 */
+		static rp_image *decodeBlocks_mt(pfnDecodeBlocks_t pfn, unsigned int blockSize,
+			int width, int height, const uint8_t *RESTRICT img_buf, int img_siz);
+
+	public:
+		/** BC7 **/
+
+		/**
+		 * Decoded BC7 block parameters.
+		 * Each pixel is interpolated between the two endpoints
+		 * of its subset: c = ((64 - w) * e0 + w * e1 + 32) >> 6
+		 */
+		struct bc7_block_t {
+			// Endpoints, in argb32_t order.
+			// - [0][s]: First endpoint of subset s.
+			// - [1][s]: Second endpoint of subset s.
+			// NOTE: Subset 3 is unused. It's present for alignment.
+			argb32_t endpoints[2][4];
+
+			uint8_t subset[16];		// Subset index for each pixel. (0-2)
+			uint8_t colorWeight[16];	// Color weight for each pixel. (0-64)
+			uint8_t alphaWeight[16];	// Alpha weight for each pixel. (0-64)
+			uint8_t rotation_mode;		// Component rotation mode. (0-3)
+		};
+
+		/**
+		 * Decode the parameters of a BC7 block.
+		 * @param blk		[out] Decoded block parameters.
+		 * @param bc7_src	[in] BC7 block. (128-bit little-endian)
+		 * @return 0 on success; non-zero if the block mode is invalid.
+		 */
+		static int BC7_decodeBlock(bc7_block_t *RESTRICT blk, const uint64_t *RESTRICT bc7_src);
+
+		/**
+		 * BC7 partition parameters for the SIMD decoders.
+		 * These are derived from the partition and anchor index
+		 * tables using the same rules as BC7_decodeBlock().
+		 */
+		struct bc7_partition_t {
+			uint8_t subset[16];		// Subset index for each pixel. (0-2)
+			uint8_t anchor[16];		// 0xFF if the pixel is an anchor index; 0 if not.
+			uint8_t anchorsBefore[16];	// Number of anchor indexes before each pixel, negated.
+		};
+
+		/**
+		 * BC7 per-mode parameters for the SIMD decoders.
+		 *
+		 * The SIMD decoders group blocks by mode, so these only
+		 * have to be loaded once per group. Every bit field is
+		 * extracted by loading a 16-bit window starting at byte
+		 * (bit >> 3) using PSHUFB, multiplying it by 2^(8 - (bit & 7)),
+		 * and keeping the high byte.
+		 *
+		 * Endpoint components use 16-bit lanes, eight per vector,
+		 * in RRRR/GGGG/BBBB/AAAA order. The largest mode (0 or 2)
+		 * has 18 components, so three vectors are needed.
+		 */
+		struct bc7_mode_params_t {
+			// Endpoint component extraction.
+			uint8_t compShuf[3][16];	// Component windows. (PSHUFB)
+			uint16_t compMul[3][8];		// Component window multipliers.
+			uint16_t compMask[3][8];	// Component masks.
+			uint8_t pbitShuf[3][16];	// P-bit windows. (PSHUFB)
+			uint16_t pbitMul[3][8];		// P-bit window multipliers.
+			uint16_t pbitMask[3][8];	// P-bit masks. (0 if no P-bit)
+			uint16_t compScale[3][8];	// 2^(8 - component bits)
+			uint16_t pbitScale[3][8];	// 2^(7 - component bits)
+			uint16_t expandMul[3][8];	// 2^(16 - expanded bits); 0 if already 8 bits.
+
+			// Assemble bc7_block_t::endpoints[] from the packed components.
+			// - [e][0]: Endpoint e from components 0-15.
+			// - [e][1]: Endpoint e from components 16-23. (in bytes 0-7)
+			uint8_t epShuf[2][2][16];
+			uint8_t epConst[2][16];		// Implied alpha for modes without alpha.
+
+			// Index extraction.
+			// Index 1 is the color index (the 2-bit index for mode 4).
+			// Index 2 is the alpha index (modes 4 and 5 only).
+			uint8_t idxBase[2][16];		// Bit offset of each index, ignoring anchors.
+			uint8_t idxWeights[2][16];	// Interpolation weights.
+			uint8_t idxMask[2];		// Index masks.
+			uint8_t idxAnchorBit[2];	// High bit of the index mask. (implied 0 for anchors)
+
+			// Block header.
+			uint8_t partitionShift;		// Partition number position.
+			uint8_t partitionMask;		// Partition number mask. (0 if no partitions)
+			const bc7_partition_t *partitions;	// Partition table.
+		};
+
+		/**
+		 * BC7 mode properties for the SIMD decoders' per-mode templates.
+		 */
+		template<unsigned int MODE>
+		struct bc7_mode_traits_t {
+			enum : unsigned int {
+				// Number of subsets.
+				subsets = (MODE == 0 || MODE == 2) ? 3 : ((MODE >= 4 && MODE <= 6) ? 1 : 2),
+				// Number of component vectors. (eight components each)
+				compVecs = (MODE == 0 || MODE == 2) ? 3 : ((MODE >= 4 && MODE <= 6) ? 1 : 2),
+				// Mode has P-bits.
+				hasPBits = (MODE != 2 && MODE != 4 && MODE != 5),
+				// Mode has separate alpha indexes and component rotation.
+				hasAlphaIdx = (MODE == 4 || MODE == 5),
+			};
+		};
+
+		/**
+		 * Get the BC7 per-mode parameters for the SIMD decoders.
+		 * @return Mode parameters, indexed by mode number.
+		 */
+		static const bc7_mode_params_t *BC7_getModeParams(void);
+
+	public:
+		/** ETC1/ETC2 **/
+
+		// ETC decoding mode.
+		enum ETC_Decoding_Mode {
+			// Bit 0: ETC1 vs. ETC2
+			ETC_DM_ETC1	= (0U << 0),	// ETC1
+			ETC_DM_ETC2	= (1U << 0),	// ETC2
+			ETC_DM_MASK12	= (1U << 0),
+
+			// Bit 1: ETC2 punchthrough alpha
+			ETC2_DM_A1	= (1U << 1),
+		};
+
+		/**
+		 * Decoded ETC1/ETC2 RGB block parameters.
+		 */
+		struct etc_rgb_block_t {
+			// Base colors, in B,G,R,A order. (A is always 255)
+			// - ETC1 mode: Base colors for the two subblocks.
+			// - Planar mode: 'O', 'H', and 'V' colors.
+			int16_t base_color[3][4];
+
+			// 'T' and 'H' modes: Paint colors. (xRGB32)
+			uint32_t paint_color[4];
+
+			// Pixel index bits, in ETC1 order. (columns, then rows)
+			uint16_t px_msb;
+			uint16_t px_lsb;
+
+			// Block mode.
+			enum class Mode : uint8_t {
+				ETC1,	// ETC1-compatible mode (indiv, diff)
+				TH,	// ETC2 'T' or 'H' mode
+				Planar,	// ETC2 'Planar' mode
+			} mode;
+
+			uint8_t flip;		// ETC1 mode: Flip bit. (0 == 2x4; 1 == 4x2)
+			uint8_t tbl_idx[2];	// ETC1 mode: Table codewords for each subblock.
+
+			// ETC2 punchthrough alpha: If true, the opaque bit is unset,
+			// so pixel index 2 is transparent in ETC1, 'T', and 'H' modes.
+			bool punchthrough;
+		};
+
+		/**
+		 * Decode the parameters of an ETC1/ETC2 RGB block.
+		 * @param blk		[out] Decoded block parameters.
+		 * @param etc1_src	[in] ETC1/ETC2 RGB block. (8 bytes)
+		 * @param mode		[in] Mode flags. (See ETC_Decoding_Mode)
+		 */
+		static void ETC_decodeBlock(etc_rgb_block_t *RESTRICT blk, const uint8_t *RESTRICT etc1_src, unsigned int mode);
 };
 
 /**
@@ -22,6 +22,7 @@ using LibRpFile::IRpFile;
 
 // librptexture
 #include "img/rp_image.hpp"
+#include "img/rp_image_backend_view.hpp"
 #include "decoder/ImageDecoder.hpp"
 
 // C++ STL classes.
@@ -51,19 +52,55 @@ class DirectDrawSurfacePrivate final : public FileFormatPrivate
 		// Texture data start address.
 		unsigned int texDataStartAddr;
 
-		// Decoded image.
-		rp_image *img;
+		// Decoded mipmaps.
+		// Mipmap 0 is the full image.
+		vector<rp_image*> mipmaps;
 
 		// Pixel format message.
 		// NOTE: Used for both valid and invalid pixel formats
 		// due to various bit specifications.
 		char pixel_format[32];
 
+		/**
+		 * Calculate the size of a mipmap level's texture data.
+		 * @param mip		[in] Mipmap number. (0 == full image)
+		 * @param pStride	[out,opt] Row stride. (Uncompressed only; 0 for compressed.)
+		 * @return Mipmap size in bytes, or 0 if the format isn't supported.
+		 */
+		unsigned int calcMipmapSize(int mip, unsigned int *pStride = nullptr) const;
+
 		/**
 		 * Load the image.
+		 * @param mip Mipmap number. (0 == full image)
 		 * @return Image, or nullptr on error.
 		 */
-		const rp_image *loadImage(void);
+		const rp_image *loadImage(int mip);
+
+		/**
+		 * Decode texture data.
+		 *
+		 * This is used for both full images and bands. The pixel
+		 * format is taken from the DDS header.
+		 *
+		 * NOTE: For some 32-bit formats, the returned image may
+		 * reference the texture data directly, in which case
+		 * ownership of `buf` is transferred to the image.
+		 *
+		 * @param width		[in] Width.
+		 * @param height	[in] Height.
+		 * @param buf		[in] Texture data.
+		 * @param buf_size	[in] Size of the texture data.
+		 * @param stride	[in] Row stride. (Uncompressed only; 0 for compressed.)
+		 * @return Image, or nullptr on error.
+		 */
+		rp_image *decodeTexData(int width, int height,
+			unique_ptr_aligned<uint8_t> &buf, unsigned int buf_size, unsigned int stride) const;
+
+		/**
+		 * Get the band height for decodeBand().
+		 * @return Band height, or 0 if banded decoding isn't supported.
+		 */
+		int bandHeight(void) const;
 
 	public:
 		// Supported uncompressed RGB formats.
@@ -472,7 +509,6 @@ int DirectDrawSurfacePrivate::updatePixelFormat(void)
 DirectDrawSurfacePrivate::DirectDrawSurfacePrivate(DirectDrawSurface *q, IRpFile *file)
 	: super(q, file)
 	, texDataStartAddr(0)
-	, img(nullptr)
 	, pxf_uncomp(0)
 	, bytespp(0)
 	, dxgi_format(0)
@@ -487,81 +523,40 @@ DirectDrawSurfacePrivate::DirectDrawSurfacePrivate(DirectDrawSurface *q, IRpFile
 
 DirectDrawSurfacePrivate::~DirectDrawSurfacePrivate()
 {
-	UNREF(img);
+	std::for_each(mipmaps.begin(), mipmaps.end(), [](rp_image *img) { UNREF(img); });
 }
 
 /**
- * Load the image.
- * @return Image, or nullptr on error.
+ * Calculate the size of a mipmap level's texture data.
+ * @param mip		[in] Mipmap number. (0 == full image)
+ * @param pStride	[out,opt] Row stride. (Uncompressed only; 0 for compressed.)
+ * @return Mipmap size in bytes, or 0 if the format isn't supported.
  */
-const rp_image *DirectDrawSurfacePrivate::loadImage(void)
+unsigned int DirectDrawSurfacePrivate::calcMipmapSize(int mip, unsigned int *pStride) const
 {
-	if (img) {
-		// Image has already been loaded.
-		return img;
-	} else if (!this->file || !this->isValid) {
-		// Can't load the image.
-		return nullptr;
-	}
-
-	// Sanity check: Maximum image dimensions of 32768x32768.
-	assert(ddsHeader.dwWidth > 0);
-	assert(ddsHeader.dwWidth <= 32768);
-	assert(ddsHeader.dwHeight > 0);
-	assert(ddsHeader.dwHeight <= 32768);
-	if (ddsHeader.dwWidth == 0 || ddsHeader.dwWidth > 32768 ||
-	    ddsHeader.dwHeight == 0 || ddsHeader.dwHeight > 32768)
-	{
-		// Invalid image dimensions.
-		return nullptr;
+	// Adjust width/height for the mipmap level.
+	unsigned int width = ddsHeader.dwWidth >> mip;
+	unsigned int height = ddsHeader.dwHeight >> mip;
+	if (width == 0) width = 1;
+	if (height == 0) height = 1;
+
+	if (pStride) {
+		*pStride = 0;
 	}
 
-	// Texture cannot start inside of the DDS header.
-	// TODO: Also dxt10Header for DX10?
-	// TODO: ...and xb1Header for XBOX?
-	assert(texDataStartAddr >= sizeof(ddsHeader));
-	if (texDataStartAddr < sizeof(ddsHeader)) {
-		// Invalid texture data start address.
-		return nullptr;
-	}
-
-	if (file->size() > 128*1024*1024) {
-		// Sanity check: DDS files shouldn't be more than 128 MB.
-		return nullptr;
-	}
-	const uint32_t file_sz = static_cast<uint32_t>(file->size());
-
-	// Seek to the start of the texture data.
-	int ret = file->seek(texDataStartAddr);
-	if (ret != 0) {
-		// Seek error.
-		return nullptr;
-	}
-
-	// TODO: Handle DX10 alpha processing.
-	// Currently, we're assuming straight alpha for formats
-	// that have an alpha channel, except for DXT2 and DXT4,
-	// which use premultiplied alpha.
-
-	// NOTE: Mipmaps are stored *after* the main image.
-	// Hence, no mipmap processing is necessary.
 	if (dxgi_format != 0) {
 		// Compressed RGB data.
-
 		// NOTE: dwPitchOrLinearSize is not necessarily correct.
 		// Calculate the expected size.
-		uint32_t expected_size;
 		switch (dxgi_format) {
 #ifdef ENABLE_PVRTC
 			case DXGI_FORMAT_FAKE_PVRTC_2bpp:
 				// 32 pixels compressed into 64 bits. (2bpp)
-				expected_size = (ddsHeader.dwWidth * ddsHeader.dwHeight) / 4;
-				break;
+				return (width * height) / 4;
 
 			case DXGI_FORMAT_FAKE_PVRTC_4bpp:
 				// 16 pixels compressed into 64 bits. (4bpp)
-				expected_size = (ddsHeader.dwWidth * ddsHeader.dwHeight) / 2;
-				break;
+				return (width * height) / 2;
 #endif /* ENABLE_PVRTC */
 
 			case DXGI_FORMAT_BC1_TYPELESS:
@@ -572,9 +567,7 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 			case DXGI_FORMAT_BC4_SNORM:
 				// 16 pixels compressed into 64 bits. (4bpp)
 				// NOTE: Width and height must be rounded to the nearest tile. (4x4)
-				expected_size = ALIGN_BYTES(4, ddsHeader.dwWidth) *
-				                ALIGN_BYTES(4, ddsHeader.dwHeight) / 2;
-				break;
+				return ALIGN_BYTES(4, width) * ALIGN_BYTES(4, height) / 2;
 
 			case DXGI_FORMAT_BC2_TYPELESS:
 			case DXGI_FORMAT_BC2_UNORM:
@@ -590,34 +583,80 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 			case DXGI_FORMAT_BC7_UNORM_SRGB:
 				// 16 pixels compressed into 128 bits. (8bpp)
 				// NOTE: Width and height must be rounded to the nearest tile. (4x4)
-				expected_size = ALIGN_BYTES(4, ddsHeader.dwWidth) *
-				                ALIGN_BYTES(4, ddsHeader.dwHeight);
-				break;
+				return ALIGN_BYTES(4, width) * ALIGN_BYTES(4, height);
 
 			case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
 				// Uncompressed "special" 32bpp formats.
-				expected_size = ddsHeader.dwWidth * ddsHeader.dwHeight * 4;
-				break;
+				return width * height * 4;
 
 			default:
 				// Not supported.
-				return nullptr;
+				return 0;
 		}
+	}
 
-		// Verify file size.
-		if (expected_size >= file_sz + texDataStartAddr) {
-			// File is too small.
-			return nullptr;
-		}
+	// Uncompressed linear image data.
+	assert(pxf_uncomp != 0);
+	assert(bytespp != 0);
+	if (pxf_uncomp == 0 || bytespp == 0) {
+		// Pixel format wasn't updated...
+		return 0;
+	}
 
-		// Read the texture data.
-		auto buf = aligned_uptr<uint8_t>(16, expected_size);
-		size_t size = file->read(buf.get(), expected_size);
-		if (size != expected_size) {
-			// Read error.
-			return nullptr;
+	unsigned int stride = 0;
+	if (mip == 0) {
+		// If DDSD_LINEARSIZE is set, the field is linear size,
+		// so it needs to be divided by the image height.
+		if (ddsHeader.dwFlags & DDSD_LINEARSIZE) {
+			stride = ddsHeader.dwPitchOrLinearSize / height;
+		} else {
+			stride = ddsHeader.dwPitchOrLinearSize;
 		}
+	}
+	// NOTE: dwPitchOrLinearSize only applies to the full image.
+	// Mipmaps are assumed to be tightly packed.
+	if (stride == 0) {
+		// Invalid stride. Assume stride == width * bytespp.
+		// TODO: Check for stride is too small but non-zero?
+		stride = width * bytespp;
+	} else if (stride > (width * 16)) {
+		// Stride is too large.
+		return 0;
+	}
+
+	if (pStride) {
+		*pStride = stride;
+	}
+	return height * stride;
+}
 
+/**
+ * Decode texture data.
+ *
+ * This is used for both full images and bands. The pixel
+ * format is taken from the DDS header.
+ *
+ * NOTE: For some 32-bit formats, the returned image may
+ * reference the texture data directly, in which case
+ * ownership of `buf` is transferred to the image.
+ *
+ * @param width		[in] Width.
+ * @param height	[in] Height.
+ * @param buf		[in] Texture data.
+ * @param buf_size	[in] Size of the texture data.
+ * @param stride	[in] Row stride. (Uncompressed only; 0 for compressed.)
+ * @return Image, or nullptr on error.
+ */
+rp_image *DirectDrawSurfacePrivate::decodeTexData(int width, int height,
+	unique_ptr_aligned<uint8_t> &buf, unsigned int buf_size, unsigned int stride) const
+{
+	// TODO: Handle DX10 alpha processing.
+	// Currently, we're assuming straight alpha for formats
+	// that have an alpha channel, except for DXT2 and DXT4,
+	// which use premultiplied alpha.
+	rp_image *img = nullptr;
+	if (dxgi_format != 0) {
+		// Compressed RGB data.
 		// TODO: Handle typeless, signed, sRGB, float.
 		switch (dxgi_format) {
 			case DXGI_FORMAT_BC1_TYPELESS:
@@ -626,13 +665,13 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 				if (likely(dxgi_alpha != DDS_ALPHA_MODE_OPAQUE)) {
 					// 1-bit alpha.
 					img = ImageDecoder::fromDXT1_A1(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
-						buf.get(), expected_size);
+						width, height,
+						buf.get(), buf_size);
 				} else {
 					// No alpha channel.
 					img = ImageDecoder::fromDXT1(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
-						buf.get(), expected_size);
+						width, height,
+						buf.get(), buf_size);
 				}
 				break;
 
@@ -642,13 +681,13 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 				if (likely(dxgi_alpha != DDS_ALPHA_MODE_PREMULTIPLIED)) {
 					// Standard alpha: DXT3
 					img = ImageDecoder::fromDXT3(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
-						buf.get(), expected_size);
+						width, height,
+						buf.get(), buf_size);
 				} else {
 					// Premultiplied alpha: DXT2
 					img = ImageDecoder::fromDXT2(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
-						buf.get(), expected_size);
+						width, height,
+						buf.get(), buf_size);
 				}
 				break;
 
@@ -658,13 +697,13 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 				if (likely(dxgi_alpha != DDS_ALPHA_MODE_PREMULTIPLIED)) {
 					// Standard alpha: DXT5
 					img = ImageDecoder::fromDXT5(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
-						buf.get(), expected_size);
+						width, height,
+						buf.get(), buf_size);
 				} else {
 					// Premultiplied alpha: DXT4
 					img = ImageDecoder::fromDXT4(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
-						buf.get(), expected_size);
+						width, height,
+						buf.get(), buf_size);
 				}
 				break;
 
@@ -672,40 +711,40 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 			case DXGI_FORMAT_BC4_UNORM:
 			case DXGI_FORMAT_BC4_SNORM:
 				img = ImageDecoder::fromBC4(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size);
+					width, height,
+					buf.get(), buf_size);
 				break;
 
 			case DXGI_FORMAT_BC5_TYPELESS:
 			case DXGI_FORMAT_BC5_UNORM:
 			case DXGI_FORMAT_BC5_SNORM:
 				img = ImageDecoder::fromBC5(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size);
+					width, height,
+					buf.get(), buf_size);
 				break;
 
 			case DXGI_FORMAT_BC7_TYPELESS:
 			case DXGI_FORMAT_BC7_UNORM:
 			case DXGI_FORMAT_BC7_UNORM_SRGB:
 				img = ImageDecoder::fromBC7(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size);
+					width, height,
+					buf.get(), buf_size);
 				break;
 
 #ifdef ENABLE_PVRTC
 			case DXGI_FORMAT_FAKE_PVRTC_2bpp:
 				// PVRTC, 2bpp, has alpha.
 				img = ImageDecoder::fromPVRTC(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size,
+					width, height,
+					buf.get(), buf_size,
 					ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES);
 				break;
 
 			case DXGI_FORMAT_FAKE_PVRTC_4bpp:
 				// PVRTC, 4bpp, has alpha.
 				img = ImageDecoder::fromPVRTC(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size,
+					width, height,
+					buf.get(), buf_size,
 					ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES);
 				break;
 #endif /* ENABLE_PVRTC */
@@ -714,9 +753,9 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 				// RGB9_E5 (technically uncompressed...)
 				img = ImageDecoder::fromLinear32(
 					ImageDecoder::PXF_RGB9_E5,
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
+					width, height,
 					reinterpret_cast<const uint32_t*>(buf.get()),
-					expected_size);
+					buf_size);
 				break;
 
 			default:
@@ -725,81 +764,44 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 		}
 	} else {
 		// Uncompressed linear image data.
-		assert(pxf_uncomp != 0);
-		assert(bytespp != 0);
-		if (pxf_uncomp == 0 || bytespp == 0) {
-			// Pixel format wasn't updated...
-			return nullptr;
-		}
-
-		// If DDSD_LINEARSIZE is set, the field is linear size,
-		// so it needs to be divided by the image height.
-		unsigned int stride = 0;
-		if (ddsHeader.dwFlags & DDSD_LINEARSIZE) {
-			if (ddsHeader.dwHeight != 0) {
-				stride = ddsHeader.dwPitchOrLinearSize / ddsHeader.dwHeight;
-			}
-		} else {
-			stride = ddsHeader.dwPitchOrLinearSize;
-		}
-		if (stride == 0) {
-			// Invalid stride. Assume stride == width * bytespp.
-			// TODO: Check for stride is too small but non-zero?
-			stride = ddsHeader.dwWidth * bytespp;
-		} else if (stride > (ddsHeader.dwWidth * 16)) {
-			// Stride is too large.
-			return nullptr;
-		}
-		const unsigned int expected_size = ddsHeader.dwHeight * stride;
-
-		// Verify file size.
-		if (expected_size >= file_sz + texDataStartAddr) {
-			// File is too small.
-			return nullptr;
-		}
-
-		// Read the texture data.
-		auto buf = aligned_uptr<uint8_t>(16, expected_size);
-		size_t size = file->read(buf.get(), expected_size);
-		if (size != expected_size) {
-			// Read error.
-			return nullptr;
-		}
-
 		switch (bytespp) {
 			case sizeof(uint8_t):
 				// 8-bit image. (Usually luminance or alpha.)
 				img = ImageDecoder::fromLinear8(
 					(ImageDecoder::PixelFormat)pxf_uncomp,
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size, stride);
+					width, height,
+					buf.get(), buf_size, stride);
 				break;
 
 			case sizeof(uint16_t):
 				// 16-bit RGB image.
 				img = ImageDecoder::fromLinear16(
 					(ImageDecoder::PixelFormat)pxf_uncomp,
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
+					width, height,
 					reinterpret_cast<const uint16_t*>(buf.get()),
-					expected_size, stride);
+					buf_size, stride);
 				break;
 
 			case 24/8:
 				// 24-bit RGB image.
 				img = ImageDecoder::fromLinear24(
 					(ImageDecoder::PixelFormat)pxf_uncomp,
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size, stride);
+					width, height,
+					buf.get(), buf_size, stride);
 				break;
 
-			case sizeof(uint32_t):
+			case sizeof(uint32_t): {
 				// 32-bit RGB image.
+				// NOTE: If the pixel format matches rp_image's ARGB32
+				// format, the rp_image will reference the texture data
+				// directly, so transfer ownership to an rp_image_buffer.
+				rp_image_buffer *const imgbuf = new rp_image_buffer_aligned(buf.release(), buf_size);
 				img = ImageDecoder::fromLinear32(
 					(ImageDecoder::PixelFormat)pxf_uncomp,
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					reinterpret_cast<const uint32_t*>(buf.get()),
-					expected_size, stride);
+					width, height, imgbuf, stride);
+				imgbuf->unref();
 				break;
+			}
 
 			default:
 				// TODO: Implement other formats.
@@ -808,10 +810,149 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 		}
 	}
 
+	return img;
+}
+
+/**
+ * Load the image.
+ * @param mip Mipmap number. (0 == full image)
+ * @return Image, or nullptr on error.
+ */
+const rp_image *DirectDrawSurfacePrivate::loadImage(int mip)
+{
+	// NOTE: The mipmap array is allocated by the constructor.
+	const int mipmapCount = static_cast<int>(mipmaps.size());
+	assert(mip >= 0);
+	assert(mip < mipmapCount);
+	if (mip < 0 || mip >= mipmapCount) {
+		// Invalid mipmap number.
+		return nullptr;
+	}
+
+	if (mipmaps[mip] != nullptr) {
+		// Image has already been loaded.
+		return mipmaps[mip];
+	} else if (!this->file || !this->isValid) {
+		// Can't load the image.
+		return nullptr;
+	}
+
+	// Sanity check: Maximum image dimensions of 32768x32768.
+	assert(ddsHeader.dwWidth > 0);
+	assert(ddsHeader.dwWidth <= 32768);
+	assert(ddsHeader.dwHeight > 0);
+	assert(ddsHeader.dwHeight <= 32768);
+	if (ddsHeader.dwWidth == 0 || ddsHeader.dwWidth > 32768 ||
+	    ddsHeader.dwHeight == 0 || ddsHeader.dwHeight > 32768)
+	{
+		// Invalid image dimensions.
+		return nullptr;
+	}
+
+	// Texture cannot start inside of the DDS header.
+	// TODO: Also dxt10Header for DX10?
+	// TODO: ...and xb1Header for XBOX?
+	assert(texDataStartAddr >= sizeof(ddsHeader));
+	if (texDataStartAddr < sizeof(ddsHeader)) {
+		// Invalid texture data start address.
+		return nullptr;
+	}
+
+	if (file->size() > 128*1024*1024) {
+		// Sanity check: DDS files shouldn't be more than 128 MB.
+		return nullptr;
+	}
+	const uint32_t file_sz = static_cast<uint32_t>(file->size());
+
+	// Adjust width/height for the mipmap level.
+	int width = ddsHeader.dwWidth >> mip;
+	int height = ddsHeader.dwHeight >> mip;
+	if (width <= 0) width = 1;
+	if (height <= 0) height = 1;
+
+	// NOTE: Mipmaps are stored *after* the main image,
+	// in order from largest to smallest. Skip over the
+	// larger mipmap levels to get to the requested one.
+	uint32_t mipAddr = texDataStartAddr;
+	for (int i = 0; i < mip; i++) {
+		const unsigned int mip_size = calcMipmapSize(i);
+		if (mip_size == 0 || mipAddr >= file_sz || mip_size > file_sz - mipAddr) {
+			// Format isn't supported, or the file is too small.
+			return nullptr;
+		}
+		mipAddr += mip_size;
+	}
+
+	unsigned int stride;
+	const unsigned int expected_size = calcMipmapSize(mip, &stride);
+	if (expected_size == 0) {
+		// Not supported.
+		return nullptr;
+	}
+
+	// Verify file size.
+	if (mipAddr >= file_sz || expected_size > file_sz - mipAddr) {
+		// File is too small.
+		return nullptr;
+	}
+
+	// Read the texture data.
+	auto buf = aligned_uptr<uint8_t>(16, expected_size);
+	size_t size = file->seekAndRead(mipAddr, buf.get(), expected_size);
+	if (size != expected_size) {
+		// Seek and/or read error.
+		return nullptr;
+	}
+
+	rp_image *const img = decodeTexData(width, height, buf, expected_size, stride);
+
 	// TODO: Untile textures for XBOX format.
+	mipmaps[mip] = img;
 	return img;
 }
 
+/**
+ * Get the band height for decodeBand().
+ * @return Band height, or 0 if banded decoding isn't supported.
+ */
+int DirectDrawSurfacePrivate::bandHeight(void) const
+{
+	if (dxgi_format == 0 || dxgi_format == DXGI_FORMAT_R9G9B9E5_SHAREDEXP) {
+		// Uncompressed linear image data.
+		// Any number of rows can be decoded.
+		return (calcMipmapSize(0) != 0 ? 1 : 0);
+	}
+
+	switch (dxgi_format) {
+		case DXGI_FORMAT_BC1_TYPELESS:
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+		case DXGI_FORMAT_BC2_TYPELESS:
+		case DXGI_FORMAT_BC2_UNORM:
+		case DXGI_FORMAT_BC2_UNORM_SRGB:
+		case DXGI_FORMAT_BC3_TYPELESS:
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+		case DXGI_FORMAT_BC4_TYPELESS:
+		case DXGI_FORMAT_BC4_UNORM:
+		case DXGI_FORMAT_BC4_SNORM:
+		case DXGI_FORMAT_BC5_TYPELESS:
+		case DXGI_FORMAT_BC5_UNORM:
+		case DXGI_FORMAT_BC5_SNORM:
+		case DXGI_FORMAT_BC7_TYPELESS:
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			// 4x4 tiles. Each row of tiles is independent.
+			return 4;
+
+		default:
+			// Not supported.
+			// NOTE: PVRTC interpolates between adjacent blocks,
+			// so it can't be decoded in bands.
+			return 0;
+	}
+}
+
 /** DirectDrawSurface **/
 
 /**
@@ -967,6 +1108,17 @@ DirectDrawSurface::DirectDrawSurface(IRpFile *file)
 	if (d->ddsHeader.dwFlags & DDSD_DEPTH) {
 		d->dimensions[2] = d->ddsHeader.dwDepth;
 	}
+
+	// Allocate the mipmap array.
+	// NOTE: 32768x32768 has a maximum of 16 mipmap levels.
+	unsigned int mipmapCount = d->ddsHeader.dwMipMapCount;
+	if (mipmapCount == 0) {
+		// No mipmaps == one image.
+		mipmapCount = 1;
+	} else if (mipmapCount > 16) {
+		mipmapCount = 16;
+	}
+	d->mipmaps.resize(mipmapCount);
 }
 
 /**
@@ -1340,11 +1492,108 @@ const rp_image *DirectDrawSurface::mipmap(int mip) const
 		return nullptr;
 	}
 
-	// FIXME: Support decoding mipmaps.
-	if (mip == 0) {
-		return const_cast<DirectDrawSurfacePrivate*>(d)->loadImage();
+	// Load the image.
+	return const_cast<DirectDrawSurfacePrivate*>(d)->loadImage(mip);
+}
+
+/**
+ * Get the band height for decodeBand().
+ *
+ * Bands must start on a multiple of this height, and must
+ * be a multiple of this height unless the band ends at the
+ * bottom of the image.
+ *
+ * @return Band height, or 0 if banded decoding isn't supported.
+ */
+int DirectDrawSurface::bandHeight(void) const
+{
+	RP_D(const DirectDrawSurface);
+	if (!d->isValid || !d->file) {
+		// Unknown file type.
+		return 0;
 	}
-	return nullptr;
+	return d->bandHeight();
+}
+
+/**
+ * Decode a horizontal band of the full image.
+ *
+ * This allows large images to be processed without
+ * keeping the entire decoded image in memory.
+ * The band is *not* cached by this object.
+ *
+ * @param y First row. (must be a multiple of bandHeight())
+ * @param height Number of rows.
+ * @return Band image (caller must unref()), or nullptr on error.
+ */
+rp_image *DirectDrawSurface::decodeBand(int y, int height) const
+{
+	RP_D(const DirectDrawSurface);
+	const int band_align = bandHeight();
+	if (band_align <= 0) {
+		// Banded decoding isn't supported.
+		return nullptr;
+	}
+
+	// Sanity check: Maximum image dimensions of 32768x32768.
+	const int width = static_cast<int>(d->ddsHeader.dwWidth);
+	const int full_height = static_cast<int>(d->ddsHeader.dwHeight);
+	if (width <= 0 || width > 32768 || full_height <= 0 || full_height > 32768) {
+		// Invalid image dimensions.
+		return nullptr;
+	}
+
+	// Validate the band.
+	assert(y >= 0);
+	assert(height > 0);
+	assert(y % band_align == 0);
+	assert(height <= full_height - y);
+	if (y < 0 || height <= 0 || (y % band_align) != 0 ||
+	    height > full_height - y)
+	{
+		// Invalid band.
+		return nullptr;
+	}
+	if ((height % band_align) != 0 && (y + height) != full_height) {
+		// Only the last band can have a partial tile row.
+		return nullptr;
+	}
+
+	// Texture cannot start inside of the DDS header.
+	if (d->texDataStartAddr < sizeof(d->ddsHeader)) {
+		// Invalid texture data start address.
+		return nullptr;
+	}
+
+	// Size of each band row. (one row of pixels, or one row of tiles)
+	unsigned int stride;
+	const unsigned int full_size = d->calcMipmapSize(0, &stride);
+	const unsigned int band_rows = ALIGN_BYTES(band_align, static_cast<unsigned int>(full_height)) / band_align;
+	if (full_size == 0 || band_rows == 0) {
+		// Not supported.
+		return nullptr;
+	}
+	const unsigned int row_size = full_size / band_rows;
+
+	// Get the band's texture data location.
+	const off64_t band_addr = d->texDataStartAddr +
+		(static_cast<off64_t>(y / band_align) * row_size);
+	const unsigned int band_size =
+		(ALIGN_BYTES(band_align, static_cast<unsigned int>(height)) / band_align) * row_size;
+	if (band_addr + band_size > d->file->size()) {
+		// File is too small.
+		return nullptr;
+	}
+
+	// Read the texture data.
+	auto buf = aligned_uptr<uint8_t>(16, band_size);
+	size_t size = d->file->seekAndRead(band_addr, buf.get(), band_size);
+	if (size != band_size) {
+		// Seek and/or read error.
+		return nullptr;
+	}
+
+	return d->decodeTexData(width, height, buf, band_size, stride);
 }
 
 }
@@ -18,6 +18,22 @@ FILEFORMAT_DECL_BEGIN(DirectDrawSurface)
 	public:
 		static int isRomSupported_static(const DetectInfo *info);
 
+	public:
+		/**
+		 * Get the band height for decodeBand().
+		 * @return Band height, or 0 if banded decoding isn't supported.
+		 */
+		int bandHeight(void) const final;
+
+		/**
+		 * Decode a horizontal band of the full image.
+		 * The band is *not* cached by this object.
+		 * @param y First row. (must be a multiple of bandHeight())
+		 * @param height Number of rows.
+		 * @return Band image (caller must unref()), or nullptr on error.
+		 */
+		rp_image *decodeBand(int y, int height) const final;
+
 FILEFORMAT_DECL_END()
 
 }
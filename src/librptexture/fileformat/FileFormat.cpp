@@ -139,4 +139,99 @@ int FileFormat::getDimensions(int pBuf[3]) const
 	return 0;
 }
 
+/** Image accessors **/
+
+/**
+ * Get the smallest mipmap that is at least the specified size.
+ *
+ * This is intended for thumbnailing, since decoding a smaller
+ * mipmap is much faster than decoding and downscaling the
+ * full image. Since mipmaps maintain the aspect ratio, only
+ * one dimension needs to be at least the specified size.
+ *
+ * If the texture doesn't have a large enough mipmap, or if
+ * the mipmap can't be decoded, the full image is returned.
+ *
+ * The image is owned by this object.
+ * @param width Minimum width.
+ * @param height Minimum height.
+ * @return Image, or nullptr on error.
+ */
+const rp_image *FileFormat::mipmapForSize(int width, int height) const
+{
+	RP_D(const FileFormat);
+	if (!d->isValid) {
+		// Not supported.
+		return nullptr;
+	}
+
+	// NOTE: 32768x32768 has a maximum of 16 mipmap levels.
+	int mipmapCount = this->mipmapCount();
+	if (mipmapCount > 16) {
+		mipmapCount = 16;
+	}
+
+	// Check mipmaps from smallest to largest.
+	// Mipmap 0 is the full image, so it's handled separately.
+	for (int mip = mipmapCount - 1; mip > 0; mip--) {
+		int mipWidth = d->dimensions[0] >> mip;
+		int mipHeight = d->dimensions[1] >> mip;
+		if (mipWidth <= 0) mipWidth = 1;
+		if (mipHeight <= 0) mipHeight = 1;
+		if (mipWidth < width && mipHeight < height) {
+			// Mipmap is too small.
+			continue;
+		}
+
+		const rp_image *const img = this->mipmap(mip);
+		if (img) {
+			return img;
+		}
+		// Unable to decode this mipmap.
+		// Try the next larger one.
+	}
+
+	// Use the full image.
+	return this->image();
+}
+
+/**
+ * Get the band height for decodeBand().
+ *
+ * Bands must start on a multiple of this height, and must
+ * be a multiple of this height unless the band ends at the
+ * bottom of the image. For example, S3TC-compressed textures
+ * are decoded in rows of 4x4 blocks, so the band height is 4.
+ *
+ * The default implementation returns 0.
+ *
+ * @return Band height, or 0 if banded decoding isn't supported.
+ */
+int FileFormat::bandHeight(void) const
+{
+	// Banded decoding isn't supported by default.
+	return 0;
+}
+
+/**
+ * Decode a horizontal band of the full image.
+ *
+ * This allows large images to be processed without
+ * keeping the entire decoded image in memory.
+ * The band is *not* cached by this object.
+ *
+ * The default implementation returns nullptr.
+ *
+ * @param y First row. (must be a multiple of bandHeight())
+ * @param height Number of rows.
+ * @return Band image (caller must unref()), or nullptr on error.
+ */
+rp_image *FileFormat::decodeBand(int y, int height) const
+{
+	// Banded decoding isn't supported by default.
+	RP_UNUSED(y);
+	RP_UNUSED(height);
+	return nullptr;
+}
+
 }
@@ -194,6 +194,53 @@ class FileFormat : public RefBase
 		 * @return Image, or nullptr on error.
 		 */
 		virtual const rp_image *mipmap(int mip) const = 0;
+
+		/**
+		 * Get the smallest mipmap that is at least the specified size.
+		 *
+		 * This is intended for thumbnailing, since decoding a smaller
+		 * mipmap is much faster than decoding and downscaling the
+		 * full image. Since mipmaps maintain the aspect ratio, only
+		 * one dimension needs to be at least the specified size.
+		 *
+		 * If the texture doesn't have a large enough mipmap, or if
+		 * the mipmap can't be decoded, the full image is returned.
+		 *
+		 * The image is owned by this object.
+		 * @param width Minimum width.
+		 * @param height Minimum height.
+		 * @return Image, or nullptr on error.
+		 */
+		const rp_image *mipmapForSize(int width, int height) const;
+
+		/**
+		 * Get the band height for decodeBand().
+		 *
+		 * Bands must start on a multiple of this height, and must
+		 * be a multiple of this height unless the band ends at the
+		 * bottom of the image. For example, S3TC-compressed textures
+		 * are decoded in rows of 4x4 blocks, so the band height is 4.
+		 *
+		 * The default implementation returns 0.
+		 *
+		 * @return Band height, or 0 if banded decoding isn't supported.
+		 */
+		virtual int bandHeight(void) const;
+
+		/**
+		 * Decode a horizontal band of the full image.
+		 *
+		 * This allows large images to be processed without
+		 * keeping the entire decoded image in memory.
+		 * The band is *not* cached by this object.
+		 *
+		 * The default implementation returns nullptr.
+		 *
+		 * @param y First row. (must be a multiple of bandHeight())
+		 * @param height Number of rows.
+		 * @return Band image (caller must unref()), or nullptr on error.
+		 */
+		virtual rp_image *decodeBand(int y, int height) const;
 };
 
 }
@@ -65,8 +65,9 @@ class KhronosKTXPrivate final : public FileFormatPrivate
 		// Texture data start address.
 		unsigned int texDataStartAddr;
 
-		// Decoded image.
-		rp_image *img;
+		// Decoded mipmaps.
+		// Mipmap 0 is the full image.
+		vector<rp_image*> mipmaps;
 
 		// Invalid pixel format message.
 		char invalid_pixel_format[24];
@@ -79,9 +80,10 @@ class KhronosKTXPrivate final : public FileFormatPrivate
 
 		/**
 		 * Load the image.
+		 * @param mip Mipmap number. (0 == full image)
 		 * @return Image, or nullptr on error.
 		 */
-		const rp_image *loadImage(void);
+		const rp_image *loadImage(int mip);
 
 		/**
 		 * Load key/value data.
@@ -96,7 +98,6 @@ KhronosKTXPrivate::KhronosKTXPrivate(KhronosKTX *q, IRpFile *file)
 	, isByteswapNeeded(false)
 	, flipOp(rp_image::FLIP_V)
 	, texDataStartAddr(0)
-	, img(nullptr)
 {
 	// Clear the KTX header struct.
 	memset(&ktxHeader, 0, sizeof(ktxHeader));
@@ -105,18 +106,28 @@ KhronosKTXPrivate::KhronosKTXPrivate(KhronosKTX *q, IRpFile *file)
 
 KhronosKTXPrivate::~KhronosKTXPrivate()
 {
-	UNREF(img);
+	std::for_each(mipmaps.begin(), mipmaps.end(), [](rp_image *img) { UNREF(img); });
 }
 
 /**
  * Load the image.
+ * @param mip Mipmap number. (0 == full image)
  * @return Image, or nullptr on error.
  */
-const rp_image *KhronosKTXPrivate::loadImage(void)
+const rp_image *KhronosKTXPrivate::loadImage(int mip)
 {
-	if (img) {
+	// NOTE: The mipmap array is allocated by the constructor.
+	const int mipmapCount = static_cast<int>(mipmaps.size());
+	assert(mip >= 0);
+	assert(mip < mipmapCount);
+	if (mip < 0 || mip >= mipmapCount) {
+		// Invalid mipmap number.
+		return nullptr;
+	}
+
+	if (mipmaps[mip] != nullptr) {
 		// Image has already been loaded.
-		return img;
+		return mipmaps[mip];
 	} else if (!this->file || !this->isValid) {
 		// Can't load the image.
 		return nullptr;
@@ -147,19 +158,49 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 	}
 	const uint32_t file_sz = static_cast<uint32_t>(file->size());
 
+	// NOTE: Mipmaps are stored *after* the main image,
+	// in order from largest to smallest. Each mipmap level
+	// starts with a 32-bit imageSize field, so skip over the
+	// larger mipmap levels to get to the requested one.
+	uint32_t mipAddr = texDataStartAddr;
+	for (int i = 0; i < mip; i++) {
+		uint32_t imageSize;
+		size_t size = file->seekAndRead(mipAddr, &imageSize, sizeof(imageSize));
+		if (size != sizeof(imageSize)) {
+			// Seek and/or read error.
+			return nullptr;
+		}
+		if (isByteswapNeeded) {
+			imageSize = __swab32(imageSize);
+		}
+
+		// NOTE: For non-array cubemaps, imageSize is the size of
+		// a single face, and each face is padded to 4 bytes.
+		uint32_t levelSize = ALIGN_BYTES(4, imageSize);
+		if (ktxHeader.numberOfArrayElements == 0 && ktxHeader.numberOfFaces == 6) {
+			levelSize *= 6;
+		}
+		if (levelSize > file_sz - mipAddr - sizeof(imageSize)) {
+			// File is too small.
+			return nullptr;
+		}
+		mipAddr += sizeof(imageSize) + levelSize;
+	}
+
 	// Seek to the start of the texture data.
-	int ret = file->seek(texDataStartAddr);
+	int ret = file->seek(mipAddr);
 	if (ret != 0) {
 		// Seek error.
 		return nullptr;
 	}
 
-	// NOTE: Mipmaps are stored *after* the main image.
-	// Hence, no mipmap processing is necessary.
-
+	// Adjust width/height for the mipmap level.
 	// Handle a 1D texture as a "width x 1" 2D texture.
 	// NOTE: Handling a 3D texture as a single 2D texture.
-	const int height = (ktxHeader.pixelHeight > 0 ? ktxHeader.pixelHeight : 1);
+	int width = ktxHeader.pixelWidth >> mip;
+	int height = ktxHeader.pixelHeight >> mip;
+	if (width <= 0) width = 1;
+	if (height <= 0) height = 1;
 
 	// Calculate the expected size.
 	// NOTE: Scanlines are 4-byte aligned.
@@ -168,26 +209,26 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 	switch (ktxHeader.glFormat) {
 		case GL_RGB:
 			// 24-bit RGB.
-			stride = ALIGN_BYTES(4, ktxHeader.pixelWidth * 3);
+			stride = ALIGN_BYTES(4, width * 3);
 			expected_size = static_cast<unsigned int>(stride * height);
 			break;
 
 		case GL_RGBA:
 			// 32-bit RGBA.
-			stride = ktxHeader.pixelWidth * 4;
+			stride = width * 4;
 			expected_size = static_cast<unsigned int>(stride * height);
 			break;
 
 		case GL_LUMINANCE:
 			// 8-bit luminance.
-			stride = ALIGN_BYTES(4, ktxHeader.pixelWidth);
+			stride = ALIGN_BYTES(4, width);
 			expected_size = static_cast<unsigned int>(stride * height);
 			break;
 
 		case GL_RGB9_E5:
 			// Uncompressed "special" 32bpp formats.
 			// TODO: Does KTX handle GL_RGB9_E5 as compressed?
-			stride = ktxHeader.pixelWidth * 4;
+			stride = width * 4;
 			expected_size = static_cast<unsigned int>(stride * height);
 			break;
 
@@ -200,25 +241,25 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 				case GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG:
 				case GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG:
 					// 32 pixels compressed into 64 bits. (2bpp)
-					expected_size = (ktxHeader.pixelWidth * height) / 4;
+					expected_size = (width * height) / 4;
 					break;
 
 				case GL_COMPRESSED_RGBA_PVRTC_2BPPV2_IMG:
 					// 32 pixels compressed into 64 bits. (2bpp)
 					// NOTE: Width and height must be rounded to the nearest tile. (8x4)
-					expected_size = ALIGN_BYTES(8, ktxHeader.pixelWidth) *
+					expected_size = ALIGN_BYTES(8, width) *
 					                ALIGN_BYTES(4, (int)height) / 4;
 					break;
 
 				case GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG:
 				case GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG:
 					// 16 pixels compressed into 64 bits. (4bpp)
-					expected_size = (ktxHeader.pixelWidth * height) / 2;
+					expected_size = (width * height) / 2;
 					break;
 
 				case GL_COMPRESSED_RGBA_PVRTC_4BPPV2_IMG:
 					// NOTE: Width and height must be rounded to the nearest tile. (4x4)
-					expected_size = ALIGN_BYTES(4, ktxHeader.pixelWidth) *
+					expected_size = ALIGN_BYTES(4, width) *
 					                ALIGN_BYTES(4, (int)height) / 2;
 					break;
 #endif /* ENABLE_PVRTC */
@@ -240,7 +281,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 				case GL_COMPRESSED_SIGNED_LUMINANCE_LATC1_EXT:
 					// 16 pixels compressed into 64 bits. (4bpp)
 					// NOTE: Width and height must be rounded to the nearest tile. (4x4)
-					expected_size = ALIGN_BYTES(4, ktxHeader.pixelWidth) *
+					expected_size = ALIGN_BYTES(4, width) *
 					                ALIGN_BYTES(4, (int)height) / 2;
 					break;
 
@@ -262,14 +303,14 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 				case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
 					// 16 pixels compressed into 128 bits. (8bpp)
 					// NOTE: Width and height must be rounded to the nearest tile. (4x4)
-					expected_size = ALIGN_BYTES(4, ktxHeader.pixelWidth) *
+					expected_size = ALIGN_BYTES(4, width) *
 					                ALIGN_BYTES(4, (int)height);
 					break;
 
 				case GL_RGB9_E5:
 					// Uncompressed "special" 32bpp formats.
 					// TODO: Does KTX handle GL_RGB9_E5 as compressed?
-					expected_size = ktxHeader.pixelWidth * height * 4;
+					expected_size = width * height * 4;
 					break;
 
 				default:
@@ -280,7 +321,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 	}
 
 	// Verify file size.
-	if (texDataStartAddr + expected_size > file_sz) {
+	if (mipAddr + expected_size > file_sz) {
 		// File is too small.
 		return nullptr;
 	}
@@ -321,25 +362,26 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 	// TODO: Byteswapping.
 	// TODO: Handle variants. Check for channel sizes in glInternalFormat?
 	// TODO: Handle sRGB post-processing? (for e.g. GL_SRGB8)
+	rp_image *img = nullptr;
 	switch (ktxHeader.glFormat) {
 		case GL_RGB:
 			// 24-bit RGB.
 			img = ImageDecoder::fromLinear24(ImageDecoder::PXF_BGR888,
-				ktxHeader.pixelWidth, height,
+				width, height,
 				buf.get(), expected_size, stride);
 			break;
 
 		case GL_RGBA:
 			// 32-bit RGBA.
 			img = ImageDecoder::fromLinear32(ImageDecoder::PXF_ABGR8888,
-				ktxHeader.pixelWidth, height,
+				width, height,
 				reinterpret_cast<const uint32_t*>(buf.get()), expected_size, stride);
 			break;
 
 		case GL_LUMINANCE:
 			// 8-bit Luminance.
 			img = ImageDecoder::fromLinear8(ImageDecoder::PXF_L8,
-				ktxHeader.pixelWidth, height,
+				width, height,
 				buf.get(), expected_size, stride);
 			break;
 
@@ -347,7 +389,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 			// Uncompressed "special" 32bpp formats.
 			// TODO: Does KTX handle GL_RGB9_E5 as compressed?
 			img = ImageDecoder::fromLinear32(ImageDecoder::PXF_RGB9_E5,
-				ktxHeader.pixelWidth, height,
+				width, height,
 				reinterpret_cast<const uint32_t*>(buf.get()), expected_size, stride);
 			break;
 
@@ -361,21 +403,21 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 				case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
 					// DXT1-compressed texture.
 					img = ImageDecoder::fromDXT1(
-						ktxHeader.pixelWidth, height,
+						width, height,
 						buf.get(), expected_size);
 					break;
 
 				case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
 					// DXT1-compressed texture with 1-bit alpha.
 					img = ImageDecoder::fromDXT1_A1(
-						ktxHeader.pixelWidth, height,
+						width, height,
 						buf.get(), expected_size);
 					break;
 
 				case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
 					// DXT3-compressed texture.
 					img = ImageDecoder::fromDXT3(
-						ktxHeader.pixelWidth, height,
+						width, height,
 						buf.get(), expected_size);
 					break;
 
@@ -384,14 +426,14 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 				case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
 					// DXT5-compressed texture.
 					img = ImageDecoder::fromDXT5(
-						ktxHeader.pixelWidth, height,
+						width, height,
 						buf.get(), expected_size);
 					break;
 
 				case GL_ETC1_RGB8_OES:
 					// ETC1-compressed texture.
 					img = ImageDecoder::fromETC1(
-						ktxHeader.pixelWidth, height,
+						width, height,
 						buf.get(), expected_size);
 					break;
 
@@ -400,7 +442,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// ETC2-compressed RGB texture.
 					// TODO: Handle sRGB.
 					img = ImageDecoder::fromETC2_RGB(
-						ktxHeader.pixelWidth, height,
+						width, height,
 						buf.get(), expected_size);
 					break;
 
@@ -410,7 +452,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// with punchthrough alpha.
 					// TODO: Handle sRGB.
 					img = ImageDecoder::fromETC2_RGB_A1(
-						ktxHeader.pixelWidth, height,
+						width, height,
 						buf.get(), expected_size);
 					break;
 
@@ -420,7 +462,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// with EAC-compressed alpha channel.
 					// TODO: Handle sRGB.
 					img = ImageDecoder::fromETC2_RGBA(
-						ktxHeader.pixelWidth, height,
+						width, height,
 						buf.get(), expected_size);
 					break;
 
@@ -429,7 +471,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// RGTC, one component. (BC4)
 					// TODO: Handle signed properly.
 					img = ImageDecoder::fromBC4(
-						ktxHeader.pixelWidth, height,
+						width, height,
 						buf.get(), expected_size);
 					break;
 
@@ -438,7 +480,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// RGTC, two components. (BC5)
 					// TODO: Handle signed properly.
 					img = ImageDecoder::fromBC5(
-						ktxHeader.pixelWidth, height,
+						width, height,
 						buf.get(), expected_size);
 					break;
 
@@ -447,7 +489,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// LATC, one component. (BC4)
 					// TODO: Handle signed properly.
 					img = ImageDecoder::fromBC4(
-						ktxHeader.pixelWidth, height,
+						width, height,
 						buf.get(), expected_size);
 					// TODO: If this fails, return it anyway or return nullptr?
 					ImageDecoder::fromRed8ToL8(img);
@@ -458,7 +500,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// LATC, two components. (BC5)
 					// TODO: Handle signed properly.
 					img = ImageDecoder::fromBC5(
-						ktxHeader.pixelWidth, height,
+						width, height,
 						buf.get(), expected_size);
 					// TODO: If this fails, return it anyway or return nullptr?
 					ImageDecoder::fromRG8ToLA8(img);
@@ -468,35 +510,35 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 				case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
 					// BPTC-compressed RGBA texture. (BC7)
 					img = ImageDecoder::fromBC7(
-						ktxHeader.pixelWidth, height,
+						width, height,
 						buf.get(), expected_size);
 					break;
 
 #ifdef ENABLE_PVRTC
 				case GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG:
 					// PVRTC, 2bpp, no alpha.
-					img = ImageDecoder::fromPVRTC(ktxHeader.pixelWidth, height,
+					img = ImageDecoder::fromPVRTC(width, height,
 						buf.get(), expected_size,
 						ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_NONE);
 					break;
 
 				case GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG:
 					// PVRTC, 2bpp, has alpha.
-					img = ImageDecoder::fromPVRTC(ktxHeader.pixelWidth, height,
+					img = ImageDecoder::fromPVRTC(width, height,
 						buf.get(), expected_size,
 						ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES);
 					break;
 
 				case GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG:
 					// PVRTC, 4bpp, no alpha.
-					img = ImageDecoder::fromPVRTC(ktxHeader.pixelWidth, height,
+					img = ImageDecoder::fromPVRTC(width, height,
 						buf.get(), expected_size,
 						ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_NONE);
 					break;
 
 				case GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG:
 					// PVRTC, 4bpp, has alpha.
-					img = ImageDecoder::fromPVRTC(ktxHeader.pixelWidth, height,
+					img = ImageDecoder::fromPVRTC(width, height,
 						buf.get(), expected_size,
 						ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES);
 					break;
@@ -504,7 +546,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 				case GL_COMPRESSED_RGBA_PVRTC_2BPPV2_IMG:
 					// PVRTC-II, 2bpp.
 					// NOTE: Assuming this has alpha.
-					img = ImageDecoder::fromPVRTCII(ktxHeader.pixelWidth, height,
+					img = ImageDecoder::fromPVRTCII(width, height,
 						buf.get(), expected_size,
 						ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES);
 					break;
@@ -512,7 +554,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 				case GL_COMPRESSED_RGBA_PVRTC_4BPPV2_IMG:
 					// PVRTC-II, 4bpp.
 					// NOTE: Assuming this has alpha.
-					img = ImageDecoder::fromPVRTCII(ktxHeader.pixelWidth, height,
+					img = ImageDecoder::fromPVRTCII(width, height,
 						buf.get(), expected_size,
 						ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES);
 					break;
@@ -522,7 +564,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// Uncompressed "special" 32bpp formats.
 					// TODO: Does KTX handle GL_RGB9_E5 as compressed?
 					img = ImageDecoder::fromLinear32(ImageDecoder::PXF_RGB9_E5,
-						ktxHeader.pixelWidth, height,
+						width, height,
 						reinterpret_cast<const uint32_t*>(buf.get()), expected_size);
 					break;
 
@@ -535,7 +577,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 
 	// Post-processing: Check if a flip is needed.
 	if (img && (flipOp != rp_image::FLIP_NONE) && height > 1) {
-		// TODO: Assert that img dimensions match ktxHeader?
+		// TODO: Assert that img dimensions match the mipmap level?
 		rp_image *const flipimg = img->flip(flipOp);
 		if (flipimg) {
 			img->unref();
@@ -543,6 +585,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 		}
 	}
 
+	mipmaps[mip] = img;
 	return img;
 }
 
@@ -749,6 +792,17 @@ KhronosKTX::KhronosKTX(IRpFile *file)
 	if (d->ktxHeader.pixelDepth > 1) {
 		d->dimensions[2] = d->ktxHeader.pixelDepth;
 	}
+
+	// Allocate the mipmap array.
+	// NOTE: 32768x32768 has a maximum of 16 mipmap levels.
+	unsigned int mipmapCount = d->ktxHeader.numberOfMipmapLevels;
+	if (mipmapCount == 0) {
+		// No mipmaps == one image.
+		mipmapCount = 1;
+	} else if (mipmapCount > 16) {
+		mipmapCount = 16;
+	}
+	d->mipmaps.resize(mipmapCount);
 }
 
 /**
@@ -1039,11 +1093,8 @@ const rp_image *KhronosKTX::mipmap(int mip) const
 		return nullptr;
 	}
 
-	// FIXME: Support decoding mipmaps.
-	if (mip == 0) {
-		return const_cast<KhronosKTXPrivate*>(d)->loadImage();
-	}
-	return nullptr;
+	// Load the image.
+	return const_cast<KhronosKTXPrivate*>(d)->loadImage(mip);
 }
 
 }
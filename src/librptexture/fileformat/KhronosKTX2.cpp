@@ -31,6 +31,7 @@ using LibRpFile::IRpFile;
 
 // librptexture
 #include "img/rp_image.hpp"
+#include "img/rp_image_backend_view.hpp"
 #include "decoder/ImageDecoder.hpp"
 
 // C++ STL classes.
@@ -43,10 +44,24 @@ using std::vector;
 // FIXME: Move out of librpbase?
 #include "librpbase/uvector.h"
 
+// zstd (supercompression)
+#ifdef HAVE_ZSTD
+#  include <zstd.h>
+#  ifdef _MSC_VER
+// MSVC: Exception handling for /DELAYLOAD.
+#    include "libwin32common/DelayLoadHelper.h"
+#  endif /* _MSC_VER */
+#endif /* HAVE_ZSTD */
+
 namespace LibRpTexture {
 
 FILEFORMAT_IMPL(KhronosKTX2)
 
+#if defined(HAVE_ZSTD) && defined(_MSC_VER)
+// DelayLoad test implementation.
+DELAYLOAD_TEST_FUNCTION_IMPL0(ZSTD_versionNumber);
+#endif /* HAVE_ZSTD && _MSC_VER */
+
 class KhronosKTX2Private final : public FileFormatPrivate
 {
 	public:
@@ -90,6 +105,25 @@ class KhronosKTX2Private final : public FileFormatPrivate
 		 */
 		const rp_image *loadImage(int mip);
 
+#ifdef HAVE_ZSTD
+		/**
+		 * Decompress a zstd-supercompressed mipmap level.
+		 *
+		 * The compressed data is streamed from the file, and
+		 * decompression stops once the output buffer is full,
+		 * so other levels and any additional faces or layers
+		 * in this level are never decompressed.
+		 *
+		 * The file must be positioned at the start of the level.
+		 *
+		 * @param mipinfo	[in] Mipmap level index.
+		 * @param buf		[out] Output buffer.
+		 * @param size		[in] Number of bytes to decompress.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int decompressZstdLevel(const KTX2_Mipmap_Index &mipinfo, uint8_t *buf, size_t size);
+#endif /* HAVE_ZSTD */
+
 		/**
 		 * Load key/value data.
 		 */
@@ -152,9 +186,27 @@ const rp_image *KhronosKTX2Private::loadImage(int mip)
 		return nullptr;
 	}
 
-	// TODO: Support supercompression.
-	if (ktx2Header.supercompressionScheme != 0) {
-		return nullptr;
+	// Check the supercompression scheme.
+	switch (ktx2Header.supercompressionScheme) {
+		case KTX2_SUPERZ_NONE:
+			break;
+
+#ifdef HAVE_ZSTD
+		case KTX2_SUPERZ_ZSTD:
+#  if defined(_MSC_VER) && defined(ZSTD_IS_DLL)
+			// Delay load verification.
+			// TODO: Only if linked with /DELAYLOAD?
+			if (DelayLoad_test_ZSTD_versionNumber() != 0) {
+				// Delay load failed.
+				return nullptr;
+			}
+#  endif /* _MSC_VER && ZSTD_IS_DLL */
+			break;
+#endif /* HAVE_ZSTD */
+
+		default:
+			// TODO: Support other supercompression schemes.
+			return nullptr;
 	}
 
 	// TODO: For VK_FORMAT_UNDEFINED, parse the DFD.
@@ -205,7 +257,8 @@ const rp_image *KhronosKTX2Private::loadImage(int mip)
 	}
 
 	// Calculate the expected size.
-	// NOTE: Scanlines are 4-byte aligned.
+	// NOTE: Unlike KTX1, KTX2 scanlines are *not* 4-byte aligned.
+	// This matters for smaller mipmap levels.
 	// TODO: Differences between UNORM, UINT, SRGB; handle SNORM, SINT.
 	uint32_t expected_size;
 	int stride = 0;
@@ -217,7 +270,7 @@ const rp_image *KhronosKTX2Private::loadImage(int mip)
 		case VK_FORMAT_B8G8R8_UINT:
 		case VK_FORMAT_B8G8R8_SRGB:
 			// 24-bit RGB.
-			stride = ALIGN_BYTES(4, width * 3);
+			stride = width * 3;
 			expected_size = static_cast<unsigned int>(stride * height);
 			break;
 
@@ -236,7 +289,7 @@ const rp_image *KhronosKTX2Private::loadImage(int mip)
 		case VK_FORMAT_R8_UINT:
 		case VK_FORMAT_R8_SRGB:
 			// 8-bit. (red)
-			stride = ALIGN_BYTES(4, width);
+			stride = width;
 			expected_size = static_cast<unsigned int>(stride * height);
 			break;
 
@@ -317,25 +370,51 @@ const rp_image *KhronosKTX2Private::loadImage(int mip)
 			return nullptr;
 	}
 
-	// Verify mipmap size.
-	if (mipinfo.byteLength < expected_size) {
-		// Mipmap level is too small.
-		// TODO: Should we require the exact size?
-		return nullptr;
-	}
+	auto buf = aligned_uptr<uint8_t>(16, expected_size);
+#ifdef HAVE_ZSTD
+	if (ktx2Header.supercompressionScheme == KTX2_SUPERZ_ZSTD) {
+		// Verify mipmap size.
+		if (mipinfo.uncompressedByteLength < expected_size) {
+			// Mipmap level is too small.
+			return nullptr;
+		}
 
-	// Verify file size.
-	if (mipinfo.byteOffset + expected_size > file_sz) {
-		// File is too small.
-		return nullptr;
-	}
+		// Verify file size.
+		if (mipinfo.byteLength > file_sz ||
+		    mipinfo.byteOffset + mipinfo.byteLength > file_sz)
+		{
+			// File is too small.
+			return nullptr;
+		}
 
-	// Read the texture data.
-	auto buf = aligned_uptr<uint8_t>(16, expected_size);
-	size_t size = file->read(buf.get(), expected_size);
-	if (size != expected_size) {
-		// Read error.
-		return nullptr;
+		// Decompress the texture data.
+		ret = decompressZstdLevel(mipinfo, buf.get(), expected_size);
+		if (ret != 0) {
+			// Decompression error.
+			return nullptr;
+		}
+	} else
+#endif /* HAVE_ZSTD */
+	{
+		// Verify mipmap size.
+		if (mipinfo.byteLength < expected_size) {
+			// Mipmap level is too small.
+			// TODO: Should we require the exact size?
+			return nullptr;
+		}
+
+		// Verify file size.
+		if (mipinfo.byteOffset + expected_size > file_sz) {
+			// File is too small.
+			return nullptr;
+		}
+
+		// Read the texture data.
+		size_t size = file->read(buf.get(), expected_size);
+		if (size != expected_size) {
+			// Read error.
+			return nullptr;
+		}
 	}
 
 	// TODO: Handle sRGB post-processing? (for e.g. GL_SRGB8)
@@ -370,12 +449,16 @@ const rp_image *KhronosKTX2Private::loadImage(int mip)
 
 		case VK_FORMAT_B8G8R8A8_UNORM:
 		case VK_FORMAT_B8G8R8A8_UINT:
-		case VK_FORMAT_B8G8R8A8_SRGB:
+		case VK_FORMAT_B8G8R8A8_SRGB: {
 			// 32-bit RGBA. (R/B swapped)
+			// NOTE: This matches rp_image's ARGB32 format, so the
+			// rp_image will reference the texture data directly.
+			rp_image_buffer *const imgbuf = new rp_image_buffer_aligned(buf.release(), expected_size);
 			img = ImageDecoder::fromLinear32(ImageDecoder::PXF_ARGB8888,
-				width, height,
-				reinterpret_cast<const uint32_t*>(buf.get()), expected_size, stride);
+				width, height, imgbuf, stride);
+			imgbuf->unref();
 			break;
+		}
 
 		case VK_FORMAT_R8_UNORM:
 		case VK_FORMAT_R8_UINT:
@@ -524,6 +607,75 @@ const rp_image *KhronosKTX2Private::loadImage(int mip)
 	return img;
 }
 
+#ifdef HAVE_ZSTD
+/**
+ * Decompress a zstd-supercompressed mipmap level.
+ *
+ * The compressed data is streamed from the file, and
+ * decompression stops once the output buffer is full,
+ * so other levels and any additional faces or layers
+ * in this level are never decompressed.
+ *
+ * The file must be positioned at the start of the level.
+ *
+ * @param mipinfo	[in] Mipmap level index.
+ * @param buf		[out] Output buffer.
+ * @param size		[in] Number of bytes to decompress.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int KhronosKTX2Private::decompressZstdLevel(const KTX2_Mipmap_Index &mipinfo, uint8_t *buf, size_t size)
+{
+	ZSTD_DStream *const dstream = ZSTD_createDStream();
+	if (!dstream) {
+		return -ENOMEM;
+	}
+
+	// Compressed data is read in chunks of the
+	// recommended zstd input buffer size.
+	const size_t in_buf_size = ZSTD_DStreamInSize();
+	unique_ptr<uint8_t[]> in_buf(new uint8_t[in_buf_size]);
+	ZSTD_inBuffer input = { in_buf.get(), 0, 0 };
+	ZSTD_outBuffer output = { buf, size, 0 };
+	uint64_t compr_remain = mipinfo.byteLength;
+
+	int ret = 0;
+	while (output.pos < output.size) {
+		if (input.pos == input.size) {
+			// Read more compressed data.
+			if (compr_remain == 0) {
+				// Level data is truncated.
+				ret = -EIO;
+				break;
+			}
+			const size_t to_read = static_cast<size_t>(
+				std::min(static_cast<uint64_t>(in_buf_size), compr_remain));
+			if (file->read(in_buf.get(), to_read) != to_read) {
+				// Read error.
+				ret = -EIO;
+				break;
+			}
+			compr_remain -= to_read;
+			input.size = to_read;
+			input.pos = 0;
+		}
+
+		const size_t zret = ZSTD_decompressStream(dstream, &output, &input);
+		if (ZSTD_isError(zret)) {
+			// Decompression error.
+			ret = -EIO;
+			break;
+		} else if (zret == 0 && output.pos < output.size) {
+			// End of frame, but the output buffer isn't full.
+			ret = -EIO;
+			break;
+		}
+	}
+
+	ZSTD_freeDStream(dstream);
+	return ret;
+}
+#endif /* HAVE_ZSTD */
+
 /**
  * Load key/value data.
  */
@@ -25,6 +25,7 @@ using LibRpFile::IRpFile;
 
 // librptexture
 #include "img/rp_image.hpp"
+#include "img/rp_image_backend_view.hpp"
 #include "decoder/ImageDecoder.hpp"
 
 // C++ STL classes.
@@ -467,13 +468,18 @@ const rp_image *PowerVR3Private::loadImage(int mip)
 					width, height, buf.get(), expected_size);
 				break;
 
-			case 32:
+			case 32: {
 				// 32-bit
+				// NOTE: If the pixel format matches rp_image's ARGB32
+				// format, the rp_image will reference the texture data
+				// directly, so transfer ownership to an rp_image_buffer.
+				rp_image_buffer *const imgbuf = new rp_image_buffer_aligned(buf.release(), expected_size);
 				img = ImageDecoder::fromLinear32(
 					static_cast<ImageDecoder::PixelFormat>(fmtLkup->pxfmt),
-					width, height,
-					reinterpret_cast<const uint32_t*>(buf.get()), expected_size);
+					width, height, imgbuf);
+				imgbuf->unref();
 				break;
+			}
 
 			default:
 				// Not supported...
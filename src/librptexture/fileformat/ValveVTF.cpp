@@ -24,6 +24,7 @@ using LibRpFile::IRpFile;
 
 // librptexture
 #include "img/rp_image.hpp"
+#include "img/rp_image_backend_view.hpp"
 #include "decoder/ImageDecoder.hpp"
 
 // C++ STL classes.
@@ -529,12 +530,16 @@ const rp_image *ValveVTFPrivate::loadImage(int mip)
 				reinterpret_cast<const uint32_t*>(buf.get()), mdata.size,
 				mdata.row_width * sizeof(uint32_t));
 			break;
-		case VTF_IMAGE_FORMAT_BGRA8888:
+		case VTF_IMAGE_FORMAT_BGRA8888: {
+			// NOTE: This matches rp_image's ARGB32 format, so the
+			// rp_image will reference the texture data directly.
+			rp_image_buffer *const imgbuf = new rp_image_buffer_aligned(buf.release(), mdata.size);
 			img = ImageDecoder::fromLinear32(ImageDecoder::PXF_ARGB8888,
-				mdata.width, mdata.height,
-				reinterpret_cast<const uint32_t*>(buf.get()), mdata.size,
+				mdata.width, mdata.height, imgbuf,
 				mdata.row_width * sizeof(uint32_t));
+			imgbuf->unref();
 			break;
+		}
 		case VTF_IMAGE_FORMAT_BGRx8888:
 			img = ImageDecoder::fromLinear32(ImageDecoder::PXF_xRGB8888,
 				mdata.width, mdata.height,
@@ -20,6 +20,9 @@ using LibRpFile::IRpFile;
 #include "img/rp_image.hpp"
 #include "decoder/ImageDecoder.hpp"
 
+// C++ STL classes.
+using std::vector;
+
 namespace LibRpTexture {
 
 FILEFORMAT_IMPL(XboxXPR)
@@ -49,8 +52,9 @@ class XboxXPRPrivate final : public FileFormatPrivate
 		// XPR0 header.
 		Xbox_XPR0_Header xpr0Header;
 
-		// Decoded image.
-		rp_image *img;
+		// Decoded mipmaps.
+		// Mipmap 0 is the full image.
+		vector<rp_image*> mipmaps;
 
 		// Invalid pixel format message.
 		char invalid_pixel_format[24];
@@ -138,9 +142,10 @@ class XboxXPRPrivate final : public FileFormatPrivate
 
 		/**
 		 * Load the XboxXPR image.
+		 * @param mip Mipmap number. (0 == full image)
 		 * @return Image, or nullptr on error.
 		 */
-		const rp_image *loadXboxXPR0Image(void);
+		const rp_image *loadXboxXPR0Image(int mip);
 };
 
 /** XboxXPRPrivate **/
@@ -148,7 +153,6 @@ class XboxXPRPrivate final : public FileFormatPrivate
 XboxXPRPrivate::XboxXPRPrivate(XboxXPR *q, IRpFile *file)
 	: super(q, file)
 	, xprType(XPRType::Unknown)
-	, img(nullptr)
 {
 	// Clear the structs and arrays.
 	memset(&xpr0Header, 0, sizeof(xpr0Header));
@@ -157,7 +161,7 @@ XboxXPRPrivate::XboxXPRPrivate(XboxXPR *q, IRpFile *file)
 
 XboxXPRPrivate::~XboxXPRPrivate()
 {
-	UNREF(img);
+	std::for_each(mipmaps.begin(), mipmaps.end(), [](rp_image *img) { UNREF(img); });
 }
 
 /**
@@ -288,13 +292,23 @@ void XboxXPRPrivate::unswizzle_box(const uint8_t *src_buf,
 
 /**
  * Load the XPR0 image.
+ * @param mip Mipmap number. (0 == full image)
  * @return Image, or nullptr on error.
  */
-const rp_image *XboxXPRPrivate::loadXboxXPR0Image(void)
+const rp_image *XboxXPRPrivate::loadXboxXPR0Image(int mip)
 {
-	if (img) {
+	// NOTE: The mipmap array is allocated by the constructor.
+	const int mipmapCount = static_cast<int>(mipmaps.size());
+	assert(mip >= 0);
+	assert(mip < mipmapCount);
+	if (mip < 0 || mip >= mipmapCount) {
+		// Invalid mipmap number.
+		return nullptr;
+	}
+
+	if (mipmaps[mip] != nullptr) {
 		// Image has already been loaded.
-		return img;
+		return mipmaps[mip];
 	} else if (!this->file) {
 		// Can't load the image.
 		return nullptr;
@@ -418,26 +432,40 @@ const rp_image *XboxXPRPrivate::loadXboxXPR0Image(void)
 	}
 
 	// Determine the expected size based on the pixel format.
-	const unsigned int area_shift = (xpr0Header.width_pow2 >> 4) +
-					(xpr0Header.height_pow2 & 0x0F);
+	// NOTE: Mipmaps are stored *after* the main image, in order
+	// from largest to smallest. Skip over the larger mipmap levels
+	// to get to the requested one.
+	// DXTn mipmaps are a minimum of one 4x4 block.
 	const auto &mode = mode_tbl[xpr0Header.pixel_format];
-	const uint32_t expected_size = (1U << area_shift) * mode.bpp / 8U;
+	const int min_shift = (mode.dxtn != 0 ? 2 : 0);
+	const int width_shift  = (xpr0Header.width_pow2 >> 4);
+	const int height_shift = (xpr0Header.height_pow2 & 0x0F);
+	uint32_t mipAddr = data_offset;
+	uint32_t expected_size = 0;
+	for (int i = 0; i <= mip; i++) {
+		mipAddr += expected_size;
+		const int w_shift = std::max(width_shift - i, min_shift);
+		const int h_shift = std::max(height_shift - i, min_shift);
+		expected_size = (1U << (w_shift + h_shift)) * mode.bpp / 8U;
+	}
 
-	if (expected_size > file_sz - data_offset) {
+	if (mipAddr > file_sz || expected_size > file_sz - mipAddr) {
 		// File is too small.
 		return nullptr;
 	}
 
 	// Read the image data.
 	auto buf = aligned_uptr<uint8_t>(16, expected_size);
-	size_t size = file->seekAndRead(data_offset, buf.get(), expected_size);
+	size_t size = file->seekAndRead(mipAddr, buf.get(), expected_size);
 	if (size != expected_size) {
 		// Seek and/or read error.
 		return nullptr;
 	}
 
-	const int width  = 1 << (xpr0Header.width_pow2 >> 4);
-	const int height = 1 << (xpr0Header.height_pow2 & 0x0F);
+	// Adjust width/height for the mipmap level.
+	const int width  = 1 << std::max(width_shift - mip, 0);
+	const int height = 1 << std::max(height_shift - mip, 0);
+	rp_image *img = nullptr;
 	if (mode.dxtn != 0) {
 		// DXTn
 		switch (mode.dxtn) {
@@ -496,11 +524,13 @@ const rp_image *XboxXPRPrivate::loadXboxXPR0Image(void)
 		// https://github.com/Cxbx-Reloaded/Cxbx-Reloaded/blob/5d79c0b66e58bf38d39ea28cb4de954209d1e8ad/src/devices/video/swizzle.cpp
 
 		// Image dimensions must be a multiple of 4.
-		assert(width % 4 == 0);
-		assert(height % 4 == 0);
+		// NOTE: Smaller mipmaps may not be a multiple of 4.
+		assert(mip > 0 || width % 4 == 0);
+		assert(mip > 0 || height % 4 == 0);
 		if (width % 4 != 0 || height % 4 != 0) {
 			// Not a multiple of 4.
 			// Return the image as-is.
+			mipmaps[mip] = img;
 			return img;
 		}
 
@@ -512,6 +542,7 @@ const rp_image *XboxXPRPrivate::loadXboxXPR0Image(void)
 			// We have extra bytes.
 			// Can't unswizzle this image right now.
 			// Return the image as-is.
+			mipmaps[mip] = img;
 			return img;
 		}
 
@@ -524,9 +555,9 @@ const rp_image *XboxXPRPrivate::loadXboxXPR0Image(void)
 			img->stride(), sizeof(uint32_t));
 		img->unref();
 		img = imgunswz;
-		return imgunswz;
 	}
 
+	mipmaps[mip] = img;
 	return img;
 }
 
@@ -590,6 +621,15 @@ XboxXPR::XboxXPR(IRpFile *file)
 	d->dimensions[0] = 1 << (d->xpr0Header.width_pow2 >> 4);
 	d->dimensions[1] = 1 << (d->xpr0Header.height_pow2 & 0x0F);
 	d->dimensions[2] = 0;
+
+	// Allocate the mipmap array.
+	// NOTE: The low nybble of width_pow2 is the mipmap count.
+	int mipmapCount = (d->xpr0Header.width_pow2 & 0x0F);
+	if (mipmapCount <= 0) {
+		// No mipmaps == one image.
+		mipmapCount = 1;
+	}
+	d->mipmaps.resize(mipmapCount);
 }
 
 /** Class-specific functions that can be used even if isValid() is false. **/
@@ -745,8 +785,12 @@ const char *XboxXPR::pixelFormat(void) const
  */
 int XboxXPR::mipmapCount(void) const
 {
-	// TODO: Does XPR0 support mipmaps?
-	return -1;
+	RP_D(const XboxXPR);
+	if (!d->isValid || (int)d->xprType < 0)
+		return -1;
+
+	// NOTE: The low nybble of width_pow2 is the mipmap count.
+	return (d->xpr0Header.width_pow2 & 0x0F);
 }
 
 #ifdef ENABLE_LIBRPBASE_ROMFIELDS
@@ -802,14 +846,8 @@ int XboxXPR::getFields(LibRpBase::RomFields *fields) const
  */
 const rp_image *XboxXPR::image(void) const
 {
-	RP_D(const XboxXPR);
-	if (!d->isValid || (int)d->xprType < 0) {
-		// Unknown file type.
-		return nullptr;
-	}
-
-	// Load the image.
-	return const_cast<XboxXPRPrivate*>(d)->loadXboxXPR0Image();
+	// The full image is mipmap 0.
+	return this->mipmap(0);
 }
 
 /**
@@ -820,11 +858,14 @@ const rp_image *XboxXPR::image(void) const
  */
 const rp_image *XboxXPR::mipmap(int mip) const
 {
-	// Allowing mipmap 0 for compatibility.
-	if (mip == 0) {
-		return image();
+	RP_D(const XboxXPR);
+	if (!d->isValid || (int)d->xprType < 0) {
+		// Unknown file type.
+		return nullptr;
 	}
-	return nullptr;
+
+	// Load the image.
+	return const_cast<XboxXPRPrivate*>(d)->loadXboxXPR0Image(mip);
 }
 
 }
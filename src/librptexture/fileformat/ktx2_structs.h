@@ -66,8 +66,8 @@ ASSERT_STRUCT(KTX2_Header, 0x50);
 typedef enum {
 	KTX2_SUPERZ_NONE	= 0,
 	KTX2_SUPERZ_BASISU	= 1,
-	KTX2_SUPERZ_ZLIB	= 2,
-	KTX2_SUPERZ_ZSTD	= 3,
+	KTX2_SUPERZ_ZSTD	= 2,
+	KTX2_SUPERZ_ZLIB	= 3,
 	KTX2_SUPERZ_LZMA	= 4,
 } KTX2_Supercompression_e;
 
@@ -10,6 +10,7 @@
 #include "rp_image.hpp"
 #include "rp_image_p.hpp"
 #include "rp_image_backend.hpp"
+#include "rp_image_pool.hpp"
 
 // Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
 #define rp_imagePrivate rp_image_private
@@ -71,6 +72,7 @@ class rp_image_backend_default : public rp_image_backend
 	private:
 		void *m_data;
 		size_t m_data_len;
+		size_t m_alloc_len;	// Allocated size. (m_data_len may be reduced by shrink().)
 
 		uint32_t *m_palette;
 		int m_palette_len;
@@ -80,6 +82,7 @@ rp_image_backend_default::rp_image_backend_default(int width, int height, rp_ima
 	: super(width, height, format)
 	, m_data(nullptr)
 	, m_data_len(0)
+	, m_alloc_len(0)
 	, m_palette(nullptr)
 	, m_palette_len(0)
 {
@@ -100,13 +103,14 @@ rp_image_backend_default::rp_image_backend_default(int width, int height, rp_ima
 		return;
 	}
 
-	m_data = aligned_malloc(16, m_data_len);
+	m_data = ImagePool::allocBuffer(m_data_len);
 	assert(m_data != nullptr);
 	if (!m_data) {
 		// Failed to allocate memory.
 		clear_properties();
 		return;
 	}
+	m_alloc_len = m_data_len;
 
 	// Do we need to allocate memory for the palette?
 	if (format == rp_image::Format::CI8) {
@@ -114,12 +118,13 @@ rp_image_backend_default::rp_image_backend_default(int width, int height, rp_ima
 		// there's no weird artifacts if the caller
 		// is converting a lower-color image.
 		const size_t palette_sz = 256*sizeof(*m_palette);
-		m_palette = static_cast<uint32_t*>(aligned_malloc(16, palette_sz));
+		m_palette = static_cast<uint32_t*>(ImagePool::allocBuffer(palette_sz));
 		if (!m_palette) {
 			// Failed to allocate memory.
-			aligned_free(m_data);
+			ImagePool::freeBuffer(m_data, m_alloc_len);
 			m_data = nullptr;
 			m_data_len = 0;
+			m_alloc_len = 0;
 			clear_properties();
 			return;
 		}
@@ -132,8 +137,8 @@ rp_image_backend_default::rp_image_backend_default(int width, int height, rp_ima
 
 rp_image_backend_default::~rp_image_backend_default()
 {
-	aligned_free(m_data);
-	aligned_free(m_palette);
+	ImagePool::freeBuffer(m_data, m_alloc_len);
+	ImagePool::freeBuffer(m_palette, m_palette_len * sizeof(*m_palette));
 }
 
 /**
@@ -376,7 +381,8 @@ rp_image::Format rp_image::format(void) const
 const void *rp_image::bits(void) const
 {
 	RP_D(const rp_image);
-	return d->backend->data();
+	const rp_image_backend *const backend = d->backend;
+	return backend->data();
 }
 
 /**
@@ -398,11 +404,12 @@ void *rp_image::bits(void)
 const void *rp_image::scanLine(int i) const
 {
 	RP_D(const rp_image);
-	const uint8_t *data = static_cast<const uint8_t*>(d->backend->data());
+	const rp_image_backend *const backend = d->backend;
+	const uint8_t *data = static_cast<const uint8_t*>(backend->data());
 	if (!data)
 		return nullptr;
 
-	return data + (d->backend->stride * i);
+	return data + (backend->stride * i);
 }
 
 /**
@@ -439,7 +446,8 @@ size_t rp_image::data_len(void) const
 const uint32_t *rp_image::palette(void) const
 {
 	RP_D(const rp_image);
-	return d->backend->palette();
+	const rp_image_backend *const backend = d->backend;
+	return backend->palette();
 }
 
 /**
@@ -22,7 +22,12 @@
 #if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
 # include "librpcpu/cpuflags_x86.h"
 # define RP_IMAGE_HAS_SSE2 1
+# define RP_IMAGE_HAS_SSSE3 1
 # define RP_IMAGE_HAS_SSE41 1
+// TODO: Check 2012; assuming 2013+ for now.
+# if !defined(_MSC_VER) || _MSC_VER >= 1800
+#  define RP_IMAGE_HAS_AVX2 1
+# endif
 #endif
 #ifdef RP_CPU_AMD64
 # define RP_IMAGE_ALWAYS_HAS_SSE2 1
@@ -322,6 +327,93 @@ class rp_image : public RefBase
 		 */
 		rp_image *dup_ARGB32(void) const;
 
+		/**
+		 * Expand CI8 pixels to 32-bit pixels using a palette.
+		 * Standard version using regular C++ code.
+		 *
+		 * This is used by dup_ARGB32(), and can be used by
+		 * frontends that need to convert CI8 images to their
+		 * own 32-bit image formats.
+		 *
+		 * @param dest		[out] Destination buffer. (32-bit pixels)
+		 * @param dest_stride	[in] Destination stride, in bytes.
+		 * @param src		[in] Source buffer. (8-bit palette indexes)
+		 * @param src_stride	[in] Source stride, in bytes.
+		 * @param width		[in] Width, in pixels.
+		 * @param height	[in] Height, in pixels.
+		 * @param palette	[in] Palette. (must have 256 entries)
+		 */
+		static void expand_CI8_cpp(uint32_t *RESTRICT dest, int dest_stride,
+			const uint8_t *RESTRICT src, int src_stride,
+			int width, int height,
+			const uint32_t *RESTRICT palette);
+
+#ifdef RP_IMAGE_HAS_SSSE3
+		/**
+		 * Expand CI8 pixels to 32-bit pixels using a palette.
+		 * SSSE3-optimized version.
+		 *
+		 * If only the first 16 palette entries are non-zero,
+		 * pixels are expanded 16 at a time using pshufb.
+		 * Otherwise, the standard version is used.
+		 *
+		 * @param dest		[out] Destination buffer. (32-bit pixels)
+		 * @param dest_stride	[in] Destination stride, in bytes.
+		 * @param src		[in] Source buffer. (8-bit palette indexes)
+		 * @param src_stride	[in] Source stride, in bytes.
+		 * @param width		[in] Width, in pixels.
+		 * @param height	[in] Height, in pixels.
+		 * @param palette	[in] Palette. (must have 256 entries)
+		 */
+		static void expand_CI8_ssse3(uint32_t *RESTRICT dest, int dest_stride,
+			const uint8_t *RESTRICT src, int src_stride,
+			int width, int height,
+			const uint32_t *RESTRICT palette);
+#endif /* RP_IMAGE_HAS_SSSE3 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Expand CI8 pixels to 32-bit pixels using a palette.
+		 * AVX2-optimized version.
+		 *
+		 * If only the first 16 palette entries are non-zero,
+		 * pixels are expanded 32 at a time using vpshufb.
+		 * Otherwise, pixels are expanded using vpgatherdd.
+		 *
+		 * @param dest		[out] Destination buffer. (32-bit pixels)
+		 * @param dest_stride	[in] Destination stride, in bytes.
+		 * @param src		[in] Source buffer. (8-bit palette indexes)
+		 * @param src_stride	[in] Source stride, in bytes.
+		 * @param width		[in] Width, in pixels.
+		 * @param height	[in] Height, in pixels.
+		 * @param palette	[in] Palette. (must have 256 entries)
+		 */
+		static void expand_CI8_avx2(uint32_t *RESTRICT dest, int dest_stride,
+			const uint8_t *RESTRICT src, int src_stride,
+			int width, int height,
+			const uint32_t *RESTRICT palette);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+		/**
+		 * Expand CI8 pixels to 32-bit pixels using a palette.
+		 *
+		 * This is used by dup_ARGB32(), and can be used by
+		 * frontends that need to convert CI8 images to their
+		 * own 32-bit image formats.
+		 *
+		 * @param dest		[out] Destination buffer. (32-bit pixels)
+		 * @param dest_stride	[in] Destination stride, in bytes.
+		 * @param src		[in] Source buffer. (8-bit palette indexes)
+		 * @param src_stride	[in] Source stride, in bytes.
+		 * @param width		[in] Width, in pixels.
+		 * @param height	[in] Height, in pixels.
+		 * @param palette	[in] Palette. (must have 256 entries)
+		 */
+		static inline void expand_CI8(uint32_t *RESTRICT dest, int dest_stride,
+			const uint8_t *RESTRICT src, int src_stride,
+			int width, int height,
+			const uint32_t *RESTRICT palette);
+
 		/**
 		 * Square the rp_image.
 		 *
@@ -386,6 +478,32 @@ class rp_image : public RefBase
 			Alignment alignment = AlignDefault,
 			uint32_t bgColor = 0x00000000) const;
 
+		/**
+		 * Scaling filters for scaled().
+		 */
+		enum class ScaleFilter : uint8_t {
+			Box = 0,	// Box filter. (area averaging when downscaling)
+			Bilinear = 1,	// Bilinear (triangle) filter.
+			Lanczos = 2,	// Lanczos-3 filter.
+		};
+
+		/**
+		 * Scale the rp_image.
+		 *
+		 * A new ARGB32 rp_image will be created with the specified
+		 * dimensions, and the current image will be resampled using
+		 * the specified filter. CI8 images are converted to ARGB32.
+		 *
+		 * Resampling is done on premultiplied pixels in order to
+		 * prevent fully-transparent pixels from bleeding color.
+		 *
+		 * @param width New width
+		 * @param height New height
+		 * @param filter Scaling filter
+		 * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+		 */
+		rp_image *scaled(int width, int height, ScaleFilter filter = ScaleFilter::Box) const;
+
 		/**
 		 * Un-premultiply this image.
 		 * Standard version using regular C++ code.
@@ -408,6 +526,18 @@ class rp_image : public RefBase
 		int un_premultiply_sse41(void);
 #endif /* RP_IMAGE_HAS_SSE41 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Un-premultiply this image.
+		 * AVX2-optimized version.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		int un_premultiply_avx2(void);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 		/**
 		 * Un-premultiply this image.
 		 *
@@ -424,6 +554,28 @@ class rp_image : public RefBase
 		 */
 		static uint32_t premultiply_pixel(uint32_t px);
 
+		/**
+		 * Premultiply this image.
+		 * Standard version using regular C++ code.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		int premultiply_cpp(void);
+
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Premultiply this image.
+		 * AVX2-optimized version.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		int premultiply_avx2(void);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 		/**
 		 * Premultiply this image.
 		 *
@@ -431,7 +583,7 @@ class rp_image : public RefBase
 		 *
 		 * @return 0 on success; non-zero on error.
 		 */
-		int premultiply(void);
+		inline int premultiply(void);
 
 		/**
 		 * Convert a chroma-keyed image to standard ARGB32.
@@ -463,6 +615,22 @@ class rp_image : public RefBase
 		int apply_chroma_key_sse2(uint32_t key);
 #endif /* RP_IMAGE_HAS_SSE2 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Convert a chroma-keyed image to standard ARGB32.
+		 * AVX2-optimized version.
+		 *
+		 * This operates on the image itself, and does not return
+		 * a duplicated image with the adjusted image.
+		 *
+		 * NOTE: The image *must* be ARGB32.
+		 *
+		 * @param key Chroma key color.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int apply_chroma_key_avx2(uint32_t key);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 		/**
 		 * Convert a chroma-keyed image to standard ARGB32.
 		 *
@@ -503,6 +671,42 @@ class rp_image : public RefBase
 		int shrink(int width, int height);
 };
 
+/**
+ * Expand CI8 pixels to 32-bit pixels using a palette.
+ *
+ * This is used by dup_ARGB32(), and can be used by
+ * frontends that need to convert CI8 images to their
+ * own 32-bit image formats.
+ *
+ * @param dest		[out] Destination buffer. (32-bit pixels)
+ * @param dest_stride	[in] Destination stride, in bytes.
+ * @param src		[in] Source buffer. (8-bit palette indexes)
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param width		[in] Width, in pixels.
+ * @param height	[in] Height, in pixels.
+ * @param palette	[in] Palette. (must have 256 entries)
+ */
+inline void rp_image::expand_CI8(uint32_t *RESTRICT dest, int dest_stride,
+	const uint8_t *RESTRICT src, int src_stride,
+	int width, int height,
+	const uint32_t *RESTRICT palette)
+{
+	// FIXME: Figure out how to get IFUNC working with C++ member functions.
+#ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		expand_CI8_avx2(dest, dest_stride, src, src_stride, width, height, palette);
+	} else
+#endif /* RP_IMAGE_HAS_AVX2 */
+#ifdef RP_IMAGE_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		expand_CI8_ssse3(dest, dest_stride, src, src_stride, width, height, palette);
+	} else
+#endif /* RP_IMAGE_HAS_SSSE3 */
+	{
+		expand_CI8_cpp(dest, dest_stride, src, src_stride, width, height, palette);
+	}
+}
+
 /**
  * Un-premultiply this image.
  *
@@ -512,17 +716,42 @@ class rp_image : public RefBase
  */
 inline int rp_image::un_premultiply(void)
 {
-	// FIXME: Figure out how to get IFUNC working with  C++ member functions.
+	// FIXME: Figure out how to get IFUNC working with C++ member functions.
+#ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return un_premultiply_avx2();
+	} else
+#endif /* RP_IMAGE_HAS_AVX2 */
 #ifdef RP_IMAGE_HAS_SSE41
 	if (RP_CPU_HasSSE41()) {
 		return un_premultiply_sse41();
 	} else
-#endif /* RP_IMAGE_HAS_SSE2 */
+#endif /* RP_IMAGE_HAS_SSE41 */
 	{
 		return un_premultiply_cpp();
 	}
 }
 
+/**
+ * Premultiply this image.
+ *
+ * Image must be ARGB32.
+ *
+ * @return 0 on success; non-zero on error.
+ */
+inline int rp_image::premultiply(void)
+{
+	// FIXME: Figure out how to get IFUNC working with C++ member functions.
+#ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return premultiply_avx2();
+	} else
+#endif /* RP_IMAGE_HAS_AVX2 */
+	{
+		return premultiply_cpp();
+	}
+}
+
 /**
  * Convert a chroma-keyed image to standard ARGB32.
  *
@@ -536,7 +765,12 @@ inline int rp_image::un_premultiply(void)
  */
 inline int rp_image::apply_chroma_key(uint32_t key)
 {
-	// FIXME: Figure out how to get IFUNC working with  C++ member functions.
+	// FIXME: Figure out how to get IFUNC working with C++ member functions.
+#ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return apply_chroma_key_avx2(key);
+	}
+#endif /* RP_IMAGE_HAS_AVX2 */
 #if defined(RP_IMAGE_ALWAYS_HAS_SSE2)
 	// amd64 always has SSE2.
 	return apply_chroma_key_sse2(key);
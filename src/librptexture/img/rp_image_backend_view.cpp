@@ -0,0 +1,146 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_backend_view.cpp: Image backend for externally-owned buffers.  *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image_backend_view.hpp"
+#include "rp_image_pool.hpp"
+
+namespace LibRpTexture {
+
+/** rp_image_buffer_aligned **/
+
+rp_image_buffer_aligned::~rp_image_buffer_aligned()
+{
+	aligned_free(const_cast<void*>(m_data));
+}
+
+/** rp_image_backend_view **/
+
+/**
+ * Create an rp_image_backend_view.
+ * @param buffer	[in] Image buffer. (will be ref()'d)
+ * @param bits		[in] First scanline within the buffer.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param stride	[in] Stride, in bytes.
+ */
+rp_image_backend_view::rp_image_backend_view(rp_image_buffer *buffer, const void *bits,
+	int width, int height, int stride)
+	: super(width, height, rp_image::Format::ARGB32)
+	, m_buffer(nullptr)
+	, m_bits(nullptr)
+	, m_copy(nullptr)
+	, m_copy_len(0)
+{
+	assert(canView(buffer, bits, width, height, stride));
+	if (!canView(buffer, bits, width, height, stride)) {
+		// Cannot reference this buffer.
+		clear_properties();
+		return;
+	}
+
+	m_buffer = buffer->ref();
+	m_bits = bits;
+	this->stride = stride;
+}
+
+rp_image_backend_view::~rp_image_backend_view()
+{
+	ImagePool::freeBuffer(m_copy, m_copy_len);
+	UNREF(m_buffer);
+}
+
+/**
+ * Can the specified buffer be referenced by an rp_image_backend_view?
+ * @param buffer	[in] Image buffer.
+ * @param bits		[in] First scanline within the buffer.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param stride	[in] Stride, in bytes.
+ * @return True if the buffer can be referenced; false if not.
+ */
+bool rp_image_backend_view::canView(const rp_image_buffer *buffer, const void *bits,
+	int width, int height, int stride)
+{
+	if (!buffer || !bits || width <= 0 || height <= 0 ||
+	    stride < width * 4 || (stride % 16) != 0 ||
+	    (reinterpret_cast<uintptr_t>(bits) % 16) != 0)
+	{
+		return false;
+	}
+
+	// Make sure the image is entirely within the buffer.
+	// NOTE: The last row must have the full stride, since
+	// data_len() is (height * stride), and rp_image::dup()
+	// copies data_len() bytes if the strides match.
+	const uint8_t *const buf_start = static_cast<const uint8_t*>(buffer->data());
+	const uint8_t *const img_start = static_cast<const uint8_t*>(bits);
+	if (img_start < buf_start) {
+		return false;
+	}
+	const size_t offset = static_cast<size_t>(img_start - buf_start);
+	const size_t img_len = static_cast<size_t>(height) * stride;
+	return (offset <= buffer->size() && img_len <= buffer->size() - offset);
+}
+
+/**
+ * Get the image data for writing.
+ * The image data is copied from the rp_image_buffer first.
+ * @return Image data.
+ */
+void *rp_image_backend_view::data(void)
+{
+	if (m_copy || !m_bits) {
+		return m_copy;
+	}
+
+	// Copy the image data.
+	const size_t len = data_len();
+	m_copy = ImagePool::allocBuffer(len);
+	if (!m_copy) {
+		// Failed to allocate memory.
+		return nullptr;
+	}
+	m_copy_len = len;
+	memcpy(m_copy, m_bits, len);
+
+	// The rp_image_buffer is no longer needed.
+	m_bits = nullptr;
+	UNREF_AND_NULL_NOCHK(m_buffer);
+	return m_copy;
+}
+
+/**
+ * Shrink image dimensions.
+ * @param width New width.
+ * @param height New height.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rp_image_backend_view::shrink(int width, int height)
+{
+	assert(width > 0);
+	assert(height > 0);
+	assert(this->width > 0);
+	assert(this->height > 0);
+	assert(width <= this->width);
+	assert(height <= this->height);
+	if (width <= 0 || height <= 0 ||
+	    this->width <= 0 || this->height <= 0 ||
+	    width > this->width || height > this->height)
+	{
+		return -EINVAL;
+	}
+
+	// We can simply reduce width/height without actually
+	// adjusting the image data.
+	this->width = width;
+	this->height = height;
+	return 0;
+}
+
+}
@@ -0,0 +1,185 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_backend_view.hpp: Image backend for externally-owned buffers.  *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_BACKEND_VIEW_HPP__
+#define __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_BACKEND_VIEW_HPP__
+
+#include "rp_image_backend.hpp"
+
+namespace LibRpTexture {
+
+/**
+ * Reference-counted image buffer.
+ * Subclasses own the memory, e.g. a heap buffer or an mmap()'d region.
+ */
+class rp_image_buffer : public RefBase
+{
+	protected:
+		rp_image_buffer(const void *data, size_t size)
+			: m_data(data)
+			, m_size(size)
+		{ }
+		virtual ~rp_image_buffer() { }	// call unref() instead
+
+	private:
+		RP_DISABLE_COPY(rp_image_buffer)
+
+	public:
+		inline rp_image_buffer *ref(void)
+		{
+			return RefBase::ref<rp_image_buffer>();
+		}
+
+		/**
+		 * Get the buffer data.
+		 * @return Buffer data.
+		 */
+		inline const void *data(void) const
+		{
+			return m_data;
+		}
+
+		/**
+		 * Get the buffer size.
+		 * @return Buffer size, in bytes.
+		 */
+		inline size_t size(void) const
+		{
+			return m_size;
+		}
+
+	protected:
+		const void *m_data;
+		size_t m_size;
+};
+
+/**
+ * Reference-counted image buffer allocated using aligned_malloc().
+ */
+class rp_image_buffer_aligned : public rp_image_buffer
+{
+	public:
+		/**
+		 * Take ownership of an aligned_malloc()'d buffer.
+		 * @param data Buffer data. (will be freed using aligned_free())
+		 * @param size Buffer size, in bytes.
+		 */
+		rp_image_buffer_aligned(void *data, size_t size)
+			: rp_image_buffer(data, size)
+		{ }
+
+	protected:
+		~rp_image_buffer_aligned() final;
+
+	private:
+		typedef rp_image_buffer super;
+		RP_DISABLE_COPY(rp_image_buffer_aligned)
+};
+
+/**
+ * rp_image backend that references an rp_image_buffer
+ * instead of copying its image data.
+ *
+ * The referenced buffer is never modified. If the image data
+ * is requested for writing, it's copied into a private buffer
+ * first. (copy-on-write)
+ *
+ * Only ARGB32 is supported. The buffer and stride must be
+ * 16-byte aligned, since rp_image's SIMD functions assume
+ * 16-byte alignment.
+ */
+class rp_image_backend_view : public rp_image_backend
+{
+	public:
+		/**
+		 * Create an rp_image_backend_view.
+		 * @param buffer	[in] Image buffer. (will be ref()'d)
+		 * @param bits		[in] First scanline within the buffer.
+		 * @param width		[in] Image width.
+		 * @param height	[in] Image height.
+		 * @param stride	[in] Stride, in bytes.
+		 */
+		rp_image_backend_view(rp_image_buffer *buffer, const void *bits,
+			int width, int height, int stride);
+		virtual ~rp_image_backend_view();
+
+	private:
+		typedef rp_image_backend super;
+		RP_DISABLE_COPY(rp_image_backend_view)
+
+	public:
+		/**
+		 * Can the specified buffer be referenced by an rp_image_backend_view?
+		 * @param buffer	[in] Image buffer.
+		 * @param bits		[in] First scanline within the buffer.
+		 * @param width		[in] Image width.
+		 * @param height	[in] Image height.
+		 * @param stride	[in] Stride, in bytes.
+		 * @return True if the buffer can be referenced; false if not.
+		 */
+		static bool canView(const rp_image_buffer *buffer, const void *bits,
+			int width, int height, int stride);
+
+		/**
+		 * Is the image data still shared with the rp_image_buffer?
+		 * @return True if shared; false if the image data was copied.
+		 */
+		inline bool isShared(void) const
+		{
+			return (m_copy == nullptr);
+		}
+
+	public:
+		void *data(void) final;
+
+		const void *data(void) const final
+		{
+			return (m_copy ? m_copy : m_bits);
+		}
+
+		size_t data_len(void) const final
+		{
+			return static_cast<size_t>(height) * stride;
+		}
+
+		uint32_t *palette(void) final
+		{
+			return nullptr;
+		}
+
+		const uint32_t *palette(void) const final
+		{
+			return nullptr;
+		}
+
+		int palette_len(void) const final
+		{
+			return 0;
+		}
+
+	public:
+		/**
+		 * Shrink image dimensions.
+		 * @param width New width.
+		 * @param height New height.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int shrink(int width, int height) final;
+
+	private:
+		rp_image_buffer *m_buffer;
+		const void *m_bits;
+
+		// Private copy of the image data. (copy-on-write)
+		void *m_copy;
+		size_t m_copy_len;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_BACKEND_VIEW_HPP__ */
@@ -114,26 +114,65 @@ rp_image *rp_image::dup_ARGB32(void) const
 	}
 
 	// Copy the image, converting from CI8 to ARGB32.
-	uint32_t *dest = static_cast<uint32_t*>(img->bits());
-	const uint8_t *src = static_cast<const uint8_t*>(backend->data());
-	const uint32_t *pal = backend->palette();
-	const int dest_adj = (img->stride() / 4) - width;
-	const int src_adj = backend->stride - width;
+	expand_CI8(static_cast<uint32_t*>(img->bits()), img->stride(),
+		static_cast<const uint8_t*>(backend->data()), backend->stride,
+		width, height, backend->palette());
+
+	// Copy sBIT if it's set.
+	if (d->has_sBIT) {
+		img->set_sBIT(&d->sBIT);
+	}
+
+	// Converted to ARGB32.
+	return img;
+}
+
+/**
+ * Expand CI8 pixels to 32-bit pixels using a palette.
+ * Standard version using regular C++ code.
+ *
+ * This is used by dup_ARGB32(), and can be used by
+ * frontends that need to convert CI8 images to their
+ * own 32-bit image formats.
+ *
+ * @param dest		[out] Destination buffer. (32-bit pixels)
+ * @param dest_stride	[in] Destination stride, in bytes.
+ * @param src		[in] Source buffer. (8-bit palette indexes)
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param width		[in] Width, in pixels.
+ * @param height	[in] Height, in pixels.
+ * @param palette	[in] Palette. (must have 256 entries)
+ */
+void rp_image::expand_CI8_cpp(uint32_t *RESTRICT dest, int dest_stride,
+	const uint8_t *RESTRICT src, int src_stride,
+	int width, int height,
+	const uint32_t *RESTRICT palette)
+{
+	assert(dest != nullptr);
+	assert(src != nullptr);
+	assert(palette != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(dest_stride >= width * 4);
+	assert(src_stride >= width);
+
+	const int dest_adj = (dest_stride / 4) - width;
+	const int src_adj = src_stride - width;
 
 	for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
 		// Convert up to 4 pixels per loop iteration.
 		unsigned int x;
 		for (x = static_cast<unsigned int>(width); x > 3; x -= 4) {
-			dest[0] = pal[src[0]];
-			dest[1] = pal[src[1]];
-			dest[2] = pal[src[2]];
-			dest[3] = pal[src[3]];
+			dest[0] = palette[src[0]];
+			dest[1] = palette[src[1]];
+			dest[2] = palette[src[2]];
+			dest[3] = palette[src[3]];
 			dest += 4;
 			src += 4;
 		}
 		// Remaining pixels.
 		for (; x > 0; x--) {
-			*dest = pal[*src];
+			*dest = palette[*src];
 			dest++;
 			src++;
 		}
@@ -142,14 +181,6 @@ rp_image *rp_image::dup_ARGB32(void) const
 		dest += dest_adj;
 		src += src_adj;
 	}
-
-	// Copy sBIT if it's set.
-	if (d->has_sBIT) {
-		img->set_sBIT(&d->sBIT);
-	}
-
-	// Converted to ARGB32.
-	return img;
 }
 
 /**
@@ -579,7 +610,7 @@ rp_image *rp_image::flip(FlipOp op) const
 	}
 
 	RP_D(const rp_image);
-	rp_image_backend *const backend = d->backend;
+	const rp_image_backend *const backend = d->backend;
 
 	const int width = backend->width;
 	const int height = backend->height;
@@ -0,0 +1,240 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_ops.cpp: Image class. (operations)                             *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_p.hpp"
+#include "rp_image_backend.hpp"
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+// Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
+#define rp_imagePrivate rp_image_private
+
+namespace LibRpTexture {
+
+/** Image operations. **/
+
+/**
+ * Expand CI8 pixels to 32-bit pixels using a palette.
+ * AVX2-optimized version.
+ *
+ * If only the first 16 palette entries are non-zero,
+ * pixels are expanded 32 at a time using vpshufb.
+ * Otherwise, pixels are expanded using vpgatherdd.
+ *
+ * @param dest		[out] Destination buffer. (32-bit pixels)
+ * @param dest_stride	[in] Destination stride, in bytes.
+ * @param src		[in] Source buffer. (8-bit palette indexes)
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param width		[in] Width, in pixels.
+ * @param height	[in] Height, in pixels.
+ * @param palette	[in] Palette. (must have 256 entries)
+ */
+void rp_image::expand_CI8_avx2(uint32_t *RESTRICT dest, int dest_stride,
+	const uint8_t *RESTRICT src, int src_stride,
+	int width, int height,
+	const uint32_t *RESTRICT palette)
+{
+	assert(dest != nullptr);
+	assert(src != nullptr);
+	assert(palette != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(dest_stride >= width * 4);
+	assert(src_stride >= width);
+
+	const int dest_adj = (dest_stride / 4) - width;
+	const int src_adj = src_stride - width;
+
+	// Check if palette entries 16-255 are all zero.
+	// This is the case for CI4 images, which use a
+	// 256-entry palette with only 16 entries set.
+	__m256i ymm_hipal = _mm256_setzero_si256();
+	const __m256i *ymm_pal = reinterpret_cast<const __m256i*>(&palette[16]);
+	for (unsigned int i = (256-16)/8; i > 0; i--, ymm_pal++) {
+		ymm_hipal = _mm256_or_si256(ymm_hipal, _mm256_loadu_si256(ymm_pal));
+	}
+
+	if (!_mm256_testz_si256(ymm_hipal, ymm_hipal)) {
+		// More than 16 colors. Use vpgatherdd.
+		const int *const pal_i32 = reinterpret_cast<const int*>(palette);
+		for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+			// Convert 16 pixels per loop iteration.
+			unsigned int x;
+			for (x = static_cast<unsigned int>(width); x > 15; x -= 16) {
+				const __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+				const __m256i idx_lo = _mm256_cvtepu8_epi32(idx);
+				const __m256i idx_hi = _mm256_cvtepu8_epi32(_mm_unpackhi_epi64(idx, idx));
+
+				__m256i *const ymm_dest = reinterpret_cast<__m256i*>(dest);
+				_mm256_storeu_si256(&ymm_dest[0], _mm256_i32gather_epi32(pal_i32, idx_lo, 4));
+				_mm256_storeu_si256(&ymm_dest[1], _mm256_i32gather_epi32(pal_i32, idx_hi, 4));
+
+				dest += 16;
+				src += 16;
+			}
+
+			// Remaining pixels.
+			for (; x > 0; x--) {
+				*dest = palette[*src];
+				dest++;
+				src++;
+			}
+
+			// Next line.
+			dest += dest_adj;
+			src += src_adj;
+		}
+		return;
+	}
+
+	// Split the 16-color palette into B, G, R, and A byte planes.
+	// Each plane is a 16-entry vpshufb lookup table, duplicated
+	// in both 128-bit lanes.
+	const __m128i shuf_bgra = _mm_setr_epi8(0,4,8,12, 1,5,9,13, 2,6,10,14, 3,7,11,15);
+	const __m128i q0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&palette[0])), shuf_bgra);
+	const __m128i q1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&palette[4])), shuf_bgra);
+	const __m128i q2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&palette[8])), shuf_bgra);
+	const __m128i q3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&palette[12])), shuf_bgra);
+	const __m128i t_bg_lo = _mm_unpacklo_epi32(q0, q1);
+	const __m128i t_bg_hi = _mm_unpacklo_epi32(q2, q3);
+	const __m128i t_ra_lo = _mm_unpackhi_epi32(q0, q1);
+	const __m128i t_ra_hi = _mm_unpackhi_epi32(q2, q3);
+	const __m256i plane_b = _mm256_broadcastsi128_si256(_mm_unpacklo_epi64(t_bg_lo, t_bg_hi));
+	const __m256i plane_g = _mm256_broadcastsi128_si256(_mm_unpackhi_epi64(t_bg_lo, t_bg_hi));
+	const __m256i plane_r = _mm256_broadcastsi128_si256(_mm_unpacklo_epi64(t_ra_lo, t_ra_hi));
+	const __m256i plane_a = _mm256_broadcastsi128_si256(_mm_unpackhi_epi64(t_ra_lo, t_ra_hi));
+
+	// Indexes 16-255 map to zero. vpshufb returns zero if the
+	// high bit of the index is set, so set it for those indexes.
+	const __m256i mask_F0 = _mm256_set1_epi8(static_cast<char>(0xF0));
+	const __m256i mask_80 = _mm256_set1_epi8(static_cast<char>(0x80));
+
+	for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+		// Convert 32 pixels per loop iteration.
+		unsigned int x;
+		for (x = static_cast<unsigned int>(width); x > 31; x -= 32) {
+			__m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+			const __m256i in_range = _mm256_cmpeq_epi8(_mm256_and_si256(idx, mask_F0), _mm256_setzero_si256());
+			idx = _mm256_or_si256(idx, _mm256_andnot_si256(in_range, mask_80));
+
+			const __m256i b = _mm256_shuffle_epi8(plane_b, idx);
+			const __m256i g = _mm256_shuffle_epi8(plane_g, idx);
+			const __m256i r = _mm256_shuffle_epi8(plane_r, idx);
+			const __m256i a = _mm256_shuffle_epi8(plane_a, idx);
+
+			// Unpacking is done per 128-bit lane:
+			// - px0: pixels 0-3,  16-19
+			// - px1: pixels 4-7,  20-23
+			// - px2: pixels 8-11, 24-27
+			// - px3: pixels 12-15, 28-31
+			const __m256i bg_lo = _mm256_unpacklo_epi8(b, g);
+			const __m256i bg_hi = _mm256_unpackhi_epi8(b, g);
+			const __m256i ra_lo = _mm256_unpacklo_epi8(r, a);
+			const __m256i ra_hi = _mm256_unpackhi_epi8(r, a);
+			const __m256i px0 = _mm256_unpacklo_epi16(bg_lo, ra_lo);
+			const __m256i px1 = _mm256_unpackhi_epi16(bg_lo, ra_lo);
+			const __m256i px2 = _mm256_unpacklo_epi16(bg_hi, ra_hi);
+			const __m256i px3 = _mm256_unpackhi_epi16(bg_hi, ra_hi);
+
+			__m256i *const ymm_dest = reinterpret_cast<__m256i*>(dest);
+			_mm256_storeu_si256(&ymm_dest[0], _mm256_permute2x128_si256(px0, px1, 0x20));
+			_mm256_storeu_si256(&ymm_dest[1], _mm256_permute2x128_si256(px2, px3, 0x20));
+			_mm256_storeu_si256(&ymm_dest[2], _mm256_permute2x128_si256(px0, px1, 0x31));
+			_mm256_storeu_si256(&ymm_dest[3], _mm256_permute2x128_si256(px2, px3, 0x31));
+
+			dest += 32;
+			src += 32;
+		}
+
+		// Remaining pixels.
+		for (; x > 0; x--) {
+			*dest = palette[*src];
+			dest++;
+			src++;
+		}
+
+		// Next line.
+		dest += dest_adj;
+		src += src_adj;
+	}
+}
+
+/**
+ * Convert a chroma-keyed image to standard ARGB32.
+ * AVX2-optimized version.
+ *
+ * This operates on the image itself, and does not return
+ * a duplicated image with the adjusted image.
+ *
+ * NOTE: The image *must* be ARGB32.
+ *
+ * @param key Chroma key color.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rp_image::apply_chroma_key_avx2(uint32_t key)
+{
+	RP_D(rp_image);
+	rp_image_backend *const backend = d->backend;
+	assert(backend->format == Format::ARGB32);
+	if (backend->format != Format::ARGB32) {
+		// ARGB32 only.
+		return -EINVAL;
+	}
+
+	const unsigned int diff = (backend->stride - this->row_bytes()) / sizeof(uint32_t);
+	uint32_t *img_buf = static_cast<uint32_t*>(backend->data());
+
+	// AVX2 constants.
+	const __m256i ymm_key = _mm256_set1_epi32(static_cast<int>(key));
+
+	for (unsigned int y = static_cast<unsigned int>(backend->height); y > 0; y--) {
+		// Process 16 pixels per iteration with AVX2.
+		unsigned int x = static_cast<unsigned int>(backend->width);
+		for (; x > 15; x -= 16, img_buf += 16) {
+			__m256i *ymm_data = reinterpret_cast<__m256i*>(img_buf);
+			__m256i sa = _mm256_loadu_si256(&ymm_data[0]);
+			__m256i sb = _mm256_loadu_si256(&ymm_data[1]);
+
+			// Compare the pixels to the chroma key.
+			// Equal values will be 0xFFFFFFFF.
+			// Non-equal values will be 0x00000000.
+			// Then, mask the original data with the inverted results.
+			// Original data will now have 00s for chroma-keyed pixels.
+			sa = _mm256_andnot_si256(_mm256_cmpeq_epi32(sa, ymm_key), sa);
+			sb = _mm256_andnot_si256(_mm256_cmpeq_epi32(sb, ymm_key), sb);
+
+			_mm256_storeu_si256(&ymm_data[0], sa);
+			_mm256_storeu_si256(&ymm_data[1], sb);
+		}
+
+		// Remaining pixels.
+		for (; x > 0; x--, img_buf++) {
+			if (*img_buf == key) {
+				*img_buf = 0;
+			}
+		}
+
+		// Next row.
+		img_buf += diff;
+	}
+
+	// Adjust sBIT.
+	// TODO: Only if transparent pixels were found.
+	if (d->has_sBIT && d->sBIT.alpha == 0) {
+		d->sBIT.alpha = 1;
+	}
+
+	// Chroma key applied.
+	return 0;
+}
+
+}
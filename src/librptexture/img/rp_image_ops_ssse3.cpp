@@ -0,0 +1,129 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_ops.cpp: Image class. (operations)                             *
+ * SSSE3-optimized version.                                                *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+
+// SSSE3 intrinsics.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+namespace LibRpTexture {
+
+/** Image operations. **/
+
+/**
+ * Expand CI8 pixels to 32-bit pixels using a palette.
+ * SSSE3-optimized version.
+ *
+ * If only the first 16 palette entries are non-zero,
+ * pixels are expanded 16 at a time using pshufb.
+ * Otherwise, the standard version is used.
+ *
+ * @param dest		[out] Destination buffer. (32-bit pixels)
+ * @param dest_stride	[in] Destination stride, in bytes.
+ * @param src		[in] Source buffer. (8-bit palette indexes)
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param width		[in] Width, in pixels.
+ * @param height	[in] Height, in pixels.
+ * @param palette	[in] Palette. (must have 256 entries)
+ */
+void rp_image::expand_CI8_ssse3(uint32_t *RESTRICT dest, int dest_stride,
+	const uint8_t *RESTRICT src, int src_stride,
+	int width, int height,
+	const uint32_t *RESTRICT palette)
+{
+	assert(dest != nullptr);
+	assert(src != nullptr);
+	assert(palette != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(dest_stride >= width * 4);
+	assert(src_stride >= width);
+
+	// Check if palette entries 16-255 are all zero.
+	// This is the case for CI4 images, which use a
+	// 256-entry palette with only 16 entries set.
+	__m128i xmm_hipal = _mm_setzero_si128();
+	const __m128i *xmm_pal = reinterpret_cast<const __m128i*>(&palette[16]);
+	for (unsigned int i = (256-16)/4; i > 0; i--, xmm_pal++) {
+		xmm_hipal = _mm_or_si128(xmm_hipal, _mm_loadu_si128(xmm_pal));
+	}
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(xmm_hipal, _mm_setzero_si128())) != 0xFFFF) {
+		// More than 16 colors. pshufb can't handle this.
+		expand_CI8_cpp(dest, dest_stride, src, src_stride, width, height, palette);
+		return;
+	}
+
+	// Split the 16-color palette into B, G, R, and A byte planes.
+	// Each plane is a 16-entry pshufb lookup table.
+	const __m128i shuf_bgra = _mm_setr_epi8(0,4,8,12, 1,5,9,13, 2,6,10,14, 3,7,11,15);
+	const __m128i q0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&palette[0])), shuf_bgra);
+	const __m128i q1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&palette[4])), shuf_bgra);
+	const __m128i q2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&palette[8])), shuf_bgra);
+	const __m128i q3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&palette[12])), shuf_bgra);
+	const __m128i t_bg_lo = _mm_unpacklo_epi32(q0, q1);
+	const __m128i t_bg_hi = _mm_unpacklo_epi32(q2, q3);
+	const __m128i t_ra_lo = _mm_unpackhi_epi32(q0, q1);
+	const __m128i t_ra_hi = _mm_unpackhi_epi32(q2, q3);
+	const __m128i plane_b = _mm_unpacklo_epi64(t_bg_lo, t_bg_hi);
+	const __m128i plane_g = _mm_unpackhi_epi64(t_bg_lo, t_bg_hi);
+	const __m128i plane_r = _mm_unpacklo_epi64(t_ra_lo, t_ra_hi);
+	const __m128i plane_a = _mm_unpackhi_epi64(t_ra_lo, t_ra_hi);
+
+	// Indexes 16-255 map to zero. pshufb returns zero if the
+	// high bit of the index is set, so set it for those indexes.
+	const __m128i mask_F0 = _mm_set1_epi8(static_cast<char>(0xF0));
+	const __m128i mask_80 = _mm_set1_epi8(static_cast<char>(0x80));
+
+	const int dest_adj = (dest_stride / 4) - width;
+	const int src_adj = src_stride - width;
+
+	for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+		// Convert 16 pixels per loop iteration.
+		unsigned int x;
+		for (x = static_cast<unsigned int>(width); x > 15; x -= 16) {
+			__m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+			const __m128i in_range = _mm_cmpeq_epi8(_mm_and_si128(idx, mask_F0), _mm_setzero_si128());
+			idx = _mm_or_si128(idx, _mm_andnot_si128(in_range, mask_80));
+
+			const __m128i b = _mm_shuffle_epi8(plane_b, idx);
+			const __m128i g = _mm_shuffle_epi8(plane_g, idx);
+			const __m128i r = _mm_shuffle_epi8(plane_r, idx);
+			const __m128i a = _mm_shuffle_epi8(plane_a, idx);
+
+			const __m128i bg_lo = _mm_unpacklo_epi8(b, g);
+			const __m128i bg_hi = _mm_unpackhi_epi8(b, g);
+			const __m128i ra_lo = _mm_unpacklo_epi8(r, a);
+			const __m128i ra_hi = _mm_unpackhi_epi8(r, a);
+
+			__m128i *const xmm_dest = reinterpret_cast<__m128i*>(dest);
+			_mm_storeu_si128(&xmm_dest[0], _mm_unpacklo_epi16(bg_lo, ra_lo));
+			_mm_storeu_si128(&xmm_dest[1], _mm_unpackhi_epi16(bg_lo, ra_lo));
+			_mm_storeu_si128(&xmm_dest[2], _mm_unpacklo_epi16(bg_hi, ra_hi));
+			_mm_storeu_si128(&xmm_dest[3], _mm_unpackhi_epi16(bg_hi, ra_hi));
+
+			dest += 16;
+			src += 16;
+		}
+
+		// Remaining pixels.
+		for (; x > 0; x--) {
+			*dest = palette[*src];
+			dest++;
+			src++;
+		}
+
+		// Next line.
+		dest += dest_adj;
+		src += src_adj;
+	}
+}
+
+}
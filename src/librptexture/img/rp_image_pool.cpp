@@ -0,0 +1,341 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_pool.cpp: Pooled allocator for image buffers.                  *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image_pool.hpp"
+
+// librpthreads
+#include "config.librpthreads.h"
+#ifdef HAVE_PTHREADS
+# include <pthread.h>
+#endif /* HAVE_PTHREADS */
+
+// C++ includes.
+#include <atomic>
+
+// MSVC 2013 and earlier don't support thread_local.
+// Caching is disabled there, and statistics aren't tracked.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+# define RP_IMAGE_POOL_NO_THREAD_LOCAL 1
+#endif
+
+namespace LibRpTexture { namespace ImagePool {
+
+// Size classes: 4 per power of two, from 1 KiB to 64 MiB.
+static const unsigned int MIN_CLASS_SHIFT = 10;
+static const unsigned int MAX_CLASS_SHIFT = 26;
+static const unsigned int NUM_CLASSES = ((MAX_CLASS_SHIFT - MIN_CLASS_SHIFT) * 4) + 1;
+
+// Maximum number of bytes cached per thread.
+static std::atomic<size_t> max_cached_bytes(0);
+
+/**
+ * Get the size class index for a buffer.
+ * @param size		[in] Requested size, in bytes.
+ * @param pClassSize	[out] Size class, in bytes.
+ * @return Size class index, or -1 if the buffer is too large to be pooled.
+ */
+static int sizeClassIndex(size_t size, size_t *pClassSize)
+{
+	if (size <= (1U << MIN_CLASS_SHIFT)) {
+		*pClassSize = (1U << MIN_CLASS_SHIFT);
+		return 0;
+	} else if (size > (1U << MAX_CLASS_SHIFT)) {
+		*pClassSize = 0;
+		return -1;
+	}
+
+	// Find the highest set bit of (size - 1).
+	// The size is then in the range (2^p, 2^(p+1)].
+	unsigned int p = MIN_CLASS_SHIFT;
+	while (((size - 1) >> (p + 1)) != 0) {
+		p++;
+	}
+
+	// Each power of two is split into 4 classes: 5/4, 6/4, 7/4, and 8/4.
+	const unsigned int step_shift = p - 2;
+	const size_t n = ((size - 1) >> step_shift) + 1;
+	*pClassSize = (n << step_shift);
+	return static_cast<int>(((p - MIN_CLASS_SHIFT) * 4) + (n - 4));
+}
+
+#ifndef RP_IMAGE_POOL_NO_THREAD_LOCAL
+/**
+ * Free buffer list entry.
+ * This is stored in the free buffer itself.
+ */
+struct FreeBuffer {
+	FreeBuffer *next;
+};
+
+/**
+ * Per-thread buffer cache.
+ *
+ * NOTE: This struct must be trivially destructible. rp_image objects
+ * may be freed after the thread's C++ thread_local objects have been
+ * destroyed, e.g. by static or thread_local destructors, so the cache
+ * must remain valid until the thread exits. Cached buffers are released
+ * by threadCleanup() instead of a destructor.
+ */
+struct ThreadCache {
+	FreeBuffer *head[NUM_CLASSES];
+	Stats stats;
+	bool cleanup_registered;	// True if the cleanup hook was registered.
+	bool exited;			// True if threadCleanup() was called.
+};
+
+// Zero-initialized, since it has static storage duration.
+static thread_local ThreadCache tls_cache;
+
+/**
+ * Return all cached buffers in a thread cache to the system.
+ * @param cache Thread cache.
+ */
+static void trimCache(ThreadCache &cache)
+{
+	for (unsigned int i = 0; i < NUM_CLASSES; i++) {
+		FreeBuffer *p = cache.head[i];
+		while (p) {
+			FreeBuffer *const next = p->next;
+			aligned_free(p);
+			cache.stats.sys_free_count++;
+			p = next;
+		}
+		cache.head[i] = nullptr;
+	}
+	cache.stats.cached_bytes = 0;
+}
+
+#ifdef HAVE_PTHREADS
+// pthread key used to call threadCleanup() when a thread exits.
+static pthread_once_t cleanup_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t cleanup_key;
+static bool cleanup_key_valid = false;
+
+/**
+ * pthread key destructor.
+ * @param arg Thread cache.
+ */
+static void cleanupKeyDestructor(void *arg)
+{
+	RP_UNUSED(arg);
+	threadCleanup();
+}
+
+/**
+ * Create the pthread key used for thread cleanup.
+ * Called by pthread_once().
+ */
+static void initCleanupKey(void)
+{
+	cleanup_key_valid = (pthread_key_create(&cleanup_key, cleanupKeyDestructor) == 0);
+}
+#endif /* HAVE_PTHREADS */
+
+/**
+ * Register the calling thread's cleanup hook.
+ * This is done when the thread caches its first buffer.
+ * @param cache Thread cache.
+ */
+static inline void registerThreadCleanup(ThreadCache &cache)
+{
+	if (cache.cleanup_registered)
+		return;
+	cache.cleanup_registered = true;
+
+#ifdef HAVE_PTHREADS
+	// NOTE: The key's value must be non-NULL for the destructor to be called.
+	pthread_once(&cleanup_key_once, initCleanupKey);
+	if (cleanup_key_valid) {
+		pthread_setspecific(cleanup_key, &cache);
+	}
+#endif /* HAVE_PTHREADS */
+}
+#endif /* !RP_IMAGE_POOL_NO_THREAD_LOCAL */
+
+/**
+ * Get the allocation size class for a buffer.
+ * @param size Requested size, in bytes.
+ * @return Size class, in bytes, or 0 if the buffer is too large to be pooled.
+ */
+size_t classSize(size_t size)
+{
+	size_t class_size;
+	sizeClassIndex(size, &class_size);
+	return class_size;
+}
+
+/**
+ * Allocate a buffer.
+ * @param size Size, in bytes.
+ * @return 16-byte aligned buffer, or nullptr on error.
+ */
+void *allocBuffer(size_t size)
+{
+	assert(size > 0);
+	if (size == 0) {
+		return nullptr;
+	}
+
+	// NOTE: The size is always rounded up to the size class,
+	// even if caching is disabled, since caching might be
+	// enabled before the buffer is freed.
+	size_t class_size;
+	const int idx = sizeClassIndex(size, &class_size);
+	if (idx < 0) {
+		class_size = size;
+	}
+
+#ifndef RP_IMAGE_POOL_NO_THREAD_LOCAL
+	ThreadCache &cache = tls_cache;
+	cache.stats.alloc_count++;
+	if (idx >= 0 && cache.head[idx]) {
+		// Found a cached buffer.
+		FreeBuffer *const p = cache.head[idx];
+		cache.head[idx] = p->next;
+		cache.stats.cached_bytes -= class_size;
+		cache.stats.pool_hits++;
+		return p;
+	}
+#endif /* !RP_IMAGE_POOL_NO_THREAD_LOCAL */
+
+	void *const ptr = aligned_malloc(16, class_size);
+#ifndef RP_IMAGE_POOL_NO_THREAD_LOCAL
+	if (ptr) {
+		cache.stats.sys_alloc_count++;
+		cache.stats.sys_alloc_bytes += class_size;
+	}
+#endif /* !RP_IMAGE_POOL_NO_THREAD_LOCAL */
+	return ptr;
+}
+
+/**
+ * Free a buffer allocated by allocBuffer().
+ * @param ptr Buffer.
+ * @param size Size, in bytes. (Must match the size passed to allocBuffer().)
+ */
+void freeBuffer(void *ptr, size_t size)
+{
+	if (!ptr) {
+		return;
+	}
+
+#ifndef RP_IMAGE_POOL_NO_THREAD_LOCAL
+	ThreadCache &cache = tls_cache;
+	cache.stats.free_count++;
+
+	size_t class_size;
+	const int idx = sizeClassIndex(size, &class_size);
+	if (idx >= 0 && !cache.exited &&
+	    cache.stats.cached_bytes + class_size <= max_cached_bytes.load(std::memory_order_relaxed))
+	{
+		// Cache the buffer.
+		registerThreadCleanup(cache);
+		FreeBuffer *const p = static_cast<FreeBuffer*>(ptr);
+		p->next = cache.head[idx];
+		cache.head[idx] = p;
+		cache.stats.cached_bytes += class_size;
+		if (cache.stats.cached_bytes > cache.stats.peak_cached_bytes) {
+			cache.stats.peak_cached_bytes = cache.stats.cached_bytes;
+		}
+		return;
+	}
+
+	cache.stats.sys_free_count++;
+#else /* RP_IMAGE_POOL_NO_THREAD_LOCAL */
+	RP_UNUSED(size);
+#endif /* !RP_IMAGE_POOL_NO_THREAD_LOCAL */
+	aligned_free(ptr);
+}
+
+/**
+ * Set the maximum number of bytes cached per thread.
+ * If the calling thread's cache is larger than the new
+ * maximum, it will be trimmed.
+ * @param max_bytes Maximum number of cached bytes. (0 to disable caching)
+ */
+void setMaxCachedBytes(size_t max_bytes)
+{
+	max_cached_bytes.store(max_bytes, std::memory_order_relaxed);
+#ifndef RP_IMAGE_POOL_NO_THREAD_LOCAL
+	if (tls_cache.stats.cached_bytes > max_bytes) {
+		trimCache(tls_cache);
+	}
+#endif /* !RP_IMAGE_POOL_NO_THREAD_LOCAL */
+}
+
+/**
+ * Get the maximum number of bytes cached per thread.
+ * @return Maximum number of cached bytes. (0 if caching is disabled)
+ */
+size_t maxCachedBytes(void)
+{
+	return max_cached_bytes.load(std::memory_order_relaxed);
+}
+
+/**
+ * Return all of the calling thread's cached buffers to the system.
+ */
+void trim(void)
+{
+#ifndef RP_IMAGE_POOL_NO_THREAD_LOCAL
+	trimCache(tls_cache);
+#endif /* !RP_IMAGE_POOL_NO_THREAD_LOCAL */
+}
+
+/**
+ * Release the calling thread's cached buffers and disable
+ * caching for the rest of the thread's lifetime.
+ *
+ * On systems with pthreads, this is called automatically when
+ * a thread that has cached buffers exits. Otherwise, it must
+ * be called before exiting a thread that may have cached buffers.
+ */
+void threadCleanup(void)
+{
+#ifndef RP_IMAGE_POOL_NO_THREAD_LOCAL
+	// Buffers freed after this point will be
+	// returned to the system immediately.
+	tls_cache.exited = true;
+	trimCache(tls_cache);
+#endif /* !RP_IMAGE_POOL_NO_THREAD_LOCAL */
+}
+
+/**
+ * Get the calling thread's allocation statistics.
+ * @param pStats	[out] Allocation statistics.
+ */
+void getStats(Stats *pStats)
+{
+	assert(pStats != nullptr);
+	if (!pStats)
+		return;
+
+#ifndef RP_IMAGE_POOL_NO_THREAD_LOCAL
+	*pStats = tls_cache.stats;
+#else /* RP_IMAGE_POOL_NO_THREAD_LOCAL */
+	memset(pStats, 0, sizeof(*pStats));
+#endif /* !RP_IMAGE_POOL_NO_THREAD_LOCAL */
+}
+
+/**
+ * Reset the calling thread's allocation statistics.
+ * NOTE: cached_bytes is not reset, since the buffers are still cached.
+ */
+void resetStats(void)
+{
+#ifndef RP_IMAGE_POOL_NO_THREAD_LOCAL
+	Stats &stats = tls_cache.stats;
+	const size_t cached_bytes = stats.cached_bytes;
+	memset(&stats, 0, sizeof(stats));
+	stats.cached_bytes = cached_bytes;
+	stats.peak_cached_bytes = cached_bytes;
+#endif /* !RP_IMAGE_POOL_NO_THREAD_LOCAL */
+}
+
+} }
@@ -0,0 +1,117 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_pool.hpp: Pooled allocator for image buffers.                  *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_POOL_HPP__
+#define __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_POOL_HPP__
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+namespace LibRpTexture { namespace ImagePool {
+
+/**
+ * Image buffer pool.
+ *
+ * The default rp_image backend allocates its pixel and palette
+ * buffers from this pool. Buffer sizes are rounded up to one of
+ * four size classes per power of two, from 1 KiB to 64 MiB.
+ * Larger buffers are always allocated from the system.
+ *
+ * When a buffer is freed, it's kept on a per-thread free list
+ * as long as the thread's cached buffers don't exceed the
+ * memory cap; otherwise, it's returned to the system.
+ *
+ * The memory cap defaults to 0, which disables caching.
+ * Long-running processes that create many images, e.g.
+ * thumbnailers, can opt in by calling setMaxCachedBytes().
+ * The cap may be changed at any time from any thread.
+ *
+ * All buffers are 16-byte aligned.
+ */
+
+/**
+ * Allocation statistics.
+ * Statistics are tracked per thread.
+ */
+struct Stats {
+	uint64_t alloc_count;		// Number of allocBuffer() calls.
+	uint64_t free_count;		// Number of freeBuffer() calls.
+	uint64_t pool_hits;		// Allocations satisfied from the free list.
+	uint64_t sys_alloc_count;	// Allocations from the system allocator.
+	uint64_t sys_alloc_bytes;	// Bytes allocated from the system allocator.
+	uint64_t sys_free_count;	// Buffers returned to the system allocator.
+	size_t cached_bytes;		// Bytes currently held in the free list.
+	size_t peak_cached_bytes;	// Maximum value of cached_bytes.
+};
+
+/**
+ * Get the allocation size class for a buffer.
+ * @param size Requested size, in bytes.
+ * @return Size class, in bytes, or 0 if the buffer is too large to be pooled.
+ */
+size_t classSize(size_t size);
+
+/**
+ * Allocate a buffer.
+ * @param size Size, in bytes.
+ * @return 16-byte aligned buffer, or nullptr on error.
+ */
+void *allocBuffer(size_t size);
+
+/**
+ * Free a buffer allocated by allocBuffer().
+ * @param ptr Buffer.
+ * @param size Size, in bytes. (Must match the size passed to allocBuffer().)
+ */
+void freeBuffer(void *ptr, size_t size);
+
+/**
+ * Set the maximum number of bytes cached per thread.
+ * If the calling thread's cache is larger than the new
+ * maximum, it will be trimmed.
+ * @param max_bytes Maximum number of cached bytes. (0 to disable caching)
+ */
+void setMaxCachedBytes(size_t max_bytes);
+
+/**
+ * Get the maximum number of bytes cached per thread.
+ * @return Maximum number of cached bytes. (0 if caching is disabled)
+ */
+size_t maxCachedBytes(void);
+
+/**
+ * Return all of the calling thread's cached buffers to the system.
+ */
+void trim(void);
+
+/**
+ * Release the calling thread's cached buffers and disable
+ * caching for the rest of the thread's lifetime.
+ *
+ * On systems with pthreads, this is called automatically when
+ * a thread that has cached buffers exits. Otherwise, it must
+ * be called before exiting a thread that may have cached buffers.
+ */
+void threadCleanup(void);
+
+/**
+ * Get the calling thread's allocation statistics.
+ * @param pStats	[out] Allocation statistics.
+ */
+void getStats(Stats *pStats);
+
+/**
+ * Reset the calling thread's allocation statistics.
+ * NOTE: cached_bytes is not reset, since the buffers are still cached.
+ */
+void resetStats(void);
+
+} }
+
+#endif /* __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_POOL_HPP__ */
@@ -0,0 +1,308 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale.cpp: Image class. (scaling)                              *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_scale_p.hpp"
+
+// C includes. (C++ namespace)
+#include <cmath>
+
+namespace LibRpTexture {
+
+namespace ImageScale {
+
+/**
+ * Box filter.
+ * @param x Distance from the center, in filter units.
+ * @return Filter weight.
+ */
+static double filter_box(double x)
+{
+	return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+}
+
+/**
+ * Bilinear (triangle) filter.
+ * @param x Distance from the center, in filter units.
+ * @return Filter weight.
+ */
+static double filter_bilinear(double x)
+{
+	x = fabs(x);
+	return (x < 1.0) ? (1.0 - x) : 0.0;
+}
+
+/**
+ * Normalized sinc function.
+ * @param x
+ * @return sin(pi*x) / (pi*x)
+ */
+static inline double sinc(double x)
+{
+	if (x == 0.0)
+		return 1.0;
+	x *= 3.14159265358979323846;
+	return sin(x) / x;
+}
+
+/**
+ * Lanczos-3 filter.
+ * @param x Distance from the center, in filter units.
+ * @return Filter weight.
+ */
+static double filter_lanczos3(double x)
+{
+	return (x > -3.0 && x < 3.0) ? (sinc(x) * sinc(x / 3.0)) : 0.0;
+}
+
+/**
+ * Calculate filter coefficients for one dimension.
+ * @param coeffs	[out] Filter coefficients.
+ * @param in_size	[in] Source size.
+ * @param out_size	[in] Destination size.
+ * @param filter	[in] Scaling filter.
+ */
+void calcCoeffs(ScaleCoeffs &coeffs, int in_size, int out_size, rp_image::ScaleFilter filter)
+{
+	assert(in_size > 0);
+	assert(out_size > 0);
+
+	double (*filter_fn)(double);
+	double radius;
+	switch (filter) {
+		default:
+			assert(!"Invalid scaling filter.");
+			// fall-through
+		case rp_image::ScaleFilter::Box:
+			filter_fn = filter_box;
+			radius = 0.5;
+			break;
+		case rp_image::ScaleFilter::Bilinear:
+			filter_fn = filter_bilinear;
+			radius = 1.0;
+			break;
+		case rp_image::ScaleFilter::Lanczos:
+			filter_fn = filter_lanczos3;
+			radius = 3.0;
+			break;
+	}
+
+	// When downscaling, the filter is stretched to cover
+	// all source pixels that map to an output pixel.
+	const double scale = static_cast<double>(in_size) / static_cast<double>(out_size);
+	const double fscale = (scale > 1.0 ? scale : 1.0);
+	const double support = radius * fscale;
+
+	// Maximum number of taps, rounded up to a multiple of 4.
+	int taps = static_cast<int>(ceil(support)) * 2 + 1;
+	taps = (taps + 3) & ~3;
+
+	coeffs.start.resize(out_size);
+	coeffs.count.resize(out_size);
+	coeffs.weights.assign(static_cast<size_t>(out_size) * taps, 0);
+	coeffs.taps = taps;
+
+	std::vector<double> fw(taps);
+	int16_t *wp = coeffs.weights.data();
+	for (int i = 0; i < out_size; i++, wp += taps) {
+		const double center = (i + 0.5) * scale;
+		int xmin = static_cast<int>(floor(center - support + 0.5));
+		if (xmin < 0)
+			xmin = 0;
+		int xmax = static_cast<int>(floor(center + support + 0.5));
+		if (xmax > in_size)
+			xmax = in_size;
+		int n = xmax - xmin;
+		if (n > taps)
+			n = taps;
+
+		double total = 0.0;
+		for (int j = 0; j < n; j++) {
+			fw[j] = filter_fn((xmin + j - center + 0.5) / fscale);
+			total += fw[j];
+		}
+		if (total == 0.0) {
+			// No weights. Use the nearest pixel.
+			// (Shouldn't happen, but just in case...)
+			int nearest = static_cast<int>(center);
+			if (nearest >= in_size)
+				nearest = in_size - 1;
+			xmin = nearest;
+			n = 1;
+			fw[0] = total = 1.0;
+		}
+
+		// Convert the weights to fixed-point, and add the rounding
+		// error to the largest weight so the weights add up to exactly
+		// 1.0. Otherwise, solid colors wouldn't be preserved.
+		int isum = 0, jmax = 0;
+		for (int j = 0; j < n; j++) {
+			wp[j] = static_cast<int16_t>(lround(fw[j] / total * (1 << WEIGHT_BITS)));
+			isum += wp[j];
+			if (wp[j] > wp[jmax]) {
+				jmax = j;
+			}
+		}
+		wp[jmax] += static_cast<int16_t>((1 << WEIGHT_BITS) - isum);
+
+		// Trim zero weights from both ends.
+		int first = 0;
+		while (first < n && wp[first] == 0) {
+			first++;
+		}
+		while (n > first && wp[n-1] == 0) {
+			n--;
+		}
+		if (first > 0) {
+			memmove(wp, &wp[first], (n - first) * sizeof(*wp));
+			memset(&wp[n - first], 0, first * sizeof(*wp));
+		}
+
+		coeffs.start[i] = xmin + first;
+		coeffs.count[i] = n - first;
+	}
+}
+
+/**
+ * Vertically filter one row of premultiplied ARGB32 pixels.
+ * Standard version using regular C++ code.
+ * @param dest		[out] Destination row.
+ * @param src		[in] First source row.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param count		[in] Number of source rows.
+ * @param weights	[in] Weights. (one per source row)
+ * @param width		[in] Row width, in pixels.
+ */
+void scaleRowV_cpp(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, int src_stride, int count,
+	const int16_t *RESTRICT weights, int width)
+{
+	const int src_stride_px = src_stride / sizeof(uint32_t);
+	for (int x = 0; x < width; x++) {
+		int b = 0, g = 0, r = 0, a = 0;
+		const uint32_t *p = &src[x];
+		for (int k = 0; k < count; k++, p += src_stride_px) {
+			const int w = weights[k];
+			const uint32_t px = *p;
+			b += static_cast<int>( px        & 0xFF) * w;
+			g += static_cast<int>((px >>  8) & 0xFF) * w;
+			r += static_cast<int>((px >> 16) & 0xFF) * w;
+			a += static_cast<int>( px >> 24        ) * w;
+		}
+		dest[x] = sums_to_ARGB32(b, g, r, a);
+	}
+}
+
+/**
+ * Horizontally filter one row of premultiplied ARGB32 pixels.
+ * Standard version using regular C++ code.
+ * @param dest		[out] Destination row.
+ * @param src		[in] Source row.
+ * @param coeffs	[in] Filter coefficients.
+ */
+void scaleRowH_cpp(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, const ScaleCoeffs &coeffs)
+{
+	const int width = static_cast<int>(coeffs.start.size());
+	const int16_t *wp = coeffs.weights.data();
+	for (int x = 0; x < width; x++, wp += coeffs.taps) {
+		int b = 0, g = 0, r = 0, a = 0;
+		const uint32_t *p = &src[coeffs.start[x]];
+		const int count = coeffs.count[x];
+		for (int k = 0; k < count; k++) {
+			const int w = wp[k];
+			const uint32_t px = p[k];
+			b += static_cast<int>( px        & 0xFF) * w;
+			g += static_cast<int>((px >>  8) & 0xFF) * w;
+			r += static_cast<int>((px >> 16) & 0xFF) * w;
+			a += static_cast<int>( px >> 24        ) * w;
+		}
+		dest[x] = sums_to_ARGB32(b, g, r, a);
+	}
+}
+
+}
+
+/**
+ * Scale the rp_image.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions, and the current image will be resampled using
+ * the specified filter. CI8 images are converted to ARGB32.
+ *
+ * Resampling is done on premultiplied pixels in order to
+ * prevent fully-transparent pixels from bleeding color.
+ *
+ * @param width New width
+ * @param height New height
+ * @param filter Scaling filter
+ * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image *rp_image::scaled(int width, int height, ScaleFilter filter) const
+{
+	assert(width > 0);
+	assert(height > 0);
+	if (width <= 0 || height <= 0) {
+		return nullptr;
+	}
+
+	// Convert to ARGB32.
+	rp_image *const src_img = this->dup_ARGB32();
+	if (!src_img) {
+		return nullptr;
+	}
+	const int src_width = src_img->width();
+	const int src_height = src_img->height();
+	if (src_width == width && src_height == height) {
+		// No scaling is necessary.
+		return src_img;
+	}
+	src_img->premultiply();
+
+	ImageScale::ScaleCoeffs coeffs_v, coeffs_h;
+	ImageScale::calcCoeffs(coeffs_v, src_height, height, filter);
+	ImageScale::calcCoeffs(coeffs_h, src_width, width, filter);
+
+	// Vertical pass: src_width x height
+	auto tmpbuf = aligned_uptr<uint32_t>(16, static_cast<size_t>(src_width) * height);
+	const uint32_t *const src_bits = static_cast<const uint32_t*>(src_img->bits());
+	const int src_stride = src_img->stride();
+	uint32_t *tmp_row = tmpbuf.get();
+	const int16_t *wp = coeffs_v.weights.data();
+	for (int y = 0; y < height; y++, tmp_row += src_width, wp += coeffs_v.taps) {
+		ImageScale::scaleRowV(tmp_row,
+			&src_bits[coeffs_v.start[y] * (src_stride / sizeof(uint32_t))],
+			src_stride, coeffs_v.count[y], wp, src_width);
+	}
+	src_img->unref();
+
+	rp_image *const img = new rp_image(width, height, Format::ARGB32);
+	if (!img->isValid()) {
+		// Image is invalid. Something went wrong.
+		img->unref();
+		return nullptr;
+	}
+
+	// Horizontal pass: width x height
+	tmp_row = tmpbuf.get();
+	for (int y = 0; y < height; y++, tmp_row += src_width) {
+		ImageScale::scaleRowH(static_cast<uint32_t*>(img->scanLine(y)), tmp_row, coeffs_h);
+	}
+	img->un_premultiply();
+
+	// Copy sBIT if it's set.
+	sBIT_t sBIT;
+	if (this->get_sBIT(&sBIT) == 0) {
+		img->set_sBIT(&sBIT);
+	}
+
+	return img;
+}
+
+}
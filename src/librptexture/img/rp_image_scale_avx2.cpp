@@ -0,0 +1,159 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale.cpp: Image class. (scaling)                              *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_scale_p.hpp"
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+namespace LibRpTexture { namespace ImageScale {
+
+/**
+ * Vertically filter one row of premultiplied ARGB32 pixels.
+ * AVX2-optimized version.
+ * @param dest		[out] Destination row.
+ * @param src		[in] First source row.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param count		[in] Number of source rows.
+ * @param weights	[in] Weights. (one per source row)
+ * @param width		[in] Row width, in pixels.
+ */
+void scaleRowV_avx2(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, int src_stride, int count,
+	const int16_t *RESTRICT weights, int width)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i round = _mm256_set1_epi32(1 << (WEIGHT_BITS - 1));
+	const int src_stride_px = src_stride / sizeof(uint32_t);
+
+	// Process 8 pixels per iteration.
+	// Unpacking is done per 128-bit lane:
+	// - acc0: pixels 0, 4
+	// - acc1: pixels 1, 5
+	// - acc2: pixels 2, 6
+	// - acc3: pixels 3, 7
+	// Packing is also done per lane, so the pixels end up in order.
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		__m256i acc0 = round, acc1 = round, acc2 = round, acc3 = round;
+		const uint32_t *p = &src[x];
+		int k = 0;
+		for (; k + 2 <= count; k += 2, p += src_stride_px * 2) {
+			const __m256i w = _mm256_set1_epi32(weight_pair(&weights[k]));
+			const __m256i p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			const __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + src_stride_px));
+			const __m256i p0lo = _mm256_unpacklo_epi8(p0, zero);
+			const __m256i p0hi = _mm256_unpackhi_epi8(p0, zero);
+			const __m256i p1lo = _mm256_unpacklo_epi8(p1, zero);
+			const __m256i p1hi = _mm256_unpackhi_epi8(p1, zero);
+			acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi16(p0lo, p1lo), w));
+			acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi16(p0lo, p1lo), w));
+			acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi16(p0hi, p1hi), w));
+			acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi16(p0hi, p1hi), w));
+		}
+		if (k < count) {
+			// Last source row.
+			const __m256i w = _mm256_set1_epi32(static_cast<uint16_t>(weights[k]));
+			const __m256i p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			const __m256i p0lo = _mm256_unpacklo_epi8(p0, zero);
+			const __m256i p0hi = _mm256_unpackhi_epi8(p0, zero);
+			acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi16(p0lo, zero), w));
+			acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi16(p0lo, zero), w));
+			acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi16(p0hi, zero), w));
+			acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi16(p0hi, zero), w));
+		}
+
+		// NOTE: Rounding is included in the initial sums.
+		acc0 = _mm256_srai_epi32(acc0, WEIGHT_BITS);
+		acc1 = _mm256_srai_epi32(acc1, WEIGHT_BITS);
+		acc2 = _mm256_srai_epi32(acc2, WEIGHT_BITS);
+		acc3 = _mm256_srai_epi32(acc3, WEIGHT_BITS);
+		const __m256i px = _mm256_packus_epi16(
+			_mm256_packs_epi32(acc0, acc1), _mm256_packs_epi32(acc2, acc3));
+
+		// Clamp the color channels to the alpha channel.
+		__m256i alpha = _mm256_srli_epi32(px, 24);
+		alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 8));
+		alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 16));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&dest[x]), _mm256_min_epu8(px, alpha));
+	}
+
+	// Remaining pixels.
+	if (x < width) {
+		scaleRowV_sse2(&dest[x], &src[x], src_stride, count, weights, width - x);
+	}
+}
+
+/**
+ * Horizontally filter one row of premultiplied ARGB32 pixels.
+ * AVX2-optimized version.
+ * @param dest		[out] Destination row.
+ * @param src		[in] Source row.
+ * @param coeffs	[in] Filter coefficients.
+ */
+void scaleRowH_avx2(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, const ScaleCoeffs &coeffs)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi32(1 << (WEIGHT_BITS - 1));
+
+	// Interleave pixel pairs: [B0 B1 G0 G1 R0 R1 A0 A1 | B2 B3 G2 G3 R2 R3 A2 A3]
+	const __m128i shuf_pairs = _mm_setr_epi8(0,4,1,5,2,6,3,7, 8,12,9,13,10,14,11,15);
+	// Broadcast weight pair 0 to the low lane and weight pair 1 to the high lane.
+	const __m256i perm_weights = _mm256_setr_epi32(0,0,0,0, 1,1,1,1);
+
+	const int width = static_cast<int>(coeffs.start.size());
+	const int16_t *wp = coeffs.weights.data();
+	for (int x = 0; x < width; x++, wp += coeffs.taps) {
+		const uint32_t *p = &src[coeffs.start[x]];
+		const int count = coeffs.count[x];
+
+		// Process 4 source pixels per iteration.
+		int k = 0;
+		__m256i acc256 = _mm256_setzero_si256();
+		for (; k + 4 <= count; k += 4) {
+			__m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&p[k]));
+			px = _mm_shuffle_epi8(px, shuf_pairs);
+			const __m256i w = _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(
+				_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&wp[k]))), perm_weights);
+			acc256 = _mm256_add_epi32(acc256, _mm256_madd_epi16(_mm256_cvtepu8_epi16(px), w));
+		}
+		__m128i acc = _mm_add_epi32(round, _mm_add_epi32(
+			_mm256_castsi256_si128(acc256), _mm256_extracti128_si256(acc256, 1)));
+
+		if (k + 2 <= count) {
+			// Two more source pixels.
+			__m128i px = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&p[k]));
+			px = _mm_unpacklo_epi8(_mm_shuffle_epi8(px, shuf_pairs), zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(weight_pair(&wp[k]))));
+			k += 2;
+		}
+		if (k < count) {
+			// Last source pixel: [B0 0 G0 0 R0 0 A0 0]
+			__m128i px = _mm_cvtsi32_si128(static_cast<int>(p[k]));
+			px = _mm_cvtepu8_epi32(px);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(static_cast<uint16_t>(wp[k]))));
+		}
+
+		// NOTE: Rounding is included in the initial sums.
+		acc = _mm_srai_epi32(acc, WEIGHT_BITS);
+		acc = _mm_packs_epi32(acc, acc);
+		acc = _mm_packus_epi16(acc, acc);
+
+		// Clamp the color channels to the alpha channel.
+		__m128i alpha = _mm_srli_epi32(acc, 24);
+		alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 8));
+		alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+		dest[x] = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_min_epu8(acc, alpha)));
+	}
+}
+
+} }
@@ -0,0 +1,235 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale_p.hpp: Image scaling functions. (Private)                *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_SCALE_P_HPP__
+#define __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_SCALE_P_HPP__
+
+#include "rp_image.hpp"
+
+// C++ includes.
+#include <algorithm>
+#include <vector>
+
+namespace LibRpTexture { namespace ImageScale {
+
+/**
+ * Number of fractional bits in the fixed-point filter weights.
+ * The weights for each output pixel add up to (1 << WEIGHT_BITS).
+ */
+static const int WEIGHT_BITS = 14;
+
+/**
+ * Filter coefficients for one dimension.
+ *
+ * Output pixel i is calculated from source pixels
+ * [start[i], start[i] + count[i]), using the weights
+ * at &weights[i * taps].
+ */
+struct ScaleCoeffs {
+	std::vector<int> start;		// First source pixel.
+	std::vector<int> count;		// Number of source pixels.
+	std::vector<int16_t> weights;	// Fixed-point weights. (zero-padded to taps)
+	int taps;			// Weight stride per output pixel. (multiple of 4)
+};
+
+/**
+ * Calculate filter coefficients for one dimension.
+ * @param coeffs	[out] Filter coefficients.
+ * @param in_size	[in] Source size.
+ * @param out_size	[in] Destination size.
+ * @param filter	[in] Scaling filter.
+ */
+void calcCoeffs(ScaleCoeffs &coeffs, int in_size, int out_size, rp_image::ScaleFilter filter);
+
+/**
+ * Convert a fixed-point channel sum to an 8-bit channel value.
+ * @param c Channel sum.
+ * @return Channel value. (0-255)
+ */
+static inline int sum_to_channel(int c)
+{
+	c = (c + (1 << (WEIGHT_BITS - 1))) >> WEIGHT_BITS;
+	return (c < 0 ? 0 : (c > 255 ? 255 : c));
+}
+
+/**
+ * Convert fixed-point channel sums to a premultiplied ARGB32 pixel.
+ * Color channels are clamped to the alpha channel.
+ * @param b Blue sum.
+ * @param g Green sum.
+ * @param r Red sum.
+ * @param a Alpha sum.
+ * @return ARGB32 pixel.
+ */
+static inline uint32_t sums_to_ARGB32(int b, int g, int r, int a)
+{
+	const int a8 = sum_to_channel(a);
+	const int b8 = std::min(sum_to_channel(b), a8);
+	const int g8 = std::min(sum_to_channel(g), a8);
+	const int r8 = std::min(sum_to_channel(r), a8);
+	return (static_cast<uint32_t>(a8) << 24) | (r8 << 16) | (g8 << 8) | b8;
+}
+
+/**
+ * Combine two adjacent weights for use with pmaddwd.
+ * @param weights Weights.
+ * @return weights[0] in the low 16 bits; weights[1] in the high 16 bits.
+ */
+static inline int weight_pair(const int16_t *weights)
+{
+	return static_cast<int>(static_cast<uint16_t>(weights[0]) |
+		(static_cast<uint32_t>(static_cast<uint16_t>(weights[1])) << 16));
+}
+
+/**
+ * Vertically filter one row of premultiplied ARGB32 pixels.
+ * Standard version using regular C++ code.
+ * @param dest		[out] Destination row.
+ * @param src		[in] First source row.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param count		[in] Number of source rows.
+ * @param weights	[in] Weights. (one per source row)
+ * @param width		[in] Row width, in pixels.
+ */
+void scaleRowV_cpp(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, int src_stride, int count,
+	const int16_t *RESTRICT weights, int width);
+
+/**
+ * Horizontally filter one row of premultiplied ARGB32 pixels.
+ * Standard version using regular C++ code.
+ * @param dest		[out] Destination row.
+ * @param src		[in] Source row.
+ * @param coeffs	[in] Filter coefficients.
+ */
+void scaleRowH_cpp(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, const ScaleCoeffs &coeffs);
+
+#ifdef RP_IMAGE_HAS_SSE2
+/**
+ * Vertically filter one row of premultiplied ARGB32 pixels.
+ * SSE2-optimized version.
+ * @param dest		[out] Destination row.
+ * @param src		[in] First source row.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param count		[in] Number of source rows.
+ * @param weights	[in] Weights. (one per source row)
+ * @param width		[in] Row width, in pixels.
+ */
+void scaleRowV_sse2(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, int src_stride, int count,
+	const int16_t *RESTRICT weights, int width);
+
+/**
+ * Horizontally filter one row of premultiplied ARGB32 pixels.
+ * SSE2-optimized version.
+ * @param dest		[out] Destination row.
+ * @param src		[in] Source row.
+ * @param coeffs	[in] Filter coefficients.
+ */
+void scaleRowH_sse2(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, const ScaleCoeffs &coeffs);
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Vertically filter one row of premultiplied ARGB32 pixels.
+ * AVX2-optimized version.
+ * @param dest		[out] Destination row.
+ * @param src		[in] First source row.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param count		[in] Number of source rows.
+ * @param weights	[in] Weights. (one per source row)
+ * @param width		[in] Row width, in pixels.
+ */
+void scaleRowV_avx2(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, int src_stride, int count,
+	const int16_t *RESTRICT weights, int width);
+
+/**
+ * Horizontally filter one row of premultiplied ARGB32 pixels.
+ * AVX2-optimized version.
+ * @param dest		[out] Destination row.
+ * @param src		[in] Source row.
+ * @param coeffs	[in] Filter coefficients.
+ */
+void scaleRowH_avx2(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, const ScaleCoeffs &coeffs);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+/**
+ * Vertically filter one row of premultiplied ARGB32 pixels.
+ * @param dest		[out] Destination row.
+ * @param src		[in] First source row.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param count		[in] Number of source rows.
+ * @param weights	[in] Weights. (one per source row)
+ * @param width		[in] Row width, in pixels.
+ */
+static inline void scaleRowV(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, int src_stride, int count,
+	const int16_t *RESTRICT weights, int width)
+{
+#ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		scaleRowV_avx2(dest, src, src_stride, count, weights, width);
+	} else
+#endif /* RP_IMAGE_HAS_AVX2 */
+#ifdef RP_IMAGE_HAS_SSE2
+# ifdef RP_IMAGE_ALWAYS_HAS_SSE2
+	{
+		scaleRowV_sse2(dest, src, src_stride, count, weights, width);
+	}
+# else /* !RP_IMAGE_ALWAYS_HAS_SSE2 */
+	if (RP_CPU_HasSSE2()) {
+		scaleRowV_sse2(dest, src, src_stride, count, weights, width);
+	} else
+# endif /* RP_IMAGE_ALWAYS_HAS_SSE2 */
+#endif /* RP_IMAGE_HAS_SSE2 */
+#ifndef RP_IMAGE_ALWAYS_HAS_SSE2
+	{
+		scaleRowV_cpp(dest, src, src_stride, count, weights, width);
+	}
+#endif /* !RP_IMAGE_ALWAYS_HAS_SSE2 */
+}
+
+/**
+ * Horizontally filter one row of premultiplied ARGB32 pixels.
+ * @param dest		[out] Destination row.
+ * @param src		[in] Source row.
+ * @param coeffs	[in] Filter coefficients.
+ */
+static inline void scaleRowH(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, const ScaleCoeffs &coeffs)
+{
+#ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		scaleRowH_avx2(dest, src, coeffs);
+	} else
+#endif /* RP_IMAGE_HAS_AVX2 */
+#ifdef RP_IMAGE_HAS_SSE2
+# ifdef RP_IMAGE_ALWAYS_HAS_SSE2
+	{
+		scaleRowH_sse2(dest, src, coeffs);
+	}
+# else /* !RP_IMAGE_ALWAYS_HAS_SSE2 */
+	if (RP_CPU_HasSSE2()) {
+		scaleRowH_sse2(dest, src, coeffs);
+	} else
+# endif /* RP_IMAGE_ALWAYS_HAS_SSE2 */
+#endif /* RP_IMAGE_HAS_SSE2 */
+#ifndef RP_IMAGE_ALWAYS_HAS_SSE2
+	{
+		scaleRowH_cpp(dest, src, coeffs);
+	}
+#endif /* !RP_IMAGE_ALWAYS_HAS_SSE2 */
+}
+
+} }
+
+#endif /* __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_SCALE_P_HPP__ */
@@ -0,0 +1,146 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale.cpp: Image class. (scaling)                              *
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_scale_p.hpp"
+
+// SSE2 intrinsics.
+#include <emmintrin.h>
+
+namespace LibRpTexture { namespace ImageScale {
+
+/**
+ * Convert fixed-point channel sums to premultiplied ARGB32 pixels.
+ * Color channels are clamped to the alpha channel.
+ * @param acc0 Channel sums for pixel 0. (B, G, R, A)
+ * @param acc1 Channel sums for pixel 1. (B, G, R, A)
+ * @param acc2 Channel sums for pixel 2. (B, G, R, A)
+ * @param acc3 Channel sums for pixel 3. (B, G, R, A)
+ * @return 4 ARGB32 pixels.
+ */
+static FORCEINLINE __m128i sums_to_ARGB32_sse2(__m128i acc0, __m128i acc1, __m128i acc2, __m128i acc3)
+{
+	// NOTE: Rounding is included in the initial sums.
+	acc0 = _mm_srai_epi32(acc0, WEIGHT_BITS);
+	acc1 = _mm_srai_epi32(acc1, WEIGHT_BITS);
+	acc2 = _mm_srai_epi32(acc2, WEIGHT_BITS);
+	acc3 = _mm_srai_epi32(acc3, WEIGHT_BITS);
+	const __m128i px = _mm_packus_epi16(_mm_packs_epi32(acc0, acc1), _mm_packs_epi32(acc2, acc3));
+
+	// Clamp the color channels to the alpha channel.
+	__m128i alpha = _mm_srli_epi32(px, 24);
+	alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 8));
+	alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+	return _mm_min_epu8(px, alpha);
+}
+
+/**
+ * Vertically filter one row of premultiplied ARGB32 pixels.
+ * SSE2-optimized version.
+ * @param dest		[out] Destination row.
+ * @param src		[in] First source row.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param count		[in] Number of source rows.
+ * @param weights	[in] Weights. (one per source row)
+ * @param width		[in] Row width, in pixels.
+ */
+void scaleRowV_sse2(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, int src_stride, int count,
+	const int16_t *RESTRICT weights, int width)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi32(1 << (WEIGHT_BITS - 1));
+	const int src_stride_px = src_stride / sizeof(uint32_t);
+
+	// Process 4 pixels per iteration.
+	// Two source rows are interleaved so pmaddwd
+	// can multiply-add both rows at once.
+	int x = 0;
+	for (; x + 4 <= width; x += 4) {
+		__m128i acc0 = round, acc1 = round, acc2 = round, acc3 = round;
+		const uint32_t *p = &src[x];
+		int k = 0;
+		for (; k + 2 <= count; k += 2, p += src_stride_px * 2) {
+			const __m128i w = _mm_set1_epi32(weight_pair(&weights[k]));
+			const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + src_stride_px));
+			const __m128i p0lo = _mm_unpacklo_epi8(p0, zero);
+			const __m128i p0hi = _mm_unpackhi_epi8(p0, zero);
+			const __m128i p1lo = _mm_unpacklo_epi8(p1, zero);
+			const __m128i p1hi = _mm_unpackhi_epi8(p1, zero);
+			acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(p0lo, p1lo), w));
+			acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(p0lo, p1lo), w));
+			acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(p0hi, p1hi), w));
+			acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(p0hi, p1hi), w));
+		}
+		if (k < count) {
+			// Last source row.
+			const __m128i w = _mm_set1_epi32(static_cast<uint16_t>(weights[k]));
+			const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const __m128i p0lo = _mm_unpacklo_epi8(p0, zero);
+			const __m128i p0hi = _mm_unpackhi_epi8(p0, zero);
+			acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(p0lo, zero), w));
+			acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(p0lo, zero), w));
+			acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(p0hi, zero), w));
+			acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(p0hi, zero), w));
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dest[x]),
+			sums_to_ARGB32_sse2(acc0, acc1, acc2, acc3));
+	}
+
+	// Remaining pixels.
+	if (x < width) {
+		scaleRowV_cpp(&dest[x], &src[x], src_stride, count, weights, width - x);
+	}
+}
+
+/**
+ * Horizontally filter one row of premultiplied ARGB32 pixels.
+ * SSE2-optimized version.
+ * @param dest		[out] Destination row.
+ * @param src		[in] Source row.
+ * @param coeffs	[in] Filter coefficients.
+ */
+void scaleRowH_sse2(uint32_t *RESTRICT dest,
+	const uint32_t *RESTRICT src, const ScaleCoeffs &coeffs)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi32(1 << (WEIGHT_BITS - 1));
+
+	const int width = static_cast<int>(coeffs.start.size());
+	const int16_t *wp = coeffs.weights.data();
+	for (int x = 0; x < width; x++, wp += coeffs.taps) {
+		__m128i acc = round;
+		const uint32_t *p = &src[coeffs.start[x]];
+		const int count = coeffs.count[x];
+
+		// Process 2 source pixels per iteration.
+		int k = 0;
+		for (; k + 2 <= count; k += 2) {
+			// Interleave the two pixels: [B0 B1 G0 G1 R0 R1 A0 A1]
+			__m128i px = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&p[k]));
+			px = _mm_unpacklo_epi8(px, _mm_srli_si128(px, 4));
+			px = _mm_unpacklo_epi8(px, zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(weight_pair(&wp[k]))));
+		}
+		if (k < count) {
+			// Last source pixel: [B0 0 G0 0 R0 0 A0 0]
+			__m128i px = _mm_cvtsi32_si128(static_cast<int>(p[k]));
+			px = _mm_unpacklo_epi16(_mm_unpacklo_epi8(px, zero), zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(static_cast<uint16_t>(wp[k]))));
+		}
+
+		dest[x] = static_cast<uint32_t>(_mm_cvtsi128_si32(
+			sums_to_ARGB32_sse2(acc, acc, acc, acc)));
+	}
+}
+
+} }
@@ -133,8 +133,10 @@ int rp_image::un_premultiply_cpp(void)
 static FORCEINLINE uint32_t premultiply_pixel_inl(uint32_t px)
 {
 	const unsigned int a = (px >> 24);
-	if (likely(a == 255 || a == 0))
+	if (likely(a == 255))
 		return px;
+	else if (a == 0)
+		return 0;
 
 	// Based on Qt 5.9.1's qPremultiply().
 	unsigned int t = (px & 0xff00ff) * a;
@@ -159,15 +161,14 @@ uint32_t rp_image::premultiply_pixel(uint32_t px)
 
 /**
  * Premultiply an ARGB32 rp_image.
+ * Standard version using regular C++ code.
  *
  * Image must be ARGB32.
  *
  * @return 0 on success; non-zero on error.
  */
-int rp_image::premultiply(void)
+int rp_image::premultiply_cpp(void)
 {
-	// TODO: Qt doesn't have SSE-optimized builds.
-
 	RP_D(const rp_image);
 	rp_image_backend *const backend = d->backend;
 	assert(backend->format == rp_image::Format::ARGB32);
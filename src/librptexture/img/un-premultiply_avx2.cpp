@@ -0,0 +1,204 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * un-premultiply_avx2.cpp: Un-premultiply function.                       *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2017-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_p.hpp"
+#include "rp_image_backend.hpp"
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+// Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
+#define rp_imagePrivate rp_image_private
+
+namespace LibRpTexture {
+
+/**
+ * Get a mask for the first n pixels of an 8-pixel vector.
+ * Used with vpmaskmovd for the remaining pixels in a row.
+ * @param n Number of pixels. (1-7)
+ * @return Mask.
+ */
+static FORCEINLINE __m256i tail_mask_avx2(unsigned int n)
+{
+	return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)),
+		_mm256_setr_epi32(0,1,2,3,4,5,6,7));
+}
+
+/**
+ * Un-premultiply 8 ARGB32 pixels. (AVX2 version)
+ * Based on qt-5.11.0's qUnpremultiply().
+ *
+ * This produces the same results as the standard version,
+ * including for pixels with color values larger than alpha.
+ *
+ * @param px	[in] ARGB32 pixels.
+ * @return Un-premultiplied pixels.
+ */
+static FORCEINLINE __m256i un_premultiply_px8_avx2(__m256i px)
+{
+	const __m256i mask8 = _mm256_set1_epi32(0xFF);
+	const __m256i round = _mm256_set1_epi32(0x8000);
+
+	// Look up the inverted premultiplication factors.
+	const __m256i alpha = _mm256_srli_epi32(px, 24);
+	const __m256i invAlpha = _mm256_i32gather_epi32(
+		reinterpret_cast<const int*>(rp_image::qt_inv_premul_factor), alpha, 4);
+
+	// (p*(0x00ff00ff/alpha)) >> 16 == (p*255)/alpha for all p and alpha <= 256.
+	// We add 0x8000 to get even rounding.
+	__m256i b = _mm256_and_si256(px, mask8);
+	__m256i g = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask8);
+	__m256i r = _mm256_and_si256(_mm256_srli_epi32(px, 16), mask8);
+	b = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(b, invAlpha), round), 16);
+	g = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(g, invAlpha), round), 16);
+	r = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(r, invAlpha), round), 16);
+
+	// Combine the channels. Results are truncated to 8 bits.
+	__m256i res = _mm256_and_si256(b, mask8);
+	res = _mm256_or_si256(res, _mm256_slli_epi32(_mm256_and_si256(g, mask8), 8));
+	res = _mm256_or_si256(res, _mm256_slli_epi32(_mm256_and_si256(r, mask8), 16));
+	res = _mm256_or_si256(res, _mm256_slli_epi32(alpha, 24));
+
+	// Pixels with alpha == 0 are left as-is.
+	// (alpha == 255 is handled by invAlpha == 65537.)
+	const __m256i is_zero = _mm256_cmpeq_epi32(alpha, _mm256_setzero_si256());
+	return _mm256_blendv_epi8(res, px, is_zero);
+}
+
+/**
+ * Premultiply 8 ARGB32 pixels. (AVX2 version)
+ * Based on qt-5.11.0's qPremultiply().
+ * @param px	[in] ARGB32 pixels.
+ * @return Premultiplied pixels.
+ */
+static FORCEINLINE __m256i premultiply_px8_avx2(__m256i px)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i round = _mm256_set1_epi16(0x80);
+	const __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+	// Broadcast each pixel's alpha value to all four of its words.
+	const __m256i shuf_alpha = _mm256_setr_epi8(
+		6,7,6,7,6,7,6,7, 14,15,14,15,14,15,14,15,
+		6,7,6,7,6,7,6,7, 14,15,14,15,14,15,14,15);
+
+	// Expand the channels to 16-bit.
+	__m256i lo = _mm256_unpacklo_epi8(px, zero);
+	__m256i hi = _mm256_unpackhi_epi8(px, zero);
+
+	// t = c * a; t = (t + (t >> 8) + 0x80) >> 8
+	lo = _mm256_mullo_epi16(lo, _mm256_shuffle_epi8(lo, shuf_alpha));
+	hi = _mm256_mullo_epi16(hi, _mm256_shuffle_epi8(hi, shuf_alpha));
+	lo = _mm256_add_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), round);
+	hi = _mm256_add_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), round);
+	lo = _mm256_srli_epi16(lo, 8);
+	hi = _mm256_srli_epi16(hi, 8);
+
+	// Pack the channels and restore the original alpha channel.
+	return _mm256_blendv_epi8(_mm256_packus_epi16(lo, hi), px, alpha_mask);
+}
+
+/**
+ * Un-premultiply an ARGB32 rp_image.
+ * AVX2-optimized version.
+ *
+ * Image must be ARGB32.
+ *
+ * @return 0 on success; non-zero on error.
+ */
+int rp_image::un_premultiply_avx2(void)
+{
+	RP_D(const rp_image);
+	rp_image_backend *const backend = d->backend;
+	assert(backend->format == rp_image::Format::ARGB32);
+	if (backend->format != rp_image::Format::ARGB32) {
+		// Incorrect format...
+		return -1;
+	}
+
+	const __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+
+	const unsigned int width = static_cast<unsigned int>(backend->width);
+	uint32_t *px_dest = static_cast<uint32_t*>(backend->data());
+	const int dest_stride_adj = (backend->stride / sizeof(*px_dest)) - width;
+	for (int y = backend->height; y > 0; y--, px_dest += dest_stride_adj) {
+		// Process 8 pixels per iteration using AVX2.
+		unsigned int x = width;
+		for (; x > 7; x -= 8, px_dest += 8) {
+			__m256i *ymm_data = reinterpret_cast<__m256i*>(px_dest);
+			const __m256i px = _mm256_loadu_si256(ymm_data);
+			if (_mm256_testc_si256(px, alpha_mask)) {
+				// All pixels are opaque. Nothing to do here.
+				continue;
+			}
+			_mm256_storeu_si256(ymm_data, un_premultiply_px8_avx2(px));
+		}
+
+		// Remaining pixels.
+		if (x > 0) {
+			int *const p = reinterpret_cast<int*>(px_dest);
+			const __m256i mask = tail_mask_avx2(x);
+			const __m256i px = _mm256_maskload_epi32(p, mask);
+			_mm256_maskstore_epi32(p, mask, un_premultiply_px8_avx2(px));
+			px_dest += x;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Premultiply an ARGB32 rp_image.
+ * AVX2-optimized version.
+ *
+ * Image must be ARGB32.
+ *
+ * @return 0 on success; non-zero on error.
+ */
+int rp_image::premultiply_avx2(void)
+{
+	RP_D(const rp_image);
+	rp_image_backend *const backend = d->backend;
+	assert(backend->format == rp_image::Format::ARGB32);
+	if (backend->format != rp_image::Format::ARGB32) {
+		// Incorrect format...
+		return -1;
+	}
+
+	const __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+
+	const unsigned int width = static_cast<unsigned int>(backend->width);
+	uint32_t *px_dest = static_cast<uint32_t*>(backend->data());
+	const int dest_stride_adj = (backend->stride / sizeof(*px_dest)) - width;
+	for (int y = backend->height; y > 0; y--, px_dest += dest_stride_adj) {
+		// Process 8 pixels per iteration using AVX2.
+		unsigned int x = width;
+		for (; x > 7; x -= 8, px_dest += 8) {
+			__m256i *ymm_data = reinterpret_cast<__m256i*>(px_dest);
+			const __m256i px = _mm256_loadu_si256(ymm_data);
+			if (_mm256_testc_si256(px, alpha_mask)) {
+				// All pixels are opaque. Nothing to do here.
+				continue;
+			}
+			_mm256_storeu_si256(ymm_data, premultiply_px8_avx2(px));
+		}
+
+		// Remaining pixels.
+		if (x > 0) {
+			int *const p = reinterpret_cast<int*>(px_dest);
+			const __m256i mask = tail_mask_avx2(x);
+			const __m256i px = _mm256_maskload_epi32(p, mask);
+			_mm256_maskstore_epi32(p, mask, premultiply_px8_avx2(px));
+			px_dest += x;
+		}
+	}
+	return 0;
+}
+
+}
@@ -0,0 +1,330 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ExpandCI8Test.cpp: Test expand_CI8().                                   *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpbase, librptexture, librpcpu
+#include "librpbase/aligned_malloc.h"
+#include "librptexture/img/rp_image.hpp"
+
+// Pseudo-random test data.
+#include "librpbase/tests/PseudoRandom.hpp"
+using LibRpBase::Tests::nextPseudoRandom;
+
+// C includes.
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <vector>
+using std::vector;
+
+namespace LibRpTexture { namespace Tests {
+
+class ExpandCI8Test : public ::testing::Test
+{
+	protected:
+		ExpandCI8Test()
+			: m_palette(aligned_uptr<uint32_t>(16, 256))
+			, m_src(aligned_uptr<uint8_t>(16, SRC_STRIDE * HEIGHT))
+			, m_dest_cpp(DEST_STRIDE * HEIGHT / 4)
+			, m_dest(DEST_STRIDE * HEIGHT / 4)
+		{
+			srand(0x5A5A5A5A);
+			uint8_t *p = m_src.get();
+			for (size_t i = SRC_STRIDE * HEIGHT; i > 0; i--, p++) {
+				*p = static_cast<uint8_t>(rand() & 0xFF);
+			}
+		}
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 1000;
+
+		// Image dimensions.
+		// NOTE: Width is intentionally not a multiple of 16 or 32,
+		// and the strides have padding, to test the scalar fallback.
+		static const int WIDTH = 509;
+		static const int HEIGHT = 512;
+		static const int SRC_STRIDE = 528;
+		static const int DEST_STRIDE = 528 * 4;
+
+		typedef void (*expand_CI8_fn)(uint32_t *RESTRICT dest, int dest_stride,
+			const uint8_t *RESTRICT src, int src_stride,
+			int width, int height,
+			const uint32_t *RESTRICT palette);
+
+		/**
+		 * Initialize the palette.
+		 * @param colors Number of non-zero colors. (Remaining colors are zeroed.)
+		 */
+		void initPalette(int colors)
+		{
+			uint32_t *const pal = m_palette.get();
+			uint32_t color = 0x80FF4020;
+			for (int i = 0; i < colors; i++, nextPseudoRandom(color)) {
+				pal[i] = color | 0x01010101U;
+			}
+			for (int i = colors; i < 256; i++) {
+				pal[i] = 0;
+			}
+		}
+
+		/**
+		 * Limit the source indexes to a maximum of 16 colors.
+		 */
+		void limitSrcTo16(void)
+		{
+			uint8_t *p = m_src.get();
+			for (size_t i = SRC_STRIDE * HEIGHT; i > 0; i--, p++) {
+				*p &= 0x0F;
+			}
+		}
+
+		/**
+		 * Compare an expand_CI8() implementation to the standard version.
+		 * @param fn expand_CI8() implementation.
+		 */
+		void checkImpl(expand_CI8_fn fn)
+		{
+			// Fill the destination buffers with the same canary value
+			// to verify that stride padding is left as-is.
+			std::fill(m_dest_cpp.begin(), m_dest_cpp.end(), 0xDEADBEEF);
+			std::fill(m_dest.begin(), m_dest.end(), 0xDEADBEEF);
+
+			rp_image::expand_CI8_cpp(m_dest_cpp.data(), DEST_STRIDE,
+				m_src.get(), SRC_STRIDE, WIDTH, HEIGHT, m_palette.get());
+			fn(m_dest.data(), DEST_STRIDE,
+				m_src.get(), SRC_STRIDE, WIDTH, HEIGHT, m_palette.get());
+
+			// Verify the standard version first.
+			const uint8_t *src = m_src.get();
+			const uint32_t *dest = m_dest_cpp.data();
+			for (int y = 0; y < HEIGHT; y++, src += SRC_STRIDE, dest += DEST_STRIDE/4) {
+				for (int x = 0; x < WIDTH; x++) {
+					ASSERT_EQ(m_palette.get()[src[x]], dest[x]) << "x == " << x << ", y == " << y;
+				}
+			}
+
+			ASSERT_TRUE(m_dest_cpp == m_dest);
+		}
+
+		// Palette.
+		unique_ptr_aligned<uint32_t> m_palette;
+		// Source image.
+		unique_ptr_aligned<uint8_t> m_src;
+
+		// Destination buffers.
+		vector<uint32_t> m_dest_cpp;
+		vector<uint32_t> m_dest;
+};
+
+/**
+ * Verify the dispatch function with a 16-color palette.
+ */
+TEST_F(ExpandCI8Test, expand_CI8_16_test)
+{
+	initPalette(16);
+	limitSrcTo16();
+	ASSERT_NO_FATAL_FAILURE(checkImpl(rp_image::expand_CI8));
+}
+
+/**
+ * Verify the dispatch function with a 16-color palette,
+ * using indexes outside of the 16-color range.
+ */
+TEST_F(ExpandCI8Test, expand_CI8_16_out_of_range_test)
+{
+	initPalette(16);
+	ASSERT_NO_FATAL_FAILURE(checkImpl(rp_image::expand_CI8));
+}
+
+/**
+ * Verify the dispatch function with a 256-color palette.
+ */
+TEST_F(ExpandCI8Test, expand_CI8_256_test)
+{
+	initPalette(256);
+	ASSERT_NO_FATAL_FAILURE(checkImpl(rp_image::expand_CI8));
+}
+
+/**
+ * Verify rp_image::dup_ARGB32().
+ */
+TEST_F(ExpandCI8Test, dup_ARGB32_test)
+{
+	rp_image *const img = new rp_image(WIDTH, HEIGHT, rp_image::Format::CI8);
+	ASSERT_TRUE(img->isValid());
+	initPalette(16);
+	memcpy(img->palette(), m_palette.get(), 256 * sizeof(uint32_t));
+	for (int y = 0; y < HEIGHT; y++) {
+		memcpy(img->scanLine(y), m_src.get() + (y * SRC_STRIDE), WIDTH);
+	}
+
+	rp_image *const img_argb = img->dup_ARGB32();
+	ASSERT_TRUE(img_argb != nullptr);
+	ASSERT_EQ(rp_image::Format::ARGB32, img_argb->format());
+	for (int y = 0; y < HEIGHT; y++) {
+		const uint8_t *const src = static_cast<const uint8_t*>(img->scanLine(y));
+		const uint32_t *const dest = static_cast<const uint32_t*>(img_argb->scanLine(y));
+		for (int x = 0; x < WIDTH; x++) {
+			ASSERT_EQ(m_palette.get()[src[x]], dest[x]) << "x == " << x << ", y == " << y;
+		}
+	}
+
+	img_argb->unref();
+	img->unref();
+}
+
+#ifdef RP_IMAGE_HAS_SSSE3
+/**
+ * Verify the SSSE3-optimized version with 16-color and 256-color palettes.
+ */
+TEST_F(ExpandCI8Test, expand_CI8_ssse3_test)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	initPalette(16);
+	ASSERT_NO_FATAL_FAILURE(checkImpl(rp_image::expand_CI8_ssse3));
+	limitSrcTo16();
+	ASSERT_NO_FATAL_FAILURE(checkImpl(rp_image::expand_CI8_ssse3));
+	initPalette(256);
+	ASSERT_NO_FATAL_FAILURE(checkImpl(rp_image::expand_CI8_ssse3));
+}
+#endif /* RP_IMAGE_HAS_SSSE3 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Verify the AVX2-optimized version with 16-color and 256-color palettes.
+ */
+TEST_F(ExpandCI8Test, expand_CI8_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	initPalette(16);
+	ASSERT_NO_FATAL_FAILURE(checkImpl(rp_image::expand_CI8_avx2));
+	limitSrcTo16();
+	ASSERT_NO_FATAL_FAILURE(checkImpl(rp_image::expand_CI8_avx2));
+	initPalette(256);
+	ASSERT_NO_FATAL_FAILURE(checkImpl(rp_image::expand_CI8_avx2));
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+/**
+ * Benchmark the rp_image::expand_CI8() function. (Standard version, 16 colors)
+ */
+TEST_F(ExpandCI8Test, expand_CI8_16_cpp_benchmark)
+{
+	initPalette(16);
+	limitSrcTo16();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image::expand_CI8_cpp(m_dest.data(), DEST_STRIDE,
+			m_src.get(), SRC_STRIDE, WIDTH, HEIGHT, m_palette.get());
+	}
+}
+
+/**
+ * Benchmark the rp_image::expand_CI8() function. (Standard version, 256 colors)
+ */
+TEST_F(ExpandCI8Test, expand_CI8_256_cpp_benchmark)
+{
+	initPalette(256);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image::expand_CI8_cpp(m_dest.data(), DEST_STRIDE,
+			m_src.get(), SRC_STRIDE, WIDTH, HEIGHT, m_palette.get());
+	}
+}
+
+#ifdef RP_IMAGE_HAS_SSSE3
+/**
+ * Benchmark the rp_image::expand_CI8() function. (SSSE3-optimized version, 16 colors)
+ */
+TEST_F(ExpandCI8Test, expand_CI8_16_ssse3_benchmark)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	initPalette(16);
+	limitSrcTo16();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image::expand_CI8_ssse3(m_dest.data(), DEST_STRIDE,
+			m_src.get(), SRC_STRIDE, WIDTH, HEIGHT, m_palette.get());
+	}
+}
+#endif /* RP_IMAGE_HAS_SSSE3 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Benchmark the rp_image::expand_CI8() function. (AVX2-optimized version, 16 colors)
+ */
+TEST_F(ExpandCI8Test, expand_CI8_16_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	initPalette(16);
+	limitSrcTo16();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image::expand_CI8_avx2(m_dest.data(), DEST_STRIDE,
+			m_src.get(), SRC_STRIDE, WIDTH, HEIGHT, m_palette.get());
+	}
+}
+
+/**
+ * Benchmark the rp_image::expand_CI8() function. (AVX2-optimized version, 256 colors)
+ */
+TEST_F(ExpandCI8Test, expand_CI8_256_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	initPalette(256);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image::expand_CI8_avx2(m_dest.data(), DEST_STRIDE,
+			m_src.get(), SRC_STRIDE, WIDTH, HEIGHT, m_palette.get());
+	}
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: rp_image::expand_CI8() tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::ExpandCI8Test::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -14,6 +14,7 @@
 // librpbase, librptexture, librpcpu
 #include "librpbase/aligned_malloc.h"
 #include "librptexture/img/rp_image.hpp"
+#include "librptexture/img/rp_image_backend_view.hpp"
 #include "librptexture/decoder/ImageDecoder.hpp"
 #include "librpcpu/byteswap.h"
 
@@ -643,8 +644,166 @@ TEST_P(ImageDecoderLinearTest, fromLinear_ssse3_benchmark)
 }
 #endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Test the ImageDecoder::fromLinear*() functions. (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderLinearTest, fromLinear_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// Parameterized test.
+	const ImageDecoderLinearTest_mode &mode = GetParam();
+
+	// Decode the image.
+	switch (mode.bpp) {
+		case 24:
+			// 24-bit image.
+			m_img = ImageDecoder::fromLinear24_avx2(mode.src_pxf, 128, 128,
+				m_img_buf, static_cast<int>(m_img_buf_len), mode.stride);
+			break;
+
+		case 32:
+			// 32-bit image.
+			m_img = ImageDecoder::fromLinear32_avx2(mode.src_pxf, 128, 128,
+				reinterpret_cast<const uint32_t*>(m_img_buf),
+				static_cast<int>(m_img_buf_len), mode.stride);
+			break;
+
+		case 15:
+		case 16:
+			// 15/16-bit image.
+			m_img = ImageDecoder::fromLinear16_avx2(mode.src_pxf, 128, 128,
+				reinterpret_cast<const uint16_t*>(m_img_buf),
+				static_cast<int>(m_img_buf_len), mode.stride);
+			break;
+
+		default:
+			ASSERT_TRUE(false) << "Invalid bpp: " << mode.bpp;
+			return;
+	}
+
+	ASSERT_TRUE(m_img != nullptr);
+
+	// Validate the image.
+	ASSERT_NO_FATAL_FAILURE(Validate_RpImage(m_img, mode.dest_pixel));
+}
+
+/**
+ * Test the ImageDecoder::fromLinear*() functions with a width
+ * that isn't a multiple of 16 pixels. (AVX2-optimized version)
+ * This tests the handling of the remaining pixels in each row.
+ */
+TEST_P(ImageDecoderLinearTest, fromLinear_avx2_remaining_pixels_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// Parameterized test.
+	const ImageDecoderLinearTest_mode &mode = GetParam();
+
+	// Decode a 125x128 image using the 128x128 image buffer.
+	const int bytespp = (mode.bpp + 7) / 8;
+	const int stride = (mode.stride > 0 ? mode.stride : 128 * bytespp);
+	switch (mode.bpp) {
+		case 24:
+			// 24-bit image.
+			m_img = ImageDecoder::fromLinear24_avx2(mode.src_pxf, 125, 128,
+				m_img_buf, static_cast<int>(m_img_buf_len), stride);
+			break;
+
+		case 32:
+			// 32-bit image.
+			m_img = ImageDecoder::fromLinear32_avx2(mode.src_pxf, 125, 128,
+				reinterpret_cast<const uint32_t*>(m_img_buf),
+				static_cast<int>(m_img_buf_len), stride);
+			break;
+
+		case 15:
+		case 16:
+			// 15/16-bit image.
+			m_img = ImageDecoder::fromLinear16_avx2(mode.src_pxf, 125, 128,
+				reinterpret_cast<const uint16_t*>(m_img_buf),
+				static_cast<int>(m_img_buf_len), stride);
+			break;
+
+		default:
+			ASSERT_TRUE(false) << "Invalid bpp: " << mode.bpp;
+			return;
+	}
+
+	ASSERT_TRUE(m_img != nullptr);
+	ASSERT_EQ(125, m_img->width());
+	ASSERT_EQ(128, m_img->height());
+
+	// Validate the image.
+	for (int y = 0; y < 128; y++) {
+		const uint32_t *px = static_cast<const uint32_t*>(m_img->scanLine(y));
+		for (int x = 0; x < 125; x++, px++) {
+			ASSERT_EQ(mode.dest_pixel, *px) << "Pixel (" << x << "," << y << ") does not match.";
+		}
+	}
+}
+
+/**
+ * Benchmark the ImageDecoder::fromLinear*() functions. (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderLinearTest, fromLinear_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// Parameterized test.
+	const ImageDecoderLinearTest_mode &mode = GetParam();
+
+	// Decode the image.
+	switch (mode.bpp) {
+		case 24:
+			// 24-bit image.
+			for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+				m_img = ImageDecoder::fromLinear24_avx2(mode.src_pxf, 128, 128,
+					m_img_buf, static_cast<int>(m_img_buf_len), mode.stride);
+				UNREF_AND_NULL(m_img);
+			}
+			break;
+
+		case 32:
+			// 32-bit image.
+			for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+				m_img = ImageDecoder::fromLinear32_avx2(mode.src_pxf, 128, 128,
+					reinterpret_cast<const uint32_t*>(m_img_buf),
+					static_cast<int>(m_img_buf_len), mode.stride);
+				UNREF_AND_NULL(m_img);
+			}
+			break;
+
+		case 15:
+		case 16:
+			// 15/16-bit image.
+			for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+				m_img = ImageDecoder::fromLinear16_avx2(mode.src_pxf, 128, 128,
+					reinterpret_cast<const uint16_t*>(m_img_buf),
+					static_cast<int>(m_img_buf_len), mode.stride);
+				UNREF_AND_NULL(m_img);
+			}
+			break;
+
+		default:
+			ASSERT_TRUE(false) << "Invalid bpp: " << mode.bpp;
+			return;
+	}
+}
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(IMAGEDECODER_HAS_SSE2) || defined(IMAGEDECODER_HAS_SSSE3)
+#if defined(IMAGEDECODER_HAS_SSE2) || defined(IMAGEDECODER_HAS_SSSE3) || defined(IMAGEDECODER_HAS_AVX2)
 /**
  * Test the ImageDecoder::fromLinear*() dispatch functions.
  */
@@ -732,10 +891,72 @@ TEST_P(ImageDecoderLinearTest, fromLinear_dispatch_benchmark)
 			return;
 	}
 }
-#endif /* IMAGEDECODER_HAS_SSE2 || IMAGEDECODER_HAS_SSSE3 */
+#endif /* IMAGEDECODER_HAS_SSE2 || IMAGEDECODER_HAS_SSSE3 || IMAGEDECODER_HAS_AVX2 */
 
 // Test cases.
 
+/**
+ * Test the ImageDecoder::fromLinear32() function that takes an rp_image_buffer.
+ */
+TEST_P(ImageDecoderLinearTest, fromLinear32_buffer_test)
+{
+	// Parameterized test.
+	const ImageDecoderLinearTest_mode &mode = GetParam();
+	if (mode.bpp != 32) {
+		// Not a 32-bit image.
+		return;
+	}
+
+	// Copy the image data into an rp_image_buffer.
+	void *const data = aligned_malloc(16, m_img_buf_len);
+	ASSERT_TRUE(data != nullptr);
+	memcpy(data, m_img_buf, m_img_buf_len);
+	rp_image_buffer *const imgbuf = new rp_image_buffer_aligned(data, m_img_buf_len);
+
+	m_img = ImageDecoder::fromLinear32(mode.src_pxf, 128, 128, imgbuf, mode.stride);
+	ASSERT_TRUE(m_img != nullptr);
+	ASSERT_NO_FATAL_FAILURE(Validate_RpImage(m_img, mode.dest_pixel));
+
+	const bool can_view = (mode.src_pxf == ImageDecoder::PXF_HOST_ARGB32 &&
+		rp_image::backendCreatorFn() == nullptr);
+	if (!can_view) {
+		// Image data was converted.
+		EXPECT_NE(imgbuf->data(), static_cast<const rp_image*>(m_img)->bits());
+		imgbuf->unref();
+		return;
+	}
+
+	// Image data should be referenced directly.
+	EXPECT_EQ(imgbuf->data(), static_cast<const rp_image*>(m_img)->bits());
+	if (mode.stride != 0) {
+		EXPECT_EQ(mode.stride, m_img->stride());
+	}
+
+	// Writing to the image should copy the image data first.
+	uint32_t *const bits = static_cast<uint32_t*>(m_img->bits());
+	ASSERT_TRUE(bits != nullptr);
+	EXPECT_NE(imgbuf->data(), bits);
+	bits[0] = ~bits[0];
+	EXPECT_EQ(0, memcmp(imgbuf->data(), m_img_buf, m_img_buf_len));
+	bits[0] = ~bits[0];
+	ASSERT_NO_FATAL_FAILURE(Validate_RpImage(m_img, mode.dest_pixel));
+
+	if (mode.stride > 128*4) {
+		// A buffer that doesn't have the full stride for the
+		// last row can't be referenced directly, since the
+		// full stride would be read if the image is copied.
+		rp_image_buffer *const shortbuf = new rp_image_buffer_aligned(
+			aligned_malloc(16, m_img_buf_len), m_img_buf_len - mode.stride + (128*4));
+		EXPECT_FALSE(rp_image_backend_view::canView(shortbuf, shortbuf->data(),
+			128, 128, mode.stride));
+		EXPECT_TRUE(rp_image_backend_view::canView(imgbuf, imgbuf->data(),
+			128, 128, mode.stride));
+		shortbuf->unref();
+	}
+
+	imgbuf->unref();
+}
+
 // 32-bit tests.
 INSTANTIATE_TEST_SUITE_P(fromLinear32, ImageDecoderLinearTest,
 	::testing::Values(
@@ -0,0 +1,288 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImagePoolTest.cpp: Test the image buffer pool.                          *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/img/rp_image_pool.hpp"
+
+// C includes.
+#include <stdint.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+// C++ includes.
+#include <thread>
+
+namespace LibRpTexture { namespace Tests {
+
+class ImagePoolTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) final
+		{
+			ImagePool::setMaxCachedBytes(0);
+			ImagePool::resetStats();
+		}
+
+		void TearDown(void) final
+		{
+			ImagePool::setMaxCachedBytes(0);
+		}
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 1000;
+
+		/**
+		 * Create and destroy a batch of images, similar to
+		 * what a thumbnailer does for each thumbnail.
+		 */
+		static void thumbnailJob(void)
+		{
+			rp_image *const img = new rp_image(512, 512, rp_image::Format::CI8);
+			rp_image *const img32 = img->dup_ARGB32();
+			rp_image *const sq = img32->squared();
+			img->unref();
+			img32->unref();
+			if (sq) {
+				sq->unref();
+			}
+		}
+};
+
+/**
+ * Test the size classes.
+ */
+TEST_F(ImagePoolTest, classSizeTest)
+{
+	EXPECT_EQ(1024U, ImagePool::classSize(1));
+	EXPECT_EQ(1024U, ImagePool::classSize(1024));
+	EXPECT_EQ(1280U, ImagePool::classSize(1025));
+	EXPECT_EQ(2048U, ImagePool::classSize(2048));
+	EXPECT_EQ(2560U, ImagePool::classSize(2049));
+
+	// 256x256 ARGB32 is exactly a power of two.
+	EXPECT_EQ(256U*256U*4U, ImagePool::classSize(256*256*4));
+	// 320x240 ARGB32: 300 KiB -> 320 KiB
+	EXPECT_EQ(320U*1024U, ImagePool::classSize(320*240*4));
+
+	// Largest pooled size is 64 MiB.
+	EXPECT_EQ(64U*1024U*1024U, ImagePool::classSize(64*1024*1024));
+	EXPECT_EQ(0U, ImagePool::classSize(64*1024*1024 + 1));
+
+	// Size classes are never more than 25% larger than the request.
+	for (size_t size = 1024; size <= 64*1024*1024; size = size * 9 / 8 + 1) {
+		const size_t class_size = ImagePool::classSize(size);
+		EXPECT_GE(class_size, size);
+		EXPECT_LE(class_size, size + size / 4);
+	}
+}
+
+/**
+ * Buffers are returned to the system if caching is disabled.
+ */
+TEST_F(ImagePoolTest, disabledTest)
+{
+	void *const p1 = ImagePool::allocBuffer(100000);
+	ASSERT_TRUE(p1 != nullptr);
+	EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p1) & 15U);
+	ImagePool::freeBuffer(p1, 100000);
+
+	void *const p2 = ImagePool::allocBuffer(100000);
+	ASSERT_TRUE(p2 != nullptr);
+	ImagePool::freeBuffer(p2, 100000);
+
+	ImagePool::Stats stats;
+	ImagePool::getStats(&stats);
+	EXPECT_EQ(2U, stats.alloc_count);
+	EXPECT_EQ(2U, stats.free_count);
+	EXPECT_EQ(0U, stats.pool_hits);
+	EXPECT_EQ(2U, stats.sys_alloc_count);
+	EXPECT_EQ(2U, stats.sys_free_count);
+	EXPECT_EQ(0U, stats.cached_bytes);
+}
+
+/**
+ * Freed buffers are reused for allocations in the same size class.
+ */
+TEST_F(ImagePoolTest, reuseTest)
+{
+	ImagePool::setMaxCachedBytes(1024*1024);
+
+	void *const p1 = ImagePool::allocBuffer(100000);
+	ASSERT_TRUE(p1 != nullptr);
+	ImagePool::freeBuffer(p1, 100000);
+
+	ImagePool::Stats stats;
+	ImagePool::getStats(&stats);
+	EXPECT_EQ(ImagePool::classSize(100000), stats.cached_bytes);
+
+	// Same size class: should get the same buffer.
+	void *const p2 = ImagePool::allocBuffer(110000);
+	EXPECT_EQ(p1, p2);
+	ImagePool::getStats(&stats);
+	EXPECT_EQ(1U, stats.pool_hits);
+	EXPECT_EQ(1U, stats.sys_alloc_count);
+	EXPECT_EQ(0U, stats.cached_bytes);
+
+	// Different size class: should get a new buffer.
+	void *const p3 = ImagePool::allocBuffer(1000);
+	EXPECT_NE(p1, p3);
+
+	ImagePool::freeBuffer(p2, 110000);
+	ImagePool::freeBuffer(p3, 1000);
+	ImagePool::trim();
+	ImagePool::getStats(&stats);
+	EXPECT_EQ(0U, stats.cached_bytes);
+	EXPECT_EQ(stats.sys_alloc_count, stats.sys_free_count);
+}
+
+/**
+ * The cache never exceeds the memory cap.
+ */
+TEST_F(ImagePoolTest, capTest)
+{
+	static const size_t BUF_SIZE = 256*1024;
+	ImagePool::setMaxCachedBytes(BUF_SIZE * 3);
+
+	void *bufs[5];
+	for (unsigned int i = 0; i < ARRAY_SIZE(bufs); i++) {
+		bufs[i] = ImagePool::allocBuffer(BUF_SIZE);
+		ASSERT_TRUE(bufs[i] != nullptr);
+	}
+	for (unsigned int i = 0; i < ARRAY_SIZE(bufs); i++) {
+		ImagePool::freeBuffer(bufs[i], BUF_SIZE);
+	}
+
+	ImagePool::Stats stats;
+	ImagePool::getStats(&stats);
+	EXPECT_EQ(BUF_SIZE * 3, stats.cached_bytes);
+	EXPECT_EQ(BUF_SIZE * 3, stats.peak_cached_bytes);
+	EXPECT_EQ(2U, stats.sys_free_count);
+
+	// Lowering the cap trims the cache.
+	ImagePool::setMaxCachedBytes(BUF_SIZE);
+	ImagePool::getStats(&stats);
+	EXPECT_EQ(0U, stats.cached_bytes);
+	EXPECT_EQ(5U, stats.sys_free_count);
+}
+
+/**
+ * rp_image's default backend uses the pool.
+ */
+TEST_F(ImagePoolTest, rpImageTest)
+{
+	if (rp_image::backendCreatorFn() != nullptr) {
+		// Not using the default backend.
+		return;
+	}
+
+	ImagePool::setMaxCachedBytes(16*1024*1024);
+
+	// First job: everything is allocated from the system.
+	thumbnailJob();
+	ImagePool::Stats stats;
+	ImagePool::getStats(&stats);
+	EXPECT_EQ(0U, stats.pool_hits);
+	const uint64_t sys_alloc_count = stats.sys_alloc_count;
+	EXPECT_GT(sys_alloc_count, 0U);
+	EXPECT_EQ(stats.alloc_count, stats.free_count);
+
+	// Second job: everything is allocated from the pool.
+	thumbnailJob();
+	ImagePool::getStats(&stats);
+	EXPECT_EQ(sys_alloc_count, stats.sys_alloc_count);
+	EXPECT_EQ(sys_alloc_count, stats.pool_hits);
+	EXPECT_EQ(0U, stats.sys_free_count);
+	ImagePool::trim();
+}
+
+/**
+ * threadCleanup() releases the cached buffers and
+ * disables caching for the rest of the thread's lifetime.
+ * NOTE: Run in a separate thread, since caching can't be
+ * re-enabled for the calling thread afterwards.
+ */
+TEST_F(ImagePoolTest, threadCleanupTest)
+{
+	ImagePool::setMaxCachedBytes(1024*1024);
+
+	ImagePool::Stats stats1, stats2;
+	std::thread thread([&stats1, &stats2]() {
+		void *const p1 = ImagePool::allocBuffer(100000);
+		void *const p2 = ImagePool::allocBuffer(100000);
+		ImagePool::freeBuffer(p1, 100000);
+		ImagePool::getStats(&stats1);
+
+		// Buffers freed after threadCleanup() aren't cached.
+		ImagePool::threadCleanup();
+		ImagePool::freeBuffer(p2, 100000);
+		ImagePool::getStats(&stats2);
+	});
+	thread.join();
+
+	EXPECT_EQ(ImagePool::classSize(100000), stats1.cached_bytes);
+	EXPECT_EQ(0U, stats1.sys_free_count);
+	EXPECT_EQ(0U, stats2.cached_bytes);
+	EXPECT_EQ(2U, stats2.sys_free_count);
+}
+
+/**
+ * Benchmark thumbnail jobs without the pool.
+ */
+TEST_F(ImagePoolTest, disabled_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		thumbnailJob();
+	}
+
+	ImagePool::Stats stats;
+	ImagePool::getStats(&stats);
+	printf("system allocations: %llu\n", static_cast<unsigned long long>(stats.sys_alloc_count));
+}
+
+/**
+ * Benchmark thumbnail jobs with the pool.
+ */
+TEST_F(ImagePoolTest, pooled_benchmark)
+{
+	ImagePool::setMaxCachedBytes(16*1024*1024);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		thumbnailJob();
+	}
+
+	ImagePool::Stats stats;
+	ImagePool::getStats(&stats);
+	printf("system allocations: %llu, pool hits: %llu\n",
+		static_cast<unsigned long long>(stats.sys_alloc_count),
+		static_cast<unsigned long long>(stats.pool_hits));
+	ImagePool::trim();
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: ImagePool tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::ImagePoolTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,377 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImageScaleTest.cpp: Test rp_image::scaled().                            *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpbase, librptexture, librpcpu
+#include "librpbase/aligned_malloc.h"
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/img/rp_image_scale_p.hpp"
+
+// C includes.
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRpTexture { namespace Tests {
+
+struct ImageScaleTest_mode
+{
+	int src_w, src_h;
+	int dest_w, dest_h;
+	rp_image::ScaleFilter filter;
+
+	ImageScaleTest_mode(int src_w, int src_h, int dest_w, int dest_h, rp_image::ScaleFilter filter)
+		: src_w(src_w), src_h(src_h)
+		, dest_w(dest_w), dest_h(dest_h)
+		, filter(filter)
+	{ }
+};
+
+class ImageScaleTest : public ::testing::TestWithParam<ImageScaleTest_mode>
+{
+	protected:
+		ImageScaleTest()
+			: m_img(nullptr)
+		{ }
+
+		void SetUp(void) final
+		{
+			const ImageScaleTest_mode &mode = GetParam();
+			m_img = new rp_image(mode.src_w, mode.src_h, rp_image::Format::ARGB32);
+			ASSERT_TRUE(m_img->isValid());
+
+			// Random premultiplied pixels.
+			srand(0x5A5A5A5A);
+			for (int y = 0; y < mode.src_h; y++) {
+				uint32_t *px = static_cast<uint32_t*>(m_img->scanLine(y));
+				for (int x = 0; x < mode.src_w; x++, px++) {
+					const unsigned int a = rand() & 0xFF;
+					const unsigned int r = (rand() & 0xFF) * a / 255;
+					const unsigned int g = (rand() & 0xFF) * a / 255;
+					const unsigned int b = (rand() & 0xFF) * a / 255;
+					*px = (a << 24) | (r << 16) | (g << 8) | b;
+				}
+			}
+		}
+
+		void TearDown(void) final
+		{
+			UNREF_AND_NULL(m_img);
+		}
+
+	public:
+		typedef void (*scaleRowV_fn)(uint32_t *RESTRICT dest,
+			const uint32_t *RESTRICT src, int src_stride, int count,
+			const int16_t *RESTRICT weights, int width);
+		typedef void (*scaleRowH_fn)(uint32_t *RESTRICT dest,
+			const uint32_t *RESTRICT src, const ImageScale::ScaleCoeffs &coeffs);
+
+		/**
+		 * Scale m_img using the specified row functions.
+		 * @param dest		[out] Destination buffer. (dest_w * dest_h)
+		 * @param fnV		[in] Vertical row function.
+		 * @param fnH		[in] Horizontal row function.
+		 */
+		void scaleWith(vector<uint32_t> &dest, scaleRowV_fn fnV, scaleRowH_fn fnH)
+		{
+			const ImageScaleTest_mode &mode = GetParam();
+			ImageScale::ScaleCoeffs coeffs_v, coeffs_h;
+			ImageScale::calcCoeffs(coeffs_v, mode.src_h, mode.dest_h, mode.filter);
+			ImageScale::calcCoeffs(coeffs_h, mode.src_w, mode.dest_w, mode.filter);
+
+			vector<uint32_t> tmp(mode.src_w * mode.dest_h);
+			const uint32_t *const src = static_cast<const uint32_t*>(m_img->bits());
+			const int stride = m_img->stride();
+			for (int y = 0; y < mode.dest_h; y++) {
+				fnV(&tmp[y * mode.src_w], &src[coeffs_v.start[y] * (stride / 4)], stride,
+					coeffs_v.count[y], &coeffs_v.weights[y * coeffs_v.taps], mode.src_w);
+			}
+
+			dest.resize(mode.dest_w * mode.dest_h);
+			for (int y = 0; y < mode.dest_h; y++) {
+				fnH(&dest[y * mode.dest_w], &tmp[y * mode.src_w], coeffs_h);
+			}
+		}
+
+		/**
+		 * Compare row functions to the standard versions.
+		 * @param fnV		[in] Vertical row function.
+		 * @param fnH		[in] Horizontal row function.
+		 */
+		void checkImpl(scaleRowV_fn fnV, scaleRowH_fn fnH)
+		{
+			vector<uint32_t> dest_cpp, dest;
+			scaleWith(dest_cpp, ImageScale::scaleRowV_cpp, ImageScale::scaleRowH_cpp);
+			scaleWith(dest, fnV, fnH);
+			ASSERT_EQ(dest_cpp.size(), dest.size());
+			for (size_t i = 0; i < dest.size(); i++) {
+				ASSERT_EQ(dest_cpp[i], dest[i]) << "pixel index == " << i;
+			}
+		}
+
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 100;
+
+		// Source image.
+		rp_image *m_img;
+};
+
+/**
+ * Verify that the filter weights for each output pixel add up to 1.0.
+ */
+TEST_P(ImageScaleTest, coeffsTest)
+{
+	const ImageScaleTest_mode &mode = GetParam();
+	ImageScale::ScaleCoeffs coeffs;
+	ImageScale::calcCoeffs(coeffs, mode.src_w, mode.dest_w, mode.filter);
+	ASSERT_EQ(static_cast<size_t>(mode.dest_w), coeffs.start.size());
+	ASSERT_EQ(0, coeffs.taps % 4);
+
+	for (int i = 0; i < mode.dest_w; i++) {
+		EXPECT_GE(coeffs.start[i], 0);
+		EXPECT_GT(coeffs.count[i], 0);
+		EXPECT_LE(coeffs.count[i], coeffs.taps);
+		EXPECT_LE(coeffs.start[i] + coeffs.count[i], mode.src_w);
+
+		int sum = 0;
+		for (int k = 0; k < coeffs.taps; k++) {
+			sum += coeffs.weights[i * coeffs.taps + k];
+		}
+		EXPECT_EQ(1 << ImageScale::WEIGHT_BITS, sum) << "output pixel == " << i;
+	}
+}
+
+/**
+ * Verify that a solid color is preserved.
+ */
+TEST_P(ImageScaleTest, solidColorTest)
+{
+	const ImageScaleTest_mode &mode = GetParam();
+	static const uint32_t color = 0x80402010;
+	for (int y = 0; y < mode.src_h; y++) {
+		uint32_t *px = static_cast<uint32_t*>(m_img->scanLine(y));
+		for (int x = 0; x < mode.src_w; x++) {
+			px[x] = color;
+		}
+	}
+
+	rp_image *const img = m_img->scaled(mode.dest_w, mode.dest_h, mode.filter);
+	ASSERT_TRUE(img != nullptr);
+	ASSERT_EQ(mode.dest_w, img->width());
+	ASSERT_EQ(mode.dest_h, img->height());
+	ASSERT_EQ(rp_image::Format::ARGB32, img->format());
+
+	// NOTE: Premultiplying and un-premultiplying may change
+	// the color channels slightly due to rounding.
+	const uint32_t expected = rp_image::premultiply_pixel(color);
+	rp_image *const img_prex = img->dup();
+	img_prex->premultiply();
+	for (int y = 0; y < mode.dest_h; y++) {
+		const uint32_t *px = static_cast<const uint32_t*>(img_prex->scanLine(y));
+		for (int x = 0; x < mode.dest_w; x++) {
+			ASSERT_EQ(expected, px[x]) << "x == " << x << ", y == " << y;
+		}
+	}
+	img_prex->unref();
+	img->unref();
+}
+
+/**
+ * Verify that fully-transparent pixels don't affect other pixels.
+ */
+TEST_P(ImageScaleTest, transparentTest)
+{
+	const ImageScaleTest_mode &mode = GetParam();
+
+	// Checkerboard of transparent red and opaque blue.
+	for (int y = 0; y < mode.src_h; y++) {
+		uint32_t *px = static_cast<uint32_t*>(m_img->scanLine(y));
+		for (int x = 0; x < mode.src_w; x++) {
+			px[x] = ((x ^ y) & 1) ? 0x00FF0000 : 0xFF0000FF;
+		}
+	}
+
+	rp_image *const img = m_img->scaled(mode.dest_w, mode.dest_h, mode.filter);
+	ASSERT_TRUE(img != nullptr);
+	for (int y = 0; y < mode.dest_h; y++) {
+		const uint32_t *px = static_cast<const uint32_t*>(img->scanLine(y));
+		for (int x = 0; x < mode.dest_w; x++) {
+			ASSERT_EQ(0U, px[x] & 0x00FFFF00) << "x == " << x << ", y == " << y;
+		}
+	}
+	img->unref();
+}
+
+/**
+ * Verify that a CI8 image is scaled the same way as the equivalent ARGB32 image.
+ */
+TEST_P(ImageScaleTest, CI8Test)
+{
+	const ImageScaleTest_mode &mode = GetParam();
+	rp_image *const img_ci8 = new rp_image(mode.src_w, mode.src_h, rp_image::Format::CI8);
+	ASSERT_TRUE(img_ci8->isValid());
+	uint32_t *const pal = img_ci8->palette();
+	for (int i = 0; i < 256; i++) {
+		pal[i] = 0xFF000000 | (i * 0x010305);
+	}
+	for (int y = 0; y < mode.src_h; y++) {
+		uint8_t *const src = static_cast<uint8_t*>(img_ci8->scanLine(y));
+		for (int x = 0; x < mode.src_w; x++) {
+			src[x] = static_cast<uint8_t>(x * 7 + y * 3);
+		}
+	}
+
+	rp_image *const img_argb = img_ci8->dup_ARGB32();
+	ASSERT_TRUE(img_argb != nullptr);
+	rp_image *const scaled_ci8 = img_ci8->scaled(mode.dest_w, mode.dest_h, mode.filter);
+	rp_image *const scaled_argb = img_argb->scaled(mode.dest_w, mode.dest_h, mode.filter);
+	ASSERT_TRUE(scaled_ci8 != nullptr);
+	ASSERT_TRUE(scaled_argb != nullptr);
+	ASSERT_EQ(rp_image::Format::ARGB32, scaled_ci8->format());
+	for (int y = 0; y < mode.dest_h; y++) {
+		ASSERT_EQ(0, memcmp(scaled_argb->scanLine(y), scaled_ci8->scanLine(y),
+			mode.dest_w * sizeof(uint32_t))) << "y == " << y;
+	}
+
+	scaled_argb->unref();
+	scaled_ci8->unref();
+	img_argb->unref();
+	img_ci8->unref();
+}
+
+#ifdef RP_IMAGE_HAS_SSE2
+/**
+ * Compare the SSE2-optimized row functions to the standard versions.
+ */
+TEST_P(ImageScaleTest, sse2Test)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+	ASSERT_NO_FATAL_FAILURE(checkImpl(ImageScale::scaleRowV_sse2, ImageScale::scaleRowH_sse2));
+}
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Compare the AVX2-optimized row functions to the standard versions.
+ */
+TEST_P(ImageScaleTest, avx2Test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+	ASSERT_NO_FATAL_FAILURE(checkImpl(ImageScale::scaleRowV_avx2, ImageScale::scaleRowH_avx2));
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+/**
+ * Benchmark rp_image::scaled(). (Standard version)
+ */
+TEST_P(ImageScaleTest, cpp_benchmark)
+{
+	vector<uint32_t> dest;
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		scaleWith(dest, ImageScale::scaleRowV_cpp, ImageScale::scaleRowH_cpp);
+	}
+}
+
+#ifdef RP_IMAGE_HAS_SSE2
+/**
+ * Benchmark rp_image::scaled(). (SSE2-optimized version)
+ */
+TEST_P(ImageScaleTest, sse2_benchmark)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	vector<uint32_t> dest;
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		scaleWith(dest, ImageScale::scaleRowV_sse2, ImageScale::scaleRowH_sse2);
+	}
+}
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Benchmark rp_image::scaled(). (AVX2-optimized version)
+ */
+TEST_P(ImageScaleTest, avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	vector<uint32_t> dest;
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		scaleWith(dest, ImageScale::scaleRowV_avx2, ImageScale::scaleRowH_avx2);
+	}
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+// Downscaling.
+INSTANTIATE_TEST_SUITE_P(Downscale, ImageScaleTest,
+	::testing::Values(
+		ImageScaleTest_mode(1024, 1024, 256, 256, rp_image::ScaleFilter::Box),
+		ImageScaleTest_mode(1024, 1024, 256, 256, rp_image::ScaleFilter::Bilinear),
+		ImageScaleTest_mode(1024, 1024, 256, 256, rp_image::ScaleFilter::Lanczos),
+		ImageScaleTest_mode(509, 383, 127, 95, rp_image::ScaleFilter::Box),
+		ImageScaleTest_mode(509, 383, 127, 95, rp_image::ScaleFilter::Bilinear),
+		ImageScaleTest_mode(509, 383, 127, 95, rp_image::ScaleFilter::Lanczos))
+	);
+
+// Upscaling.
+INSTANTIATE_TEST_SUITE_P(Upscale, ImageScaleTest,
+	::testing::Values(
+		ImageScaleTest_mode(61, 47, 203, 151, rp_image::ScaleFilter::Box),
+		ImageScaleTest_mode(61, 47, 203, 151, rp_image::ScaleFilter::Bilinear),
+		ImageScaleTest_mode(61, 47, 203, 151, rp_image::ScaleFilter::Lanczos),
+		ImageScaleTest_mode(2, 2, 37, 37, rp_image::ScaleFilter::Lanczos))
+	);
+
+// Mixed: upscale in one direction, downscale in the other.
+INSTANTIATE_TEST_SUITE_P(Mixed, ImageScaleTest,
+	::testing::Values(
+		ImageScaleTest_mode(300, 17, 7, 40, rp_image::ScaleFilter::Box),
+		ImageScaleTest_mode(300, 17, 7, 40, rp_image::ScaleFilter::Bilinear),
+		ImageScaleTest_mode(300, 17, 7, 40, rp_image::ScaleFilter::Lanczos))
+	);
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: rp_image::scaled() tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::ImageScaleTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
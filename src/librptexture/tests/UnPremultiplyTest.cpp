@@ -16,6 +16,10 @@
 #include "librptexture/img/rp_image.hpp"
 #include "librpcpu/byteswap.h"
 
+// Pseudo-random test data.
+#include "librpbase/tests/PseudoRandom.hpp"
+using LibRpBase::Tests::nextPseudoRandom;
+
 // C includes.
 #include <stdint.h>
 #include <stdlib.h>
@@ -52,10 +56,130 @@ class UnPremultiplyTest : public ::testing::Test
 
 		// Image.
 		rp_image *m_img;
+
+	public:
+		/**
+		 * Create an image with pseudo-random pixels.
+		 * Every alpha value is included in each row, along with
+		 * fully opaque runs to test the all-opaque fast path.
+		 * The width is not a multiple of 8 in order to test
+		 * the remaining pixels in each row.
+		 * @return ARGB32 image.
+		 */
+		static rp_image *createTestImage(void)
+		{
+			static const int width = 509;
+			static const int height = 67;
+			rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+
+			uint32_t seed = 0x12345678;
+			for (int y = 0; y < height; y++) {
+				uint32_t *const row = static_cast<uint32_t*>(img->scanLine(y));
+				for (int x = 0; x < width; x++) {
+					nextPseudoRandom(seed);
+					uint32_t px = seed & 0x00FFFFFF;
+					if (x < 256) {
+						px |= static_cast<uint32_t>(x) << 24;
+					} else if (x < 384) {
+						px |= 0xFF000000;
+					} else {
+						px |= (seed & 0xFF000000);
+					}
+					row[x] = px;
+				}
+			}
+			return img;
+		}
+
+		/**
+		 * Compare two images.
+		 * @param expected	[in] Expected image.
+		 * @param actual	[in] Actual image.
+		 */
+		static void compareImages(const rp_image *expected, const rp_image *actual)
+		{
+			ASSERT_EQ(expected->width(), actual->width());
+			ASSERT_EQ(expected->height(), actual->height());
+			for (int y = 0; y < expected->height(); y++) {
+				const uint32_t *const pe = static_cast<const uint32_t*>(expected->scanLine(y));
+				const uint32_t *const pa = static_cast<const uint32_t*>(actual->scanLine(y));
+				for (int x = 0; x < expected->width(); x++) {
+					ASSERT_EQ(pe[x], pa[x]) << "Pixel (" << x << "," << y << ") does not match.";
+				}
+			}
+		}
 };
 
-// TODO: Add actual tests to verify that un-premultiply works.
-// Currently we only have benchmark tests.
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Test the rp_image::un_premultiply() function. (AVX2-optimized version)
+ * The results must match the standard version.
+ */
+TEST_F(UnPremultiplyTest, un_premultiply_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	rp_image *const img_cpp = createTestImage();
+	rp_image *const img_avx2 = img_cpp->dup();
+	EXPECT_EQ(0, img_cpp->un_premultiply_cpp());
+	EXPECT_EQ(0, img_avx2->un_premultiply_avx2());
+	EXPECT_NO_FATAL_FAILURE(compareImages(img_cpp, img_avx2));
+	img_cpp->unref();
+	img_avx2->unref();
+}
+
+/**
+ * Test the rp_image::premultiply() function. (AVX2-optimized version)
+ * The results must match the standard version.
+ */
+TEST_F(UnPremultiplyTest, premultiply_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	rp_image *const img_cpp = createTestImage();
+	rp_image *const img_avx2 = img_cpp->dup();
+	EXPECT_EQ(0, img_cpp->premultiply_cpp());
+	EXPECT_EQ(0, img_avx2->premultiply_avx2());
+	EXPECT_NO_FATAL_FAILURE(compareImages(img_cpp, img_avx2));
+	img_cpp->unref();
+	img_avx2->unref();
+}
+
+/**
+ * Test the rp_image::apply_chroma_key() function. (AVX2-optimized version)
+ * The results must match the standard version.
+ */
+TEST_F(UnPremultiplyTest, apply_chroma_key_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// Use one of the image's pixels as the chroma key.
+	rp_image *const img_cpp = createTestImage();
+	const uint32_t key = static_cast<const uint32_t*>(img_cpp->scanLine(0))[300];
+	for (int y = 0; y < img_cpp->height(); y += 3) {
+		uint32_t *const row = static_cast<uint32_t*>(img_cpp->scanLine(y));
+		for (int x = y % 5; x < img_cpp->width(); x += 7) {
+			row[x] = key;
+		}
+	}
+
+	rp_image *const img_avx2 = img_cpp->dup();
+	EXPECT_EQ(0, img_cpp->apply_chroma_key_cpp(key));
+	EXPECT_EQ(0, img_avx2->apply_chroma_key_avx2(key));
+	EXPECT_NO_FATAL_FAILURE(compareImages(img_cpp, img_avx2));
+	img_cpp->unref();
+	img_avx2->unref();
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
 
 /**
  * Benchmark the ImageDecoder::un_premultiply() function. (Standard version)
@@ -84,8 +208,25 @@ TEST_F(UnPremultiplyTest, un_premultiply_sse41_benchmark)
 }
 #endif /* RP_IMAGE_HAS_SSE41 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Benchmark the ImageDecoder::un_premultiply() function. (AVX2-optimized version)
+ */
+TEST_F(UnPremultiplyTest, un_premultiply_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->un_premultiply_avx2();
+	}
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(RP_IMAGE_HAS_SSE41)
+#if defined(RP_IMAGE_HAS_SSE41) || defined(RP_IMAGE_HAS_AVX2)
 /**
  * Benchmark the ImageDecoder::un_premultiply() dispatch function.
  */
@@ -95,17 +236,44 @@ TEST_F(UnPremultiplyTest, un_premultiply_dispatch_benchmark)
 		m_img->un_premultiply();
 	}
 }
-#endif /* RP_IMAGE_HAS_SSE41 */
+#endif /* RP_IMAGE_HAS_SSE41 || RP_IMAGE_HAS_AVX2 */
 
 /**
  * Benchmark the ImageDecoder::premultiply() function. (Standard version)
  */
 TEST_F(UnPremultiplyTest, premultiply_cpp)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->premultiply_cpp();
+	}
+}
+
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Benchmark the ImageDecoder::premultiply() function. (AVX2-optimized version)
+ */
+TEST_F(UnPremultiplyTest, premultiply_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->premultiply_avx2();
+	}
+}
+
+/**
+ * Benchmark the ImageDecoder::premultiply() dispatch function.
+ */
+TEST_F(UnPremultiplyTest, premultiply_dispatch_benchmark)
 {
 	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
 		m_img->premultiply();
 	}
 }
+#endif /* RP_IMAGE_HAS_AVX2 */
 
 } }
 
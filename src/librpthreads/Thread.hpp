@@ -0,0 +1,23 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * Thread.hpp: System-specific thread implementation.                      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTHREADS_THREAD_HPP__
+#define __ROMPROPERTIES_LIBRPTHREADS_THREAD_HPP__
+
+// NOTE: The .cpp files are #included here in order to inline the functions.
+// Do NOT compile them separately!
+
+// Each .cpp file defines the Thread class itself, with required fields.
+
+#ifdef _WIN32
+# include "ThreadWin32.cpp"
+#else /* !_WIN32 */
+# include "ThreadPosix.cpp"
+#endif
+
+#endif /* __ROMPROPERTIES_LIBRPTHREADS_THREAD_HPP__ */
@@ -0,0 +1,154 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadPosix.cpp: POSIX thread implementation.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include <pthread.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+namespace LibRpThreads {
+
+class Thread
+{
+	public:
+		/**
+		 * Thread function.
+		 * @param param User-specified parameter.
+		 */
+		typedef void (*ThreadProc)(void *param);
+
+		/**
+		 * Create and start a thread.
+		 * @param proc Thread function.
+		 * @param param User-specified parameter.
+		 */
+		inline explicit Thread(ThreadProc proc, void *param);
+
+		/**
+		 * Delete the thread.
+		 * If the thread is still running, this will wait for it to finish.
+		 */
+		inline ~Thread();
+
+	private:
+#if __cplusplus >= 201103L
+		Thread(const Thread &) = delete;
+		Thread &operator=(const Thread &) = delete;
+#else /* __cplusplus < 201103L */
+		Thread(const Thread &);
+		Thread &operator=(const Thread &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Was the thread started successfully?
+		 * @return True if the thread was started; false if not.
+		 */
+		inline bool isValid(void) const;
+
+		/**
+		 * Wait for the thread to finish.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int join(void);
+
+		/**
+		 * Get the number of logical CPUs available to this process.
+		 * @return Number of logical CPUs. (always at least 1)
+		 */
+		static inline unsigned int numberOfCPUs(void);
+
+	private:
+		/**
+		 * pthread start routine.
+		 * @param arg Thread object.
+		 * @return nullptr
+		 */
+		static void *threadStart(void *arg);
+
+	private:
+		pthread_t m_thread;
+		ThreadProc m_proc;
+		void *m_param;
+		bool m_isInit;
+};
+
+/**
+ * Create and start a thread.
+ * @param proc Thread function.
+ * @param param User-specified parameter.
+ */
+inline Thread::Thread(ThreadProc proc, void *param)
+	: m_proc(proc)
+	, m_param(param)
+	, m_isInit(false)
+{
+	assert(proc != nullptr);
+	int ret = pthread_create(&m_thread, nullptr, threadStart, this);
+	if (ret == 0) {
+		m_isInit = true;
+	}
+}
+
+/**
+ * Delete the thread.
+ * If the thread is still running, this will wait for it to finish.
+ */
+inline Thread::~Thread()
+{
+	join();
+}
+
+/**
+ * Was the thread started successfully?
+ * @return True if the thread was started; false if not.
+ */
+inline bool Thread::isValid(void) const
+{
+	return m_isInit;
+}
+
+/**
+ * Wait for the thread to finish.
+ * @return 0 on success; non-zero on error.
+ */
+inline int Thread::join(void)
+{
+	if (!m_isInit)
+		return -EBADF;
+
+	int ret = pthread_join(m_thread, nullptr);
+	m_isInit = false;
+	return (ret == 0 ? 0 : -ret);
+}
+
+/**
+ * Get the number of logical CPUs available to this process.
+ * @return Number of logical CPUs. (always at least 1)
+ */
+inline unsigned int Thread::numberOfCPUs(void)
+{
+	const long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return (n > 0 ? static_cast<unsigned int>(n) : 1U);
+}
+
+/**
+ * pthread start routine.
+ * @param arg Thread object.
+ * @return nullptr
+ */
+inline void *Thread::threadStart(void *arg)
+{
+	Thread *const thr = static_cast<Thread*>(arg);
+	thr->m_proc(thr->m_param);
+	return nullptr;
+}
+
+}
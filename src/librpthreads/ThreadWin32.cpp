@@ -0,0 +1,159 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadWin32.cpp: Win32 thread implementation.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+#ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+#include <process.h>
+
+namespace LibRpThreads {
+
+class Thread
+{
+	public:
+		/**
+		 * Thread function.
+		 * @param param User-specified parameter.
+		 */
+		typedef void (*ThreadProc)(void *param);
+
+		/**
+		 * Create and start a thread.
+		 * @param proc Thread function.
+		 * @param param User-specified parameter.
+		 */
+		inline explicit Thread(ThreadProc proc, void *param);
+
+		/**
+		 * Delete the thread.
+		 * If the thread is still running, this will wait for it to finish.
+		 */
+		inline ~Thread();
+
+	private:
+#if __cplusplus >= 201103L
+		Thread(const Thread &) = delete;
+		Thread &operator=(const Thread &) = delete;
+#else /* __cplusplus < 201103L */
+		Thread(const Thread &);
+		Thread &operator=(const Thread &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Was the thread started successfully?
+		 * @return True if the thread was started; false if not.
+		 */
+		inline bool isValid(void) const;
+
+		/**
+		 * Wait for the thread to finish.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int join(void);
+
+		/**
+		 * Get the number of logical CPUs available to this process.
+		 * @return Number of logical CPUs. (always at least 1)
+		 */
+		static inline unsigned int numberOfCPUs(void);
+
+	private:
+		/**
+		 * Win32 thread start routine.
+		 * @param arg Thread object.
+		 * @return 0
+		 */
+		static unsigned int __stdcall threadStart(void *arg);
+
+	private:
+		HANDLE m_hThread;
+		ThreadProc m_proc;
+		void *m_param;
+};
+
+/**
+ * Create and start a thread.
+ * @param proc Thread function.
+ * @param param User-specified parameter.
+ */
+inline Thread::Thread(ThreadProc proc, void *param)
+	: m_hThread(nullptr)
+	, m_proc(proc)
+	, m_param(param)
+{
+	assert(proc != nullptr);
+
+	// NOTE: Using _beginthreadex() instead of CreateThread()
+	// so the CRT is initialized properly for the new thread.
+	m_hThread = reinterpret_cast<HANDLE>(_beginthreadex(
+		nullptr, 0, threadStart, this, 0, nullptr));
+}
+
+/**
+ * Delete the thread.
+ * If the thread is still running, this will wait for it to finish.
+ */
+inline Thread::~Thread()
+{
+	join();
+}
+
+/**
+ * Was the thread started successfully?
+ * @return True if the thread was started; false if not.
+ */
+inline bool Thread::isValid(void) const
+{
+	return (m_hThread != nullptr);
+}
+
+/**
+ * Wait for the thread to finish.
+ * @return 0 on success; non-zero on error.
+ */
+inline int Thread::join(void)
+{
+	if (!m_hThread)
+		return -EBADF;
+
+	DWORD dwRet = WaitForSingleObject(m_hThread, INFINITE);
+	CloseHandle(m_hThread);
+	m_hThread = nullptr;
+	return (dwRet == WAIT_OBJECT_0 ? 0 : -EIO);
+}
+
+/**
+ * Get the number of logical CPUs available to this process.
+ * @return Number of logical CPUs. (always at least 1)
+ */
+inline unsigned int Thread::numberOfCPUs(void)
+{
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	return (si.dwNumberOfProcessors > 0 ? si.dwNumberOfProcessors : 1U);
+}
+
+/**
+ * Win32 thread start routine.
+ * @param arg Thread object.
+ * @return 0
+ */
+inline unsigned int __stdcall Thread::threadStart(void *arg)
+{
+	Thread *const thr = static_cast<Thread*>(arg);
+	thr->m_proc(thr->m_param);
+	return 0;
+}
+
+}
@@ -77,6 +77,16 @@ int rp_stub_do_security_options(bool config)
 #endif /* __SNR_getrlimit64 || __NR_getrlimit64 */
 		SCMP_SYS(set_tid_address), SCMP_SYS(set_robust_list),
 
+		// ImageDecoder: multithreaded decoding of large textures
+		// NOTE: clone() is allowed below for ExecRpDownload_posix.cpp.
+		SCMP_SYS(madvise),		// thread stack cleanup
+		SCMP_SYS(rt_sigprocmask),	// pthread_create()
+#if defined(__SNR_rseq)
+		SCMP_SYS(rseq),		// glibc-2.35
+#elif defined(__NR_rseq)
+		__NR_rseq,		// glibc-2.35
+#endif /* __SNR_rseq || __NR_rseq */
+
 		SCMP_SYS(getppid),	// dll-search.c: walk_proc_tree()
 
 #if defined(__SNR_statx) || defined(__NR_statx)
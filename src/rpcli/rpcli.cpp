@@ -65,11 +65,13 @@ using LibRpTexture::rp_image;
 // C includes. (C++ namespace)
 #include <cassert>
 #include <cerrno>
+#include <cstring>
 
 // C++ includes.
 #include <fstream>
 #include <iostream>
 #include <locale>
+#include <memory>
 #include <string>
 #include <vector>
 using std::cout;
@@ -78,6 +80,7 @@ using std::endl;
 using std::locale;
 using std::ofstream;
 using std::string;
+using std::unique_ptr;
 using std::vector;
 
 #include "libi18n/config.libi18n.h"
@@ -92,11 +95,89 @@ DELAYLOAD_TEST_FUNCTION_IMPL1(textdomain, nullptr);
 struct ExtractParam {
 	const char* filename;	// Target filename. Can be null due to argv[argc]
 	int image_type;		// Image Type. -1 = iconAnimData, MUST be between -1 and IMG_INT_MAX
+	RpPngWriter::EncodeProfile profile;	// PNG encoding profile.
 
-	ExtractParam(const char *filename, int image_type)
-		: filename(filename), image_type(image_type) { }
+	ExtractParam(const char *filename, int image_type, RpPngWriter::EncodeProfile profile)
+		: filename(filename), image_type(image_type), profile(profile) { }
 };
 
+/**
+ * Save an internal image to a PNG file by decoding it in bands.
+ * This writes each band as it's decoded, so the full image
+ * doesn't need to be kept in memory.
+ * If an error occurs after the file is created, it will be deleted.
+ * @param romData RomData containing the image
+ * @param imageType Image type
+ * @param filename Output filename
+ * @param profile PNG encoding profile
+ * @return 0 on success; -ENOTSUP if banded decoding isn't available; other negative POSIX error code on error.
+ */
+static int SaveImageBanded(const RomData *romData, RomData::ImageType imageType,
+	const char *filename, RpPngWriter::EncodeProfile profile)
+{
+	int fullSize[2];
+	const int bandHeight = romData->imageBandHeight(imageType, fullSize);
+	if (bandHeight <= 0 || fullSize[0] <= 0 || fullSize[1] <= 0)
+		return -ENOTSUP;
+
+	// Decode at least 64 rows at a time.
+	const int rows = ((64 + bandHeight - 1) / bandHeight) * bandHeight;
+
+	// Decode the first band before creating the file,
+	// so the caller can fall back to the full image.
+	int y = 0;
+	int h = (fullSize[1] < rows ? fullSize[1] : rows);
+	rp_image *band = romData->imageBand(imageType, y, h);
+	if (!band || !band->isValid() || band->format() != rp_image::Format::ARGB32 ||
+	    band->width() != fullSize[0] || band->height() != h)
+	{
+		UNREF(band);
+		return -ENOTSUP;
+	}
+
+	unique_ptr<RpPngWriter> pngWriter(new RpPngWriter(filename,
+		fullSize[0], fullSize[1], rp_image::Format::ARGB32));
+	if (!pngWriter->isOpen()) {
+		band->unref();
+		return -pngWriter->lastError();
+	}
+	pngWriter->setEncodeProfile(profile);
+
+	// NOTE: sBIT is taken from the first band.
+	rp_image::sBIT_t sBIT;
+	int ret = pngWriter->write_IHDR(band->get_sBIT(&sBIT) == 0 ? &sBIT : nullptr);
+
+	unique_ptr<const uint8_t*[]> row_pointers(new const uint8_t*[rows]);
+	while (ret == 0) {
+		for (int i = 0; i < h; i++) {
+			row_pointers[i] = static_cast<const uint8_t*>(band->scanLine(i));
+		}
+		ret = pngWriter->write_IDAT_rows(row_pointers.get(), h);
+		UNREF_AND_NULL_NOCHK(band);
+
+		y += h;
+		if (ret != 0 || y >= fullSize[1])
+			break;
+
+		// Next band.
+		h = (fullSize[1] - y < rows ? fullSize[1] - y : rows);
+		band = romData->imageBand(imageType, y, h);
+		if (!band || !band->isValid() || band->format() != rp_image::Format::ARGB32 ||
+		    band->width() != fullSize[0] || band->height() != h)
+		{
+			ret = -EIO;
+		}
+	}
+
+	UNREF(band);
+	if (ret != 0) {
+		// Don't leave a truncated PNG file behind.
+		pngWriter->close();
+		FileSystem::delete_file(filename);
+	}
+	return ret;
+}
+
 /**
 * Extracts images from romdata
 * @param romData RomData containing the images
@@ -111,15 +192,31 @@ static void ExtractImages(const RomData *romData, vector<ExtractParam>& extract)
 		
 		if (it->image_type >= 0 && supported & (1U << it->image_type)) {
 			// normal image
-			auto image = romData->image((RomData::ImageType)it->image_type);
-			if (image && image->isValid()) {
+			// If the image can be decoded in bands, it's written
+			// directly to the PNG file without decoding the full image.
+			const RomData::ImageType imageType = (RomData::ImageType)it->image_type;
+			const bool banded = (romData->imageBandHeight(imageType) > 0);
+			auto image = (banded ? nullptr : romData->image(imageType));
+			if (banded || (image && image->isValid())) {
 				found = true;
 				cerr << "-- " <<
 					// tr: %1$s == image type name, %2$s == output filename
 					rp_sprintf_p(C_("rpcli", "Extracting %1$s into '%2$s'"),
-						RomData::getImageTypeName((RomData::ImageType)it->image_type),
+						RomData::getImageTypeName(imageType),
 						it->filename) << endl;
-				int errcode = RpPng::save(it->filename, image);
+				int errcode;
+				if (banded) {
+					errcode = SaveImageBanded(romData, imageType, it->filename, it->profile);
+					if (errcode == -ENOTSUP) {
+						// Banded decoding failed. Use the full image.
+						image = romData->image(imageType);
+						errcode = (image && image->isValid())
+							? RpPng::save(it->filename, image, it->profile)
+							: -EIO;
+					}
+				} else {
+					errcode = RpPng::save(it->filename, image, it->profile);
+				}
 				if (errcode != 0) {
 					// tr: %1$s == filename, %2%s == error message
 					cerr << rp_sprintf_p(C_("rpcli", "Couldn't create file '%1$s': %2$s"),
@@ -136,11 +233,11 @@ static void ExtractImages(const RomData *romData, vector<ExtractParam>& extract)
 			if (iconAnimData && iconAnimData->count != 0 && iconAnimData->seq_count != 0) {
 				found = true;
 				cerr << "-- " << rp_sprintf(C_("rpcli", "Extracting animated icon into '%s'"), it->filename) << endl;
-				int errcode = RpPng::save(it->filename, iconAnimData);
+				int errcode = RpPng::save(it->filename, iconAnimData, it->profile);
 				if (errcode == -ENOTSUP) {
 					cerr << "   " << C_("rpcli", "APNG not supported, extracting only the first frame") << endl;
 					// falling back to outputting the first frame
-					errcode = RpPng::save(it->filename, iconAnimData->frames[iconAnimData->seq_index[0]]);
+					errcode = RpPng::save(it->filename, iconAnimData->frames[iconAnimData->seq_index[0]], it->profile);
 				}
 				if (errcode != 0) {
 					cerr << "   " <<
@@ -344,15 +441,16 @@ int RP_C_API main(int argc, char *argv[])
 
 	if(argc < 2){
 #ifdef ENABLE_DECRYPTION
-		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-p] [-j] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-p] [-j] [-l lang] [-z profile] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
 		cerr << "  -k:   " << C_("rpcli", "Verify encryption keys in keys.conf.") << endl;
 #else /* !ENABLE_DECRYPTION */
-		cerr << C_("rpcli", "Usage: rpcli [-c] [-p] [-j] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-c] [-p] [-j] [-l lang] [-z profile] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
 #endif /* ENABLE_DECRYPTION */
 		cerr << "  -c:   " << C_("rpcli", "Print system region information.") << endl;
 		cerr << "  -p:   " << C_("rpcli", "Print system path information.") << endl;
 		cerr << "  -j:   " << C_("rpcli", "Use JSON output format.") << endl;
 		cerr << "  -l:   " << C_("rpcli", "Retrieve the specified language from the ROM image.") << endl;
+		cerr << "  -z:   " << C_("rpcli", "PNG encoding profile for extracted images: fast, balanced (default), small.") << endl;
 		cerr << "  -xN:  " << C_("rpcli", "Extract image N to outfile in PNG format.") << endl;
 		cerr << "  -a:   " << C_("rpcli", "Extract the animated icon to outfile in APNG format.") << endl;
 		cerr << endl;
@@ -388,6 +486,7 @@ int RP_C_API main(int argc, char *argv[])
 	bool inq_ata_packet = false;
 #endif /* RP_OS_SCSI_SUPPORTED */
 	uint32_t languageCode = 0;
+	RpPngWriter::EncodeProfile pngProfile = RpPngWriter::EncodeProfile::Balanced;
 	bool first = true;
 	int ret = 0;
 	for (int i = 1; i < argc; i++){
@@ -445,17 +544,45 @@ int RP_C_API main(int argc, char *argv[])
 				languageCode = lc;
 				break;
 			}
+			case 'z': {
+				// PNG encoding profile.
+				// NOTE: Like the language code, this affects
+				// images extracted from files specified *after* it.
+				const char *s_profile;
+				if (argv[i][2] == '\0') {
+					// Separate argument.
+					s_profile = argv[i+1];
+					i++;
+				} else {
+					// Same argument.
+					s_profile = &argv[i][2];
+				}
+
+				if (!s_profile) {
+					// No profile specified.
+					break;
+				} else if (!strcmp(s_profile, "fast")) {
+					pngProfile = RpPngWriter::EncodeProfile::Fast;
+				} else if (!strcmp(s_profile, "balanced")) {
+					pngProfile = RpPngWriter::EncodeProfile::Balanced;
+				} else if (!strcmp(s_profile, "small")) {
+					pngProfile = RpPngWriter::EncodeProfile::Small;
+				} else {
+					cerr << rp_sprintf(C_("rpcli", "Warning: ignoring unknown PNG encoding profile '%s'"), s_profile) << endl;
+				}
+				break;
+			}
 			case 'x': {
 				long num = atol(argv[i] + 2);
 				if (num<RomData::IMG_INT_MIN || num>RomData::IMG_INT_MAX) {
 					cerr << rp_sprintf(C_("rpcli", "Warning: skipping unknown image type %ld"), num) << endl;
 					i++; continue;
 				}
-				extract.emplace_back(ExtractParam(argv[++i], num));
+				extract.emplace_back(ExtractParam(argv[++i], num, pngProfile));
 				break;
 			}
 			case 'a':
-				extract.emplace_back(ExtractParam(argv[++i], -1));
+				extract.emplace_back(ExtractParam(argv[++i], -1, pngProfile));
 				break;
 			case 'j': // do nothing
 				break;
@@ -26,6 +26,22 @@ int rpcli_do_security_options(void)
 		// TODO: Add more syscalls.
 		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
 		// defined in earlier versions, including Ubuntu 14.04.
+
+		// NOTE: Special case for clone(). If it's the first syscall
+		// in the list, it has a parameter restriction added that
+		// ensures it can only be used to create threads.
+		SCMP_SYS(clone),
+		// Other multi-threading syscalls
+		// [ImageDecoder: multithreaded decoding of large textures]
+		SCMP_SYS(set_robust_list),
+		SCMP_SYS(madvise),		// thread stack cleanup
+		SCMP_SYS(rt_sigprocmask),	// pthread_create()
+#if defined(__SNR_rseq)
+		SCMP_SYS(rseq),		// glibc-2.35
+#elif defined(__NR_rseq)
+		__NR_rseq,		// glibc-2.35
+#endif /* __SNR_rseq || __NR_rseq */
+
 		SCMP_SYS(close),
 		SCMP_SYS(dup),		// gzdopen()
 		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling